@@ -1,6 +1,9 @@
 package ukv_testing
 
-import "testing"
+import (
+	"bytes"
+	"testing"
+)
 
 type dataBase interface {
 	ReConnect(string) error
@@ -8,8 +11,11 @@ type dataBase interface {
 	Set(uint64, []byte) error
 	SetBatch([]uint64, [][]byte) error
 	Delete(uint64) error
+	DeleteBatch([]uint64) error
 	Get(uint64) ([]byte, error)
+	GetBatch([]uint64) ([][]byte, error)
 	Contains(uint64) (bool, error)
+	ContainsBatch([]uint64) ([]bool, error)
 }
 
 func DataBaseSimpleTest(db dataBase, t *testing.T) {
@@ -65,3 +71,45 @@ func DataBaseBatchInsertTest(db dataBase, t *testing.T) {
 		t.Fatalf("Couldn't check value existance: %s", err)
 	}
 }
+
+func DataBaseBatchReadTest(db dataBase, t *testing.T) {
+	if err := db.ReConnect(""); err != nil {
+		t.Fatalf("Couldn't open db: %s", err)
+	}
+
+	defer db.Close()
+	keys := []uint64{10, 11, 12, 13}
+	values := [][]byte{
+		[]byte("Batched"),
+		[]byte(""),
+		[]byte("Values"),
+		[]byte("!")}
+
+	if err := db.SetBatch(keys, values); err != nil {
+		t.Fatalf("Couldn't set values: %s", err)
+	}
+	if err := db.DeleteBatch(keys[3:]); err != nil {
+		t.Fatalf("Couldn't delete values: %s", err)
+	}
+
+	found, err := db.GetBatch(append(keys, 42))
+	if err != nil {
+		t.Fatalf("Couldn't get values: %s", err)
+	}
+	for i := 0; i < 3; i++ {
+		if found[i] == nil || !bytes.Equal(found[i], values[i]) {
+			t.Fatalf("Wrong Value: Expected: %s, Got: %s", string(values[i]), string(found[i]))
+		}
+	}
+	if found[3] != nil || found[4] != nil {
+		t.Fatalf("Missing values must be nil")
+	}
+
+	present, err := db.ContainsBatch(append(keys, 42))
+	if err != nil {
+		t.Fatalf("Couldn't check values existance: %s", err)
+	}
+	if !present[0] || !present[1] || !present[2] || present[3] || present[4] {
+		t.Fatalf("Wrong existance flags: %v", present)
+	}
+}
@@ -5,16 +5,14 @@ package ukv
 #include "ukv/db.h"
 #include <stdlib.h>
 
-ukv_val_len_t dereference_index(ukv_val_len_t* lens, ukv_size_t idx) { return lens[idx]; }
-
 typedef void (*open_fn)(ukv_str_view_t, ukv_t*, ukv_error_t*);
 typedef void (*error_free_fn)(ukv_error_t);
 typedef void (*arena_free_fn)(ukv_t const, ukv_arena_t);
 typedef void (*free_fn)(ukv_t);
 typedef void (*read_fn)(ukv_t const, ukv_txn_t const, ukv_size_t const,
     ukv_col_t const*, ukv_size_t const, ukv_key_t const*,
-    ukv_size_t const, ukv_options_t const, ukv_val_len_t**,
-    ukv_val_ptr_t*, ukv_arena_t*, ukv_error_t*);
+    ukv_size_t const, ukv_options_t const, ukv_val_ptr_t*,
+    ukv_val_len_t**, ukv_val_len_t**, ukv_arena_t*, ukv_error_t*);
 typedef void (*write_fn)(ukv_t const, ukv_txn_t const,ukv_size_t const,
     ukv_col_t const*, ukv_size_t const, ukv_key_t const*,
     ukv_size_t const, ukv_val_ptr_t const*, ukv_size_t const,
@@ -44,31 +42,26 @@ void u_free(void*fn, ukv_t c_db) {
 
 void u_read(void* fn, ukv_t const c_db, ukv_txn_t const c_txn, ukv_size_t const c_tasks_count,
 		ukv_col_t const* c_cols, ukv_size_t const c_cols_stride, ukv_key_t const* c_keys,
-		ukv_size_t const c_keys_stride, ukv_options_t const c_options, ukv_val_len_t** c_found_lengths,
-		ukv_val_ptr_t* c_found_values, ukv_arena_t* c_arena, ukv_error_t* c_error) {
+		ukv_size_t const c_keys_stride, ukv_options_t const c_options, ukv_val_ptr_t* c_found_values,
+		ukv_val_len_t** c_found_offsets, ukv_val_len_t** c_found_lengths,
+		ukv_arena_t* c_arena, ukv_error_t* c_error) {
 
 	read_fn func = (read_fn)(fn);
 	(*func)(c_db, c_txn, c_tasks_count, c_cols, c_cols_stride, c_keys, c_keys_stride,
-			c_options, c_found_lengths, c_found_values, c_arena, c_error);
+			c_options, c_found_values, c_found_offsets, c_found_lengths, c_arena, c_error);
 }
 
 void u_write(void* fn, ukv_t const c_db, ukv_txn_t const c_txn, ukv_size_t const c_tasks_count,
 		ukv_col_t const* c_cols, ukv_size_t const c_cols_stride, ukv_key_t const* c_keys,
-		ukv_size_t const c_keys_stride, ukv_val_ptr_t const c_vals, ukv_size_t const c_vals_stride,
+		ukv_size_t const c_keys_stride, ukv_val_ptr_t const* c_vals, ukv_size_t const c_vals_stride,
 		ukv_val_len_t const* c_offs, ukv_size_t const c_offs_stride, ukv_val_len_t const* c_lens,
 		ukv_size_t const c_lens_stride, ukv_options_t const c_options, ukv_arena_t* c_arena, ukv_error_t* c_error) {
 
 	write_fn func = (write_fn)(fn);
-	ukv_val_ptr_t * val_ptr = (ukv_val_ptr_t*)c_vals;
-
-	(*func)(c_db, c_txn, c_tasks_count, c_cols, c_cols_stride, c_keys, c_keys_stride, val_ptr,
+	(*func)(c_db, c_txn, c_tasks_count, c_cols, c_cols_stride, c_keys, c_keys_stride, c_vals,
 			c_vals_stride, c_offs, c_offs_stride, c_lens, c_lens_stride, c_options, c_arena, c_error);
 }
 
-bool is_null(ukv_val_ptr_t ptr, int len) {
-	return *(*(char**)ptr + len) == 0;
-}
-
  const ukv_size_t size_of_key = sizeof(ukv_key_t);
  const ukv_size_t size_of_len = sizeof(ukv_val_len_t);
 */
@@ -78,6 +71,10 @@ import (
 	"unsafe"
 )
 
+// Upper bounds for viewing C arrays as Go slices without copies
+const maxTapeLength = 1 << 30
+const maxTasksCount = 1 << 27
+
 type UKV_val_len_t = C.ukv_val_len_t
 
 type BackendInterface struct {
@@ -134,163 +131,207 @@ func (db *DataBase) Close() {
 }
 
 func (db *DataBase) Set(key uint64, value []byte) error {
-
-	// Passing values without copies seems essentially impossible
-	// and causes: "cgo argument has Go pointer to Go pointer"
-	// when we try to take pass pointer to to first object in `[]byte`.
-	// https://stackoverflow.com/a/64867672
-	error_c := C.ukv_error_t(nil)
-	key_c := C.ukv_key_t(key)
-	collection_c := (*C.ukv_col_t)(nil)
-	options_c := C.ukv_options_t(C.ukv_options_default_k)
-	val_ptr := C.ukv_val_ptr_t(unsafe.Pointer(&value[0]))
-	value_ptr_c := C.ukv_val_ptr_t(unsafe.Pointer(&val_ptr))
-	value_length_c := C.ukv_val_len_t(len(value))
-	value_offset_c := C.ukv_val_len_t(0)
-	arena_c := (C.ukv_arena_t)(nil)
-	defer freeArena(db, arena_c)
-
-	C.u_write(db.Backend.UKV_write,
-		db.raw, nil, 1,
-		collection_c, 0,
-		&key_c, 0,
-		value_ptr_c, 0,
-		&value_offset_c, 0,
-		&value_length_c, 0,
-		options_c, &arena_c, &error_c)
-	return forwardError(db, error_c)
+	return db.SetBatch([]uint64{key}, [][]byte{value})
 }
 
+// SetBatch writes all the values in a single call to the backend.
+// Passing Go slices of slices to C violates the cgo pointer rules:
+// "cgo argument has Go pointer to Go pointer", https://stackoverflow.com/a/64867672
+// So the values are joined into one C-allocated buffer,
+// and addressed with offsets and lengths from the beginning of it.
 func (db *DataBase) SetBatch(keys []uint64, values [][]byte) error {
 
+	if len(keys) != len(values) {
+		return errors.New("Number of keys and values must match")
+	}
+	if len(keys) == 0 {
+		return nil
+	}
+
+	total_length := 0
+	for _, value := range values {
+		total_length += len(value)
+	}
+	if total_length >= maxTapeLength {
+		return errors.New("Values exceed the maximum batch size")
+	}
+
+	contents_c := C.ukv_val_ptr_t(C.malloc(C.size_t(total_length + 1)))
+	if contents_c == nil {
+		return errors.New("Failed to allocate memory!")
+	}
+	defer C.free(unsafe.Pointer(contents_c))
+
+	contents_go := (*[maxTapeLength]byte)(unsafe.Pointer(contents_c))[:total_length:total_length]
+	offsets := make([]C.ukv_val_len_t, len(values))
+	lengths := make([]C.ukv_val_len_t, len(values))
+	progress := 0
+	for i, value := range values {
+		offsets[i] = C.ukv_val_len_t(progress)
+		lengths[i] = C.ukv_val_len_t(len(value))
+		progress += copy(contents_go[progress:], value)
+	}
+
 	error_c := C.ukv_error_t(nil)
 	keys_c := (*C.ukv_key_t)(unsafe.Pointer(&keys[0]))
 	collection_c := (*C.ukv_col_t)(nil)
 	options_c := C.ukv_options_t(C.ukv_options_default_k)
-	value_ptr_c := C.ukv_val_ptr_t(unsafe.Pointer(&values[0]))
-	task_count_c := C.size_t(len(values))
-
-	offsets := make([]C.ukv_val_len_t, task_count_c)
-	lens := make([]C.ukv_val_len_t, task_count_c)
-
-	lens[0] = C.ukv_val_len_t(len(values[0]))
-	offsets[0] = 0
-	for i := C.size_t(1); i < task_count_c; i++ {
-		lens[i] = C.ukv_val_len_t(len(values[i]))
-		new_offs := offsets[i-1] + lens[i-1]
-		for C.is_null(value_ptr_c, C.int(new_offs)) {
-			new_offs++
-		}
-		offsets[i] = new_offs
-	}
-
 	arena_c := (C.ukv_arena_t)(nil)
-	defer freeArena(db, arena_c)
+	defer func() { freeArena(db, arena_c) }()
 
 	C.u_write(db.Backend.UKV_write,
-		db.raw, nil, task_count_c,
+		db.raw, nil, C.ukv_size_t(len(keys)),
 		collection_c, 0,
 		keys_c, C.size_of_key,
-		value_ptr_c, 0,
+		&contents_c, 0,
 		&offsets[0], C.size_of_len,
-		&lens[0], C.size_of_len,
+		&lengths[0], C.size_of_len,
 		options_c, &arena_c, &error_c)
 	return forwardError(db, error_c)
 }
 
 func (db *DataBase) Delete(key uint64) error {
+	return db.DeleteBatch([]uint64{key})
+}
+
+// DeleteBatch removes all the keys in a single call to the backend.
+func (db *DataBase) DeleteBatch(keys []uint64) error {
+
+	if len(keys) == 0 {
+		return nil
+	}
 
-	// Passing values without copies seems essentially impossible
-	// and causes: "cgo argument has Go pointer to Go pointer"
-	// when we try to take pass pointer to to first object in `[]byte`.
-	// https://stackoverflow.com/a/64867672
 	error_c := C.ukv_error_t(nil)
-	key_c := C.ukv_key_t(key)
+	keys_c := (*C.ukv_key_t)(unsafe.Pointer(&keys[0]))
 	collection_c := (*C.ukv_col_t)(nil)
 	options_c := C.ukv_options_t(C.ukv_options_default_k)
-	value_ptr_c := C.ukv_val_ptr_t(nil)
-	value_length_c := C.ukv_val_len_t(0)
-	value_offset_c := C.ukv_val_len_t(0)
+	contents_c := C.ukv_val_ptr_t(nil)
+	offset_c := C.ukv_val_len_t(0)
+	length_c := C.ukv_val_len_t(0)
 	arena_c := (C.ukv_arena_t)(nil)
-	defer freeArena(db, arena_c)
+	defer func() { freeArena(db, arena_c) }()
 
 	C.u_write(db.Backend.UKV_write,
-		db.raw, nil, 1,
+		db.raw, nil, C.ukv_size_t(len(keys)),
 		collection_c, 0,
-		&key_c, 0,
-		value_ptr_c, 0,
-		&value_offset_c, 0,
-		&value_length_c, 0,
+		keys_c, C.size_of_key,
+		&contents_c, 0,
+		&offset_c, 0,
+		&length_c, 0,
 		options_c, &arena_c, &error_c)
 	return forwardError(db, error_c)
 }
 
-func (db *DataBase) Get(key uint64) ([]byte, error) {
+// readBatch fetches the values or just their lengths in a single call,
+// exposing the offsets and lengths as Go slices over the arena memory.
+// Those slices are only valid until the returned arena is freed.
+func (db *DataBase) readBatch(keys []uint64, options_c C.ukv_options_t) (
+	C.ukv_val_ptr_t, []C.ukv_val_len_t, []C.ukv_val_len_t, C.ukv_arena_t, error) {
 
-	// Even though we can't properly write without a single copy
-	// from Go layer, but we can read entries from C-allocated buffers.
 	error_c := C.ukv_error_t(nil)
-	key_c := C.ukv_key_t(key)
+	keys_c := (*C.ukv_key_t)(unsafe.Pointer(&keys[0]))
 	collection_c := (*C.ukv_col_t)(nil)
-	options_c := C.ukv_options_t(C.ukv_options_default_k)
-	pulled_values_lengths_c := (*C.ukv_val_len_t)(nil)
-	pulled_values_c := (C.ukv_val_ptr_t)(nil)
+	values_c := (C.ukv_val_ptr_t)(nil)
+	offsets_c := (*C.ukv_val_len_t)(nil)
+	lengths_c := (*C.ukv_val_len_t)(nil)
 	arena_c := (C.ukv_arena_t)(nil)
-	defer freeArena(db, arena_c)
 
 	C.u_read(db.Backend.UKV_read,
-		db.raw, nil, 1,
+		db.raw, nil, C.ukv_size_t(len(keys)),
 		collection_c, 0,
-		&key_c, 0,
+		keys_c, C.size_of_key,
 		options_c,
-		&pulled_values_lengths_c,
-		&pulled_values_c,
+		&values_c,
+		&offsets_c,
+		&lengths_c,
 		&arena_c,
 		&error_c)
 
 	error_go := forwardError(db, error_c)
 	if error_go != nil {
-		return nil, error_go
+		return nil, nil, nil, arena_c, error_go
 	}
 
-	// We can also jsut cast it to slice without copies
-	// pulled_value_go := (*[1 << 30]byte)(unsafe.Pointer(pulled_value_c))[:tape_length_c:tape_length_c]
-	pulled_value_length_c := C.dereference_index(pulled_values_lengths_c, 0)
-	if pulled_value_length_c == db.Backend.UKV_val_len_missing {
-		return nil, nil
-	} else {
-		pulled_value_go := C.GoBytes(unsafe.Pointer(pulled_values_c), C.int(pulled_value_length_c))
-		return pulled_value_go, nil
+	count := len(keys)
+	lengths_go := (*[maxTasksCount]C.ukv_val_len_t)(unsafe.Pointer(lengths_c))[:count:count]
+	if offsets_c == nil {
+		return values_c, nil, lengths_go, arena_c, nil
 	}
+	offsets_go := (*[maxTasksCount]C.ukv_val_len_t)(unsafe.Pointer(offsets_c))[:count:count]
+	return values_c, offsets_go, lengths_go, arena_c, nil
 }
 
-func (db *DataBase) Contains(key uint64) (bool, error) {
+func (db *DataBase) Get(key uint64) ([]byte, error) {
+	values, error_go := db.GetBatch([]uint64{key})
+	if error_go != nil {
+		return nil, error_go
+	}
+	return values[0], nil
+}
 
-	// Even though we can't properly write without a single copy
-	// from Go layer, but we can read entries from C-allocated buffers.
-	error_c := C.ukv_error_t(nil)
-	key_c := C.ukv_key_t(key)
-	collection_c := (*C.ukv_col_t)(nil)
-	options_c := C.ukv_options_t(C.ukv_option_read_lengths_k)
-	pulled_values_lengths_c := (*C.ukv_val_len_t)(nil)
-	pulled_values_c := (C.ukv_val_ptr_t)(nil)
-	arena_c := (C.ukv_arena_t)(nil)
+// GetBatch fetches all the values in a single call to the backend.
+// The shared tape is copied into Go memory at once, and the returned
+// values are slices of it. Missing values are returned as nil.
+func (db *DataBase) GetBatch(keys []uint64) ([][]byte, error) {
+
+	if len(keys) == 0 {
+		return [][]byte{}, nil
+	}
+	if len(keys) >= maxTasksCount {
+		return nil, errors.New("Too many keys in a batch")
+	}
+
+	values_c, offsets, lengths, arena_c, error_go := db.readBatch(keys, C.ukv_options_default_k)
 	defer freeArena(db, arena_c)
+	if error_go != nil {
+		return nil, error_go
+	}
 
-	C.u_read(db.Backend.UKV_read,
-		db.raw, nil, 1,
-		collection_c, 0,
-		&key_c, 0,
-		options_c,
-		&pulled_values_lengths_c,
-		&pulled_values_c,
-		&arena_c,
-		&error_c)
+	tape_length := C.ukv_val_len_t(0)
+	for i, length := range lengths {
+		if length != db.Backend.UKV_val_len_missing && offsets[i]+length > tape_length {
+			tape_length = offsets[i] + length
+		}
+	}
 
-	error_go := forwardError(db, error_c)
+	tape := C.GoBytes(unsafe.Pointer(values_c), C.int(tape_length))
+	values := make([][]byte, len(keys))
+	for i, length := range lengths {
+		if length != db.Backend.UKV_val_len_missing {
+			begin, end := offsets[i], offsets[i]+length
+			values[i] = tape[begin:end:end]
+		}
+	}
+	return values, nil
+}
+
+func (db *DataBase) Contains(key uint64) (bool, error) {
+	found, error_go := db.ContainsBatch([]uint64{key})
 	if error_go != nil {
 		return false, error_go
 	}
+	return found[0], nil
+}
+
+// ContainsBatch checks the presence of all the keys in a single call to the backend.
+func (db *DataBase) ContainsBatch(keys []uint64) ([]bool, error) {
+
+	if len(keys) == 0 {
+		return []bool{}, nil
+	}
+	if len(keys) >= maxTasksCount {
+		return nil, errors.New("Too many keys in a batch")
+	}
+
+	_, _, lengths, arena_c, error_go := db.readBatch(keys, C.ukv_option_read_lengths_k)
+	defer freeArena(db, arena_c)
+	if error_go != nil {
+		return nil, error_go
+	}
 
-	return C.dereference_index(pulled_values_lengths_c, 0) != db.Backend.UKV_val_len_missing, nil
+	found := make([]bool, len(keys))
+	for i, length := range lengths {
+		found[i] = length != db.Backend.UKV_val_len_missing
+	}
+	return found, nil
 }
@@ -16,3 +16,8 @@ func TestDataBaseBatchInsert(t *testing.T) {
 	db := ukv.CreateDB()
 	utest.DataBaseBatchInsertTest(&db, t)
 }
+
+func TestDataBaseBatchRead(t *testing.T) {
+	db := ukv.CreateDB()
+	utest.DataBaseBatchReadTest(&db, t)
+}
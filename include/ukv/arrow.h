@@ -1,18 +1,46 @@
 /**
- * Implements bindings for the Apache Arrow.
- * Internally replicates the bare-minimum defintions required
- * for Arrow to be ABI-compatiable.
+ * @file arrow.h
+ * @author Ashot Vardanian
+ * @date 4 Aug 2022
+ *
+ * @brief Exports the results of UKV reads into the Apache Arrow C Data Interface.
+ * Internally replicates the bare-minimum definitions required
+ * for Arrow to be ABI-compatible, so no Arrow headers are needed.
  *
  * https://arrow.apache.org/docs/format/CDataInterface.html#structure-definitions
- * https://arrow.apache.org/docs/format/CDataInterface.html#example-use-case
+ * https://arrow.apache.org/docs/format/CStreamInterface.html
+ *
+ * @section Ownership
+ * Exported arrays point directly into the memory of the arena, that received
+ * the results. To keep that memory alive, the arena is moved into the array:
+ * the passed `ukv_arena_t` is reset to NULL and freed by the `release` callback
+ * of the array. Schemas and arrays are released independently, as required by
+ * the interface. Children of exported arrays share the memory of the parent,
+ * so they can be read, but must not be moved out of it.
  *
- * After the data is exported into Arrow RecordBatches or Tables,
- * we can stream it with standardized messages:
- * https://arrow.apache.org/docs/format/Columnar.html#encapsulated-message-format
+ * @section Copies
+ * Keys, scalar columns, validity bitmaps and binary values, consecutively laid out
+ * on the tape, are exported without copies. A few layouts differ between UKV and Arrow,
+ * and are repacked into memory owned by the array:
+ * > Arrow needs `count + 1` offsets, while UKV exports offsets and lengths.
+ * > Arrow booleans are bit-packed, while UKV exports them as bytes.
+ * > Arrow keeps the strings of every column together, while UKV gathers them row-by-row.
  */
+
 #pragma once
-#include <inttypes.h> // `int64_t`
-#include <stdlib.h>   // `malloc`
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h> // `int64_t`
+
+#include "ukv/db.h"
+#include "ukv/docs.h"
+
+/*********************************************************/
+/*****************   Structures & Consts  ****************/
+/*********************************************************/
 
 #ifndef ARROW_C_DATA_INTERFACE
 #define ARROW_C_DATA_INTERFACE
@@ -22,6 +50,7 @@
 #define ARROW_FLAG_MAP_KEYS_SORTED 4
 
 struct ArrowSchema {
+    // Array type description
     const char* format;
     const char* name;
     const char* metadata;
@@ -29,7 +58,10 @@ struct ArrowSchema {
     int64_t n_children;
     struct ArrowSchema** children;
     struct ArrowSchema* dictionary;
+
+    // Release callback
     void (*release)(struct ArrowSchema*);
+    // Opaque producer-specific data
     void* private_data;
 };
 
@@ -43,7 +75,10 @@ struct ArrowArray {
     const void** buffers;
     struct ArrowArray** children;
     struct ArrowArray* dictionary;
+
+    // Release callback
     void (*release)(struct ArrowArray*);
+    // Opaque producer-specific data
     void* private_data;
 };
 
@@ -53,185 +88,148 @@ struct ArrowArray {
 #define ARROW_C_STREAM_INTERFACE
 
 struct ArrowArrayStream {
+    // Callbacks providing stream functionality
     int (*get_schema)(struct ArrowArrayStream*, struct ArrowSchema* out);
     int (*get_next)(struct ArrowArrayStream*, struct ArrowArray* out);
     const char* (*get_last_error)(struct ArrowArrayStream*);
+
+    // Release callback
     void (*release)(struct ArrowArrayStream*);
+    // Opaque producer-specific data
     void* private_data;
 };
 
 #endif // ARROW_C_STREAM_INTERFACE
 
-static void ukv_to_arrow_schema( //
-    ukv_size_t const docs_count,
-    ukv_size_t const fields_count,
+/*********************************************************/
+/*****************	 Primary Functions	  ****************/
+/*********************************************************/
+
+/**
+ * @brief Exports keys, like the ones found by `ukv_scan`, as an Arrow @c `int64` array.
+ * The buffer is referenced without copies.
+ *
+ * @param[in] db            Database, that allocated the @p arena.
+ * @param[in] count         Number of keys to export, excluding the `ukv_key_unknown_k` padding.
+ * @param[in] keys          Keys, stored in the @p arena.
+ * @param[in] name          Name of the exported column. Can be NULL.
+ * @param[out] schema       Will describe the exported array.
+ * @param[out] array        Will contain the exported array.
+ * @param[inout] arena      Memory holding the @p keys. Ownership moves into the @p array.
+ * @param[out] error        The error message to be handled by callee.
+ */
+void ukv_to_arrow_keys( //
+    ukv_t const db,
+    ukv_size_t const count,
+    ukv_key_t const* keys,
+    ukv_str_view_t const name,
 
     struct ArrowSchema* schema,
     struct ArrowArray* array,
-    ukv_error_t* error) {
-
-    // Schema
-    schema->format = "+s";
-    schema->name = "";
-    schema->metadata = NULL;
-    schema->flags = 0;
-    schema->n_children = static_cast<int64_t>(fields_count);
-    schema->dictionary = NULL;
-    schema->release = &release_malloced_schema;
-    schema->children = malloc(sizeof(struct ArrowSchema*) * schema->n_children);
-
-    // Data
-    array->length = static_cast<int64_t>(docs_count);
-    array->offset = 0;
-    array->null_count = 0;
-    array->n_buffers = 1;
-    array->n_children = 2;
-    array->dictionary = NULL;
-    array->release = &release_malloced_array;
-    array->buffers = malloc(sizeof(void*) * array->n_buffers);
-    array->buffers[0] = NULL; // no nulls, so bitmap can be omitted
-    array->children = malloc(sizeof(struct ArrowArray*) * array->n_children);
-
-    // Allocate sub-schemas and sub-arays
-    // TODO: Don't malloc every child schema/array separately,
-    // use `private_data` member for that.
-    for (ukv_size_t field_idx = 0; field_idx != fields_count; ++field_idx)
-        schema->children[field_idx] = malloc(sizeof(struct ArrowSchema));
-    for (ukv_size_t field_idx = 0; field_idx != fields_count; ++field_idx)
-        array->children[field_idx] = malloc(sizeof(struct ArrowArray));
-}
-
-static void ukv_to_arrow_column( //
-    ukv_size_t const docs_count,
-    ukv_str_view_t const field_name,
-    ukv_type_t const field_type,
+    ukv_arena_t* arena,
+    ukv_error_t* error);
 
-    ukv_val_ptr_t const column_validities,
-    ukv_val_len_t const column_offsets,
-    ukv_val_ptr_t const column_contents,
+/**
+ * @brief Exports values, fetched by `ukv_read`, as an Arrow @c `binary` array.
+ * Missing entries become nulls. The contents are referenced without copies,
+ * if the values are laid out consecutively on the tape, as most backends do.
+ *
+ * @param[in] db            Database, that allocated the @p arena.
+ * @param[in] count         Number of values to export.
+ * @param[in] values        Tape of values, exported by `ukv_read`.
+ * @param[in] offsets       Offsets of the values within the @p values tape.
+ * @param[in] lengths       Lengths of the values or `ukv_val_len_missing_k`.
+ * @param[in] name          Name of the exported column. Can be NULL.
+ * @param[out] schema       Will describe the exported array.
+ * @param[out] array        Will contain the exported array.
+ * @param[inout] arena      Memory holding the @p values. Ownership moves into the @p array.
+ * @param[out] error        The error message to be handled by callee.
+ */
+void ukv_to_arrow_values( //
+    ukv_t const db,
+    ukv_size_t const count,
+    ukv_val_ptr_t const values,
+    ukv_val_len_t const* offsets,
+    ukv_val_len_t const* lengths,
+    ukv_str_view_t const name,
 
     struct ArrowSchema* schema,
     struct ArrowArray* array,
+    ukv_arena_t* arena,
+    ukv_error_t* error);
 
-    ukv_error_t* error) {
-
-    // Export the right format string and number of buffers to be managed by Arrow.
-    // For scalar arrays we need: bitmap and data.
-    // For variable length arrays we need: bitmap, @b offsets and data.
-    // Important note, both 32-bit and 64-bit offsets are supported.
-    // https://arrow.apache.org/docs/format/CDataInterface.html#data-type-description-format-strings
-    // https://arrow.apache.org/docs/format/Columnar.html#buffer-listing-for-each-layout
-    switch (field_type) {
-    case ukv_type_null_k: schema->format = "n"; break;
-    case ukv_type_bool_k: schema->format = "b"; break;
-    case ukv_type_uuid_k: schema->format = "w:16"; break;
-    case ukv_type_i8_k: schema->format = "c"; break;
-    case ukv_type_i16_k: schema->format = "s"; break;
-    case ukv_type_i32_k: schema->format = "i"; break;
-    case ukv_type_i64_k: schema->format = "l"; break;
-    case ukv_type_u8_k: schema->format = "C"; break;
-    case ukv_type_u16_k: schema->format = "S"; break;
-    case ukv_type_u32_k: schema->format = "I"; break;
-    case ukv_type_u64_k: schema->format = "U"; break;
-    case ukv_type_f16_k: schema->format = "e"; break;
-    case ukv_type_f32_k: schema->format = "f"; break;
-    case ukv_type_f64_k: schema->format = "g"; break;
-    case ukv_type_bin_k: schema->format = "z"; break;
-    case ukv_type_str_k: schema->format = "u"; break;
-    }
-    schema->name = field_name;
-    schema->metadata = NULL;
-    schema->flags = ARROW_FLAG_NULLABLE;
-    schema->n_children = 0;
-    schema->dictionary = NULL;
-    schema->children = NULL;
-    schema->release = &release_malloced_schema;
-
-    // Export the data
-    switch (field_type) {
-    case ukv_type_null_k: array->n_buffers = 0; break;
-    case ukv_type_bool_k:
-    case ukv_type_uuid_k:
-    case ukv_type_i8_k:
-    case ukv_type_i16_k:
-    case ukv_type_i32_k:
-    case ukv_type_i64_k:
-    case ukv_type_u8_k:
-    case ukv_type_u16_k:
-    case ukv_type_u32_k:
-    case ukv_type_u64_k:
-    case ukv_type_f16_k:
-    case ukv_type_f32_k:
-    case ukv_type_f64_k: array->n_buffers = 2; break;
-    case ukv_type_bin_k:
-    case ukv_type_str_k: array->n_buffers = 3; break;
-    }
-    array->length = docs_count;
-    array->offset = 0;
-    array->null_count = -1;
-    array->n_children = 0;
-    array->dictionary = NULL;
-    array->children = NULL;
-    array->release = &release_malloced_array;
-
-    // Link our buffers
-    array->buffers = malloc(sizeof(void*) * array->n_buffers);
-    if (array->n_buffers == 2) {
-        array->buffers[0] = (void*)column_validities;
-        array->buffers[1] = (void*)column_contents;
-    }
-    else {
-        array->buffers[0] = (void*)column_validities;
-        array->buffers[1] = (void*)column_offsets;
-        array->buffers[2] = (void*)column_contents;
-    }
-}
-
-static void release_malloced_schema(struct ArrowSchema* schema) {
-    for (int64_t i = 0; i < schema->n_children; ++i) {
-        struct ArrowSchema* child = schema->children[i];
-        if (child->release != NULL)
-            child->release(child);
-    }
-    free(schema->children);
-    schema->release = NULL;
-}
-
-static void release_malloced_array(struct ArrowArray* array) {
-    // Free children
-    for (int64_t i = 0; i < array->n_children; ++i) {
-        struct ArrowArray* child = array->children[i];
-        if (child->release != NULL)
-            child->release(child);
-    }
-    free(array->children);
-    // Freeing buffers can be avoided, UKV still owns those regions
-    // while the connection is alive and hasn't be reused for any other
-    // requests.
-    // for (int64_t i = 0; i < array->n_buffers; ++i)
-    //     free((void*)array->buffers[i]);
-    free(array->buffers);
-    array->release = NULL;
-}
+/**
+ * @brief Exports the columns produced by `ukv_docs_gather` as an Arrow @c `struct` array,
+ * that most libraries import as a `RecordBatch`. Fixed-width scalars and validity bitmaps
+ * are referenced without copies.
+ *
+ * @param[in] db            Database, that allocated the @p arena.
+ * @param[in] docs_count    Number of rows, passed to `ukv_docs_gather`.
+ * @param[in] fields_count  Number of columns, passed to `ukv_docs_gather`.
+ * @param[in] fields        Names of the columns, passed to `ukv_docs_gather`.
+ * @param[in] types         Types of the columns, passed to `ukv_docs_gather`.
+ * @param[in] columns_validities    Validity bitmaps, exported by `ukv_docs_gather`.
+ * @param[in] columns_scalars       Scalar columns, exported by `ukv_docs_gather`.
+ * @param[in] columns_offsets       Strings offsets, exported by `ukv_docs_gather`.
+ * @param[in] columns_lengths       Strings lengths, exported by `ukv_docs_gather`.
+ * @param[in] joined_strings        Strings tape, exported by `ukv_docs_gather`.
+ * @param[out] schema       Will describe the exported array.
+ * @param[out] array        Will contain the exported array.
+ * @param[inout] arena      Memory holding the columns. Ownership moves into the @p array.
+ * @param[out] error        The error message to be handled by callee.
+ */
+void ukv_to_arrow_table( //
+    ukv_t const db,
+    ukv_size_t const docs_count,
+    ukv_size_t const fields_count,
+
+    ukv_str_view_t const* fields,
+    ukv_size_t const fields_stride,
+
+    ukv_type_t const* types,
+    ukv_size_t const types_stride,
+
+    ukv_1x8_t** columns_validities,
+    ukv_val_ptr_t* columns_scalars,
+    ukv_val_len_t** columns_offsets,
+    ukv_val_len_t** columns_lengths,
+    ukv_val_ptr_t joined_strings,
+
+    struct ArrowSchema* schema,
+    struct ArrowArray* array,
+    ukv_arena_t* arena,
+    ukv_error_t* error);
 
 /**
+ * @brief Streams a range of a collection as Arrow @c `struct` arrays.
+ * The first column of every batch is the "key". Without fields, the second one
+ * is the binary "value", otherwise the fields are gathered from documents.
+ * Every batch owns the arenas it was read into, so it stays valid after the
+ * following `get_next` calls and even after the stream is released.
  *
- * @param[in] collections   Can have 0, 1 or `fields_count` elements.
- *                          It allows joining the data from different collections
- *                          stored in documents under the same key.
+ * @param[in] db            Already open database instance, @see `ukv_db_open`.
+ * @param[in] txn           Transaction or the snapshot, through which the
+ *                          operation must go. Can be NULL.
+ * @param[in] collection    Collection to stream.
+ * @param[in] min_key       Inclusive lower bound of the range.
+ * @param[in] max_key       Exclusive upper bound of the range.
+ * @param[in] docs_per_batch  Number of keys scanned for every batch.
+ * @param[in] fields_count  Number of fields to gather. Zero exports the binary values.
+ * @param[in] fields        JSON-Pointers to gather, @see `ukv_docs_gather`.
+ * @param[in] types         Types of gathered fields, @see `ukv_docs_gather`.
+ * @param[out] stream       Will contain the exported stream. The @p txn must outlive it.
+ * @param[out] error        The error message to be handled by callee.
  */
-static void ukv_to_arrow_stream( //
+void ukv_to_arrow_stream( //
     ukv_t const db,
     ukv_txn_t const txn,
-    ukv_size_t const fields_count,
+    ukv_col_t const collection,
 
-    ukv_size_t const docs_per_batch,
     ukv_key_t const min_key,
     ukv_key_t const max_key,
+    ukv_size_t const docs_per_batch,
 
-    ukv_col_t const* collections,
-    ukv_size_t const collections_stride,
-
+    ukv_size_t const fields_count,
     ukv_str_view_t const* fields,
     ukv_size_t const fields_stride,
 
@@ -239,5 +237,8 @@ static void ukv_to_arrow_stream( //
     ukv_size_t const types_stride,
 
     struct ArrowArrayStream* stream,
-    ukv_arena_t* arena) {
-}
\ No newline at end of file
+    ukv_error_t* error);
+
+#ifdef __cplusplus
+} /* end extern "C" */
+#endif
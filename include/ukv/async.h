@@ -0,0 +1,190 @@
+/**
+ * @file async.h
+ * @author Ashot Vardanian
+ * @date 20 Aug 2022
+ *
+ * @brief C bindings for non-blocking submission of the primary operations.
+ * It extends "db.h" with `ukv_read_async`, `ukv_write_async` and `ukv_scan_async`,
+ * that return immediately, leaving a future to be polled, waited or completed
+ * with a callback. Unlike the synchronous versions, many of them can stay in
+ * flight at once, so a single thread can drive thousands of batches.
+ *
+ * @section Execution
+ * The batches are executed by the backend itself, but on a shared pool of threads,
+ * so that the I/O of disk-based backends stalls those, instead of the submitter.
+ * The pool is spawned on the first submission, @see `ukv_async_threads_limit`.
+ *
+ * @section Lifetimes
+ * Every argument, including the arrays of keys, values and the output
+ * pointers, must stay valid until the operation completes. The results
+ * are exported into the @p arena, which can't be shared with any other
+ * call in flight. The same applies to transactions: they aren't thread-safe,
+ * so only one operation per transaction can be in flight.
+ *
+ * @section Completion
+ * Once the batch is done and the outputs are written, the @p callback receives the
+ * @p user_data and the error of the operation, if any. The callback is invoked from
+ * one of the pool threads and must not block. Afterwards the future becomes "ready".
+ * Futures must be released with `ukv_future_free`, even before completion:
+ * the operation will still finish, but its result will be discarded.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "ukv/db.h"
+
+/*********************************************************/
+/*****************   Structures & Consts  ****************/
+/*********************************************************/
+
+/**
+ * @brief Handle of a submitted operation.
+ * Can be NULL, if the caller only relies on the callback.
+ */
+typedef void* ukv_future_t;
+
+/**
+ * @brief Completion routine, receiving the `user_data` passed on submission
+ * and the error of the operation, which is NULL on success.
+ */
+typedef void (*ukv_callback_t)(void* user_data, ukv_error_t error);
+
+/*********************************************************/
+/*****************	 Primary Functions	  ****************/
+/*********************************************************/
+
+/**
+ * @brief Limits the number of threads executing the submitted operations.
+ * Has effect only before the first submission in the current process.
+ * Zero, the default, means all hardware threads.
+ */
+void ukv_async_threads_limit(ukv_size_t const threads);
+
+/**
+ * @brief Submits a `ukv_read`, returning before it's executed.
+ * The found values are exported into @p arena right before the @p callback.
+ *
+ * @param[in] callback      Invoked on completion. Can be NULL.
+ * @param[in] user_data     Passed to the @p callback.
+ * @param[out] future       Will contain the handle of the operation. Can be NULL.
+ * @param[out] error        Reports failed submissions only, @see `ukv_future_wait`.
+ */
+void ukv_read_async( //
+    ukv_t const db,
+    ukv_txn_t const txn,
+    ukv_size_t const tasks_count,
+
+    ukv_col_t const* collections,
+    ukv_size_t const collections_stride,
+
+    ukv_key_t const* keys,
+    ukv_size_t const keys_stride,
+
+    ukv_options_t const options,
+
+    ukv_val_ptr_t* found_values,
+    ukv_val_len_t** found_offsets,
+    ukv_val_len_t** found_lengths,
+
+    ukv_arena_t* arena,
+    ukv_callback_t callback,
+    void* user_data,
+    ukv_future_t* future,
+    ukv_error_t* error);
+
+/**
+ * @brief Submits a `ukv_write`, returning before it's executed.
+ * The passed values must not be changed until completion.
+ *
+ * @param[in] callback      Invoked on completion. Can be NULL.
+ * @param[in] user_data     Passed to the @p callback.
+ * @param[out] future       Will contain the handle of the operation. Can be NULL.
+ * @param[out] error        Reports failed submissions only, @see `ukv_future_wait`.
+ */
+void ukv_write_async( //
+    ukv_t const db,
+    ukv_txn_t const txn,
+    ukv_size_t const tasks_count,
+
+    ukv_col_t const* collections,
+    ukv_size_t const collections_stride,
+
+    ukv_key_t const* keys,
+    ukv_size_t const keys_stride,
+
+    ukv_val_ptr_t const* values,
+    ukv_size_t const values_stride,
+
+    ukv_val_len_t const* offsets,
+    ukv_size_t const offsets_stride,
+
+    ukv_val_len_t const* lengths,
+    ukv_size_t const lengths_stride,
+
+    ukv_options_t const options,
+
+    ukv_arena_t* arena,
+    ukv_callback_t callback,
+    void* user_data,
+    ukv_future_t* future,
+    ukv_error_t* error);
+
+/**
+ * @brief Submits a `ukv_scan`, returning before it's executed.
+ * The found keys are exported into @p arena right before the @p callback.
+ *
+ * @param[in] callback      Invoked on completion. Can be NULL.
+ * @param[in] user_data     Passed to the @p callback.
+ * @param[out] future       Will contain the handle of the operation. Can be NULL.
+ * @param[out] error        Reports failed submissions only, @see `ukv_future_wait`.
+ */
+void ukv_scan_async( //
+    ukv_t const db,
+    ukv_txn_t const txn,
+    ukv_size_t const tasks_count,
+
+    ukv_col_t const* collections,
+    ukv_size_t const collections_stride,
+
+    ukv_key_t const* min_keys,
+    ukv_size_t const min_keys_stride,
+
+    ukv_size_t const* scan_lengths,
+    ukv_size_t const scan_lengths_stride,
+
+    ukv_options_t const options,
+
+    ukv_key_t** found_keys,
+    ukv_val_len_t** found_lengths,
+
+    ukv_arena_t* arena,
+    ukv_callback_t callback,
+    void* user_data,
+    ukv_future_t* future,
+    ukv_error_t* error);
+
+/**
+ * @brief Checks if the operation has completed, without blocking.
+ * Passing NULLs is safe, as those are always ready.
+ */
+bool ukv_future_ready(ukv_future_t const future);
+
+/**
+ * @brief Blocks until the operation completes.
+ * @param[out] error        The error of the operation, valid until the @p future is freed.
+ */
+void ukv_future_wait(ukv_future_t const future, ukv_error_t* error);
+
+/**
+ * @brief Releases the handle of an operation, which may still be running.
+ * Passing NULLs is safe.
+ */
+void ukv_future_free(ukv_t const db, ukv_future_t const future);
+
+#ifdef __cplusplus
+} /* end extern "C" */
+#endif
@@ -0,0 +1,160 @@
+/**
+ * @file async.hpp
+ * @author Ashot Vardanian
+ * @date 20 Aug 2022
+ * @brief C++ bindings for @see "ukv/async.h".
+ */
+
+#pragma once
+#include <atomic>      // `std::atomic`
+#include <algorithm>   // `std::find`
+#include <memory>      // `std::unique_ptr`
+#include <type_traits> // `std::conditional_t`
+
+#include "ukv/ukv.h"
+#include "ukv/async.h"
+#include "ukv/cpp/types.hpp"  // `arena_t`
+#include "ukv/cpp/status.hpp" // `status_t`
+#include "ukv/cpp/ranges.hpp" // `tape_view_t`
+
+namespace unum::ukv {
+
+/**
+ * @brief Operation in flight, submitted through @see "ukv/async.h".
+ * Owns the arena, receiving the outputs, so any number of those can be
+ * in flight at once, and the outputs stay valid until this object dies.
+ *
+ * Can be polled with `ready()`, blocked on with `wait()`, or awaited from
+ * C++20 coroutines, without this header requiring C++20:
+ *
+ *      tape_view_t values = *co_await col.read_async(keys);
+ *
+ * The coroutine is resumed from the pool thread, that executed the batch.
+ *
+ * @section Class Specs
+ * > Concurrency: Must be awaited or waited from one thread at a time.
+ * > Lifetime: Waits for the operation to complete on destruction.
+ *   Must live shorter then the DB, and the keys and values passed into it.
+ * > Copyable: No.
+ * > Exceptions: Never.
+ */
+template <typename result_at>
+class [[nodiscard]] async_gt {
+  public:
+    using expected_t = std::conditional_t<std::is_void_v<result_at>, status_t, expected_gt<result_at>>;
+
+    /// Everything, that the pool thread may touch, has a stable address.
+    struct state_t {
+        ukv_future_t future = nullptr;
+        arena_t arena;
+        ukv_error_t error = nullptr;
+        std::atomic<void*> continuation {nullptr};
+        void (*resume)(void*) = nullptr;
+
+        // Arguments, that must outlive the submission
+        ukv_col_t col = ukv_col_main_k;
+        ukv_key_t min_key = 0;
+        ukv_size_t length = 0;
+
+        // Outputs
+        ukv_val_ptr_t values = nullptr;
+        ukv_val_len_t* offsets = nullptr;
+        ukv_val_len_t* lengths = nullptr;
+        ukv_key_t* keys = nullptr;
+
+        state_t(ukv_t db) noexcept : arena(db) {}
+        ~state_t() noexcept { ukv_future_free(arena.db(), future); }
+    };
+
+  private:
+    std::unique_ptr<state_t> state_;
+
+    static inline char done_k = 0;
+    static void* done() noexcept { return &done_k; }
+
+    template <typename handle_at>
+    static void resume_gt(void* address) noexcept {
+        handle_at::from_address(address).resume();
+    }
+
+  public:
+    async_gt(ukv_t db) noexcept : state_(new (std::nothrow) state_t(db)) {}
+    async_gt(async_gt&&) noexcept = default;
+    async_gt& operator=(async_gt&&) noexcept = default;
+    async_gt(async_gt const&) = delete;
+    async_gt& operator=(async_gt const&) = delete;
+
+    ~async_gt() noexcept {
+        // If the coroutine was resumed by the completion callback, the operation is over
+        if (state_ && state_->continuation.load() != done()) {
+            ukv_error_t ignored = nullptr;
+            ukv_future_wait(state_->future, &ignored);
+        }
+    }
+
+    inline state_t* state() noexcept { return state_.get(); }
+    inline ukv_future_t* future_ptr() noexcept { return &state_->future; }
+    inline ukv_arena_t* arena_ptr() noexcept { return state_->arena.member_ptr(); }
+
+    /// Passed to @see "ukv/async.h" as the `ukv_callback_t` with `state()` as `user_data`.
+    static void on_complete(void* user_data, ukv_error_t error) noexcept {
+        state_t& state = *reinterpret_cast<state_t*>(user_data);
+        state.error = error;
+        void* continuation = state.continuation.exchange(done());
+        if (continuation)
+            state.resume(continuation);
+    }
+
+    /// Marks operations, that failed on submission, as completed.
+    /// The pool thread may already be writing the `state_t::error`, so it's passed separately.
+    void submitted(ukv_error_t error) noexcept {
+        if (!error)
+            return;
+        state_->error = error;
+        state_->continuation.store(done());
+    }
+
+    bool ready() const noexcept { return !state_ || state_->continuation.load() == done(); }
+
+    void wait() noexcept {
+        if (ready())
+            return;
+        ukv_error_t ignored = nullptr;
+        ukv_future_wait(state_->future, &ignored);
+    }
+
+    expected_t get() noexcept {
+        if (!state_)
+            return status_t {"Failed to allocate memory!"};
+        wait();
+        status_t status {std::exchange(state_->error, nullptr)};
+        if constexpr (std::is_void_v<result_at>)
+            return status;
+        else {
+            if (!status)
+                return status;
+            if constexpr (std::is_same_v<result_at, tape_view_t>)
+                return tape_view_t {state_->values, state_->offsets, state_->lengths, state_->length};
+            else {
+                ukv_key_t* end = std::find(state_->keys, state_->keys + state_->length, ukv_key_unknown_k);
+                return result_at {state_->keys, end};
+            }
+        }
+    }
+
+    bool await_ready() const noexcept { return ready(); }
+
+    template <typename handle_at>
+    bool await_suspend(handle_at handle) noexcept {
+        state_->resume = &resume_gt<handle_at>;
+        void* expected = nullptr;
+        return state_->continuation.compare_exchange_strong(expected, handle.address());
+    }
+
+    expected_t await_resume() noexcept { return get(); }
+};
+
+/// Keys found by `col_t::scan_async`.
+using keys_span_t = indexed_range_gt<ukv_key_t*>;
+
+} // namespace unum::ukv
@@ -15,6 +15,7 @@
 #include "ukv/cpp/members_range.hpp"
 #include "ukv/cpp/graph_ref.hpp"
 #include "ukv/cpp/docs.hpp"
+#include "ukv/cpp/async.hpp"
 
 namespace unum::ukv {
 
@@ -122,6 +123,82 @@ class col_t {
         return (maybe->min + maybe->max) / 2;
     }
 
+    /**
+     * @brief Removes all the entries with keys in `[min_key, max_key)` at once.
+     * Bypasses the transaction, if any was set, @see `ukv_remove_range`.
+     */
+    status_t remove_range( //
+        ukv_key_t min_key = std::numeric_limits<ukv_key_t>::min(),
+        ukv_key_t max_key = ukv_key_unknown_k,
+        bool flush = false) noexcept {
+        status_t status;
+        auto options = flush ? ukv_option_write_flush_k : ukv_options_default_k;
+        ukv_remove_range(db_, 1, &col_, 0, &min_key, 0, &max_key, 0, options, arena_.member_ptr(), status.member_ptr());
+        return status;
+    }
+
+    /**
+     * @brief Submits a batched read, without waiting for it to complete.
+     * The @p keys must outlive the returned object, @see `async_gt`.
+     */
+    async_gt<tape_view_t> read_async(keys_view_t keys, bool track = false) const noexcept {
+        ukv_error_t error = nullptr;
+        async_gt<tape_view_t> result {db_};
+        auto state = result.state();
+        if (!state)
+            return result;
+        state->col = col_;
+        state->length = static_cast<ukv_size_t>(keys.size());
+        auto options = track ? ukv_option_read_track_k : ukv_options_default_k;
+        ukv_read_async(db_, txn_, state->length, &state->col, 0, keys.begin().get(), keys.stride(), options, //
+                       &state->values, &state->offsets, &state->lengths, result.arena_ptr(),
+                       &async_gt<tape_view_t>::on_complete, state, result.future_ptr(), &error);
+        result.submitted(error);
+        return result;
+    }
+
+    /**
+     * @brief Submits a batched write, without waiting for it to complete.
+     * The @p keys and @p values must outlive the returned object, @see `async_gt`.
+     */
+    async_gt<void> write_async(keys_view_t keys, values_arg_t values, bool flush = false) const noexcept {
+        ukv_error_t error = nullptr;
+        async_gt<void> result {db_};
+        auto state = result.state();
+        if (!state)
+            return result;
+        state->col = col_;
+        auto options = flush ? ukv_option_write_flush_k : ukv_options_default_k;
+        ukv_write_async(db_, txn_, static_cast<ukv_size_t>(keys.size()), &state->col, 0, //
+                        keys.begin().get(), keys.stride(),
+                        values.contents_begin.get(), values.contents_begin.stride(),
+                        values.offsets_begin.get(), values.offsets_begin.stride(),
+                        values.lengths_begin.get(), values.lengths_begin.stride(),
+                        options, result.arena_ptr(),
+                        &async_gt<void>::on_complete, state, result.future_ptr(), &error);
+        result.submitted(error);
+        return result;
+    }
+
+    /**
+     * @brief Submits a scan of upto @p length keys, starting from @p min_key.
+     */
+    async_gt<keys_span_t> scan_async(ukv_key_t min_key, ukv_size_t length) const noexcept {
+        ukv_error_t error = nullptr;
+        async_gt<keys_span_t> result {db_};
+        auto state = result.state();
+        if (!state)
+            return result;
+        state->col = col_;
+        state->min_key = min_key;
+        state->length = length;
+        ukv_scan_async(db_, txn_, 1, &state->col, 0, &state->min_key, 0, &state->length, 0, ukv_options_default_k, //
+                       &state->keys, &state->lengths, result.arena_ptr(),
+                       &async_gt<keys_span_t>::on_complete, state, result.future_ptr(), &error);
+        result.submitted(error);
+        return result;
+    }
+
     inline members_ref_gt<keys_arg_t> operator[](std::initializer_list<ukv_key_t> keys) noexcept { return at(keys); }
     inline members_ref_gt<keys_arg_t> at(std::initializer_list<ukv_key_t> keys) noexcept { //
         return at(strided_range(keys));
@@ -359,10 +436,16 @@ class db_t : public std::enable_shared_from_this<db_t> {
     operator expected_gt<col_t>() noexcept { return collection(""); }
     expected_gt<col_t> operator*() noexcept { return collection(""); }
 
-    expected_gt<col_t> collection(ukv_str_view_t name = "", ukv_format_t format = ukv_format_binary_k) noexcept {
+    /**
+     * @param config Backend-specific collection config, like the compression settings.
+     * @see `ukv_col_open`.
+     */
+    expected_gt<col_t> collection(ukv_str_view_t name = "",
+                                  ukv_format_t format = ukv_format_binary_k,
+                                  ukv_str_view_t config = nullptr) noexcept {
         status_t status;
         ukv_col_t col = ukv_col_main_k;
-        ukv_col_open(db_, name, nullptr, &col, status.member_ptr());
+        ukv_col_open(db_, name, config, &col, status.member_ptr());
         if (!status)
             return status;
         else
@@ -13,6 +13,27 @@
 
 namespace unum::ukv {
 
+/**
+ * @brief Vertices reached by `ukv_graph_traverse`, with their depths
+ * and the edges, through which all but the starts were discovered.
+ */
+struct traversal_t {
+    indexed_range_gt<ukv_key_t*> vertices;
+    indexed_range_gt<ukv_size_t*> depths;
+    edges_span_t edges;
+};
+
+/**
+ * @brief Compressed Sparse Row view of a graph, exported by `ukv_graph_export_csr`.
+ * The neighbors of `vertices[i]` are `neighbors[offsets[i] : offsets[i + 1]]`.
+ */
+struct csr_t {
+    indexed_range_gt<ukv_key_t*> vertices;
+    indexed_range_gt<ukv_size_t*> offsets;
+    indexed_range_gt<ukv_key_t*> neighbors;
+    indexed_range_gt<ukv_key_t*> edges;
+};
+
 /**
  * @brief Wraps relational/linking operations with cleaner type system.
  * Controls mainly just the inverted index collection and keeps a local
@@ -319,6 +340,96 @@ class graph_ref_t {
         return strided_range_gt<ukv_key_t> {es.target_ids};
     }
 
+    /**
+     * @brief Breadth-First expansion from @p starts, evaluated on the server side.
+     * @see `ukv_graph_traverse` for the meaning of arguments.
+     */
+    expected_gt<traversal_t> traverse( //
+        strided_range_gt<ukv_key_t const> starts,
+        ukv_size_t max_depth,
+        ukv_vertex_role_t role = ukv_vertex_source_k,
+        ukv_size_t max_visits = 0,
+        bool track = false) noexcept {
+
+        status_t status;
+        ukv_size_t count = 0;
+        ukv_key_t* vertices = nullptr;
+        ukv_size_t* depths = nullptr;
+        ukv_key_t* edges = nullptr;
+
+        ukv_graph_traverse( //
+            db_,
+            txn_,
+            col_,
+            starts.count(),
+            starts.begin().get(),
+            starts.stride(),
+            role,
+            max_depth,
+            max_visits,
+            track ? ukv_option_read_track_k : ukv_options_default_k,
+            &count,
+            &vertices,
+            &depths,
+            &edges,
+            arena_,
+            status.member_ptr());
+        if (!status)
+            return status;
+
+        auto count_starts = std::find_if(depths, depths + count, [](ukv_size_t d) { return d != 0; }) - depths;
+        auto edges_begin = reinterpret_cast<edge_t*>(edges);
+        return traversal_t {
+            {vertices, vertices + count},
+            {depths, depths + count},
+            edges_span_t {edges_begin, edges_begin + (count - count_starts)},
+        };
+    }
+
+    /**
+     * @brief Exports the adjacency of all the vertices in `[min_key, max_key)`.
+     * @see `ukv_graph_export_csr` for the meaning of arguments.
+     */
+    expected_gt<csr_t> export_csr( //
+        ukv_vertex_role_t role = ukv_vertex_source_k,
+        bool export_edges = false,
+        ukv_key_t min_key = std::numeric_limits<ukv_key_t>::min(),
+        ukv_key_t max_key = std::numeric_limits<ukv_key_t>::max()) noexcept {
+
+        status_t status;
+        ukv_size_t count = 0;
+        ukv_key_t* vertices = nullptr;
+        ukv_size_t* offsets = nullptr;
+        ukv_key_t* neighbors = nullptr;
+        ukv_key_t* edges = nullptr;
+
+        ukv_graph_export_csr( //
+            db_,
+            txn_,
+            col_,
+            min_key,
+            max_key,
+            role,
+            ukv_options_default_k,
+            &count,
+            &vertices,
+            &offsets,
+            &neighbors,
+            export_edges ? &edges : nullptr,
+            arena_,
+            status.member_ptr());
+        if (!status)
+            return status;
+
+        ukv_size_t total = offsets[count];
+        return csr_t {
+            {vertices, vertices + count},
+            {offsets, offsets + count + 1},
+            {neighbors, neighbors + total},
+            {edges, edges ? edges + total : edges},
+        };
+    }
+
     status_t export_adjacency_list(std::string const& path,
                                    std::string_view column_separator,
                                    std::string_view line_delimiter);
@@ -6,6 +6,10 @@
  */
 
 #pragma once
+#include <future> // `std::async`
+#include <memory> // `std::unique_ptr`
+#include <new>    // `std::nothrow`
+
 #include "ukv/ukv.h"
 #include "ukv/cpp/ranges.hpp" // `indexed_range_gt`
 
@@ -19,67 +23,250 @@ struct size_range_t;
 struct size_estimates_t;
 
 /**
- * @brief Iterator (almost) over the keys in a single collection.
- * Manages it's own memory and may be expressive to construct.
- * Prefer to `seek`, instead of re-creating such a stream.
- * Unlike classical iterators, keeps an internal state,
- * which makes it @b non copy-constructible!
- *
- * @section Class Specs
- * > Concurrency: Must be used from a single thread!
- * > Lifetime: @b Must live shorter then the collection it belongs to.
- * > Copyable: No.
- * > Exceptions: Never.
+ * @brief A batch of scanned keys, optionally with their values,
+ * and the memory they are stored in.
  */
+struct scan_batch_t {
+    arena_t arena_scan;
+    arena_t arena_read;
+    indexed_range_gt<ukv_key_t*> keys;
+    tape_view_t values;
+    ukv_key_t next_min_key = ukv_key_unknown_k;
+    status_t status;
 
-class keys_stream_t {
-
-    ukv_t db_ = nullptr;
-    ukv_col_t col_ = ukv_col_main_k;
-    ukv_txn_t txn_ = nullptr;
-
-    arena_t arena_;
-    ukv_size_t read_ahead_ = 0;
-
-    ukv_key_t next_min_key_ = std::numeric_limits<ukv_key_t>::min();
-    indexed_range_gt<ukv_key_t*> fetched_keys_;
-    std::size_t fetched_offset_ = 0;
+    scan_batch_t(ukv_t db) noexcept : arena_scan(db), arena_read(db) {}
 
-    status_t prefetch() noexcept {
-
-        if (next_min_key_ == ukv_key_unknown_k)
-            return {};
+    /**
+     * @brief Scans up to `read_ahead` keys starting from `min_key` and, optionally, reads their values.
+     * Only touches the memory of this batch, so may be called from any thread.
+     */
+    void fetch(ukv_t db,
+               ukv_txn_t txn,
+               ukv_col_t col,
+               ukv_key_t min_key,
+               ukv_size_t read_ahead,
+               bool with_values) noexcept {
+
+        keys = {};
+        values = {};
+        next_min_key = ukv_key_unknown_k;
+        status = {};
+        if (min_key == ukv_key_unknown_k)
+            return;
 
         ukv_key_t* found_keys = nullptr;
         ukv_val_len_t* found_lens = nullptr;
-        status_t status;
         ukv_scan( //
-            db_,
-            txn_,
+            db,
+            txn,
             1,
-            &col_,
+            &col,
             0,
-            &next_min_key_,
+            &min_key,
             0,
-            &read_ahead_,
+            &read_ahead,
             0,
             ukv_options_default_k,
             &found_keys,
             &found_lens,
-            arena_.member_ptr(),
+            arena_scan.member_ptr(),
             status.member_ptr());
         if (!status)
-            return status;
+            return;
 
-        auto present_end = std::find(found_keys, found_keys + read_ahead_, ukv_key_unknown_k);
-        fetched_keys_ = indexed_range_gt<ukv_key_t*> {found_keys, present_end};
-        fetched_offset_ = 0;
+        auto present_end = std::find(found_keys, found_keys + read_ahead, ukv_key_unknown_k);
+        auto count = static_cast<ukv_size_t>(present_end - found_keys);
+        keys = indexed_range_gt<ukv_key_t*> {found_keys, present_end};
+        next_min_key = count && count == read_ahead ? found_keys[count - 1] + 1 : ukv_key_unknown_k;
+        if (!with_values || !count)
+            return;
 
-        auto count = static_cast<ukv_size_t>(fetched_keys_.size());
-        next_min_key_ = count <= read_ahead_ ? ukv_key_unknown_k : fetched_keys_[count - 1] + 1;
+        ukv_val_ptr_t found_vals = nullptr;
+        ukv_val_len_t* found_offs = nullptr;
+        ukv_read( //
+            db,
+            txn,
+            count,
+            &col,
+            0,
+            found_keys,
+            sizeof(ukv_key_t),
+            ukv_options_default_k,
+            &found_vals,
+            &found_offs,
+            &found_lens,
+            arena_read.member_ptr(),
+            status.member_ptr());
+        if (!status)
+            return;
+
+        values = tape_view_t {found_vals, found_offs, found_lens, count};
+    }
+};
+
+/**
+ * @brief Double-buffered fetching of consecutive scan batches.
+ * With `prefetch` enabled, the following batch is fetched on a background thread,
+ * while the current one is being consumed, hiding the latency of the next scan.
+ *
+ * Batches are allocated on the heap, so the background task is unaffected
+ * if the fetcher is moved. Destructing or re-seeking waits for it to finish.
+ */
+class scan_fetcher_t {
+
+    ukv_t db_ = nullptr;
+    ukv_col_t col_ = ukv_col_main_k;
+    ukv_txn_t txn_ = nullptr;
+    ukv_size_t read_ahead_ = 0;
+    bool with_values_ = false;
+    bool prefetch_ = false;
+
+    std::unique_ptr<scan_batch_t> current_;
+    std::unique_ptr<scan_batch_t> upcoming_;
+    ukv_key_t upcoming_min_key_ = ukv_key_unknown_k;
+    // Declared last, to be destroyed first, while the batches are still alive
+    std::future<void> pending_;
+
+    void wait() noexcept {
+        if (pending_.valid())
+            pending_.get();
+    }
+
+    void schedule(ukv_key_t min_key) noexcept {
+        upcoming_min_key_ = ukv_key_unknown_k;
+        if (!prefetch_ || min_key == ukv_key_unknown_k)
+            return;
+
+        try {
+            pending_ = std::async(std::launch::async,
+                                  [batch = upcoming_.get(),
+                                   db = db_,
+                                   txn = txn_,
+                                   col = col_,
+                                   min_key,
+                                   read_ahead = read_ahead_,
+                                   with_values = with_values_] {
+                                      batch->fetch(db, txn, col, min_key, read_ahead, with_values);
+                                  });
+            upcoming_min_key_ = min_key;
+        }
+        catch (...) {
+            // If no thread can be spawned, the next batch is fetched synchronously
+        }
+    }
+
+    status_t allocate() noexcept {
+        if (current_)
+            return {};
+        current_.reset(new (std::nothrow) scan_batch_t(db_));
+        upcoming_.reset(new (std::nothrow) scan_batch_t(db_));
+        if (!current_ || !upcoming_) {
+            current_.reset();
+            return status_t {"Out of memory!"};
+        }
         return {};
     }
 
+  public:
+    scan_fetcher_t(ukv_t db, ukv_col_t col, ukv_txn_t txn, std::size_t read_ahead, bool with_values, bool prefetch)
+        : db_(db), col_(col), txn_(txn), read_ahead_(static_cast<ukv_size_t>(read_ahead)), with_values_(with_values),
+          prefetch_(prefetch) {}
+
+    scan_fetcher_t(scan_fetcher_t&&) = default;
+    ~scan_fetcher_t() { wait(); }
+
+    /// Our pending task may still be writing into the batches we are about to free.
+    scan_fetcher_t& operator=(scan_fetcher_t&& other) noexcept {
+        wait();
+        db_ = other.db_;
+        col_ = other.col_;
+        txn_ = other.txn_;
+        read_ahead_ = other.read_ahead_;
+        with_values_ = other.with_values_;
+        prefetch_ = other.prefetch_;
+        pending_ = std::move(other.pending_);
+        current_ = std::move(other.current_);
+        upcoming_ = std::move(other.upcoming_);
+        upcoming_min_key_ = other.upcoming_min_key_;
+        return *this;
+    }
+
+    /**
+     * @brief Synchronously fetches the batch starting at `key`, and schedules the next one.
+     */
+    status_t seek(ukv_key_t key) noexcept {
+        if (status_t status = allocate(); !status)
+            return status;
+
+        wait();
+        current_->fetch(db_, txn_, col_, key, read_ahead_, with_values_);
+        if (current_->status)
+            schedule(current_->next_min_key);
+        return std::exchange(current_->status, status_t {});
+    }
+
+    /**
+     * @brief Replaces the current batch with the following one,
+     * waiting for the background task, if it was scheduled.
+     */
+    status_t fetch_next() noexcept {
+        if (!current_)
+            return {};
+
+        ukv_key_t min_key = current_->next_min_key;
+        bool was_scheduled = min_key != ukv_key_unknown_k && upcoming_min_key_ == min_key;
+        wait();
+        if (!was_scheduled)
+            upcoming_->fetch(db_, txn_, col_, min_key, read_ahead_, with_values_);
+
+        std::swap(current_, upcoming_);
+        if (current_->status)
+            schedule(current_->next_min_key);
+        else
+            upcoming_min_key_ = ukv_key_unknown_k;
+        return std::exchange(current_->status, status_t {});
+    }
+
+    /**
+     * @brief Forgets the fetched batch and the scheduled one.
+     */
+    void reset() noexcept {
+        wait();
+        upcoming_min_key_ = ukv_key_unknown_k;
+        if (current_)
+            current_->keys = {}, current_->values = {}, current_->next_min_key = ukv_key_unknown_k;
+    }
+
+    indexed_range_gt<ukv_key_t*> keys() const noexcept {
+        return current_ ? current_->keys : indexed_range_gt<ukv_key_t*> {};
+    }
+    tape_view_t values() const noexcept { return current_ ? current_->values : tape_view_t {}; }
+    ukv_key_t next_min_key() const noexcept { return current_ ? current_->next_min_key : ukv_key_unknown_k; }
+};
+
+/**
+ * @brief Iterator (almost) over the keys in a single collection.
+ * Manages it's own memory and may be expressive to construct.
+ * Prefer to `seek`, instead of re-creating such a stream.
+ * Unlike classical iterators, keeps an internal state,
+ * which makes it @b non copy-constructible!
+ *
+ * Keys are fetched in batches of `read_ahead` elements. With `prefetch`
+ * enabled, the following batch is scanned on a background thread.
+ *
+ * @section Class Specs
+ * > Concurrency: Must be used from a single thread!
+ * > Lifetime: @b Must live shorter then the collection it belongs to.
+ * > Copyable: No.
+ * > Exceptions: Never.
+ */
+
+class keys_stream_t {
+
+    ukv_col_t col_ = ukv_col_main_k;
+    scan_fetcher_t fetcher_;
+    std::size_t fetched_offset_ = 0;
+
   public:
     using iterator_category = std::forward_iterator_tag;
     using difference_type = std::ptrdiff_t;
@@ -92,8 +279,9 @@ class keys_stream_t {
     keys_stream_t(ukv_t db,
                   ukv_col_t col = ukv_col_main_k,
                   std::size_t read_ahead = keys_stream_t::default_read_ahead_k,
-                  ukv_txn_t txn = nullptr)
-        : db_(db), col_(col), txn_(txn), arena_(db), read_ahead_(static_cast<ukv_size_t>(read_ahead)) {}
+                  ukv_txn_t txn = nullptr,
+                  bool prefetch = false)
+        : col_(col), fetcher_(db, col, txn, read_ahead, false, prefetch) {}
 
     keys_stream_t(keys_stream_t&&) = default;
     keys_stream_t& operator=(keys_stream_t&&) = default;
@@ -102,19 +290,17 @@ class keys_stream_t {
     keys_stream_t& operator=(keys_stream_t const&) = delete;
 
     status_t seek(ukv_key_t key) noexcept {
-        fetched_keys_ = {};
         fetched_offset_ = 0;
-        next_min_key_ = key;
-        return prefetch();
+        return fetcher_.seek(key);
     }
 
     status_t advance() noexcept {
 
-        if (fetched_offset_ >= fetched_keys_.size())
-            return prefetch();
+        if (++fetched_offset_ < fetcher_.keys().size() || fetcher_.next_min_key() == ukv_key_unknown_k)
+            return {};
 
-        ++fetched_offset_;
-        return {};
+        fetched_offset_ = 0;
+        return fetcher_.fetch_next();
     }
 
     /**
@@ -127,28 +313,31 @@ class keys_stream_t {
         if (status)
             return *this;
 
-        fetched_keys_ = {};
+        fetcher_.reset();
         fetched_offset_ = 0;
-        next_min_key_ = ukv_key_unknown_k;
         return *this;
     }
 
-    ukv_key_t key() const noexcept { return fetched_keys_[fetched_offset_]; }
+    ukv_key_t key() const noexcept { return fetcher_.keys()[fetched_offset_]; }
     ukv_key_t operator*() const noexcept { return key(); }
     status_t seek_to_first() noexcept { return seek(std::numeric_limits<ukv_key_t>::min()); }
-    status_t seek_to_next_batch() noexcept { return seek(next_min_key_); }
+    status_t seek_to_next_batch() noexcept {
+        fetched_offset_ = 0;
+        return fetcher_.fetch_next();
+    }
 
     /**
      * @brief Exposes all the fetched keys at once, including the passed ones.
      * Should be used with `seek_to_next_batch`. Next `advance` will do the same.
      */
     indexed_range_gt<ukv_key_t const*> keys_batch() noexcept {
-        fetched_offset_ = fetched_keys_.size();
-        return {fetched_keys_.begin(), fetched_keys_.end()};
+        auto keys = fetcher_.keys();
+        fetched_offset_ = keys.size();
+        return {keys.begin(), keys.end()};
     }
 
     bool is_end() const noexcept {
-        return next_min_key_ == ukv_key_unknown_k && fetched_offset_ >= fetched_keys_.size();
+        return fetcher_.next_min_key() == ukv_key_unknown_k && fetched_offset_ >= fetcher_.keys().size();
     }
 
     bool operator==(keys_stream_t const& other) const noexcept {
@@ -170,74 +359,10 @@ class keys_stream_t {
 
 class pairs_stream_t {
 
-    ukv_t db_ = nullptr;
     ukv_col_t col_ = ukv_col_main_k;
-    ukv_txn_t txn_ = nullptr;
-
-    arena_t arena_scan_;
-    arena_t arena_read_;
-    ukv_size_t read_ahead_ = 0;
-
-    ukv_key_t next_min_key_ = std::numeric_limits<ukv_key_t>::min();
-    indexed_range_gt<ukv_key_t*> fetched_keys_;
-    tape_view_t values_view;
+    scan_fetcher_t fetcher_;
     std::size_t fetched_offset_ = 0;
 
-    status_t prefetch() noexcept {
-
-        if (next_min_key_ == ukv_key_unknown_k)
-            return {};
-
-        ukv_key_t* found_keys = nullptr;
-        ukv_val_len_t* found_offs = nullptr;
-        ukv_val_len_t* found_lens = nullptr;
-        ukv_val_ptr_t found_vals = nullptr;
-        status_t status;
-        ukv_scan( //
-            db_,
-            txn_,
-            1,
-            &col_,
-            0,
-            &next_min_key_,
-            0,
-            &read_ahead_,
-            0,
-            ukv_options_default_k,
-            &found_keys,
-            &found_lens,
-            arena_scan_.member_ptr(),
-            status.member_ptr());
-        if (!status)
-            return status;
-
-        auto present_end = std::find(found_keys, found_keys + read_ahead_, ukv_key_unknown_k);
-        fetched_keys_ = indexed_range_gt<ukv_key_t*> {found_keys, present_end};
-        fetched_offset_ = 0;
-        auto count = static_cast<ukv_size_t>(fetched_keys_.size());
-
-        ukv_read( //
-            db_,
-            txn_,
-            count,
-            &col_,
-            0,
-            found_keys,
-            sizeof(ukv_key_t),
-            ukv_options_default_k,
-            &found_vals,
-            &found_offs,
-            &found_lens,
-            arena_read_.member_ptr(),
-            status.member_ptr());
-        if (!status)
-            return status;
-
-        values_view = tape_view_t {found_vals, found_offs, found_lens, count};
-        next_min_key_ = count <= read_ahead_ ? ukv_key_unknown_k : fetched_keys_[count - 1] + 1;
-        return {};
-    }
-
   public:
     using iterator_category = std::forward_iterator_tag;
     using difference_type = std::ptrdiff_t;
@@ -248,9 +373,9 @@ class pairs_stream_t {
     pairs_stream_t(ukv_t db,
                    ukv_col_t col = ukv_col_main_k,
                    std::size_t read_ahead = pairs_stream_t::default_read_ahead_k,
-                   ukv_txn_t txn = nullptr)
-        : db_(db), col_(col), txn_(txn), arena_scan_(db_), arena_read_(db_),
-          read_ahead_(static_cast<ukv_size_t>(read_ahead)) {}
+                   ukv_txn_t txn = nullptr,
+                   bool prefetch = false)
+        : col_(col), fetcher_(db, col, txn, read_ahead, true, prefetch) {}
 
     pairs_stream_t(pairs_stream_t&&) = default;
     pairs_stream_t& operator=(pairs_stream_t&&) = default;
@@ -259,19 +384,17 @@ class pairs_stream_t {
     pairs_stream_t& operator=(pairs_stream_t const&) = delete;
 
     status_t seek(ukv_key_t key) noexcept {
-        fetched_keys_ = {};
         fetched_offset_ = 0;
-        next_min_key_ = key;
-        return prefetch();
+        return fetcher_.seek(key);
     }
 
     status_t advance() noexcept {
 
-        if (fetched_offset_ >= fetched_keys_.size())
-            return prefetch();
+        if (++fetched_offset_ < fetcher_.keys().size() || fetcher_.next_min_key() == ukv_key_unknown_k)
+            return {};
 
-        ++fetched_offset_;
-        return {};
+        fetched_offset_ = 0;
+        return fetcher_.fetch_next();
     }
 
     /**
@@ -284,41 +407,42 @@ class pairs_stream_t {
         if (status)
             return *this;
 
-        fetched_keys_ = {};
+        fetcher_.reset();
         fetched_offset_ = 0;
-        next_min_key_ = ukv_key_unknown_k;
         return *this;
     }
 
-    ukv_key_t key() const noexcept { return fetched_keys_[fetched_offset_]; }
+    ukv_key_t key() const noexcept { return fetcher_.keys()[fetched_offset_]; }
     value_view_t value() const noexcept {
-        auto it = values_view.begin();
-        for (size_t i = 0; i != fetched_offset_; ++i)
-            ++it;
-        return *it;
-    }
-    value_type item() const noexcept {
-        auto it = values_view.begin();
-        for (size_t i = 0; i != fetched_offset_; ++i)
-            ++it;
-        return std::make_pair(fetched_keys_[fetched_offset_], *it);
+        tape_view_t values = fetcher_.values();
+        return {values.contents() + values.offsets()[fetched_offset_], values.lengths()[fetched_offset_]};
     }
+    value_type item() const noexcept { return std::make_pair(key(), value()); }
     value_type operator*() const noexcept { return item(); }
 
     status_t seek_to_first() noexcept { return seek(std::numeric_limits<ukv_key_t>::min()); }
-    status_t seek_to_next_batch() noexcept { return seek(next_min_key_); }
+    status_t seek_to_next_batch() noexcept {
+        fetched_offset_ = 0;
+        return fetcher_.fetch_next();
+    }
 
     /**
      * @brief Exposes all the fetched keys at once, including the passed ones.
      * Should be used with `seek_to_next_batch`. Next `advance` will do the same.
      */
     indexed_range_gt<ukv_key_t const*> keys_batch() noexcept {
-        fetched_offset_ = fetched_keys_.size();
-        return {fetched_keys_.begin(), fetched_keys_.end()};
+        auto keys = fetcher_.keys();
+        fetched_offset_ = keys.size();
+        return {keys.begin(), keys.end()};
     }
 
+    /**
+     * @brief Exposes all the fetched values at once, matching the `keys_batch`.
+     */
+    tape_view_t values_batch() noexcept { return fetcher_.values(); }
+
     bool is_end() const noexcept {
-        return next_min_key_ == ukv_key_unknown_k && fetched_offset_ >= fetched_keys_.size();
+        return fetcher_.next_min_key() == ukv_key_unknown_k && fetched_offset_ >= fetcher_.keys().size();
     }
 
     bool operator==(pairs_stream_t const& other) const noexcept {
@@ -374,8 +498,9 @@ class members_range_t {
     template <typename stream_at>
     expected_gt<stream_at> make_stream( //
         ukv_key_t target,
-        std::size_t read_ahead = keys_stream_t::default_read_ahead_k) noexcept {
-        stream_at stream {db_, col_, read_ahead, txn_};
+        std::size_t read_ahead = keys_stream_t::default_read_ahead_k,
+        bool prefetch = false) noexcept {
+        stream_at stream {db_, col_, read_ahead, txn_, prefetch};
         status_t status = stream.seek(target);
         return {std::move(status), std::move(stream)};
     }
@@ -393,16 +518,24 @@ class members_range_t {
     members_range_t(members_range_t const&) = default;
     members_range_t& operator=(members_range_t const&) = default;
 
-    expected_gt<keys_stream_t> keys_begin(std::size_t read_ahead = keys_stream_t::default_read_ahead_k) noexcept {
-        return make_stream<keys_stream_t>(min_key_, read_ahead);
+    /**
+     * @param read_ahead Number of keys fetched in every batch.
+     * @param prefetch Whether to fetch the next batch in background, while the current one is consumed.
+     */
+    expected_gt<keys_stream_t> keys_begin( //
+        std::size_t read_ahead = keys_stream_t::default_read_ahead_k,
+        bool prefetch = false) noexcept {
+        return make_stream<keys_stream_t>(min_key_, read_ahead, prefetch);
     }
 
     expected_gt<keys_stream_t> keys_end() noexcept {
         return make_stream<keys_stream_t>(max_key_, max_key_ == ukv_key_unknown_k ? 0u : 1u);
     }
 
-    expected_gt<pairs_stream_t> pairs_begin(std::size_t read_ahead = pairs_stream_t::default_read_ahead_k) noexcept {
-        return make_stream<pairs_stream_t>(min_key_, read_ahead);
+    expected_gt<pairs_stream_t> pairs_begin( //
+        std::size_t read_ahead = pairs_stream_t::default_read_ahead_k,
+        bool prefetch = false) noexcept {
+        return make_stream<pairs_stream_t>(min_key_, read_ahead, prefetch);
     }
 
     expected_gt<pairs_stream_t> pairs_end() noexcept {
@@ -126,7 +126,7 @@ class strided_range_gt {
 
     inline auto immutable() const noexcept { return strided_range_gt<object_at const>(begin_, stride_, count_); }
     inline strided_range_gt subspan(std::size_t offset, std::size_t count) const noexcept {
-        return {begin_ + offset * stride_, stride_, count};
+        return {(begin() + static_cast<std::ptrdiff_t>(offset)).get(), stride_, count};
     }
 
     inline bool empty() const noexcept { return !count_; }
@@ -326,6 +326,25 @@ element_at reduce_n(iterator_at begin, std::size_t n, element_at init) {
     return transform_reduce_n(begin, n, init, [](auto x) { return x; });
 }
 
+/**
+ * @brief Handles the zero-strided and contiguous layouts separately from the general case.
+ * The former is a multiplication, and the latter is a plain loop, which compilers vectorize.
+ */
+template <typename element_at, typename object_at>
+element_at reduce_n(strided_iterator_gt<object_at> begin, std::size_t n, element_at init) {
+    if (!n)
+        return init;
+    if (begin.repeats())
+        return init + static_cast<element_at>(*begin) * static_cast<element_at>(n);
+    if (begin.stride() != sizeof(object_at))
+        return transform_reduce_n(begin, n, init, [](auto x) { return x; });
+
+    object_at* const contiguous = begin.get();
+    for (std::size_t i = 0; i != n; ++i)
+        init += contiguous[i];
+    return init;
+}
+
 template <typename iterator_at>
 bool all_ascending(iterator_at begin, std::size_t n) {
     auto previous = begin;
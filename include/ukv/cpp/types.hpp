@@ -8,6 +8,7 @@
 
 #pragma once
 #include <functional> // `std::hash`
+#include <utility>    // `std::exchange`
 
 #include "ukv/ukv.h"
 
@@ -37,10 +38,12 @@ struct col_key_t {
 
     inline bool operator==(col_key_t const& other) const noexcept { return (col == other.col) & (key == other.key); }
     inline bool operator!=(col_key_t const& other) const noexcept { return (col != other.col) | (key != other.key); }
-    inline bool operator<(col_key_t const& other) const noexcept { return key < other.key; }
-    inline bool operator>(col_key_t const& other) const noexcept { return key > other.key; }
-    inline bool operator<=(col_key_t const& other) const noexcept { return key <= other.key; }
-    inline bool operator>=(col_key_t const& other) const noexcept { return key >= other.key; }
+    inline bool operator<(col_key_t const& other) const noexcept {
+        return (col < other.col) | ((col == other.col) & (key < other.key));
+    }
+    inline bool operator>(col_key_t const& other) const noexcept { return other < *this; }
+    inline bool operator<=(col_key_t const& other) const noexcept { return !(other < *this); }
+    inline bool operator>=(col_key_t const& other) const noexcept { return !(*this < other); }
 };
 
 struct col_key_field_t {
@@ -187,6 +190,7 @@ class arena_t {
     inline ukv_arena_t* member_ptr() noexcept { return &memory_; }
     inline operator ukv_arena_t*() & noexcept { return member_ptr(); }
     inline ukv_t db() const noexcept { return db_; }
+    inline std::size_t allocations() const noexcept { return ukv_arena_allocations(db_, memory_); }
 };
 
 class any_arena_t {
@@ -108,6 +108,8 @@ typedef enum {
      * snapshot is created. It guarantees that the global state of all the
      * keys in the DB will be unchanged during the entire lifetime of the
      * transaction. Will not affect the writes in any way.
+     * It isn't a promise of lock-free reads: implementations may still
+     * synchronize every read with concurrent writers, like the STL one does.
      */
     ukv_option_txn_snapshot_k = 1 << 4,
     /**
@@ -253,6 +255,76 @@ void ukv_write( //
     ukv_arena_t* arena,
     ukv_error_t* error);
 
+/**
+ * @brief Imports a big batch of entries, bypassing the regular write path,
+ * so that initial ingestion of datasets happens at disk bandwidth.
+ * Existing entries with the same keys are overwritten.
+ * Arguments match the ones of `ukv_write`, except for the transaction.
+ * Unlike `ukv_write`, the keys must be sorted and unique within every
+ * collection, and the values can't be NULL.
+ *
+ * @section Backends
+ * > RocksDB: builds SST files with `SstFileWriter` and ingests them.
+ * > LevelDB: appends the entries in big sorted `WriteBatch`es.
+ * > STL: appends keys bigger than the present ones, without lookups.
+ */
+void ukv_bulk_load( //
+    ukv_t const db,
+    ukv_size_t const tasks_count,
+
+    ukv_col_t const* collections,
+    ukv_size_t const collections_stride,
+
+    ukv_key_t const* keys,
+    ukv_size_t const keys_stride,
+
+    ukv_val_ptr_t const* values,
+    ukv_size_t const values_stride,
+
+    ukv_val_len_t const* offsets,
+    ukv_size_t const offsets_stride,
+
+    ukv_val_len_t const* lengths,
+    ukv_size_t const lengths_stride,
+
+    ukv_options_t const options,
+
+    ukv_arena_t* arena,
+    ukv_error_t* error);
+
+/**
+ * @brief Removes all the entries with keys in `[min_key, max_key)` ranges,
+ * without enumerating them. Purging a whole collection this way is instant,
+ * unlike a `ukv_write` of NULL values, which leaves a tombstone per key.
+ * Arguments are laid out like in `ukv_size`. Only `ukv_option_write_flush_k`
+ * applies. Bypasses transactions, and the STL backend fails the commits
+ * of the ones, that have read the removed entries.
+ *
+ * @section Backends
+ * > RocksDB: issues a `DeleteRange`, leaving a single range tombstone.
+ * > LevelDB: drops and recreates the whole DB, if the range covers all keys,
+ *   otherwise deletes the entries in big batches. Dropping the DB must not
+ *   race with any other operation on the same `ukv_t`.
+ * > STL: erases whole blocks, unless some snapshot can still see them.
+ */
+void ukv_remove_range( //
+    ukv_t const db,
+    ukv_size_t const tasks_count,
+
+    ukv_col_t const* collections,
+    ukv_size_t const collections_stride,
+
+    ukv_key_t const* min_keys,
+    ukv_size_t const min_keys_stride,
+
+    ukv_key_t const* max_keys,
+    ukv_size_t const max_keys_stride,
+
+    ukv_options_t const options,
+
+    ukv_arena_t* arena,
+    ukv_error_t* error);
+
 /**
  * @brief The primary "getter" interface.
  * If a fail had occurred, @param error will be set to non-NULL.
@@ -415,6 +487,56 @@ void ukv_size( //
     ukv_arena_t* arena,
     ukv_error_t* error);
 
+/**
+ * @brief Exports the keys of a collection, updated after the given @p generation,
+ * so that replicas and caches can catch up at a cost proportional to the delta,
+ * instead of rescanning the whole collection. Changes are ordered by generations,
+ * and the changes of one generation, like a transaction, are never split between
+ * calls, so a batch may slightly exceed the @p limit.
+ *
+ * To start following a collection, pass a zero @p limit to get the current
+ * generation, then read the collection, and pass that generation to the next calls.
+ * If the history since @p generation is no longer available, an error is returned,
+ * and the follower has to start over.
+ *
+ * @param[in] db                 Already open database instance, @see `ukv_db_open`.
+ * @param[in] collection         The collection to follow.
+ * @param[in] generation         Only the changes with greater generations are exported.
+ * @param[in] limit              Desired maximum number of changes to export.
+ *
+ * @param[out] found_count       Number of exported changes.
+ * @param[out] found_keys        Will contain @param found_count updated keys.
+ * @param[out] found_generations Will contain @param found_count generations of those updates.
+ * @param[out] found_lengths     Will contain @param found_count new lengths of values,
+ *                               or `ukv_val_len_missing_k` for removed entries.
+ * @param[out] next_generation   The @param generation to pass in the following call.
+ *
+ * @param[out] error             The error message to be handled by callee.
+ * @param[inout] arena           Temporary memory region, that can be reused between operations.
+ *
+ * @section Backends
+ * > RocksDB: generations are sequence numbers, and the history is read from the
+ *   Write-Ahead Log, which is kept longer with the "wal_ttl_seconds" DB config.
+ * > LevelDB: unsupported.
+ * > STL: keeps the recent changes in memory, once enabled with the collection
+ *   config: `{"change_feed": 65536}`. The range removals, that leave no tombstones,
+ *   and resizing the feed drop the history.
+ */
+void ukv_changes_since( //
+    ukv_t const db,
+    ukv_col_t const collection,
+    ukv_size_t const generation,
+    ukv_size_t const limit,
+
+    ukv_size_t* found_count,
+    ukv_key_t** found_keys,
+    ukv_size_t** found_generations,
+    ukv_val_len_t** found_lengths,
+    ukv_size_t* next_generation,
+
+    ukv_arena_t* arena,
+    ukv_error_t* error);
+
 /*********************************************************/
 /***************** Collection Management  ****************/
 /*********************************************************/
@@ -424,9 +546,16 @@ void ukv_size( //
  * This function may never be called, as the default nameless collection
  * always exists and can be addressed via `ukv_col_main_k`.
  *
+ * The @p config may enable transparent compression of the collection values,
+ * which is applied on writes and undone on reads, reporting the original lengths:
+ * `{"compression": "lz4", "dictionary": "<common patterns of small values>"}`.
+ * Once enabled, the compression of a collection can't be changed.
+ * The embedded backend also accepts `"bloom_bits_per_key": 10`, building a filter,
+ * that answers most lookups of missing keys without searching the collection.
+ *
  * @param[in] db           Already open database instance, @see `ukv_db_open`.
  * @param[in] name         A NULL-terminated collection name.
- * @param[in] config       A NULL-terminated configuration string.
+ * @param[in] config       A NULL-terminated configuration string. May be NULL or empty.
  * @param[out] collection  Address to which the collection handle will be exported.
  * @param[out] error       The error message to be handled by callee.
  */
@@ -482,8 +611,15 @@ void ukv_col_remove( //
  * > "clear":   Removes all the data from DB, while keeping collection names.
  * > "reset":   Removes all the data from DB, including collection names.
  * > "compact": Flushes and compacts all the data in LSM-tree implementations.
+ *              Persistent STL DBs start a new log segment and snapshot the rest in the background.
  * > "info":    Metadata about the current software version, used for debugging.
  * > "usage":   Metadata about approximate collection sizes, RAM and disk usage.
+ * > "commits": JSON with the number of commits and the time spent in their phases.
+ * > "metrics": JSON with calls, failures and latency quantiles of every operation,
+ *              globally and per collection, transaction conflicts and aborts,
+ *              and the growth of arenas.
+ * > "metrics.prometheus": Same metrics in the Prometheus text exposition format.
+ * > "numa_node:<collection>": Index of the NUMA node owning the collection, or "any".
  */
 void ukv_db_control( //
     ukv_t const db,
@@ -528,11 +664,21 @@ void ukv_txn_commit( //
 
 /**
  * @brief A function to be used after `ukv_read` to
- * deallocate and return memory to the OS.
+ * release the memory. A few arenas are cached per
+ * thread for reuse, the rest is returned to the OS.
  * Passing NULLs is safe.
  */
 void ukv_arena_free(ukv_t const db, ukv_arena_t const arena);
 
+/**
+ * @brief Number of times the arena had to request memory from the heap.
+ * Stays constant in steady state, when the same arena is reused
+ * between calls of similar size, so it can be used to benchmark
+ * and verify the absence of allocations on hot paths.
+ * Passing NULLs is safe.
+ */
+ukv_size_t ukv_arena_allocations(ukv_t const db, ukv_arena_t const arena);
+
 /**
  * @brief Deallocates memory used by transaction.
  * If snapshot was created via `ukv_option_txn_snapshot_k`,
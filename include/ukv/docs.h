@@ -116,6 +116,114 @@ typedef uint8_t ukv_1x8_t;
 /*****************	 Primary Functions	  ****************/
 /*********************************************************/
 
+/**
+ * @brief Enables a cache of up to @p documents parsed documents, shared by all
+ * collections in the current process. Field lookups in `ukv_docs_read`,
+ * `ukv_docs_gist` and `ukv_docs_gather` then skip re-parsing of hot documents.
+ * An entry is reused only while the stored bytes stay identical, so writes
+ * invalidate it implicitly. Zero, the default, disables and clears the cache.
+ */
+void ukv_docs_cache_limit(ukv_size_t const documents);
+
+/**
+ * @brief Exports the number of parsed documents, found in the cache,
+ * and the number of ones, that had to be parsed while it was enabled.
+ */
+void ukv_docs_cache_stats(ukv_size_t* hits, ukv_size_t* misses);
+
+/**
+ * @brief Switches @p collection into a columnar mode, where the top-level @p fields of
+ * every document are "shredded" into separate @p columns collections of fixed-width
+ * scalars of given @p types, keyed by the same IDs. The presence of a cell serves as
+ * its validity bit, and the rest of the document is kept in @p collection.
+ * `ukv_docs_gather` then exports shredded members straight from the columns, without
+ * reading or parsing documents, while other functions reassemble them transparently.
+ *
+ * Members are only shredded, if they fit into the column type without loss, like
+ * integers in range of an integral column. Others stay in the residual document.
+ * Only booleans, integers and 32- or 64-bit floats are supported.
+ *
+ * The layout lives in the memory of the current process and isn't persisted.
+ * It affects the documents written afterwards, so it should be set up before
+ * filling the @p collection, and all the writes must go through `ukv_docs_write`.
+ * Passing zero @p fields_count switches the collection back to the default mode.
+ */
+void ukv_docs_shred( //
+    ukv_t const db,
+    ukv_col_t const collection,
+    ukv_size_t const fields_count,
+
+    ukv_str_view_t const* fields,
+    ukv_size_t const fields_stride,
+
+    ukv_type_t const* types,
+    ukv_size_t const types_stride,
+
+    ukv_col_t const* columns,
+    ukv_size_t const columns_stride,
+
+    ukv_error_t* error);
+
+/**
+ * @brief Creates an ordered secondary index of an integer @p field of documents in
+ * @p collection, addressed by a top-level name or a JSON-Pointer. The index is kept
+ * in a separate collection, named @p name, which is cleared and filled with the
+ * existing documents first. Afterwards, every `ukv_docs_write` into @p collection
+ * updates the index in the same batch, in the transaction @p txn it was issued in.
+ *
+ * Every entry of the index is keyed by a value of the field and contains the sorted
+ * IDs of documents having it. Members of other types, and values equal to
+ * `ukv_key_unknown_k`, aren't indexed.
+ *
+ * Like `ukv_docs_shred`, the registration isn't persisted and lives in the memory of
+ * the current process. Concurrent writers of the same documents should use transactions.
+ */
+void ukv_docs_index_create( //
+    ukv_t const db,
+    ukv_txn_t const txn,
+    ukv_col_t const collection,
+    ukv_str_view_t const field,
+    ukv_str_view_t const name,
+    ukv_options_t const options,
+
+    ukv_arena_t* arena,
+    ukv_error_t* error);
+
+/**
+ * @brief Stops maintaining the index of @p field, created by `ukv_docs_index_create`,
+ * and removes the collection, that it was kept in.
+ */
+void ukv_docs_index_drop( //
+    ukv_t const db,
+    ukv_col_t const collection,
+    ukv_str_view_t const field,
+    ukv_error_t* error);
+
+/**
+ * @brief Finds the IDs of all documents, whose indexed @p field is within an inclusive
+ * range of `[min_value, max_value]`, in O(log(n) + k), using a single scan of the index.
+ * Passing identical bounds performs an equality lookup.
+ *
+ * @param[out] found_count  Number of found documents.
+ * @param[out] found_keys   IDs of found documents, sorted by the field value first
+ *                          and by the ID within every value.
+ */
+void ukv_docs_index_find( //
+    ukv_t const db,
+    ukv_txn_t const txn,
+    ukv_col_t const collection,
+    ukv_str_view_t const field,
+
+    int64_t const min_value,
+    int64_t const max_value,
+    ukv_options_t const options,
+
+    ukv_size_t* found_count,
+    ukv_key_t** found_keys,
+
+    ukv_arena_t* arena,
+    ukv_error_t* error);
+
 /**
  * @brief The primary "setter" interface for sub-document-level data.
  * Is an extension of the @see `ukv_write` function for structured vals.
@@ -175,6 +283,37 @@ void ukv_docs_write( //
     ukv_arena_t* arena,
     ukv_error_t* error);
 
+/**
+ * @brief Adds signed @p deltas to numeric @p fields of documents, addressed by top-level
+ * names or JSON-Pointers. Every document is read and written once per batch, even if
+ * it's incremented repeatedly, in which case increments are applied in order.
+ *
+ * Members, that keep their encoding, are overwritten in place, without parsing or
+ * re-serializing the rest of the document. Missing members and documents are
+ * created with the value of the delta. Integer overflows are reported as errors.
+ */
+void ukv_docs_increment( //
+    ukv_t const db,
+    ukv_txn_t const txn,
+    ukv_size_t const tasks_count,
+
+    ukv_col_t const* collections,
+    ukv_size_t const collections_stride,
+
+    ukv_key_t const* keys,
+    ukv_size_t const keys_stride,
+
+    ukv_str_view_t const* fields,
+    ukv_size_t const fields_stride,
+
+    int64_t const* deltas,
+    ukv_size_t const deltas_stride,
+
+    ukv_options_t const options,
+
+    ukv_arena_t* arena,
+    ukv_error_t* error);
+
 /**
  * @brief The primary "getter" interface for sub-document-level data.
  * Is an extension of the @see `ukv_read` function for structured vals.
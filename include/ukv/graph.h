@@ -79,6 +79,14 @@ extern ukv_vertex_degree_t ukv_vertex_degree_missing_k;
 /*****************	 Primary Functions	  ****************/
 /*********************************************************/
 
+/**
+ * @brief Limits the number of threads, used in the current process to merge
+ * big batches of edges in `ukv_graph_upsert_edges` and `ukv_graph_remove_edges`,
+ * and to decode adjacency lists in `ukv_graph_export_csr`.
+ * Zero, the default, means all hardware threads. One disables multi-threading.
+ */
+void ukv_graph_threads_limit(ukv_size_t const threads);
+
 /**
  * @brief Finds and extracts all the related edges and
  * neighbor IDs for the provided vertices set. Can also be
@@ -136,6 +144,90 @@ void ukv_graph_find_edges( //
     ukv_arena_t* arena,
     ukv_error_t* error);
 
+/**
+ * @brief Expands the neighborhoods of @p starts Breadth-First, level by level,
+ * fetching every frontier with a single batched read on the server side.
+ * Every vertex is reported once, at the first level it was reached from.
+ *
+ * @param[in] role        Direction of edges to follow: outgoing for
+ *                        @c `ukv_vertex_source_k`, incoming for
+ *                        @c `ukv_vertex_target_k`, or both.
+ * @param[in] max_depth   Number of hops to expand. Zero only checks
+ *                        which of the @p starts are present.
+ * @param[in] max_visits  Limits the number of reported vertices,
+ *                        including the starts. Zero means no limit.
+ *
+ * @param[out] vertices_count     Number of reported vertices.
+ * @param[out] vertices_ids       Reported vertices, ordered by their depth.
+ *                                Missing and repeated starts are skipped.
+ * @param[out] depths_per_vertex  Number of hops to every reported vertex.
+ * @param[out] edges_per_vertex   Edges, through which the vertices were
+ *                                discovered, as source, target and edge IDs.
+ *                                Starts, having depth zero, have none. So
+ *                                the i-th edge leads to the vertex
+ *                                @c `vertices_ids[count_starts + i]`.
+ */
+void ukv_graph_traverse( //
+    ukv_t const db,
+    ukv_txn_t const txn,
+    ukv_col_t const collection,
+
+    ukv_size_t const starts_count,
+    ukv_key_t const* starts_ids,
+    ukv_size_t const starts_stride,
+
+    ukv_vertex_role_t const role,
+    ukv_size_t const max_depth,
+    ukv_size_t const max_visits,
+    ukv_options_t const options,
+
+    ukv_size_t* vertices_count,
+    ukv_key_t** vertices_ids,
+    ukv_size_t** depths_per_vertex,
+    ukv_key_t** edges_per_vertex,
+
+    ukv_arena_t* arena,
+    ukv_error_t* error);
+
+/**
+ * @brief Exports the adjacency of all the vertices in `[min_key, max_key)` in the
+ * Compressed Sparse Row form, ready for analytics libraries. The neighbors of the
+ * i-th vertex are `neighbors_ids[offsets_per_vertex[i] : offsets_per_vertex[i + 1]]`.
+ * Vertex IDs are gathered with batched scans and fetched with a single read.
+ * Adjacency lists of disjoint ranges of vertices are then decoded concurrently,
+ * @see `ukv_graph_threads_limit`.
+ *
+ * @param[in] role  Which lists to export: outgoing for @c `ukv_vertex_source_k`,
+ *                  incoming for @c `ukv_vertex_target_k`. For @c `ukv_vertex_role_any_k`
+ *                  both are exported, the outgoing ones first.
+ *
+ * @param[out] vertices_count      Number of exported vertices.
+ * @param[out] vertices_ids        Sorted IDs of exported vertices.
+ * @param[out] offsets_per_vertex  Will contain @b `vertices_count + 1` offsets.
+ * @param[out] neighbors_ids       Concatenated lists of neighbors, sorted within every list.
+ * @param[out] edges_ids           Optional. Edges IDs, matching @p neighbors_ids.
+ *                                 Aren't even decoded, if NULL is passed.
+ */
+void ukv_graph_export_csr( //
+    ukv_t const db,
+    ukv_txn_t const txn,
+    ukv_col_t const collection,
+
+    ukv_key_t const min_key,
+    ukv_key_t const max_key,
+
+    ukv_vertex_role_t const role,
+    ukv_options_t const options,
+
+    ukv_size_t* vertices_count,
+    ukv_key_t** vertices_ids,
+    ukv_size_t** offsets_per_vertex,
+    ukv_key_t** neighbors_ids,
+    ukv_key_t** edges_ids,
+
+    ukv_arena_t* arena,
+    ukv_error_t* error);
+
 /**
  * @brief Inserts edges between provided vertices.
  *
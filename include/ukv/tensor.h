@@ -0,0 +1,67 @@
+/**
+ * @file tensor.h
+ * @author Ashot Vardanian
+ * @date 12 Sep 2022
+ *
+ * @brief "TenPack": gathers fixed-length values into dense row-major tensors.
+ * Collections of embeddings or other fixed-size records are read like with `ukv_read`,
+ * but instead of a tape with offsets and lengths, every value becomes a row of a single
+ * contiguous matrix, that can be passed to NumPy, PyTorch, or any DLPack consumer.
+ *
+ * @section Copies
+ * If the caller provides the output memory, the values are copied into it once,
+ * from multiple threads for big batches. Otherwise, the tensor is exported in
+ * the arena, and if the backend has already laid the values out back to back,
+ * it is just a view of the read tape, with no copies at all.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "ukv/db.h"
+
+/**
+ * @brief Reads the values of @p keys into consecutive rows of a dense tensor.
+ * All of the values must be present and have the same length, otherwise
+ * an error is returned and the output memory may be partially overwritten.
+ *
+ * @param[in] db               Already open database instance, @see `ukv_db_open`.
+ * @param[in] txn              Transaction or the snapshot, through which the values are read.
+ * @param[in] tasks_count      Number of keys, which is the number of rows in the tensor.
+ * @param[in] collections      Array of collections owning the @p keys, @see `ukv_read`.
+ * @param[in] keys             Array of keys in one or more collections, @see `ukv_read`.
+ * @param[in] options          Read options, @see `ukv_read`.
+ *
+ * @param[inout] row_length    Length of every value in bytes. If zero is passed,
+ *                             it is inferred from the first value and exported.
+ * @param[inout] tensor        Memory of `tasks_count * row_length` bytes, to be filled,
+ *                             or a pointer to NULL, to export the tensor in the @p arena.
+ *
+ * @param[out] error           The error message to be handled by callee.
+ * @param[inout] arena         Temporary memory region, that can be reused between operations.
+ */
+void ukv_read_tensor( //
+    ukv_t const db,
+    ukv_txn_t const txn,
+    ukv_size_t const tasks_count,
+
+    ukv_col_t const* collections,
+    ukv_size_t const collections_stride,
+
+    ukv_key_t const* keys,
+    ukv_size_t const keys_stride,
+
+    ukv_options_t const options,
+
+    ukv_val_len_t* row_length,
+    ukv_val_ptr_t* tensor,
+
+    ukv_arena_t* arena,
+    ukv_error_t* error);
+
+#ifdef __cplusplus
+} /* end extern "C" */
+#endif
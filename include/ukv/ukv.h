@@ -11,7 +11,7 @@
  * @section Assumptions and Limitations (in current version):
  * > Keys are preset to @b 8-byte unsigned integers.
  * > Values must be @b under 4GB long, zero length is OK too.
- * > Fully @b synchronous for the simplicity of interface.
+ * > Fully @b synchronous for the simplicity of interface, except for "async.h".
  * > Collection names should be under 64 characters long. Postgres does 59 :)
  *
  * @section Extended Functionality: @b Docs, @b Graphs
@@ -3,6 +3,7 @@ package com.unum.ukv;
 import java.io.File;
 import java.io.IOException;
 import java.io.InputStream;
+import java.nio.ByteBuffer;
 import java.nio.file.Files;
 import java.nio.file.StandardCopyOption;
 import java.util.Map; // Map abstract class
@@ -41,6 +42,8 @@ import java.util.Arrays; // Arrays.equals
  *          > putIfAbsent(key, value)
  *          > getOrDefault(key, defaultValue)
  *          > putAll(Map<Key, Value>)
+ *          > getAll(keys)
+ *          > containsKeys(keys)
  *          You can expect similar behavior to native classes described here:
  *          https://docs.oracle.com/javase/7/docs/api/java/util/Dictionary.html
  *          https://docs.oracle.com/javase/7/docs/api/java/util/Hashtable.html
@@ -185,17 +188,85 @@ public abstract class DataBase {
                 put(key, value);
         }
 
+        /**
+         * Maps the specified keys to values, concatenated in a direct `ByteBuffer`,
+         * submitting all of them in a single native call. The values are addressed
+         * in place, starting from the beginning of the buffer.
+         *
+         * @param lengths The number of bytes in each of the values.
+         */
+        public native void putBatch(String collection, long[] keys, ByteBuffer values, int[] lengths);
+
+        public void putBatch(long[] keys, ByteBuffer values, int[] lengths) {
+            putBatch(null, keys, values, lengths);
+        }
+
+        /**
+         * Fetches the values of all the specified keys in a single native call.
+         *
+         * @param lengths Output array, that will receive the lengths of values,
+         *                or -1 for missing keys.
+         * @return A direct buffer with concatenated values of found keys.
+         */
+        public native ByteBuffer getBatch(String collection, long[] keys, int[] lengths);
+
+        public ByteBuffer getBatch(long[] keys, int[] lengths) {
+            return getBatch(null, keys, lengths);
+        }
+
+        /**
+         * Tests which of the specified keys are present in this collection.
+         */
+        public native boolean[] containsKeys(String collection, long[] keys);
+
+        public boolean[] containsKeys(long[] keys) {
+            return containsKeys(null, keys);
+        }
+
+        /**
+         * Returns the values to which the specified keys are mapped,
+         * with nulls for missing keys.
+         */
+        public byte[][] getAll(String collection, long[] keys) {
+            int[] lengths = new int[keys.length];
+            ByteBuffer values = getBatch(collection, keys, lengths);
+            byte[][] result = new byte[keys.length][];
+            for (int i = 0; i != keys.length; ++i) {
+                if (lengths[i] < 0)
+                    continue;
+                result[i] = new byte[lengths[i]];
+                values.get(result[i]);
+            }
+            return result;
+        }
+
+        public byte[][] getAll(long[] keys) {
+            return getAll(null, keys);
+        }
+
         /**
          * Copies all of the mappings from the specified map to this collection.
          */
         public void putAll(String collection, Map<Long, byte[]> t) {
-            for (Map.Entry<Long, byte[]> entry : t.entrySet())
-                put(collection, entry.getKey(), entry.getValue());
+            long[] keys = new long[t.size()];
+            int[] lengths = new int[t.size()];
+            int totalLength = 0;
+            int i = 0;
+            for (Map.Entry<Long, byte[]> entry : t.entrySet()) {
+                keys[i] = entry.getKey();
+                lengths[i] = entry.getValue().length;
+                totalLength += lengths[i];
+                ++i;
+            }
+
+            ByteBuffer values = ByteBuffer.allocateDirect(totalLength);
+            for (byte[] value : t.values())
+                values.put(value);
+            putBatch(collection, keys, values, lengths);
         }
 
         public void putAll(Map<Long, byte[]> t) {
-            for (Map.Entry<Long, byte[]> entry : t.entrySet())
-                put(entry.getKey(), entry.getValue());
+            putAll(null, t);
         }
 
         /**
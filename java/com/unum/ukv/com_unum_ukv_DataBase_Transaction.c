@@ -1,3 +1,6 @@
+#include <stdlib.h> // `malloc`
+#include <string.h> // `memcpy`
+
 #include "com_unum_ukv_Shared.h"
 #include "com_unum_ukv_DataBase_Transaction.h"
 
@@ -221,6 +224,261 @@ JNIEXPORT void JNICALL Java_com_unum_ukv_DataBase_00024Transaction_erase( //
     forward_ukv_error(env_java, error_c);
 }
 
+JNIEXPORT void JNICALL Java_com_unum_ukv_DataBase_00024Transaction_putBatch( //
+    JNIEnv* env_java,
+    jobject txn_java,
+    jstring col_java,
+    jlongArray keys_java,
+    jobject values_java,
+    jintArray lengths_java) {
+
+    ukv_t db_ptr_c = db_ptr(env_java, txn_java);
+    if (!db_ptr_c) {
+        forward_error(env_java, "Database is closed!");
+        return;
+    }
+
+    ukv_txn_t txn_ptr_c = txn_ptr(env_java, txn_java);
+    ukv_col_t col_ptr_c = col_ptr(env_java, db_ptr_c, col_java);
+    if ((*env_java)->ExceptionCheck(env_java))
+        return;
+
+    jsize keys_count_java = (*env_java)->GetArrayLength(env_java, keys_java);
+    if ((*env_java)->GetArrayLength(env_java, lengths_java) != keys_count_java) {
+        forward_error(env_java, "Every key must have a length!");
+        return;
+    }
+
+    // Direct buffers are addressed in place, without copies
+    ukv_val_ptr_t values_c = (ukv_val_ptr_t)(*env_java)->GetDirectBufferAddress(env_java, values_java);
+    jlong values_capacity_java = (*env_java)->GetDirectBufferCapacity(env_java, values_java);
+    if (!values_c && keys_count_java) {
+        forward_error(env_java, "Values must be passed in a direct ByteBuffer!");
+        return;
+    }
+
+    ukv_val_len_t* offsets_c = (ukv_val_len_t*)malloc(sizeof(ukv_val_len_t) * (keys_count_java + 1));
+    if (!offsets_c) {
+        forward_error(env_java, "Failed to allocate memory!");
+        return;
+    }
+
+    // Values are expected to be concatenated in the order of keys
+    jint* lengths_ptr_java = (*env_java)->GetIntArrayElements(env_java, lengths_java, NULL);
+    if ((*env_java)->ExceptionCheck(env_java)) {
+        free(offsets_c);
+        return;
+    }
+    jlong total_length_java = 0;
+    for (jsize i = 0; i != keys_count_java; ++i) {
+        if (lengths_ptr_java[i] < 0)
+            total_length_java = values_capacity_java + 1;
+        if (total_length_java > values_capacity_java)
+            break;
+        offsets_c[i] = (ukv_val_len_t)total_length_java;
+        total_length_java += lengths_ptr_java[i];
+    }
+    if (total_length_java > values_capacity_java) {
+        (*env_java)->ReleaseIntArrayElements(env_java, lengths_java, lengths_ptr_java, JNI_ABORT);
+        free(offsets_c);
+        forward_error(env_java, "Lengths exceed the capacity of the values buffer!");
+        return;
+    }
+
+    jlong* keys_ptr_java = (*env_java)->GetLongArrayElements(env_java, keys_java, NULL);
+    if ((*env_java)->ExceptionCheck(env_java)) {
+        (*env_java)->ReleaseIntArrayElements(env_java, lengths_java, lengths_ptr_java, JNI_ABORT);
+        free(offsets_c);
+        return;
+    }
+
+    ukv_options_t options_c = ukv_options_default_k;
+    ukv_arena_t arena_c = NULL;
+    ukv_error_t error_c = NULL;
+
+    ukv_write( //
+        db_ptr_c,
+        txn_ptr_c,
+        (ukv_size_t)keys_count_java,
+        &col_ptr_c,
+        0,
+        (ukv_key_t const*)keys_ptr_java,
+        sizeof(jlong),
+        &values_c,
+        0,
+        offsets_c,
+        sizeof(ukv_val_len_t),
+        (ukv_val_len_t const*)lengths_ptr_java,
+        sizeof(jint),
+        options_c,
+        &arena_c,
+        &error_c);
+    ukv_arena_free(db_ptr_c, arena_c);
+
+    (*env_java)->ReleaseLongArrayElements(env_java, keys_java, keys_ptr_java, JNI_ABORT);
+    (*env_java)->ReleaseIntArrayElements(env_java, lengths_java, lengths_ptr_java, JNI_ABORT);
+    free(offsets_c);
+    forward_ukv_error(env_java, error_c);
+}
+
+JNIEXPORT jbooleanArray JNICALL Java_com_unum_ukv_DataBase_00024Transaction_containsKeys( //
+    JNIEnv* env_java,
+    jobject txn_java,
+    jstring col_java,
+    jlongArray keys_java) {
+
+    ukv_t db_ptr_c = db_ptr(env_java, txn_java);
+    if (!db_ptr_c) {
+        forward_error(env_java, "Database is closed!");
+        return NULL;
+    }
+
+    ukv_txn_t txn_ptr_c = txn_ptr(env_java, txn_java);
+    ukv_col_t col_ptr_c = col_ptr(env_java, db_ptr_c, col_java);
+    if ((*env_java)->ExceptionCheck(env_java))
+        return NULL;
+
+    jsize keys_count_java = (*env_java)->GetArrayLength(env_java, keys_java);
+    jlong* keys_ptr_java = (*env_java)->GetLongArrayElements(env_java, keys_java, NULL);
+    if ((*env_java)->ExceptionCheck(env_java))
+        return NULL;
+
+    ukv_options_t options_c = ukv_option_read_lengths_k;
+    ukv_val_len_t* found_offsets_c = NULL;
+    ukv_val_len_t* found_lengths_c = NULL;
+    ukv_val_ptr_t found_values_c = NULL;
+    ukv_arena_t arena_c = NULL;
+    ukv_error_t error_c = NULL;
+
+    ukv_read( //
+        db_ptr_c,
+        txn_ptr_c,
+        (ukv_size_t)keys_count_java,
+        &col_ptr_c,
+        0,
+        (ukv_key_t const*)keys_ptr_java,
+        sizeof(jlong),
+        options_c,
+        &found_values_c,
+        &found_offsets_c,
+        &found_lengths_c,
+        &arena_c,
+        &error_c);
+    (*env_java)->ReleaseLongArrayElements(env_java, keys_java, keys_ptr_java, JNI_ABORT);
+
+    if (forward_ukv_error(env_java, error_c)) {
+        ukv_arena_free(db_ptr_c, arena_c);
+        return NULL;
+    }
+
+    jbooleanArray result_java = (*env_java)->NewBooleanArray(env_java, keys_count_java);
+    jboolean* result_ptr_java = result_java //
+                                    ? (*env_java)->GetBooleanArrayElements(env_java, result_java, NULL)
+                                    : NULL;
+    if (result_ptr_java) {
+        for (jsize i = 0; i != keys_count_java; ++i)
+            result_ptr_java[i] = found_lengths_c[i] != ukv_val_len_missing_k ? JNI_TRUE : JNI_FALSE;
+        (*env_java)->ReleaseBooleanArrayElements(env_java, result_java, result_ptr_java, 0);
+    }
+
+    ukv_arena_free(db_ptr_c, arena_c);
+    return result_java;
+}
+
+JNIEXPORT jobject JNICALL Java_com_unum_ukv_DataBase_00024Transaction_getBatch( //
+    JNIEnv* env_java,
+    jobject txn_java,
+    jstring col_java,
+    jlongArray keys_java,
+    jintArray lengths_java) {
+
+    ukv_t db_ptr_c = db_ptr(env_java, txn_java);
+    if (!db_ptr_c) {
+        forward_error(env_java, "Database is closed!");
+        return NULL;
+    }
+
+    ukv_txn_t txn_ptr_c = txn_ptr(env_java, txn_java);
+    ukv_col_t col_ptr_c = col_ptr(env_java, db_ptr_c, col_java);
+    if ((*env_java)->ExceptionCheck(env_java))
+        return NULL;
+
+    jsize keys_count_java = (*env_java)->GetArrayLength(env_java, keys_java);
+    if ((*env_java)->GetArrayLength(env_java, lengths_java) != keys_count_java) {
+        forward_error(env_java, "Every key must have a length!");
+        return NULL;
+    }
+
+    jlong* keys_ptr_java = (*env_java)->GetLongArrayElements(env_java, keys_java, NULL);
+    if ((*env_java)->ExceptionCheck(env_java))
+        return NULL;
+
+    ukv_options_t options_c = ukv_options_default_k;
+    ukv_val_len_t* found_offsets_c = NULL;
+    ukv_val_len_t* found_lengths_c = NULL;
+    ukv_val_ptr_t found_values_c = NULL;
+    ukv_arena_t arena_c = NULL;
+    ukv_error_t error_c = NULL;
+
+    ukv_read( //
+        db_ptr_c,
+        txn_ptr_c,
+        (ukv_size_t)keys_count_java,
+        &col_ptr_c,
+        0,
+        (ukv_key_t const*)keys_ptr_java,
+        sizeof(jlong),
+        options_c,
+        &found_values_c,
+        &found_offsets_c,
+        &found_lengths_c,
+        &arena_c,
+        &error_c);
+    (*env_java)->ReleaseLongArrayElements(env_java, keys_java, keys_ptr_java, JNI_ABORT);
+
+    if (forward_ukv_error(env_java, error_c)) {
+        ukv_arena_free(db_ptr_c, arena_c);
+        return NULL;
+    }
+
+    // Export the lengths, marking the missing entries with -1
+    jlong total_length_java = 0;
+    jint* lengths_ptr_java = (*env_java)->GetIntArrayElements(env_java, lengths_java, NULL);
+    if ((*env_java)->ExceptionCheck(env_java)) {
+        ukv_arena_free(db_ptr_c, arena_c);
+        return NULL;
+    }
+    for (jsize i = 0; i != keys_count_java; ++i) {
+        bool is_missing = found_lengths_c[i] == ukv_val_len_missing_k;
+        lengths_ptr_java[i] = is_missing ? -1 : (jint)found_lengths_c[i];
+        total_length_java += is_missing ? 0 : found_lengths_c[i];
+    }
+    (*env_java)->ReleaseIntArrayElements(env_java, lengths_java, lengths_ptr_java, 0);
+
+    // Unlike `get`, the whole batch is copied into a single direct buffer,
+    // allocated and owned by the JVM, crossing the JNI boundary only once.
+    jclass buffer_class_java = (*env_java)->FindClass(env_java, "java/nio/ByteBuffer");
+    jmethodID allocate_java =
+        (*env_java)->GetStaticMethodID(env_java, buffer_class_java, "allocateDirect", "(I)Ljava/nio/ByteBuffer;");
+    jobject result_java =
+        (*env_java)->CallStaticObjectMethod(env_java, buffer_class_java, allocate_java, (jint)total_length_java);
+    if ((*env_java)->ExceptionCheck(env_java)) {
+        ukv_arena_free(db_ptr_c, arena_c);
+        return NULL;
+    }
+
+    ukv_val_ptr_t result_ptr_c = (ukv_val_ptr_t)(*env_java)->GetDirectBufferAddress(env_java, result_java);
+    for (jsize i = 0; i != keys_count_java && result_ptr_c; ++i) {
+        if (found_lengths_c[i] == ukv_val_len_missing_k)
+            continue;
+        memcpy(result_ptr_c, found_values_c + found_offsets_c[i], found_lengths_c[i]);
+        result_ptr_c += found_lengths_c[i];
+    }
+
+    ukv_arena_free(db_ptr_c, arena_c);
+    return result_java;
+}
+
 JNIEXPORT void JNICALL Java_com_unum_ukv_DataBase_00024Transaction_rollback( //
     JNIEnv* env_java,
     jobject txn_java) {
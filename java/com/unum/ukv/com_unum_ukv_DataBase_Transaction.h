@@ -55,6 +55,30 @@ JNIEXPORT jbyteArray JNICALL Java_com_unum_ukv_DataBase_00024Transaction_get
 JNIEXPORT void JNICALL Java_com_unum_ukv_DataBase_00024Transaction_erase
   (JNIEnv *, jobject, jstring, jlong);
 
+/*
+ * Class:     com_unum_ukv_DataBase_Transaction
+ * Method:    putBatch
+ * Signature: (Ljava/lang/String;[JLjava/nio/ByteBuffer;[I)V
+ */
+JNIEXPORT void JNICALL Java_com_unum_ukv_DataBase_00024Transaction_putBatch
+  (JNIEnv *, jobject, jstring, jlongArray, jobject, jintArray);
+
+/*
+ * Class:     com_unum_ukv_DataBase_Transaction
+ * Method:    getBatch
+ * Signature: (Ljava/lang/String;[J[I)Ljava/nio/ByteBuffer;
+ */
+JNIEXPORT jobject JNICALL Java_com_unum_ukv_DataBase_00024Transaction_getBatch
+  (JNIEnv *, jobject, jstring, jlongArray, jintArray);
+
+/*
+ * Class:     com_unum_ukv_DataBase_Transaction
+ * Method:    containsKeys
+ * Signature: (Ljava/lang/String;[J)[Z
+ */
+JNIEXPORT jbooleanArray JNICALL Java_com_unum_ukv_DataBase_00024Transaction_containsKeys
+  (JNIEnv *, jobject, jstring, jlongArray);
+
 #ifdef __cplusplus
 }
 #endif
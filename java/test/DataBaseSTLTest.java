@@ -3,6 +3,8 @@ import com.unum.ukv.DataBaseSTL;
 import org.junit.Test;
 
 import java.util.Arrays;
+import java.util.HashMap;
+import java.util.Map;
 
 public class DataBaseSTLTest {
     static {
@@ -23,4 +25,25 @@ public class DataBaseSTLTest {
         ctx.close();
         System.out.println("Success!");
     }
+
+    @Test
+    public void batch() {
+        DataBaseSTL.Context ctx = new DataBaseSTL.Context("");
+        Map<Long, byte[]> pairs = new HashMap<>();
+        for (long key = 0; key != 100; ++key)
+            pairs.put(key, Long.toString(key).getBytes());
+        ctx.putAll("batch", pairs);
+
+        long[] keys = { 1, 42, 100, 7 };
+        boolean[] present = ctx.containsKeys("batch", keys);
+        assert present[0] && present[1] && !present[2] && present[3] : "Wrong presence";
+
+        byte[][] values = ctx.getAll("batch", keys);
+        assert Arrays.equals(values[0], "1".getBytes()) : "Received wrong value";
+        assert Arrays.equals(values[1], "42".getBytes()) : "Received wrong value";
+        assert values[2] == null : "Received a missing value";
+        assert Arrays.equals(values[3], "7".getBytes()) : "Received wrong value";
+
+        ctx.close();
+    }
 }
@@ -60,7 +60,6 @@ def only_overwrite(col):
 
 
 def batch_insert(col):
-    return
     col.clear()
     count_keys: int = 20
     keys: list[int] = list(range(1, count_keys + 1))
@@ -73,15 +72,24 @@ def batch_insert(col):
         keeper.append((f'{i}' * int(i-count_keys//2)).encode())
 
     keys = np.array(keys, dtype=np.uint64)
-    values = np.array(keeper)
-
-    col.set(keys, values)
+    col.set(keys, keeper)
+    assert col.get(keys) == tuple(keeper)
 
     for i in keys[:count_keys//2]:
-        assert col.get(i) == (f'{i}' * i).encode()
+        assert col.get(int(i)) == (f'{i}' * i).encode()
 
     for i in keys[count_keys//2:]:
-        assert col.get(i) == (f'{i}' * int(i-count_keys//2)).encode()
+        assert col.get(int(i)) == (f'{i}' * int(i-count_keys//2)).encode()
+
+
+def batch_arrow(col):
+    pa = pytest.importorskip('pyarrow')
+    col.clear()
+    col.set(np.array([1, 2, 4], dtype=np.int64), [b'a', b'bb', b'dddd'])
+
+    column = col.get_column(np.array([1, 2, 3, 4], dtype=np.int64))
+    assert isinstance(column, pa.BinaryArray)
+    assert column.to_pylist() == [b'a', b'bb', None, b'dddd']
 
 
 def scan(col):
@@ -137,6 +145,11 @@ def iterate(col):
         iterated_keys.append(key)
     assert iterated_keys == [1, 2, 3, 4]
 
+    # Iterate keys in NumPy chunks, prefetching the following ones
+    chunks = list(col.keys.chunks(batch_size=4))
+    assert [len(chunk) for chunk in chunks] == [4, 2]
+    assert np.array_equal(np.concatenate(chunks), [1, 2, 3, 4, 5, 6])
+
     # Iterate items
     iterated_items = []
     for item in col.items:
@@ -167,6 +180,11 @@ def test_main_collection():
     iterate(db)
 
 
+def test_arrow_export():
+    db = ukv.DataBase()
+    batch_arrow(db.main)
+
+
 def test_named_collections():
     db = ukv.DataBase()
     col_sub = db['sub']
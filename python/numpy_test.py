@@ -38,3 +38,19 @@ def test_main_collection_txn():
     with ukv.DataBase() as db:
         with ukv.Transaction(db) as txn:
             lower_triangular(txn.main)
+
+
+def test_tensor():
+    db = ukv.DataBase()
+    col = db.main
+    embeddings = np.arange(40, dtype=np.float32).reshape(10, 4)
+    keys = np.arange(10, dtype=np.int64)
+    for key in keys:
+        col.set(int(key), embeddings[key].tobytes())
+
+    gathered = keys[::-1].copy()
+    assert np.array_equal(col.get_tensor(gathered, dtype=np.float32), embeddings[::-1])
+
+    out = np.zeros((10, 4), dtype=np.float32)
+    assert col.get_tensor(gathered, out=out) is out
+    assert np.array_equal(out, embeddings[::-1])
@@ -1,11 +1,16 @@
 
 #pragma once
 #include <vector>              // `std::vector`
+#include <optional>            // `std::optional`
 #include <pybind11/pybind11.h> // `gil_scoped_release`
 #include <Python.h>            // `PyObject`
 
 #include "ukv/ukv.h"
+#include "ukv/arrow.h"
+#include "ukv/tensor.h"
+#include "pybind.hpp"
 #include "cast.hpp"
+#include "dlpack.hpp"
 
 namespace unum::ukv::pyb {
 
@@ -17,6 +22,49 @@ struct py_bin_req_t {
     ukv_val_len_t len = 0;
 };
 
+/**
+ * @brief Keys of a batch request. NumPy arrays and other buffers of 64-bit
+ * integers are viewed without copies, Python sequences are gathered into `owned`.
+ */
+struct py_keys_t {
+    std::optional<py_buffer_t> buffer;
+    std::vector<ukv_key_t> owned;
+    strided_range_gt<ukv_key_t const> range;
+};
+
+static void py_to_keys(PyObject* keys_py, py_keys_t& keys) {
+    if (PyObject_CheckBuffer(keys_py)) {
+        keys.buffer.emplace(py_buffer(keys_py));
+        Py_buffer const& raw = keys.buffer->raw;
+        // Skip the optional byte-order prefix of the format string
+        std::size_t format_length = raw.format ? std::strlen(raw.format) : 0;
+        char format = format_length ? raw.format[format_length - 1] : 0;
+        bool is_integral = format == 'l' || format == 'L' || format == 'q' || format == 'Q';
+        if (raw.ndim != 1 || raw.itemsize != sizeof(ukv_key_t) || !is_integral)
+            throw std::invalid_argument("Keys must be a 1D buffer of 64-bit integers");
+        keys.range = {reinterpret_cast<ukv_key_t const*>(raw.buf),
+                      static_cast<std::size_t>(raw.strides[0]),
+                      static_cast<std::size_t>(raw.shape[0])};
+        return;
+    }
+
+    py_transform_n(keys_py, &py_to_scalar<ukv_key_t>, std::back_inserter(keys.owned));
+    keys.range = {keys.owned.data(), sizeof(ukv_key_t), keys.owned.size()};
+}
+
+/**
+ * @brief Keeps a dedicated arena alive, while NumPy arrays view its memory.
+ */
+struct py_arena_owner_t {
+    std::shared_ptr<py_db_t> db_ptr;
+    ukv_arena_t arena = nullptr;
+
+    py_arena_owner_t(std::shared_ptr<py_db_t> db, ukv_arena_t memory) noexcept
+        : db_ptr(std::move(db)), arena(memory) {}
+    py_arena_owner_t(py_arena_owner_t const&) = delete;
+    ~py_arena_owner_t() { ukv_arena_free(db_ptr->native, arena); }
+};
+
 #pragma region Writes
 
 /**
@@ -52,21 +100,28 @@ static void write_one_binary(py_task_ctx_t ctx, PyObject* key_py, PyObject* val_
 static void write_many_binaries(py_task_ctx_t ctx, PyObject* keys_py, PyObject* vals_py) {
 
     status_t status;
-    std::vector<ukv_key_t> keys;
-    py_transform_n(keys_py, &py_to_scalar<ukv_key_t>, std::back_inserter(keys));
-
-    std::vector<value_view_t> vals(keys.size());
-    if (vals_py != Py_None)
+    py_keys_t keys;
+    py_to_keys(keys_py, keys);
+    if (keys.range.empty())
+        return;
+
+    // Bytes objects are referenced in place, as we hold the GIL until they are parsed
+    std::vector<value_view_t> vals(keys.range.size());
+    if (vals_py != Py_None) {
+        auto vals_count = py_sequence_length(vals_py);
+        if (vals_count && *vals_count != vals.size())
+            throw std::invalid_argument("Number of keys and values must match");
         py_transform_n(vals_py, &py_to_bytes, vals.begin(), vals.size());
+    }
 
     [[maybe_unused]] py::gil_scoped_release release;
     ukv_write(ctx.db,
               ctx.txn,
-              static_cast<ukv_size_t>(keys.size()),
+              static_cast<ukv_size_t>(keys.range.size()),
               ctx.col,
               0,
-              keys.data(),
-              sizeof(ukv_key_t),
+              keys.range.data(),
+              keys.range.stride(),
               vals[0].member_ptr(),
               sizeof(value_view_t),
               nullptr,
@@ -159,18 +214,19 @@ static py::object has_many_binaries(py_task_ctx_t ctx, PyObject* keys_py) {
     ukv_val_len_t* found_lengths = nullptr;
     ctx.options = static_cast<ukv_options_t>(ctx.options | ukv_option_read_lengths_k);
 
-    std::vector<ukv_key_t> keys;
-    py_transform_n(keys_py, &py_to_scalar<ukv_key_t>, std::back_inserter(keys));
+    py_keys_t keys;
+    py_to_keys(keys_py, keys);
+    std::size_t const count = keys.range.size();
 
     {
         [[maybe_unused]] py::gil_scoped_release release;
         ukv_read(ctx.db,
                  ctx.txn,
-                 static_cast<ukv_size_t>(keys.size()),
+                 static_cast<ukv_size_t>(count),
                  ctx.col,
                  0,
-                 keys.data(),
-                 sizeof(ukv_key_t),
+                 keys.range.data(),
+                 keys.range.stride(),
                  ctx.options,
                  &found_values,
                  &found_offsets,
@@ -180,8 +236,8 @@ static py::object has_many_binaries(py_task_ctx_t ctx, PyObject* keys_py) {
         status.throw_unhandled();
     }
 
-    PyObject* tuple_ptr = PyTuple_New(keys.size());
-    for (std::size_t i = 0; i != keys.size(); ++i) {
+    PyObject* tuple_ptr = PyTuple_New(count);
+    for (std::size_t i = 0; i != count; ++i) {
         PyObject* obj_ptr = found_lengths[i] != ukv_val_len_missing_k ? Py_True : Py_False;
         PyTuple_SetItem(tuple_ptr, i, obj_ptr);
     }
@@ -195,18 +251,19 @@ static py::object read_many_binaries(py_task_ctx_t ctx, PyObject* keys_py) {
     ukv_val_len_t* found_offsets = nullptr;
     ukv_val_len_t* found_lengths = nullptr;
 
-    std::vector<ukv_key_t> keys;
-    py_transform_n(keys_py, &py_to_scalar<ukv_key_t>, std::back_inserter(keys));
+    py_keys_t keys;
+    py_to_keys(keys_py, keys);
+    std::size_t const count = keys.range.size();
 
     {
         [[maybe_unused]] py::gil_scoped_release release;
         ukv_read(ctx.db,
                  ctx.txn,
-                 static_cast<ukv_size_t>(keys.size()),
+                 static_cast<ukv_size_t>(count),
                  ctx.col,
                  0,
-                 keys.data(),
-                 sizeof(ukv_key_t),
+                 keys.range.data(),
+                 keys.range.stride(),
                  ctx.options,
                  &found_values,
                  &found_offsets,
@@ -217,8 +274,8 @@ static py::object read_many_binaries(py_task_ctx_t ctx, PyObject* keys_py) {
     }
 
     tape_iterator_t tape_it {found_values, found_offsets, found_lengths};
-    PyObject* tuple_ptr = PyTuple_New(keys.size());
-    for (std::size_t i = 0; i != keys.size(); ++i, ++tape_it) {
+    PyObject* tuple_ptr = PyTuple_New(count);
+    for (std::size_t i = 0; i != count; ++i, ++tape_it) {
         value_view_t val = *tape_it;
         PyObject* obj_ptr = val ? PyBytes_FromStringAndSize(val.c_str(), val.size()) : Py_None;
         PyTuple_SetItem(tuple_ptr, i, obj_ptr);
@@ -261,7 +318,7 @@ void update_binary(py_wrap_at& wrap, py::object dict_py) {
     ukv_size_t step = sizeof(py_bin_req_t);
 
     std::vector<py_bin_req_t> keys;
-    keys.reserve(PyDict_Size(dict_py.ptr()));
+    keys.resize(PyDict_Size(dict_py.ptr()));
 
     std::size_t i = 0;
     py_scan_dict(dict_py.ptr(), [&](PyObject* key_obj, PyObject* val_obj) {
@@ -293,6 +350,303 @@ void update_binary(py_wrap_at& wrap, py::object dict_py) {
     status.throw_unhandled();
 }
 
+/**
+ * @brief Reads a batch of values into a dedicated arena, which the caller must free.
+ */
+static ukv_arena_t read_many_into_arena( //
+    py_task_ctx_t ctx,
+    py_keys_t const& keys,
+    ukv_val_ptr_t& found_values,
+    ukv_val_len_t*& found_offsets,
+    ukv_val_len_t*& found_lengths) {
+
+    status_t status;
+    ukv_arena_t arena = nullptr;
+    {
+        [[maybe_unused]] py::gil_scoped_release release;
+        ukv_read(ctx.db,
+                 ctx.txn,
+                 static_cast<ukv_size_t>(keys.range.size()),
+                 ctx.col,
+                 0,
+                 keys.range.data(),
+                 keys.range.stride(),
+                 ctx.options,
+                 &found_values,
+                 &found_offsets,
+                 &found_lengths,
+                 &arena,
+                 status.member_ptr());
+    }
+    if (!status) {
+        ukv_arena_free(ctx.db, arena);
+        status.throw_unhandled();
+    }
+    return arena;
+}
+
+/**
+ * @brief Exports a batch of values as a `pyarrow.BinaryArray`, that references
+ * the read values in place, without building a Python object per entry.
+ * Missing values become nulls.
+ */
+template <typename py_wrap_at>
+py::object read_binaries_to_arrow(py_wrap_at& wrap, py::object keys_py) {
+
+    py_task_ctx_t ctx = wrap;
+    py_keys_t keys;
+    py_to_keys(keys_py.ptr(), keys);
+
+    ukv_val_ptr_t found_values = nullptr;
+    ukv_val_len_t* found_offsets = nullptr;
+    ukv_val_len_t* found_lengths = nullptr;
+    ukv_arena_t arena = read_many_into_arena(ctx, keys, found_values, found_offsets, found_lengths);
+
+    // On success, the arena moves into the array
+    status_t status;
+    ArrowSchema schema;
+    ArrowArray array;
+    ukv_to_arrow_values(ctx.db,
+                        static_cast<ukv_size_t>(keys.range.size()),
+                        found_values,
+                        found_offsets,
+                        found_lengths,
+                        nullptr,
+                        &schema,
+                        &array,
+                        &arena,
+                        status.member_ptr());
+    if (!status) {
+        ukv_arena_free(ctx.db, arena);
+        status.throw_unhandled();
+    }
+
+    // PyArrow moves both structures out, if the import succeeds
+    try {
+        py::object py_array = py::module_::import("pyarrow").attr("Array").attr("_import_from_c");
+        py::object result = py_array(reinterpret_cast<std::uintptr_t>(&array), //
+                                     reinterpret_cast<std::uintptr_t>(&schema));
+        return result;
+    }
+    catch (...) {
+        if (array.release)
+            array.release(&array);
+        if (schema.release)
+            schema.release(&schema);
+        throw;
+    }
+}
+
+/**
+ * @brief Exports a batch of values as a 2D NumPy matrix of bytes and a vector of lengths.
+ * If all values have the same length and are laid out consecutively, the matrix
+ * is a view of the read memory. Otherwise, shorter rows are padded and longer ones
+ * are truncated to `max_length`, which defaults to the longest value.
+ */
+template <typename py_wrap_at>
+py::tuple read_binaries_to_matrix( //
+    py_wrap_at& wrap,
+    py::object keys_py,
+    ukv_val_len_t max_length,
+    std::uint8_t padding) {
+
+    py_task_ctx_t ctx = wrap;
+    py_keys_t keys;
+    py_to_keys(keys_py.ptr(), keys);
+    std::size_t const count = keys.range.size();
+
+    ukv_val_ptr_t found_values = nullptr;
+    ukv_val_len_t* found_offsets = nullptr;
+    ukv_val_len_t* found_lengths = nullptr;
+    ukv_arena_t arena = read_many_into_arena(ctx, keys, found_values, found_offsets, found_lengths);
+    auto owner = std::make_unique<py_arena_owner_t>(wrap.db_ptr, arena);
+
+    ukv_val_len_t const first_length = count ? found_lengths[0] : 0;
+    bool is_fixed = first_length != ukv_val_len_missing_k && (!max_length || max_length == first_length);
+    ukv_val_len_t longest = 0;
+    for (std::size_t i = 0; i != count; ++i) {
+        is_fixed &= found_lengths[i] == first_length && found_offsets[i] == found_offsets[0] + i * first_length;
+        if (found_lengths[i] != ukv_val_len_missing_k)
+            longest = std::max(longest, found_lengths[i]);
+    }
+
+    if (is_fixed && count) {
+        auto begin = reinterpret_cast<std::uint8_t const*>(found_values + found_offsets[0]);
+        auto rows = static_cast<py::ssize_t>(count);
+        auto columns = static_cast<py::ssize_t>(first_length);
+        py::capsule base(owner.release(), [](void* ptr) { delete static_cast<py_arena_owner_t*>(ptr); });
+        py::array_t<std::uint8_t> matrix({rows, columns}, {columns, py::ssize_t(1)}, begin, base);
+        py::array_t<ukv_val_len_t> lengths({rows}, {py::ssize_t(sizeof(ukv_val_len_t))}, found_lengths, base);
+        return py::make_tuple(matrix, lengths);
+    }
+
+    std::size_t const width = max_length ? max_length : longest;
+    py::array_t<std::uint8_t> matrix({static_cast<py::ssize_t>(count), static_cast<py::ssize_t>(width)});
+    py::array_t<ukv_val_len_t> lengths(count, found_lengths);
+    std::uint8_t* matrix_begin = matrix.mutable_data();
+    std::memset(matrix_begin, padding, count * width);
+    tape_iterator_t tape_it {found_values, found_offsets, found_lengths};
+    for (std::size_t i = 0; i != count; ++i, ++tape_it) {
+        value_view_t val = *tape_it;
+        std::memcpy(matrix_begin + i * width, val.begin(), std::min<std::size_t>(val.size(), width));
+    }
+    return py::make_tuple(matrix, lengths);
+}
+
+#pragma region Tensors
+
+/**
+ * @brief Reads fixed-length values into a dense @p tensor, @see `ukv_read_tensor`.
+ * If the @p tensor is NULL, it is exported in a dedicated arena, which the caller must free.
+ */
+static ukv_arena_t read_many_into_tensor( //
+    py_task_ctx_t ctx,
+    py_keys_t const& keys,
+    ukv_val_len_t& row_length,
+    ukv_val_ptr_t& tensor) {
+
+    status_t status;
+    ukv_arena_t arena = nullptr;
+    {
+        [[maybe_unused]] py::gil_scoped_release release;
+        ukv_read_tensor(ctx.db,
+                        ctx.txn,
+                        static_cast<ukv_size_t>(keys.range.size()),
+                        ctx.col,
+                        0,
+                        keys.range.data(),
+                        keys.range.stride(),
+                        ctx.options,
+                        &row_length,
+                        &tensor,
+                        &arena,
+                        status.member_ptr());
+    }
+    if (!status) {
+        ukv_arena_free(ctx.db, arena);
+        status.throw_unhandled();
+    }
+    return arena;
+}
+
+static py::dtype py_to_dtype(py::object const& dtype_py) {
+    return dtype_py.is_none() ? py::dtype::of<std::uint8_t>() : py::dtype::from_args(dtype_py);
+}
+
+/// Number of scalars of @p dtype in a row of @p row_length bytes.
+static py::ssize_t py_row_scalars(py::dtype const& dtype, ukv_val_len_t row_length) {
+    auto const itemsize = static_cast<ukv_val_len_t>(dtype.itemsize());
+    if (row_length % itemsize)
+        throw std::invalid_argument("Length of values must be a multiple of the scalar size");
+    return static_cast<py::ssize_t>(row_length / itemsize);
+}
+
+/**
+ * @brief Exports a batch of fixed-length values as a 2D NumPy matrix of @p dtype scalars.
+ * Values are written straight into the @p out matrix, if one is passed, otherwise
+ * the result views the read memory. Missing values and different lengths raise errors.
+ */
+template <typename py_wrap_at>
+py::array read_binaries_to_tensor( //
+    py_wrap_at& wrap,
+    py::object keys_py,
+    py::object dtype_py,
+    py::object out_py) {
+
+    py_task_ctx_t ctx = wrap;
+    py_keys_t keys;
+    py_to_keys(keys_py.ptr(), keys);
+    auto const rows = static_cast<py::ssize_t>(keys.range.size());
+    ukv_val_len_t row_length = 0;
+    ukv_val_ptr_t tensor = nullptr;
+
+    if (!out_py.is_none()) {
+        py::array out = out_py.cast<py::array>();
+        if (!(out.flags() & py::array::c_style) || !out.writeable())
+            throw std::invalid_argument("Output must be a writable C-contiguous array");
+        if (!out.ndim() || out.shape(0) != rows)
+            throw std::invalid_argument("Output must have a row per key");
+        row_length = rows ? static_cast<ukv_val_len_t>(out.nbytes() / rows) : 0;
+        tensor = reinterpret_cast<ukv_val_ptr_t>(out.mutable_data());
+        py_arena_owner_t owner {wrap.db_ptr, read_many_into_tensor(ctx, keys, row_length, tensor)};
+        return out;
+    }
+
+    py::dtype dtype = py_to_dtype(dtype_py);
+    auto owner = std::make_unique<py_arena_owner_t>(wrap.db_ptr, read_many_into_tensor(ctx, keys, row_length, tensor));
+    py::ssize_t const columns = py_row_scalars(dtype, row_length);
+    py::ssize_t const itemsize = dtype.itemsize();
+    py::capsule base(owner.release(), [](void* ptr) { delete static_cast<py_arena_owner_t*>(ptr); });
+    return py::array(dtype, {rows, columns}, {columns * itemsize, itemsize}, tensor, base);
+}
+
+/**
+ * @brief Keeps the arena with the tensor alive, until the DLPack consumer calls the `deleter`.
+ */
+struct py_dlpack_owner_t {
+    DLManagedTensor managed {};
+    std::int64_t shape[2] {};
+    py_arena_owner_t arena;
+
+    py_dlpack_owner_t(std::shared_ptr<py_db_t> db, ukv_arena_t memory) noexcept : arena(std::move(db), memory) {}
+};
+
+static DLDataType py_to_dlpack(py::dtype const& dtype) {
+    DLDataType result {0, static_cast<std::uint8_t>(dtype.itemsize() * 8), 1};
+    switch (dtype.kind()) {
+    case 'i': result.code = kDLInt; break;
+    case 'u': result.code = kDLUInt; break;
+    case 'f': result.code = kDLFloat; break;
+    case 'c': result.code = kDLComplex; break;
+    case 'b': result.code = kDLBool; break;
+    default: throw std::invalid_argument("Unsupported scalar type for DLPack");
+    }
+    return result;
+}
+
+/**
+ * @brief Exports a batch of fixed-length values as a DLPack capsule, that
+ * `torch.utils.dlpack.from_dlpack` and alike can consume without copies.
+ * Consumers rename the capsule, so it only frees the tensor, if was never consumed.
+ */
+template <typename py_wrap_at>
+py::object read_binaries_to_dlpack( //
+    py_wrap_at& wrap,
+    py::object keys_py,
+    py::object dtype_py) {
+
+    py_task_ctx_t ctx = wrap;
+    py_keys_t keys;
+    py_to_keys(keys_py.ptr(), keys);
+    py::dtype dtype = py_to_dtype(dtype_py);
+    DLDataType const scalar = py_to_dlpack(dtype);
+    ukv_val_len_t row_length = 0;
+    ukv_val_ptr_t tensor = nullptr;
+    auto owner = std::make_unique<py_dlpack_owner_t>(wrap.db_ptr, read_many_into_tensor(ctx, keys, row_length, tensor));
+
+    owner->shape[0] = static_cast<std::int64_t>(keys.range.size());
+    owner->shape[1] = py_row_scalars(dtype, row_length);
+    DLTensor& dl_tensor = owner->managed.dl_tensor;
+    dl_tensor.data = tensor;
+    dl_tensor.device = {kDLCPU, 0};
+    dl_tensor.ndim = 2;
+    dl_tensor.dtype = scalar;
+    dl_tensor.shape = owner->shape;
+    owner->managed.manager_ctx = owner.get();
+    owner->managed.deleter = [](DLManagedTensor* self) { delete static_cast<py_dlpack_owner_t*>(self->manager_ctx); };
+
+    PyObject* capsule = PyCapsule_New(&owner->managed, "dltensor", [](PyObject* capsule) {
+        if (!PyCapsule_IsValid(capsule, "dltensor"))
+            return;
+        auto managed = static_cast<DLManagedTensor*>(PyCapsule_GetPointer(capsule, "dltensor"));
+        managed->deleter(managed);
+    });
+    if (!capsule)
+        throw py::error_already_set();
+    owner.release();
+    return py::reinterpret_steal<py::object>(capsule);
+}
+
 template <typename py_wrap_at>
 py::array_t<ukv_key_t> scan_binary( //
     py_wrap_at& wrap,
@@ -304,21 +658,24 @@ py::array_t<ukv_key_t> scan_binary( //
     ukv_val_len_t* found_lengths = nullptr;
     status_t status;
 
-    ukv_scan( //
-        ctx.db,
-        ctx.txn,
-        1,
-        ctx.col,
-        0,
-        &min_key,
-        0,
-        &scan_length,
-        0,
-        ctx.options,
-        &found_keys,
-        &found_lengths,
-        ctx.arena,
-        status.member_ptr());
+    {
+        [[maybe_unused]] py::gil_scoped_release release;
+        ukv_scan( //
+            ctx.db,
+            ctx.txn,
+            1,
+            ctx.col,
+            0,
+            &min_key,
+            0,
+            &scan_length,
+            0,
+            ctx.options,
+            &found_keys,
+            &found_lengths,
+            ctx.arena,
+            status.member_ptr());
+    }
 
     status.throw_unhandled();
     return py::array_t<ukv_key_t>(scan_length, found_keys);
@@ -40,6 +40,16 @@ struct py_stream_with_ending_gt {
 using py_kstream_t = py_stream_with_ending_gt<keys_stream_t>;
 using py_kvstream_t = py_stream_with_ending_gt<pairs_stream_t>;
 
+/**
+ * @brief Yields whole batches of keys as NumPy arrays, instead of one key per `__next__`.
+ * With `prefetch`, the next batch is scanned in background, while Python consumes the current one.
+ */
+struct py_kchunks_t {
+    keys_stream_t native;
+    ukv_key_t terminal = ukv_key_unknown_k;
+    bool reached_terminal = false;
+};
+
 template <typename range_at>
 range_at& since(range_at& range, ukv_key_t key) {
     range.members.since(key);
@@ -71,6 +81,7 @@ void ukv::wrap_database(py::module& m) {
     auto py_kvrange = py::class_<pairs_range_t>(m, "ItemsRange", py::module_local());
     auto py_kstream = py::class_<py_kstream_t>(m, "KeysStream", py::module_local());
     auto py_kvstream = py::class_<py_kvstream_t>(m, "ItemsStream", py::module_local());
+    auto py_kchunks = py::class_<py_kchunks_t, std::shared_ptr<py_kchunks_t>>(m, "KeysChunks", py::module_local());
 
     py::enum_<ukv_format_t>(m, "Format", py::module_local())
         .value("Binary", ukv_format_binary_k)
@@ -116,8 +127,18 @@ void ukv::wrap_database(py::module& m) {
 
     // ML-oriented procedures for zero-copy variants exporting
     // Apache Arrow shared memory handles:
-    py_col.def("get_column", [](py_col_t& py_col, py::object keys) { return 0; });
-    py_col.def("get_matrix", [](py_col_t& py_col, py::object keys) { return 0; });
+    py_col.def("get_column", &read_binaries_to_arrow<py_col_t>, py::arg("keys"));
+    py_col.def("get_matrix",
+               &read_binaries_to_matrix<py_col_t>,
+               py::arg("keys"),
+               py::arg("max_length") = 0,
+               py::arg("padding") = 0);
+    py_col.def("get_tensor",
+               &read_binaries_to_tensor<py_col_t>,
+               py::arg("keys"),
+               py::arg("dtype") = py::none(),
+               py::arg("out") = py::none());
+    py_col.def("get_dlpack", &read_binaries_to_dlpack<py_col_t>, py::arg("keys"), py::arg("dtype") = py::none());
 
 #pragma region Transactions and Lifetime
 
@@ -227,17 +248,47 @@ void ukv::wrap_database(py::module& m) {
         return py::array(remaining, keys.begin() + start);
     });
 
+    py_krange.def(
+        "chunks",
+        [](keys_range_t& keys_range, std::size_t batch_size, bool prefetch) {
+            if (!batch_size)
+                throw std::invalid_argument("Batch size must be positive");
+            keys_stream_t stream = keys_range.members.keys_begin(batch_size, prefetch).throw_or_release();
+            py_kchunks_t chunks {std::move(stream), keys_range.members.max_key()};
+            return std::make_shared<py_kchunks_t>(std::move(chunks));
+        },
+        py::arg("batch_size") = keys_stream_t::default_read_ahead_k,
+        py::arg("prefetch") = true);
+
+    py_kchunks.def("__iter__", [](std::shared_ptr<py_kchunks_t> kchunks) { return kchunks; });
+    py_kchunks.def("__next__", [](py_kchunks_t& kchunks) {
+        if (kchunks.reached_terminal || kchunks.native.is_end())
+            throw py::stop_iteration();
+
+        auto keys = kchunks.native.keys_batch();
+        auto keys_end = std::lower_bound(keys.begin(), keys.end(), kchunks.terminal);
+        py::array_t<ukv_key_t> chunk(keys_end - keys.begin(), keys.begin());
+        if (keys_end != keys.end()) {
+            kchunks.reached_terminal = true;
+            return chunk;
+        }
+
+        [[maybe_unused]] py::gil_scoped_release release;
+        kchunks.native.seek_to_next_batch().throw_unhandled();
+        return chunk;
+    });
+
     py_kstream.def("__next__", [](py_kstream_t& kstream) {
-        ukv_key_t key = kstream.native.key();
-        if (kstream.native.is_end() || kstream.terminal == key)
+        if (kstream.native.is_end() || kstream.terminal == kstream.native.key())
             throw py::stop_iteration();
+        ukv_key_t key = kstream.native.key();
         ++kstream.native;
         return key;
     });
     py_kvstream.def("__next__", [](py_kvstream_t& kvstream) {
-        ukv_key_t key = kvstream.native.key();
-        if (kvstream.native.is_end() || kvstream.terminal == key)
+        if (kvstream.native.is_end() || kvstream.terminal == kvstream.native.key())
             throw py::stop_iteration();
+        ukv_key_t key = kvstream.native.key();
 
         value_view_t value_view = kvstream.native.value();
         PyObject* value_ptr = PyBytes_FromStringAndSize(value_view.c_str(), value_view.size());
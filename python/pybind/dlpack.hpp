@@ -0,0 +1,64 @@
+/**
+ * @file dlpack.hpp
+ * @author Ashot Vardanian
+ *
+ * @brief Replicates the bare-minimum definitions of the DLPack tensor interface,
+ * so that PyTorch, TensorFlow, JAX or CuPy can consume exported tensors without copies.
+ * If the original header is included first, its definitions are used instead.
+ *
+ * https://github.com/dmlc/dlpack/blob/main/include/dlpack/dlpack.h
+ * https://dmlc.github.io/dlpack/latest/python_spec.html
+ */
+#pragma once
+#include <stdint.h> // `int64_t`
+
+#ifndef DLPACK_DLPACK_H_
+#define DLPACK_DLPACK_H_
+
+extern "C" {
+
+typedef enum {
+    kDLCPU = 1,
+} DLDeviceType;
+
+typedef struct {
+    DLDeviceType device_type;
+    int32_t device_id;
+} DLDevice;
+
+typedef enum {
+    kDLInt = 0U,
+    kDLUInt = 1U,
+    kDLFloat = 2U,
+    kDLOpaqueHandle = 3U,
+    kDLBfloat = 4U,
+    kDLComplex = 5U,
+    kDLBool = 6U,
+} DLDataTypeCode;
+
+typedef struct {
+    uint8_t code;
+    uint8_t bits;
+    uint16_t lanes;
+} DLDataType;
+
+typedef struct {
+    void* data;
+    DLDevice device;
+    int32_t ndim;
+    DLDataType dtype;
+    int64_t* shape;
+    /// NULL for compact row-major tensors.
+    int64_t* strides;
+    uint64_t byte_offset;
+} DLTensor;
+
+typedef struct DLManagedTensor {
+    DLTensor dl_tensor;
+    void* manager_ctx;
+    void (*deleter)(struct DLManagedTensor* self);
+} DLManagedTensor;
+
+} /* end extern "C" */
+
+#endif
@@ -336,6 +336,24 @@ void ukv::wrap_networkx(py::module& m) {
         },
         "Checks given nodes against graph members and returns a filtered iterable object");
 
+    // Exporting the whole graph at once, for analytics libraries, like SciPy and PyTorch Geometric
+    g.def(
+        "to_csr",
+        [](py_graph_t& g, bool edges) {
+            auto role = g.is_directed_ ? ukv_vertex_source_k : ukv_vertex_role_any_k;
+            csr_t csr = g.ref().export_csr(role, edges).throw_or_release();
+            auto vertices = py::array_t<ukv_key_t>(csr.vertices.size(), csr.vertices.begin());
+            auto offsets = py::array_t<ukv_size_t>(csr.offsets.size(), csr.offsets.begin());
+            auto neighbors = py::array_t<ukv_key_t>(csr.neighbors.size(), csr.neighbors.begin());
+            if (!edges)
+                return py::make_tuple(vertices, offsets, neighbors);
+            auto edge_ids = py::array_t<ukv_key_t>(csr.edges.size(), csr.edges.begin());
+            return py::make_tuple(vertices, offsets, neighbors, edge_ids);
+        },
+        py::arg("edges") = false,
+        "Exports sorted node IDs, offsets and neighbors arrays of the Compressed Sparse Row form, "
+        "optionally followed by edge IDs.");
+
     // Adding and Removing Nodes and Edges
     // https://networkx.org/documentation/stable/reference/classes/multidigraph.html#adding-and-removing-nodes-and-edges
     g.def(
@@ -3,55 +3,582 @@
  * @author Ashot Vardanian
  * @date 2022-07-18
  *
- * @brief An server implementing Apache Arrow Flight RPC protocol.
+ * @brief An server implementing Apache Arrow Flight RPC protocol on top of UKV collections.
+ *
+ * @section Requests
+ *
+ * Tickets and flight descriptors of the "CMD" type contain JSON objects:
+ *      {
+ *          "collection": str,      // Name of the collection, empty for the main one
+ *          "fields"?: [str],       // JSON-Pointers to gather from documents
+ *          "types"?: [str],        // Types of gathered fields, like "i64", "f64" or "str"
+ *          "min"?: int,            // Inclusive lower bound of the keys range
+ *          "max"?: int,            // Exclusive upper bound of the keys range
+ *          "batch"?: int           // Number of keys scanned for every record batch
+ *      }
+ * Descriptors of the "PATH" type must contain a single collection name.
+ *
+ * Without "fields", entries are exported as is, in a table of two columns:
+ * the "key" of type `int64` and the "value" of type `binary`. With "fields",
+ * the "value" is replaced by the gathered columns of documents, @see `ukv_docs_gather`.
+ *
+ * > DoGet: Streams the entries in the requested range, one record batch per scan.
+ *          Keys and scalar columns reference the arena tapes, without copies.
+ * > DoPut: Ingests record batches with an `int64` "key" column. If the only other
+ *          column is a binary "value", batches are passed to `ukv_write` as is.
+ *          Otherwise, every row is packed into a MessagePack document for `ukv_docs_write`.
+ * > DoAction "drop_collection": Removes the collection, named in the body of the action.
  *
  * Links:
  * https://arrow.apache.org/cookbook/cpp/flight.html
  */
 
+#include <arrow/array.h>
 #include <arrow/buffer.h>
-#include <arrow/filesystem/filesystem.h>
-#include <arrow/filesystem/localfs.h>
-#include <arrow/flight/client.h>
+#include <arrow/builder.h>
 #include <arrow/flight/server.h>
-#include <arrow/pretty_print.h>
+#include <arrow/record_batch.h>
 #include <arrow/result.h>
 #include <arrow/status.h>
-#include <arrow/table.h>
 #include <arrow/type.h>
 
-#include <parquet/arrow/reader.h>
-#include <parquet/arrow/writer.h>
-
 #include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <limits>
 #include <memory>
-#include <numeric>
+#include <string>
 #include <vector>
 #include <iostream>
+#include <fstream>
+
+#include <nlohmann/json.hpp>
+
+#include "ukv/ukv.hpp"
+#include "ukv/docs.h"
+
+using namespace unum::ukv;
+using namespace unum;
+
+using json_t = nlohmann::json;
+
+static constexpr ukv_size_t flight_batch_size_k = 1024;
+
+/*********************************************************/
+/*****************	    Type Mappings	  ****************/
+/*********************************************************/
+
+struct named_type_t {
+    char const* name;
+    ukv_type_t type;
+};
+
+static constexpr named_type_t named_types_k[] = {
+    {"bool", ukv_type_bool_k},
+    {"i8", ukv_type_i8_k},
+    {"i16", ukv_type_i16_k},
+    {"i32", ukv_type_i32_k},
+    {"i64", ukv_type_i64_k},
+    {"u8", ukv_type_u8_k},
+    {"u16", ukv_type_u16_k},
+    {"u32", ukv_type_u32_k},
+    {"u64", ukv_type_u64_k},
+    {"f32", ukv_type_f32_k},
+    {"f64", ukv_type_f64_k},
+    {"bin", ukv_type_bin_k},
+    {"str", ukv_type_str_k},
+};
+
+std::shared_ptr<arrow::DataType> ukv_to_arrow_type(ukv_type_t type) {
+    switch (type) {
+    case ukv_type_bool_k: return arrow::boolean();
+    case ukv_type_i8_k: return arrow::int8();
+    case ukv_type_i16_k: return arrow::int16();
+    case ukv_type_i32_k: return arrow::int32();
+    case ukv_type_i64_k: return arrow::int64();
+    case ukv_type_u8_k: return arrow::uint8();
+    case ukv_type_u16_k: return arrow::uint16();
+    case ukv_type_u32_k: return arrow::uint32();
+    case ukv_type_u64_k: return arrow::uint64();
+    case ukv_type_f32_k: return arrow::float32();
+    case ukv_type_f64_k: return arrow::float64();
+    case ukv_type_bin_k: return arrow::binary();
+    case ukv_type_str_k: return arrow::utf8();
+    default: return nullptr;
+    }
+}
+
+arrow::Status to_arrow_status(status_t& status) {
+    return status ? arrow::Status::OK() : arrow::Status::IOError(status.release_exception().what());
+}
+
+/**
+ * @brief Wraps memory, owned by someone else, into an Arrow buffer without copies.
+ * It must outlive the batches referencing it, @see `collection_reader_t`.
+ */
+std::shared_ptr<arrow::Buffer> borrow_buffer(void const* begin, std::size_t length) {
+    return std::make_shared<arrow::Buffer>(reinterpret_cast<std::uint8_t const*>(begin),
+                                           static_cast<std::int64_t>(length));
+}
+
+/*********************************************************/
+/*****************	   MessagePack Output	  ****************/
+/*********************************************************/
+
+void msgpack_append_be(std::string& out, std::uint8_t code, std::uint64_t value, std::size_t bytes) {
+    out.push_back(static_cast<char>(code));
+    for (std::size_t i = bytes; i != 0; --i)
+        out.push_back(static_cast<char>(value >> ((i - 1) * 8)));
+}
+
+void msgpack_append_map(std::string& out, std::size_t count) {
+    if (count < 16)
+        out.push_back(static_cast<char>(0x80 | count));
+    else if (count <= 0xFFFF)
+        msgpack_append_be(out, 0xDE, count, 2);
+    else
+        msgpack_append_be(out, 0xDF, count, 4);
+}
+
+void msgpack_append_str(std::string& out, char const* begin, std::size_t length) {
+    if (length < 32)
+        out.push_back(static_cast<char>(0xA0 | length));
+    else if (length <= 0xFF)
+        msgpack_append_be(out, 0xD9, length, 1);
+    else if (length <= 0xFFFF)
+        msgpack_append_be(out, 0xDA, length, 2);
+    else
+        msgpack_append_be(out, 0xDB, length, 4);
+    out.append(begin, length);
+}
+
+void msgpack_append_bin(std::string& out, char const* begin, std::size_t length) {
+    if (length <= 0xFF)
+        msgpack_append_be(out, 0xC4, length, 1);
+    else if (length <= 0xFFFF)
+        msgpack_append_be(out, 0xC5, length, 2);
+    else
+        msgpack_append_be(out, 0xC6, length, 4);
+    out.append(begin, length);
+}
+
+void msgpack_append_uint(std::string& out, std::uint64_t value) {
+    if (value < 128)
+        out.push_back(static_cast<char>(value));
+    else
+        msgpack_append_be(out, 0xCF, value, 8);
+}
+
+void msgpack_append_int(std::string& out, std::int64_t value) {
+    if (value >= 0)
+        msgpack_append_uint(out, static_cast<std::uint64_t>(value));
+    else if (value >= -32)
+        out.push_back(static_cast<char>(value));
+    else
+        msgpack_append_be(out, 0xD3, static_cast<std::uint64_t>(value), 8);
+}
+
+void msgpack_append_double(std::string& out, double value) {
+    std::uint64_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    msgpack_append_be(out, 0xCB, bits, 8);
+}
+
+bool is_packable(arrow::Type::type type) {
+    switch (type) {
+    case arrow::Type::BOOL:
+    case arrow::Type::INT8:
+    case arrow::Type::INT16:
+    case arrow::Type::INT32:
+    case arrow::Type::INT64:
+    case arrow::Type::UINT8:
+    case arrow::Type::UINT16:
+    case arrow::Type::UINT32:
+    case arrow::Type::UINT64:
+    case arrow::Type::FLOAT:
+    case arrow::Type::DOUBLE:
+    case arrow::Type::STRING:
+    case arrow::Type::BINARY: return true;
+    default: return false;
+    }
+}
 
-#include "ukv/cpp/arrow.hpp"
+/**
+ * @brief Appends a non-null cell of a column, that passed `is_packable`, to a MessagePack tape.
+ */
+void msgpack_append_cell(std::string& out, arrow::Array const& array, std::int64_t row) {
+    switch (array.type_id()) {
+    case arrow::Type::BOOL:
+        out.push_back(static_cast<arrow::BooleanArray const&>(array).Value(row) ? '\xC3' : '\xC2');
+        break;
+    case arrow::Type::INT8: msgpack_append_int(out, static_cast<arrow::Int8Array const&>(array).Value(row)); break;
+    case arrow::Type::INT16: msgpack_append_int(out, static_cast<arrow::Int16Array const&>(array).Value(row)); break;
+    case arrow::Type::INT32: msgpack_append_int(out, static_cast<arrow::Int32Array const&>(array).Value(row)); break;
+    case arrow::Type::INT64: msgpack_append_int(out, static_cast<arrow::Int64Array const&>(array).Value(row)); break;
+    case arrow::Type::UINT8: msgpack_append_uint(out, static_cast<arrow::UInt8Array const&>(array).Value(row)); break;
+    case arrow::Type::UINT16:
+        msgpack_append_uint(out, static_cast<arrow::UInt16Array const&>(array).Value(row));
+        break;
+    case arrow::Type::UINT32:
+        msgpack_append_uint(out, static_cast<arrow::UInt32Array const&>(array).Value(row));
+        break;
+    case arrow::Type::UINT64:
+        msgpack_append_uint(out, static_cast<arrow::UInt64Array const&>(array).Value(row));
+        break;
+    case arrow::Type::FLOAT:
+        msgpack_append_double(out, static_cast<arrow::FloatArray const&>(array).Value(row));
+        break;
+    case arrow::Type::DOUBLE:
+        msgpack_append_double(out, static_cast<arrow::DoubleArray const&>(array).Value(row));
+        break;
+    case arrow::Type::STRING: {
+        auto view = static_cast<arrow::StringArray const&>(array).GetView(row);
+        msgpack_append_str(out, view.data(), view.size());
+        break;
+    }
+    case arrow::Type::BINARY: {
+        auto view = static_cast<arrow::BinaryArray const&>(array).GetView(row);
+        msgpack_append_bin(out, view.data(), view.size());
+        break;
+    }
+    default: break;
+    }
+}
+
+/*********************************************************/
+/*****************	       Queries	      ****************/
+/*********************************************************/
 
-using namespace arrow::flight;
-using namespace arrow;
+/**
+ * @brief Parsed contents of a ticket or a flight descriptor.
+ */
+struct query_t {
+    std::string collection;
+    std::vector<std::string> fields;
+    std::vector<ukv_type_t> types;
+    ukv_key_t min_key = std::numeric_limits<ukv_key_t>::min();
+    ukv_key_t max_key = ukv_key_unknown_k;
+    ukv_size_t batch_size = flight_batch_size_k;
+
+    std::string dump() const {
+        json_t query = {
+            {"collection", collection},
+            {"min", min_key},
+            {"max", max_key},
+            {"batch", batch_size},
+        };
+        if (!fields.empty()) {
+            query["fields"] = fields;
+            json_t& names = query["types"] = json_t::array();
+            for (ukv_type_t type : types)
+                for (named_type_t const& named : named_types_k)
+                    if (named.type == type)
+                        names.push_back(named.name);
+        }
+        return query.dump();
+    }
+
+    std::shared_ptr<arrow::Schema> schema() const {
+        std::vector<std::shared_ptr<arrow::Field>> columns;
+        columns.push_back(arrow::field("key", arrow::int64(), false));
+        if (fields.empty())
+            columns.push_back(arrow::field("value", arrow::binary()));
+        for (std::size_t field_idx = 0; field_idx != fields.size(); ++field_idx)
+            columns.push_back(arrow::field(fields[field_idx], ukv_to_arrow_type(types[field_idx])));
+        return arrow::schema(std::move(columns));
+    }
+};
+
+arrow::Result<query_t> parse_query(std::string const& query_str) {
+    json_t query_json = json_t::parse(query_str, nullptr, false);
+    if (query_json.is_discarded() || !query_json.is_object())
+        return arrow::Status::Invalid("Queries must be JSON objects");
+
+    query_t query;
+    try {
+        query.collection = query_json.value("collection", std::string());
+        query.min_key = query_json.value("min", query.min_key);
+        query.max_key = query_json.value("max", query.max_key);
+        query.batch_size = query_json.value("batch", query.batch_size);
+        query.fields = query_json.value("fields", query.fields);
+        for (std::string const& name : query_json.value("types", std::vector<std::string> {})) {
+            auto it = std::find_if(std::begin(named_types_k), std::end(named_types_k), [&](named_type_t const& named) {
+                return name == named.name;
+            });
+            if (it == std::end(named_types_k))
+                return arrow::Status::Invalid("Unsupported field type: ", name);
+            query.types.push_back(it->type);
+        }
+    }
+    catch (json_t::exception const& e) {
+        return arrow::Status::Invalid("Malformed query: ", e.what());
+    }
+
+    if (query.fields.size() != query.types.size())
+        return arrow::Status::Invalid("Every gathered field needs a type");
+    if (!query.batch_size)
+        return arrow::Status::Invalid("Batches can't be empty");
+    return query;
+}
+
+arrow::Result<query_t> parse_descriptor(arrow::flight::FlightDescriptor const& descriptor) {
+    if (descriptor.type == arrow::flight::FlightDescriptor::CMD)
+        return parse_query(descriptor.cmd);
+    if (descriptor.path.size() != 1)
+        return arrow::Status::Invalid("Must provide PATH-type FlightDescriptor with one path component");
+    query_t query;
+    query.collection = descriptor.path[0];
+    return query;
+}
+
+/*********************************************************/
+/*****************	       Readers	      ****************/
+/*********************************************************/
+
+/**
+ * @brief Produces record batches from consecutive scans of a collection.
+ * Keys and fixed-width columns reference the memory of the arena, which is
+ * only reused by the following batch. Flight serializes every batch before
+ * asking for the next one, so no copies are needed. Strings, booleans and
+ * values, that aren't contiguous on the tape, are copied into Arrow layouts.
+ */
+class collection_reader_t final : public arrow::RecordBatchReader {
+    ukv_t db_ = nullptr;
+    ukv_col_t col_ = ukv_col_main_k;
+    query_t query_;
+    std::shared_ptr<arrow::Schema> schema_;
+    std::vector<ukv_str_view_t> fields_;
+
+    arena_t arena_;
+    ukv_key_t next_key_ = 0;
+    std::vector<ukv_key_t> keys_;
+    std::vector<std::int32_t> offsets_;
+    std::vector<std::uint8_t> validities_;
+    std::vector<std::uint8_t> contents_;
+
+    arrow::Status read_values(std::int64_t count, std::vector<std::shared_ptr<arrow::Array>>& columns) {
+        status_t status;
+        ukv_val_ptr_t found_values = nullptr;
+        ukv_val_len_t* found_offsets = nullptr;
+        ukv_val_len_t* found_lengths = nullptr;
+        ukv_read(db_,
+                 nullptr,
+                 static_cast<ukv_size_t>(count),
+                 &col_,
+                 0,
+                 keys_.data(),
+                 sizeof(ukv_key_t),
+                 ukv_options_default_k,
+                 &found_values,
+                 &found_offsets,
+                 &found_lengths,
+                 arena_,
+                 status.member_ptr());
+        ARROW_RETURN_NOT_OK(to_arrow_status(status));
+
+        // Values are exported right from the tape, if they are laid out consecutively
+        std::int64_t null_count = 0;
+        std::size_t progress = 0;
+        ukv_val_ptr_t base = nullptr;
+        bool is_contiguous = true;
+        offsets_.resize(count + 1);
+        validities_.assign(static_cast<std::size_t>(count + 7) / 8, 0);
+        for (std::int64_t i = 0; i != count; ++i) {
+            offsets_[i] = static_cast<std::int32_t>(progress);
+            if (found_lengths[i] == ukv_val_len_missing_k) {
+                ++null_count;
+                continue;
+            }
+            ukv_val_ptr_t begin = found_values + found_offsets[i];
+            base = base ? base : begin;
+            is_contiguous &= begin == base + progress;
+            validities_[i / 8] |= static_cast<std::uint8_t>(1 << (i % 8));
+            progress += found_lengths[i];
+        }
+        if (progress > static_cast<std::size_t>(std::numeric_limits<std::int32_t>::max()))
+            return arrow::Status::CapacityError("Batch values exceed 2 GB, reduce the batch size");
+        offsets_[count] = static_cast<std::int32_t>(progress);
+
+        if (!is_contiguous) {
+            contents_.clear();
+            for (std::int64_t i = 0; i != count; ++i)
+                if (found_lengths[i] != ukv_val_len_missing_k)
+                    contents_.insert(contents_.end(),
+                                     found_values + found_offsets[i],
+                                     found_values + found_offsets[i] + found_lengths[i]);
+            base = contents_.data();
+        }
+
+        auto data = arrow::ArrayData::Make( //
+            arrow::binary(),
+            count,
+            {null_count ? borrow_buffer(validities_.data(), validities_.size()) : nullptr,
+             borrow_buffer(offsets_.data(), offsets_.size() * sizeof(std::int32_t)),
+             borrow_buffer(base, progress)},
+            null_count);
+        columns.push_back(arrow::MakeArray(std::move(data)));
+        return arrow::Status::OK();
+    }
+
+    arrow::Status gather_fields(std::int64_t count, std::vector<std::shared_ptr<arrow::Array>>& columns) {
+        status_t status;
+        ukv_1x8_t** validities = nullptr;
+        ukv_1x8_t** conversions = nullptr;
+        ukv_1x8_t** collisions = nullptr;
+        ukv_val_ptr_t* scalars = nullptr;
+        ukv_val_len_t** strs_offsets = nullptr;
+        ukv_val_len_t** strs_lengths = nullptr;
+        ukv_val_ptr_t strs_contents = nullptr;
+        ukv_docs_gather(db_,
+                        nullptr,
+                        static_cast<ukv_size_t>(count),
+                        static_cast<ukv_size_t>(fields_.size()),
+                        &col_,
+                        0,
+                        keys_.data(),
+                        sizeof(ukv_key_t),
+                        fields_.data(),
+                        sizeof(ukv_str_view_t),
+                        query_.types.data(),
+                        sizeof(ukv_type_t),
+                        ukv_options_default_k,
+                        &validities,
+                        &conversions,
+                        &collisions,
+                        &scalars,
+                        &strs_offsets,
+                        &strs_lengths,
+                        &strs_contents,
+                        arena_,
+                        status.member_ptr());
+        ARROW_RETURN_NOT_OK(to_arrow_status(status));
+
+        std::size_t bitmap_length = static_cast<std::size_t>(count + 7) / 8;
+        for (std::size_t field_idx = 0; field_idx != fields_.size(); ++field_idx) {
+            ukv_1x8_t const* column_validities = validities[field_idx];
+            auto is_valid = [=](std::int64_t i) {
+                return (column_validities[i / 8] >> (i % 8)) & 1;
+            };
+
+            ukv_type_t type = query_.types[field_idx];
+            std::shared_ptr<arrow::Array> column;
+            if (type == ukv_type_str_k || type == ukv_type_bin_k) {
+                arrow::BinaryBuilder binary_builder;
+                arrow::StringBuilder string_builder;
+                arrow::BinaryBuilder& builder = type == ukv_type_str_k ? string_builder : binary_builder;
+                for (std::int64_t i = 0; i != count; ++i)
+                    ARROW_RETURN_NOT_OK(is_valid(i) ? builder.Append(strs_contents + strs_offsets[field_idx][i],
+                                                                     strs_lengths[field_idx][i])
+                                                    : builder.AppendNull());
+                ARROW_RETURN_NOT_OK(builder.Finish(&column));
+            }
+            else if (type == ukv_type_bool_k) {
+                arrow::BooleanBuilder builder;
+                for (std::int64_t i = 0; i != count; ++i)
+                    ARROW_RETURN_NOT_OK(is_valid(i) ? builder.Append(scalars[field_idx][i] != 0)
+                                                    : builder.AppendNull());
+                ARROW_RETURN_NOT_OK(builder.Finish(&column));
+            }
+            else {
+                auto arrow_type = ukv_to_arrow_type(type);
+                auto width = static_cast<arrow::FixedWidthType const&>(*arrow_type).bit_width() / 8;
+                auto data = arrow::ArrayData::Make( //
+                    arrow_type,
+                    count,
+                    {borrow_buffer(column_validities, bitmap_length),
+                     borrow_buffer(scalars[field_idx], static_cast<std::size_t>(count * width))});
+                column = arrow::MakeArray(std::move(data));
+            }
+            columns.push_back(std::move(column));
+        }
+        return arrow::Status::OK();
+    }
+
+  public:
+    collection_reader_t(ukv_t db, ukv_col_t col, query_t query)
+        : db_(db), col_(col), query_(std::move(query)), schema_(query_.schema()), arena_(db),
+          next_key_(query_.min_key) {
+        for (std::string const& field : query_.fields)
+            fields_.push_back(field.c_str());
+    }
+
+    std::shared_ptr<arrow::Schema> schema() const override { return schema_; }
+
+    arrow::Status ReadNext(std::shared_ptr<arrow::RecordBatch>* batch) override {
+        *batch = nullptr;
+        if (next_key_ >= query_.max_key)
+            return arrow::Status::OK();
+
+        status_t status;
+        ukv_key_t* found_keys = nullptr;
+        ukv_val_len_t* found_lengths = nullptr;
+        ukv_scan(db_,
+                 nullptr,
+                 1,
+                 &col_,
+                 0,
+                 &next_key_,
+                 0,
+                 &query_.batch_size,
+                 0,
+                 ukv_options_default_k,
+                 &found_keys,
+                 &found_lengths,
+                 arena_,
+                 status.member_ptr());
+        ARROW_RETURN_NOT_OK(to_arrow_status(status));
+
+        // Keys are sorted and padded with `ukv_key_unknown_k`
+        ukv_size_t count = 0;
+        while (count != query_.batch_size && found_keys[count] < query_.max_key)
+            ++count;
+        if (!count) {
+            next_key_ = query_.max_key;
+            return arrow::Status::OK();
+        }
+
+        // The following reads will overwrite the keys in the arena
+        keys_.assign(found_keys, found_keys + count);
+        next_key_ = count == query_.batch_size ? keys_.back() + 1 : query_.max_key;
+
+        std::vector<std::shared_ptr<arrow::Array>> columns;
+        columns.push_back(arrow::MakeArray(arrow::ArrayData::Make( //
+            arrow::int64(),
+            count,
+            {nullptr, borrow_buffer(keys_.data(), keys_.size() * sizeof(ukv_key_t))},
+            0)));
+        ARROW_RETURN_NOT_OK(query_.fields.empty() ? read_values(count, columns) : gather_fields(count, columns));
+        *batch = arrow::RecordBatch::Make(schema_, count, std::move(columns));
+        return arrow::Status::OK();
+    }
+};
+
+/*********************************************************/
+/*****************	       Service	      ****************/
+/*********************************************************/
 
 class UKVService : public arrow::flight::FlightServerBase {
   public:
-    const arrow::flight::ActionType kActionDropDataset {"drop_dataset", "Delete a dataset."};
+    const arrow::flight::ActionType kActionDropCollection {"drop_collection", "Removes a collection."};
 
-    explicit UKVService(std::shared_ptr<arrow::fs::FileSystem> root) : root_(std::move(root)) {}
+    explicit UKVService(ukv_t db) : db_(db) {}
 
     arrow::Status ListFlights(arrow::flight::ServerCallContext const&,
                               arrow::flight::Criteria const*,
                               std::unique_ptr<arrow::flight::FlightListing>* listings) override {
-        arrow::fs::FileSelector selector;
-        selector.base_dir = "/";
-        ARROW_ASSIGN_OR_RAISE(auto listing, root_->GetFileInfo(selector));
+        status_t status;
+        arena_t arena(db_);
+        ukv_size_t count = 0;
+        ukv_str_view_t names = nullptr;
+        ukv_col_list(db_, &count, &names, arena, status.member_ptr());
+        ARROW_RETURN_NOT_OK(to_arrow_status(status));
 
         std::vector<arrow::flight::FlightInfo> flights;
-        for (const auto& file_info : listing) {
-            if (!file_info.IsFile() || file_info.extension() != "parquet")
-                continue;
-            ARROW_ASSIGN_OR_RAISE(auto info, MakeFlightInfo(file_info));
+        for (; count; --count, names += std::strlen(names) + 1) {
+            query_t query;
+            query.collection = names;
+            ARROW_ASSIGN_OR_RAISE(auto info, MakeFlightInfo(query));
             flights.push_back(std::move(info));
         }
 
@@ -63,15 +590,17 @@ class UKVService : public arrow::flight::FlightServerBase {
     arrow::Status GetFlightInfo(arrow::flight::ServerCallContext const&,
                                 arrow::flight::FlightDescriptor const& descriptor,
                                 std::unique_ptr<arrow::flight::FlightInfo>* info) override {
-        ARROW_ASSIGN_OR_RAISE(auto file_info, FileInfoFromDescriptor(descriptor));
-        ARROW_ASSIGN_OR_RAISE(auto flight_info, MakeFlightInfo(file_info));
+        ARROW_ASSIGN_OR_RAISE(query_t query, parse_descriptor(descriptor));
+        ARROW_ASSIGN_OR_RAISE(auto flight_info, MakeFlightInfo(query));
         *info = std::unique_ptr<arrow::flight::FlightInfo>(new arrow::flight::FlightInfo(std::move(flight_info)));
         return arrow::Status::OK();
     }
 
-    arrow::Status GetSchema(arrow::flight::ServerCallContext const& context,
-                            arrow::flight::FlightDescriptor const& request,
+    arrow::Status GetSchema(arrow::flight::ServerCallContext const&,
+                            arrow::flight::FlightDescriptor const& descriptor,
                             std::unique_ptr<arrow::flight::SchemaResult>* schema) override {
+        ARROW_ASSIGN_OR_RAISE(query_t query, parse_descriptor(descriptor));
+        ARROW_ASSIGN_OR_RAISE(*schema, arrow::flight::SchemaResult::Make(*query.schema()));
         return arrow::Status::OK();
     }
 
@@ -79,106 +608,215 @@ class UKVService : public arrow::flight::FlightServerBase {
                         std::unique_ptr<arrow::flight::FlightMessageReader> reader,
                         std::unique_ptr<arrow::flight::FlightMetadataWriter>) override {
 
-        // ARROW_ASSIGN_OR_RAISE(arrow::Result<std::shared_ptr<arrow::Schema>> schema, reader->GetSchema());
-        // ARROW_ASSIGN_OR_RAISE(arrow::Result<arrow::flight::FlightStreamChunk> chunk, reader->Next());
-
-        ARROW_ASSIGN_OR_RAISE(auto file_info, FileInfoFromDescriptor(reader->descriptor()));
-        ARROW_ASSIGN_OR_RAISE(auto sink, root_->OpenOutputStream(file_info.path()));
-        ARROW_ASSIGN_OR_RAISE(std::shared_ptr<arrow::Table> table, reader->ToTable());
-
-        ARROW_RETURN_NOT_OK(
-            parquet::arrow::WriteTable(*table, arrow::default_memory_pool(), sink, /*chunk_size=*/65536));
+        ARROW_ASSIGN_OR_RAISE(query_t query, parse_descriptor(reader->descriptor()));
+        ARROW_ASSIGN_OR_RAISE(ukv_col_t col, OpenCollection(query.collection));
+        ARROW_ASSIGN_OR_RAISE(std::shared_ptr<arrow::Schema> schema, reader->GetSchema());
+
+        int key_idx = schema->GetFieldIndex("key");
+        if (key_idx < 0 || !schema->field(key_idx)->type()->Equals(arrow::int64()))
+            return arrow::Status::Invalid("Batches must have an int64 \"key\" column");
+        for (auto const& field : schema->fields())
+            if (!is_packable(field->type()->id()))
+                return arrow::Status::NotImplemented("Unsupported column type: ", field->type()->ToString());
+
+        int value_idx = schema->GetFieldIndex("value");
+        auto value_type = value_idx >= 0 ? schema->field(value_idx)->type()->id() : arrow::Type::NA;
+        bool is_binary = schema->num_fields() == 2 && (value_type == arrow::Type::BINARY || //
+                                                       value_type == arrow::Type::STRING);
+
+        arena_t arena(db_);
+        put_buffers_t buffers;
+        while (true) {
+            ARROW_ASSIGN_OR_RAISE(arrow::flight::FlightStreamChunk chunk, reader->Next());
+            if (!chunk.data)
+                break;
+
+            auto const& keys = static_cast<arrow::Int64Array const&>(*chunk.data->column(key_idx));
+            if (keys.null_count())
+                return arrow::Status::Invalid("Keys can't be null");
+            ARROW_RETURN_NOT_OK(is_binary ? PutValues(col, keys, *chunk.data->column(value_idx), arena, buffers)
+                                          : PutDocs(col, keys, *chunk.data, key_idx, arena, buffers));
+        }
         return arrow::Status::OK();
     }
 
     arrow::Status DoGet(arrow::flight::ServerCallContext const&,
                         arrow::flight::Ticket const& request,
                         std::unique_ptr<arrow::flight::FlightDataStream>* stream) override {
-        ARROW_ASSIGN_OR_RAISE(auto input, root_->OpenInputFile(request.ticket));
-        std::unique_ptr<parquet::arrow::FileReader> reader;
-        ARROW_RETURN_NOT_OK(parquet::arrow::OpenFile(std::move(input), arrow::default_memory_pool(), &reader));
-
-        std::shared_ptr<arrow::Table> table;
-        ARROW_RETURN_NOT_OK(reader->ReadTable(&table));
-        // Note that we can't directly pass TableBatchReader to
-        // RecordBatchStream because TableBatchReader keeps a non-owning
-        // reference to the underlying Table, which would then get freed
-        // when we exit this function
-        std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
-        arrow::TableBatchReader batch_reader(*table);
-        ARROW_ASSIGN_OR_RAISE(batches, batch_reader.ToRecordBatches());
-
-        ARROW_ASSIGN_OR_RAISE(auto owning_reader, arrow::RecordBatchReader::Make(std::move(batches), table->schema()));
-        *stream = std::unique_ptr<arrow::flight::FlightDataStream>(new arrow::flight::RecordBatchStream(owning_reader));
-
+        ARROW_ASSIGN_OR_RAISE(query_t query, parse_query(request.ticket));
+        ARROW_ASSIGN_OR_RAISE(ukv_col_t col, OpenCollection(query.collection));
+        auto reader = std::make_shared<collection_reader_t>(db_, col, std::move(query));
+        *stream = std::unique_ptr<arrow::flight::FlightDataStream>(new arrow::flight::RecordBatchStream(reader));
         return arrow::Status::OK();
     }
 
     arrow::Status ListActions(arrow::flight::ServerCallContext const&,
                               std::vector<arrow::flight::ActionType>* actions) override {
-        *actions = {kActionDropDataset};
+        *actions = {kActionDropCollection};
         return arrow::Status::OK();
     }
 
     arrow::Status DoAction(arrow::flight::ServerCallContext const&,
                            arrow::flight::Action const& action,
                            std::unique_ptr<arrow::flight::ResultStream>* result) override {
-        if (action.type == kActionDropDataset.type) {
+        if (action.type == kActionDropCollection.type) {
             *result = std::unique_ptr<arrow::flight::ResultStream>(new arrow::flight::SimpleResultStream({}));
-            return DoActionDropDataset(action.body->ToString());
+            return DoActionDropCollection(action.body->ToString());
         }
         return arrow::Status::NotImplemented("Unknown action type: ", action.type);
     }
 
   private:
-    arrow::Result<arrow::flight::FlightInfo> MakeFlightInfo(arrow::fs::FileInfo const& file_info) {
-        ARROW_ASSIGN_OR_RAISE(auto input, root_->OpenInputFile(file_info));
-        std::unique_ptr<parquet::arrow::FileReader> reader;
-        ARROW_RETURN_NOT_OK(parquet::arrow::OpenFile(std::move(input), arrow::default_memory_pool(), &reader));
+    /// Buffers reused across the batches of a single `DoPut` call.
+    struct put_buffers_t {
+        std::string tape;
+        std::vector<ukv_val_len_t> offsets;
+        std::vector<ukv_val_len_t> lengths;
+        std::vector<ukv_val_ptr_t> values;
+    };
+
+    arrow::Result<ukv_col_t> OpenCollection(std::string const& name) {
+        status_t status;
+        ukv_col_t col = ukv_col_main_k;
+        if (!name.empty())
+            ukv_col_open(db_, name.c_str(), nullptr, &col, status.member_ptr());
+        ARROW_RETURN_NOT_OK(to_arrow_status(status));
+        return col;
+    }
 
-        std::shared_ptr<arrow::Schema> schema;
-        ARROW_RETURN_NOT_OK(reader->GetSchema(&schema));
+    /**
+     * @brief Passes the binary values to `ukv_write` right from the Arrow buffers.
+     * Null values delete the entries.
+     */
+    arrow::Status PutValues(ukv_col_t col,
+                            arrow::Int64Array const& keys,
+                            arrow::Array const& values_array,
+                            arena_t& arena,
+                            put_buffers_t& buffers) {
+
+        auto const& values = static_cast<arrow::BinaryArray const&>(values_array);
+        auto count = values.length();
+        std::int32_t const* offsets = values.raw_value_offsets();
+        auto contents = const_cast<ukv_val_ptr_t>(values.value_data()->data());
+
+        buffers.lengths.resize(count);
+        for (std::int64_t i = 0; i != count; ++i)
+            buffers.lengths[i] = static_cast<ukv_val_len_t>(offsets[i + 1] - offsets[i]);
+        if (values.null_count()) {
+            buffers.values.resize(count);
+            for (std::int64_t i = 0; i != count; ++i)
+                buffers.values[i] = values.IsNull(i) ? nullptr : contents;
+        }
 
-        auto descriptor = arrow::flight::FlightDescriptor::Path({file_info.base_name()});
+        status_t status;
+        ukv_write(db_,
+                  nullptr,
+                  static_cast<ukv_size_t>(count),
+                  &col,
+                  0,
+                  keys.raw_values(),
+                  sizeof(ukv_key_t),
+                  values.null_count() ? buffers.values.data() : &contents,
+                  values.null_count() ? sizeof(ukv_val_ptr_t) : 0,
+                  reinterpret_cast<ukv_val_len_t const*>(offsets),
+                  sizeof(ukv_val_len_t),
+                  buffers.lengths.data(),
+                  sizeof(ukv_val_len_t),
+                  ukv_options_default_k,
+                  arena,
+                  status.member_ptr());
+        return to_arrow_status(status);
+    }
+
+    /**
+     * @brief Packs every row into a MessagePack document, skipping the null cells,
+     * and writes the whole batch at once with `ukv_docs_write`.
+     */
+    arrow::Status PutDocs(ukv_col_t col,
+                          arrow::Int64Array const& keys,
+                          arrow::RecordBatch const& batch,
+                          int key_idx,
+                          arena_t& arena,
+                          put_buffers_t& buffers) {
+
+        auto count = batch.num_rows();
+        auto const& names = batch.schema()->fields();
+        buffers.tape.clear();
+        buffers.offsets.resize(count);
+        buffers.lengths.resize(count);
+        for (std::int64_t row = 0; row != count; ++row) {
+            std::size_t members = 0;
+            for (int column_idx = 0; column_idx != batch.num_columns(); ++column_idx)
+                members += column_idx != key_idx && batch.column(column_idx)->IsValid(row);
+
+            std::size_t begin = buffers.tape.size();
+            msgpack_append_map(buffers.tape, members);
+            for (int column_idx = 0; column_idx != batch.num_columns(); ++column_idx) {
+                arrow::Array const& column = *batch.column(column_idx);
+                if (column_idx == key_idx || column.IsNull(row))
+                    continue;
+                std::string const& name = names[column_idx]->name();
+                msgpack_append_str(buffers.tape, name.data(), name.size());
+                msgpack_append_cell(buffers.tape, column, row);
+            }
+            buffers.offsets[row] = static_cast<ukv_val_len_t>(begin);
+            buffers.lengths[row] = static_cast<ukv_val_len_t>(buffers.tape.size() - begin);
+        }
+
+        status_t status;
+        auto tape = reinterpret_cast<ukv_val_ptr_t>(buffers.tape.data());
+        ukv_docs_write(db_,
+                       nullptr,
+                       static_cast<ukv_size_t>(count),
+                       &col,
+                       0,
+                       keys.raw_values(),
+                       sizeof(ukv_key_t),
+                       nullptr,
+                       0,
+                       ukv_options_default_k,
+                       ukv_format_msgpack_k,
+                       ukv_type_any_k,
+                       &tape,
+                       0,
+                       buffers.offsets.data(),
+                       sizeof(ukv_val_len_t),
+                       buffers.lengths.data(),
+                       sizeof(ukv_val_len_t),
+                       arena,
+                       status.member_ptr());
+        return to_arrow_status(status);
+    }
+
+    arrow::Result<arrow::flight::FlightInfo> MakeFlightInfo(query_t const& query) {
+        auto descriptor = arrow::flight::FlightDescriptor::Command(query.dump());
 
         arrow::flight::FlightEndpoint endpoint;
-        endpoint.ticket.ticket = file_info.base_name();
+        endpoint.ticket.ticket = query.dump();
         arrow::flight::Location location;
         ARROW_ASSIGN_OR_RAISE(location, arrow::flight::Location::ForGrpcTcp("localhost", port()));
         endpoint.locations.push_back(location);
 
-        int64_t total_records = 0; // reader->parquet_reader()->metadata()->num_rows();
-        int64_t total_bytes = file_info.size();
-
-        return arrow::flight::FlightInfo::Make(*schema, descriptor, {endpoint}, total_records, total_bytes);
+        int64_t total_records = -1;
+        int64_t total_bytes = -1;
+        return arrow::flight::FlightInfo::Make(*query.schema(), descriptor, {endpoint}, total_records, total_bytes);
     }
 
-    arrow::Result<arrow::fs::FileInfo> FileInfoFromDescriptor(arrow::flight::FlightDescriptor const& descriptor) {
-        if (descriptor.type != arrow::flight::FlightDescriptor::PATH) {
-            return arrow::Status::Invalid("Must provide PATH-type FlightDescriptor");
-        }
-        else if (descriptor.path.size() != 1) {
-            return arrow::Status::Invalid("Must provide PATH-type FlightDescriptor with one path component");
-        }
-        return root_->GetFileInfo(descriptor.path[0]);
+    arrow::Status DoActionDropCollection(std::string const& name) {
+        status_t status;
+        ukv_col_remove(db_, name.c_str(), status.member_ptr());
+        return to_arrow_status(status);
     }
 
-    arrow::Status DoActionDropDataset(std::string const& key) { return root_->DeleteFile(key); }
-
-    std::shared_ptr<arrow::fs::FileSystem> root_;
+    ukv_t db_ = nullptr;
 };
 
-arrow::Status run_server() {
-    auto fs = std::make_shared<arrow::fs::LocalFileSystem>();
-    ARROW_RETURN_NOT_OK(fs->CreateDir("./flight_datasets/"));
-    ARROW_RETURN_NOT_OK(fs->DeleteDirContents("./flight_datasets/"));
-    auto root = std::make_shared<arrow::fs::SubTreeFileSystem>("./flight_datasets/", fs);
-
+arrow::Status run_server(ukv_t db, int port) {
     arrow::flight::Location server_location;
-    ARROW_ASSIGN_OR_RAISE(server_location, arrow::flight::Location::ForGrpcTcp("0.0.0.0", 38709));
+    ARROW_ASSIGN_OR_RAISE(server_location, arrow::flight::Location::ForGrpcTcp("0.0.0.0", port));
 
     arrow::flight::FlightServerOptions options(server_location);
-    auto server = std::unique_ptr<arrow::flight::FlightServerBase>(new UKVService(std::move(root)));
+    auto server = std::unique_ptr<arrow::flight::FlightServerBase>(new UKVService(db));
     ARROW_RETURN_NOT_OK(server->Init(options));
     std::cout << "Listening on port " << server->port() << std::endl;
     return server->Serve();
@@ -187,5 +825,24 @@ arrow::Status run_server() {
 //------------------------------------------------------------------------------
 
 int main(int argc, char* argv[]) {
-    return run_server().ok() ? EXIT_SUCCESS : EXIT_FAILURE;
+
+    // Parse the arguments
+    auto const port = argc >= 2 ? std::atoi(argv[1]) : 38709;
+    auto db_config = std::string();
+    if (argc >= 3) {
+        std::ifstream ifs(argv[2]);
+        db_config = std::string(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+    }
+
+    db_t db;
+    status_t status = db.open(db_config);
+    if (!status) {
+        std::cerr << "Couldn't initialize DB: " << status.release_exception().what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    arrow::Status served = run_server(db, port);
+    if (!served.ok())
+        std::cerr << served.ToString() << std::endl;
+    return served.ok() ? EXIT_SUCCESS : EXIT_FAILURE;
 }
@@ -4,14 +4,18 @@
  *
  * @brief Embedded Persistent Key-Value Store on top of @b LevelDB.
  * Has no support for collections, transactions or any non-CRUD jobs.
+ * The `ukv_t` handle pairs the native DB with the `metrics_t` of its calls.
  */
 
+#include <numeric> // `std::iota`
+
 #include <leveldb/db.h>
 #include <leveldb/comparator.h>
 #include <leveldb/write_batch.h>
 
 #include "ukv/db.h"
 #include "helpers.hpp"
+#include "metrics.hpp"
 
 using namespace unum::ukv;
 using namespace unum;
@@ -51,6 +55,14 @@ struct key_comparator_t final : public leveldb::Comparator {
 
 static key_comparator_t const key_comparator_k = {};
 
+struct level_handle_t {
+    std::unique_ptr<level_db_t> native;
+    /// Kept to recreate the DB, when all of its entries are removed at once.
+    level_options_t options;
+    std::string path = "./tmp/leveldb/";
+    metrics_t metrics;
+};
+
 /*********************************************************/
 /*****************	 C++ Implementation	  ****************/
 /*********************************************************/
@@ -63,17 +75,6 @@ inline leveldb::Slice to_slice(value_view_t value) noexcept {
     return {reinterpret_cast<const char*>(value.begin()), value.size()};
 }
 
-inline std::unique_ptr<std::string> make_value(ukv_error_t* c_error) noexcept {
-    std::unique_ptr<std::string> value_uptr;
-    try {
-        value_uptr = std::make_unique<std::string>();
-    }
-    catch (...) {
-        *c_error = "Fail to allocate value";
-    }
-    return value_uptr;
-}
-
 bool export_error(level_status_t const& status, ukv_error_t* c_error) {
     if (status.ok())
         return false;
@@ -89,18 +90,76 @@ bool export_error(level_status_t const& status, ukv_error_t* c_error) {
     return true;
 }
 
+/// Number of `Next` steps, after which jumping with a `Seek` is cheaper.
+constexpr std::size_t next_steps_k = 8;
+
+inline ukv_key_t current_key(leveldb::Iterator const& it) noexcept {
+    ukv_key_t key;
+    std::memcpy(&key, it.key().data(), sizeof(ukv_key_t));
+    return key;
+}
+
+/**
+ * @brief Moves a positioned iterator to the first entry not smaller than @p key.
+ * Keys must come in ascending order, so that short distances are covered with
+ * `Next`, and only long jumps re-walk the memtable and the levels with `Seek`.
+ */
+void seek_forward(leveldb::Iterator& it, ukv_key_t key) {
+    for (std::size_t steps = 0; it.Valid() && current_key(it) < key; ++steps) {
+        if (steps == next_steps_k)
+            return it.Seek(to_slice(key));
+        it.Next();
+    }
+}
+
+/**
+ * @brief Serves a batch of point lookups with a single iterator, visiting keys in sorted order.
+ * Calls @p callback with the index of the task and the value, for every found key.
+ */
+template <typename callback_at>
+void sorted_get( //
+    level_db_t& db,
+    read_tasks_soa_t const& tasks,
+    leveldb::ReadOptions const& options,
+    std::vector<ukv_size_t>& order,
+    callback_at&& callback,
+    ukv_error_t* c_error) {
+
+    if (!tasks.count)
+        return;
+
+    order.resize(tasks.count);
+    std::iota(order.begin(), order.end(), ukv_size_t(0));
+    std::sort(order.begin(), order.end(), [&](ukv_size_t a, ukv_size_t b) noexcept {
+        return tasks[a].key < tasks[b].key;
+    });
+
+    level_iter_uptr_t it {db.NewIterator(options)};
+    it->Seek(to_slice(tasks[order.front()].key));
+    for (ukv_size_t task_idx : order) {
+        ukv_key_t const key = tasks[task_idx].key;
+        seek_forward(*it, key);
+        if (!it->Valid())
+            break;
+        if (current_key(*it) == key && !callback(task_idx, it->value()))
+            return;
+    }
+    export_error(it->status(), c_error);
+}
+
 void ukv_db_open(ukv_str_view_t, ukv_t* c_db, ukv_error_t* c_error) {
     try {
+        auto handle = std::make_unique<level_handle_t>();
         level_db_t* db_ptr = nullptr;
-        level_options_t options;
-        options.create_if_missing = true;
-        options.comparator = &key_comparator_k;
-        level_status_t status = level_db_t::Open(options, "./tmp/leveldb/", &db_ptr);
+        handle->options.create_if_missing = true;
+        handle->options.comparator = &key_comparator_k;
+        level_status_t status = level_db_t::Open(handle->options, handle->path, &db_ptr);
         if (!status.ok()) {
             *c_error = "Couldn't open LevelDB";
             return;
         }
-        *c_db = db_ptr;
+        handle->native = std::unique_ptr<level_db_t>(db_ptr);
+        *c_db = handle.release();
     }
     catch (...) {
         *c_error = "Open Failure";
@@ -168,7 +227,9 @@ void ukv_write( //
         return;
     }
 
-    level_db_t& db = *reinterpret_cast<level_db_t*>(c_db);
+    level_handle_t& handle = *reinterpret_cast<level_handle_t*>(c_db);
+    metrics_scope_t metrics {handle.metrics, metric_op_t::write_k, ukv_col_main_k, c_tasks_count, c_error};
+    level_db_t& db = *handle.native;
     strided_iterator_gt<ukv_col_t const> cols {c_cols, c_cols_stride};
     strided_iterator_gt<ukv_key_t const> keys {c_keys, c_keys_stride};
     strided_iterator_gt<ukv_val_ptr_t const> vals {c_vals, c_vals_stride};
@@ -189,6 +250,145 @@ void ukv_write( //
     }
 }
 
+/// Size of a single `WriteBatch` in bulk loads, big enough to amortize the logging overhead.
+constexpr std::size_t bulk_batch_bytes_k = 4ul * 1024ul * 1024ul;
+
+void ukv_bulk_load( //
+    ukv_t const c_db,
+    ukv_size_t const c_tasks_count,
+
+    ukv_col_t const* c_cols,
+    ukv_size_t const c_cols_stride,
+
+    ukv_key_t const* c_keys,
+    ukv_size_t const c_keys_stride,
+
+    ukv_val_ptr_t const* c_vals,
+    ukv_size_t const c_vals_stride,
+
+    ukv_val_len_t const* c_offs,
+    ukv_size_t const c_offs_stride,
+
+    ukv_val_len_t const* c_lens,
+    ukv_size_t const c_lens_stride,
+
+    ukv_options_t const c_options,
+    ukv_arena_t*,
+    ukv_error_t* c_error) {
+
+    if (!c_db) {
+        *c_error = "DataBase is NULL!";
+        return;
+    }
+
+    level_handle_t& handle = *reinterpret_cast<level_handle_t*>(c_db);
+    metrics_scope_t metrics {handle.metrics, metric_op_t::write_k, ukv_col_main_k, c_tasks_count, c_error};
+    level_db_t& db = *handle.native;
+    strided_iterator_gt<ukv_col_t const> cols {c_cols, c_cols_stride};
+    strided_iterator_gt<ukv_key_t const> keys {c_keys, c_keys_stride};
+    strided_iterator_gt<ukv_val_ptr_t const> vals {c_vals, c_vals_stride};
+    strided_iterator_gt<ukv_val_len_t const> offs {c_offs, c_offs_stride};
+    strided_iterator_gt<ukv_val_len_t const> lens {c_lens, c_lens_stride};
+    write_tasks_soa_t tasks {cols, keys, vals, offs, lens, c_tasks_count};
+
+    validate_bulk_load(tasks, c_error);
+    if (*c_error)
+        return;
+
+    // LevelDB can't ingest external tables, so we append sorted runs
+    // in batches much bigger than the regular writes would produce.
+    leveldb::WriteOptions options;
+    try {
+        leveldb::WriteBatch batch;
+        for (ukv_size_t i = 0; i != tasks.count; ++i) {
+            auto task = tasks[i];
+            batch.Put(to_slice(task.key), to_slice(task.view()));
+            if (batch.ApproximateSize() < bulk_batch_bytes_k && i + 1 != tasks.count)
+                continue;
+
+            options.sync = (c_options & ukv_option_write_flush_k) && i + 1 == tasks.count;
+            if (export_error(db.Write(options, &batch), c_error))
+                return;
+            batch.Clear();
+        }
+    }
+    catch (...) {
+        *c_error = "Write Failure";
+    }
+}
+
+/**
+ * @brief Drops all the files of the DB and opens an empty one in the same place.
+ * Is much cheaper, than writing a tombstone for every present key.
+ */
+void recreate(level_handle_t& handle, ukv_error_t* c_error) {
+    handle.native.reset();
+    level_status_t destroy_status = leveldb::DestroyDB(handle.path, handle.options);
+    level_db_t* db_ptr = nullptr;
+    level_status_t open_status = level_db_t::Open(handle.options, handle.path, &db_ptr);
+    handle.native = std::unique_ptr<level_db_t>(db_ptr);
+    if (!export_error(open_status, c_error))
+        export_error(destroy_status, c_error);
+}
+
+void ukv_remove_range( //
+    ukv_t const c_db,
+    ukv_size_t const c_tasks_count,
+
+    ukv_col_t const*,
+    ukv_size_t const,
+
+    ukv_key_t const* c_min_keys,
+    ukv_size_t const c_min_keys_stride,
+
+    ukv_key_t const* c_max_keys,
+    ukv_size_t const c_max_keys_stride,
+
+    ukv_options_t const c_options,
+    ukv_arena_t*,
+    ukv_error_t* c_error) {
+
+    if (!c_db && (*c_error = "DataBase is NULL!"))
+        return;
+
+    level_handle_t& handle = *reinterpret_cast<level_handle_t*>(c_db);
+    metrics_scope_t metrics {handle.metrics, metric_op_t::write_k, ukv_col_main_k, c_tasks_count, c_error};
+    strided_iterator_gt<ukv_key_t const> min_keys {c_min_keys, c_min_keys_stride};
+    strided_iterator_gt<ukv_key_t const> max_keys {c_max_keys, c_max_keys_stride};
+
+    for (ukv_size_t i = 0; i != c_tasks_count; ++i)
+        if (min_keys[i] == std::numeric_limits<ukv_key_t>::min() && max_keys[i] == ukv_key_unknown_k)
+            return recreate(handle, c_error);
+
+    // Partial ranges have to be enumerated, but are deleted in big batches
+    level_db_t& db = *handle.native;
+    leveldb::ReadOptions read_options;
+    read_options.fill_cache = false;
+    leveldb::WriteOptions options;
+    try {
+        leveldb::WriteBatch batch;
+        level_iter_uptr_t it {db.NewIterator(read_options)};
+        for (ukv_size_t i = 0; i != c_tasks_count; ++i) {
+            ukv_key_t const max_key = max_keys[i];
+            for (it->Seek(to_slice(min_keys[i])); it->Valid(); it->Next()) {
+                if (current_key(*it) >= max_key)
+                    break;
+                batch.Delete(it->key());
+                if (batch.ApproximateSize() < bulk_batch_bytes_k)
+                    continue;
+                if (export_error(db.Write(options, &batch), c_error))
+                    return;
+                batch.Clear();
+            }
+        }
+        options.sync = c_options & ukv_option_write_flush_k;
+        export_error(db.Write(options, &batch), c_error);
+    }
+    catch (...) {
+        *c_error = "Write Failure";
+    }
+}
+
 void measure_one( //
     level_db_t& db,
     read_tasks_soa_t const& tasks,
@@ -207,7 +407,7 @@ void measure_one( //
             return;
 
     auto exported_len = status.IsNotFound() ? ukv_val_len_missing_k : static_cast<ukv_size_t>(value.size());
-    auto tape = prepare_memory(arena.output_tape, sizeof(ukv_val_len_t), c_error);
+    auto tape = prepare_memory(arena, arena.output_tape, sizeof(ukv_val_len_t), c_error);
     if (*c_error)
         return;
 
@@ -237,7 +437,7 @@ void read_one( //
     auto bytes_in_value = static_cast<ukv_val_len_t>(value.size());
     auto exported_len = status.IsNotFound() ? ukv_val_len_missing_k : bytes_in_value;
     ukv_val_len_t offset = 0;
-    auto tape = prepare_memory(arena.output_tape, sizeof(ukv_val_len_t) * 2 + bytes_in_value, c_error);
+    auto tape = prepare_memory(arena, arena.output_tape, sizeof(ukv_val_len_t) * 2 + bytes_in_value, c_error);
     if (*c_error)
         return;
 
@@ -254,14 +454,14 @@ void measure_many( //
     level_db_t& db,
     read_tasks_soa_t const& tasks,
     leveldb::ReadOptions const& options,
-    std::string& value,
+    std::string&,
     ukv_val_ptr_t* c_found_values,
     ukv_val_len_t** c_found_offsets,
     ukv_val_len_t** c_found_lengths,
     stl_arena_t& arena,
     ukv_error_t* c_error) {
 
-    byte_t* tape = prepare_memory(arena.output_tape, sizeof(ukv_val_len_t) * tasks.count, c_error);
+    byte_t* tape = prepare_memory(arena, arena.output_tape, sizeof(ukv_val_len_t) * tasks.count, c_error);
     if (*c_error)
         return;
 
@@ -271,64 +471,60 @@ void measure_many( //
     *c_found_offsets = nullptr;
     *c_found_values = nullptr;
 
-    for (ukv_size_t i = 0; i != tasks.count; ++i) {
-        read_task_t task = tasks[i];
-        level_status_t status = db.Get(options, to_slice(task.key), &value);
-        if (status.IsNotFound())
-            continue;
-        if (export_error(status, c_error))
-            return;
-        lens[i] = static_cast<ukv_val_len_t>(value.size());
-    }
+    std::vector<ukv_size_t> order;
+    auto export_length = [&](ukv_size_t task_idx, leveldb::Slice value) noexcept {
+        lens[task_idx] = static_cast<ukv_val_len_t>(value.size());
+        return true;
+    };
+    sorted_get(db, tasks, options, order, export_length, c_error);
 }
 
 void read_many( //
     level_db_t& db,
     read_tasks_soa_t const& tasks,
     leveldb::ReadOptions const& options,
-    std::string& value,
+    std::string&,
     ukv_val_ptr_t* c_found_values,
     ukv_val_len_t** c_found_offsets,
     ukv_val_len_t** c_found_lengths,
     stl_arena_t& arena,
     ukv_error_t* c_error) {
 
-    ukv_size_t lens_bytes = sizeof(ukv_val_len_t) * tasks.count;
-    byte_t* tape = prepare_memory(arena.output_tape, lens_bytes * 2, c_error);
+    // 1. Export the lengths, stashing the values in the order of keys
+    ukv_size_t const lens_bytes = sizeof(ukv_val_len_t) * tasks.count;
+    byte_t* tape = prepare_memory(arena, arena.output_tape, lens_bytes * 2, c_error);
     if (*c_error)
         return;
 
     ukv_val_len_t* lens = reinterpret_cast<ukv_val_len_t*>(tape);
-    ukv_val_len_t* offs = lens + tasks.count;
-    ukv_val_ptr_t contents = reinterpret_cast<ukv_val_ptr_t>(offs + tasks.count);
     std::fill_n(lens, tasks.count * 2, ukv_val_len_missing_k);
 
-    for (ukv_size_t i = 0; i != tasks.count; ++i) {
-        read_task_t task = tasks[i];
-        level_status_t status = db.Get(options, to_slice(task.key), &value);
-        if (status.IsNotFound())
-            continue;
-        if (export_error(status, c_error))
-            return;
-
-        auto old_tape_len = arena.output_tape.size();
-        auto bytes_in_value = value.size();
-        tape = prepare_memory(arena.output_tape, old_tape_len + bytes_in_value, c_error);
+    std::vector<byte_t>& stash = arena.backend_tape;
+    stash.clear();
+    std::vector<ukv_size_t> order;
+    auto stash_value = [&](ukv_size_t task_idx, leveldb::Slice value) noexcept {
+        std::size_t const offset = stash.size();
+        byte_t* stashed = prepare_memory(arena, stash, offset + value.size(), c_error);
         if (*c_error)
-            return;
-
-        lens = reinterpret_cast<ukv_val_len_t*>(tape);
-        offs = lens + tasks.count;
-        contents = reinterpret_cast<ukv_val_ptr_t>(offs + tasks.count);
+            return false;
+        std::memcpy(stashed + offset, value.data(), value.size());
+        lens[task_idx] = static_cast<ukv_val_len_t>(value.size());
+        lens[tasks.count + task_idx] = static_cast<ukv_val_len_t>(offset);
+        return true;
+    };
+    sorted_get(db, tasks, options, order, stash_value, c_error);
+    if (*c_error)
+        return;
 
-        std::memcpy(tape + old_tape_len, value.data(), bytes_in_value);
-        lens[i] = static_cast<ukv_val_len_t>(bytes_in_value);
-        offs[i] = reinterpret_cast<ukv_val_ptr_t>(tape + old_tape_len) - contents;
-    }
+    // 2. Grow the tape once, appending all the values
+    tape = prepare_memory(arena, arena.output_tape, lens_bytes * 2 + stash.size(), c_error);
+    if (*c_error)
+        return;
 
-    *c_found_lengths = lens;
-    *c_found_offsets = offs;
-    *c_found_values = contents;
+    std::memcpy(tape + lens_bytes * 2, stash.data(), stash.size());
+    *c_found_lengths = reinterpret_cast<ukv_val_len_t*>(tape);
+    *c_found_offsets = *c_found_lengths + tasks.count;
+    *c_found_values = reinterpret_cast<ukv_val_ptr_t>(tape + lens_bytes * 2);
 }
 
 void ukv_read( //
@@ -354,17 +550,22 @@ void ukv_read( //
     if (!c_db && (*c_error = "DataBase is NULL!"))
         return;
 
+    level_handle_t& handle = *reinterpret_cast<level_handle_t*>(c_db);
+    metrics_scope_t metrics {handle.metrics, metric_op_t::read_k, ukv_col_main_k, c_tasks_count, c_error, c_arena};
     stl_arena_t& arena = *cast_arena(c_arena, c_error);
     if (*c_error)
         return;
 
-    level_db_t& db = *reinterpret_cast<level_db_t*>(c_db);
+    level_db_t& db = *handle.native;
     leveldb::ReadOptions options;
     strided_iterator_gt<ukv_key_t const> keys {c_keys, c_keys_stride};
     read_tasks_soa_t tasks {{}, keys, c_tasks_count};
 
-    auto value_uptr = make_value(c_error);
-    std::string& value = *value_uptr.get();
+    // Reuse the string from the arena, to avoid allocations in steady state
+    std::string* value_ptr = prepare_memory(arena, arena.strings, 1, c_error);
+    if (*c_error)
+        return;
+    std::string& value = *value_ptr;
 
     try {
         if (c_tasks_count == 1) {
@@ -406,11 +607,14 @@ void ukv_scan( //
     if (!c_db && (*c_error = "DataBase is NULL!"))
         return;
 
+    level_handle_t& handle = *reinterpret_cast<level_handle_t*>(c_db);
+    metrics_scope_t metrics {
+        handle.metrics, metric_op_t::scan_k, ukv_col_main_k, c_min_tasks_count, c_error, c_arena};
     stl_arena_t& arena = *cast_arena(c_arena, c_error);
     if (*c_error)
         return;
 
-    level_db_t& db = *reinterpret_cast<level_db_t*>(c_db);
+    level_db_t& db = *handle.native;
     strided_iterator_gt<ukv_key_t const> keys {c_min_keys, c_min_keys_stride};
     strided_iterator_gt<ukv_size_t const> lens {c_scan_lengths, c_scan_lengths_stride};
     scan_tasks_soa_t tasks {{}, keys, lens, c_min_tasks_count};
@@ -424,7 +628,7 @@ void ukv_scan( //
     if (export_lengths)
         total_bytes += total_lengths * sizeof(ukv_val_len_t);
 
-    byte_t* tape = prepare_memory(arena.output_tape, total_bytes, c_error);
+    byte_t* tape = prepare_memory(arena, arena.output_tape, total_bytes, c_error);
     if (*c_error)
         return;
 
@@ -433,36 +637,50 @@ void ukv_scan( //
     *c_found_keys = found_keys;
     *c_found_lengths = export_lengths ? found_lens : nullptr;
 
+    // Ranges are visited in ascending order, so that the neighbouring ones are reached with `Next`
     level_iter_uptr_t it;
+    std::vector<ukv_size_t> order;
+    std::vector<ukv_size_t> outputs;
     try {
         it = level_iter_uptr_t(db.NewIterator(options));
+        order.resize(c_min_tasks_count);
+        outputs.resize(c_min_tasks_count);
+        for (ukv_size_t i = 1; i < c_min_tasks_count; ++i)
+            outputs[i] = outputs[i - 1] + tasks[i - 1].length;
+        std::iota(order.begin(), order.end(), ukv_size_t(0));
+        std::sort(order.begin(), order.end(), [&](ukv_size_t a, ukv_size_t b) noexcept {
+            return tasks[a].min_key < tasks[b].min_key;
+        });
     }
     catch (...) {
         *c_error = "Fail To Create Iterator";
         return;
     }
-    for (ukv_size_t i = 0; i != c_min_tasks_count; ++i) {
-        scan_task_t task = tasks[i];
-        it->Seek(to_slice(task.min_key));
 
+    for (ukv_size_t task_idx : order) {
+        scan_task_t task = tasks[task_idx];
+        if (it->Valid() && current_key(*it) <= task.min_key)
+            seek_forward(*it, task.min_key);
+        else
+            it->Seek(to_slice(task.min_key));
+
+        ukv_key_t* task_keys = found_keys + outputs[task_idx];
+        ukv_val_len_t* task_lens = found_lens + outputs[task_idx];
         ukv_size_t j = 0;
         for (; it->Valid() && j != task.length; j++, it->Next()) {
-            std::memcpy(&found_keys[j], it->key().data(), sizeof(ukv_key_t));
+            task_keys[j] = current_key(*it);
             if (export_lengths)
-                found_lens[j] = static_cast<ukv_val_len_t>(it->value().size());
+                task_lens[j] = static_cast<ukv_val_len_t>(it->value().size());
         }
 
         while (j != task.length) {
-            found_keys[j] = ukv_key_unknown_k;
+            task_keys[j] = ukv_key_unknown_k;
             if (export_lengths)
-                found_lens[j] = ukv_val_len_missing_k;
+                task_lens[j] = ukv_val_len_missing_k;
             ++j;
         }
-
-        found_keys += task.length;
-        if (export_lengths)
-            found_lens += task.length;
     }
+    export_error(it->status(), c_error);
 }
 
 void ukv_size( //
@@ -489,16 +707,18 @@ void ukv_size( //
     if (!c_db && (*c_error = "DataBase is NULL!"))
         return;
 
+    level_handle_t& handle = *reinterpret_cast<level_handle_t*>(c_db);
+    metrics_scope_t metrics {handle.metrics, metric_op_t::size_k, ukv_col_main_k, n, c_error, c_arena};
     stl_arena_t& arena = *cast_arena(c_arena, c_error);
     if (*c_error)
         return;
 
     std::size_t bytes_needed = sizeof(ukv_size_t) * 6 * n;
-    *c_found_estimates = reinterpret_cast<ukv_size_t*>(prepare_memory(arena.output_tape, bytes_needed, c_error));
+    *c_found_estimates = reinterpret_cast<ukv_size_t*>(prepare_memory(arena, arena.output_tape, bytes_needed, c_error));
     if (*c_error)
         return;
 
-    level_db_t& db = *reinterpret_cast<level_db_t*>(c_db);
+    level_db_t& db = *handle.native;
     strided_iterator_gt<ukv_key_t const> min_keys {c_min_keys, c_min_keys_stride};
     strided_iterator_gt<ukv_key_t const> max_keys {c_max_keys, c_max_keys_stride};
     std::vector<uint64_t> sizes;
@@ -526,6 +746,21 @@ void ukv_size( //
     }
 }
 
+void ukv_changes_since( //
+    ukv_t const,
+    ukv_col_t const,
+    ukv_size_t const,
+    ukv_size_t const,
+    ukv_size_t*,
+    ukv_key_t**,
+    ukv_size_t**,
+    ukv_val_len_t**,
+    ukv_size_t*,
+    ukv_arena_t*,
+    ukv_error_t* c_error) {
+    *c_error = "Change feeds not supported by LevelDB!";
+}
+
 void ukv_col_open( //
     ukv_t const,
     ukv_str_view_t c_col_name,
@@ -537,10 +772,16 @@ void ukv_col_open( //
 }
 
 void ukv_col_remove( //
-    ukv_t const,
-    ukv_str_view_t,
+    ukv_t const c_db,
+    ukv_str_view_t c_col_name,
     ukv_error_t* c_error) {
-    *c_error = "Collections not supported by LevelDB!";
+
+    if (c_col_name && std::strlen(c_col_name) && (*c_error = "Collections not supported by LevelDB!"))
+        return;
+
+    // The main collection is cleared by recreating the whole DB
+    ukv_key_t const min_key = std::numeric_limits<ukv_key_t>::min();
+    ukv_remove_range(c_db, 1, nullptr, 0, &min_key, 0, &ukv_key_unknown_k, 0, ukv_options_default_k, nullptr, c_error);
 }
 
 void ukv_col_list( //
@@ -565,6 +806,21 @@ void ukv_db_control( //
         return;
 
     *c_response = NULL;
+    level_handle_t& handle = *reinterpret_cast<level_handle_t*>(c_db);
+    std::string_view request {c_request};
+    if (request == "metrics" || request == "metrics.prometheus") {
+        thread_local std::string response;
+        try {
+            auto name_of = [](ukv_col_t) { return std::string(); };
+            response = request == "metrics" ? handle.metrics.json(name_of) : handle.metrics.prometheus(name_of);
+            *c_response = response.c_str();
+        }
+        catch (...) {
+            *c_error = "Failed to allocate memory!";
+        }
+        return;
+    }
+
     *c_error = "Controls aren't supported in this implementation!";
 }
 
@@ -585,10 +841,11 @@ void ukv_txn_commit( //
 }
 
 void ukv_arena_free(ukv_t const, ukv_arena_t c_arena) {
-    if (!c_arena)
-        return;
-    stl_arena_t& arena = *reinterpret_cast<stl_arena_t*>(c_arena);
-    delete &arena;
+    release_arena(c_arena);
+}
+
+ukv_size_t ukv_arena_allocations(ukv_t const, ukv_arena_t const c_arena) {
+    return arena_allocations(c_arena);
 }
 
 void ukv_txn_free(ukv_t const, ukv_txn_t) {
@@ -600,8 +857,8 @@ void ukv_col_free(ukv_t const, ukv_col_t const) {
 void ukv_db_free(ukv_t c_db) {
     if (!c_db)
         return;
-    level_db_t* db = reinterpret_cast<level_db_t*>(c_db);
-    delete db;
+    level_handle_t* handle = reinterpret_cast<level_handle_t*>(c_db);
+    delete handle;
 }
 
 void ukv_error_free(ukv_error_t const) {
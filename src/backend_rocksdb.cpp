@@ -15,19 +15,62 @@
  * Moreover, not being the default variant, its significantly less optimized,
  * so after numerous tests we decided to stick to `BlockBasedTable`.
  * https://github.com/facebook/rocksdb/wiki/PlainTable-Format
+ *
+ * @section Configuration
+ * The `ukv_db_open` config is either a path, or a JSON object with tuning knobs.
+ * Presets are applied first, and explicitly passed knobs override them:
+ * {
+ *     "path": "./tmp/rocksdb/",
+ *     "preset": "point_lookups" | "scans",
+ *     "block_cache_bytes": 536870912,
+ *     "block_bytes": 4096,
+ *     "bloom_bits_per_key": 10,
+ *     "compression": "none" | "snappy" | "lz4" | "zstd",
+ *     "max_background_jobs": 4,
+ *     "prefix_bytes": 0,
+ *     "optimistic_transactions": false,
+ *     "statistics": false,
+ *     "wal_ttl_seconds": 0
+ * }
+ * Keys are stored in native little-endian order, so "prefix_bytes" capture
+ * the lowest bytes of keys, and only help point lookups, not the scans.
+ * Enabling "statistics" costs a few percent of throughput, but forwards
+ * the RocksDB tickers into the "metrics" requests of `ukv_db_control`.
+ * Archiving the Write-Ahead Log for "wal_ttl_seconds" lets `ukv_changes_since`
+ * look further back, than the unflushed updates.
+ *
+ * The `ukv_col_open` config overrides the compression of a single collection,
+ * and may enable dictionary compression, which helps with small values:
+ * {"compression": "zstd", "dictionary_bytes": 16384}
+ * Like the other tuning knobs, those aren't persisted and must be passed on every open.
  */
 
+#include <numeric>     // `std::iota`
+#include <string_view> // Parsing the config
+#include <atomic>      // Naming bulk-loaded files
+
 #include <rocksdb/db.h>
-#include <rocksdb/utilities/options_util.h>
+#include <rocksdb/cache.h>
+#include <rocksdb/table.h>
+#include <rocksdb/filter_policy.h>
+#include <rocksdb/slice_transform.h>
+#include <rocksdb/sst_file_writer.h>
+#include <rocksdb/statistics.h>
+#include <rocksdb/convenience.h>
 #include <rocksdb/utilities/transaction_db.h>
+#include <rocksdb/utilities/optimistic_transaction_db.h>
+#include <rocksdb/transaction_log.h>
+#include <nlohmann/json.hpp>
 
 #include "ukv/db.h"
 #include "helpers.hpp"
+#include "metrics.hpp"
+#include "change_feed.hpp"
 
 using namespace unum::ukv;
 using namespace unum;
 
-using rocks_native_t = rocksdb::TransactionDB;
+using rocks_native_t = rocksdb::DB;
 using rocks_status_t = rocksdb::Status;
 using rocks_value_t = rocksdb::PinnableSlice;
 using rocks_txn_t = rocksdb::Transaction;
@@ -50,6 +93,8 @@ struct key_comparator_t final : public rocksdb::Comparator {
         return ai < bi ? -1 : 1;
     }
     const char* Name() const override { return "Integral"; }
+    /// Allows hash indexes within data blocks, as keys are equal only if their bytes are.
+    bool CanKeysWithDifferentByteContentsBeEqual() const override { return false; }
     void FindShortestSeparator(std::string*, const rocksdb::Slice&) const override {}
     void FindShortSuccessor(std::string* key) const override {
         auto& int_key = *reinterpret_cast<ukv_key_t*>(key->data());
@@ -62,6 +107,47 @@ static key_comparator_t key_comparator_k = {};
 struct rocks_db_t {
     std::vector<rocks_col_t*> columns;
     std::unique_ptr<rocks_native_t> native;
+    /// Exactly one of those points to the `native` DB, depending on the config.
+    rocksdb::TransactionDB* pessimistic = nullptr;
+    rocksdb::OptimisticTransactionDB* optimistic = nullptr;
+    /// Options for all the collections, including the newly created ones.
+    rocksdb::ColumnFamilyOptions col_options;
+    std::string path;
+    /// Number of SST files ever built for bulk loads, used to name new ones.
+    std::atomic<std::size_t> bulk_files {0};
+    /// Only collected, if enabled in the config.
+    std::shared_ptr<rocksdb::Statistics> statistics;
+    metrics_t metrics;
+};
+
+/**
+ * @brief RocksDB transactions don't expose the DB they belong to,
+ * so we keep it alongside, to report commits into `rocks_db_t::metrics`.
+ */
+struct rocks_txn_handle_t {
+    rocks_txn_t* native = nullptr;
+    rocks_db_t* db = nullptr;
+    bool is_committed = false;
+};
+
+inline rocks_txn_t* rocks_txn(ukv_txn_t c_txn) noexcept {
+    return c_txn ? reinterpret_cast<rocks_txn_handle_t*>(c_txn)->native : nullptr;
+}
+
+struct rocks_config_t {
+    std::string path = "./tmp/rocksdb/";
+    /// Zero values keep the RocksDB defaults.
+    std::size_t block_cache_bytes = 0;
+    std::size_t block_bytes = 0;
+    double bloom_bits_per_key = 0;
+    rocksdb::CompressionType compression = rocksdb::kSnappyCompression;
+    int max_background_jobs = 2;
+    std::size_t prefix_bytes = 0;
+    bool optimistic_transactions = false;
+    bool hash_data_blocks = false;
+    bool dynamic_level_bytes = false;
+    bool statistics = false;
+    std::uint64_t wal_ttl_seconds = 0;
 };
 
 inline rocksdb::Slice to_slice(ukv_key_t const& key) noexcept {
@@ -102,37 +188,198 @@ rocks_col_t* rocks_collection(rocks_db_t& db, ukv_col_t col) {
     return col == ukv_col_main_k ? db.native->DefaultColumnFamily() : reinterpret_cast<rocks_col_t*>(col);
 }
 
+/// The default column family is reported as the main collection, however it was opened.
+ukv_col_t metrics_col(rocks_db_t& db, ukv_col_t const* cols, ukv_size_t count) {
+    ukv_col_t col = first_col(cols, count);
+    return reinterpret_cast<rocks_col_t*>(col) == db.native->DefaultColumnFamily() ? ukv_col_main_k : col;
+}
+
+/// Counts the transactions, that are reset or freed, discarding their updates.
+void count_abort(rocks_txn_handle_t const& handle) noexcept {
+    if (handle.native && !handle.is_committed && handle.native->GetNumPuts() + handle.native->GetNumDeletes())
+        ++handle.db->metrics.txn_aborts;
+}
+
+bool parse_compression(std::string const& name, rocksdb::CompressionType& compression) noexcept {
+    if (name == "none")
+        compression = rocksdb::kNoCompression;
+    else if (name == "snappy")
+        compression = rocksdb::kSnappyCompression;
+    else if (name == "lz4")
+        compression = rocksdb::kLZ4Compression;
+    else if (name == "zstd")
+        compression = rocksdb::kZSTD;
+    else
+        return false;
+    return true;
+}
+
+/**
+ * @brief Overrides the DB-wide options of a single collection, with the `ukv_col_open` config:
+ * `{"compression": "none" | "snappy" | "lz4" | "zstd", "dictionary_bytes": 16384}`.
+ * Dictionaries are sampled from the data by RocksDB itself, so only their size is configured.
+ */
+bool parse_col_config(ukv_str_view_t c_config, rocksdb::ColumnFamilyOptions& col_options, ukv_error_t* c_error) {
+    std::string_view text = c_config ? c_config : "";
+    if (text.empty())
+        return true;
+
+    try {
+        auto json = nlohmann::json::parse(text);
+        if (json.contains("compression") &&
+            !parse_compression(json["compression"].get<std::string>(), col_options.compression) &&
+            (*c_error = "Unknown RocksDB compression!"))
+            return false;
+
+        auto dictionary_bytes = json.value("dictionary_bytes", std::size_t(0));
+        if (dictionary_bytes) {
+            col_options.compression_opts.max_dict_bytes = static_cast<std::uint32_t>(dictionary_bytes);
+            // Zstd trains better dictionaries, if given ~100x more samples
+            if (col_options.compression == rocksdb::kZSTD)
+                col_options.compression_opts.zstd_max_train_bytes = static_cast<std::uint32_t>(dictionary_bytes * 100);
+        }
+    }
+    catch (nlohmann::json::exception const&) {
+        *c_error = "Invalid RocksDB collection config!";
+        return false;
+    }
+    return true;
+}
+
+bool parse_config(ukv_str_view_t c_config, rocks_config_t& config, ukv_error_t* c_error) {
+    std::string_view text = c_config ? c_config : "";
+    if (text.empty())
+        return true;
+    if (text.front() != '{') {
+        config.path = std::string(text);
+        return true;
+    }
+
+    try {
+        auto json = nlohmann::json::parse(text);
+        auto preset = json.value("preset", std::string {});
+        if (preset == "point_lookups") {
+            config.block_cache_bytes = 512ul * 1024ul * 1024ul;
+            config.block_bytes = 4 * 1024;
+            config.bloom_bits_per_key = 10;
+            config.compression = rocksdb::kLZ4Compression;
+            config.hash_data_blocks = true;
+        }
+        else if (preset == "scans") {
+            config.block_cache_bytes = 256ul * 1024ul * 1024ul;
+            config.block_bytes = 64 * 1024;
+            config.bloom_bits_per_key = 0;
+            config.compression = rocksdb::kZSTD;
+            config.dynamic_level_bytes = true;
+        }
+        else if (!preset.empty() && (*c_error = "Unknown RocksDB preset!"))
+            return false;
+
+        config.path = json.value("path", config.path);
+        config.block_cache_bytes = json.value("block_cache_bytes", config.block_cache_bytes);
+        config.block_bytes = json.value("block_bytes", config.block_bytes);
+        config.bloom_bits_per_key = json.value("bloom_bits_per_key", config.bloom_bits_per_key);
+        config.max_background_jobs = json.value("max_background_jobs", config.max_background_jobs);
+        config.prefix_bytes = json.value("prefix_bytes", config.prefix_bytes);
+        config.optimistic_transactions = json.value("optimistic_transactions", config.optimistic_transactions);
+        config.statistics = json.value("statistics", config.statistics);
+        config.wal_ttl_seconds = json.value("wal_ttl_seconds", config.wal_ttl_seconds);
+
+        if (json.contains("compression") &&
+            !parse_compression(json["compression"].get<std::string>(), config.compression) &&
+            (*c_error = "Unknown RocksDB compression!"))
+            return false;
+    }
+    catch (nlohmann::json::exception const&) {
+        *c_error = "Invalid RocksDB config!";
+        return false;
+    }
+    return true;
+}
+
+void apply_config(rocks_config_t const& config, rocksdb::DBOptions& db_options, rocksdb::ColumnFamilyOptions& col_options) {
+
+    db_options.create_if_missing = true;
+    db_options.max_background_jobs = config.max_background_jobs;
+    db_options.WAL_ttl_seconds = config.wal_ttl_seconds;
+
+    rocksdb::BlockBasedTableOptions table_options;
+    if (config.block_cache_bytes)
+        table_options.block_cache = rocksdb::NewLRUCache(config.block_cache_bytes);
+    if (config.block_bytes)
+        table_options.block_size = config.block_bytes;
+    if (config.bloom_bits_per_key > 0)
+        table_options.filter_policy.reset(rocksdb::NewBloomFilterPolicy(config.bloom_bits_per_key));
+    if (config.hash_data_blocks)
+        table_options.data_block_index_type = rocksdb::BlockBasedTableOptions::kDataBlockBinaryAndHash;
+
+    col_options.comparator = &key_comparator_k;
+    col_options.table_factory.reset(rocksdb::NewBlockBasedTableFactory(table_options));
+    col_options.compression = config.compression;
+    col_options.level_compaction_dynamic_level_bytes = config.dynamic_level_bytes;
+    if (config.prefix_bytes)
+        col_options.prefix_extractor.reset(rocksdb::NewFixedPrefixTransform(config.prefix_bytes));
+    if (config.bloom_bits_per_key > 0 && config.hash_data_blocks) {
+        col_options.memtable_whole_key_filtering = true;
+        col_options.memtable_prefix_bloom_size_ratio = 0.1;
+    }
+}
+
 /*********************************************************/
 /*****************	    C Interface 	  ****************/
 /*********************************************************/
 
-void ukv_db_open(ukv_str_view_t, ukv_t* c_db, ukv_error_t* c_error) {
+void ukv_db_open(ukv_str_view_t c_config, ukv_t* c_db, ukv_error_t* c_error) {
     try {
-        rocks_db_t* db_ptr = new rocks_db_t;
+        rocks_config_t config;
+        if (!parse_config(c_config, config, c_error))
+            return;
+
+        auto db_ptr = std::make_unique<rocks_db_t>();
+        rocksdb::DBOptions options;
+        apply_config(config, options, db_ptr->col_options);
+        if (config.statistics)
+            db_ptr->statistics = options.statistics = rocksdb::CreateDBStatistics();
+
+        // Reopen the existing collections, but with the tuning from the config
+        std::vector<std::string> col_names;
+        rocks_status_t status = rocksdb::DB::ListColumnFamilies(options, config.path, &col_names);
+        if (col_names.empty())
+            col_names.push_back(rocksdb::kDefaultColumnFamilyName);
         std::vector<rocksdb::ColumnFamilyDescriptor> column_descriptors;
-        rocksdb::Options options;
-        rocksdb::ConfigOptions config_options;
-
-        rocks_status_t status =
-            rocksdb::LoadLatestOptions(config_options, "./tmp/rocksdb/", &options, &column_descriptors);
-        if (column_descriptors.empty())
-            column_descriptors.push_back({rocksdb::kDefaultColumnFamilyName, rocksdb::ColumnFamilyOptions()});
-
-        rocks_native_t* native_db = nullptr;
-        options.create_if_missing = true;
-        options.comparator = &key_comparator_k;
-        status = rocks_native_t::Open(options,
-                                      rocksdb::TransactionDBOptions(),
-                                      "./tmp/rocksdb/",
-                                      column_descriptors,
-                                      &db_ptr->columns,
-                                      &native_db);
-
-        db_ptr->native = std::unique_ptr<rocks_native_t>(native_db);
-
-        if (!status.ok())
+        for (auto& col_name : col_names)
+            column_descriptors.push_back({col_name, db_ptr->col_options});
+
+        if (config.optimistic_transactions) {
+            rocksdb::OptimisticTransactionDB* native_db = nullptr;
+            status = rocksdb::OptimisticTransactionDB::Open( //
+                options,
+                config.path,
+                column_descriptors,
+                &db_ptr->columns,
+                &native_db);
+            db_ptr->optimistic = native_db;
+            db_ptr->native = std::unique_ptr<rocks_native_t>(native_db);
+        }
+        else {
+            rocksdb::TransactionDB* native_db = nullptr;
+            status = rocksdb::TransactionDB::Open( //
+                options,
+                rocksdb::TransactionDBOptions(),
+                config.path,
+                column_descriptors,
+                &db_ptr->columns,
+                &native_db);
+            db_ptr->pessimistic = native_db;
+            db_ptr->native = std::unique_ptr<rocks_native_t>(native_db);
+        }
+
+        if (!status.ok()) {
             *c_error = "Open Error";
-        *c_db = db_ptr;
+            return;
+        }
+        db_ptr->path = config.path;
+        *c_db = db_ptr.release();
     }
     catch (...) {
         *c_error = "Open Failure";
@@ -226,7 +473,9 @@ void ukv_write( //
         return;
 
     rocks_db_t& db = *reinterpret_cast<rocks_db_t*>(c_db);
-    rocks_txn_t* txn = reinterpret_cast<rocks_txn_t*>(c_txn);
+    metrics_scope_t metrics {
+        db.metrics, metric_op_t::write_k, metrics_col(db, c_cols, c_tasks_count), c_tasks_count, c_error};
+    rocks_txn_t* txn = rocks_txn(c_txn);
     strided_iterator_gt<ukv_col_t const> cols {c_cols, c_cols_stride};
     strided_iterator_gt<ukv_key_t const> keys {c_keys, c_keys_stride};
     strided_iterator_gt<ukv_val_ptr_t const> vals {c_vals, c_vals_stride};
@@ -247,6 +496,145 @@ void ukv_write( //
     }
 }
 
+/**
+ * @brief Builds an SST file from a sorted run of entries of the same collection
+ * and moves it into the LSM tree, skipping the WAL, the memtables and the
+ * compactions they would trigger.
+ */
+void bulk_load_run( //
+    rocks_db_t& db,
+    write_tasks_soa_t const& tasks,
+    ukv_size_t begin,
+    ukv_size_t end,
+    ukv_error_t* c_error) {
+
+    rocks_col_t* col = rocks_collection(db, tasks[begin].col);
+    std::string file_path = db.path + "/bulk-" + std::to_string(db.bulk_files++) + ".sst";
+    rocksdb::Options options {rocksdb::DBOptions(), db.col_options};
+    rocksdb::SstFileWriter writer {rocksdb::EnvOptions(), options, col};
+
+    if (export_error(writer.Open(file_path), c_error))
+        return;
+    for (ukv_size_t i = begin; i != end; ++i) {
+        write_task_t task = tasks[i];
+        if (export_error(writer.Put(to_slice(task.key), to_slice(task.view())), c_error))
+            break;
+    }
+    if (!*c_error)
+        export_error(writer.Finish(), c_error);
+
+    if (!*c_error) {
+        rocksdb::IngestExternalFileOptions ingest_options;
+        ingest_options.move_files = true;
+        export_error(db.native->IngestExternalFile(col, {file_path}, ingest_options), c_error);
+    }
+    // Moved files are already unlinked, but failed builds must be cleaned
+    if (*c_error)
+        rocksdb::Env::Default()->DeleteFile(file_path);
+}
+
+void ukv_bulk_load( //
+    ukv_t const c_db,
+    ukv_size_t const c_tasks_count,
+
+    ukv_col_t const* c_cols,
+    ukv_size_t const c_cols_stride,
+
+    ukv_key_t const* c_keys,
+    ukv_size_t const c_keys_stride,
+
+    ukv_val_ptr_t const* c_vals,
+    ukv_size_t const c_vals_stride,
+
+    ukv_val_len_t const* c_offs,
+    ukv_size_t const c_offs_stride,
+
+    ukv_val_len_t const* c_lens,
+    ukv_size_t const c_lens_stride,
+
+    ukv_options_t const,
+    ukv_arena_t*,
+    ukv_error_t* c_error) {
+
+    if (!c_db && (*c_error = "DataBase is NULL!"))
+        return;
+
+    rocks_db_t& db = *reinterpret_cast<rocks_db_t*>(c_db);
+    metrics_scope_t metrics {
+        db.metrics, metric_op_t::write_k, metrics_col(db, c_cols, c_tasks_count), c_tasks_count, c_error};
+    strided_iterator_gt<ukv_col_t const> cols {c_cols, c_cols_stride};
+    strided_iterator_gt<ukv_key_t const> keys {c_keys, c_keys_stride};
+    strided_iterator_gt<ukv_val_ptr_t const> vals {c_vals, c_vals_stride};
+    strided_iterator_gt<ukv_val_len_t const> offs {c_offs, c_offs_stride};
+    strided_iterator_gt<ukv_val_len_t const> lens {c_lens, c_lens_stride};
+    write_tasks_soa_t tasks {cols, keys, vals, offs, lens, c_tasks_count};
+
+    validate_bulk_load(tasks, c_error);
+    if (*c_error)
+        return;
+
+    // Ingested files are synced to disk anyway, so flushing options make no difference.
+    // Every run of entries from the same collection becomes a separate file.
+    try {
+        for (ukv_size_t begin = 0, end = 0; begin != tasks.count && !*c_error; begin = end) {
+            for (end = begin + 1; end != tasks.count && tasks[end].col == tasks[begin].col; ++end)
+                ;
+            bulk_load_run(db, tasks, begin, end, c_error);
+        }
+    }
+    catch (...) {
+        *c_error = "Write Failure";
+    }
+}
+
+void ukv_remove_range( //
+    ukv_t const c_db,
+    ukv_size_t const c_tasks_count,
+
+    ukv_col_t const* c_cols,
+    ukv_size_t const c_cols_stride,
+
+    ukv_key_t const* c_min_keys,
+    ukv_size_t const c_min_keys_stride,
+
+    ukv_key_t const* c_max_keys,
+    ukv_size_t const c_max_keys_stride,
+
+    ukv_options_t const c_options,
+    ukv_arena_t*,
+    ukv_error_t* c_error) {
+
+    if (!c_db && (*c_error = "DataBase is NULL!"))
+        return;
+
+    rocks_db_t& db = *reinterpret_cast<rocks_db_t*>(c_db);
+    metrics_scope_t metrics {
+        db.metrics, metric_op_t::write_k, metrics_col(db, c_cols, c_tasks_count), c_tasks_count, c_error};
+    strided_iterator_gt<ukv_col_t const> cols {c_cols, c_cols_stride};
+    strided_iterator_gt<ukv_key_t const> min_keys {c_min_keys, c_min_keys_stride};
+    strided_iterator_gt<ukv_key_t const> max_keys {c_max_keys, c_max_keys_stride};
+    read_tasks_soa_t mins {cols, min_keys, c_tasks_count};
+
+    rocksdb::WriteOptions options;
+    options.sync = c_options & ukv_option_write_flush_k;
+
+    try {
+        rocksdb::WriteBatch batch;
+        for (ukv_size_t i = 0; i != c_tasks_count; ++i) {
+            read_task_t min = mins[i];
+            if (min.key < max_keys[i])
+                batch.DeleteRange(rocks_collection(db, min.col), to_slice(min.key), to_slice(max_keys[i]));
+        }
+
+        // Transactional DBs reject range tombstones, so those go straight into the base DB
+        rocks_status_t status = db.native->GetRootDB()->Write(options, &batch);
+        export_error(status, c_error);
+    }
+    catch (...) {
+        *c_error = "Write Failure";
+    }
+}
+
 void measure_one( //
     rocks_db_t& db,
     rocks_txn_t* txn,
@@ -272,7 +660,7 @@ void measure_one( //
             return;
 
     auto exported_len = status.IsNotFound() ? ukv_val_len_missing_k : static_cast<ukv_size_t>(value.size());
-    auto tape = prepare_memory(arena.output_tape, sizeof(ukv_size_t), c_error);
+    auto tape = prepare_memory(arena, arena.output_tape, sizeof(ukv_size_t), c_error);
     if (*c_error)
         return;
 
@@ -309,7 +697,7 @@ void read_one( //
     auto bytes_in_value = static_cast<ukv_val_len_t>(value.size());
     auto exported_len = status.IsNotFound() ? ukv_val_len_missing_k : bytes_in_value;
     ukv_val_len_t offset = 0;
-    auto tape = prepare_memory(arena.output_tape, sizeof(ukv_val_len_t) * 2 + bytes_in_value, c_error);
+    auto tape = prepare_memory(arena, arena.output_tape, sizeof(ukv_val_len_t) * 2 + bytes_in_value, c_error);
     if (*c_error)
         return;
 
@@ -322,6 +710,57 @@ void read_one( //
     *c_found_values = reinterpret_cast<ukv_val_ptr_t>(tape + sizeof(ukv_val_len_t) * 2);
 }
 
+/**
+ * @brief Batched lookup of all the @p `tasks` with a single `MultiGet` per call.
+ * Keys are sorted by column family and key, so that RocksDB doesn't have to, and
+ * values are pinned in the block cache, instead of being copied into `std::string`s.
+ * The results are left in the sorted order, @p `order` maps them to the @p `tasks`.
+ */
+void multi_get( //
+    rocks_db_t& db,
+    rocks_txn_t* txn,
+    read_tasks_soa_t const& tasks,
+    rocksdb::ReadOptions const& options,
+    std::vector<ukv_size_t>& order,
+    std::vector<rocks_value_t>& values,
+    std::vector<rocks_status_t>& statuses) {
+
+    ukv_size_t const n = tasks.count;
+    std::vector<rocks_col_t*> unsorted_cols(n);
+    std::vector<std::uint32_t> col_ids(n);
+    for (ukv_size_t i = 0; i != n; ++i) {
+        unsorted_cols[i] = rocks_collection(db, tasks[i].col);
+        col_ids[i] = unsorted_cols[i]->GetID();
+    }
+
+    order.resize(n);
+    std::iota(order.begin(), order.end(), ukv_size_t(0));
+    std::sort(order.begin(), order.end(), [&](ukv_size_t a, ukv_size_t b) noexcept {
+        return col_ids[a] != col_ids[b] ? col_ids[a] < col_ids[b] : tasks[a].key < tasks[b].key;
+    });
+
+    std::vector<rocks_col_t*> cols(n);
+    std::vector<rocksdb::Slice> keys(n);
+    for (ukv_size_t i = 0; i != n; ++i) {
+        cols[i] = unsorted_cols[order[i]];
+        keys[i] = to_slice(tasks[order[i]].key);
+    }
+
+    values.resize(n);
+    statuses.resize(n);
+    if (!txn) {
+        db.native->MultiGet(options, n, cols.data(), keys.data(), values.data(), statuses.data(), true);
+        return;
+    }
+
+    // Transactions can only fetch from one column family at a time
+    for (ukv_size_t begin = 0, end = 0; begin != n; begin = end) {
+        for (end = begin + 1; end != n && cols[end] == cols[begin]; ++end)
+            ;
+        txn->MultiGet(options, cols[begin], end - begin, &keys[begin], &values[begin], &statuses[begin], true);
+    }
+}
+
 void measure_many( //
     rocks_db_t& db,
     rocks_txn_t* txn,
@@ -333,21 +772,13 @@ void measure_many( //
     stl_arena_t& arena,
     ukv_error_t* c_error) {
 
-    std::vector<rocks_col_t*> cols(tasks.count);
-    std::vector<rocksdb::Slice> keys(tasks.count);
-    std::vector<std::string> vals(tasks.count);
-    for (ukv_size_t i = 0; i != tasks.count; ++i) {
-        read_task_t task = tasks[i];
-        cols[i] = rocks_collection(db, task.col);
-        keys[i] = to_slice(task.key);
-    }
-
-    std::vector<rocks_status_t> statuses = txn //
-                                               ? txn->MultiGet(options, cols, keys, &vals)
-                                               : db.native->MultiGet(options, cols, keys, &vals);
+    std::vector<ukv_size_t> order;
+    std::vector<rocks_value_t> vals;
+    std::vector<rocks_status_t> statuses;
+    multi_get(db, txn, tasks, options, order, vals, statuses);
 
     ukv_size_t total_bytes = sizeof(ukv_val_len_t) * tasks.count;
-    byte_t* tape = prepare_memory(arena.output_tape, total_bytes, c_error);
+    byte_t* tape = prepare_memory(arena, arena.output_tape, total_bytes, c_error);
     if (*c_error)
         return;
 
@@ -356,8 +787,14 @@ void measure_many( //
     *c_found_offsets = nullptr;
     *c_found_values = nullptr;
 
-    for (ukv_size_t i = 0; i != tasks.count; ++i)
-        lens[i] = statuses[i].IsNotFound() ? ukv_val_len_missing_k : static_cast<ukv_val_len_t>(vals[i].size());
+    for (ukv_size_t i = 0; i != tasks.count; ++i) {
+        if (statuses[i].IsNotFound())
+            lens[order[i]] = ukv_val_len_missing_k;
+        else if (export_error(statuses[i], c_error))
+            return;
+        else
+            lens[order[i]] = static_cast<ukv_val_len_t>(vals[i].size());
+    }
 }
 
 void read_many( //
@@ -371,30 +808,25 @@ void read_many( //
     stl_arena_t& arena,
     ukv_error_t* c_error) {
 
-    std::vector<rocks_col_t*> cols(tasks.count);
-    std::vector<rocksdb::Slice> keys(tasks.count);
-    std::vector<std::string> vals(tasks.count);
-    for (ukv_size_t i = 0; i != tasks.count; ++i) {
-        read_task_t task = tasks[i];
-        cols[i] = rocks_collection(db, task.col);
-        keys[i] = to_slice(task.key);
-    }
-
-    std::vector<rocks_status_t> statuses = txn //
-                                               ? txn->MultiGet(options, cols, keys, &vals)
-                                               : db.native->MultiGet(options, cols, keys, &vals);
+    std::vector<ukv_size_t> order;
+    std::vector<rocks_value_t> vals;
+    std::vector<rocks_status_t> statuses;
+    multi_get(db, txn, tasks, options, order, vals, statuses);
 
     // 1. Estimate the total size
     ukv_size_t total_bytes = sizeof(ukv_val_len_t) * tasks.count * 2;
-    for (ukv_size_t i = 0; i != tasks.count; ++i)
+    for (ukv_size_t i = 0; i != tasks.count; ++i) {
+        if (!statuses[i].ok() && !statuses[i].IsNotFound() && export_error(statuses[i], c_error))
+            return;
         total_bytes += vals[i].size();
+    }
 
     // 2. Allocate a tape for all the values to be fetched
-    byte_t* tape = prepare_memory(arena.output_tape, total_bytes, c_error);
+    byte_t* tape = prepare_memory(arena, arena.output_tape, total_bytes, c_error);
     if (*c_error)
         return;
 
-    // 3. Fetch the data
+    // 3. Copy the pinned values straight into the tape
     ukv_val_len_t* lens = reinterpret_cast<ukv_val_len_t*>(tape);
     ukv_val_len_t* offs = lens + tasks.count;
     ukv_size_t exported_bytes = sizeof(ukv_val_len_t) * tasks.count * 2;
@@ -403,17 +835,18 @@ void read_many( //
     *c_found_values = reinterpret_cast<ukv_val_ptr_t>(tape + exported_bytes);
 
     for (ukv_size_t i = 0; i != tasks.count; ++i) {
-        auto bytes_in_value = vals[i].size();
-        if (bytes_in_value) {
-            std::memcpy(tape + exported_bytes, vals[i].data(), bytes_in_value);
-            lens[i] = static_cast<ukv_val_len_t>(bytes_in_value);
-            offs[i] = reinterpret_cast<ukv_val_ptr_t>(tape + exported_bytes) - *c_found_values;
-            exported_bytes += bytes_in_value;
-        }
-        else {
-            lens[i] = ukv_val_len_missing_k;
-            offs[i] = ukv_val_len_missing_k;
+        ukv_size_t const task_idx = order[i];
+        if (statuses[i].IsNotFound()) {
+            lens[task_idx] = ukv_val_len_missing_k;
+            offs[task_idx] = ukv_val_len_missing_k;
+            continue;
         }
+
+        auto bytes_in_value = vals[i].size();
+        std::memcpy(tape + exported_bytes, vals[i].data(), bytes_in_value);
+        lens[task_idx] = static_cast<ukv_val_len_t>(bytes_in_value);
+        offs[task_idx] = reinterpret_cast<ukv_val_ptr_t>(tape + exported_bytes) - *c_found_values;
+        exported_bytes += bytes_in_value;
     }
 }
 
@@ -440,13 +873,15 @@ void ukv_read( //
     if (!c_db && (*c_error = "DataBase is NULL!"))
         return;
 
+    rocks_db_t& db = *reinterpret_cast<rocks_db_t*>(c_db);
+    metrics_scope_t metrics {
+        db.metrics, metric_op_t::read_k, metrics_col(db, c_cols, c_tasks_count), c_tasks_count, c_error, c_arena};
     if (c_txn && (c_options & ukv_option_read_track_k)) {
         *c_error = "RocksDB only supports transparent reads!";
         return;
     }
 
-    rocks_db_t& db = *reinterpret_cast<rocks_db_t*>(c_db);
-    rocks_txn_t* txn = reinterpret_cast<rocks_txn_t*>(c_txn);
+    rocks_txn_t* txn = rocks_txn(c_txn);
     strided_iterator_gt<ukv_col_t const> cols_stride {c_cols, c_cols_stride};
     strided_iterator_gt<ukv_key_t const> keys_stride {c_keys, c_keys_stride};
     read_tasks_soa_t tasks {cols_stride, keys_stride, c_tasks_count};
@@ -455,6 +890,8 @@ void ukv_read( //
     rocksdb::ReadOptions options;
     if (txn && (c_options & ukv_option_txn_snapshot_k))
         options.snapshot = txn->GetSnapshot();
+    // Let batched lookups prefetch data blocks from disk concurrently
+    options.async_io = c_tasks_count > 1;
 
     try {
         if (c_tasks_count == 1) {
@@ -493,6 +930,16 @@ void ukv_scan( //
     ukv_arena_t* c_arena,
     ukv_error_t* c_error) {
 
+    if (!c_db && (*c_error = "DataBase is NULL!"))
+        return;
+
+    rocks_db_t& db = *reinterpret_cast<rocks_db_t*>(c_db);
+    metrics_scope_t metrics {db.metrics,
+                             metric_op_t::scan_k,
+                             metrics_col(db, c_cols, c_min_tasks_count),
+                             c_min_tasks_count,
+                             c_error,
+                             c_arena};
     if (c_txn && (c_options & ukv_option_read_track_k)) {
         *c_error = "RocksDB only supports transparent reads!";
         return;
@@ -502,8 +949,7 @@ void ukv_scan( //
     if (*c_error)
         return;
 
-    rocks_db_t& db = *reinterpret_cast<rocks_db_t*>(c_db);
-    rocks_txn_t* txn = reinterpret_cast<rocks_txn_t*>(c_txn);
+    rocks_txn_t* txn = rocks_txn(c_txn);
     strided_iterator_gt<ukv_col_t const> cols {c_cols, c_cols_stride};
     strided_iterator_gt<ukv_key_t const> keys {c_min_keys, c_min_keys_stride};
     strided_iterator_gt<ukv_size_t const> lengths {c_scan_lengths, c_scan_lengths_stride};
@@ -512,13 +958,15 @@ void ukv_scan( //
     bool export_lengths = (c_options & ukv_option_read_lengths_k);
     rocksdb::ReadOptions options;
     options.fill_cache = false;
+    // Prefix extractors must not limit iteration to the prefix of the first key
+    options.total_order_seek = true;
 
     ukv_size_t total_lengths = reduce_n(tasks.lengths, tasks.count, 0ul);
     ukv_size_t total_bytes = total_lengths * sizeof(ukv_key_t);
     if (export_lengths)
         total_bytes += total_lengths * sizeof(ukv_val_len_t);
 
-    byte_t* tape = prepare_memory(arena.output_tape, total_bytes, c_error);
+    byte_t* tape = prepare_memory(arena, arena.output_tape, total_bytes, c_error);
     if (*c_error)
         return;
 
@@ -585,73 +1033,228 @@ void ukv_size( //
     if (!c_db && (*c_error = "DataBase is NULL!"))
         return;
 
+    rocks_db_t& db = *reinterpret_cast<rocks_db_t*>(c_db);
+    metrics_scope_t metrics {db.metrics, metric_op_t::size_k, metrics_col(db, c_cols, n), n, c_error, c_arena};
     stl_arena_t& arena = *cast_arena(c_arena, c_error);
     if (*c_error)
         return;
 
     std::size_t bytes_needed = sizeof(ukv_size_t) * 6 * n;
-    *c_found_estimates = reinterpret_cast<ukv_size_t*>(prepare_memory(arena.output_tape, bytes_needed, c_error));
+    *c_found_estimates = reinterpret_cast<ukv_size_t*>(prepare_memory(arena, arena.output_tape, bytes_needed, c_error));
     if (*c_error)
         return;
 
-    rocks_db_t& db = *reinterpret_cast<rocks_db_t*>(c_db);
     strided_iterator_gt<ukv_col_t const> cols {c_cols, c_cols_stride};
     strided_iterator_gt<ukv_key_t const> min_keys {c_min_keys, c_min_keys_stride};
     strided_iterator_gt<ukv_key_t const> max_keys {c_max_keys, c_max_keys_stride};
     rocksdb::SizeApproximationOptions options;
-
-    std::vector<uint64_t> sizes;
-    uint64_t keys_size;
-    uint64_t sst_files_size;
+    options.include_files = true;
+    options.include_memtables = false;
 
     for (ukv_size_t i = 0; i != n; ++i) {
         auto col = rocks_collection(db, cols[i]);
         ukv_key_t const min_key = min_keys[i];
         ukv_key_t const max_key = max_keys[i];
         rocksdb::Range range(to_slice(min_key), to_slice(max_key));
-        try {
-            db.native->GetApproximateSizes(options, col, &range, 1, sizes.data());
-            db.native->GetIntProperty(col, "rocksdb.estimate-num-keys", &keys_size);
-            db.native->GetIntProperty(col, "rocksdb.total-sst-files-size", &sst_files_size);
-        }
-        catch (...) {
-            *c_error = "Property Read Failure";
+
+        // Sizes of the range in SST files and in MemTables are estimated separately.
+        // The keys in files are counted as a share of all the keys, proportional to the
+        // share of the bytes. MemTable entries may overwrite or delete the keys in files,
+        // so they only contribute to the upper bounds.
+        std::uint64_t files_bytes = 0;
+        std::uint64_t memtable_count = 0;
+        std::uint64_t memtable_bytes = 0;
+        std::uint64_t total_count = 0;
+        std::uint64_t total_files_bytes = 0;
+        std::uint64_t files_count = 0;
+        if (min_key < max_key) {
+            if (export_error(db.native->GetApproximateSizes(options, col, &range, 1, &files_bytes), c_error))
+                return;
+            db.native->GetApproximateMemTableStats(col, range, &memtable_count, &memtable_bytes);
+            db.native->GetIntProperty(col, "rocksdb.estimate-num-keys", &total_count);
+            db.native->GetIntProperty(col, "rocksdb.live-sst-files-size", &total_files_bytes);
+            if (total_files_bytes)
+                files_count = static_cast<std::uint64_t>(static_cast<long double>(total_count) * files_bytes /
+                                                         total_files_bytes);
+            files_count = std::min(files_count, total_count);
         }
+        std::uint64_t const files_keys_bytes = files_count * sizeof(ukv_key_t);
+        std::uint64_t const files_values_bytes = files_bytes > files_keys_bytes ? files_bytes - files_keys_bytes : 0;
 
         ukv_size_t* estimates = *c_found_estimates + i * 6;
-        estimates[0] = static_cast<ukv_size_t>(0);
-        estimates[1] = static_cast<ukv_size_t>(keys_size);
-        estimates[2] = static_cast<ukv_size_t>(0);
-        estimates[3] = static_cast<ukv_size_t>(0);
-        estimates[4] = sizes.size();
-        estimates[5] = sst_files_size;
+        estimates[0] = static_cast<ukv_size_t>(files_count);
+        estimates[1] = static_cast<ukv_size_t>(files_count + memtable_count);
+        estimates[2] = static_cast<ukv_size_t>(files_values_bytes);
+        estimates[3] = static_cast<ukv_size_t>(files_values_bytes + memtable_bytes);
+        estimates[4] = static_cast<ukv_size_t>(files_bytes);
+        estimates[5] = static_cast<ukv_size_t>(files_bytes + memtable_bytes);
+    }
+}
+
+/**
+ * @brief Collects the updates of a single column family from the batches in the Write-Ahead Log.
+ * Every update of a batch takes the next sequence number, starting from the one of the batch.
+ */
+struct changes_handler_t final : public rocksdb::WriteBatch::Handler {
+    std::uint32_t col_id = 0;
+    ukv_size_t since = 0;
+    /// Sequence number of the next update in the batch.
+    ukv_size_t sequence = 0;
+    std::vector<change_feed_t::change_t> changes;
+    /// Range removals can't be described per key, so the follower has to rescan.
+    bool has_ranges = false;
+
+    void record(std::uint32_t id, rocksdb::Slice const& key, ukv_val_len_t length) {
+        ukv_size_t const generation = sequence++;
+        if (id != col_id || generation <= since || key.size() != sizeof(ukv_key_t))
+            return;
+        ukv_key_t native_key;
+        std::memcpy(&native_key, key.data(), sizeof(ukv_key_t));
+        changes.push_back({native_key, generation, length});
+    }
+
+    rocks_status_t PutCF(std::uint32_t id, rocksdb::Slice const& key, rocksdb::Slice const& value) override {
+        record(id, key, static_cast<ukv_val_len_t>(value.size()));
+        return rocks_status_t::OK();
+    }
+    rocks_status_t DeleteCF(std::uint32_t id, rocksdb::Slice const& key) override {
+        record(id, key, ukv_val_len_missing_k);
+        return rocks_status_t::OK();
+    }
+    rocks_status_t SingleDeleteCF(std::uint32_t id, rocksdb::Slice const& key) override {
+        return DeleteCF(id, key);
+    }
+    rocks_status_t DeleteRangeCF(std::uint32_t id, rocksdb::Slice const&, rocksdb::Slice const&) override {
+        ukv_size_t const generation = sequence++;
+        has_ranges |= id == col_id && generation > since;
+        return rocks_status_t::OK();
+    }
+};
+
+void ukv_changes_since( //
+    ukv_t const c_db,
+    ukv_col_t const c_col,
+    ukv_size_t const c_generation,
+    ukv_size_t const c_limit,
+
+    ukv_size_t* c_found_count,
+    ukv_key_t** c_found_keys,
+    ukv_size_t** c_found_generations,
+    ukv_val_len_t** c_found_lengths,
+    ukv_size_t* c_next_generation,
+
+    ukv_arena_t* c_arena,
+    ukv_error_t* c_error) {
+
+    if (!c_db && (*c_error = "DataBase is NULL!"))
+        return;
+
+    rocks_db_t& db = *reinterpret_cast<rocks_db_t*>(c_db);
+    metrics_scope_t metrics {db.metrics, metric_op_t::scan_k, metrics_col(db, &c_col, 1), 1, c_error, c_arena};
+    stl_arena_t& arena = *cast_arena(c_arena, c_error);
+    if (*c_error)
+        return;
+
+    ukv_size_t const youngest = db.native->GetLatestSequenceNumber();
+    *c_found_count = 0;
+    *c_next_generation = std::max(c_generation, youngest);
+    if (!c_limit || c_generation >= youngest)
+        return;
+
+    std::unique_ptr<rocksdb::TransactionLogIterator> iterator;
+    rocks_status_t status = db.native->GetUpdatesSince(c_generation + 1, &iterator);
+    if (export_error(status, c_error))
+        return;
+
+    changes_handler_t handler;
+    handler.col_id = rocks_collection(db, c_col)->GetID();
+    handler.since = c_generation;
+    handler.sequence = c_generation + 1;
+    try {
+        // Whole batches are exported, so the updates of a transaction are never split
+        for (; iterator->Valid() && handler.changes.size() < c_limit; iterator->Next()) {
+            // Sequence numbers may be skipped by purged WAL files or by the files ingested in bulk loads
+            rocksdb::BatchResult batch = iterator->GetBatch();
+            if (batch.sequence > handler.sequence &&
+                (*c_error = "Changes since this generation were evicted, a full rescan is needed!"))
+                return;
+            handler.sequence = batch.sequence;
+            status = batch.writeBatchPtr->Iterate(&handler);
+            if (export_error(status, c_error))
+                return;
+            if (handler.has_ranges && (*c_error = "Range removals can't be followed, a full rescan is needed!"))
+                return;
+        }
     }
+    catch (...) {
+        *c_error = "Failed to allocate memory!";
+        return;
+    }
+
+    std::size_t const count = handler.changes.size();
+    std::size_t const bytes_needed = count * (sizeof(ukv_key_t) + sizeof(ukv_size_t) + sizeof(ukv_val_len_t));
+    byte_t* tape = prepare_memory(arena, arena.output_tape, bytes_needed, c_error);
+    if (*c_error)
+        return;
+
+    auto keys = reinterpret_cast<ukv_key_t*>(tape);
+    auto generations = reinterpret_cast<ukv_size_t*>(keys + count);
+    auto lengths = reinterpret_cast<ukv_val_len_t*>(generations + count);
+    for (std::size_t i = 0; i != count; ++i) {
+        change_feed_t::change_t const& change = handler.changes[i];
+        keys[i] = change.key;
+        generations[i] = change.generation;
+        lengths[i] = change.length;
+    }
+
+    *c_found_count = static_cast<ukv_size_t>(count);
+    *c_found_keys = keys;
+    *c_found_generations = generations;
+    *c_found_lengths = lengths;
+    // Past the last read batch, the follower can skip the updates of other collections
+    *c_next_generation = iterator->Valid() ? handler.sequence - 1 : std::max(youngest, handler.sequence - 1);
 }
 
 void ukv_col_open(
     // Inputs:
     ukv_t const c_db,
     ukv_str_view_t c_col_name,
-    ukv_str_view_t,
+    ukv_str_view_t c_config,
     // Outputs:
     ukv_col_t* c_col,
     ukv_error_t* c_error) {
 
     rocks_db_t& db = *reinterpret_cast<rocks_db_t*>(c_db);
+    rocksdb::ColumnFamilyOptions col_options = db.col_options;
+    if (!parse_col_config(c_config, col_options, c_error))
+        return;
+
+    // Existing collections can only switch the compression of the files they will write next
+    auto reconfigure = [&](rocks_col_t* handle) {
+        if (!c_config || !std::strlen(c_config))
+            return;
+        std::string compression;
+        rocks_status_t status = rocksdb::GetStringFromCompressionType(&compression, col_options.compression);
+        if (!export_error(status, c_error))
+            export_error(db.native->SetOptions(handle, {{"compression", compression}}), c_error);
+    };
+
     if (!c_col_name || (c_col_name && !std::strlen(c_col_name))) {
+        reconfigure(db.native->DefaultColumnFamily());
         *c_col = reinterpret_cast<ukv_col_t>(db.native->DefaultColumnFamily());
         return;
     }
 
     for (auto handle : db.columns) {
         if (handle && handle->GetName() == c_col_name) {
+            reconfigure(handle);
             *c_col = reinterpret_cast<ukv_col_t>(handle);
             return;
         }
     }
 
     rocks_col_t* col = nullptr;
-    rocks_status_t status = db.native->CreateColumnFamily(rocksdb::ColumnFamilyOptions(), c_col_name, &col);
+    rocks_status_t status = db.native->CreateColumnFamily(col_options, c_col_name, &col);
     if (!export_error(status, c_error)) {
         db.columns.push_back(col);
         *c_col = reinterpret_cast<ukv_col_t>(col);
@@ -668,13 +1271,8 @@ void ukv_col_remove( //
 
     rocks_db_t& db = *reinterpret_cast<rocks_db_t*>(c_db);
     if (!c_col_name || !std::strlen(c_col_name)) {
-        rocksdb::WriteBatch batch;
-        auto col = db.native->DefaultColumnFamily();
-        auto it = std::unique_ptr<rocksdb::Iterator>(db.native->NewIterator(rocksdb::ReadOptions(), col));
-        for (it->SeekToFirst(); it->Valid(); it->Next())
-            batch.Delete(col, it->key());
-        rocks_status_t status = db.native->Write(rocksdb::WriteOptions(), &batch);
-        export_error(status, c_error);
+        ukv_key_t const min_key = std::numeric_limits<ukv_key_t>::min();
+        ukv_remove_range(c_db, 1, nullptr, 0, &min_key, 0, &ukv_key_unknown_k, 0, ukv_options_default_k, nullptr, c_error);
         return;
     }
 
@@ -713,7 +1311,7 @@ void ukv_col_list( //
     total_length += db.columns.size();
     *c_count = static_cast<ukv_size_t>(db.columns.size());
 
-    auto tape = prepare_memory(arena.output_tape, total_length, c_error);
+    auto tape = prepare_memory(arena, arena.output_tape, total_length, c_error);
     if (*c_error)
         return;
 
@@ -727,11 +1325,55 @@ void ukv_col_list( //
 }
 
 void ukv_db_control( //
-    ukv_t const,
-    ukv_str_view_t,
+    ukv_t const c_db,
+    ukv_str_view_t c_request,
     ukv_str_view_t* c_response,
     ukv_error_t* c_error) {
+
+    if (!c_db && (*c_error = "DataBase is NULL!"))
+        return;
+
+    if (!c_request && (*c_error = "Request is NULL!"))
+        return;
+
     *c_response = NULL;
+    rocks_db_t& db = *reinterpret_cast<rocks_db_t*>(c_db);
+    std::string_view request {c_request};
+    if (request == "metrics" || request == "metrics.prometheus") {
+        thread_local std::string response;
+        bool as_json = request == "metrics";
+        try {
+            auto name_of = [&](ukv_col_t col) -> std::string {
+                if (col == ukv_col_main_k)
+                    return {};
+                for (rocks_col_t* handle : db.columns)
+                    if (reinterpret_cast<ukv_col_t>(handle) == col)
+                        return handle->GetName();
+                // The collection was removed
+                return "#" + std::to_string(col);
+            };
+
+            // Forward the RocksDB tickers, if they are collected
+            std::string tickers;
+            if (db.statistics) {
+                tickers = as_json ? ",\"rocksdb\":{" : "# TYPE ukv_rocksdb_ticker counter\n";
+                for (auto const& [ticker, name] : rocksdb::TickersNameMap) {
+                    std::string count = std::to_string(db.statistics->getTickerCount(ticker));
+                    tickers += as_json ? "\"" + name + "\":" + count + ","
+                                       : "ukv_rocksdb_ticker{name=\"" + name + "\"} " + count + "\n";
+                }
+                if (as_json)
+                    tickers.back() = '}';
+            }
+            response = as_json ? db.metrics.json(name_of, tickers) : db.metrics.prometheus(name_of, tickers);
+            *c_response = response.c_str();
+        }
+        catch (...) {
+            *c_error = "Failed to allocate memory!";
+        }
+        return;
+    }
+
     *c_error = "Controls aren't supported in this implementation!";
 }
 
@@ -744,16 +1386,46 @@ void ukv_txn_begin(
     ukv_txn_t* c_txn,
     ukv_error_t* c_error) {
 
+    if (!c_db && (*c_error = "DataBase is NULL!"))
+        return;
+
     rocks_db_t& db = *reinterpret_cast<rocks_db_t*>(c_db);
-    rocks_txn_t* txn = reinterpret_cast<rocks_txn_t*>(*c_txn);
-    rocksdb::TransactionOptions options;
-    if (c_options & ukv_option_txn_snapshot_k)
-        options.set_snapshot = true;
-    txn = db.native->BeginTransaction(rocksdb::WriteOptions(), options, txn);
-    if (!txn)
-        *c_error = "Couldn't start a transaction!";
+    metrics_scope_t metrics {db.metrics, metric_op_t::txn_begin_k, ukv_col_main_k, 1, c_error};
+    rocks_txn_handle_t* handle = reinterpret_cast<rocks_txn_handle_t*>(*c_txn);
+    if (!handle) {
+        try {
+            handle = new rocks_txn_handle_t;
+        }
+        catch (...) {
+            *c_error = "Failed to initialize the transaction";
+            return;
+        }
+    }
     else
-        *c_txn = txn;
+        count_abort(*handle);
+
+    rocks_txn_t* txn = handle->native;
+    if (db.optimistic) {
+        rocksdb::OptimisticTransactionOptions options;
+        options.set_snapshot = c_options & ukv_option_txn_snapshot_k;
+        txn = db.optimistic->BeginTransaction(rocksdb::WriteOptions(), options, txn);
+    }
+    else {
+        rocksdb::TransactionOptions options;
+        options.set_snapshot = c_options & ukv_option_txn_snapshot_k;
+        txn = db.pessimistic->BeginTransaction(rocksdb::WriteOptions(), options, txn);
+    }
+    if (!txn) {
+        *c_error = "Couldn't start a transaction!";
+        if (!*c_txn)
+            delete handle;
+        return;
+    }
+
+    handle->native = txn;
+    handle->db = &db;
+    handle->is_committed = false;
+    *c_txn = handle;
 }
 
 void ukv_txn_commit( //
@@ -763,18 +1435,27 @@ void ukv_txn_commit( //
 
     if (!c_txn)
         return;
-    rocks_txn_t* txn = reinterpret_cast<rocks_txn_t*>(c_txn);
-    rocks_status_t status = txn->Commit();
-    export_error(status, c_error);
+    rocks_txn_handle_t& handle = *reinterpret_cast<rocks_txn_handle_t*>(c_txn);
+    rocks_status_t status;
+    {
+        metrics_scope_t metrics {handle.db->metrics, metric_op_t::txn_commit_k, ukv_col_main_k, 1, c_error};
+        status = handle.native->Commit();
+        export_error(status, c_error);
+    }
+    // Both pessimistic lock timeouts and optimistic validation failures are conflicts
+    if (status.IsBusy() || status.IsTryAgain() || status.IsTimedOut())
+        ++handle.db->metrics.txn_conflicts;
+    handle.is_committed = status.ok();
 
     // where do we flush?! in transactions and ouside
 }
 
 void ukv_arena_free(ukv_t const, ukv_arena_t c_arena) {
-    if (!c_arena)
-        return;
-    stl_arena_t& arena = *reinterpret_cast<stl_arena_t*>(c_arena);
-    delete &arena;
+    release_arena(c_arena);
+}
+
+ukv_size_t ukv_arena_allocations(ukv_t const, ukv_arena_t const c_arena) {
+    return arena_allocations(c_arena);
 }
 
 void ukv_txn_free(ukv_t const c_db, ukv_txn_t c_txn) {
@@ -783,8 +1464,10 @@ void ukv_txn_free(ukv_t const c_db, ukv_txn_t c_txn) {
     rocks_db_t& db = *reinterpret_cast<rocks_db_t*>(c_db);
     if (!db.native)
         return;
-    rocks_txn_t* txn = reinterpret_cast<rocks_txn_t*>(c_txn);
-    delete txn;
+    rocks_txn_handle_t* handle = reinterpret_cast<rocks_txn_handle_t*>(c_txn);
+    count_abort(*handle);
+    delete handle->native;
+    delete handle;
 }
 
 void ukv_col_free(ukv_t const, ukv_col_t const) {
@@ -0,0 +1,1322 @@
+/**
+ * @file backend_sharded.cpp
+ * @author Ashot Vardanian
+ *
+ * @brief Routes requests across many instances of another backend, like RocksDB or the RPC client.
+ * Every batch is split into per-shard sub-batches, which are submitted in parallel,
+ * and the results are stitched back in the order of tasks. Keys are partitioned
+ * by hash or by ranges. Scans query all the shards, that may contain the following
+ * keys, and merge them.
+ *
+ * @section Configuration
+ * The `ukv_db_open` config lists the configs of underlying instances:
+ * {
+ *     "shards": ["10.0.0.1:38709", "10.0.0.2:38709", "10.0.0.3:38709"],
+ *     "partition": "hash" | "range",
+ *     "boundaries": [1000000, 2000000]
+ * }
+ * For "range" partitioning, the "boundaries" contain the smallest keys of every shard,
+ * but the first one. Shards can also be JSON objects, if the child backend accepts those.
+ * Empty config opens `UKV_SHARDED_DEFAULT_SHARDS` shards with empty configs.
+ * Collection configs are passed to every shard as is, but `"numa_node": "shards"`,
+ * which homes every key shard of `ukv_sharded_stl` to its own NUMA node, @see "numa.hpp".
+ *
+ * @section Limitations
+ * > Transactions are atomic within every shard, but not across them. A commit applies
+ *   shard by shard, stopping at the first failure, so some shards may have been committed.
+ * > Transactions begin on every shard, but only the accessed ones are committed.
+ *   Snapshots are taken on every shard at slightly different moments.
+ * > Scans fetch the full requested length from every candidate shard.
+ * > Generations of different shards are unrelated, so change feeds only work with a single shard.
+ */
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <shared_mutex>
+#include <mutex>     // `std::unique_lock`
+#include <algorithm> // `std::upper_bound`
+#include <numeric>   // `std::partial_sum`
+
+#include <nlohmann/json.hpp> // Parsing the config
+
+#include "ukv/db.h"
+#include "helpers.hpp"
+#include "metrics.hpp"
+#include "sharded_child.hpp"
+
+#if !defined(UKV_SHARDED_DEFAULT_SHARDS)
+#define UKV_SHARDED_DEFAULT_SHARDS 1
+#endif
+
+/*********************************************************/
+/*****************	 C++ Implementation	  ****************/
+/*********************************************************/
+
+using namespace unum::ukv;
+using namespace unum;
+using json_t = nlohmann::json;
+
+namespace {
+
+enum class partition_t {
+    hash_k,
+    range_k,
+};
+
+struct sharded_db_t {
+    std::vector<ukv_t> shards;
+    partition_t partition = partition_t::hash_k;
+    /// The smallest keys of every shard, but the first one, for range partitioning.
+    std::vector<ukv_key_t> boundaries;
+
+    std::shared_mutex mutex;
+    /// Handles of named collections in every shard, laid out in rows of `shards.size()`.
+    std::vector<ukv_col_t> cols;
+    std::unordered_map<std::string, ukv_col_t> names;
+
+    sharded_db_t() = default;
+    sharded_db_t(sharded_db_t const&) = delete;
+    ~sharded_db_t() {
+        for (ukv_t shard : shards)
+            ukv_child_db_free(shard);
+    }
+
+    std::size_t shard_of(ukv_key_t key) const noexcept {
+        if (partition == partition_t::range_k)
+            return std::upper_bound(boundaries.begin(), boundaries.end(), key) - boundaries.begin();
+
+        // Sequential keys must spread evenly, so the bits are mixed, before mapping them with a multiplication
+        auto hash = static_cast<std::uint64_t>(key);
+        hash ^= hash >> 33, hash *= 0xff51afd7ed558ccdull, hash ^= hash >> 33;
+        return static_cast<std::size_t>((static_cast<unsigned __int128>(hash) * shards.size()) >> 64);
+    }
+
+    /// Half-open interval of shards, that may contain keys from @p min_key to @p max_key inclusive.
+    std::pair<std::size_t, std::size_t> shards_of(ukv_key_t min_key, ukv_key_t max_key) const noexcept {
+        if (partition == partition_t::hash_k)
+            return {0, shards.size()};
+        std::size_t first = shard_of(min_key);
+        return {first, std::max(first, shard_of(max_key)) + 1};
+    }
+
+    /// Translates the router @p col into the handle of a child. Must be called under a lock.
+    bool child_col(ukv_col_t col, std::size_t shard, ukv_col_t& child) const noexcept {
+        if (col == ukv_col_main_k)
+            return child = ukv_col_main_k, true;
+        std::size_t row = static_cast<std::size_t>(col - 1) * shards.size();
+        if (row >= cols.size())
+            return false;
+        return child = cols[row + shard], true;
+    }
+};
+
+struct sharded_txn_t {
+    sharded_db_t* db = nullptr;
+    /// Transactions of children, that start together, but only the accessed ones are committed.
+    std::vector<ukv_txn_t> shards;
+    std::vector<std::uint8_t> touched;
+};
+
+/// Results of a single child, that are kept in its arena until stitched.
+struct shard_output_t {
+    ukv_val_ptr_t values = nullptr;
+    ukv_val_len_t* offsets = nullptr;
+    ukv_val_len_t* lengths = nullptr;
+    ukv_key_t* keys = nullptr;
+    ukv_size_t* estimates = nullptr;
+};
+
+/// Arguments of tasks, that are gathered for every shard, in addition to collections and keys.
+enum class batch_args_t {
+    keys_k,
+    ranges_k,
+    scans_k,
+    writes_k,
+};
+
+/**
+ * @brief Tasks of a batch, grouped by shards with a stable counting sort.
+ * The tasks of the `i`-th shard are `origins[offsets[i]]` to `origins[offsets[i + 1]]`,
+ * with their arguments gathered into contiguous arrays at the same positions.
+ */
+struct sharded_batch_t {
+    std::size_t* offsets = nullptr;
+    std::size_t* cursors = nullptr;
+    std::size_t* active = nullptr;
+    std::size_t active_count = 0;
+    shard_output_t* outputs = nullptr;
+
+    ukv_size_t* origins = nullptr;
+    ukv_col_t* cols = nullptr;
+    ukv_key_t* keys = nullptr;
+    ukv_key_t* max_keys = nullptr;
+    ukv_size_t* lengths = nullptr;
+    ukv_val_ptr_t* vals = nullptr;
+    ukv_val_len_t* offs = nullptr;
+    ukv_val_len_t* lens = nullptr;
+
+    std::size_t size(std::size_t shard) const noexcept { return offsets[shard + 1] - offsets[shard]; }
+    /// All the tasks were routed to one shard, so the results are already in order.
+    bool is_single(std::size_t tasks_count) const noexcept {
+        return active_count == 1 && size(active[0]) == tasks_count;
+    }
+};
+
+template <typename at>
+struct carved_gt {
+    at*& begin;
+    std::size_t count;
+};
+
+template <typename at>
+carved_gt<at> carved(at*& begin, std::size_t count) noexcept {
+    return {begin, count};
+}
+
+/// Lays out several arrays in the `backend_tape` of the arena, with a single allocation.
+template <typename... ats>
+void carve_memory(stl_arena_t& arena, ukv_error_t* c_error, carved_gt<ats>... arrays) noexcept {
+    auto padded = [](std::size_t bytes) noexcept { return (bytes + 7) & ~std::size_t(7); };
+    std::size_t const total = (padded(sizeof(ats) * arrays.count) + ... + 0);
+    byte_t* tape = prepare_memory(arena, arena.backend_tape, total, c_error);
+    if (*c_error)
+        return;
+    ((arrays.begin = reinterpret_cast<ats*>(tape), tape += padded(sizeof(ats) * arrays.count)), ...);
+}
+
+/// Errors of children are copied, as they may be kept in thread-local storage of the worker threads.
+thread_local std::string sharded_error;
+
+/**
+ * @brief Groups @p tasks_count tasks by the shards, chosen by @p shards_of, translates their
+ * collections, and allocates the arenas of children. Other arguments are gathered by the caller.
+ */
+template <typename shards_of_at>
+void plan_batch(sharded_db_t& db,
+                stl_arena_t& arena,
+                strided_iterator_gt<ukv_col_t const> cols,
+                std::size_t const tasks_count,
+                batch_args_t const args,
+                shards_of_at&& shards_of,
+                sharded_batch_t& batch,
+                ukv_error_t* c_error) noexcept {
+
+    std::size_t const shards_count = db.shards.size();
+    std::size_t entries = 0;
+    for (std::size_t i = 0; i != tasks_count; ++i) {
+        auto [first, last] = shards_of(i);
+        entries += last - first;
+    }
+
+    auto count_if = [=](bool condition) noexcept { return condition ? entries : 0; };
+    carve_memory(arena,
+                 c_error,
+                 carved(batch.offsets, shards_count + 1),
+                 carved(batch.cursors, shards_count),
+                 carved(batch.active, shards_count),
+                 carved(batch.outputs, shards_count),
+                 carved(batch.origins, entries),
+                 carved(batch.cols, entries),
+                 carved(batch.keys, entries),
+                 carved(batch.max_keys, count_if(args == batch_args_t::ranges_k)),
+                 carved(batch.lengths, count_if(args == batch_args_t::scans_k)),
+                 carved(batch.vals, count_if(args == batch_args_t::writes_k)),
+                 carved(batch.offs, count_if(args == batch_args_t::writes_k)),
+                 carved(batch.lens, count_if(args == batch_args_t::writes_k)));
+    if (*c_error)
+        return;
+
+    try {
+        if (arena.backend_arenas.size() < shards_count)
+            arena.backend_arenas.resize(shards_count, nullptr);
+    }
+    catch (...) {
+        *c_error = "Failed to allocate memory!";
+        return;
+    }
+
+    // Count the tasks of every shard and scatter them in the original order
+    std::fill_n(batch.offsets, shards_count + 1, 0);
+    std::fill_n(batch.outputs, shards_count, shard_output_t {});
+    for (std::size_t i = 0; i != tasks_count; ++i) {
+        auto [first, last] = shards_of(i);
+        for (std::size_t shard = first; shard != last; ++shard)
+            ++batch.offsets[shard + 1];
+    }
+    std::partial_sum(batch.offsets, batch.offsets + shards_count + 1, batch.offsets);
+    std::copy_n(batch.offsets, shards_count, batch.cursors);
+
+    std::shared_lock _ {db.mutex};
+    for (std::size_t i = 0; i != tasks_count; ++i) {
+        auto [first, last] = shards_of(i);
+        ukv_col_t col = cols ? cols[i] : ukv_col_main_k;
+        for (std::size_t shard = first; shard != last; ++shard) {
+            std::size_t entry = batch.cursors[shard]++;
+            batch.origins[entry] = static_cast<ukv_size_t>(i);
+            if (!db.child_col(col, shard, batch.cols[entry]) && (*c_error = "Unknown collection!"))
+                return;
+        }
+    }
+
+    batch.active_count = 0;
+    for (std::size_t shard = 0; shard != shards_count; ++shard)
+        if (batch.size(shard))
+            batch.active[batch.active_count++] = shard;
+}
+
+/// Marks the transactions of children on the active shards, to be committed.
+void touch_txns(sharded_txn_t* txn, sharded_batch_t const& batch) noexcept {
+    if (!txn)
+        return;
+    for (std::size_t i = 0; i != batch.active_count; ++i)
+        txn->touched[batch.active[i]] = 1;
+}
+
+ukv_txn_t child_txn(sharded_txn_t const* txn, std::size_t shard) noexcept {
+    return txn ? txn->shards[shard] : nullptr;
+}
+
+/**
+ * @brief Calls @p callback for every active shard, in parallel, if there are several.
+ * Reports the first error of children, copied into the storage of the calling thread.
+ */
+template <typename callback_at>
+void for_each_shard(sharded_batch_t const& batch, callback_at&& callback, ukv_error_t* c_error) noexcept {
+    std::mutex error_mutex;
+    bool failed = false;
+    ukv_error_t failure = nullptr;
+    std::string& message = sharded_error;
+    auto submit = [&](std::size_t begin, std::size_t end) noexcept {
+        for (std::size_t i = begin; i != end; ++i) {
+            ukv_error_t error = nullptr;
+            callback(batch.active[i], &error);
+            if (!error)
+                continue;
+
+            std::lock_guard _ {error_mutex};
+            if (!std::exchange(failed, true)) {
+                try {
+                    message = error;
+                    failure = message.c_str();
+                }
+                catch (...) {
+                    failure = "Failed to allocate memory!";
+                }
+            }
+            ukv_child_error_free(error);
+        }
+    };
+    parallel_for_chunks(batch.active_count, 1, 0, submit);
+    if (failed)
+        *c_error = failure;
+}
+
+/**
+ * @brief Sums the numbers in JSON objects of different shards,
+ * keeping the worst of latency quantiles, instead of adding them up.
+ */
+void merge_metrics(json_t& merged, json_t const& shard) {
+    for (auto it = shard.begin(); it != shard.end(); ++it) {
+        auto existing = merged.find(it.key());
+        if (existing == merged.end())
+            merged[it.key()] = *it;
+        else if (it->is_object() && existing->is_object())
+            merge_metrics(*existing, *it);
+        else if (it->is_number_unsigned() && existing->is_number_unsigned()) {
+            auto is_quantile = [&](char const* name) { return it.key() == name; };
+            auto a = existing->get<std::uint64_t>();
+            auto b = it->get<std::uint64_t>();
+            bool keep_worst = std::any_of(std::begin(metric_quantile_names_k),
+                                          std::end(metric_quantile_names_k),
+                                          is_quantile);
+            *existing = keep_worst ? std::max(a, b) : a + b;
+        }
+        else if (it->is_number() && existing->is_number())
+            *existing = existing->get<double>() + it->get<double>();
+    }
+}
+
+} // namespace
+
+/*********************************************************/
+/*****************	    C Interface 	  ****************/
+/*********************************************************/
+
+void ukv_db_open( //
+    ukv_str_view_t c_config,
+    ukv_t* c_db,
+    ukv_error_t* c_error) {
+
+    try {
+        auto db_ptr = std::make_unique<sharded_db_t>();
+        std::vector<std::string> configs;
+        auto config = std::string_view(c_config ? c_config : "");
+        if (config.empty())
+            configs.resize(UKV_SHARDED_DEFAULT_SHARDS);
+        else {
+            json_t json = json_t::parse(config, nullptr, false);
+            if (json.is_discarded() || !json.is_object() || !json.contains("shards") || !json["shards"].is_array() ||
+                json["shards"].empty()) {
+                *c_error = "Sharded config must list the shards!";
+                return;
+            }
+            for (json_t const& shard : json["shards"])
+                configs.push_back(shard.is_string() ? shard.get<std::string>() : shard.dump());
+
+            std::string partition = json.value("partition", "hash");
+            if (partition == "range") {
+                db_ptr->partition = partition_t::range_k;
+                db_ptr->boundaries = json.value("boundaries", std::vector<ukv_key_t> {});
+                auto const& boundaries = db_ptr->boundaries;
+                bool is_valid = boundaries.size() + 1 == configs.size() &&
+                                std::adjacent_find(boundaries.begin(), boundaries.end(), std::greater_equal<>()) ==
+                                    boundaries.end();
+                if (!is_valid && (*c_error = "Range shards need ascending boundaries, one less than shards!"))
+                    return;
+            }
+            else if (partition != "hash" && (*c_error = "Unknown partitioning, expected \"hash\" or \"range\"!"))
+                return;
+        }
+
+        db_ptr->shards.reserve(configs.size());
+        for (std::string const& shard_config : configs) {
+            ukv_t shard = nullptr;
+            ukv_child_db_open(shard_config.c_str(), &shard, c_error);
+            if (*c_error)
+                return;
+            db_ptr->shards.push_back(shard);
+        }
+        *c_db = db_ptr.release();
+    }
+    catch (...) {
+        *c_error = "Failed to initialize the database";
+    }
+}
+
+void ukv_read( //
+    ukv_t const c_db,
+    ukv_txn_t const c_txn,
+    ukv_size_t const c_tasks_count,
+
+    ukv_col_t const* c_cols,
+    ukv_size_t const c_cols_stride,
+
+    ukv_key_t const* c_keys,
+    ukv_size_t const c_keys_stride,
+
+    ukv_options_t const c_options,
+
+    ukv_val_ptr_t* c_found_values,
+    ukv_val_len_t** c_found_offsets,
+    ukv_val_len_t** c_found_lengths,
+
+    ukv_arena_t* c_arena,
+    ukv_error_t* c_error) {
+
+    if (!c_db && (*c_error = "DataBase is NULL!"))
+        return;
+
+    stl_arena_t& arena = *cast_arena(c_arena, c_error);
+    if (*c_error)
+        return;
+
+    sharded_db_t& db = *reinterpret_cast<sharded_db_t*>(c_db);
+    sharded_txn_t* txn = reinterpret_cast<sharded_txn_t*>(c_txn);
+    strided_iterator_gt<ukv_col_t const> cols {c_cols, c_cols_stride};
+    strided_iterator_gt<ukv_key_t const> keys {c_keys, c_keys_stride};
+
+    // 1. Group the tasks by shards
+    sharded_batch_t batch;
+    auto shards_of = [&](std::size_t i) noexcept {
+        std::size_t shard = db.shard_of(keys[i]);
+        return std::make_pair(shard, shard + 1);
+    };
+    plan_batch(db, arena, cols, c_tasks_count, batch_args_t::keys_k, shards_of, batch, c_error);
+    if (*c_error)
+        return;
+    for (std::size_t entry = 0; entry != c_tasks_count; ++entry)
+        batch.keys[entry] = keys[batch.origins[entry]];
+    touch_txns(txn, batch);
+
+    // 2. Submit the sub-batches
+    auto read_shard = [&](std::size_t shard, ukv_error_t* error) noexcept {
+        std::size_t offset = batch.offsets[shard];
+        shard_output_t& output = batch.outputs[shard];
+        ukv_child_read(db.shards[shard],
+                       child_txn(txn, shard),
+                       static_cast<ukv_size_t>(batch.size(shard)),
+                       batch.cols + offset,
+                       sizeof(ukv_col_t),
+                       batch.keys + offset,
+                       sizeof(ukv_key_t),
+                       c_options,
+                       &output.values,
+                       &output.offsets,
+                       &output.lengths,
+                       &arena.backend_arenas[shard],
+                       error);
+    };
+    for_each_shard(batch, read_shard, c_error);
+    if (*c_error)
+        return;
+
+    if (batch.is_single(c_tasks_count)) {
+        shard_output_t const& output = batch.outputs[batch.active[0]];
+        *c_found_values = output.values;
+        *c_found_offsets = output.offsets;
+        *c_found_lengths = output.lengths;
+        return;
+    }
+
+    // 3. Stitch the results in the original order, including the contents
+    bool const export_values = !(c_options & ukv_option_read_lengths_k);
+    std::size_t total_bytes = sizeof(ukv_val_len_t) * c_tasks_count * (export_values ? 2 : 1);
+    for (std::size_t i = 0; export_values && i != batch.active_count; ++i) {
+        std::size_t shard = batch.active[i];
+        for (std::size_t j = 0; j != batch.size(shard); ++j)
+            if (batch.outputs[shard].lengths[j] != ukv_val_len_missing_k)
+                total_bytes += batch.outputs[shard].lengths[j];
+    }
+
+    byte_t* tape = prepare_memory(arena, arena.output_tape, total_bytes, c_error);
+    if (*c_error)
+        return;
+
+    auto lens = reinterpret_cast<ukv_val_len_t*>(tape);
+    auto offs = export_values ? lens + c_tasks_count : nullptr;
+    auto contents = reinterpret_cast<byte_t*>(lens + c_tasks_count * (export_values ? 2 : 1));
+    *c_found_lengths = lens;
+    *c_found_offsets = offs;
+    *c_found_values = export_values ? reinterpret_cast<ukv_val_ptr_t>(contents) : nullptr;
+
+    std::fill_n(batch.cursors, db.shards.size(), 0);
+    ukv_val_len_t written = 0;
+    for (std::size_t i = 0; i != c_tasks_count; ++i) {
+        std::size_t shard = db.shard_of(keys[i]);
+        std::size_t j = batch.cursors[shard]++;
+        shard_output_t const& output = batch.outputs[shard];
+        ukv_val_len_t length = lens[i] = output.lengths[j];
+        if (!export_values)
+            continue;
+        if (length == ukv_val_len_missing_k) {
+            offs[i] = ukv_val_len_missing_k;
+            continue;
+        }
+        std::memcpy(contents + written, reinterpret_cast<byte_t const*>(output.values) + output.offsets[j], length);
+        offs[i] = written;
+        written += length;
+    }
+}
+
+/// Gathers the arguments of `ukv_write` and `ukv_bulk_load` for every shard.
+void plan_writes(sharded_db_t& db,
+                 stl_arena_t& arena,
+                 write_tasks_soa_t const& tasks,
+                 sharded_batch_t& batch,
+                 ukv_error_t* c_error) noexcept {
+
+    auto shards_of = [&](std::size_t i) noexcept {
+        std::size_t shard = db.shard_of(tasks.keys[i]);
+        return std::make_pair(shard, shard + 1);
+    };
+    plan_batch(db, arena, tasks.cols, tasks.count, batch_args_t::writes_k, shards_of, batch, c_error);
+    if (*c_error)
+        return;
+
+    // Deletions are passed as NULL values of individual tasks
+    for (std::size_t entry = 0; entry != tasks.count; ++entry) {
+        write_task_t task = tasks[batch.origins[entry]];
+        batch.keys[entry] = task.key;
+        batch.vals[entry] = reinterpret_cast<ukv_val_ptr_t>(const_cast<byte_t*>(task.begin));
+        batch.offs[entry] = task.offset;
+        batch.lens[entry] = task.length;
+    }
+}
+
+void ukv_write( //
+    ukv_t const c_db,
+    ukv_txn_t const c_txn,
+    ukv_size_t const c_tasks_count,
+
+    ukv_col_t const* c_cols,
+    ukv_size_t const c_cols_stride,
+
+    ukv_key_t const* c_keys,
+    ukv_size_t const c_keys_stride,
+
+    ukv_val_ptr_t const* c_vals,
+    ukv_size_t const c_vals_stride,
+
+    ukv_val_len_t const* c_offs,
+    ukv_size_t const c_offs_stride,
+
+    ukv_val_len_t const* c_lens,
+    ukv_size_t const c_lens_stride,
+
+    ukv_options_t const c_options,
+
+    ukv_arena_t* c_arena,
+    ukv_error_t* c_error) {
+
+    if (!c_db && (*c_error = "DataBase is NULL!"))
+        return;
+
+    stl_arena_t& arena = *cast_arena(c_arena, c_error);
+    if (*c_error)
+        return;
+
+    sharded_db_t& db = *reinterpret_cast<sharded_db_t*>(c_db);
+    sharded_txn_t* txn = reinterpret_cast<sharded_txn_t*>(c_txn);
+    strided_iterator_gt<ukv_col_t const> cols {c_cols, c_cols_stride};
+    strided_iterator_gt<ukv_key_t const> keys {c_keys, c_keys_stride};
+    strided_iterator_gt<ukv_val_ptr_t const> vals {c_vals, c_vals_stride};
+    strided_iterator_gt<ukv_val_len_t const> offs {c_offs, c_offs_stride};
+    strided_iterator_gt<ukv_val_len_t const> lens {c_lens, c_lens_stride};
+    write_tasks_soa_t tasks {cols, keys, vals, offs, lens, c_tasks_count};
+
+    sharded_batch_t batch;
+    plan_writes(db, arena, tasks, batch, c_error);
+    if (*c_error)
+        return;
+    touch_txns(txn, batch);
+
+    auto write_shard = [&](std::size_t shard, ukv_error_t* error) noexcept {
+        std::size_t offset = batch.offsets[shard];
+        ukv_child_write(db.shards[shard],
+                        child_txn(txn, shard),
+                        static_cast<ukv_size_t>(batch.size(shard)),
+                        batch.cols + offset,
+                        sizeof(ukv_col_t),
+                        batch.keys + offset,
+                        sizeof(ukv_key_t),
+                        batch.vals + offset,
+                        sizeof(ukv_val_ptr_t),
+                        batch.offs + offset,
+                        sizeof(ukv_val_len_t),
+                        batch.lens + offset,
+                        sizeof(ukv_val_len_t),
+                        c_options,
+                        &arena.backend_arenas[shard],
+                        error);
+    };
+    for_each_shard(batch, write_shard, c_error);
+}
+
+void ukv_bulk_load( //
+    ukv_t const c_db,
+    ukv_size_t const c_tasks_count,
+
+    ukv_col_t const* c_cols,
+    ukv_size_t const c_cols_stride,
+
+    ukv_key_t const* c_keys,
+    ukv_size_t const c_keys_stride,
+
+    ukv_val_ptr_t const* c_vals,
+    ukv_size_t const c_vals_stride,
+
+    ukv_val_len_t const* c_offs,
+    ukv_size_t const c_offs_stride,
+
+    ukv_val_len_t const* c_lens,
+    ukv_size_t const c_lens_stride,
+
+    ukv_options_t const c_options,
+
+    ukv_arena_t* c_arena,
+    ukv_error_t* c_error) {
+
+    if (!c_db && (*c_error = "DataBase is NULL!"))
+        return;
+
+    stl_arena_t& arena = *cast_arena(c_arena, c_error);
+    if (*c_error)
+        return;
+
+    sharded_db_t& db = *reinterpret_cast<sharded_db_t*>(c_db);
+    strided_iterator_gt<ukv_col_t const> cols {c_cols, c_cols_stride};
+    strided_iterator_gt<ukv_key_t const> keys {c_keys, c_keys_stride};
+    strided_iterator_gt<ukv_val_ptr_t const> vals {c_vals, c_vals_stride};
+    strided_iterator_gt<ukv_val_len_t const> offs {c_offs, c_offs_stride};
+    strided_iterator_gt<ukv_val_len_t const> lens {c_lens, c_lens_stride};
+    write_tasks_soa_t tasks {cols, keys, vals, offs, lens, c_tasks_count};
+    validate_bulk_load(tasks, c_error);
+    if (*c_error)
+        return;
+
+    // The grouping is stable, so the sub-batches remain sorted
+    sharded_batch_t batch;
+    plan_writes(db, arena, tasks, batch, c_error);
+    if (*c_error)
+        return;
+
+    auto load_shard = [&](std::size_t shard, ukv_error_t* error) noexcept {
+        std::size_t offset = batch.offsets[shard];
+        ukv_child_bulk_load(db.shards[shard],
+                            static_cast<ukv_size_t>(batch.size(shard)),
+                            batch.cols + offset,
+                            sizeof(ukv_col_t),
+                            batch.keys + offset,
+                            sizeof(ukv_key_t),
+                            batch.vals + offset,
+                            sizeof(ukv_val_ptr_t),
+                            batch.offs + offset,
+                            sizeof(ukv_val_len_t),
+                            batch.lens + offset,
+                            sizeof(ukv_val_len_t),
+                            c_options,
+                            &arena.backend_arenas[shard],
+                            error);
+    };
+    for_each_shard(batch, load_shard, c_error);
+}
+
+void ukv_scan( //
+    ukv_t const c_db,
+    ukv_txn_t const c_txn,
+    ukv_size_t const c_min_tasks_count,
+
+    ukv_col_t const* c_cols,
+    ukv_size_t const c_cols_stride,
+
+    ukv_key_t const* c_min_keys,
+    ukv_size_t const c_min_keys_stride,
+
+    ukv_size_t const* c_scan_lengths,
+    ukv_size_t const c_scan_lengths_stride,
+
+    ukv_options_t const c_options,
+
+    ukv_key_t** c_found_keys,
+    ukv_val_len_t** c_found_lengths,
+
+    ukv_arena_t* c_arena,
+    ukv_error_t* c_error) {
+
+    if (!c_db && (*c_error = "DataBase is NULL!"))
+        return;
+
+    stl_arena_t& arena = *cast_arena(c_arena, c_error);
+    if (*c_error)
+        return;
+
+    sharded_db_t& db = *reinterpret_cast<sharded_db_t*>(c_db);
+    sharded_txn_t* txn = reinterpret_cast<sharded_txn_t*>(c_txn);
+    strided_iterator_gt<ukv_col_t const> cols {c_cols, c_cols_stride};
+    strided_iterator_gt<ukv_key_t const> min_keys {c_min_keys, c_min_keys_stride};
+    strided_iterator_gt<ukv_size_t const> lengths {c_scan_lengths, c_scan_lengths_stride};
+
+    // 1. Every task goes to all the shards, that may contain the following keys
+    sharded_batch_t batch;
+    auto shards_of = [&](std::size_t i) noexcept {
+        return db.shards_of(min_keys[i], std::numeric_limits<ukv_key_t>::max());
+    };
+    plan_batch(db, arena, cols, c_min_tasks_count, batch_args_t::scans_k, shards_of, batch, c_error);
+    if (*c_error)
+        return;
+    for (std::size_t entry = 0; entry != batch.offsets[db.shards.size()]; ++entry) {
+        batch.keys[entry] = min_keys[batch.origins[entry]];
+        batch.lengths[entry] = lengths[batch.origins[entry]];
+    }
+    touch_txns(txn, batch);
+
+    // 2. Submit the sub-batches
+    auto scan_shard = [&](std::size_t shard, ukv_error_t* error) noexcept {
+        std::size_t offset = batch.offsets[shard];
+        shard_output_t& output = batch.outputs[shard];
+        ukv_child_scan(db.shards[shard],
+                       child_txn(txn, shard),
+                       static_cast<ukv_size_t>(batch.size(shard)),
+                       batch.cols + offset,
+                       sizeof(ukv_col_t),
+                       batch.keys + offset,
+                       sizeof(ukv_key_t),
+                       batch.lengths + offset,
+                       sizeof(ukv_size_t),
+                       c_options,
+                       &output.keys,
+                       &output.lengths,
+                       &arena.backend_arenas[shard],
+                       error);
+    };
+    for_each_shard(batch, scan_shard, c_error);
+    if (*c_error)
+        return;
+
+    if (batch.is_single(c_min_tasks_count)) {
+        shard_output_t const& output = batch.outputs[batch.active[0]];
+        *c_found_keys = output.keys;
+        *c_found_lengths = output.lengths;
+        return;
+    }
+
+    // 3. Merge the sorted results of every task, where missing keys are the biggest ones
+    bool const export_lengths = (c_options & ukv_option_read_lengths_k);
+    ukv_size_t const total_lengths = reduce_n(lengths, c_min_tasks_count, 0ul);
+    std::size_t total_bytes = total_lengths * sizeof(ukv_key_t);
+    if (export_lengths)
+        total_bytes += total_lengths * sizeof(ukv_val_len_t);
+
+    byte_t* tape = prepare_memory(arena, arena.output_tape, total_bytes, c_error);
+    if (*c_error)
+        return;
+
+    auto found_keys = reinterpret_cast<ukv_key_t*>(tape);
+    auto found_lens = reinterpret_cast<ukv_val_len_t*>(found_keys + total_lengths);
+    *c_found_keys = found_keys;
+    *c_found_lengths = export_lengths ? found_lens : nullptr;
+
+    // Reuse `cursors` for the beginnings of current tasks in the outputs, and `active` for the keys taken from them
+    std::fill_n(batch.cursors, db.shards.size(), 0);
+    for (std::size_t i = 0; i != c_min_tasks_count; ++i) {
+        std::size_t const length = lengths[i];
+        auto [first, last] = shards_of(i);
+        std::fill(batch.active + first, batch.active + last, 0);
+        for (std::size_t j = 0; j != length; ++j) {
+            std::size_t best = last;
+            ukv_key_t best_key = ukv_key_unknown_k;
+            for (std::size_t shard = first; shard != last; ++shard) {
+                if (batch.active[shard] == length)
+                    continue;
+                ukv_key_t key = batch.outputs[shard].keys[batch.cursors[shard] + batch.active[shard]];
+                if (key < best_key)
+                    best = shard, best_key = key;
+            }
+
+            found_keys[j] = best_key;
+            if (best == last) {
+                if (export_lengths)
+                    found_lens[j] = ukv_val_len_missing_k;
+                continue;
+            }
+            if (export_lengths)
+                found_lens[j] = batch.outputs[best].lengths[batch.cursors[best] + batch.active[best]];
+            ++batch.active[best];
+        }
+        for (std::size_t shard = first; shard != last; ++shard)
+            batch.cursors[shard] += length;
+        found_keys += length;
+        found_lens += length;
+    }
+}
+
+/// Gathers the arguments of `ukv_size` and `ukv_remove_range` for every shard, that overlaps the ranges.
+void plan_ranges(sharded_db_t& db,
+                 stl_arena_t& arena,
+                 strided_iterator_gt<ukv_col_t const> cols,
+                 strided_iterator_gt<ukv_key_t const> min_keys,
+                 strided_iterator_gt<ukv_key_t const> max_keys,
+                 std::size_t const tasks_count,
+                 sharded_batch_t& batch,
+                 ukv_error_t* c_error) noexcept {
+
+    auto shards_of = [&](std::size_t i) noexcept { return db.shards_of(min_keys[i], max_keys[i]); };
+    plan_batch(db, arena, cols, tasks_count, batch_args_t::ranges_k, shards_of, batch, c_error);
+    if (*c_error)
+        return;
+    for (std::size_t entry = 0; entry != batch.offsets[db.shards.size()]; ++entry) {
+        batch.keys[entry] = min_keys[batch.origins[entry]];
+        batch.max_keys[entry] = max_keys[batch.origins[entry]];
+    }
+}
+
+void ukv_size( //
+    ukv_t const c_db,
+    ukv_txn_t const c_txn,
+    ukv_size_t const n,
+
+    ukv_col_t const* c_cols,
+    ukv_size_t const c_cols_stride,
+
+    ukv_key_t const* c_min_keys,
+    ukv_size_t const c_min_keys_stride,
+
+    ukv_key_t const* c_max_keys,
+    ukv_size_t const c_max_keys_stride,
+
+    ukv_options_t const c_options,
+
+    ukv_size_t** c_found_estimates,
+    ukv_arena_t* c_arena,
+    ukv_error_t* c_error) {
+
+    if (!c_db && (*c_error = "DataBase is NULL!"))
+        return;
+
+    stl_arena_t& arena = *cast_arena(c_arena, c_error);
+    if (*c_error)
+        return;
+
+    sharded_db_t& db = *reinterpret_cast<sharded_db_t*>(c_db);
+    sharded_txn_t* txn = reinterpret_cast<sharded_txn_t*>(c_txn);
+    strided_iterator_gt<ukv_col_t const> cols {c_cols, c_cols_stride};
+    strided_iterator_gt<ukv_key_t const> min_keys {c_min_keys, c_min_keys_stride};
+    strided_iterator_gt<ukv_key_t const> max_keys {c_max_keys, c_max_keys_stride};
+
+    sharded_batch_t batch;
+    plan_ranges(db, arena, cols, min_keys, max_keys, n, batch, c_error);
+    if (*c_error)
+        return;
+    touch_txns(txn, batch);
+
+    auto measure_shard = [&](std::size_t shard, ukv_error_t* error) noexcept {
+        std::size_t offset = batch.offsets[shard];
+        ukv_child_size(db.shards[shard],
+                       child_txn(txn, shard),
+                       static_cast<ukv_size_t>(batch.size(shard)),
+                       batch.cols + offset,
+                       sizeof(ukv_col_t),
+                       batch.keys + offset,
+                       sizeof(ukv_key_t),
+                       batch.max_keys + offset,
+                       sizeof(ukv_key_t),
+                       c_options,
+                       &batch.outputs[shard].estimates,
+                       &arena.backend_arenas[shard],
+                       error);
+    };
+    for_each_shard(batch, measure_shard, c_error);
+    if (*c_error)
+        return;
+
+    // Both the lower and the upper bounds add up across shards
+    std::size_t bytes_needed = sizeof(ukv_size_t) * 6 * n;
+    auto estimates = reinterpret_cast<ukv_size_t*>(prepare_memory(arena, arena.output_tape, bytes_needed, c_error));
+    if (*c_error)
+        return;
+
+    *c_found_estimates = estimates;
+    std::fill_n(estimates, 6 * n, 0);
+    for (std::size_t i = 0; i != batch.active_count; ++i) {
+        std::size_t shard = batch.active[i];
+        ukv_size_t const* shard_estimates = batch.outputs[shard].estimates;
+        for (std::size_t j = 0; j != batch.size(shard); ++j)
+            for (std::size_t k = 0; k != 6; ++k)
+                estimates[batch.origins[batch.offsets[shard] + j] * 6 + k] += shard_estimates[j * 6 + k];
+    }
+}
+
+void ukv_remove_range( //
+    ukv_t const c_db,
+    ukv_size_t const n,
+
+    ukv_col_t const* c_cols,
+    ukv_size_t const c_cols_stride,
+
+    ukv_key_t const* c_min_keys,
+    ukv_size_t const c_min_keys_stride,
+
+    ukv_key_t const* c_max_keys,
+    ukv_size_t const c_max_keys_stride,
+
+    ukv_options_t const c_options,
+
+    ukv_arena_t* c_arena,
+    ukv_error_t* c_error) {
+
+    if (!c_db && (*c_error = "DataBase is NULL!"))
+        return;
+
+    stl_arena_t& arena = *cast_arena(c_arena, c_error);
+    if (*c_error)
+        return;
+
+    sharded_db_t& db = *reinterpret_cast<sharded_db_t*>(c_db);
+    strided_iterator_gt<ukv_col_t const> cols {c_cols, c_cols_stride};
+    strided_iterator_gt<ukv_key_t const> min_keys {c_min_keys, c_min_keys_stride};
+    strided_iterator_gt<ukv_key_t const> max_keys {c_max_keys, c_max_keys_stride};
+
+    sharded_batch_t batch;
+    plan_ranges(db, arena, cols, min_keys, max_keys, n, batch, c_error);
+    if (*c_error)
+        return;
+
+    auto remove_shard = [&](std::size_t shard, ukv_error_t* error) noexcept {
+        std::size_t offset = batch.offsets[shard];
+        ukv_child_remove_range(db.shards[shard],
+                               static_cast<ukv_size_t>(batch.size(shard)),
+                               batch.cols + offset,
+                               sizeof(ukv_col_t),
+                               batch.keys + offset,
+                               sizeof(ukv_key_t),
+                               batch.max_keys + offset,
+                               sizeof(ukv_key_t),
+                               c_options,
+                               &arena.backend_arenas[shard],
+                               error);
+    };
+    for_each_shard(batch, remove_shard, c_error);
+}
+
+void ukv_changes_since( //
+    ukv_t const c_db,
+    ukv_col_t const c_col,
+    ukv_size_t const c_generation,
+    ukv_size_t const c_limit,
+
+    ukv_size_t* c_found_count,
+    ukv_key_t** c_found_keys,
+    ukv_size_t** c_found_generations,
+    ukv_val_len_t** c_found_lengths,
+    ukv_size_t* c_next_generation,
+
+    ukv_arena_t* c_arena,
+    ukv_error_t* c_error) {
+
+    if (!c_db && (*c_error = "DataBase is NULL!"))
+        return;
+
+    stl_arena_t& arena = *cast_arena(c_arena, c_error);
+    if (*c_error)
+        return;
+
+    sharded_db_t& db = *reinterpret_cast<sharded_db_t*>(c_db);
+    if (db.shards.size() != 1 && (*c_error = "Change feeds aren't supported across shards!"))
+        return;
+
+    ukv_col_t col = ukv_col_main_k;
+    {
+        std::shared_lock _ {db.mutex};
+        if (!db.child_col(c_col, 0, col) && (*c_error = "Unknown collection!"))
+            return;
+    }
+
+    try {
+        if (arena.backend_arenas.empty())
+            arena.backend_arenas.resize(1, nullptr);
+    }
+    catch (...) {
+        *c_error = "Failed to allocate memory!";
+        return;
+    }
+
+    ukv_child_changes_since(db.shards.front(),
+                            col,
+                            c_generation,
+                            c_limit,
+                            c_found_count,
+                            c_found_keys,
+                            c_found_generations,
+                            c_found_lengths,
+                            c_next_generation,
+                            &arena.backend_arenas.front(),
+                            c_error);
+}
+
+/*********************************************************/
+/*****************	Collections Management	****************/
+/*********************************************************/
+
+void ukv_col_open(
+    // Inputs:
+    ukv_t const c_db,
+    ukv_str_view_t c_col_name,
+    ukv_str_view_t c_config,
+    // Outputs:
+    ukv_col_t* c_col,
+    ukv_error_t* c_error) {
+
+    if (!c_db && (*c_error = "DataBase is NULL!"))
+        return;
+
+    sharded_db_t& db = *reinterpret_cast<sharded_db_t*>(c_db);
+    std::size_t const shards_count = db.shards.size();
+    auto col_name = std::string_view(c_col_name ? c_col_name : "");
+    std::unique_lock _ {db.mutex};
+
+    // Every shard has all of the collections, even empty ones, and applies the same config to them
+    std::vector<ukv_col_t> handles;
+    json_t config;
+    bool numa_shards = false;
+    try {
+        handles.resize(shards_count);
+        config = json_t::parse(c_config ? c_config : "", nullptr, false);
+        numa_shards = config.is_object() && config.value("numa_node", json_t {}) == "shards";
+    }
+    catch (...) {
+        *c_error = "Failed to allocate memory!";
+        return;
+    }
+    for (std::size_t shard = 0; shard != shards_count; ++shard) {
+        // Shards are spread across NUMA nodes, and children wrap the index around the number of nodes
+        std::string shard_config;
+        if (numa_shards) {
+            try {
+                config["numa_node"] = shard;
+                shard_config = config.dump();
+            }
+            catch (...) {
+                *c_error = "Failed to allocate memory!";
+                return;
+            }
+        }
+        auto child_config = numa_shards ? shard_config.c_str() : c_config;
+        ukv_child_col_open(db.shards[shard], c_col_name ? c_col_name : "", child_config, &handles[shard], c_error);
+        if (*c_error)
+            return;
+    }
+    if (col_name.empty()) {
+        *c_col = ukv_col_main_k;
+        return;
+    }
+
+    try {
+        auto name_it = db.names.find(std::string(col_name));
+        if (name_it == db.names.end()) {
+            db.cols.insert(db.cols.end(), handles.begin(), handles.end());
+            auto col = static_cast<ukv_col_t>(db.cols.size() / shards_count);
+            name_it = db.names.emplace(std::string(col_name), col).first;
+        }
+        else
+            std::copy(handles.begin(), handles.end(), db.cols.begin() + (name_it->second - 1) * shards_count);
+        *c_col = name_it->second;
+    }
+    catch (...) {
+        *c_error = "Failed to create a new col!";
+    }
+}
+
+void ukv_col_remove(
+    // Inputs:
+    ukv_t const c_db,
+    ukv_str_view_t c_col_name,
+    // Outputs:
+    ukv_error_t* c_error) {
+
+    if (!c_db && (*c_error = "DataBase is NULL!"))
+        return;
+
+    sharded_db_t& db = *reinterpret_cast<sharded_db_t*>(c_db);
+    auto col_name = std::string_view(c_col_name ? c_col_name : "");
+    std::unique_lock _ {db.mutex};
+    for (ukv_t shard : db.shards) {
+        ukv_child_col_remove(shard, c_col_name ? c_col_name : "", c_error);
+        if (*c_error)
+            return;
+    }
+
+    // The handles of removed collections are never reused
+    if (!col_name.empty())
+        db.names.erase(std::string(col_name));
+}
+
+void ukv_col_list( //
+    ukv_t const c_db,
+    ukv_size_t* c_count,
+    ukv_str_view_t* c_names,
+    ukv_arena_t* c_arena,
+    ukv_error_t* c_error) {
+
+    if (!c_db && (*c_error = "DataBase is NULL!"))
+        return;
+
+    stl_arena_t& arena = *cast_arena(c_arena, c_error);
+    if (*c_error)
+        return;
+
+    try {
+        if (arena.backend_arenas.empty())
+            arena.backend_arenas.resize(1, nullptr);
+    }
+    catch (...) {
+        *c_error = "Failed to allocate memory!";
+        return;
+    }
+
+    // All the shards have the same collections
+    sharded_db_t& db = *reinterpret_cast<sharded_db_t*>(c_db);
+    ukv_child_col_list(db.shards.front(), c_count, c_names, &arena.backend_arenas.front(), c_error);
+}
+
+void ukv_db_control( //
+    ukv_t const c_db,
+    ukv_str_view_t c_request,
+    ukv_str_view_t* c_response,
+    ukv_error_t* c_error) {
+
+    if (!c_db && (*c_error = "DataBase is NULL!"))
+        return;
+
+    if (!c_request && (*c_error = "Request is NULL!"))
+        return;
+
+    *c_response = NULL;
+    sharded_db_t& db = *reinterpret_cast<sharded_db_t*>(c_db);
+    std::string_view request {c_request};
+    thread_local std::string response;
+
+    // Collections span all the shards, so they only have a home, if there is just one
+    constexpr std::string_view numa_node_k = "numa_node:";
+    if (request.substr(0, numa_node_k.size()) == numa_node_k) {
+        auto col = static_cast<ukv_col_t>(std::strtoull(c_request + numa_node_k.size(), nullptr, 10));
+        ukv_col_t child = ukv_col_main_k;
+        {
+            std::shared_lock _ {db.mutex};
+            if (!db.child_col(col, 0, child) && (*c_error = "Unknown collection!"))
+                return;
+        }
+        if (db.shards.size() != 1) {
+            *c_response = "any";
+            return;
+        }
+        try {
+            response = std::string(numa_node_k) + std::to_string(child);
+        }
+        catch (...) {
+            *c_error = "Failed to allocate memory!";
+            return;
+        }
+        return ukv_child_db_control(db.shards.front(), response.c_str(), c_response, c_error);
+    }
+
+    try {
+        // JSON objects of different shards are merged, the other responses are concatenated
+        json_t merged = json_t::object();
+        bool all_json = true, any_response = false;
+        response.clear();
+        for (ukv_t shard : db.shards) {
+            ukv_str_view_t shard_response = nullptr;
+            ukv_child_db_control(shard, c_request, &shard_response, c_error);
+            if (*c_error)
+                return;
+            if (!shard_response)
+                continue;
+
+            json_t parsed = json_t::parse(shard_response, nullptr, false);
+            all_json &= !parsed.is_discarded() && parsed.is_object();
+            if (all_json)
+                merge_metrics(merged, parsed);
+            if (any_response)
+                response += '\n';
+            response += shard_response;
+            any_response = true;
+        }
+
+        if (request == "reset") {
+            std::unique_lock _ {db.mutex};
+            db.names.clear();
+        }
+        if (!any_response)
+            return;
+        if (all_json)
+            response = merged.dump();
+        *c_response = response.c_str();
+    }
+    catch (...) {
+        *c_error = "Failed to allocate memory!";
+    }
+}
+
+/*********************************************************/
+/*****************		Transactions	  ****************/
+/*********************************************************/
+
+void ukv_txn_begin(
+    // Inputs:
+    ukv_t const c_db,
+    ukv_size_t const c_generation,
+    ukv_options_t const c_options,
+    // Outputs:
+    ukv_txn_t* c_txn,
+    ukv_error_t* c_error) {
+
+    if (!c_db && (*c_error = "DataBase is NULL!"))
+        return;
+
+    sharded_db_t& db = *reinterpret_cast<sharded_db_t*>(c_db);
+    std::unique_ptr<sharded_txn_t> new_txn;
+    if (!*c_txn) {
+        try {
+            new_txn = std::make_unique<sharded_txn_t>();
+            new_txn->db = &db;
+            new_txn->shards.resize(db.shards.size(), nullptr);
+            new_txn->touched.resize(db.shards.size(), 0);
+        }
+        catch (...) {
+            *c_error = "Failed to initialize the transaction";
+            return;
+        }
+    }
+
+    // Every shard must detect the changes, that happen after this moment, even if it's accessed later
+    sharded_txn_t& txn = new_txn ? *new_txn : *reinterpret_cast<sharded_txn_t*>(*c_txn);
+    std::fill(txn.touched.begin(), txn.touched.end(), 0);
+    for (std::size_t shard = 0; shard != db.shards.size(); ++shard) {
+        ukv_child_txn_begin(db.shards[shard], c_generation, c_options, &txn.shards[shard], c_error);
+        if (*c_error)
+            break;
+    }
+    if (*c_error && new_txn)
+        for (std::size_t shard = 0; shard != db.shards.size(); ++shard)
+            ukv_child_txn_free(db.shards[shard], new_txn->shards[shard]);
+    if (!*c_error && new_txn)
+        *c_txn = new_txn.release();
+}
+
+void ukv_txn_commit( //
+    ukv_txn_t const c_txn,
+    ukv_options_t const c_options,
+    ukv_error_t* c_error) {
+
+    if (!c_txn && (*c_error = "Transaction is NULL!"))
+        return;
+
+    // There is no two-phase commit, so the shards are committed one by one, until the first failure
+    sharded_txn_t& txn = *reinterpret_cast<sharded_txn_t*>(c_txn);
+    for (std::size_t shard = 0; shard != txn.shards.size() && !*c_error; ++shard)
+        if (txn.touched[shard])
+            ukv_child_txn_commit(txn.shards[shard], c_options, c_error);
+}
+
+/*********************************************************/
+/*****************	  Memory Management   ****************/
+/*********************************************************/
+
+void ukv_arena_free(ukv_t const c_db, ukv_arena_t c_arena) {
+    if (!c_arena)
+        return;
+    stl_arena_t& arena = *reinterpret_cast<stl_arena_t*>(c_arena);
+    sharded_db_t* db = reinterpret_cast<sharded_db_t*>(c_db);
+    for (std::size_t shard = 0; shard != arena.backend_arenas.size(); ++shard)
+        ukv_child_arena_free(db && shard < db->shards.size() ? db->shards[shard] : nullptr,
+                             arena.backend_arenas[shard]);
+    arena.backend_arenas.clear();
+    release_arena(c_arena);
+}
+
+ukv_size_t ukv_arena_allocations(ukv_t const c_db, ukv_arena_t const c_arena) {
+    if (!c_arena)
+        return 0;
+    stl_arena_t& arena = *reinterpret_cast<stl_arena_t*>(c_arena);
+    sharded_db_t* db = reinterpret_cast<sharded_db_t*>(c_db);
+    ukv_size_t allocations = arena_allocations(c_arena);
+    for (std::size_t shard = 0; shard != arena.backend_arenas.size(); ++shard)
+        allocations += ukv_child_arena_allocations(db && shard < db->shards.size() ? db->shards[shard] : nullptr,
+                                                   arena.backend_arenas[shard]);
+    return allocations;
+}
+
+void ukv_txn_free(ukv_t const, ukv_txn_t const c_txn) {
+    if (!c_txn)
+        return;
+    sharded_txn_t& txn = *reinterpret_cast<sharded_txn_t*>(c_txn);
+    for (std::size_t shard = 0; shard != txn.shards.size(); ++shard)
+        ukv_child_txn_free(txn.db->shards[shard], txn.shards[shard]);
+    delete &txn;
+}
+
+void ukv_db_free(ukv_t c_db) {
+    if (!c_db)
+        return;
+    sharded_db_t& db = *reinterpret_cast<sharded_db_t*>(c_db);
+    delete &db;
+}
+
+void ukv_col_free(ukv_t const, ukv_col_t const) {
+    // Collection handles are owned by the children.
+}
+
+void ukv_error_free(ukv_error_t) {
+}
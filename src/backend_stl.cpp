@@ -6,7 +6,7 @@
  * This is not the fastest, not the smartest possible solution for @b ACID KVS,
  * but is a good reference design for educational purposes.
  * Deficiencies:
- * > Global Lock.
+ * > Locks are per-collection, not per key-range.
  * > No support for range queries.
  * > Keeps track of all the deleted keys throughout the history.
  */
@@ -15,17 +15,30 @@
 #include <string>
 #include <string_view>
 #include <map>
+#include <set>
 #include <unordered_map>
 #include <unordered_set>
 #include <shared_mutex>
 #include <mutex>      // `std::unique_lock`
 #include <numeric>    // `std::accumulate`
+#include <chrono>     // Commit phases latency
 #include <atomic>     // Thread-safe generation counters
 #include <filesystem> // Enumerating the directory
+#include <thread>     // Background compactions
+#include <condition_variable> // Group commits
 #include <stdio.h>    // Saving/reading from disk
 
+#include <nlohmann/json.hpp> // Collection configs
+
 #include "ukv/db.h"
 #include "helpers.hpp"
+#include "metrics.hpp"
+#include "sorted_blocks.hpp"
+#include "compression.hpp"
+#include "bloom_filter.hpp"
+#include "change_feed.hpp"
+#include "numa.hpp"
+#include "txn_log.hpp"
 
 /*********************************************************/
 /*****************   Structures & Consts  ****************/
@@ -47,19 +60,132 @@ struct stl_db_t;
 struct stl_col_t;
 struct stl_txn_t;
 
+/**
+ * @brief Generations of the oldest and the youngest active snapshot transactions.
+ * Overwritten versions of entries are kept only while some snapshot can see them.
+ */
+struct snapshots_horizon_t {
+    generation_t oldest {0};
+    generation_t youngest {0};
+    bool empty {true};
+};
+
 struct stl_value_t {
     buffer_t buffer;
     generation_t generation {0};
     bool is_deleted {false};
+    /**
+     * @brief Points into the memory-mapped snapshot of the collection,
+     * until the entry is overwritten. Only then the @p `buffer` is used.
+     */
+    value_view_t mapped;
+    /**
+     * @brief Chain of the previous versions of this entry, newest first.
+     * Is only non-empty while some snapshot transaction started before the overwrites.
+     */
+    std::unique_ptr<stl_value_t> older;
+    /// The `buffer` holds the output of `compression_t::compress`, tuned by the collection.
+    bool is_compressed {false};
+
+    /// The newest version committed before the @p `snapshot` started, or NULL.
+    stl_value_t const* visible(generation_t snapshot) const noexcept {
+        stl_value_t const* version = this;
+        while (version && version->generation >= snapshot)
+            version = version->older.get();
+        return version;
+    }
+
+    /// Checks if `preserve` will move the current state into a new node of the chain.
+    bool needs_preserving(snapshots_horizon_t const& horizon) const noexcept {
+        return !horizon.empty && generation < horizon.youngest;
+    }
+
+    /**
+     * @brief Must be called right before the entry is overwritten or deleted.
+     * Moves the current state into the chain of older versions, if any active
+     * snapshot can see it, and reclaims the versions no snapshot can reach.
+     */
+    void preserve(snapshots_horizon_t const& horizon) {
+        std::unique_ptr<stl_value_t> spare;
+        if (needs_preserving(horizon))
+            spare = std::make_unique<stl_value_t>();
+        preserve(horizon, spare);
+    }
+
+    /// Same as above, but takes the node from @p spare, allocated in advance, @see `needs_preserving`.
+    void preserve(snapshots_horizon_t const& horizon, std::unique_ptr<stl_value_t>& spare) noexcept {
+        if (horizon.empty) {
+            older.reset();
+            return;
+        }
+
+        if (generation < horizon.youngest) {
+            stl_value_t& version = *spare;
+            version.buffer = std::move(buffer);
+            version.generation = generation;
+            version.is_deleted = is_deleted;
+            version.mapped = mapped;
+            version.older = std::move(older);
+            version.is_compressed = is_compressed;
+            older = std::move(spare);
+        }
+
+        // Everything behind the version seen by the oldest snapshot is unreachable
+        stl_value_t* version = older.get();
+        while (version && version->generation >= horizon.oldest)
+            version = version->older.get();
+        if (version)
+            version->older.reset();
+    }
+
+    inline bool is_mapped() const noexcept { return mapped.begin() != nullptr; }
+    /// The length of the original value, even if it is stored compressed.
+    inline std::size_t size() const noexcept {
+        return is_mapped() ? mapped.size() : is_compressed ? compression_t::length(view()) : buffer.size();
+    }
+    /// The stored bytes, which may be compressed, @see `export_to`.
+    inline value_view_t view() const noexcept {
+        return is_mapped() ? mapped : value_view_t {buffer.data(), buffer.data() + buffer.size()};
+    }
+    /// Copies or decompresses the original value into @p output, which must fit `size()` bytes.
+    inline bool export_to(byte_t* output, compression_t const& compression) const noexcept {
+        value_view_t stored = view();
+        if (is_compressed)
+            return compression.decompress(stored, output);
+        std::memcpy(output, stored.begin(), stored.size());
+        return true;
+    }
+
+    inline void assign(value_view_t value) {
+        buffer.assign(value.begin(), value.end());
+        mapped = {};
+        is_compressed = false;
+    }
+    inline void swap(buffer_t& other, bool other_is_compressed = false) noexcept {
+        std::swap(buffer, other);
+        mapped = {};
+        is_compressed = other_is_compressed;
+    }
+    inline void clear() noexcept {
+        buffer.clear();
+        mapped = {};
+        is_compressed = false;
+    }
 };
 
 struct stl_col_t {
     std::string name;
+    /**
+     * @brief Guards the `pairs` of this specific collection.
+     * Must only be acquired while holding `stl_db_t::mutex`, at least in shared mode.
+     */
+    mutable std::shared_mutex mutex;
     /**
      * @brief Primary data-store.
-     * Associative container is used to allow scans.
+     * Ordered container is used to allow scans, keeping keys in
+     * contiguous blocks to avoid pointer-chasing of node-based trees.
      */
-    std::map<ukv_key_t, stl_value_t> pairs;
+    sorted_blocks_gt<ukv_key_t, stl_value_t> pairs;
 
     /**
      * @brief Keeps the number of unique elements submitted to the store.
@@ -68,23 +194,217 @@ struct stl_col_t {
      */
     std::atomic<std::size_t> unique_elements;
 
-    void reserve_more(std::size_t) {
-        //  pairs.reserve(pairs.size() + n);
+    /**
+     * @brief Running totals over the newest versions of entries in `pairs`,
+     * so that `ukv_size` doesn't scan them. Commits update them from many threads.
+     */
+    std::atomic<std::size_t> live_count {0};
+    std::atomic<std::size_t> live_bytes {0};
+    std::atomic<std::size_t> deleted_count {0};
+
+    /// Serializes `count_range` calls, that may lazily rebuild the index of `pairs`.
+    mutable std::mutex ranks_mutex;
+
+    /**
+     * @brief The last snapshot read from disk.
+     * Entries, that weren't overwritten since, reference its pages.
+     */
+    mapped_file_t snapshot;
+
+    /// Set at `ukv_col_open` and never changed, as the existing values depend on it.
+    compression_t compression;
+
+    /**
+     * @brief Optional filter of the keys in `pairs`, including the deleted ones.
+     * Answers most of the lookups of missing keys without searching the `pairs`.
+     */
+    blocked_bloom_t filter;
+
+    /// Optional history of recent updates, @see `ukv_changes_since`.
+    change_feed_t changes;
+
+    /**
+     * @brief Index of the NUMA node, where the new entries are preferably allocated.
+     * Servers route the requests to the threads of this node, @see "numa.hpp".
+     */
+    std::atomic<std::size_t> numa_node {numa_any_k};
+
+    void reserve_more(std::size_t n) { pairs.reserve_more(n); }
+
+    /// Must be called before the newest version of an entry is overwritten or erased.
+    void forget(stl_value_t const& value) noexcept {
+        if (value.is_deleted)
+            --deleted_count;
+        else
+            --live_count, live_bytes -= value.size();
+    }
+
+    /// Must be called after an entry is inserted, or its newest version is overwritten.
+    void count(stl_value_t const& value) noexcept {
+        if (value.is_deleted)
+            ++deleted_count;
+        else
+            ++live_count, live_bytes += value.size();
+    }
+
+    /// Recomputes the totals from scratch, after bulk changes of the `pairs`.
+    void recount() noexcept {
+        live_count = live_bytes = deleted_count = 0;
+        for (auto const& [key, value] : pairs)
+            count(value);
+        unique_elements = pairs.size();
+    }
+
+    void clear() noexcept {
+        pairs.clear();
+        live_count = live_bytes = deleted_count = 0;
+        unique_elements = 0;
+    }
+
+    /// Same as `pairs.erase_range`, but keeps the totals.
+    void erase_range(ukv_key_t min_key, ukv_key_t max_key) {
+        auto max_iterator = pairs.lower_bound(max_key);
+        for (auto key_iterator = pairs.lower_bound(min_key); key_iterator != max_iterator; ++key_iterator)
+            forget(key_iterator->second);
+        unique_elements -= pairs.erase_range(min_key, max_key);
+    }
+
+    /// Number of entries in `[min_key, max_key)`, including the deleted ones, in logarithmic time.
+    std::size_t count_range(ukv_key_t min_key, ukv_key_t max_key) const {
+        if (!(min_key < max_key))
+            return 0;
+        std::lock_guard _ {ranks_mutex};
+        return pairs.rank(max_key) - pairs.rank(min_key);
+    }
+
+    /// Same as `pairs.find`, but skips the search, if the `filter` proves the @p key is missing.
+    auto find(ukv_key_t key) const noexcept { return filter.may_contain(key) ? pairs.find(key) : pairs.end(); }
+
+    /// Must be called after every new key is inserted into `pairs`.
+    void remember(ukv_key_t key) noexcept {
+        filter.insert(key);
+        if (!filter.overflown())
+            return;
+        try {
+            rebuild_filter(filter.bits_per_key());
+        }
+        catch (...) {
+            // The old filter still holds all the keys, it is just less selective
+        }
+    }
+
+    /// Resizes the filter with some slack for upcoming insertions, and refills it from `pairs`.
+    void rebuild_filter(std::size_t bits_per_key) {
+        filter.reset(bits_per_key, pairs.size() * 2);
+        if (filter.enabled())
+            for (auto const& [key, value] : pairs)
+                filter.insert(key);
     }
 };
 
 using stl_collection_ptr_t = std::unique_ptr<stl_col_t>;
 
+/**
+ * @brief One of the updates of a transaction being committed,
+ * with the entry it overwrites, found during validation.
+ */
+struct stl_txn_update_t {
+    col_key_t location;
+    /// Points into the `stl_txn_t::log`, evaluates to false for removals.
+    value_view_t value;
+    /// The copy of the `value` to be imported, or its compressed form.
+    buffer_t buffer;
+    stl_value_t* existing {nullptr};
+    /// The node for the overwritten version of `existing`, if a snapshot can still see it.
+    std::unique_ptr<stl_value_t> older_version;
+    /// The `buffer` holds the compressed form of the `value`.
+    bool is_compressed {false};
+    /// The `existing` entry is a placeholder, inserted by this commit, with nothing to preserve.
+    bool is_new {false};
+};
+
 struct stl_txn_t {
-    std::map<col_key_t, buffer_t> upserted;
-    std::unordered_map<col_key_t, generation_t, sub_key_hash_t> requested;
-    std::unordered_set<col_key_t, sub_key_hash_t> removed;
+    /// Upserts and removals, in the order of writes, @see "txn_log.hpp".
+    txn_log_t log;
+    /// Tracked reads with the generations they have observed.
+    txn_reads_t requested;
+    /// Updates during the commit, kept to reuse memory.
+    std::vector<stl_txn_update_t> updates;
 
     stl_db_t* db_ptr {nullptr};
     generation_t generation {0};
+    /// Started with `ukv_option_txn_snapshot_k` and registered in `stl_db_t::snapshots`.
+    bool is_snapshot {false};
+    /// Distinguishes committed updates from aborted ones, when the transaction is reused or freed.
+    bool is_committed {false};
 };
 
+/**
+ * @brief The version of the entry the transaction can see.
+ * Snapshots see the state at the moment they started, or NULL, if the entry
+ * didn't exist yet. Other transactions always see the HEAD state.
+ *
+ * Snapshot reads aren't lock-free: just like other reads, they hold `stl_db_t::mutex`
+ * and the touched collections in shared mode for the duration of every call, as
+ * the `sorted_blocks_gt` index isn't a concurrent structure. They only differ in
+ * never failing because of concurrent overwrites, so they don't need retries.
+ */
+stl_value_t const* txn_visible(stl_txn_t const& txn, stl_value_t const& value) noexcept {
+    return txn.is_snapshot ? value.visible(txn.generation) : &value;
+}
+
+/**
+ * @brief Append-only Write-Ahead Log, split into numbered segments.
+ * Every write is appended to the youngest segment, but only the writes
+ * with `ukv_option_write_flush_k` wait for it to reach the disk.
+ * Concurrent flushing writers share a single `fdatasync`.
+ * Once a segment grows big enough, a new one is started and a background
+ * thread snapshots the whole DB, removing the older segments.
+ */
+struct stl_wal_t {
+    std::mutex mutex;
+    std::condition_variable synced_condition;
+    int descriptor {-1};
+    std::size_t segment {0};
+    std::size_t segment_bytes {0};
+    /// Total number of bytes ever appended and the prefix known to be durable.
+    std::size_t appended_bytes {0};
+    std::size_t synced_bytes {0};
+    bool is_syncing {false};
+    bool is_compacting {false};
+    std::thread compaction;
+
+    ~stl_wal_t() {
+        if (compaction.joinable())
+            compaction.join();
+        if (descriptor >= 0)
+            ::close(descriptor);
+    }
+};
+
+/**
+ * @brief Cumulative time spent in every phase of `ukv_txn_commit`,
+ * reported by the "commits" request of `ukv_db_control`.
+ */
+struct stl_commit_stats_t {
+    std::atomic<std::uint64_t> commits {0};
+    std::atomic<std::uint64_t> failures {0};
+    std::atomic<std::uint64_t> lock_ns {0};
+    std::atomic<std::uint64_t> validate_ns {0};
+    std::atomic<std::uint64_t> log_ns {0};
+    std::atomic<std::uint64_t> apply_ns {0};
+    std::atomic<std::uint64_t> sync_ns {0};
+};
+
+/// Minimum number of entries per thread, for commits to be split across threads.
+constexpr std::size_t parallel_chunk_k = 16 * 1024;
+
 struct stl_db_t {
+    /**
+     * @brief Guards the set of collections, not their contents.
+     * Is only locked exclusively, when collections are added or removed.
+     * Every other operation keeps it shared and locks individual collections.
+     */
     std::shared_mutex mutex;
     stl_col_t main;
 
@@ -96,20 +416,134 @@ struct stl_db_t {
     std::unordered_map<std::string_view, stl_collection_ptr_t> named;
     /**
      * @brief The generation/transactions ID of the most recent update.
-     * This can be updated even outside of the main @p `mutex` on HEAD state.
+     * This can be updated even outside of the @p `mutex` on HEAD state.
      */
     std::atomic<generation_t> youngest_generation {0};
+    /**
+     * @brief Generations of all the active snapshot transactions.
+     * Writers keep the mutex shared from assigning generations to their updates
+     * until those are applied, so a new snapshot never sees half of a batch.
+     */
+    std::shared_mutex snapshots_mutex;
+    std::multiset<generation_t> snapshots;
     /**
      * @brief Path on disk, from which the data will be read.
-     * When closed, we will try saving the DB on disk.
+     * Snapshots and the Write-Ahead Log segments are kept there.
      */
     std::string persisted_path;
+    stl_commit_stats_t commit_stats;
+    metrics_t metrics;
+    /**
+     * @brief Must be the last member, so that the background compaction
+     * is joined before any collection is destroyed.
+     */
+    stl_wal_t wal;
 };
 
 stl_col_t& stl_col(stl_db_t& db, ukv_col_t col) {
     return col == ukv_col_main_k ? db.main : *reinterpret_cast<stl_col_t*>(col);
 }
 
+/// Prefers the memory of the node, that owns the collection, for the rest of the batch.
+numa_scope_t numa_scope(stl_db_t& db, ukv_col_t col) noexcept {
+    return numa_scope_t {stl_col(db, col).numa_node.load(std::memory_order_relaxed)};
+}
+
+/// Must be called with `stl_db_t::snapshots_mutex` locked.
+snapshots_horizon_t snapshots_horizon(stl_db_t const& db) noexcept {
+    if (db.snapshots.empty())
+        return {};
+    return {*db.snapshots.begin(), *db.snapshots.rbegin(), false};
+}
+
+void release_snapshot(stl_txn_t& txn) noexcept {
+    if (!txn.is_snapshot)
+        return;
+    stl_db_t& db = *txn.db_ptr;
+    std::unique_lock _ {db.snapshots_mutex};
+    db.snapshots.erase(db.snapshots.find(txn.generation));
+    txn.is_snapshot = false;
+}
+
+/**
+ * @brief Locks all the distinct collections touched by a batch.
+ * Mutexes are always acquired in the order of collection handles,
+ * so batches touching overlapping sets of collections can't deadlock.
+ * The handles are gathered into an external buffer, often the arena,
+ * to avoid allocations on hot paths.
+ */
+template <bool exclusive_ak>
+class cols_lock_gt {
+    stl_db_t& db_;
+    std::vector<ukv_col_t>& cols_;
+    std::size_t locked_count_ = 0;
+
+  public:
+    cols_lock_gt(stl_db_t& db, std::vector<ukv_col_t>& cols) noexcept : db_(db), cols_(cols) { cols_.clear(); }
+    cols_lock_gt(cols_lock_gt const&) = delete;
+    ~cols_lock_gt() { unlock(); }
+
+    void add(ukv_col_t col) {
+        if (cols_.empty() || cols_.back() != col)
+            cols_.push_back(col);
+    }
+
+    void lock() {
+        sort_and_deduplicate(cols_);
+        for (; locked_count_ != cols_.size(); ++locked_count_) {
+            std::shared_mutex& mutex = stl_col(db_, cols_[locked_count_]).mutex;
+            if constexpr (exclusive_ak)
+                mutex.lock();
+            else
+                mutex.lock_shared();
+        }
+    }
+
+    void unlock() noexcept {
+        for (; locked_count_; --locked_count_) {
+            std::shared_mutex& mutex = stl_col(db_, cols_[locked_count_ - 1]).mutex;
+            if constexpr (exclusive_ak)
+                mutex.unlock();
+            else
+                mutex.unlock_shared();
+        }
+    }
+
+    std::vector<ukv_col_t> const& cols() const noexcept { return cols_; }
+};
+
+using cols_shared_lock_t = cols_lock_gt<false>;
+using cols_unique_lock_t = cols_lock_gt<true>;
+
+template <bool exclusive_ak, typename tasks_at>
+void lock_cols(tasks_at const& tasks, cols_lock_gt<exclusive_ak>& lock, ukv_error_t* c_error) noexcept {
+    try {
+        if (tasks.same_col()) {
+            if (tasks.count)
+                lock.add(tasks[0].col);
+        }
+        else
+            for (ukv_size_t i = 0; i != tasks.count; ++i)
+                lock.add(tasks[i].col);
+        lock.lock();
+    }
+    catch (...) {
+        *c_error = "Failed to lock collections!";
+    }
+}
+
+/**
+ * @brief Snapshots are laid out to be memory-mapped without any parsing:
+ * > the number of entries `n` as `ukv_size_t`,
+ * > `n` sorted keys as `ukv_key_t`,
+ * > `n + 1` offsets of values into the blob as `snapshot_off_t`,
+ * > the blob of concatenated values.
+ */
+using snapshot_off_t = std::uint64_t;
+
+/// Size of the buffer used by LibC to accumulate small writes into big sequential ones.
+constexpr std::size_t snapshot_write_buffer_k = 4ul * 1024ul * 1024ul;
+
 void save_to_disk(stl_col_t const& col, std::string const& path, ukv_error_t* c_error) {
     // Using the classical C++ IO mechanisms is a bad tone in the modern world.
     // They are ugly and, more importantly, painly slow.
@@ -119,97 +553,138 @@ void save_to_disk(stl_col_t const& col, std::string const& path, ukv_error_t* c_
     // POSIX API would have been even better, but LibC will provide
     // higher portability for this reference implementation.
     // https://www.ibm.com/docs/en/i/7.1?topic=functions-fopen-open-files
+    //
+    // Some entries may still reference the previous snapshot, so we can't overwrite it.
+    // Instead, we write a new file and atomically replace the old one.
+    auto temporary_path = path + ".tmp";
     file_handle_t handle;
-    if ((*c_error = handle.open(path.c_str(), "wb+").release_error()))
+    if ((*c_error = handle.open(temporary_path.c_str(), "wb+").release_error()))
         return;
+    std::setvbuf(handle, nullptr, _IOFBF, snapshot_write_buffer_k);
 
-    // Save the collection size
-    {
-        auto n = static_cast<ukv_size_t>(col.unique_elements.load());
-        auto saved_len = std::fwrite(&n, sizeof(ukv_size_t), 1, handle);
-        if (saved_len != sizeof(ukv_size_t)) {
-            *c_error = "Couldn't write anything to file.";
-            return;
+    std::shared_lock _ {col.mutex};
+
+    // Gather the keys and the offsets of the entries we are going to export
+    std::vector<ukv_key_t> keys;
+    std::vector<snapshot_off_t> offsets;
+    try {
+        keys.reserve(col.pairs.size());
+        offsets.reserve(col.pairs.size() + 1);
+        offsets.push_back(0);
+        for (auto const& [key, seq_val] : col.pairs) {
+            if (seq_val.is_deleted)
+                continue;
+            keys.push_back(key);
+            offsets.push_back(offsets.back() + seq_val.size());
         }
     }
+    catch (...) {
+        *c_error = "Failed to allocate memory!";
+        return;
+    }
 
-    // Save the entries
+    // Save the collection size, keys and offsets
+    auto n = static_cast<ukv_size_t>(keys.size());
+    if (std::fwrite(&n, sizeof(ukv_size_t), 1, handle) != 1) {
+        *c_error = "Couldn't write anything to file.";
+        return;
+    }
+    if (std::fwrite(keys.data(), sizeof(ukv_key_t), n, handle) != n) {
+        *c_error = "Write partially failed on keys.";
+        return;
+    }
+    if (std::fwrite(offsets.data(), sizeof(snapshot_off_t), n + 1, handle) != n + 1) {
+        *c_error = "Write partially failed on offsets.";
+        return;
+    }
+
+    // Save the values, decompressing them, as the snapshots don't depend on the collection config
+    buffer_t decompressed;
     for (auto const& [key, seq_val] : col.pairs) {
         if (seq_val.is_deleted)
             continue;
 
-        auto saved_len = std::fwrite(&key, sizeof(ukv_key_t), 1, handle);
-        if (saved_len != sizeof(ukv_key_t)) {
-            *c_error = "Write partially failed on key.";
-            return;
-        }
-
-        auto const& buf = seq_val.buffer;
-        auto buf_len = static_cast<ukv_val_len_t>(buf.size());
-        saved_len = std::fwrite(&buf_len, sizeof(ukv_val_len_t), 1, handle);
-        if (saved_len != sizeof(ukv_val_len_t)) {
-            *c_error = "Write partially failed on value len.";
-            return;
+        auto value = seq_val.view();
+        if (seq_val.is_compressed) {
+            try {
+                decompressed.resize(seq_val.size());
+            }
+            catch (...) {
+                *c_error = "Failed to allocate memory!";
+                return;
+            }
+            if (!seq_val.export_to(decompressed.data(), col.compression)) {
+                *c_error = "Failed to decompress the value!";
+                return;
+            }
+            value = {decompressed.data(), decompressed.data() + decompressed.size()};
         }
-
-        saved_len = std::fwrite(buf.data(), sizeof(byte_t), buf.size(), handle);
-        if (saved_len != buf.size()) {
+        if (std::fwrite(value.begin(), sizeof(byte_t), value.size(), handle) != value.size()) {
             *c_error = "Write partially failed on value.";
             return;
         }
     }
 
-    *c_error = handle.close().release_error();
+    if ((*c_error = handle.close().release_error()))
+        return;
+    if (std::rename(temporary_path.c_str(), path.c_str()) != 0)
+        *c_error = "Couldn't replace the previous snapshot.";
 }
 
 void read_from_disk(stl_col_t& col, std::string const& path, ukv_error_t* c_error) {
-    // Similar to serialization, we don't use STL here
-    file_handle_t handle;
-    if ((*c_error = handle.open(path.c_str(), "rb+").release_error()))
+    // The values aren't copied, they are paged-in lazily, when accessed
+    mapped_file_t snapshot;
+    if ((*c_error = snapshot.open(path.c_str()).release_error()))
         return;
 
     // Get the col size, to preallocate entries
+    byte_t const* const begin = snapshot.begin();
+    std::size_t const length = snapshot.size();
     auto n = ukv_size_t(0);
-    {
-        auto read_len = std::fread(&n, sizeof(ukv_size_t), 1, handle);
-        if (read_len != sizeof(ukv_size_t)) {
-            *c_error = "Couldn't read anything from file.";
-            return;
-        }
+    if (length < sizeof(ukv_size_t)) {
+        *c_error = "Couldn't read anything from file.";
+        return;
     }
+    std::memcpy(&n, begin, sizeof(ukv_size_t));
 
-    // Load the entries
-    col.pairs.clear();
-    col.reserve_more(n);
-    col.unique_elements = n;
-
-    for (ukv_size_t i = 0; i != n; ++i) {
+    std::size_t const header_length =
+        sizeof(ukv_size_t) + sizeof(ukv_key_t) * n + sizeof(snapshot_off_t) * (n + 1);
+    if (length < header_length) {
+        *c_error = "Read partially failed on keys.";
+        return;
+    }
 
-        auto key = ukv_key_t {};
-        auto read_len = std::fread(&key, sizeof(ukv_key_t), 1, handle);
-        if (read_len != sizeof(ukv_key_t)) {
-            *c_error = "Read partially failed on key.";
-            return;
-        }
+    auto keys = reinterpret_cast<ukv_key_t const*>(begin + sizeof(ukv_size_t));
+    auto offsets = reinterpret_cast<snapshot_off_t const*>(keys + n);
+    auto values = reinterpret_cast<byte_t const*>(offsets + n + 1);
+    if (length < header_length + offsets[n]) {
+        *c_error = "Read partially failed on value.";
+        return;
+    }
 
-        auto buf_len = ukv_val_len_t(0);
-        read_len = std::fread(&buf_len, sizeof(ukv_val_len_t), 1, handle);
-        if (read_len != sizeof(ukv_val_len_t)) {
-            *c_error = "Read partially failed on value len.";
+    // Keys are saved in order, so anything else is a corrupted file
+    for (ukv_size_t i = 0; i != n; ++i) {
+        if ((i && keys[i - 1] >= keys[i]) || offsets[i] > offsets[i + 1]) {
+            *c_error = "Snapshot is corrupted: keys or offsets are out of order.";
             return;
         }
+    }
 
-        auto buf = buffer_t(buf_len);
-        read_len = std::fread(buf.data(), sizeof(byte_t), buf.size(), handle);
-        if (read_len != buf.size()) {
-            *c_error = "Read partially failed on value.";
-            return;
+    // Load the entries, appending them to the tail, without searches
+    col.clear();
+    col.snapshot = std::move(snapshot);
+    try {
+        col.reserve_more(n);
+        for (ukv_size_t i = 0; i != n; ++i) {
+            value_view_t mapped {values + offsets[i], values + offsets[i + 1]};
+            col.pairs.emplace_back(keys[i], stl_value_t {buffer_t {}, generation_t {0}, false, mapped});
         }
-
-        col.pairs.emplace(key, stl_value_t {std::move(buf), generation_t {0}, false});
+        col.rebuild_filter(col.filter.bits_per_key());
     }
-
-    *c_error = handle.close().release_error();
+    catch (...) {
+        *c_error = "Failed to allocate memory!";
+    }
+    col.recount();
 }
 
 void save_to_disk(stl_db_t const& db, ukv_error_t* c_error) {
@@ -255,6 +730,8 @@ void read_from_disk(stl_db_t& db, ukv_error_t* c_error) {
 
         auto filename_w_ext = path.filename().native();
         auto filename = filename_w_ext.substr(0, filename_w_ext.size() - 8);
+        if (filename.empty())
+            continue;
         auto col = std::make_unique<stl_col_t>();
         col->name = filename;
         read_from_disk(*col, path_str, c_error);
@@ -262,44 +739,515 @@ void read_from_disk(stl_db_t& db, ukv_error_t* c_error) {
     }
 }
 
+/*********************************************************/
+/*****************	  Write-Ahead Log	  ****************/
+/*********************************************************/
+
+/**
+ * @brief Every WAL record is prefixed with its length, followed by entries:
+ * > operation as `wal_op_t`,
+ * > collection name length as `ukv_val_len_t` and the name itself,
+ * > for upserts and removals: the `ukv_key_t`,
+ * > for upserts: value length as `ukv_val_len_t` and the value itself,
+ * > for range removals: the minimum and the maximum `ukv_key_t`.
+ * Records with a truncated tail are ignored on replay.
+ */
+using wal_record_len_t = std::uint64_t;
+
+enum class wal_op_t : std::uint8_t {
+    upsert_k = 0,
+    remove_k = 1,
+    drop_col_k = 2,
+    remove_range_k = 3,
+};
+
+/// Segment size, after which the log is compacted into a snapshot.
+constexpr std::size_t wal_segment_capacity_k = 64ul * 1024ul * 1024ul;
+constexpr char const* wal_extension_k = ".stl.wal";
+
+template <typename scalar_at>
+void wal_push(buffer_t& record, scalar_at const& scalar) {
+    auto bytes = reinterpret_cast<byte_t const*>(&scalar);
+    record.insert(record.end(), bytes, bytes + sizeof(scalar_at));
+}
+
+void wal_push(buffer_t& record, wal_op_t op, std::string_view col_name) {
+    if (record.empty())
+        wal_push(record, wal_record_len_t {0});
+    wal_push(record, op);
+    wal_push(record, static_cast<ukv_val_len_t>(col_name.size()));
+    auto name = reinterpret_cast<byte_t const*>(col_name.data());
+    record.insert(record.end(), name, name + col_name.size());
+}
+
+void wal_push_upsert(buffer_t& record, stl_col_t const& col, ukv_key_t key, value_view_t value) {
+    wal_push(record, wal_op_t::upsert_k, col.name);
+    wal_push(record, key);
+    wal_push(record, static_cast<ukv_val_len_t>(value.size()));
+    record.insert(record.end(), value.begin(), value.end());
+}
+
+void wal_push_remove(buffer_t& record, stl_col_t const& col, ukv_key_t key) {
+    wal_push(record, wal_op_t::remove_k, col.name);
+    wal_push(record, key);
+}
+
+void wal_push_remove_range(buffer_t& record, stl_col_t const& col, ukv_key_t min_key, ukv_key_t max_key) {
+    wal_push(record, wal_op_t::remove_range_k, col.name);
+    wal_push(record, min_key);
+    wal_push(record, max_key);
+}
+
+fs::path wal_segment_path(stl_db_t const& db, std::size_t segment) {
+    return fs::path(db.persisted_path) / (std::to_string(segment) + wal_extension_k);
+}
+
+/// Lists the numbers of all the WAL segments in the persisted directory in ascending order.
+std::vector<std::size_t> wal_segments(stl_db_t const& db) {
+    std::vector<std::size_t> segments;
+    std::string_view extension {wal_extension_k};
+    for (auto const& dir_entry : fs::directory_iterator {fs::path(db.persisted_path)}) {
+        if (!dir_entry.is_regular_file())
+            continue;
+        auto filename = dir_entry.path().filename().native();
+        if (filename.size() <= extension.size() || filename.substr(filename.size() - extension.size()) != extension)
+            continue;
+        auto number = filename.substr(0, filename.size() - extension.size());
+        if (number.find_first_not_of("0123456789") != std::string::npos)
+            continue;
+        segments.push_back(std::stoull(number));
+    }
+    std::sort(segments.begin(), segments.end());
+    return segments;
+}
+
+void wal_open_segment(stl_db_t& db, std::size_t segment, ukv_error_t* c_error) {
+    stl_wal_t& wal = db.wal;
+    auto path = wal_segment_path(db, segment);
+    int descriptor = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (descriptor < 0) {
+        *c_error = "Failed to open the Write-Ahead Log!";
+        return;
+    }
+    if (wal.descriptor >= 0)
+        ::close(wal.descriptor);
+    wal.descriptor = descriptor;
+    wal.segment = segment;
+    wal.segment_bytes = 0;
+}
+
+stl_col_t* wal_replay_col(stl_db_t& db, std::string_view col_name) {
+    if (col_name.empty())
+        return &db.main;
+    auto col_it = db.named.find(col_name);
+    if (col_it != db.named.end())
+        return col_it->second.get();
+    auto new_col = std::make_unique<stl_col_t>();
+    new_col->name = col_name;
+    stl_col_t* col_ptr = new_col.get();
+    db.named.emplace(new_col->name, std::move(new_col));
+    return col_ptr;
+}
+
+/**
+ * @brief Re-applies the records of a single segment on top of the loaded snapshots.
+ * Is only called on open, so no locks are needed.
+ */
+void wal_replay(stl_db_t& db, std::size_t segment, ukv_error_t* c_error) {
+    mapped_file_t file;
+    if ((*c_error = file.open(wal_segment_path(db, segment).c_str()).release_error()))
+        return;
+
+    byte_t const* progress = file.begin();
+    byte_t const* const end = file.begin() + file.size();
+    auto pull = [&](auto& scalar) {
+        if (std::size_t(end - progress) < sizeof(scalar))
+            return false;
+        std::memcpy(&scalar, progress, sizeof(scalar));
+        progress += sizeof(scalar);
+        return true;
+    };
+
+    try {
+        wal_record_len_t record_len = 0;
+        while (pull(record_len) && std::size_t(end - progress) >= record_len) {
+            byte_t const* const record_end = progress + record_len;
+            generation_t const generation = ++db.youngest_generation;
+            while (progress < record_end) {
+                wal_op_t op;
+                ukv_val_len_t name_len = 0;
+                if (!pull(op) || !pull(name_len) || std::size_t(record_end - progress) < name_len)
+                    break;
+                auto col_name = std::string_view(reinterpret_cast<char const*>(progress), name_len);
+                progress += name_len;
+                stl_col_t& col = *wal_replay_col(db, col_name);
+
+                if (op == wal_op_t::drop_col_k) {
+                    if (col_name.empty())
+                        db.main.clear();
+                    else
+                        db.named.erase(col_name);
+                    continue;
+                }
+
+                ukv_key_t key;
+                if (!pull(key))
+                    break;
+                if (op == wal_op_t::remove_range_k) {
+                    ukv_key_t max_key;
+                    if (!pull(max_key))
+                        break;
+                    col.erase_range(key, max_key);
+                    continue;
+                }
+
+                auto key_iterator = col.pairs.find(key);
+                if (op == wal_op_t::remove_k) {
+                    if (key_iterator != col.pairs.end()) {
+                        col.forget(key_iterator->second);
+                        key_iterator->second.is_deleted = true;
+                        key_iterator->second.generation = generation;
+                        key_iterator->second.clear();
+                        col.count(key_iterator->second);
+                    }
+                    continue;
+                }
+
+                ukv_val_len_t value_len = 0;
+                if (!pull(value_len) || std::size_t(record_end - progress) < value_len)
+                    break;
+                value_view_t value {progress, progress + value_len};
+                progress += value_len;
+                if (key_iterator != col.pairs.end()) {
+                    col.forget(key_iterator->second);
+                    key_iterator->second.assign(value);
+                    key_iterator->second.generation = generation;
+                    key_iterator->second.is_deleted = false;
+                    col.count(key_iterator->second);
+                }
+                else {
+                    stl_value_t value_w_generation {buffer_t {value.begin(), value.end()}, generation};
+                    col.count(col.pairs.emplace(key, std::move(value_w_generation)).first->second);
+                    col.remember(key);
+                    ++col.unique_elements;
+                }
+            }
+            progress = record_end;
+        }
+    }
+    catch (...) {
+        *c_error = "Failed to replay the Write-Ahead Log!";
+    }
+}
+
+void wal_replay_and_open(stl_db_t& db, ukv_error_t* c_error) {
+    std::vector<std::size_t> segments = wal_segments(db);
+    for (std::size_t segment : segments) {
+        wal_replay(db, segment, c_error);
+        if (*c_error)
+            return;
+    }
+    wal_open_segment(db, segments.empty() ? 0 : segments.back() + 1, c_error);
+}
+
+/**
+ * @brief Snapshots the entire DB and removes the WAL segments, preceding @p `first_kept_segment`.
+ * Runs in a background thread. If it fails, the segments are kept and will be replayed on open.
+ */
+void wal_compact(stl_db_t& db, std::size_t first_kept_segment) {
+    ukv_error_t error = nullptr;
+    {
+        std::shared_lock _ {db.mutex};
+        save_to_disk(db, &error);
+    }
+
+    if (!error)
+        for (std::size_t segment : wal_segments(db))
+            if (segment < first_kept_segment)
+                fs::remove(wal_segment_path(db, segment));
+
+    std::unique_lock _ {db.wal.mutex};
+    db.wal.is_compacting = false;
+}
+
+/**
+ * @brief Starts a new segment and a background compaction of the older ones.
+ * Must be called while holding `stl_wal_t::mutex`, with no compaction or sync in progress.
+ * @return False, if the new segment couldn't be opened.
+ */
+bool wal_rotate(stl_db_t& db) noexcept {
+    stl_wal_t& wal = db.wal;
+    ukv_error_t rotation_error = nullptr;
+    ::fdatasync(wal.descriptor);
+    wal.synced_bytes = wal.appended_bytes;
+    wal_open_segment(db, wal.segment + 1, &rotation_error);
+    if (rotation_error)
+        return false;
+
+    try {
+        if (wal.compaction.joinable())
+            wal.compaction.join();
+        wal.is_compacting = true;
+        wal.compaction = std::thread(&wal_compact, std::ref(db), wal.segment);
+    }
+    catch (...) {
+        wal.is_compacting = false;
+    }
+    return true;
+}
+
+/**
+ * @brief Appends a ready @p `record` to the log.
+ * Must be called while holding the locks of all the collections it affects,
+ * so that the order of records matches the order of updates.
+ * @return The number of bytes, that must be synced for this record to become durable.
+ */
+std::size_t wal_append(stl_db_t& db, buffer_t& record, ukv_error_t* c_error) {
+    stl_wal_t& wal = db.wal;
+    if (record.empty())
+        return 0;
+
+    wal_record_len_t record_len = record.size() - sizeof(wal_record_len_t);
+    std::memcpy(record.data(), &record_len, sizeof(wal_record_len_t));
+
+    std::unique_lock _ {wal.mutex};
+    if (wal.descriptor < 0)
+        return 0;
+    byte_t const* progress = record.data();
+    std::size_t remaining = record.size();
+    while (remaining) {
+        ssize_t written = ::write(wal.descriptor, progress, remaining);
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            *c_error = "Failed to append to the Write-Ahead Log!";
+            return 0;
+        }
+        progress += written;
+        remaining -= static_cast<std::size_t>(written);
+    }
+    wal.appended_bytes += record.size();
+    wal.segment_bytes += record.size();
+    std::size_t const sequence = wal.appended_bytes;
+
+    // Start a new segment, once the current one is full.
+    // The older ones will be removed after the snapshot.
+    bool should_compact = wal.segment_bytes >= wal_segment_capacity_k && !wal.is_compacting && !wal.is_syncing;
+    if (should_compact)
+        wal_rotate(db);
+    return sequence;
+}
+
+/**
+ * @brief Waits until the log is durable up to @p `sequence`, as returned by `wal_append`.
+ * The first waiter becomes the leader and syncs the file for everyone,
+ * others just wait for it to finish, merging their commits into a group.
+ */
+void wal_sync(stl_db_t& db, std::size_t sequence, ukv_error_t* c_error) {
+    stl_wal_t& wal = db.wal;
+    std::unique_lock lock {wal.mutex};
+    if (wal.descriptor < 0)
+        return;
+
+    while (wal.synced_bytes < sequence) {
+        if (wal.is_syncing) {
+            wal.synced_condition.wait(lock);
+            continue;
+        }
+
+        wal.is_syncing = true;
+        int descriptor = wal.descriptor;
+        std::size_t target = wal.appended_bytes;
+        lock.unlock();
+        bool failed = ::fdatasync(descriptor) != 0;
+        lock.lock();
+
+        wal.is_syncing = false;
+        if (!failed)
+            wal.synced_bytes = std::max(wal.synced_bytes, target);
+        wal.synced_condition.notify_all();
+        if (failed) {
+            *c_error = "Failed to sync the Write-Ahead Log!";
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Per-task state of `write_head`, prepared before logging, so that nothing can fail after it.
+ * Kept between calls: the buffers swapped out of the overwritten entries receive the next values,
+ * so that overwrites don't allocate in steady state.
+ */
+struct stl_write_slot_t {
+    buffer_t buffer;
+    /// The node for the overwritten version of `existing`, if a snapshot can still see it.
+    std::unique_ptr<stl_value_t> older_version;
+    stl_value_t* existing {nullptr};
+    bool is_compressed {false};
+    /// The `existing` entry is a placeholder, inserted by this call.
+    bool is_new {false};
+};
+
+/// Bound the memory kept by idle threads in `write_slots`.
+constexpr std::size_t write_slots_cached_k = 1024;
+constexpr std::size_t write_slot_cached_bytes_k = 4096;
+thread_local std::vector<stl_write_slot_t> write_slots;
+
+/**
+ * @brief Head writes need some temporary memory, but the arena is optional for them.
+ * Without one, a thread-local arena is reused, instead of growing a new one on every call.
+ */
+stl_arena_t* optional_arena(ukv_arena_t* c_arena, ukv_error_t* c_error) noexcept {
+    thread_local stl_arena_t arena;
+    return c_arena ? cast_arena(c_arena, c_error) : &arena;
+}
+
 void write_head( //
     stl_db_t& db,
     write_tasks_soa_t tasks,
     ukv_options_t const c_options,
+    stl_arena_t& arena,
     ukv_error_t* c_error) {
 
-    std::unique_lock _ {db.mutex};
+    std::shared_lock db_lock {db.mutex};
 
-    for (ukv_size_t i = 0; i != tasks.count; ++i) {
+    // Copy and compress the values before locking the collections, only leaving the swaps under the lock
+    std::vector<stl_write_slot_t>& slots = write_slots;
+    try {
+        if (slots.size() < tasks.count)
+            slots.resize(tasks.count);
+        buffer_t& scratch = arena.backend_tape;
+        for (ukv_size_t i = 0; i != tasks.count; ++i) {
+            write_task_t task = tasks[i];
+            stl_write_slot_t& slot = slots[i];
+            slot.existing = nullptr;
+            slot.is_new = false;
+            slot.is_compressed = false;
+            if (task.is_deleted())
+                continue;
+            stl_col_t const& col = stl_col(db, task.col);
+            if (col.compression.enabled() && col.compression.compress(task.view(), scratch, slot.buffer))
+                slot.is_compressed = true;
+            else
+                slot.buffer.assign(task.view().begin(), task.view().end());
+        }
+    }
+    catch (...) {
+        *c_error = "Failed to allocate memory!";
+        return;
+    }
 
-        write_task_t task = tasks[i];
-        stl_col_t& col = stl_col(db, task.col);
-        auto key_iterator = col.pairs.find(task.key);
+    cols_unique_lock_t cols_lock {db, arena.backend_cols};
+    lock_cols(tasks, cols_lock, c_error);
+    if (*c_error)
+        return;
 
-        // We want to insert a new entry, but let's check if we
-        // can overwrite the existing value without causing reallocations.
-        try {
+    // Insert the new keys as placeholders and allocate the nodes for the preserved versions.
+    // If a later step fails, the placeholders stay behind as deleted entries of the zero generation.
+    std::shared_lock snapshots_lock {db.snapshots_mutex};
+    snapshots_horizon_t const horizon = snapshots_horizon(db);
+    bool inserted_any = false;
+    try {
+        for (ukv_size_t i = 0; i != tasks.count; ++i) {
+            write_task_t task = tasks[i];
+            stl_write_slot_t& slot = slots[i];
+            stl_col_t& col = stl_col(db, task.col);
+
+            // Sorted loads and monotonic keys are appended without lookups
+            bool const is_last = col.pairs.is_after_last(task.key);
+            bool const may_exist = !is_last && col.filter.may_contain(task.key);
+            auto key_iterator = may_exist ? col.pairs.find(task.key) : col.pairs.end();
             if (key_iterator != col.pairs.end()) {
-                auto value = task.view();
-                key_iterator->second.generation = ++db.youngest_generation;
-                key_iterator->second.buffer.assign(value.begin(), value.end());
-                key_iterator->second.is_deleted = task.is_deleted();
+                slot.existing = &key_iterator->second;
+                if (slot.existing->needs_preserving(horizon) && !slot.older_version)
+                    slot.older_version = std::make_unique<stl_value_t>();
+                continue;
             }
-            else if (!task.is_deleted()) {
-                stl_value_t value_w_generation {task.buffer(), ++db.youngest_generation};
-                col.pairs.emplace(task.key, std::move(value_w_generation));
-                ++col.unique_elements;
+            if (task.is_deleted())
+                continue;
+
+            stl_value_t placeholder;
+            placeholder.is_deleted = true;
+            slot.existing = is_last ? &col.pairs.emplace_back(task.key, std::move(placeholder))->second
+                                    : &col.pairs.emplace(task.key, std::move(placeholder)).first->second;
+            slot.is_new = true;
+            inserted_any = true;
+            col.count(*slot.existing);
+            col.remember(task.key);
+            ++col.unique_elements;
+        }
+    }
+    catch (...) {
+        *c_error = "Failed to put!";
+        return;
+    }
+
+    // Log the updates, before applying them
+    std::size_t wal_sequence = 0;
+    if (!db.persisted_path.empty()) {
+        buffer_t& record = arena.backend_tape;
+        record.clear();
+        try {
+            for (ukv_size_t i = 0; i != tasks.count; ++i) {
+                write_task_t task = tasks[i];
+                stl_col_t const& col = stl_col(db, task.col);
+                if (task.is_deleted())
+                    wal_push_remove(record, col, task.key);
+                else
+                    wal_push_upsert(record, col, task.key, task.view());
             }
         }
         catch (...) {
-            *c_error = "Failed to put!";
-            break;
+            *c_error = "Failed to allocate memory!";
+            return;
         }
+        wal_sequence = wal_append(db, record, c_error);
+        if (*c_error)
+            return;
     }
 
-    // TODO: Degrade the lock to "shared" state before starting expensive IO
+    // Apply the updates, which can't fail anymore.
+    // Insertions may have invalidated the references into the same collections.
+    for (ukv_size_t i = 0; i != tasks.count; ++i) {
+        write_task_t task = tasks[i];
+        stl_write_slot_t& slot = slots[i];
+        stl_col_t& col = stl_col(db, task.col);
+        if (inserted_any && slot.existing) {
+            auto key_iterator = col.pairs.find(task.key);
+            slot.existing = key_iterator != col.pairs.end() ? &key_iterator->second : nullptr;
+        }
+        if (!slot.existing)
+            continue;
+
+        stl_value_t& value = *slot.existing;
+        col.forget(value);
+        if (!slot.is_new)
+            value.preserve(horizon, slot.older_version);
+        value.generation = ++db.youngest_generation;
+        value.is_deleted = task.is_deleted();
+        if (task.is_deleted())
+            value.clear();
+        else
+            value.swap(slot.buffer, slot.is_compressed);
+        col.count(value);
+        col.changes.push(task.key,
+                         value.generation,
+                         task.is_deleted() ? ukv_val_len_missing_k : static_cast<ukv_val_len_t>(task.view().size()));
+    }
+
+    // Release the locks before waiting for the expensive IO
+    snapshots_lock.unlock();
+    cols_lock.unlock();
+    db_lock.unlock();
+
+    if (slots.size() > write_slots_cached_k)
+        slots.resize(write_slots_cached_k);
+    for (std::size_t i = 0; i != std::min<std::size_t>(tasks.count, slots.size()); ++i)
+        if (slots[i].buffer.capacity() > write_slot_cached_bytes_k)
+            buffer_t {}.swap(slots[i].buffer);
+
     if (c_options & ukv_option_write_flush_k)
-        save_to_disk(db, c_error);
+        wal_sync(db, wal_sequence, c_error);
 }
 
 void measure_head( //
@@ -314,11 +1262,15 @@ void measure_head( //
 
     // 1. Allocate a tape for all the values to be pulled
     ukv_size_t total_bytes = sizeof(ukv_val_len_t) * tasks.count;
-    byte_t* tape = prepare_memory(arena.output_tape, total_bytes, c_error);
+    byte_t* tape = prepare_memory(arena, arena.output_tape, total_bytes, c_error);
     if (*c_error)
         return;
 
     std::shared_lock _ {db.mutex};
+    cols_shared_lock_t cols_lock {db, arena.backend_cols};
+    lock_cols(tasks, cols_lock, c_error);
+    if (*c_error)
+        return;
 
     // 2. Pull the data
     auto lens = reinterpret_cast<ukv_val_len_t*>(tape);
@@ -329,9 +1281,9 @@ void measure_head( //
     for (ukv_size_t i = 0; i != tasks.count; ++i) {
         read_task_t task = tasks[i];
         stl_col_t const& col = stl_col(db, task.col);
-        auto key_iterator = col.pairs.find(task.key);
+        auto key_iterator = col.find(task.key);
         lens[i] = key_iterator != col.pairs.end() && !key_iterator->second.is_deleted
-                      ? static_cast<ukv_val_len_t>(key_iterator->second.buffer.size())
+                      ? static_cast<ukv_val_len_t>(key_iterator->second.size())
                       : ukv_val_len_missing_k;
     }
 }
@@ -347,19 +1299,23 @@ void read_head( //
     ukv_error_t* c_error) {
 
     std::shared_lock _ {db.mutex};
+    cols_shared_lock_t cols_lock {db, arena.backend_cols};
+    lock_cols(tasks, cols_lock, c_error);
+    if (*c_error)
+        return;
 
     // 1. Estimate the total size
     ukv_size_t total_bytes = sizeof(ukv_val_len_t) * tasks.count * 2;
     for (ukv_size_t i = 0; i != tasks.count; ++i) {
         read_task_t task = tasks[i];
         stl_col_t const& col = stl_col(db, task.col);
-        auto key_iterator = col.pairs.find(task.key);
+        auto key_iterator = col.find(task.key);
         if (key_iterator != col.pairs.end())
-            total_bytes += key_iterator->second.buffer.size();
+            total_bytes += key_iterator->second.size();
     }
 
     // 2. Allocate a tape for all the values to be fetched
-    byte_t* tape = prepare_memory(arena.output_tape, total_bytes, c_error);
+    byte_t* tape = prepare_memory(arena, arena.output_tape, total_bytes, c_error);
     if (*c_error)
         return;
 
@@ -371,13 +1327,16 @@ void read_head( //
     for (ukv_size_t i = 0; i != tasks.count; ++i) {
         read_task_t task = tasks[i];
         stl_col_t const& col = stl_col(db, task.col);
-        auto key_iterator = col.pairs.find(task.key);
+        auto key_iterator = col.find(task.key);
         if (key_iterator != col.pairs.end() && !key_iterator->second.is_deleted) {
-            buffer_t const& buf = key_iterator->second.buffer;
-            std::memcpy(contents, buf.data(), buf.size());
+            stl_value_t const& value = key_iterator->second;
+            std::size_t const length = value.size();
+            auto output = reinterpret_cast<byte_t*>(contents);
+            if (!value.export_to(output, col.compression) && (*c_error = "Failed to decompress the value!"))
+                return;
             offs[i] = static_cast<ukv_val_len_t>(contents - *c_found_values);
-            lens[i] = static_cast<ukv_val_len_t>(buf.size());
-            contents += buf.size();
+            lens[i] = static_cast<ukv_val_len_t>(length);
+            contents += length;
         }
         else {
             offs[i] = lens[i] = ukv_val_len_missing_k;
@@ -395,6 +1354,10 @@ void scan_head( //
     ukv_error_t* c_error) {
 
     std::shared_lock _ {db.mutex};
+    cols_shared_lock_t cols_lock {db, arena.backend_cols};
+    lock_cols(tasks, cols_lock, c_error);
+    if (*c_error)
+        return;
 
     // 1. Estimate the total size
     bool export_lengths = (options & ukv_option_read_lengths_k);
@@ -404,7 +1367,7 @@ void scan_head( //
         total_bytes += total_lengths * sizeof(ukv_val_len_t);
 
     // 2. Allocate a tape for all the values to be fetched
-    byte_t* tape = prepare_memory(arena.output_tape, total_bytes, c_error);
+    byte_t* tape = prepare_memory(arena, arena.output_tape, total_bytes, c_error);
     if (*c_error)
         return;
 
@@ -425,7 +1388,7 @@ void scan_head( //
                 if (key_iterator->second.is_deleted)
                     continue;
                 found_keys[j] = key_iterator->first;
-                found_lens[j] = static_cast<ukv_val_len_t>(key_iterator->second.buffer.size());
+                found_lens[j] = static_cast<ukv_val_len_t>(key_iterator->second.size());
                 ++j;
             }
             for (; j != task.length; ++j)
@@ -462,13 +1425,10 @@ void write_txn( //
         write_task_t task = tasks[i];
 
         try {
-            if (task.is_deleted()) {
-                txn.upserted.erase(task.location());
-                txn.removed.insert(task.location());
-            }
-            else {
-                txn.upserted.insert_or_assign(task.location(), task.buffer());
-            }
+            if (task.is_deleted())
+                txn.log.remove(task.location());
+            else
+                txn.log.upsert(task.location(), task.view());
         }
         catch (...) {
             *c_error = "Failed to put into transaction!";
@@ -477,6 +1437,18 @@ void write_txn( //
     }
 }
 
+/// Remembers the generation of the @p value, that the transaction has seen, to validate it on commit.
+bool track_read(stl_txn_t& txn, col_key_t location, stl_value_t const* value, ukv_error_t* c_error) noexcept {
+    try {
+        txn.requested.push(location, value ? value->generation : generation_t {});
+        return true;
+    }
+    catch (...) {
+        *c_error = "Failed to track the read!";
+        return false;
+    }
+}
+
 void measure_txn( //
     stl_txn_t& txn,
     read_tasks_soa_t tasks,
@@ -489,12 +1461,17 @@ void measure_txn( //
 
     // 1. Allocate a tape for all the values to be pulled
     ukv_size_t total_bytes = sizeof(ukv_val_len_t) * tasks.count;
-    byte_t* tape = prepare_memory(arena.output_tape, total_bytes, c_error);
+    byte_t* tape = prepare_memory(arena, arena.output_tape, total_bytes, c_error);
     if (*c_error)
         return;
 
     stl_db_t& db = *txn.db_ptr;
     std::shared_lock _ {db.mutex};
+    cols_shared_lock_t cols_lock {db, arena.backend_cols};
+    lock_cols(tasks, cols_lock, c_error);
+    if (*c_error)
+        return;
+
     generation_t const youngest_generation = db.youngest_generation.load();
     bool should_track_requests = (c_options & ukv_option_read_track_k);
 
@@ -508,33 +1485,30 @@ void measure_txn( //
         read_task_t task = tasks[i];
         stl_col_t const& col = stl_col(db, task.col);
 
-        // Some keys may already be overwritten inside of transaction
-        if (auto inner_iterator = txn.upserted.find(task.location()); inner_iterator != txn.upserted.end()) {
-            lens[i] = inner_iterator->second.size();
-        }
-        // Some may have been deleted inside the transaction
-        else if (auto inner_iterator = txn.removed.find(task.location()); inner_iterator != txn.removed.end()) {
-            lens[i] = ukv_val_len_missing_k;
+        // Some keys may already be overwritten or deleted inside of transaction
+        if (auto entry = txn.log.find(task.location()); entry) {
+            lens[i] = entry->length;
         }
         // Others should be pulled from the main store
-        else if (auto key_iterator = col.pairs.find(task.key); key_iterator != col.pairs.end()) {
+        else if (auto key_iterator = col.find(task.key); key_iterator != col.pairs.end()) {
 
-            if (entry_was_overwritten(key_iterator->second.generation, txn.generation, youngest_generation) &&
+            if (!txn.is_snapshot &&
+                entry_was_overwritten(key_iterator->second.generation, txn.generation, youngest_generation) &&
                 (*c_error = "Requested key was already overwritten since the start of the transaction!"))
                 return;
 
-            lens[i] = !key_iterator->second.is_deleted ? static_cast<ukv_val_len_t>(key_iterator->second.buffer.size())
-                                                       : ukv_val_len_missing_k;
+            stl_value_t const* value = txn_visible(txn, key_iterator->second);
+            lens[i] = value && !value->is_deleted ? static_cast<ukv_val_len_t>(value->size()) : ukv_val_len_missing_k;
 
-            if (should_track_requests)
-                txn.requested.emplace(task.location(), key_iterator->second.generation);
+            if (should_track_requests && !track_read(txn, task.location(), value, c_error))
+                return;
         }
         // But some will be missing
         else {
             lens[i] = ukv_val_len_missing_k;
 
-            if (should_track_requests)
-                txn.requested.emplace(task.location(), generation_t {});
+            if (should_track_requests && !track_read(txn, task.location(), nullptr, c_error))
+                return;
         }
     }
 }
@@ -551,6 +1525,11 @@ void read_txn( //
 
     stl_db_t& db = *txn.db_ptr;
     std::shared_lock _ {db.mutex};
+    cols_shared_lock_t cols_lock {db, arena.backend_cols};
+    lock_cols(tasks, cols_lock, c_error);
+    if (*c_error)
+        return;
+
     generation_t const youngest_generation = db.youngest_generation.load();
     bool should_track_requests = (c_options & ukv_option_read_track_k);
 
@@ -560,27 +1539,25 @@ void read_txn( //
         read_task_t task = tasks[i];
         stl_col_t const& col = stl_col(db, task.col);
 
-        // Some keys may already be overwritten inside of transaction
-        if (auto inner_iterator = txn.upserted.find(task.location()); inner_iterator != txn.upserted.end()) {
-            total_bytes += inner_iterator->second.size();
-        }
-        // Some may have been deleted inside the transaction
-        else if (auto inner_iterator = txn.removed.find(task.location()); inner_iterator != txn.removed.end()) {
-            continue;
+        // Some keys may already be overwritten or deleted inside of transaction
+        if (auto entry = txn.log.find(task.location()); entry) {
+            total_bytes += txn.log.value(*entry).size();
         }
         // Others should be pulled from the main store
-        else if (auto key_iterator = col.pairs.find(task.key); key_iterator != col.pairs.end()) {
-            if (entry_was_overwritten(key_iterator->second.generation, txn.generation, youngest_generation) &&
+        else if (auto key_iterator = col.find(task.key); key_iterator != col.pairs.end()) {
+            if (!txn.is_snapshot &&
+                entry_was_overwritten(key_iterator->second.generation, txn.generation, youngest_generation) &&
                 (*c_error = "Requested key was already overwritten since the start of the transaction!"))
                 return;
 
-            if (!key_iterator->second.is_deleted)
-                total_bytes += key_iterator->second.buffer.size();
+            stl_value_t const* value = txn_visible(txn, key_iterator->second);
+            if (value && !value->is_deleted)
+                total_bytes += value->size();
         }
     }
 
     // 2. Allocate a tape for all the values to be pulled
-    byte_t* tape = prepare_memory(arena.output_tape, total_bytes, c_error);
+    byte_t* tape = prepare_memory(arena, arena.output_tape, total_bytes, c_error);
     if (*c_error)
         return;
 
@@ -594,40 +1571,43 @@ void read_txn( //
         read_task_t task = tasks[i];
         stl_col_t const& col = stl_col(db, task.col);
 
-        // Some keys may already be overwritten inside of transaction
-        if (auto inner_iterator = txn.upserted.find(task.location()); inner_iterator != txn.upserted.end()) {
-            buffer_t const& buf = inner_iterator->second;
-            std::memcpy(contents, buf.data(), buf.size());
-            offs[i] = static_cast<ukv_val_len_t>(contents - *c_found_values);
-            lens[i] = static_cast<ukv_val_len_t>(buf.size());
-            contents += buf.size();
-        }
-        // Some may have been deleted inside the transaction
-        else if (auto inner_iterator = txn.removed.find(task.location()); inner_iterator != txn.removed.end()) {
-            offs[i] = lens[i] = ukv_val_len_missing_k;
+        // Some keys may already be overwritten or deleted inside of transaction
+        if (auto entry = txn.log.find(task.location()); entry) {
+            value_view_t value = txn.log.value(*entry);
+            if (value) {
+                std::memcpy(contents, value.begin(), value.size());
+                offs[i] = static_cast<ukv_val_len_t>(contents - *c_found_values);
+                lens[i] = static_cast<ukv_val_len_t>(value.size());
+                contents += value.size();
+            }
+            else
+                offs[i] = lens[i] = ukv_val_len_missing_k;
         }
         // Others should be pulled from the main store
-        else if (auto key_iterator = col.pairs.find(task.key); key_iterator != col.pairs.end()) {
-
-            if (!key_iterator->second.is_deleted) {
-                buffer_t const& buf = key_iterator->second.buffer;
-                std::memcpy(contents, buf.data(), buf.size());
+        else if (auto key_iterator = col.find(task.key); key_iterator != col.pairs.end()) {
+
+            stl_value_t const* value = txn_visible(txn, key_iterator->second);
+            if (value && !value->is_deleted) {
+                std::size_t const length = value->size();
+                auto output = reinterpret_cast<byte_t*>(contents);
+                if (!value->export_to(output, col.compression) && (*c_error = "Failed to decompress the value!"))
+                    return;
                 offs[i] = static_cast<ukv_val_len_t>(contents - *c_found_values);
-                lens[i] = static_cast<ukv_val_len_t>(buf.size());
-                contents += buf.size();
+                lens[i] = static_cast<ukv_val_len_t>(length);
+                contents += length;
             }
             else
                 offs[i] = lens[i] = ukv_val_len_missing_k;
 
-            if (should_track_requests)
-                txn.requested.emplace(task.location(), key_iterator->second.generation);
+            if (should_track_requests && !track_read(txn, task.location(), value, c_error))
+                return;
         }
         // But some will be missing
         else {
             offs[i] = lens[i] = ukv_val_len_missing_k;
 
-            if (should_track_requests)
-                txn.requested.emplace(task.location(), generation_t {});
+            if (should_track_requests && !track_read(txn, task.location(), nullptr, c_error))
+                return;
         }
     }
 }
@@ -643,6 +1623,10 @@ void scan_txn( //
 
     stl_db_t& db = *txn.db_ptr;
     std::shared_lock _ {db.mutex};
+    cols_shared_lock_t cols_lock {db, arena.backend_cols};
+    lock_cols(tasks, cols_lock, c_error);
+    if (*c_error)
+        return;
 
     // 1. Estimate the total size
     bool export_lengths = (options & ukv_option_read_lengths_k);
@@ -653,7 +1637,7 @@ void scan_txn( //
         total_bytes += total_lengths * sizeof(ukv_val_len_t);
 
     // 2. Allocate a tape for all the values to be fetched
-    byte_t* tape = prepare_memory(arena.output_tape, total_bytes, c_error);
+    byte_t* tape = prepare_memory(arena, arena.output_tape, total_bytes, c_error);
     if (*c_error)
         return;
 
@@ -662,47 +1646,43 @@ void scan_txn( //
     ukv_val_len_t* found_lens = reinterpret_cast<ukv_val_len_t*>(found_keys + total_lengths);
     *c_found_keys = found_keys;
     *c_found_lengths = export_lengths ? found_lens : nullptr;
+    txn.log.sort();
 
     for (ukv_size_t i = 0; i != tasks.count; ++i) {
         scan_task_t task = tasks[i];
         stl_col_t const& col = stl_col(db, task.col);
         auto key_iterator = col.pairs.lower_bound(task.min_key);
-        auto txn_iterator = txn.upserted.lower_bound(task.min_key);
+        auto txn_iterator = txn.log.lower_bound(task.location());
         ukv_size_t j = 0;
 
-        for (; j != task.length && key_iterator != col.pairs.end();) {
-            // Check if the key was already removed:
-            if (key_iterator->second.is_deleted || txn.removed.find(key_iterator->first) != txn.removed.end()) {
-                ++key_iterator;
+        // Merge the sorted entries of the transaction, that shadow the main store, with the collection
+        while (j != task.length) {
+            bool has_main = key_iterator != col.pairs.end();
+            bool has_txn = txn_iterator != txn.log.end() && txn_iterator->location.col == task.col;
+            if (!has_main && !has_txn)
+                break;
+
+            if (has_txn && (!has_main || txn_iterator->location.key <= key_iterator->first)) {
+                if (has_main && txn_iterator->location.key == key_iterator->first)
+                    ++key_iterator;
+                if (txn_iterator->length != ukv_val_len_missing_k) {
+                    found_keys[j] = txn_iterator->location.key;
+                    if (export_lengths)
+                        found_lens[j] = txn_iterator->length;
+                    ++j;
+                }
+                ++txn_iterator;
                 continue;
             }
 
-            // Compare against the incoming inserted keys:
-            bool check_in_txn = txn_iterator != txn.upserted.end() && txn_iterator->first.col == task.col;
-            if (check_in_txn && txn_iterator->first.key <= key_iterator->first) {
-                found_keys[j] = txn_iterator->first.key;
+            stl_value_t const* value = txn_visible(txn, key_iterator->second);
+            if (value && !value->is_deleted) {
+                found_keys[j] = key_iterator->first;
                 if (export_lengths)
-                    found_lens[j] = static_cast<ukv_val_len_t>(txn_iterator->second.size());
-                ++txn_iterator;
+                    found_lens[j] = static_cast<ukv_val_len_t>(value->size());
                 ++j;
-                continue;
             }
-
-            // Export from the main store:
-            found_keys[j] = key_iterator->first;
-            if (export_lengths)
-                found_lens[j] = static_cast<ukv_val_len_t>(key_iterator->second.buffer.size());
             ++key_iterator;
-            ++j;
-        }
-
-        // As in any `set_union`, don't forget the tail :)
-        while (j != task.length && txn_iterator != txn.upserted.end() && txn_iterator->first.col == task.col) {
-            found_keys[j] = txn_iterator->first.key;
-            if (export_lengths)
-                found_lens[j] = static_cast<ukv_val_len_t>(txn_iterator->second.size());
-            ++txn_iterator;
-            ++j;
         }
 
         // Append NULLs to overwrite older noise:
@@ -733,6 +1713,8 @@ void ukv_db_open( //
         if (len) {
             db_ptr->persisted_path = std::string(c_config, len);
             read_from_disk(*db_ptr, c_error);
+            if (!*c_error)
+                wal_replay_and_open(*db_ptr, c_error);
         }
         *c_db = db_ptr;
     }
@@ -764,11 +1746,13 @@ void ukv_read( //
     if (!c_db && (*c_error = "DataBase is NULL!"))
         return;
 
+    stl_db_t& db = *reinterpret_cast<stl_db_t*>(c_db);
+    metrics_scope_t metrics {
+        db.metrics, metric_op_t::read_k, first_col(c_cols, c_tasks_count), c_tasks_count, c_error, c_arena};
     stl_arena_t& arena = *cast_arena(c_arena, c_error);
     if (*c_error)
         return;
 
-    stl_db_t& db = *reinterpret_cast<stl_db_t*>(c_db);
     stl_txn_t& txn = *reinterpret_cast<stl_txn_t*>(c_txn);
     strided_iterator_gt<ukv_col_t const> cols {c_cols, c_cols_stride};
     strided_iterator_gt<ukv_key_t const> keys {c_keys, c_keys_stride};
@@ -784,43 +1768,216 @@ void ukv_read( //
     }
 }
 
-void ukv_write( //
+void ukv_write( //
+    ukv_t const c_db,
+    ukv_txn_t const c_txn,
+    ukv_size_t const c_tasks_count,
+
+    ukv_col_t const* c_cols,
+    ukv_size_t const c_cols_stride,
+
+    ukv_key_t const* c_keys,
+    ukv_size_t const c_keys_stride,
+
+    ukv_val_ptr_t const* c_vals,
+    ukv_size_t const c_vals_stride,
+
+    ukv_val_len_t const* c_offs,
+    ukv_size_t const c_offs_stride,
+
+    ukv_val_len_t const* c_lens,
+    ukv_size_t const c_lens_stride,
+
+    ukv_options_t const c_options,
+    ukv_arena_t* c_arena,
+    ukv_error_t* c_error) {
+
+    if (!c_db && (*c_error = "DataBase is NULL!"))
+        return;
+
+    stl_db_t& db = *reinterpret_cast<stl_db_t*>(c_db);
+    metrics_scope_t metrics {
+        db.metrics, metric_op_t::write_k, first_col(c_cols, c_tasks_count), c_tasks_count, c_error, c_arena};
+    numa_scope_t numa = numa_scope(db, first_col(c_cols, c_tasks_count));
+
+    stl_arena_t* arena_ptr = optional_arena(c_arena, c_error);
+    if (*c_error)
+        return;
+    stl_arena_t& arena = *arena_ptr;
+
+    stl_txn_t& txn = *reinterpret_cast<stl_txn_t*>(c_txn);
+    strided_iterator_gt<ukv_col_t const> cols {c_cols, c_cols_stride};
+    strided_iterator_gt<ukv_key_t const> keys {c_keys, c_keys_stride};
+    strided_iterator_gt<ukv_val_ptr_t const> vals {c_vals, c_vals_stride};
+    strided_iterator_gt<ukv_val_len_t const> offs {c_offs, c_offs_stride};
+    strided_iterator_gt<ukv_val_len_t const> lens {c_lens, c_lens_stride};
+    write_tasks_soa_t tasks {cols, keys, vals, offs, lens, c_tasks_count};
+
+    return c_txn ? write_txn(txn, tasks, c_options, c_error) : write_head(db, tasks, c_options, arena, c_error);
+}
+
+void ukv_bulk_load( //
+    ukv_t const c_db,
+    ukv_size_t const c_tasks_count,
+
+    ukv_col_t const* c_cols,
+    ukv_size_t const c_cols_stride,
+
+    ukv_key_t const* c_keys,
+    ukv_size_t const c_keys_stride,
+
+    ukv_val_ptr_t const* c_vals,
+    ukv_size_t const c_vals_stride,
+
+    ukv_val_len_t const* c_offs,
+    ukv_size_t const c_offs_stride,
+
+    ukv_val_len_t const* c_lens,
+    ukv_size_t const c_lens_stride,
+
+    ukv_options_t const c_options,
+    ukv_arena_t* c_arena,
+    ukv_error_t* c_error) {
+
+    if (!c_db && (*c_error = "DataBase is NULL!"))
+        return;
+
+    stl_db_t& db = *reinterpret_cast<stl_db_t*>(c_db);
+    metrics_scope_t metrics {
+        db.metrics, metric_op_t::write_k, first_col(c_cols, c_tasks_count), c_tasks_count, c_error, c_arena};
+    numa_scope_t numa = numa_scope(db, first_col(c_cols, c_tasks_count));
+    stl_arena_t* arena_ptr = optional_arena(c_arena, c_error);
+    if (*c_error)
+        return;
+    stl_arena_t& arena = *arena_ptr;
+
+    strided_iterator_gt<ukv_col_t const> cols {c_cols, c_cols_stride};
+    strided_iterator_gt<ukv_key_t const> keys {c_keys, c_keys_stride};
+    strided_iterator_gt<ukv_val_ptr_t const> vals {c_vals, c_vals_stride};
+    strided_iterator_gt<ukv_val_len_t const> offs {c_offs, c_offs_stride};
+    strided_iterator_gt<ukv_val_len_t const> lens {c_lens, c_lens_stride};
+    write_tasks_soa_t tasks {cols, keys, vals, offs, lens, c_tasks_count};
+
+    // Sorted entries either land in the tail of the collection, or take the regular path
+    validate_bulk_load(tasks, c_error);
+    if (*c_error)
+        return;
+    write_head(db, tasks, c_options, arena, c_error);
+}
+
+/**
+ * @brief Removes the entries in `[min_key, max_key)` of a single collection.
+ * Without active snapshots, the blocks are erased, leaving no tombstones behind.
+ * Otherwise every entry becomes a tombstone, preserving the versions snapshots see.
+ */
+void remove_range_head( //
+    stl_db_t& db,
+    stl_col_t& col,
+    ukv_key_t min_key,
+    ukv_key_t max_key,
+    snapshots_horizon_t const& horizon) {
+
+    if (horizon.empty) {
+        col.erase_range(min_key, max_key);
+        if (col.changes.enabled())
+            col.changes.truncate(++db.youngest_generation);
+        return;
+    }
+
+    auto max_iterator = col.pairs.lower_bound(max_key);
+    for (auto key_iterator = col.pairs.lower_bound(min_key); key_iterator != max_iterator; ++key_iterator) {
+        stl_value_t& value = key_iterator->second;
+        if (value.is_deleted)
+            continue;
+        col.forget(value);
+        try {
+            value.preserve(horizon);
+        }
+        catch (...) {
+            col.count(value);
+            throw;
+        }
+        value.generation = ++db.youngest_generation;
+        value.is_deleted = true;
+        value.clear();
+        col.count(value);
+        col.changes.push(key_iterator->first, value.generation, ukv_val_len_missing_k);
+    }
+}
+
+void ukv_remove_range( //
     ukv_t const c_db,
-    ukv_txn_t const c_txn,
     ukv_size_t const c_tasks_count,
 
     ukv_col_t const* c_cols,
     ukv_size_t const c_cols_stride,
 
-    ukv_key_t const* c_keys,
-    ukv_size_t const c_keys_stride,
-
-    ukv_val_ptr_t const* c_vals,
-    ukv_size_t const c_vals_stride,
-
-    ukv_val_len_t const* c_offs,
-    ukv_size_t const c_offs_stride,
+    ukv_key_t const* c_min_keys,
+    ukv_size_t const c_min_keys_stride,
 
-    ukv_val_len_t const* c_lens,
-    ukv_size_t const c_lens_stride,
+    ukv_key_t const* c_max_keys,
+    ukv_size_t const c_max_keys_stride,
 
     ukv_options_t const c_options,
-    ukv_arena_t*,
+    ukv_arena_t* c_arena,
     ukv_error_t* c_error) {
 
     if (!c_db && (*c_error = "DataBase is NULL!"))
         return;
 
     stl_db_t& db = *reinterpret_cast<stl_db_t*>(c_db);
-    stl_txn_t& txn = *reinterpret_cast<stl_txn_t*>(c_txn);
+    metrics_scope_t metrics {
+        db.metrics, metric_op_t::write_k, first_col(c_cols, c_tasks_count), c_tasks_count, c_error, c_arena};
+    numa_scope_t numa = numa_scope(db, first_col(c_cols, c_tasks_count));
+    stl_arena_t* arena_ptr = optional_arena(c_arena, c_error);
+    if (*c_error)
+        return;
+    stl_arena_t& arena = *arena_ptr;
+
     strided_iterator_gt<ukv_col_t const> cols {c_cols, c_cols_stride};
-    strided_iterator_gt<ukv_key_t const> keys {c_keys, c_keys_stride};
-    strided_iterator_gt<ukv_val_ptr_t const> vals {c_vals, c_vals_stride};
-    strided_iterator_gt<ukv_val_len_t const> offs {c_offs, c_offs_stride};
-    strided_iterator_gt<ukv_val_len_t const> lens {c_lens, c_lens_stride};
-    write_tasks_soa_t tasks {cols, keys, vals, offs, lens, c_tasks_count};
+    strided_iterator_gt<ukv_key_t const> min_keys {c_min_keys, c_min_keys_stride};
+    strided_iterator_gt<ukv_key_t const> max_keys {c_max_keys, c_max_keys_stride};
+    read_tasks_soa_t mins {cols, min_keys, c_tasks_count};
+
+    std::shared_lock db_lock {db.mutex};
+    cols_unique_lock_t cols_lock {db, arena.backend_cols};
+    lock_cols(mins, cols_lock, c_error);
+    if (*c_error)
+        return;
+
+    // Log the ranges, before erasing them
+    std::size_t wal_sequence = 0;
+    if (!db.persisted_path.empty()) {
+        buffer_t& record = arena.backend_tape;
+        record.clear();
+        try {
+            for (ukv_size_t i = 0; i != c_tasks_count; ++i)
+                wal_push_remove_range(record, stl_col(db, mins[i].col), mins[i].key, max_keys[i]);
+        }
+        catch (...) {
+            *c_error = "Failed to allocate memory!";
+            return;
+        }
+        wal_sequence = wal_append(db, record, c_error);
+        if (*c_error)
+            return;
+    }
+
+    std::shared_lock snapshots_lock {db.snapshots_mutex};
+    snapshots_horizon_t const horizon = snapshots_horizon(db);
+    try {
+        for (ukv_size_t i = 0; i != c_tasks_count; ++i)
+            remove_range_head(db, stl_col(db, mins[i].col), mins[i].key, max_keys[i], horizon);
+    }
+    catch (...) {
+        *c_error = "Failed to allocate memory!";
+    }
 
-    return c_txn ? write_txn(txn, tasks, c_options, c_error) : write_head(db, tasks, c_options, c_error);
+    snapshots_lock.unlock();
+    cols_lock.unlock();
+    db_lock.unlock();
+    if (!*c_error && (c_options & ukv_option_write_flush_k))
+        wal_sync(db, wal_sequence, c_error);
 }
 
 void ukv_scan( //
@@ -848,11 +2005,13 @@ void ukv_scan( //
     if (!c_db && (*c_error = "DataBase is NULL!"))
         return;
 
+    stl_db_t& db = *reinterpret_cast<stl_db_t*>(c_db);
+    metrics_scope_t metrics {
+        db.metrics, metric_op_t::scan_k, first_col(c_cols, c_min_tasks_count), c_min_tasks_count, c_error, c_arena};
     stl_arena_t& arena = *cast_arena(c_arena, c_error);
     if (*c_error)
         return;
 
-    stl_db_t& db = *reinterpret_cast<stl_db_t*>(c_db);
     stl_txn_t& txn = *reinterpret_cast<stl_txn_t*>(c_txn);
     strided_iterator_gt<ukv_col_t const> cols {c_cols, c_cols_stride};
     strided_iterator_gt<ukv_key_t const> keys {c_min_keys, c_min_keys_stride};
@@ -886,74 +2045,238 @@ void ukv_size( //
     if (!c_db && (*c_error = "DataBase is NULL!"))
         return;
 
+    stl_db_t& db = *reinterpret_cast<stl_db_t*>(c_db);
+    metrics_scope_t metrics {db.metrics, metric_op_t::size_k, first_col(c_cols, n), n, c_error, c_arena};
     stl_arena_t& arena = *cast_arena(c_arena, c_error);
     if (*c_error)
         return;
 
     std::size_t bytes_needed = sizeof(ukv_size_t) * 6 * n;
-    *c_found_estimates = reinterpret_cast<ukv_size_t*>(prepare_memory(arena.output_tape, bytes_needed, c_error));
+    *c_found_estimates = reinterpret_cast<ukv_size_t*>(prepare_memory(arena, arena.output_tape, bytes_needed, c_error));
     if (*c_error)
         return;
 
-    stl_db_t& db = *reinterpret_cast<stl_db_t*>(c_db);
     stl_txn_t& txn = *reinterpret_cast<stl_txn_t*>(c_txn);
     strided_iterator_gt<ukv_col_t const> cols {c_cols, c_cols_stride};
     strided_iterator_gt<ukv_key_t const> min_keys {c_min_keys, c_min_keys_stride};
     strided_iterator_gt<ukv_key_t const> max_keys {c_max_keys, c_max_keys_stride};
 
     std::shared_lock _ {db.mutex};
+    cols_shared_lock_t cols_lock {db, arena.backend_cols};
+    lock_cols(read_tasks_soa_t {cols, min_keys, n}, cols_lock, c_error);
+    if (*c_error)
+        return;
 
     for (ukv_size_t i = 0; i != n; ++i) {
         stl_col_t const& col = stl_col(db, cols[i]);
         ukv_key_t const min_key = min_keys[i];
         ukv_key_t const max_key = max_keys[i];
-        std::size_t deleted_count = 0;
-
-        // Estimate the presence in the main store
-        std::size_t main_count = 0;
-        std::size_t main_bytes = 0;
-        auto min_iterator = col.pairs.lower_bound(min_key);
-        auto max_iterator = col.pairs.lower_bound(max_key);
-        for (; min_iterator != max_iterator; ++min_iterator) {
-            if (min_iterator->second.is_deleted) {
-                ++deleted_count;
-                continue;
-            }
-            ++main_count;
-            main_bytes += min_iterator->second.buffer.size();
+
+        // Estimate the presence in the main store from the running totals and
+        // the order statistics of keys, without visiting the entries in range.
+        // The range holds an unknown share of deleted entries, bounding the live ones.
+        std::size_t entries = 0;
+        try {
+            entries = col.count_range(min_key, max_key);
+        }
+        catch (...) {
+            *c_error = "Failed to allocate memory!";
+            return;
         }
+        std::size_t const live_count = col.live_count.load();
+        std::size_t const live_bytes = col.live_bytes.load();
+        std::size_t const deleted_count = col.deleted_count.load();
+        std::size_t const min_count = entries > deleted_count ? entries - deleted_count : 0;
+        std::size_t const max_count = std::min(entries, live_count);
+
+        // Values in partial ranges are assumed to be of average length
+        auto bytes_in = [=](std::size_t count) noexcept -> std::size_t {
+            if (count == live_count)
+                return live_bytes;
+            return static_cast<std::size_t>(static_cast<long double>(live_bytes) * count / live_count);
+        };
 
         // Estimate the metrics from within a transaction
         std::size_t txn_count = 0;
         std::size_t txn_bytes = 0;
+        std::size_t txn_deleted_count = 0;
         if (c_txn) {
-            auto min_iterator = txn.upserted.lower_bound(min_key);
-            auto max_iterator = txn.upserted.lower_bound(max_key);
-            for (; min_iterator != max_iterator; ++min_iterator, ++txn_count)
-                txn_bytes += min_iterator->second.size();
-            deleted_count += txn.removed.size();
+            txn.log.sort();
+            auto min_iterator = txn.log.lower_bound(col_key_t {cols[i], min_key});
+            auto max_iterator = txn.log.lower_bound(col_key_t {cols[i], max_key});
+            for (; min_iterator != max_iterator; ++min_iterator) {
+                if (min_iterator->length == ukv_val_len_missing_k) {
+                    ++txn_deleted_count;
+                    continue;
+                }
+                ++txn_count;
+                txn_bytes += min_iterator->length;
+            }
         }
 
         //
         ukv_size_t* estimates = *c_found_estimates + i * 6;
-        estimates[0] = static_cast<ukv_size_t>(main_count);
-        estimates[1] = static_cast<ukv_size_t>(main_count + txn_count);
-        estimates[2] = static_cast<ukv_size_t>(main_bytes);
-        estimates[3] = static_cast<ukv_size_t>(main_bytes + txn_bytes);
+        estimates[0] = static_cast<ukv_size_t>(min_count);
+        estimates[1] = static_cast<ukv_size_t>(max_count + txn_count);
+        estimates[2] = static_cast<ukv_size_t>(bytes_in(min_count));
+        estimates[3] = static_cast<ukv_size_t>(bytes_in(max_count) + txn_bytes);
         estimates[4] = estimates[0] * (sizeof(ukv_key_t) + sizeof(ukv_val_len_t)) + estimates[2];
-        estimates[5] = (estimates[1] + deleted_count) * (sizeof(ukv_key_t) + sizeof(ukv_val_len_t)) + estimates[3];
+        estimates[5] = (entries + txn_count + txn_deleted_count) * (sizeof(ukv_key_t) + sizeof(ukv_val_len_t)) +
+                       estimates[3];
     }
 }
 
+void ukv_changes_since( //
+    ukv_t const c_db,
+    ukv_col_t const c_col,
+    ukv_size_t const c_generation,
+    ukv_size_t const c_limit,
+
+    ukv_size_t* c_found_count,
+    ukv_key_t** c_found_keys,
+    ukv_size_t** c_found_generations,
+    ukv_val_len_t** c_found_lengths,
+    ukv_size_t* c_next_generation,
+
+    ukv_arena_t* c_arena,
+    ukv_error_t* c_error) {
+
+    if (!c_db && (*c_error = "DataBase is NULL!"))
+        return;
+
+    stl_db_t& db = *reinterpret_cast<stl_db_t*>(c_db);
+    metrics_scope_t metrics {db.metrics, metric_op_t::scan_k, c_col, 1, c_error, c_arena};
+    stl_arena_t& arena = *cast_arena(c_arena, c_error);
+    if (*c_error)
+        return;
+
+    std::shared_lock db_lock {db.mutex};
+    stl_col_t const& col = stl_col(db, c_col);
+    std::shared_lock col_lock {col.mutex};
+    if (!col.changes.enabled() && (*c_error = "Change feed isn't enabled for this collection!"))
+        return;
+
+    // Updates of the collection get their generations under its lock,
+    // so every one up to the youngest generation is already in the feed
+    auto const youngest = static_cast<ukv_size_t>(db.youngest_generation.load());
+    *c_found_count = 0;
+    *c_next_generation = youngest;
+    if (!c_limit)
+        return;
+
+    std::size_t count = 0;
+    ukv_size_t last_generation = 0;
+    auto count_change = [&](change_feed_t::change_t const& change) {
+        ++count;
+        last_generation = change.generation;
+    };
+    if (!col.changes.for_each_since(c_generation, c_limit, count_change) &&
+        (*c_error = "Changes since this generation were evicted, a full rescan is needed!"))
+        return;
+
+    std::size_t const bytes_needed = count * (sizeof(ukv_key_t) + sizeof(ukv_size_t) + sizeof(ukv_val_len_t));
+    byte_t* tape = prepare_memory(arena, arena.output_tape, bytes_needed, c_error);
+    if (*c_error)
+        return;
+
+    auto keys = reinterpret_cast<ukv_key_t*>(tape);
+    auto generations = reinterpret_cast<ukv_size_t*>(keys + count);
+    auto lengths = reinterpret_cast<ukv_val_len_t*>(generations + count);
+    std::size_t i = 0;
+    col.changes.for_each_since(c_generation, c_limit, [&](change_feed_t::change_t const& change) {
+        keys[i] = change.key;
+        generations[i] = change.generation;
+        lengths[i] = change.length;
+        ++i;
+    });
+
+    *c_found_count = static_cast<ukv_size_t>(count);
+    *c_found_keys = keys;
+    *c_found_generations = generations;
+    *c_found_lengths = lengths;
+    // Past the newest change, the follower can skip the updates of other collections
+    if (count && last_generation != col.changes.newest())
+        *c_next_generation = last_generation;
+    else
+        *c_next_generation = std::max(c_generation, youngest);
+}
+
 /*********************************************************/
 /*****************	Collections Management	****************/
 /*********************************************************/
 
+/**
+ * @brief Applies the collection config:
+ * {
+ *     "compression": "none" | "lz4",
+ *     "dictionary": "...",
+ *     "bloom_bits_per_key": 10,
+ *     "change_feed": 65536,
+ *     "numa_node": 1 | "auto"
+ * }
+ * Compression can't be changed, once enabled, as the existing values depend on it.
+ * The Bloom filter of present keys is rebuilt, whenever its size changes, and zero disables it.
+ * Resizing the change feed drops its history, which only covers the updates after the @p youngest generation.
+ * The NUMA node index wraps around the number of nodes, so configs stay valid on smaller hosts,
+ * and "auto" picks one by the hash of the collection name.
+ */
+void configure(stl_col_t& col, generation_t youngest, ukv_str_view_t c_config, ukv_error_t* c_error) {
+    std::string_view text = c_config ? c_config : "";
+    if (text.empty())
+        return;
+
+    try {
+        auto json = nlohmann::json::parse(text);
+        if (json.contains("compression")) {
+            auto compression = json["compression"].get<std::string>();
+            auto dictionary = json.value("dictionary", std::string {});
+            if (compression != "none" && compression != "lz4" && (*c_error = "Unknown STL compression!"))
+                return;
+
+            bool const enable = compression == "lz4";
+            if (!col.compression.enabled()) {
+                if (enable)
+                    col.compression.enable(dictionary);
+            }
+            else if ((!enable || dictionary != col.compression.dictionary()) &&
+                     (*c_error = "Compression of a collection can't be changed!"))
+                return;
+        }
+
+        auto bloom_bits_per_key = json.value("bloom_bits_per_key", col.filter.bits_per_key());
+        if (bloom_bits_per_key != col.filter.bits_per_key())
+            col.rebuild_filter(bloom_bits_per_key);
+
+        auto change_feed = json.value("change_feed", col.changes.capacity());
+        if (change_feed != col.changes.capacity())
+            col.changes.reset(change_feed, static_cast<ukv_size_t>(youngest));
+
+        if (json.contains("numa_node")) {
+            auto const& numa_node = json["numa_node"];
+            std::size_t const nodes = numa_topology_t::host().size();
+            if (numa_node.is_string() && numa_node.get<std::string>() == "auto")
+                col.numa_node = std::hash<std::string> {}(col.name) % nodes;
+            else if (numa_node.is_number_unsigned())
+                col.numa_node = numa_node.get<std::size_t>() % nodes;
+            else if (numa_node.is_null())
+                col.numa_node = numa_any_k;
+            else if ((*c_error = "Invalid NUMA node!"))
+                return;
+        }
+    }
+    catch (nlohmann::json::exception const&) {
+        *c_error = "Invalid STL collection config!";
+    }
+    catch (...) {
+        *c_error = "Failed to allocate memory!";
+    }
+}
+
 void ukv_col_open(
     // Inputs:
     ukv_t const c_db,
     ukv_str_view_t c_col_name,
-    ukv_str_view_t,
+    ukv_str_view_t c_config,
     // Outputs:
     ukv_col_t* c_col,
     ukv_error_t* c_error) {
@@ -961,13 +2284,17 @@ void ukv_col_open(
     if (!c_db && (*c_error = "DataBase is NULL!"))
         return;
 
+    stl_db_t& db = *reinterpret_cast<stl_db_t*>(c_db);
     auto name_len = std::strlen(c_col_name);
     if (!name_len) {
+        if (c_config && std::strlen(c_config)) {
+            std::unique_lock _ {db.mutex};
+            configure(db.main, db.youngest_generation, c_config, c_error);
+        }
         *c_col = ukv_col_main_k;
         return;
     }
 
-    stl_db_t& db = *reinterpret_cast<stl_db_t*>(c_db);
     std::unique_lock _ {db.mutex};
 
     auto const col_name = std::string_view(c_col_name, name_len);
@@ -976,6 +2303,9 @@ void ukv_col_open(
         try {
             auto new_col = std::make_unique<stl_col_t>();
             new_col->name = col_name;
+            configure(*new_col, db.youngest_generation, c_config, c_error);
+            if (*c_error)
+                return;
             *c_col = reinterpret_cast<ukv_col_t>(new_col.get());
             db.named.emplace(new_col->name, std::move(new_col));
         }
@@ -984,6 +2314,7 @@ void ukv_col_open(
         }
     }
     else {
+        configure(*col_it->second, db.youngest_generation, c_config, c_error);
         *c_col = reinterpret_cast<ukv_col_t>(col_it->second.get());
     }
 }
@@ -1001,17 +2332,43 @@ void ukv_col_remove(
     stl_db_t& db = *reinterpret_cast<stl_db_t*>(c_db);
     std::unique_lock _ {db.mutex};
     auto name_len = std::strlen(c_col_name);
-    if (!name_len) {
-        db.main.pairs.clear();
-        db.main.unique_elements = 0;
+    auto col_name = std::string_view(c_col_name, name_len);
+
+    // Dropping a missing collection changes nothing, so nothing is logged
+    auto col_it = db.named.find(col_name);
+    if (name_len && col_it == db.named.end())
+        return;
+
+    if (!db.persisted_path.empty()) {
+        // The snapshot of this collection must not be loaded on the next open
+        buffer_t record;
+        try {
+            wal_push(record, wal_op_t::drop_col_k, col_name);
+        }
+        catch (...) {
+            *c_error = "Failed to allocate memory!";
+            return;
+        }
+        wal_append(db, record, c_error);
+        if (*c_error)
+            return;
+        std::error_code ignored_error;
+        fs::remove(fs::path(db.persisted_path) / (std::string(col_name) + ".stl.ukv"), ignored_error);
     }
-    else {
-        auto col_name = std::string_view(c_col_name, name_len);
-        auto col_it = db.named.find(col_name);
-        if (col_it != db.named.end()) {
-            db.named.erase(col_it);
+
+    if (!name_len) {
+        db.main.clear();
+        db.main.snapshot.close();
+        db.main.changes.truncate(++db.youngest_generation);
+        try {
+            db.main.rebuild_filter(db.main.filter.bits_per_key());
+        }
+        catch (...) {
+            *c_error = "Failed to allocate memory!";
         }
     }
+    else
+        db.named.erase(col_it);
 }
 
 void ukv_col_list( //
@@ -1029,7 +2386,7 @@ void ukv_col_list( //
         return;
 
     stl_db_t& db = *reinterpret_cast<stl_db_t*>(c_db);
-    std::unique_lock _ {db.mutex};
+    std::shared_lock _ {db.mutex};
 
     std::size_t total_length = 0;
     for (auto const& name_and_contents : db.named)
@@ -1039,7 +2396,7 @@ void ukv_col_list( //
     total_length += db.named.size();
     *c_count = static_cast<ukv_size_t>(db.named.size());
 
-    auto tape = prepare_memory(arena.output_tape, total_length, c_error);
+    auto tape = prepare_memory(arena, arena.output_tape, total_length, c_error);
     if (*c_error)
         return;
 
@@ -1065,6 +2422,83 @@ void ukv_db_control( //
         return;
 
     *c_response = NULL;
+    stl_db_t& db = *reinterpret_cast<stl_db_t*>(c_db);
+    if (std::string_view(c_request) == "commits") {
+        stl_commit_stats_t const& stats = db.commit_stats;
+        thread_local std::string response;
+        try {
+            response = "{\"commits\":" + std::to_string(stats.commits.load()) +
+                       ",\"failures\":" + std::to_string(stats.failures.load()) +
+                       ",\"lock_ns\":" + std::to_string(stats.lock_ns.load()) +
+                       ",\"validate_ns\":" + std::to_string(stats.validate_ns.load()) +
+                       ",\"log_ns\":" + std::to_string(stats.log_ns.load()) +
+                       ",\"apply_ns\":" + std::to_string(stats.apply_ns.load()) +
+                       ",\"sync_ns\":" + std::to_string(stats.sync_ns.load()) + "}";
+            *c_response = response.c_str();
+        }
+        catch (...) {
+            *c_error = "Failed to allocate memory!";
+        }
+        return;
+    }
+
+    std::string_view request {c_request};
+    if (request == "compact") {
+        // Snapshots the DB in the background, just like a full log segment would
+        std::unique_lock _ {db.wal.mutex};
+        if (db.wal.descriptor < 0)
+            *c_error = "Only persistent DBs can be compacted!";
+        else if (db.wal.is_compacting || db.wal.is_syncing)
+            *c_error = "The log is busy, retry later!";
+        else if (!wal_rotate(db))
+            *c_error = "Failed to start a new log segment!";
+        return;
+    }
+
+    constexpr std::string_view numa_node_k = "numa_node:";
+    if (request.substr(0, numa_node_k.size()) == numa_node_k) {
+        // Answers with the node index of the collection handle, or "any" for unhomed ones
+        thread_local std::string response;
+        auto col = static_cast<ukv_col_t>(std::strtoull(c_request + numa_node_k.size(), nullptr, 10));
+        std::shared_lock _ {db.mutex};
+        bool exists = col == ukv_col_main_k;
+        for (auto it = db.named.begin(); !exists && it != db.named.end(); ++it)
+            exists = reinterpret_cast<ukv_col_t>(it->second.get()) == col;
+        if (!exists && (*c_error = "Unknown collection!"))
+            return;
+        try {
+            std::size_t node = stl_col(db, col).numa_node;
+            response = node == numa_any_k ? "any" : std::to_string(node);
+            *c_response = response.c_str();
+        }
+        catch (...) {
+            *c_error = "Failed to allocate memory!";
+        }
+        return;
+    }
+
+    if (request == "metrics" || request == "metrics.prometheus") {
+        thread_local std::string response;
+        try {
+            std::shared_lock _ {db.mutex};
+            auto name_of = [&](ukv_col_t col) -> std::string {
+                if (col == ukv_col_main_k)
+                    return {};
+                for (auto const& [name, col_ptr] : db.named)
+                    if (reinterpret_cast<ukv_col_t>(col_ptr.get()) == col)
+                        return std::string(name);
+                // The collection was removed
+                return "#" + std::to_string(col);
+            };
+            response = request == "metrics" ? db.metrics.json(name_of) : db.metrics.prometheus(name_of);
+            *c_response = response.c_str();
+        }
+        catch (...) {
+            *c_error = "Failed to allocate memory!";
+        }
+        return;
+    }
+
     *c_error = "Controls aren't supported in this implementation!";
 }
 
@@ -1072,11 +2506,17 @@ void ukv_db_control( //
 /*****************		Transactions	  ****************/
 /*********************************************************/
 
+/// Counts the transactions, that are reset or freed, discarding their updates.
+void count_abort(stl_txn_t const& txn) noexcept {
+    if (txn.db_ptr && !txn.is_committed && !txn.log.empty())
+        ++txn.db_ptr->metrics.txn_aborts;
+}
+
 void ukv_txn_begin(
     // Inputs:
     ukv_t const c_db,
     ukv_size_t const c_generation,
-    ukv_options_t const,
+    ukv_options_t const c_options,
     // Outputs:
     ukv_txn_t* c_txn,
     ukv_error_t* c_error) {
@@ -1085,128 +2525,322 @@ void ukv_txn_begin(
         return;
 
     stl_db_t& db = *reinterpret_cast<stl_db_t*>(c_db);
+    metrics_scope_t metrics {db.metrics, metric_op_t::txn_begin_k, ukv_col_main_k, 1, c_error};
     if (!*c_txn) {
         try {
             *c_txn = new stl_txn_t();
         }
         catch (...) {
             *c_error = "Failed to initialize the transaction";
+            return;
         }
     }
 
     stl_txn_t& txn = *reinterpret_cast<stl_txn_t*>(*c_txn);
+    count_abort(txn);
+    release_snapshot(txn);
     txn.db_ptr = &db;
-    txn.generation = c_generation ? c_generation : ++db.youngest_generation;
+    txn.is_committed = false;
+
+    // Snapshots must not start in the middle of a batch, to avoid seeing a part of it
+    if (c_options & ukv_option_txn_snapshot_k) {
+        try {
+            std::unique_lock _ {db.snapshots_mutex};
+            txn.generation = c_generation ? c_generation : ++db.youngest_generation;
+            db.snapshots.insert(txn.generation);
+            txn.is_snapshot = true;
+        }
+        catch (...) {
+            *c_error = "Failed to register the snapshot!";
+            return;
+        }
+    }
+    else
+        txn.generation = c_generation ? c_generation : ++db.youngest_generation;
     txn.requested.clear();
-    txn.upserted.clear();
-    txn.removed.clear();
+    txn.log.clear();
 }
 
-void ukv_txn_commit( //
-    ukv_txn_t const c_txn,
+/// Adds the time passed since the previous phase to one of `stl_commit_stats_t` counters.
+class phase_timer_t {
+    std::chrono::steady_clock::time_point last_ = std::chrono::steady_clock::now();
+
+  public:
+    void lap(std::atomic<std::uint64_t>& counter) noexcept {
+        auto now = std::chrono::steady_clock::now();
+        counter += std::chrono::duration_cast<std::chrono::nanoseconds>(now - last_).count();
+        last_ = now;
+    }
+};
+
+void commit_txn( //
+    stl_txn_t& txn,
     ukv_options_t const c_options,
     ukv_error_t* c_error) {
 
-    if (!c_txn && (*c_error = "Transaction is NULL!"))
-        return;
-
     // This write may fail with out-of-memory errors, if Hash-Tables
     // bucket allocation fails, but no values will be copied, only moved.
-    stl_txn_t& txn = *reinterpret_cast<stl_txn_t*>(c_txn);
     stl_db_t& db = *txn.db_ptr;
-    std::unique_lock _ {db.mutex};
+    stl_commit_stats_t& stats = db.commit_stats;
+    phase_timer_t timer;
+    std::shared_lock db_lock {db.mutex};
+
+    // 0. Sort the reads and the updates, and lock every collection they touch
+    txn.requested.sort();
+    txn.log.sort();
+    std::vector<ukv_col_t> cols;
+    cols_unique_lock_t cols_lock {db, cols};
+    try {
+        for (auto const& read : txn.requested)
+            cols_lock.add(read.location.col);
+        for (auto const& entry : txn.log)
+            cols_lock.add(entry.location.col);
+        cols_lock.lock();
+    }
+    catch (...) {
+        *c_error = "Failed to lock collections!";
+        return;
+    }
+    timer.lap(stats.lock_ns);
     generation_t const youngest_generation = db.youngest_generation.load();
-
-    // 1. Check for refreshes among fetched keys
-    for (auto const& [col_key, sub_generation] : txn.requested) {
-        stl_col_t& col = stl_col(db, col_key.col);
-        auto key_iterator = col.pairs.find(col_key.key);
-        if (key_iterator == col.pairs.end())
-            continue;
-        if (key_iterator->second.generation != sub_generation &&
-            (*c_error = "Requested key was already overwritten since the start of the transaction!"))
-            return;
+    std::atomic<ukv_error_t> error {nullptr};
+
+    // 1. Check for refreshes among fetched keys, validating disjoint slices of them in parallel
+    txn_reads_t::read_t const* reads = txn.requested.begin();
+    parallel_for_chunks(txn.requested.size(), parallel_chunk_k, 0, [&](std::size_t begin, std::size_t end) noexcept {
+        for (std::size_t i = begin; i != end && !error.load(std::memory_order_relaxed); ++i) {
+            auto const& [col_key, sub_generation] = reads[i];
+            stl_col_t const& col = stl_col(db, col_key.col);
+            auto key_iterator = col.pairs.find(col_key.key);
+            // Entries, that were seen, but aren't present anymore, were erased by range removals
+            bool was_changed = key_iterator != col.pairs.end() ? key_iterator->second.generation != sub_generation
+                                                               : sub_generation != generation_t {};
+            if (was_changed)
+                report_error(error, "Requested key was already overwritten since the start of the transaction!");
+        }
+    });
+    if ((*c_error = error.load())) {
+        ++db.metrics.txn_conflicts;
+        return;
     }
 
-    // 2. Check for collisions among incoming values
-    for (auto const& [col_key, value] : txn.upserted) {
-        stl_col_t& col = stl_col(db, col_key.col);
-        auto key_iterator = col.pairs.find(col_key.key);
-        if (key_iterator == col.pairs.end())
-            continue;
-
-        if (key_iterator->second.generation == txn.generation && (*c_error = "Can't commit same entry more than once!"))
-            return;
-
-        if (entry_was_overwritten(key_iterator->second.generation, txn.generation, youngest_generation) &&
-            (*c_error = "Incoming key collides with newer entry!"))
-            return;
+    // 2. The log is already sorted, so the updates come in the order of collections and keys
+    std::vector<stl_txn_update_t>& updates = txn.updates;
+    try {
+        updates.clear();
+        updates.reserve(txn.log.size());
+        for (auto const& entry : txn.log)
+            updates.push_back({entry.location, txn.log.value(entry)});
+    }
+    catch (...) {
+        *c_error = "Not enough memory!";
+        return;
     }
 
-    // 3. Check for collisions among deleted values
-    for (auto const& col_key : txn.removed) {
-        stl_col_t& col = stl_col(db, col_key.col);
-        auto key_iterator = col.pairs.find(col_key.key);
-        if (key_iterator == col.pairs.end())
-            continue;
-
-        if (key_iterator->second.generation == txn.generation && (*c_error = "Can't commit same entry more than once!"))
-            return;
+    // 3. Check for collisions among incoming and deleted values, remembering the
+    // existing entries. Those references stay valid, until new keys are inserted.
+    parallel_for_chunks(updates.size(), parallel_chunk_k, 0, [&](std::size_t begin, std::size_t end) noexcept {
+        for (std::size_t i = begin; i != end && !error.load(std::memory_order_relaxed); ++i) {
+            stl_txn_update_t& update = updates[i];
+            stl_col_t& col = stl_col(db, update.location.col);
+            auto key_iterator = col.pairs.find(update.location.key);
+            if (key_iterator == col.pairs.end())
+                continue;
 
-        if (entry_was_overwritten(key_iterator->second.generation, txn.generation, youngest_generation) &&
-            (*c_error = "Removed key collides with newer entry!"))
-            return;
+            generation_t const generation = key_iterator->second.generation;
+            if (generation == txn.generation)
+                report_error(error, "Can't commit same entry more than once!");
+            else if (entry_was_overwritten(generation, txn.generation, youngest_generation))
+                report_error(error,
+                             update.value ? "Incoming key collides with newer entry!"
+                                          : "Removed key collides with newer entry!");
+            else
+                update.existing = &key_iterator->second;
+        }
+    });
+    if ((*c_error = error.load())) {
+        ++db.metrics.txn_conflicts;
+        return;
     }
 
-    // 4. Allocate space for more vertices across different cols
+    // 4. Insert the new keys as placeholders, in parallel across collections, and refresh the references.
+    // Nothing may fail after logging, so the new entries are allocated here. If a later step fails,
+    // the placeholders stay behind as deleted entries of the zero generation, same as missing keys.
+    std::vector<std::pair<std::size_t, std::size_t>> col_ranges;
     try {
-        db.main.reserve_more(txn.upserted.size());
-        for (auto& name_and_col : db.named)
-            name_and_col.second->reserve_more(txn.upserted.size());
+        for (std::size_t i = 0; i != updates.size();) {
+            std::size_t const begin = i;
+            bool has_new_entries = false;
+            for (; i != updates.size() && updates[i].location.col == updates[begin].location.col; ++i)
+                has_new_entries |= updates[i].value && !updates[i].existing;
+            if (has_new_entries)
+                col_ranges.emplace_back(begin, i);
+        }
     }
     catch (...) {
         *c_error = "Not enough memory!";
         return;
     }
+    parallel_for_chunks(col_ranges.size(), 1, 0, [&](std::size_t begin, std::size_t end) noexcept {
+        for (std::size_t range_idx = begin; range_idx != end; ++range_idx) {
+            auto const [first, last] = col_ranges[range_idx];
+            stl_col_t& col = stl_col(db, updates[first].location.col);
+            try {
+                std::size_t col_new_entries = 0;
+                for (std::size_t i = first; i != last; ++i)
+                    col_new_entries += updates[i].value && !updates[i].existing;
+                col.reserve_more(col_new_entries);
+                for (std::size_t i = first; i != last; ++i) {
+                    stl_txn_update_t& update = updates[i];
+                    if (!update.value || update.existing)
+                        continue;
+                    stl_value_t placeholder;
+                    placeholder.is_deleted = true;
+                    col.count(col.pairs.emplace(update.location.key, std::move(placeholder)).first->second);
+                    col.remember(update.location.key);
+                    ++col.unique_elements;
+                    update.is_new = true;
+                }
+            }
+            catch (...) {
+                report_error(error, "Not enough memory!");
+            }
+            // Every insertion may have invalidated the references into the same collection
+            for (std::size_t i = first; i != last; ++i) {
+                stl_txn_update_t& update = updates[i];
+                if (update.existing || update.is_new) {
+                    auto key_iterator = col.pairs.find(update.location.key);
+                    update.existing = key_iterator != col.pairs.end() ? &key_iterator->second : nullptr;
+                }
+            }
+        }
+    });
+    if ((*c_error = error.load()))
+        return;
 
-    // 5. Import the data, as no collisions were detected
-    for (auto& sub_key_and_value : txn.upserted) {
-        stl_col_t& col = stl_col(db, sub_key_and_value.first.col);
-        auto key_iterator = col.pairs.find(sub_key_and_value.first.key);
-        // A key was deleted:
-        // if (sub_key_and_value.second.empty()) {
-        //     if (key_iterator != col.pairs.end())
-        //         col.pairs.erase(key_iterator);
-        // }
-        // A keys was updated:
-        // else
-        if (key_iterator != col.pairs.end()) {
-            key_iterator->second.generation = txn.generation;
-            std::swap(key_iterator->second.buffer, sub_key_and_value.second);
+    // The horizon can't move until the updates are applied, so the versions to preserve are known now
+    std::shared_lock snapshots_lock {db.snapshots_mutex};
+    snapshots_horizon_t const horizon = snapshots_horizon(db);
+
+    // 5. Copy the values out of the transaction, compressing them, and allocate the nodes
+    // for the overwritten versions, in parallel. This is the last step, that can fail,
+    // so it must precede logging.
+    parallel_for_chunks(updates.size(), parallel_chunk_k, 0, [&](std::size_t begin, std::size_t end) noexcept {
+        buffer_t scratch;
+        for (std::size_t i = begin; i != end && !error.load(std::memory_order_relaxed); ++i) {
+            stl_txn_update_t& update = updates[i];
+            stl_col_t const& col = stl_col(db, update.location.col);
+            try {
+                if (update.existing && !update.is_new && update.existing->needs_preserving(horizon))
+                    update.older_version = std::make_unique<stl_value_t>();
+                if (!update.value)
+                    continue;
+                if (col.compression.enabled() && col.compression.compress(update.value, scratch, update.buffer))
+                    update.is_compressed = true;
+                else
+                    update.buffer.assign(update.value.begin(), update.value.end());
+            }
+            catch (...) {
+                report_error(error, "Not enough memory!");
+            }
         }
-        // A key was inserted:
-        else {
-            stl_value_t value_w_generation {std::move(sub_key_and_value.second), txn.generation};
-            col.pairs.emplace(sub_key_and_value.first.key, std::move(value_w_generation));
-            ++col.unique_elements;
+    });
+    if ((*c_error = error.load()))
+        return;
+    timer.lap(stats.validate_ns);
+
+    // 6. Log the updates, before applying them
+    std::size_t wal_sequence = 0;
+    if (!db.persisted_path.empty()) {
+        buffer_t record;
+        try {
+            for (stl_txn_update_t const& update : updates) {
+                stl_col_t const& col = stl_col(db, update.location.col);
+                if (update.value)
+                    wal_push_upsert(record, col, update.location.key, update.value);
+                else
+                    wal_push_remove(record, col, update.location.key);
+            }
+        }
+        catch (...) {
+            *c_error = "Not enough memory!";
+            return;
         }
+        wal_sequence = wal_append(db, record, c_error);
+        if (*c_error)
+            return;
     }
+    timer.lap(stats.log_ns);
 
-    // 6. Remove the requested entries
-    for (auto const& col_key : txn.removed) {
-        stl_col_t& col = stl_col(db, col_key.col);
-        auto key_iterator = col.pairs.find(col_key.key);
-        if (key_iterator == col.pairs.end())
+    // 7. Import the data, as no collisions were detected. Nothing here can fail.
+    // The updates are stamped with a new generation, instead of the one the
+    // transaction started with, so that older snapshots don't see them.
+    generation_t const commit_generation = ++db.youngest_generation;
+
+    // Record the changes, in the order of keys
+    for (stl_txn_update_t const& update : updates) {
+        stl_col_t& col = stl_col(db, update.location.col);
+        if (!col.changes.enabled())
             continue;
+        ukv_val_len_t length = update.value ? static_cast<ukv_val_len_t>(update.value.size()) : ukv_val_len_missing_k;
+        col.changes.push(update.location.key, commit_generation, length);
+    }
 
-        key_iterator->second.is_deleted = true;
-        key_iterator->second.generation = txn.generation;
-        key_iterator->second.buffer.clear();
+    // Overwrite and remove the existing entries, which are independent of each other
+    parallel_for_chunks(updates.size(), parallel_chunk_k, 0, [&](std::size_t begin, std::size_t end) noexcept {
+        for (std::size_t i = begin; i != end; ++i) {
+            stl_txn_update_t& update = updates[i];
+            if (!update.existing)
+                continue;
+            stl_value_t& existing = *update.existing;
+            stl_col_t& col = stl_col(db, update.location.col);
+            col.forget(existing);
+            if (!update.is_new)
+                existing.preserve(horizon, update.older_version);
+            existing.generation = commit_generation;
+            existing.is_deleted = !update.value;
+            if (update.value)
+                existing.swap(update.buffer, update.is_compressed);
+            else
+                existing.clear();
+            col.count(existing);
+        }
+    });
+    timer.lap(stats.apply_ns);
+
+    // Release the locks before waiting for the expensive IO
+    snapshots_lock.unlock();
+    cols_lock.unlock();
+    db_lock.unlock();
+    if (!*c_error && (c_options & ukv_option_write_flush_k)) {
+        wal_sync(db, wal_sequence, c_error);
+        timer.lap(stats.sync_ns);
     }
+}
 
-    // TODO: Degrade the lock to "shared" state before starting expensive IO
-    if (c_options & ukv_option_write_flush_k)
-        save_to_disk(db, c_error);
+void ukv_txn_commit( //
+    ukv_txn_t const c_txn,
+    ukv_options_t const c_options,
+    ukv_error_t* c_error) {
+
+    if (!c_txn && (*c_error = "Transaction is NULL!"))
+        return;
+
+    stl_txn_t& txn = *reinterpret_cast<stl_txn_t*>(c_txn);
+    if (!txn.db_ptr && (*c_error = "Transaction wasn't started!"))
+        return;
+
+    {
+        metrics_scope_t metrics {txn.db_ptr->metrics, metric_op_t::txn_commit_k, ukv_col_main_k, 1, c_error};
+        ukv_col_t col = txn.log.empty() ? ukv_col_main_k : txn.log.begin()->location.col;
+        numa_scope_t numa = numa_scope(*txn.db_ptr, col);
+        commit_txn(txn, c_options, c_error);
+    }
+    txn.is_committed = !*c_error;
+    stl_commit_stats_t& stats = txn.db_ptr->commit_stats;
+    ++stats.commits;
+    if (*c_error)
+        ++stats.failures;
 }
 
 /*********************************************************/
@@ -1214,16 +2848,19 @@ void ukv_txn_commit( //
 /*********************************************************/
 
 void ukv_arena_free(ukv_t const, ukv_arena_t c_arena) {
-    if (!c_arena)
-        return;
-    stl_arena_t& arena = *reinterpret_cast<stl_arena_t*>(c_arena);
-    delete &arena;
+    release_arena(c_arena);
+}
+
+ukv_size_t ukv_arena_allocations(ukv_t const, ukv_arena_t const c_arena) {
+    return arena_allocations(c_arena);
 }
 
 void ukv_txn_free(ukv_t const, ukv_txn_t const c_txn) {
     if (!c_txn)
         return;
     stl_txn_t& txn = *reinterpret_cast<stl_txn_t*>(c_txn);
+    count_abort(txn);
+    release_snapshot(txn);
     delete &txn;
 }
 
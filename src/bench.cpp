@@ -0,0 +1,436 @@
+/**
+ * @file bench.cpp
+ * @author Ashot Vardanian
+ * @date 2022-08-16
+ *
+ * @brief A set of micro-benchmarks implemented using Google Benchmark.
+ * The same suite is linked against every backend, like `test.cpp`,
+ * producing `ukv_bench`, `ukv_leveldb_bench` and `ukv_rocksdb_bench`.
+ *
+ * Covers batched point reads and writes of different value lengths, scans,
+ * transactional contention between threads, columns gathered from documents,
+ * graph upserts and traversals. All the keys are generated from fixed seeds,
+ * so runs are comparable between releases. Every modality lives in its own
+ * range of keys of the main collection, as some backends lack named collections.
+ *
+ * To feed the results into CI:
+ *      ./ukv_bench --benchmark_out=ukv_stl.json --benchmark_out_format=json
+ * Non-Benchmark arguments are forwarded to `ukv_db_open`, so the RocksDB or
+ * LevelDB instance can be pointed at a different path:
+ *      ./ukv_rocksdb_bench --ukv_config=/mnt/nvme/rocksdb/
+ */
+
+#include <algorithm> // `std::shuffle`
+#include <cstdio>    // `std::fprintf`
+#include <cstring>   // `std::strncmp`
+#include <random>    // `std::mt19937_64`
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "ukv/ukv.hpp"
+
+#ifndef UKV_BENCH_BACKEND
+#define UKV_BENCH_BACKEND "stl"
+#endif
+
+using namespace unum::ukv;
+using namespace unum;
+
+static constexpr ukv_size_t points_k = 1u << 14;
+static constexpr ukv_size_t docs_k = 1u << 14;
+static constexpr ukv_size_t vertices_k = 1u << 12;
+static constexpr ukv_size_t vertex_degree_k = 8;
+static constexpr ukv_size_t hot_keys_k = 16;
+static constexpr std::uint64_t seed_k = 42;
+
+static constexpr ukv_key_t docs_offset_k = ukv_key_t(1) << 32;
+static constexpr ukv_key_t vertices_offset_k = ukv_key_t(2) << 32;
+static constexpr ukv_key_t upserts_offset_k = ukv_key_t(3) << 32;
+static constexpr ukv_key_t hot_offset_k = ukv_key_t(4) << 32;
+
+static db_t db;
+static ukv_col_t const main_col = ukv_col_main_k;
+
+/**
+ * @brief Reports a failed operation and stops the benchmark.
+ * @return true, if the benchmark must leave the loop.
+ */
+static bool failed(benchmark::State& state, status_t& status) {
+    if (status)
+        return false;
+    state.SkipWithError(*status.member_ptr());
+    status = status_t {};
+    return true;
+}
+
+/**
+ * @brief Permutation of `count` keys starting from `offset`.
+ * Batches are taken from it in order, so every key is visited once per cycle.
+ */
+static std::vector<ukv_key_t> shuffled_keys(ukv_size_t count, ukv_key_t offset = 0) {
+    std::vector<ukv_key_t> keys(count);
+    for (ukv_size_t i = 0; i != count; ++i)
+        keys[i] = offset + static_cast<ukv_key_t>(i);
+    std::mt19937_64 generator(seed_k);
+    std::shuffle(keys.begin(), keys.end(), generator);
+    return keys;
+}
+
+/**
+ * @brief Makes sure every key in `[0, points_k)` holds a value of `length` bytes.
+ * Repeated calls with the same length do nothing.
+ */
+static status_t fill_points(ukv_val_len_t length) {
+    static ukv_val_len_t filled_length = ukv_val_len_missing_k;
+    status_t status;
+    if (filled_length == length)
+        return status;
+
+    constexpr ukv_size_t batch_k = 1024;
+    std::vector<ukv_key_t> keys(batch_k);
+    std::string value(length, '*');
+    auto value_ptr = reinterpret_cast<ukv_val_ptr_t>(value.data());
+    arena_t arena(db);
+    for (ukv_size_t first = 0; first < points_k && status; first += batch_k) {
+        for (ukv_size_t i = 0; i != batch_k; ++i)
+            keys[i] = static_cast<ukv_key_t>(first + i);
+        ukv_write(db, nullptr, batch_k, nullptr, 0, keys.data(), sizeof(ukv_key_t), //
+                  &value_ptr, 0, nullptr, 0, &length, 0, ukv_options_default_k, arena, status.member_ptr());
+    }
+    if (status)
+        filled_length = length;
+    return status;
+}
+
+static void point_write(benchmark::State& state) {
+    auto batch = static_cast<ukv_size_t>(state.range(0));
+    auto length = static_cast<ukv_val_len_t>(state.range(1));
+    std::vector<ukv_key_t> keys = shuffled_keys(points_k);
+    std::string value(length, '#');
+    auto value_ptr = reinterpret_cast<ukv_val_ptr_t>(value.data());
+    arena_t arena(db);
+    status_t status;
+
+    ukv_size_t offset = 0;
+    for (auto _ : state) {
+        ukv_write(db, nullptr, batch, nullptr, 0, keys.data() + offset, sizeof(ukv_key_t), //
+                  &value_ptr, 0, nullptr, 0, &length, 0, ukv_options_default_k, arena, status.member_ptr());
+        if (failed(state, status))
+            break;
+        offset = (offset + batch) % points_k;
+    }
+
+    // The keyspace now holds values of this length
+    status = fill_points(length);
+    state.SetItemsProcessed(state.iterations() * batch);
+    state.SetBytesProcessed(state.iterations() * batch * length);
+}
+
+static void point_read(benchmark::State& state) {
+    auto batch = static_cast<ukv_size_t>(state.range(0));
+    auto length = static_cast<ukv_val_len_t>(state.range(1));
+    status_t status = fill_points(length);
+    if (failed(state, status))
+        return;
+
+    std::vector<ukv_key_t> keys = shuffled_keys(points_k);
+    arena_t arena(db);
+    ukv_val_ptr_t found_values = nullptr;
+    ukv_val_len_t* found_offsets = nullptr;
+    ukv_val_len_t* found_lengths = nullptr;
+
+    ukv_size_t offset = 0;
+    for (auto _ : state) {
+        ukv_read(db, nullptr, batch, nullptr, 0, keys.data() + offset, sizeof(ukv_key_t), ukv_options_default_k, //
+                 &found_values, &found_offsets, &found_lengths, arena, status.member_ptr());
+        if (failed(state, status))
+            break;
+        benchmark::DoNotOptimize(found_values);
+        offset = (offset + batch) % points_k;
+    }
+
+    state.SetItemsProcessed(state.iterations() * batch);
+    state.SetBytesProcessed(state.iterations() * batch * length);
+}
+
+static void scan(benchmark::State& state) {
+    auto length = static_cast<ukv_size_t>(state.range(0));
+    status_t status = fill_points(8);
+    if (failed(state, status))
+        return;
+
+    std::vector<ukv_key_t> starts = shuffled_keys(points_k - length);
+    arena_t arena(db);
+    ukv_key_t* found_keys = nullptr;
+    ukv_val_len_t* found_lengths = nullptr;
+
+    ukv_size_t offset = 0;
+    for (auto _ : state) {
+        ukv_scan(db, nullptr, 1, nullptr, 0, starts.data() + offset, 0, &length, 0, ukv_options_default_k, //
+                 &found_keys, &found_lengths, arena, status.member_ptr());
+        if (failed(state, status))
+            break;
+        benchmark::DoNotOptimize(found_keys);
+        offset = (offset + 1) % starts.size();
+    }
+
+    state.SetItemsProcessed(state.iterations() * length);
+}
+
+/**
+ * @brief Every transaction reads and overwrites two of the few "hot" keys.
+ * The more threads are involved, the more commits fail, which is reported
+ * as the share of "conflicts" among all the attempted transactions.
+ */
+static void txn_contention(benchmark::State& state) {
+    std::mt19937_64 generator(seed_k + state.thread_index());
+    std::uniform_int_distribution<ukv_key_t> choose(hot_offset_k, hot_offset_k + hot_keys_k - 1);
+    ukv_key_t keys[2];
+    std::uint64_t value = 0;
+    auto value_ptr = reinterpret_cast<ukv_val_ptr_t>(&value);
+    ukv_val_len_t length = sizeof(value);
+    ukv_txn_t txn = nullptr;
+    arena_t arena(db);
+    ukv_val_ptr_t found_values = nullptr;
+    ukv_val_len_t* found_offsets = nullptr;
+    ukv_val_len_t* found_lengths = nullptr;
+    status_t status;
+
+    std::size_t conflicts = 0;
+    for (auto _ : state) {
+        keys[0] = choose(generator);
+        keys[1] = choose(generator);
+        ++value;
+
+        ukv_txn_begin(db, 0, ukv_options_default_k, &txn, status.member_ptr());
+        if (failed(state, status))
+            break;
+
+        // Both the tracked reads and the commit fail, if the keys were overwritten by others
+        ukv_read(db, txn, 2, nullptr, 0, keys, sizeof(ukv_key_t), ukv_option_read_track_k, //
+                 &found_values, &found_offsets, &found_lengths, arena, status.member_ptr());
+        if (status) {
+            ukv_write(db, txn, 2, nullptr, 0, keys, sizeof(ukv_key_t), //
+                      &value_ptr, 0, nullptr, 0, &length, 0, ukv_options_default_k, arena, status.member_ptr());
+            if (failed(state, status))
+                break;
+            ukv_txn_commit(txn, ukv_options_default_k, status.member_ptr());
+        }
+        if (!status) {
+            status = status_t {};
+            ++conflicts;
+        }
+    }
+
+    ukv_txn_free(db, txn);
+    state.SetItemsProcessed(state.iterations());
+    state.counters["conflicts"] =
+        benchmark::Counter(static_cast<double>(conflicts), benchmark::Counter::kAvgIterations);
+}
+
+static status_t fill_docs() {
+    static bool filled = false;
+    status_t status;
+    if (filled)
+        return status;
+
+    constexpr ukv_size_t batch_k = 1024;
+    std::vector<ukv_key_t> keys(batch_k);
+    std::vector<ukv_val_len_t> offsets(batch_k + 1);
+    std::string tape;
+    arena_t arena(db);
+    for (ukv_size_t first = 0; first < docs_k && status; first += batch_k) {
+        tape.clear();
+        for (ukv_size_t i = 0; i != batch_k; ++i) {
+            auto id = first + i;
+            keys[i] = docs_offset_k + static_cast<ukv_key_t>(id);
+            offsets[i] = static_cast<ukv_val_len_t>(tape.size());
+            tape += "{\"age\":" + std::to_string(id % 100) + ",\"score\":" + std::to_string(id * 0.5) +
+                    ",\"name\":\"user-" + std::to_string(id) + "\"}";
+        }
+        offsets[batch_k] = static_cast<ukv_val_len_t>(tape.size());
+
+        std::vector<ukv_val_len_t> lengths(batch_k);
+        for (ukv_size_t i = 0; i != batch_k; ++i)
+            lengths[i] = offsets[i + 1] - offsets[i];
+        auto tape_ptr = reinterpret_cast<ukv_val_ptr_t>(tape.data());
+        ukv_docs_write(db, nullptr, batch_k, &main_col, 0, keys.data(), sizeof(ukv_key_t), nullptr, 0, //
+                       ukv_options_default_k, ukv_format_json_k, ukv_type_any_k,
+                       &tape_ptr, 0, offsets.data(), sizeof(ukv_val_len_t), lengths.data(), sizeof(ukv_val_len_t),
+                       arena, status.member_ptr());
+    }
+    filled = status;
+    return status;
+}
+
+static void docs_gather(benchmark::State& state) {
+    auto batch = static_cast<ukv_size_t>(state.range(0));
+    status_t status = fill_docs();
+    if (failed(state, status))
+        return;
+
+    ukv_str_view_t fields[3] {"age", "score", "name"};
+    ukv_type_t types[3] {ukv_type_u32_k, ukv_type_f64_k, ukv_type_str_k};
+    std::vector<ukv_key_t> keys = shuffled_keys(docs_k, docs_offset_k);
+    arena_t arena(db);
+    ukv_1x8_t** validities = nullptr;
+    ukv_1x8_t** conversions = nullptr;
+    ukv_1x8_t** collisions = nullptr;
+    ukv_val_ptr_t* scalars = nullptr;
+    ukv_val_len_t** offsets = nullptr;
+    ukv_val_len_t** lengths = nullptr;
+    ukv_val_ptr_t strings = nullptr;
+
+    ukv_size_t offset = 0;
+    for (auto _ : state) {
+        ukv_docs_gather(db, nullptr, batch, 3, &main_col, 0, keys.data() + offset, sizeof(ukv_key_t), //
+                        fields, sizeof(ukv_str_view_t), types, sizeof(ukv_type_t), ukv_options_default_k,
+                        &validities, &conversions, &collisions, &scalars, &offsets, &lengths, &strings,
+                        arena, status.member_ptr());
+        if (failed(state, status))
+            break;
+        benchmark::DoNotOptimize(scalars);
+        offset = (offset + batch) % docs_k;
+    }
+
+    state.SetItemsProcessed(state.iterations() * batch);
+}
+
+static void graph_upsert(benchmark::State& state) {
+    auto batch = static_cast<ukv_size_t>(state.range(0));
+    std::mt19937_64 generator(seed_k);
+    std::uniform_int_distribution<ukv_key_t> choose(upserts_offset_k, upserts_offset_k + vertices_k - 1);
+    std::vector<ukv_key_t> sources(batch), targets(batch), ids(batch);
+    arena_t arena(db);
+    status_t status;
+
+    ukv_key_t next_id = 0;
+    for (auto _ : state) {
+        for (ukv_size_t i = 0; i != batch; ++i)
+            sources[i] = choose(generator), targets[i] = choose(generator), ids[i] = next_id++;
+
+        ukv_graph_upsert_edges(db, nullptr, batch, &main_col, 0, ids.data(), sizeof(ukv_key_t), //
+                               sources.data(), sizeof(ukv_key_t), targets.data(), sizeof(ukv_key_t),
+                               ukv_options_default_k, arena, status.member_ptr());
+        if (failed(state, status))
+            break;
+    }
+
+    state.SetItemsProcessed(state.iterations() * batch);
+}
+
+/**
+ * @brief Builds a random graph with a fixed out-degree for traversals.
+ */
+static status_t fill_graph() {
+    static bool filled = false;
+    status_t status;
+    if (filled)
+        return status;
+
+    std::mt19937_64 generator(seed_k);
+    std::uniform_int_distribution<ukv_key_t> choose(vertices_offset_k, vertices_offset_k + vertices_k - 1);
+    std::vector<ukv_key_t> sources(vertices_k), targets(vertices_k);
+    arena_t arena(db);
+    for (ukv_size_t round = 0; round != vertex_degree_k && status; ++round) {
+        for (ukv_size_t i = 0; i != vertices_k; ++i)
+            sources[i] = vertices_offset_k + static_cast<ukv_key_t>(i), targets[i] = choose(generator);
+        ukv_graph_upsert_edges(db, nullptr, vertices_k, &main_col, 0, &ukv_default_edge_id_k, 0, //
+                               sources.data(), sizeof(ukv_key_t), targets.data(), sizeof(ukv_key_t),
+                               ukv_options_default_k, arena, status.member_ptr());
+    }
+    filled = status;
+    return status;
+}
+
+static void graph_find_edges(benchmark::State& state) {
+    auto batch = static_cast<ukv_size_t>(state.range(0));
+    status_t status = fill_graph();
+    if (failed(state, status))
+        return;
+
+    std::vector<ukv_key_t> vertices = shuffled_keys(vertices_k, vertices_offset_k);
+    ukv_vertex_role_t role = ukv_vertex_source_k;
+    arena_t arena(db);
+    ukv_vertex_degree_t* degrees = nullptr;
+    ukv_key_t* edges = nullptr;
+
+    ukv_size_t offset = 0;
+    for (auto _ : state) {
+        ukv_graph_find_edges(db, nullptr, batch, &main_col, 0, vertices.data() + offset, sizeof(ukv_key_t), //
+                             &role, 0, ukv_options_default_k, &degrees, &edges, arena, status.member_ptr());
+        if (failed(state, status))
+            break;
+        benchmark::DoNotOptimize(edges);
+        offset = (offset + batch) % vertices_k;
+    }
+
+    state.SetItemsProcessed(state.iterations() * batch);
+}
+
+static void graph_traverse(benchmark::State& state) {
+    auto depth = static_cast<ukv_size_t>(state.range(0));
+    status_t status = fill_graph();
+    if (failed(state, status))
+        return;
+
+    std::vector<ukv_key_t> starts = shuffled_keys(vertices_k, vertices_offset_k);
+    arena_t arena(db);
+    ukv_size_t count = 0;
+    ukv_key_t* vertices = nullptr;
+    ukv_size_t* depths = nullptr;
+    ukv_key_t* edges = nullptr;
+
+    ukv_size_t offset = 0;
+    std::size_t visited = 0;
+    for (auto _ : state) {
+        ukv_graph_traverse(db, nullptr, ukv_col_main_k, 1, starts.data() + offset, 0, ukv_vertex_source_k, //
+                           depth, vertices_k, ukv_options_default_k,
+                           &count, &vertices, &depths, &edges, arena, status.member_ptr());
+        if (failed(state, status))
+            break;
+        visited += count;
+        offset = (offset + 1) % vertices_k;
+    }
+
+    state.SetItemsProcessed(static_cast<std::int64_t>(visited));
+}
+
+BENCHMARK(point_write)->ArgsProduct({{1, 16, 256}, {8, 256, 4096}})->ArgNames({"batch", "length"});
+BENCHMARK(point_read)->ArgsProduct({{1, 16, 256}, {8, 256, 4096}})->ArgNames({"batch", "length"});
+BENCHMARK(scan)->Arg(16)->Arg(1024)->ArgName("length");
+BENCHMARK(txn_contention)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(docs_gather)->Arg(16)->Arg(256)->Arg(4096)->ArgName("batch");
+BENCHMARK(graph_upsert)->Arg(1)->Arg(256)->ArgName("batch");
+BENCHMARK(graph_find_edges)->Arg(1)->Arg(256)->ArgName("batch");
+BENCHMARK(graph_traverse)->Arg(1)->Arg(2)->Arg(3)->ArgName("depth");
+
+int main(int argc, char** argv) {
+    benchmark::Initialize(&argc, argv);
+
+    std::string config;
+    constexpr char config_flag_k[] = "--ukv_config=";
+    for (int i = 1; i < argc; ++i) {
+        if (std::strncmp(argv[i], config_flag_k, sizeof(config_flag_k) - 1) == 0)
+            config = argv[i] + sizeof(config_flag_k) - 1;
+        else {
+            std::fprintf(stderr, "Unrecognized argument: %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    status_t status = db.open(config);
+    if (!status) {
+        std::fprintf(stderr, "Failed to open the DB: %s\n", *status.member_ptr());
+        return 1;
+    }
+
+    benchmark::AddCustomContext("ukv_backend", UKV_BENCH_BACKEND);
+    benchmark::AddCustomContext("ukv_config", config);
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    db.close();
+    return 0;
+}
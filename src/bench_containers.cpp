@@ -0,0 +1,108 @@
+/**
+ * @file bench_containers.cpp
+ * @author Ashot Vardanian
+ * @date 2022-08-30
+ *
+ * @brief Compares the `sorted_blocks_gt` of the STL backend with `std::map`.
+ * Inserts, looks up and scans millions of random 64-bit keys, mapped to
+ * values of the size of a typical entry, in the same order for both containers.
+ *
+ *      ./ukv_containers_bench --benchmark_filter=10000000
+ */
+
+#include <algorithm> // `std::shuffle`
+#include <array>
+#include <map>
+#include <random> // `std::mt19937_64`
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "ukv/db.h"
+#include "sorted_blocks.hpp"
+
+using namespace unum::ukv;
+
+static constexpr std::uint64_t seed_k = 42;
+
+/// Roughly the size of the entries of the STL backend, without the heap-allocated parts.
+using value_t = std::array<std::uint64_t, 6>;
+using map_t = std::map<ukv_key_t, value_t>;
+using blocks_t = sorted_blocks_gt<ukv_key_t, value_t>;
+
+static std::vector<ukv_key_t> const& random_keys(std::size_t count) {
+    static std::vector<ukv_key_t> keys;
+    if (keys.size() != count) {
+        std::mt19937_64 generator(seed_k);
+        keys.resize(count);
+        for (auto& key : keys)
+            key = static_cast<ukv_key_t>(generator() >> 1);
+    }
+    return keys;
+}
+
+/// Lookups come in a different order, than insertions did.
+static std::vector<ukv_key_t> shuffled(std::vector<ukv_key_t> keys) {
+    std::mt19937_64 generator(seed_k + 1);
+    std::shuffle(keys.begin(), keys.end(), generator);
+    return keys;
+}
+
+template <typename container_at>
+static void fill(container_at& container, std::vector<ukv_key_t> const& keys) {
+    for (ukv_key_t key : keys)
+        container.emplace(key, value_t {static_cast<std::uint64_t>(key)});
+}
+
+template <typename container_at>
+static void insert(benchmark::State& state) {
+    auto const& keys = random_keys(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        container_at container;
+        fill(container, keys);
+        benchmark::DoNotOptimize(container.size());
+        // Exclude the deallocation from the measurement
+        state.PauseTiming();
+        container.clear();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * keys.size());
+}
+
+template <typename container_at>
+static void find(benchmark::State& state) {
+    auto const& keys = random_keys(static_cast<std::size_t>(state.range(0)));
+    container_at container;
+    fill(container, keys);
+    auto const lookups = shuffled(keys);
+    for (auto _ : state) {
+        std::uint64_t checksum = 0;
+        for (ukv_key_t key : lookups)
+            checksum += container.find(key)->second[0];
+        benchmark::DoNotOptimize(checksum);
+    }
+    state.SetItemsProcessed(state.iterations() * lookups.size());
+}
+
+template <typename container_at>
+static void scan(benchmark::State& state) {
+    auto const& keys = random_keys(static_cast<std::size_t>(state.range(0)));
+    container_at container;
+    fill(container, keys);
+    for (auto _ : state) {
+        std::uint64_t checksum = 0;
+        for (auto const& [key, value] : container)
+            checksum += value[0];
+        benchmark::DoNotOptimize(checksum);
+    }
+    state.SetItemsProcessed(state.iterations() * container.size());
+}
+
+BENCHMARK_TEMPLATE(insert, map_t)->Arg(1'000'000)->Arg(10'000'000)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(insert, blocks_t)->Arg(1'000'000)->Arg(10'000'000)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(find, map_t)->Arg(1'000'000)->Arg(10'000'000)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(find, blocks_t)->Arg(1'000'000)->Arg(10'000'000)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(scan, map_t)->Arg(1'000'000)->Arg(10'000'000)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(scan, blocks_t)->Arg(1'000'000)->Arg(10'000'000)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
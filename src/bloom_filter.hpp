@@ -0,0 +1,111 @@
+/**
+ * @file bloom_filter.hpp
+ * @author Ashot Vardanian
+ *
+ * @brief Blocked Bloom filter for integer keys.
+ * Every key maps to a single cache line, and all of its bits live in it,
+ * so negative lookups cost one cache miss, instead of a search in a tree.
+ * The price is a slightly higher false positive rate, than of a classical
+ * Bloom filter with the same number of bits.
+ */
+#pragma once
+#include <cstdint>   // `std::uint64_t`
+#include <vector>    // `std::vector`
+#include <algorithm> // `std::max`
+
+namespace unum::ukv {
+
+class blocked_bloom_t {
+    /// A single cache line of bits.
+    struct alignas(64) block_t {
+        std::uint64_t words[8] {};
+    };
+
+    std::vector<block_t> blocks_;
+    std::size_t bits_per_key_ = 0;
+    std::size_t hashes_ = 0;
+    /// Number of keys, the filter was sized for.
+    std::size_t capacity_ = 0;
+    std::size_t count_ = 0;
+
+    static std::uint64_t mix(std::uint64_t x) noexcept {
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdull;
+        x ^= x >> 33;
+        x *= 0xc4ceb9fe1a85ec53ull;
+        x ^= x >> 33;
+        return x;
+    }
+
+    /// Maps the @p hash into `[0, blocks_.size())` with a multiplication, instead of a division.
+    std::size_t block_index(std::uint64_t hash) const noexcept {
+        return static_cast<std::size_t>((static_cast<unsigned __int128>(hash) * blocks_.size()) >> 64);
+    }
+
+    /**
+     * @brief Calls @p callback with the word and the bit of every hash.
+     * Each takes 9 bits: 3 to pick a word in the block, and 6 to pick a bit in it.
+     */
+    template <typename callback_at>
+    void for_each_bit(std::uint64_t hash, callback_at&& callback) const noexcept {
+        std::uint64_t bits = mix(hash ^ 0x9e3779b97f4a7c15ull);
+        for (std::size_t i = 0, left = 7; i != hashes_; ++i, --left, bits >>= 9) {
+            if (!left)
+                bits = mix(bits ^ hash), left = 7;
+            callback((bits >> 6) & 7, std::uint64_t(1) << (bits & 63));
+        }
+    }
+
+  public:
+    /// Disabled filters report every key as possibly present.
+    bool enabled() const noexcept { return bits_per_key_; }
+    std::size_t bits_per_key() const noexcept { return bits_per_key_; }
+    /// Past its capacity the false positive rate degrades, and the filter must be rebuilt bigger.
+    bool overflown() const noexcept { return count_ > capacity_; }
+
+    /**
+     * @brief Drops all the keys and sizes the filter for, at least, @p keys entries.
+     * @param bits_per_key Zero disables the filter and releases the memory.
+     */
+    void reset(std::size_t bits_per_key, std::size_t keys) {
+        if (!bits_per_key) {
+            blocks_ = {};
+            bits_per_key_ = capacity_ = hashes_ = count_ = 0;
+            return;
+        }
+
+        // Allocate first, to remain intact on failure
+        constexpr std::size_t min_capacity_k = 1024;
+        std::size_t capacity = std::max(keys, min_capacity_k);
+        std::vector<block_t> blocks((capacity * bits_per_key + 511) / 512);
+        blocks_ = std::move(blocks);
+        bits_per_key_ = bits_per_key;
+        capacity_ = capacity;
+        count_ = 0;
+        // The optimal number of hashes is `ln(2)` times the number of bits per key
+        hashes_ = std::max<std::size_t>(1, bits_per_key_ * 69 / 100);
+    }
+
+    void insert(std::uint64_t key) noexcept {
+        if (!bits_per_key_)
+            return;
+        std::uint64_t hash = mix(key);
+        block_t& target = blocks_[block_index(hash)];
+        for_each_bit(hash, [&](std::size_t word, std::uint64_t mask) noexcept { target.words[word] |= mask; });
+        ++count_;
+    }
+
+    bool may_contain(std::uint64_t key) const noexcept {
+        if (!bits_per_key_)
+            return true;
+        std::uint64_t hash = mix(key);
+        block_t const& target = blocks_[block_index(hash)];
+        bool found = true;
+        for_each_bit(hash, [&](std::size_t word, std::uint64_t mask) noexcept {
+            found &= (target.words[word] & mask) != 0;
+        });
+        return found;
+    }
+};
+
+} // namespace unum::ukv
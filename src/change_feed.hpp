@@ -0,0 +1,141 @@
+/**
+ * @file change_feed.hpp
+ * @author Ashot Vardanian
+ *
+ * @brief Bounded history of the changes of a single collection, @see `ukv_changes_since`.
+ * Every entry is a key, the generation of its update, and the new length of the value,
+ * so followers can catch up by re-reading just the changed keys. The ring grows lazily,
+ * up to its capacity, and then evicts the oldest entries, remembering the generation,
+ * before which the history is incomplete.
+ */
+#pragma once
+#include <vector>    // `std::vector`
+#include <algorithm> // `std::max`
+
+#include "ukv/db.h"
+
+namespace unum::ukv {
+
+class change_feed_t {
+  public:
+    struct change_t {
+        ukv_key_t key;
+        ukv_size_t generation;
+        /// Equal to `ukv_val_len_missing_k` for removals.
+        ukv_val_len_t length;
+    };
+
+  private:
+    std::vector<change_t> ring_;
+    std::size_t capacity_ = 0;
+    /// Index of the oldest change in the `ring_`.
+    std::size_t first_ = 0;
+    std::size_t count_ = 0;
+    /// Changes up to this generation, inclusive, may be missing from the `ring_`.
+    ukv_size_t truncated_ = 0;
+
+    change_t const& at(std::size_t i) const noexcept { return ring_[(first_ + i) % ring_.size()]; }
+
+    /// Doubles the `ring_`, unrolling it, so that the oldest change comes first.
+    bool grow() noexcept {
+        if (ring_.size() >= capacity_)
+            return false;
+        try {
+            std::vector<change_t> ring;
+            ring.reserve(std::min(capacity_, std::max<std::size_t>(64, ring_.size() * 2)));
+            for (std::size_t i = 0; i != count_; ++i)
+                ring.push_back(at(i));
+            ring.resize(ring.capacity());
+            ring_ = std::move(ring);
+            first_ = 0;
+            return true;
+        }
+        catch (...) {
+            return false;
+        }
+    }
+
+  public:
+    bool enabled() const noexcept { return capacity_; }
+    std::size_t capacity() const noexcept { return capacity_; }
+    ukv_size_t truncated() const noexcept { return truncated_; }
+    /// Generation of the most recent change, that is still kept.
+    ukv_size_t newest() const noexcept { return count_ ? at(count_ - 1).generation : truncated_; }
+
+    /**
+     * @brief Drops the history and limits the future one to @p capacity changes, zero disabling it.
+     * Nothing is known about the changes up to the @p youngest generation, inclusive.
+     */
+    void reset(std::size_t capacity, ukv_size_t youngest) noexcept {
+        ring_ = {};
+        capacity_ = capacity;
+        first_ = count_ = 0;
+        truncated_ = youngest;
+    }
+
+    /// Forgets the history, after the collection changed in a way, that can't be described per key.
+    void truncate(ukv_size_t generation) noexcept {
+        first_ = count_ = 0;
+        truncated_ = std::max(truncated_, generation);
+    }
+
+    /// Must be called in the order of generations, evicting the oldest change, if the ring is full.
+    void push(ukv_key_t key, ukv_size_t generation, ukv_val_len_t length) noexcept {
+        if (!capacity_)
+            return;
+        if (count_ == ring_.size() && !grow()) {
+            if (!count_) {
+                truncated_ = std::max(truncated_, generation);
+                return;
+            }
+            truncated_ = std::max(truncated_, at(0).generation);
+            first_ = (first_ + 1) % ring_.size();
+            --count_;
+        }
+        ring_[(first_ + count_) % ring_.size()] = {key, generation, length};
+        ++count_;
+    }
+
+    /**
+     * @brief Passes to @p callback the oldest changes with generations above @p since.
+     * Stops after @p limit changes, but never splits the changes of one generation,
+     * so a single big transaction may exceed the limit.
+     * @return false, if some of those changes were already evicted.
+     */
+    template <typename callback_at>
+    bool for_each_since(ukv_size_t since, std::size_t limit, callback_at&& callback) const {
+        if (since < truncated_)
+            return false;
+
+        // Binary search for the first change past @p since
+        std::size_t begin = 0, end = count_;
+        while (begin != end) {
+            std::size_t middle = begin + (end - begin) / 2;
+            if (at(middle).generation <= since)
+                begin = middle + 1;
+            else
+                end = middle;
+        }
+
+        end = begin + std::min(limit, count_ - begin);
+        if (end != begin && end != count_) {
+            ukv_size_t const last = at(end - 1).generation;
+            if (at(end).generation == last) {
+                std::size_t cut = end;
+                while (cut != begin && at(cut - 1).generation == last)
+                    --cut;
+                if (cut != begin)
+                    end = cut;
+                else
+                    while (end != count_ && at(end).generation == last)
+                        ++end;
+            }
+        }
+
+        for (std::size_t i = begin; i != end; ++i)
+            callback(at(i));
+        return true;
+    }
+};
+
+} // namespace unum::ukv
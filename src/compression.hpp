@@ -0,0 +1,106 @@
+/**
+ * @file compression.hpp
+ * @author Ashot Vardanian
+ *
+ * @brief Transparent compression of individual values with @b LZ4.
+ * Every compressed value is prefixed with its original length, so that
+ * lengths can be reported without decompressing anything. Small values
+ * rarely shrink on their own, but do, if primed with a shared dictionary
+ * of patterns, common across the collection.
+ */
+#pragma once
+#include <cstring>     // `std::memcpy`
+#include <string>      // `std::string`
+#include <string_view> // `std::string_view`
+
+#include <lz4.h>
+
+#include "helpers.hpp"
+
+namespace unum::ukv {
+
+class compression_t {
+    bool enabled_ = false;
+    std::string dictionary_;
+    /// Hash tables of the loaded dictionary, copied before compressing every value.
+    LZ4_stream_t dictionary_stream_;
+
+  public:
+    static constexpr std::size_t header_length_k = sizeof(ukv_val_len_t);
+    /// Shorter values are kept as is, unless a dictionary is used.
+    static constexpr std::size_t min_length_k = 32;
+
+    compression_t() noexcept { LZ4_initStream(&dictionary_stream_, sizeof(dictionary_stream_)); }
+    compression_t(compression_t const&) = delete;
+    compression_t& operator=(compression_t const&) = delete;
+
+    bool enabled() const noexcept { return enabled_; }
+    std::string const& dictionary() const noexcept { return dictionary_; }
+
+    /**
+     * @brief Enables compression, optionally primed with a @p dictionary.
+     * LZ4 only uses the last 64 KB of it, so frequent patterns should go last.
+     */
+    void enable(std::string_view dictionary) {
+        dictionary_ = dictionary;
+        LZ4_loadDict(&dictionary_stream_, dictionary_.data(), static_cast<int>(dictionary_.size()));
+        enabled_ = true;
+    }
+
+    /**
+     * @brief Compresses the @p value into @p output, prefixed with the original length.
+     * The @p scratch space is reused between calls, and the @p output is exactly sized.
+     * @return false, if the value was too short or incompressible, and @p output is intact.
+     */
+    bool compress(value_view_t value, buffer_t& scratch, buffer_t& output) const {
+        std::size_t const min_length = dictionary_.empty() ? min_length_k : header_length_k + 1;
+        if (!enabled_ || value.size() < min_length || value.size() > LZ4_MAX_INPUT_SIZE)
+            return false;
+
+        auto const length = static_cast<int>(value.size());
+        auto const capacity = LZ4_compressBound(length);
+        scratch.resize(header_length_k + capacity);
+        auto source = reinterpret_cast<char const*>(value.begin());
+        auto target = reinterpret_cast<char*>(scratch.data() + header_length_k);
+        int compressed = 0;
+        if (dictionary_.empty())
+            compressed = LZ4_compress_default(source, target, length, capacity);
+        else {
+            LZ4_stream_t stream = dictionary_stream_;
+            compressed = LZ4_compress_fast_continue(&stream, source, target, length, capacity, 1);
+        }
+        if (compressed <= 0 || header_length_k + compressed >= value.size())
+            return false;
+
+        auto original_length = static_cast<ukv_val_len_t>(value.size());
+        std::memcpy(scratch.data(), &original_length, header_length_k);
+        output.assign(scratch.begin(), scratch.begin() + header_length_k + compressed);
+        return true;
+    }
+
+    /// The original length of a value, produced by `compress`.
+    static ukv_val_len_t length(value_view_t compressed) noexcept {
+        ukv_val_len_t original_length = 0;
+        std::memcpy(&original_length, compressed.begin(), header_length_k);
+        return original_length;
+    }
+
+    /// Unpacks the value produced by `compress` into @p output, which must fit its `length`.
+    bool decompress(value_view_t compressed, byte_t* output) const noexcept {
+        auto const original_length = static_cast<int>(length(compressed));
+        auto source = reinterpret_cast<char const*>(compressed.begin() + header_length_k);
+        auto source_length = static_cast<int>(compressed.size() - header_length_k);
+        auto target = reinterpret_cast<char*>(output);
+        int decompressed = dictionary_.empty()
+                               ? LZ4_decompress_safe(source, target, source_length, original_length)
+                               : LZ4_decompress_safe_usingDict(source,
+                                                               target,
+                                                               source_length,
+                                                               original_length,
+                                                               dictionary_.data(),
+                                                               static_cast<int>(dictionary_.size()));
+        return decompressed == original_length;
+    }
+};
+
+} // namespace unum::ukv
@@ -10,7 +10,25 @@
 #include <stdexcept> // `std::runtime_error`
 #include <memory>    // `std::allocator`
 #include <vector>    // `std::vector`
+#include <string>    // `std::string`
 #include <algorithm> // `std::sort`
+#include <utility>   // `std::exchange`
+#include <thread>    // `std::thread`
+#include <atomic>    // `std::atomic`
+#include <mutex>     // `std::mutex`
+#include <deque>     // `std::deque`
+#include <condition_variable> // `std::condition_variable`
+
+#include <fcntl.h>    // `open`
+#include <unistd.h>   // `close`
+#include <sys/mman.h> // `mmap`
+#include <sys/stat.h> // `fstat`
+
+#if defined(__AVX2__)
+#include <immintrin.h> // `_mm256_cmpgt_epi64`
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h> // `vcgtq_s64`
+#endif
 
 #include "ukv/ukv.hpp"
 
@@ -180,6 +198,11 @@ struct stl_arena_t {
     std::vector<byte_t> unpacked_tape;
     std::vector<byte_t> another_tape;
     growing_tape_t growing_tape;
+    /**
+     * Documents of shredded collections, reassembled
+     * from their residual parts and scalar columns.
+     */
+    growing_tape_t shredded_tape;
     /**
      * In complex multi-step operations we need arrays
      * of `col_key_t` to sort/navigate them more easily.
@@ -191,12 +214,63 @@ struct stl_arena_t {
      * big batch operations.
      */
     std::vector<value_t> updated_vals;
+    /**
+     * Decoded adjacency lists of the `updated_keys` vertices,
+     * two per vertex, that keep their capacity between calls.
+     */
+    std::vector<std::vector<neighborship_t>> updated_neighbors;
+    /**
+     * Strings, that some backends (like RocksDB) need to be able
+     * to fetch values in batch operations.
+     */
+    std::vector<std::string> strings;
+    /**
+     * Reserved for the backends, never exported to the user and
+     * never used by the logic layers above them.
+     */
+    std::vector<byte_t> backend_tape;
+    std::vector<ukv_col_t> backend_cols;
+    /**
+     * Arenas of the underlying databases, for backends wrapping
+     * others, like the sharding router. Must be freed by them,
+     * before the arena is released.
+     */
+    std::vector<ukv_arena_t> backend_arenas;
+    /**
+     * @brief Number of times the tapes had to grow, requesting memory from the heap.
+     * Stays constant in steady state, when the arena is reused between similar calls.
+     */
+    std::size_t allocations = 0;
 };
 
+/**
+ * @brief Thread-local cache of released arenas, that keep their capacity.
+ * Allows memory reuse, even if the user frees the arena after every call.
+ */
+class arenas_pool_t {
+    static constexpr std::size_t capacity_k = 4;
+    stl_arena_t* arenas_[capacity_k] {};
+    std::size_t count_ = 0;
+
+  public:
+    ~arenas_pool_t() {
+        while (count_)
+            delete arenas_[--count_];
+    }
+    stl_arena_t* pop() noexcept { return count_ ? arenas_[--count_] : nullptr; }
+    bool push(stl_arena_t* arena) noexcept { return count_ != capacity_k ? (arenas_[count_++] = arena, true) : false; }
+};
+
+inline thread_local arenas_pool_t arenas_pool;
+
 inline stl_arena_t* cast_arena(ukv_arena_t* c_arena, ukv_error_t* c_error) noexcept {
     try {
-        if (!*c_arena)
-            *c_arena = new stl_arena_t;
+        if (!*c_arena) {
+            stl_arena_t* pooled = arenas_pool.pop();
+            if (pooled)
+                pooled->allocations = 0;
+            *c_arena = pooled ? pooled : new stl_arena_t;
+        }
         return *reinterpret_cast<stl_arena_t**>(c_arena);
     }
     catch (...) {
@@ -205,9 +279,37 @@ inline stl_arena_t* cast_arena(ukv_arena_t* c_arena, ukv_error_t* c_error) noexc
     }
 }
 
+/**
+ * @brief Returns the arena into the thread-local pool or deallocates it,
+ * if the pool is full. Is the only correct way to implement `ukv_arena_free`.
+ */
+inline void release_arena(ukv_arena_t c_arena) noexcept {
+    if (!c_arena)
+        return;
+    stl_arena_t* arena = reinterpret_cast<stl_arena_t*>(c_arena);
+    if (!arenas_pool.push(arena))
+        delete arena;
+}
+
+inline ukv_size_t arena_allocations(ukv_arena_t c_arena) noexcept {
+    return c_arena ? static_cast<ukv_size_t>(reinterpret_cast<stl_arena_t*>(c_arena)->allocations) : 0;
+}
+
+/**
+ * @brief Resizes one of the arena tapes to @p `n` elements.
+ * Memory grows geometrically and is never returned to the heap,
+ * so calls of similar size don't allocate after the first one.
+ */
 template <typename element_at>
-inline element_at* prepare_memory(std::vector<element_at>& elems, std::size_t n, ukv_error_t* c_error) noexcept {
+inline element_at* prepare_memory(stl_arena_t& arena,
+                                  std::vector<element_at>& elems,
+                                  std::size_t n,
+                                  ukv_error_t* c_error) noexcept {
     try {
+        if (n > elems.capacity()) {
+            elems.reserve(std::max(n, elems.capacity() * 2));
+            ++arena.allocations;
+        }
         elems.resize(n);
         return elems.data();
     }
@@ -248,6 +350,8 @@ struct read_tasks_soa_t {
     ukv_size_t count = 0;
 
     inline std::size_t size() const noexcept { return count; }
+    /// All the tasks target the same collection, which is the most common layout.
+    inline bool same_col() const noexcept { return !cols || cols.repeats(); }
 
     inline read_task_t operator[](ukv_size_t i) const noexcept {
         ukv_col_t col = cols ? cols[i] : ukv_col_main_k;
@@ -275,6 +379,8 @@ struct scan_tasks_soa_t {
     ukv_size_t count = 0;
 
     inline std::size_t size() const noexcept { return count; }
+    /// All the tasks target the same collection, which is the most common layout.
+    inline bool same_col() const noexcept { return !cols || cols.repeats(); }
 
     inline scan_task_t operator[](ukv_size_t i) const noexcept {
         ukv_col_t col = cols ? cols[i] : ukv_col_main_k;
@@ -310,6 +416,8 @@ struct write_tasks_soa_t {
     ukv_size_t count = 0;
 
     inline std::size_t size() const noexcept { return count; }
+    /// All the tasks target the same collection, which is the most common layout.
+    inline bool same_col() const noexcept { return !cols || cols.repeats(); }
 
     inline write_task_t operator[](ukv_size_t i) const noexcept {
         ukv_col_t col = cols ? cols[i] : ukv_col_main_k;
@@ -331,6 +439,72 @@ struct write_tasks_soa_t {
     }
 };
 
+/**
+ * @brief Checks if @p n keys are strictly ascending.
+ * Contiguous arrays, the most common layout, are compared with SIMD,
+ * two overlapping loads at a time, which are shifted by one key.
+ */
+inline bool keys_ascending(strided_iterator_gt<ukv_key_t const> keys, std::size_t n) noexcept {
+    if (n < 2)
+        return true;
+    if (keys.repeats())
+        return false;
+    if (keys.stride() != sizeof(ukv_key_t))
+        return all_ascending(keys, n);
+
+    ukv_key_t const* begin = keys.get();
+    std::size_t i = 0;
+#if defined(__AVX2__)
+    for (; i + 4 < n; i += 4) {
+        __m256i current = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(begin + i));
+        __m256i next = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(begin + i + 1));
+        if (_mm256_movemask_epi8(_mm256_cmpgt_epi64(next, current)) != -1)
+            return false;
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    for (; i + 2 < n; i += 2) {
+        uint64x2_t ascending = vcgtq_s64(vld1q_s64(begin + i + 1), vld1q_s64(begin + i));
+        if (!(vgetq_lane_u64(ascending, 0) & vgetq_lane_u64(ascending, 1)))
+            return false;
+    }
+#endif
+    for (; i + 1 < n; ++i)
+        if (begin[i + 1] <= begin[i])
+            return false;
+    return true;
+}
+
+/**
+ * @brief Checks that the entries of a bulk load are sorted and unique
+ * within every collection, and that none of them are deletions.
+ */
+inline void validate_bulk_load(write_tasks_soa_t const& tasks, ukv_error_t* c_error) noexcept {
+    if (!tasks.vals && tasks.count && (*c_error = "Bulk loads can't delete entries!"))
+        return;
+
+    // Loads into a single collection only need the keys to ascend
+    if (tasks.same_col()) {
+        for (ukv_size_t i = 0; i != tasks.count; ++i)
+            if (!tasks.vals[i] && (*c_error = "Bulk loads can't delete entries!"))
+                return;
+        if (!keys_ascending(tasks.keys, tasks.count))
+            *c_error = "Keys must be sorted and unique within every collection!";
+        return;
+    }
+
+    for (ukv_size_t i = 0; i != tasks.count; ++i) {
+        write_task_t task = tasks[i];
+        if (task.is_deleted() && (*c_error = "Bulk loads can't delete entries!"))
+            return;
+        if (i == 0)
+            continue;
+        write_task_t previous = tasks[i - 1];
+        if (previous.col == task.col && !(previous.key < task.key) &&
+            (*c_error = "Keys must be sorted and unique within every collection!"))
+            return;
+    }
+}
+
 class file_handle_t {
     std::FILE* handle_ = nullptr;
 
@@ -362,6 +536,70 @@ class file_handle_t {
     operator std::FILE*() const noexcept { return handle_; }
 };
 
+/**
+ * @brief Read-only memory-mapping of an entire file.
+ * Pages are loaded lazily by the OS, as they are accessed,
+ * and stay valid even if the file is replaced on disk.
+ */
+class mapped_file_t {
+    byte_t* begin_ = nullptr;
+    std::size_t length_ = 0;
+
+  public:
+    mapped_file_t() = default;
+    mapped_file_t(mapped_file_t const&) = delete;
+    mapped_file_t& operator=(mapped_file_t const&) = delete;
+    mapped_file_t(mapped_file_t&& other) noexcept
+        : begin_(std::exchange(other.begin_, nullptr)), length_(std::exchange(other.length_, 0)) {}
+    mapped_file_t& operator=(mapped_file_t&& other) noexcept {
+        std::swap(begin_, other.begin_);
+        std::swap(length_, other.length_);
+        return *this;
+    }
+
+    status_t open(char const* path) {
+        if (begin_)
+            return "Close previous mapping before opening the new one!";
+        int descriptor = ::open(path, O_RDONLY);
+        if (descriptor < 0)
+            return "Failed to open a file";
+
+        struct stat info;
+        if (::fstat(descriptor, &info) != 0) {
+            ::close(descriptor);
+            return "Failed to measure a file";
+        }
+
+        // Empty files can't be mapped, but are still valid
+        length_ = static_cast<std::size_t>(info.st_size);
+        if (length_) {
+            void* begin = ::mmap(nullptr, length_, PROT_READ, MAP_PRIVATE, descriptor, 0);
+            if (begin == MAP_FAILED) {
+                ::close(descriptor);
+                length_ = 0;
+                return "Failed to map a file";
+            }
+            begin_ = reinterpret_cast<byte_t*>(begin);
+        }
+
+        // The mapping outlives the descriptor
+        ::close(descriptor);
+        return {};
+    }
+
+    void close() noexcept {
+        if (begin_)
+            ::munmap(begin_, length_);
+        begin_ = nullptr;
+        length_ = 0;
+    }
+
+    ~mapped_file_t() { close(); }
+
+    byte_t const* begin() const noexcept { return begin_; }
+    std::size_t size() const noexcept { return length_; }
+};
+
 template <typename range_at, typename comparable_at>
 inline range_at equal_subrange(range_at range, comparable_at&& comparable) {
     auto p = std::equal_range(range.begin(), range.end(), comparable);
@@ -386,4 +624,164 @@ void inplace_inclusive_prefix_sum(element_at* begin, element_at* const end) {
         sum += std::exchange(*begin, *begin + sum);
 }
 
+/**
+ * @brief Process-wide threads shared by all `parallel_for_chunks` calls, started lazily.
+ * The submitter processes the chunks too, only waiting for the ones already taken by
+ * the workers, so nested and concurrent loops can't deadlock, even with all workers busy.
+ */
+class chunks_pool_t {
+  public:
+    struct job_t {
+        void (*run)(void*, std::size_t) = nullptr;
+        void* context = nullptr;
+        std::size_t count = 0;
+        std::atomic<std::size_t> next = 0;
+        std::size_t workers = 0;
+        std::mutex mutex;
+        std::condition_variable finished;
+
+        void help() noexcept {
+            for (std::size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1))
+                run(context, i);
+        }
+    };
+
+    chunks_pool_t() {
+        std::size_t const threads_count = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+        threads_.reserve(threads_count);
+        try {
+            for (std::size_t i = 0; i != threads_count; ++i)
+                threads_.emplace_back(&chunks_pool_t::loop, this);
+        }
+        catch (...) {
+            stop();
+            throw;
+        }
+    }
+    ~chunks_pool_t() { stop(); }
+
+    /// Blocks until every chunk of the @p `job` is processed.
+    void execute(job_t& job) noexcept {
+        {
+            std::lock_guard lock {mutex_};
+            try {
+                jobs_.push_back(&job);
+            }
+            catch (...) {
+            }
+        }
+        wakeup_.notify_all();
+        job.help();
+
+        // No new workers can join the job, once it's out of the queue.
+        {
+            std::lock_guard lock {mutex_};
+            auto it = std::find(jobs_.begin(), jobs_.end(), &job);
+            if (it != jobs_.end())
+                jobs_.erase(it);
+        }
+        std::unique_lock lock {job.mutex};
+        job.finished.wait(lock, [&] { return job.workers == 0; });
+    }
+
+    static chunks_pool_t& shared() {
+        static chunks_pool_t pool;
+        return pool;
+    }
+
+  private:
+    void loop() noexcept {
+        std::unique_lock lock {mutex_};
+        while (true) {
+            wakeup_.wait(lock, [&] { return stopping_ || !jobs_.empty(); });
+            if (stopping_)
+                return;
+
+            job_t& job = *jobs_.front();
+            if (job.next.load() >= job.count) {
+                jobs_.pop_front();
+                continue;
+            }
+            {
+                std::lock_guard job_lock {job.mutex};
+                ++job.workers;
+            }
+            lock.unlock();
+            job.help();
+            {
+                // Notify under the lock, as the submitter destroys the job right after.
+                std::lock_guard job_lock {job.mutex};
+                if (--job.workers == 0)
+                    job.finished.notify_all();
+            }
+            lock.lock();
+        }
+    }
+
+    void stop() noexcept {
+        {
+            std::lock_guard lock {mutex_};
+            stopping_ = true;
+        }
+        wakeup_.notify_all();
+        for (auto& thread : threads_)
+            thread.join();
+        threads_.clear();
+    }
+
+    std::mutex mutex_;
+    std::condition_variable wakeup_;
+    std::deque<job_t*> jobs_;
+    std::vector<std::thread> threads_;
+    bool stopping_ = false;
+};
+
+/**
+ * @brief Calls @p `callback` on contiguous sub-ranges of `[0, n)` from multiple threads,
+ * if the range is big enough to give every thread at least @p `min_chunk` elements.
+ * The threads come from the `chunks_pool_t`, so no threads are spawned per call.
+ * If the pool can't be started, the whole range is processed by the calling thread.
+ * The @p `callback` must not throw.
+ *
+ * @param max_threads Upper bound for the number of threads, including the calling one.
+ *                    Zero means all hardware threads.
+ */
+template <typename callback_at>
+void parallel_for_chunks(std::size_t n, std::size_t min_chunk, std::size_t max_threads, callback_at&& callback) {
+    std::size_t threads_count = max_threads ? max_threads : std::thread::hardware_concurrency();
+    threads_count = std::min<std::size_t>(threads_count, n / std::max<std::size_t>(min_chunk, 1));
+    chunks_pool_t* pool = nullptr;
+    if (threads_count > 1) {
+        try {
+            pool = &chunks_pool_t::shared();
+        }
+        catch (...) {
+        }
+    }
+    if (!pool)
+        return callback(std::size_t(0), n);
+
+    struct context_t {
+        callback_at& callback;
+        std::size_t n;
+        std::size_t chunk;
+    };
+    context_t context {callback, n, (n + threads_count - 1) / threads_count};
+    chunks_pool_t::job_t job;
+    job.context = &context;
+    job.count = (n + context.chunk - 1) / context.chunk;
+    job.run = [](void* raw, std::size_t i) {
+        context_t& context = *reinterpret_cast<context_t*>(raw);
+        std::size_t const begin = i * context.chunk;
+        context.callback(begin, std::min(begin + context.chunk, context.n));
+    };
+    pool->execute(job);
+}
+
+/// Keeps only the first error reported by concurrent workers.
+inline void report_error(std::atomic<ukv_error_t>& error, ukv_error_t message) noexcept {
+    ukv_error_t expected = nullptr;
+    error.compare_exchange_strong(expected, message);
+}
+
 } // namespace unum::ukv
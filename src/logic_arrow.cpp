@@ -0,0 +1,723 @@
+/**
+ * @file logic_arrow.cpp
+ * @author Ashot Vardanian
+ *
+ * @brief Apache Arrow C Data Interface exports of reads, scans and gathers.
+ * Sits on top of any @see "ukv.h"-compatible system.
+ */
+
+#include <algorithm> // `std::max`
+#include <cerrno>    // `EIO`
+#include <cstring>   // `std::memcpy`
+#include <limits>    // `std::numeric_limits`
+#include <memory>    // `std::unique_ptr`
+#include <string>    // `std::string`
+#include <vector>    // `std::vector`
+#include <utility>   // `std::exchange`
+
+#include "ukv/arrow.h"
+#include "helpers.hpp"
+
+/*********************************************************/
+/*****************	 C++ Implementation	  ****************/
+/*********************************************************/
+
+using namespace unum::ukv;
+using namespace unum;
+
+namespace {
+
+/**
+ * @brief Buffers of a single exported array and the memory,
+ * repacked for Arrow, that they may point to.
+ */
+struct arrow_column_t {
+    void const* buffers[3] {};
+    std::vector<std::int32_t> offsets;
+    std::vector<std::uint8_t> bits;
+    std::vector<std::uint8_t> contents;
+};
+
+/**
+ * @brief Everything the `release` callback of an exported array must free.
+ * The arenas hold the memory of zero-copy buffers.
+ */
+struct arrow_array_private_t {
+    ukv_t db = nullptr;
+    ukv_arena_t arenas[2] {};
+    void const* struct_buffers[1] {};
+    std::vector<arrow_column_t> columns;
+    std::vector<ArrowArray> children;
+    std::vector<ArrowArray*> children_ptrs;
+};
+
+struct arrow_schema_private_t {
+    std::vector<std::string> names;
+    std::vector<ArrowSchema> children;
+    std::vector<ArrowSchema*> children_ptrs;
+};
+
+struct arrow_stream_private_t {
+    ukv_t db = nullptr;
+    ukv_txn_t txn = nullptr;
+    ukv_col_t col = ukv_col_main_k;
+    ukv_key_t next_key = 0;
+    ukv_key_t max_key = 0;
+    ukv_size_t batch_size = 0;
+    std::vector<std::string> fields;
+    std::vector<ukv_str_view_t> fields_ptrs;
+    std::vector<ukv_type_t> types;
+    std::string last_error;
+};
+
+constexpr std::size_t arrow_max_offset_k = static_cast<std::size_t>(std::numeric_limits<std::int32_t>::max());
+
+char const* arrow_format(ukv_type_t type) noexcept {
+    switch (type) {
+    case ukv_type_null_k: return "n";
+    case ukv_type_bool_k: return "b";
+    case ukv_type_uuid_k: return "w:16";
+    case ukv_type_i8_k: return "c";
+    case ukv_type_i16_k: return "s";
+    case ukv_type_i32_k: return "i";
+    case ukv_type_i64_k: return "l";
+    case ukv_type_u8_k: return "C";
+    case ukv_type_u16_k: return "S";
+    case ukv_type_u32_k: return "I";
+    case ukv_type_u64_k: return "L";
+    case ukv_type_f16_k: return "e";
+    case ukv_type_f32_k: return "f";
+    case ukv_type_f64_k: return "g";
+    case ukv_type_bin_k: return "z";
+    case ukv_type_str_k: return "u";
+    default: return nullptr;
+    }
+}
+
+inline bool get_bit(ukv_1x8_t const* bits, std::size_t i) noexcept {
+    return (bits[i / 8] >> (i % 8)) & 1;
+}
+
+void release_child_schema(ArrowSchema* schema) {
+    schema->release = nullptr;
+}
+
+void release_schema(ArrowSchema* schema) {
+    auto private_data = static_cast<arrow_schema_private_t*>(schema->private_data);
+    for (ArrowSchema& child : private_data->children)
+        if (child.release)
+            child.release(&child);
+    delete private_data;
+    schema->release = nullptr;
+}
+
+void free_arenas(arrow_array_private_t& private_data) noexcept {
+    for (ukv_arena_t& arena : private_data.arenas)
+        ukv_arena_free(private_data.db, std::exchange(arena, nullptr));
+}
+
+void release_child_array(ArrowArray* array) {
+    array->release = nullptr;
+}
+
+void release_array(ArrowArray* array) {
+    auto private_data = static_cast<arrow_array_private_t*>(array->private_data);
+    for (ArrowArray& child : private_data->children)
+        if (child.release)
+            child.release(&child);
+    free_arenas(*private_data);
+    delete private_data;
+    array->release = nullptr;
+}
+
+/**
+ * @brief Describes a single column, if @p formats has one entry and @p as_struct is false,
+ * or a `struct` of columns otherwise. Field names are copied into the schema.
+ */
+void export_schema(std::vector<std::string> names,
+                   std::vector<char const*> const& formats,
+                   bool as_struct,
+                   ArrowSchema& schema) {
+
+    auto private_data = std::make_unique<arrow_schema_private_t>();
+    private_data->names = std::move(names);
+    auto fill = [](ArrowSchema& schema, char const* format, char const* name, int64_t flags) {
+        schema.format = format;
+        schema.name = name;
+        schema.metadata = nullptr;
+        schema.flags = flags;
+        schema.n_children = 0;
+        schema.children = nullptr;
+        schema.dictionary = nullptr;
+        schema.release = &release_child_schema;
+        schema.private_data = nullptr;
+    };
+
+    if (!as_struct) {
+        fill(schema, formats[0], private_data->names[0].c_str(), ARROW_FLAG_NULLABLE);
+        schema.release = &release_schema;
+        schema.private_data = private_data.release();
+        return;
+    }
+
+    private_data->children.resize(formats.size());
+    private_data->children_ptrs.resize(formats.size());
+    for (std::size_t i = 0; i != formats.size(); ++i) {
+        fill(private_data->children[i], formats[i], private_data->names[i].c_str(), ARROW_FLAG_NULLABLE);
+        private_data->children_ptrs[i] = &private_data->children[i];
+    }
+    fill(schema, "+s", "", 0);
+    schema.n_children = static_cast<int64_t>(formats.size());
+    schema.children = private_data->children_ptrs.data();
+    schema.release = &release_schema;
+    schema.private_data = private_data.release();
+}
+
+void fill_array(ArrowArray& array, ukv_size_t length, int64_t null_count, int64_t n_buffers, void const** buffers) {
+    array.length = static_cast<int64_t>(length);
+    array.null_count = null_count;
+    array.offset = 0;
+    array.n_buffers = n_buffers;
+    array.n_children = 0;
+    array.buffers = buffers;
+    array.children = nullptr;
+    array.dictionary = nullptr;
+    array.release = &release_child_array;
+    array.private_data = nullptr;
+}
+
+/**
+ * @brief Points the array at the keys, which are always present.
+ */
+void export_keys(arrow_column_t& column, ArrowArray& array, ukv_size_t count, ukv_key_t const* keys) {
+    column.buffers[0] = nullptr;
+    column.buffers[1] = keys;
+    fill_array(array, count, 0, 2, column.buffers);
+}
+
+/**
+ * @brief Exports variable-length entries with Arrow offsets. The contents are referenced
+ * on the @p tape, if the valid entries follow each other, or copied otherwise.
+ */
+template <typename is_valid_at>
+void export_variable_length(arrow_column_t& column,
+                            ukv_size_t count,
+                            byte_t const* tape,
+                            ukv_val_len_t const* offsets,
+                            ukv_val_len_t const* lengths,
+                            is_valid_at&& is_valid,
+                            ukv_error_t* c_error) {
+
+    bool is_consecutive = true;
+    std::size_t first_offset = 0;
+    std::size_t expected_offset = 0;
+    std::size_t total_length = 0;
+    bool has_first = false;
+    for (ukv_size_t i = 0; i != count; ++i) {
+        if (!is_valid(i))
+            continue;
+        if (!has_first)
+            first_offset = expected_offset = offsets[i], has_first = true;
+        is_consecutive &= offsets[i] == expected_offset;
+        expected_offset = offsets[i] + lengths[i];
+        total_length += lengths[i];
+    }
+    if (total_length > arrow_max_offset_k && (*c_error = "Values exceed 32-bit Arrow offsets, use smaller batches!"))
+        return;
+
+    column.offsets.resize(count + 1);
+    std::int32_t progress = 0;
+    for (ukv_size_t i = 0; i != count; ++i) {
+        column.offsets[i] = progress;
+        progress += is_valid(i) ? static_cast<std::int32_t>(lengths[i]) : 0;
+    }
+    column.offsets[count] = progress;
+    column.buffers[1] = column.offsets.data();
+
+    if (is_consecutive) {
+        column.buffers[2] = tape + first_offset;
+        return;
+    }
+
+    column.contents.resize(total_length);
+    auto contents = reinterpret_cast<byte_t*>(column.contents.data());
+    for (ukv_size_t i = 0; i != count; ++i)
+        if (is_valid(i))
+            std::memcpy(contents + column.offsets[i], tape + offsets[i], lengths[i]);
+    column.buffers[2] = column.contents.data();
+}
+
+/**
+ * @brief Exports the results of `ukv_read` as a `binary` array, missing values become nulls.
+ */
+void export_values(arrow_column_t& column,
+                   ArrowArray& array,
+                   ukv_size_t count,
+                   ukv_val_ptr_t values,
+                   ukv_val_len_t const* offsets,
+                   ukv_val_len_t const* lengths,
+                   ukv_error_t* c_error) {
+
+    if (count && (!values || !offsets || !lengths) && (*c_error = "Values must be read with their contents!"))
+        return;
+
+    auto is_valid = [=](ukv_size_t i) {
+        return lengths[i] != ukv_val_len_missing_k;
+    };
+    int64_t null_count = 0;
+    column.bits.assign((count + 7) / 8, 0);
+    for (ukv_size_t i = 0; i != count; ++i)
+        if (is_valid(i))
+            column.bits[i / 8] |= static_cast<std::uint8_t>(1 << (i % 8));
+        else
+            ++null_count;
+
+    export_variable_length(column, count, reinterpret_cast<byte_t const*>(values), offsets, lengths, is_valid, c_error);
+    if (*c_error)
+        return;
+    column.buffers[0] = null_count ? column.bits.data() : nullptr;
+    fill_array(array, count, null_count, 3, column.buffers);
+}
+
+/**
+ * @brief Exports a single column of `ukv_docs_gather`, sharing the validity bitmap.
+ */
+void export_gathered(arrow_column_t& column,
+                     ArrowArray& array,
+                     ukv_size_t docs_count,
+                     ukv_type_t type,
+                     ukv_1x8_t const* validities,
+                     ukv_val_ptr_t scalars,
+                     ukv_val_len_t const* offsets,
+                     ukv_val_len_t const* lengths,
+                     ukv_val_ptr_t strings,
+                     ukv_error_t* c_error) {
+
+    column.buffers[0] = validities;
+    switch (type) {
+    case ukv_type_null_k:
+        fill_array(array, docs_count, static_cast<int64_t>(docs_count), 0, column.buffers);
+        return;
+
+    case ukv_type_bool_k:
+        column.bits.assign((docs_count + 7) / 8, 0);
+        for (ukv_size_t i = 0; i != docs_count; ++i)
+            if (scalars[i])
+                column.bits[i / 8] |= static_cast<std::uint8_t>(1 << (i % 8));
+        column.buffers[1] = column.bits.data();
+        fill_array(array, docs_count, -1, 2, column.buffers);
+        return;
+
+    case ukv_type_str_k:
+    case ukv_type_bin_k: {
+        auto is_valid = [=](ukv_size_t i) {
+            return get_bit(validities, i);
+        };
+        auto tape = reinterpret_cast<byte_t const*>(strings);
+        export_variable_length(column, docs_count, tape, offsets, lengths, is_valid, c_error);
+        if (!*c_error)
+            fill_array(array, docs_count, -1, 3, column.buffers);
+        return;
+    }
+
+    default:
+        if (!arrow_format(type) && (*c_error = "Type can't be exported to Arrow!"))
+            return;
+        column.buffers[1] = scalars;
+        fill_array(array, docs_count, -1, 2, column.buffers);
+        return;
+    }
+}
+
+/**
+ * @brief Allocates the private data of a `struct` array with @p count children.
+ */
+std::unique_ptr<arrow_array_private_t> make_struct_private(ukv_t db, std::size_t count) {
+    auto private_data = std::make_unique<arrow_array_private_t>();
+    private_data->db = db;
+    private_data->columns.resize(count);
+    private_data->children.resize(count);
+    private_data->children_ptrs.resize(count);
+    for (std::size_t i = 0; i != count; ++i)
+        private_data->children_ptrs[i] = &private_data->children[i];
+    return private_data;
+}
+
+void fill_struct_array(ArrowArray& array, ukv_size_t length, std::unique_ptr<arrow_array_private_t> private_data) {
+    fill_array(array, length, 0, 1, private_data->struct_buffers);
+    array.n_children = static_cast<int64_t>(private_data->children.size());
+    array.children = private_data->children_ptrs.data();
+    array.release = &release_array;
+    array.private_data = private_data.release();
+}
+
+std::vector<std::string> stream_names(arrow_stream_private_t const& stream) {
+    std::vector<std::string> names {"key"};
+    if (stream.fields.empty())
+        names.emplace_back("value");
+    names.insert(names.end(), stream.fields.begin(), stream.fields.end());
+    return names;
+}
+
+std::vector<char const*> stream_formats(arrow_stream_private_t const& stream) {
+    std::vector<char const*> formats {"l"};
+    if (stream.fields.empty())
+        formats.push_back("z");
+    for (ukv_type_t type : stream.types)
+        formats.push_back(arrow_format(type));
+    return formats;
+}
+
+int stream_get_schema(ArrowArrayStream* stream, ArrowSchema* out) {
+    auto& state = *static_cast<arrow_stream_private_t*>(stream->private_data);
+    try {
+        export_schema(stream_names(state), stream_formats(state), true, *out);
+        return 0;
+    }
+    catch (...) {
+        state.last_error = "Failed to allocate memory!";
+        return ENOMEM;
+    }
+}
+
+/**
+ * @brief Scans the next batch of keys into one arena and reads or gathers
+ * their contents into another, so that the keys aren't overwritten.
+ * Both arenas move into the exported batch.
+ */
+int stream_get_next(ArrowArrayStream* stream, ArrowArray* out) {
+    auto& state = *static_cast<arrow_stream_private_t*>(stream->private_data);
+    out->release = nullptr;
+    if (state.next_key >= state.max_key)
+        return 0;
+
+    ukv_error_t error = nullptr;
+    std::unique_ptr<arrow_array_private_t> private_data;
+    try {
+        std::size_t columns_count = 1 + std::max<std::size_t>(state.fields.size(), 1);
+        private_data = make_struct_private(state.db, columns_count);
+    }
+    catch (...) {
+        state.last_error = "Failed to allocate memory!";
+        return ENOMEM;
+    }
+
+    ukv_key_t* found_keys = nullptr;
+    ukv_val_len_t* found_lengths = nullptr;
+    ukv_scan(state.db,
+             state.txn,
+             1,
+             &state.col,
+             0,
+             &state.next_key,
+             0,
+             &state.batch_size,
+             0,
+             ukv_options_default_k,
+             &found_keys,
+             &found_lengths,
+             &private_data->arenas[0],
+             &error);
+
+    // Keys are sorted and padded with `ukv_key_unknown_k`
+    ukv_size_t count = 0;
+    if (!error)
+        while (count != state.batch_size && found_keys[count] < state.max_key)
+            ++count;
+    if (!error && !count) {
+        state.next_key = state.max_key;
+        free_arenas(*private_data);
+        return 0;
+    }
+
+    if (!error && state.fields.empty()) {
+        ukv_val_ptr_t found_values = nullptr;
+        ukv_val_len_t* found_offsets = nullptr;
+        ukv_read(state.db,
+                 state.txn,
+                 count,
+                 &state.col,
+                 0,
+                 found_keys,
+                 sizeof(ukv_key_t),
+                 ukv_options_default_k,
+                 &found_values,
+                 &found_offsets,
+                 &found_lengths,
+                 &private_data->arenas[1],
+                 &error);
+        if (!error)
+            export_values(private_data->columns[1],
+                          private_data->children[1],
+                          count,
+                          found_values,
+                          found_offsets,
+                          found_lengths,
+                          &error);
+    }
+    else if (!error) {
+        ukv_1x8_t** validities = nullptr;
+        ukv_1x8_t** conversions = nullptr;
+        ukv_1x8_t** collisions = nullptr;
+        ukv_val_ptr_t* scalars = nullptr;
+        ukv_val_len_t** offsets = nullptr;
+        ukv_val_len_t** lengths = nullptr;
+        ukv_val_ptr_t strings = nullptr;
+        ukv_size_t fields_count = static_cast<ukv_size_t>(state.fields.size());
+        ukv_docs_gather(state.db,
+                        state.txn,
+                        count,
+                        fields_count,
+                        &state.col,
+                        0,
+                        found_keys,
+                        sizeof(ukv_key_t),
+                        state.fields_ptrs.data(),
+                        sizeof(ukv_str_view_t),
+                        state.types.data(),
+                        sizeof(ukv_type_t),
+                        ukv_options_default_k,
+                        &validities,
+                        &conversions,
+                        &collisions,
+                        &scalars,
+                        &offsets,
+                        &lengths,
+                        &strings,
+                        &private_data->arenas[1],
+                        &error);
+        try {
+            for (ukv_size_t i = 0; i != fields_count && !error; ++i)
+                export_gathered(private_data->columns[i + 1],
+                                private_data->children[i + 1],
+                                count,
+                                state.types[i],
+                                validities[i],
+                                scalars[i],
+                                offsets[i],
+                                lengths[i],
+                                strings,
+                                &error);
+        }
+        catch (...) {
+            error = "Failed to allocate memory!";
+        }
+    }
+
+    if (error) {
+        state.last_error = error;
+        ukv_error_free(error);
+        free_arenas(*private_data);
+        return EIO;
+    }
+
+    state.next_key = count == state.batch_size ? found_keys[count - 1] + 1 : state.max_key;
+    export_keys(private_data->columns[0], private_data->children[0], count, found_keys);
+    fill_struct_array(*out, count, std::move(private_data));
+    return 0;
+}
+
+char const* stream_get_last_error(ArrowArrayStream* stream) {
+    auto& state = *static_cast<arrow_stream_private_t*>(stream->private_data);
+    return state.last_error.empty() ? nullptr : state.last_error.c_str();
+}
+
+void stream_release(ArrowArrayStream* stream) {
+    delete static_cast<arrow_stream_private_t*>(stream->private_data);
+    stream->release = nullptr;
+}
+
+} // namespace
+
+/*********************************************************/
+/*****************	    C Interface 	  ****************/
+/*********************************************************/
+
+void ukv_to_arrow_keys( //
+    ukv_t const c_db,
+    ukv_size_t const c_count,
+    ukv_key_t const* c_keys,
+    ukv_str_view_t const c_name,
+
+    ArrowSchema* c_schema,
+    ArrowArray* c_array,
+    ukv_arena_t* c_arena,
+    ukv_error_t* c_error) {
+
+    if ((!c_schema || !c_array) && (*c_error = "Arrow outputs are NULL!"))
+        return;
+
+    try {
+        auto private_data = std::make_unique<arrow_array_private_t>();
+        private_data->db = c_db;
+        private_data->columns.resize(1);
+        export_schema({c_name ? c_name : "key"}, {"l"}, false, *c_schema);
+
+        export_keys(private_data->columns[0], *c_array, c_count, c_keys);
+        c_array->release = &release_array;
+        private_data->arenas[0] = std::exchange(*c_arena, nullptr);
+        c_array->private_data = private_data.release();
+    }
+    catch (...) {
+        *c_error = "Failed to allocate memory!";
+    }
+}
+
+void ukv_to_arrow_values( //
+    ukv_t const c_db,
+    ukv_size_t const c_count,
+    ukv_val_ptr_t const c_values,
+    ukv_val_len_t const* c_offsets,
+    ukv_val_len_t const* c_lengths,
+    ukv_str_view_t const c_name,
+
+    ArrowSchema* c_schema,
+    ArrowArray* c_array,
+    ukv_arena_t* c_arena,
+    ukv_error_t* c_error) {
+
+    if ((!c_schema || !c_array) && (*c_error = "Arrow outputs are NULL!"))
+        return;
+
+    try {
+        auto private_data = std::make_unique<arrow_array_private_t>();
+        private_data->db = c_db;
+        private_data->columns.resize(1);
+        export_values(private_data->columns[0], *c_array, c_count, c_values, c_offsets, c_lengths, c_error);
+        if (*c_error)
+            return;
+
+        export_schema({c_name ? c_name : "value"}, {"z"}, false, *c_schema);
+        c_array->release = &release_array;
+        private_data->arenas[0] = std::exchange(*c_arena, nullptr);
+        c_array->private_data = private_data.release();
+    }
+    catch (...) {
+        *c_error = "Failed to allocate memory!";
+    }
+}
+
+void ukv_to_arrow_table( //
+    ukv_t const c_db,
+    ukv_size_t const c_docs_count,
+    ukv_size_t const c_fields_count,
+
+    ukv_str_view_t const* c_fields,
+    ukv_size_t const c_fields_stride,
+
+    ukv_type_t const* c_types,
+    ukv_size_t const c_types_stride,
+
+    ukv_1x8_t** c_columns_validities,
+    ukv_val_ptr_t* c_columns_scalars,
+    ukv_val_len_t** c_columns_offsets,
+    ukv_val_len_t** c_columns_lengths,
+    ukv_val_ptr_t c_joined_strings,
+
+    ArrowSchema* c_schema,
+    ArrowArray* c_array,
+    ukv_arena_t* c_arena,
+    ukv_error_t* c_error) {
+
+    if ((!c_schema || !c_array) && (*c_error = "Arrow outputs are NULL!"))
+        return;
+
+    strided_iterator_gt<ukv_str_view_t const> fields {c_fields, c_fields_stride};
+    strided_iterator_gt<ukv_type_t const> types {c_types, c_types_stride};
+
+    try {
+        std::vector<std::string> names;
+        std::vector<char const*> formats;
+        auto private_data = make_struct_private(c_db, c_fields_count);
+        ukv_str_view_t joined_name = c_fields_count ? fields[0] : nullptr;
+        for (ukv_size_t i = 0; i != c_fields_count; ++i) {
+            // Zero stride means the names are concatenated with NULL-characters
+            ukv_str_view_t name = fields.repeats() ? joined_name : fields[i];
+            if (fields.repeats())
+                joined_name += std::strlen(joined_name) + 1;
+            names.emplace_back(name);
+            formats.push_back(arrow_format(types[i]));
+            export_gathered(private_data->columns[i],
+                            private_data->children[i],
+                            c_docs_count,
+                            types[i],
+                            c_columns_validities[i],
+                            c_columns_scalars[i],
+                            c_columns_offsets[i],
+                            c_columns_lengths[i],
+                            c_joined_strings,
+                            c_error);
+            if (*c_error)
+                return;
+        }
+
+        export_schema(std::move(names), formats, true, *c_schema);
+        private_data->arenas[0] = std::exchange(*c_arena, nullptr);
+        fill_struct_array(*c_array, c_docs_count, std::move(private_data));
+    }
+    catch (...) {
+        *c_error = "Failed to allocate memory!";
+    }
+}
+
+void ukv_to_arrow_stream( //
+    ukv_t const c_db,
+    ukv_txn_t const c_txn,
+    ukv_col_t const c_col,
+
+    ukv_key_t const c_min_key,
+    ukv_key_t const c_max_key,
+    ukv_size_t const c_docs_per_batch,
+
+    ukv_size_t const c_fields_count,
+    ukv_str_view_t const* c_fields,
+    ukv_size_t const c_fields_stride,
+
+    ukv_type_t const* c_types,
+    ukv_size_t const c_types_stride,
+
+    ArrowArrayStream* c_stream,
+    ukv_error_t* c_error) {
+
+    if (!c_db && (*c_error = "DataBase is NULL!"))
+        return;
+    if (!c_stream && (*c_error = "Arrow stream is NULL!"))
+        return;
+    if (!c_docs_per_batch && (*c_error = "Batches can't be empty!"))
+        return;
+
+    strided_iterator_gt<ukv_str_view_t const> fields {c_fields, c_fields_stride};
+    strided_iterator_gt<ukv_type_t const> types {c_types, c_types_stride};
+
+    try {
+        auto state = std::make_unique<arrow_stream_private_t>();
+        state->db = c_db;
+        state->txn = c_txn;
+        state->col = c_col;
+        state->next_key = c_min_key;
+        state->max_key = c_max_key;
+        state->batch_size = c_docs_per_batch;
+        ukv_str_view_t joined_name = c_fields_count ? fields[0] : nullptr;
+        for (ukv_size_t i = 0; i != c_fields_count; ++i) {
+            if (!arrow_format(types[i]) && (*c_error = "Type can't be exported to Arrow!"))
+                return;
+            // Zero stride means the names are concatenated with NULL-characters
+            ukv_str_view_t name = fields.repeats() ? joined_name : fields[i];
+            if (fields.repeats())
+                joined_name += std::strlen(joined_name) + 1;
+            state->fields.emplace_back(name);
+            state->types.push_back(types[i]);
+        }
+        for (std::string const& field : state->fields)
+            state->fields_ptrs.push_back(field.c_str());
+
+        c_stream->get_schema = &stream_get_schema;
+        c_stream->get_next = &stream_get_next;
+        c_stream->get_last_error = &stream_get_last_error;
+        c_stream->release = &stream_release;
+        c_stream->private_data = state.release();
+    }
+    catch (...) {
+        *c_error = "Failed to allocate memory!";
+    }
+}
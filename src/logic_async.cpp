@@ -0,0 +1,343 @@
+/**
+ * @file logic_async.cpp
+ * @author Ashot Vardanian
+ *
+ * @brief Non-blocking submission of batches, executed on a shared pool of threads.
+ * Sits on top of any @see "ukv.h"-compatible system.
+ */
+
+#include <mutex>              // `std::mutex`
+#include <condition_variable> // `std::condition_variable`
+#include <deque>              // `std::deque`
+#include <functional>         // `std::function`
+#include <string>             // `std::string`
+
+#include "ukv/async.h"
+#include "helpers.hpp"
+
+/*********************************************************/
+/*****************	 C++ Implementation	  ****************/
+/*********************************************************/
+
+using namespace unum::ukv;
+using namespace unum;
+
+/// Upper bound for the number of threads in the pool. Zero means all hardware threads.
+std::atomic<std::size_t> async_threads_limit {0};
+
+/**
+ * @brief The state of a single submitted batch, shared by the pool and the future.
+ * Both hold a reference, so either side can let go first.
+ */
+struct async_task_t {
+    std::function<void(ukv_error_t*)> run;
+    ukv_callback_t callback = nullptr;
+    void* user_data = nullptr;
+
+    std::atomic<int> references {1};
+    std::atomic<bool> ready {false};
+    ukv_error_t error = nullptr;
+    /// Backends may report thread-local strings, that the next call on the worker overwrites.
+    std::string error_message;
+    std::mutex mutex;
+    std::condition_variable finished;
+
+    void release() noexcept {
+        if (references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            delete this;
+    }
+
+    void execute() noexcept {
+        run(&error);
+        if (error) {
+            try {
+                error_message = error;
+                error = error_message.c_str();
+            }
+            catch (...) {
+                error = "Failed to copy the error message!";
+            }
+        }
+        if (callback)
+            callback(user_data, error);
+        {
+            std::lock_guard<std::mutex> lock {mutex};
+            ready.store(true, std::memory_order_release);
+        }
+        finished.notify_all();
+        release();
+    }
+};
+
+/**
+ * @brief A plain queue of tasks, guarded by a mutex.
+ * The pool lives until the process exits, draining the queue before joining.
+ */
+class async_pool_t {
+    std::mutex mutex_;
+    std::condition_variable wakeup_;
+    std::deque<async_task_t*> queue_;
+    std::vector<std::thread> threads_;
+    bool stopping_ = false;
+
+    void loop() noexcept {
+        while (true) {
+            async_task_t* task = nullptr;
+            {
+                std::unique_lock<std::mutex> lock {mutex_};
+                wakeup_.wait(lock, [&] { return stopping_ || !queue_.empty(); });
+                if (queue_.empty())
+                    return;
+                task = queue_.front();
+                queue_.pop_front();
+            }
+            task->execute();
+        }
+    }
+
+  public:
+    async_pool_t() {
+        std::size_t count = async_threads_limit.load();
+        count = count ? count : std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+        threads_.reserve(count);
+        for (std::size_t i = 0; i != count; ++i)
+            threads_.emplace_back(&async_pool_t::loop, this);
+    }
+
+    ~async_pool_t() {
+        {
+            std::lock_guard<std::mutex> lock {mutex_};
+            stopping_ = true;
+        }
+        wakeup_.notify_all();
+        for (auto& thread : threads_)
+            thread.join();
+    }
+
+    void submit(async_task_t* task) {
+        {
+            std::lock_guard<std::mutex> lock {mutex_};
+            queue_.push_back(task);
+        }
+        wakeup_.notify_one();
+    }
+};
+
+async_pool_t* async_pool(ukv_error_t* c_error) noexcept {
+    try {
+        static async_pool_t pool;
+        return &pool;
+    }
+    catch (...) {
+        *c_error = "Failed to start the threads pool!";
+        return nullptr;
+    }
+}
+
+template <typename run_at>
+void async_submit(run_at&& run,
+                  ukv_callback_t c_callback,
+                  void* c_user_data,
+                  ukv_future_t* c_future,
+                  ukv_error_t* c_error) noexcept {
+
+    if (c_future)
+        *c_future = nullptr;
+    async_pool_t* pool = async_pool(c_error);
+    if (*c_error)
+        return;
+
+    async_task_t* task = nullptr;
+    try {
+        task = new async_task_t;
+        task->run = std::forward<run_at>(run);
+        task->callback = c_callback;
+        task->user_data = c_user_data;
+        task->references = c_future ? 2 : 1;
+        pool->submit(task);
+    }
+    catch (...) {
+        delete task;
+        *c_error = "Failed to allocate memory!";
+        return;
+    }
+    if (c_future)
+        *c_future = task;
+}
+
+/*********************************************************/
+/*****************	    C Interface 	  ****************/
+/*********************************************************/
+
+void ukv_async_threads_limit(ukv_size_t const c_threads) {
+    async_threads_limit = c_threads;
+}
+
+void ukv_read_async( //
+    ukv_t const c_db,
+    ukv_txn_t const c_txn,
+    ukv_size_t const c_tasks_count,
+
+    ukv_col_t const* c_cols,
+    ukv_size_t const c_cols_stride,
+
+    ukv_key_t const* c_keys,
+    ukv_size_t const c_keys_stride,
+
+    ukv_options_t const c_options,
+
+    ukv_val_ptr_t* c_found_values,
+    ukv_val_len_t** c_found_offsets,
+    ukv_val_len_t** c_found_lengths,
+
+    ukv_arena_t* c_arena,
+    ukv_callback_t c_callback,
+    void* c_user_data,
+    ukv_future_t* c_future,
+    ukv_error_t* c_error) {
+
+    if (!c_db && (*c_error = "DataBase is NULL!"))
+        return;
+    if (!c_arena && (*c_error = "Outputs of asynchronous operations need an arena!"))
+        return;
+
+    auto run = [=](ukv_error_t* error) noexcept {
+        ukv_read(c_db,
+                 c_txn,
+                 c_tasks_count,
+                 c_cols,
+                 c_cols_stride,
+                 c_keys,
+                 c_keys_stride,
+                 c_options,
+                 c_found_values,
+                 c_found_offsets,
+                 c_found_lengths,
+                 c_arena,
+                 error);
+    };
+    async_submit(run, c_callback, c_user_data, c_future, c_error);
+}
+
+void ukv_write_async( //
+    ukv_t const c_db,
+    ukv_txn_t const c_txn,
+    ukv_size_t const c_tasks_count,
+
+    ukv_col_t const* c_cols,
+    ukv_size_t const c_cols_stride,
+
+    ukv_key_t const* c_keys,
+    ukv_size_t const c_keys_stride,
+
+    ukv_val_ptr_t const* c_vals,
+    ukv_size_t const c_vals_stride,
+
+    ukv_val_len_t const* c_offs,
+    ukv_size_t const c_offs_stride,
+
+    ukv_val_len_t const* c_lens,
+    ukv_size_t const c_lens_stride,
+
+    ukv_options_t const c_options,
+
+    ukv_arena_t* c_arena,
+    ukv_callback_t c_callback,
+    void* c_user_data,
+    ukv_future_t* c_future,
+    ukv_error_t* c_error) {
+
+    if (!c_db && (*c_error = "DataBase is NULL!"))
+        return;
+
+    auto run = [=](ukv_error_t* error) noexcept {
+        ukv_write(c_db,
+                  c_txn,
+                  c_tasks_count,
+                  c_cols,
+                  c_cols_stride,
+                  c_keys,
+                  c_keys_stride,
+                  c_vals,
+                  c_vals_stride,
+                  c_offs,
+                  c_offs_stride,
+                  c_lens,
+                  c_lens_stride,
+                  c_options,
+                  c_arena,
+                  error);
+    };
+    async_submit(run, c_callback, c_user_data, c_future, c_error);
+}
+
+void ukv_scan_async( //
+    ukv_t const c_db,
+    ukv_txn_t const c_txn,
+    ukv_size_t const c_tasks_count,
+
+    ukv_col_t const* c_cols,
+    ukv_size_t const c_cols_stride,
+
+    ukv_key_t const* c_min_keys,
+    ukv_size_t const c_min_keys_stride,
+
+    ukv_size_t const* c_scan_lengths,
+    ukv_size_t const c_scan_lengths_stride,
+
+    ukv_options_t const c_options,
+
+    ukv_key_t** c_found_keys,
+    ukv_val_len_t** c_found_lengths,
+
+    ukv_arena_t* c_arena,
+    ukv_callback_t c_callback,
+    void* c_user_data,
+    ukv_future_t* c_future,
+    ukv_error_t* c_error) {
+
+    if (!c_db && (*c_error = "DataBase is NULL!"))
+        return;
+    if (!c_arena && (*c_error = "Outputs of asynchronous operations need an arena!"))
+        return;
+
+    auto run = [=](ukv_error_t* error) noexcept {
+        ukv_scan(c_db,
+                 c_txn,
+                 c_tasks_count,
+                 c_cols,
+                 c_cols_stride,
+                 c_min_keys,
+                 c_min_keys_stride,
+                 c_scan_lengths,
+                 c_scan_lengths_stride,
+                 c_options,
+                 c_found_keys,
+                 c_found_lengths,
+                 c_arena,
+                 error);
+    };
+    async_submit(run, c_callback, c_user_data, c_future, c_error);
+}
+
+bool ukv_future_ready(ukv_future_t const c_future) {
+    if (!c_future)
+        return true;
+    return reinterpret_cast<async_task_t*>(c_future)->ready.load(std::memory_order_acquire);
+}
+
+void ukv_future_wait(ukv_future_t const c_future, ukv_error_t* c_error) {
+    if (!c_future)
+        return;
+    async_task_t& task = *reinterpret_cast<async_task_t*>(c_future);
+    if (!task.ready.load(std::memory_order_acquire)) {
+        std::unique_lock<std::mutex> lock {task.mutex};
+        task.finished.wait(lock, [&] { return task.ready.load(std::memory_order_acquire); });
+    }
+    *c_error = task.error;
+}
+
+void ukv_future_free(ukv_t const, ukv_future_t const c_future) {
+    if (c_future)
+        reinterpret_cast<async_task_t*>(c_future)->release();
+}
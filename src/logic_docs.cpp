@@ -10,7 +10,14 @@
 #include <string>
 #include <string_view>
 #include <unordered_set>
+#include <unordered_map>
 #include <variant>
+#include <map>         // `std::map`
+#include <mutex>       // `std::mutex`
+#include <atomic>      // `std::atomic`
+#include <thread>      // `std::this_thread::yield`
+#include <limits>      // `std::numeric_limits`
+#include <type_traits> // `std::is_invocable_v`
 #include <charconv> // `std::to_chars`
 #include <cstdio>   // `std::snprintf`
 
@@ -18,6 +25,7 @@
 
 // #include "ukv/docs.hpp"
 #include "helpers.hpp"
+#include "msgpack_cursor.hpp"
 
 /*********************************************************/
 /*****************	 C++ Implementation	  ****************/
@@ -68,7 +76,8 @@ struct export_to_value_t final : public nlohmann::detail::output_adapter_protoco
     }
 };
 
-json_t& lookup_field(json_t& json, ukv_str_view_t field, json_t& default_json) noexcept(false) {
+template <typename json_at>
+json_at& lookup_field(json_at& json, ukv_str_view_t field, json_at& default_json) noexcept(false) {
 
     if (!field)
         return json;
@@ -109,6 +118,253 @@ json_t parse_any(value_view_t bytes, ukv_format_t const c_format, ukv_error_t* c
     }
 }
 
+/**
+ * @brief Bounded cache of parsed documents, shared by all the collections in the process.
+ * Every entry keeps the binary representation, it was parsed from, and is only reused if the
+ * freshly read bytes are identical. So updates through any path and any backend invalidate it,
+ * without the logic layer seeing the backend's generations. Entries are evicted in CLOCK order.
+ */
+class docs_cache_t {
+    struct entry_t {
+        col_key_t location;
+        value_t bytes;
+        std::shared_ptr<json_t const> parsed;
+        bool referenced = false;
+    };
+
+    std::mutex mutex_;
+    std::atomic<std::size_t> capacity_ {0};
+    std::vector<entry_t> entries_;
+    std::unordered_map<col_key_t, std::size_t, sub_key_hash_t> index_;
+    std::size_t hand_ = 0;
+
+  public:
+    std::atomic<std::uint64_t> hits {0};
+    std::atomic<std::uint64_t> misses {0};
+
+    bool enabled() const noexcept { return capacity_.load(std::memory_order_relaxed) != 0; }
+
+    void limit(std::size_t capacity) noexcept {
+        std::lock_guard _ {mutex_};
+        capacity_ = capacity;
+        if (entries_.size() <= capacity)
+            return;
+        entries_.clear();
+        index_.clear();
+        hand_ = 0;
+    }
+
+    std::shared_ptr<json_t const> find(col_key_t location, value_view_t bytes) noexcept {
+        std::lock_guard _ {mutex_};
+        auto it = index_.find(location);
+        if (it == index_.end())
+            return {};
+        entry_t& entry = entries_[it->second];
+        value_view_t cached = entry.bytes;
+        if (cached.size() != bytes.size() || std::memcmp(cached.begin(), bytes.begin(), bytes.size()) != 0)
+            return {};
+        entry.referenced = true;
+        return entry.parsed;
+    }
+
+    void insert(col_key_t location, value_view_t bytes, std::shared_ptr<json_t const> parsed) noexcept(false) {
+        std::lock_guard _ {mutex_};
+        std::size_t const capacity = capacity_.load();
+        if (!capacity)
+            return;
+
+        // Refresh the outdated entry, or pick a slot, skipping the recently referenced ones
+        std::size_t slot;
+        auto it = index_.find(location);
+        if (it != index_.end())
+            slot = it->second;
+        else if (entries_.size() < capacity) {
+            slot = entries_.size();
+            entries_.emplace_back();
+            index_.emplace(location, slot);
+        }
+        else {
+            for (; entries_[hand_].referenced; hand_ = (hand_ + 1) % entries_.size())
+                entries_[hand_].referenced = false;
+            slot = std::exchange(hand_, (hand_ + 1) % entries_.size());
+            index_.erase(entries_[slot].location);
+            index_.emplace(location, slot);
+        }
+
+        entry_t& entry = entries_[slot];
+        entry.location = location;
+        entry.bytes = value_t {bytes};
+        entry.parsed = std::move(parsed);
+        entry.referenced = false;
+    }
+};
+
+static docs_cache_t docs_cache;
+
+/**
+ * @brief Parses the internal representation of the document at @p location,
+ * reusing the cached DOM, if the stored @p bytes haven't changed since.
+ */
+std::shared_ptr<json_t const> parse_cached(col_key_t location, value_view_t bytes, ukv_error_t* c_error) noexcept {
+    try {
+        if (docs_cache.enabled() && bytes.size()) {
+            if (auto cached = docs_cache.find(location, bytes); cached) {
+                docs_cache.hits++;
+                return cached;
+            }
+            docs_cache.misses++;
+        }
+
+        auto parsed = std::make_shared<json_t const>(parse_any(bytes, internal_format_k, c_error));
+        if (!*c_error && docs_cache.enabled() && bytes.size())
+            docs_cache.insert(location, bytes, parsed);
+        return parsed;
+    }
+    catch (...) {
+        *c_error = "Out of memory!";
+        return {};
+    }
+}
+
+/**
+ * @brief Decodes a single member of a MessagePack document, located with `msgpack_find`.
+ * Scalars and strings are converted directly, only nested containers are parsed into a DOM.
+ * @return false If the member is malformed.
+ */
+bool msgpack_to_json(std::uint8_t const* begin, std::uint8_t const* end, json_t& result) noexcept(false) {
+    msgpack_item_t item;
+    if (!msgpack_parse_header(begin, end, item))
+        return false;
+
+    switch (item.kind) {
+    case msgpack_kind_t::nil_k: result = nullptr; return true;
+    case msgpack_kind_t::boolean_k: result = item.inlined != 0; return true;
+    case msgpack_kind_t::unsigned_k:
+        result = json_t::number_unsigned_t(item.length ? msgpack_load_be(item.payload, item.length) : item.inlined);
+        return true;
+    case msgpack_kind_t::signed_k: {
+        if (!item.length) {
+            result = static_cast<json_t::number_integer_t>(item.inlined);
+            return true;
+        }
+        // Sign-extend the big-endian integer of any width
+        unsigned const shift = 64 - 8 * static_cast<unsigned>(item.length);
+        auto bits = msgpack_load_be(item.payload, item.length) << shift;
+        result = json_t::number_integer_t(static_cast<std::int64_t>(bits) >> shift);
+        return true;
+    }
+    case msgpack_kind_t::float32_k: {
+        auto bits = static_cast<std::uint32_t>(msgpack_load_be(item.payload, 4));
+        float scalar;
+        std::memcpy(&scalar, &bits, sizeof(scalar));
+        result = json_t::number_float_t(scalar);
+        return true;
+    }
+    case msgpack_kind_t::float64_k: {
+        auto bits = msgpack_load_be(item.payload, 8);
+        double scalar;
+        std::memcpy(&scalar, &bits, sizeof(scalar));
+        result = json_t::number_float_t(scalar);
+        return true;
+    }
+    case msgpack_kind_t::string_k:
+        result = json_t::string_t(reinterpret_cast<char const*>(item.payload), item.length);
+        return true;
+    default: {
+        std::uint8_t const* member_end = msgpack_skip(begin, end);
+        if (!member_end)
+            return false;
+        result = json_t::from_msgpack(begin, member_end, false, false);
+        return !result.is_discarded();
+    }
+    }
+}
+
+/**
+ * @brief Overwrites a scalar member of a MessagePack document, located with `msgpack_find`,
+ * if the new @p value has the same type and fits into the same encoded width. Nothing moves,
+ * so the document doesn't have to be parsed or re-serialized.
+ * @return false If the member can't be updated in place.
+ */
+bool msgpack_assign_scalar(std::uint8_t* begin, std::uint8_t const* end, json_t const& value) noexcept {
+    msgpack_item_t item;
+    if (!msgpack_parse_header(begin, end, item))
+        return false;
+
+    auto payload = const_cast<std::uint8_t*>(item.payload);
+    switch (item.kind) {
+    case msgpack_kind_t::boolean_k:
+        if (!value.is_boolean())
+            return false;
+        *begin = value.get<json_t::boolean_t>() ? 0xC3 : 0xC2;
+        return true;
+
+    case msgpack_kind_t::unsigned_k:
+    case msgpack_kind_t::signed_k: {
+        if (!value.is_number_integer())
+            return false;
+        auto number = value.is_number_unsigned() ? 0 : value.get<json_t::number_integer_t>();
+        bool const is_negative = number < 0;
+        auto bits = is_negative ? static_cast<std::uint64_t>(number) : value.get<json_t::number_unsigned_t>();
+        bool const is_unsigned = item.kind == msgpack_kind_t::unsigned_k;
+
+        // Positive and negative "fixint"s keep the value in the header byte
+        if (!item.length) {
+            bool fits = is_unsigned ? !is_negative && bits <= 0x7F : is_negative && number >= -32;
+            if (fits)
+                *begin = static_cast<std::uint8_t>(bits);
+            return fits;
+        }
+
+        unsigned const width_bits = 8 * static_cast<unsigned>(item.length);
+        bool fits;
+        if (is_unsigned)
+            fits = !is_negative && (width_bits == 64 || !(bits >> width_bits));
+        else if (!is_negative && bits > static_cast<std::uint64_t>(INT64_MAX))
+            fits = false;
+        else {
+            auto limit = width_bits == 64 ? 0 : std::int64_t(1) << (width_bits - 1);
+            auto signed_bits = static_cast<std::int64_t>(bits);
+            fits = width_bits == 64 || (signed_bits >= -limit && signed_bits < limit);
+        }
+        if (fits)
+            msgpack_store_be(payload, item.length, bits);
+        return fits;
+    }
+
+    case msgpack_kind_t::float32_k: {
+        if (!value.is_number_float())
+            return false;
+        auto number = value.get<json_t::number_float_t>();
+        auto scalar = static_cast<float>(number);
+        if (scalar != number && number == number)
+            return false;
+        std::uint32_t bits;
+        std::memcpy(&bits, &scalar, sizeof(bits));
+        msgpack_store_be(payload, sizeof(bits), bits);
+        return true;
+    }
+
+    case msgpack_kind_t::float64_k: {
+        if (!value.is_number_float())
+            return false;
+        auto scalar = value.get<json_t::number_float_t>();
+        std::uint64_t bits;
+        std::memcpy(&bits, &scalar, sizeof(bits));
+        msgpack_store_be(payload, sizeof(bits), bits);
+        return true;
+    }
+
+    default: return false;
+    }
+}
+
+/**
+ * @brief Callbacks, that can't modify the parsed documents, are fed from `docs_cache`.
+ */
+template <typename callback_at>
+constexpr bool is_read_only_k = std::is_invocable_v<callback_at, ukv_size_t, ukv_str_view_t, json_t const&>;
+
 /**
  * The JSON package provides a number of simple interfaces, which only work with simplest STL types
  * and always allocate the output objects, without the ability to reuse previously allocated memory,
@@ -191,154 +447,818 @@ class serializing_tape_ref_t {
     tape_view_t view() const noexcept { return arena_.growing_tape; }
 };
 
-template <typename callback_at>
-read_tasks_soa_t const& read_unique_docs( //
+/*********************************************************/
+/*****************	 Shredded Collections  ****************/
+/*********************************************************/
+
+/**
+ * @brief Top-level member of documents, that is stored in a separate
+ * collection of fixed-width scalars of @c `type`, keyed by document IDs.
+ * A missing entry in the @c `column` means the member stayed in the residual document.
+ */
+struct shredded_field_t {
+    std::string name;
+    ukv_type_t type = ukv_type_any_k;
+    ukv_col_t column = 0;
+};
+
+using shredding_t = std::vector<shredded_field_t>;
+
+/**
+ * @brief Process-wide registry of per-collection document layouts, like shreddings
+ * @see `ukv_docs_shred` and secondary indexes @see `ukv_docs_index_create`.
+ * Layouts are immutable once registered, so readers only hold a shared pointer,
+ * and the common case of no registered collections at all costs a single atomic load.
+ */
+template <typename layout_at>
+class docs_registry_gt {
+    std::mutex mutex_;
+    std::map<std::pair<ukv_t, ukv_col_t>, std::shared_ptr<layout_at const>> layouts_;
+    std::atomic<std::size_t> count_ {0};
+
+  public:
+    bool any() const noexcept { return count_.load(std::memory_order_relaxed) != 0; }
+
+    std::shared_ptr<layout_at const> find(ukv_t db, ukv_col_t col) noexcept {
+        if (!any())
+            return {};
+        std::lock_guard<std::mutex> lock {mutex_};
+        auto it = layouts_.find({db, col});
+        return it != layouts_.end() ? it->second : nullptr;
+    }
+
+    /**
+     * @brief Replaces the layout of a collection with the one, produced by @p make
+     * from the current layout, which may be NULL. Returning NULL unregisters the collection.
+     */
+    template <typename callback_at>
+    void update(ukv_t db, ukv_col_t col, callback_at&& make) noexcept(false) {
+        std::lock_guard<std::mutex> lock {mutex_};
+        auto it = layouts_.find({db, col});
+        std::shared_ptr<layout_at const> layout = make(it != layouts_.end() ? it->second : nullptr);
+        if (layout)
+            layouts_[{db, col}] = std::move(layout);
+        else if (it != layouts_.end())
+            layouts_.erase(it);
+        count_.store(layouts_.size());
+    }
+
+    void assign(ukv_t db, ukv_col_t col, std::shared_ptr<layout_at const> layout) noexcept(false) {
+        update(db, col, [&](auto const&) { return std::move(layout); });
+    }
+};
+
+static docs_registry_gt<shredding_t> docs_shreddings;
+
+/**
+ * @brief Resolves the layouts of collections, mentioned in a batch, memorizing
+ * the last one, as most batches target a single collection.
+ * @return True, if any of the tasks targets a registered collection.
+ */
+template <typename tasks_at, typename layout_at>
+bool find_layouts(docs_registry_gt<layout_at>& registry,
+                  ukv_t const c_db,
+                  tasks_at const& tasks,
+                  std::vector<std::shared_ptr<layout_at const>>& layouts) noexcept(false) {
+    if (!registry.any())
+        return false;
+
+    layouts.resize(tasks.count);
+    bool found_any = false;
+    for (ukv_size_t task_idx = 0; task_idx != tasks.count; ++task_idx) {
+        ukv_col_t col = tasks[task_idx].col;
+        if (task_idx && col == tasks[task_idx - 1].col)
+            layouts[task_idx] = layouts[task_idx - 1];
+        else
+            layouts[task_idx] = registry.find(c_db, col);
+        found_any |= layouts[task_idx] != nullptr;
+    }
+    return found_any;
+}
+
+std::size_t shredded_width(ukv_type_t type) noexcept {
+    switch (type) {
+    case ukv_type_bool_k: return sizeof(bool);
+    case ukv_type_i8_k: return sizeof(std::int8_t);
+    case ukv_type_i16_k: return sizeof(std::int16_t);
+    case ukv_type_i32_k: return sizeof(std::int32_t);
+    case ukv_type_i64_k: return sizeof(std::int64_t);
+    case ukv_type_u8_k: return sizeof(std::uint8_t);
+    case ukv_type_u16_k: return sizeof(std::uint16_t);
+    case ukv_type_u32_k: return sizeof(std::uint32_t);
+    case ukv_type_u64_k: return sizeof(std::uint64_t);
+    case ukv_type_f32_k: return sizeof(float);
+    case ukv_type_f64_k: return sizeof(double);
+    default: return 0;
+    }
+}
+
+/**
+ * @brief Converts a member into a scalar of the column type, only if the document
+ * can later be reassembled exactly. So integers never land in floating-point columns,
+ * and out-of-range values stay in the residual document.
+ */
+template <typename scalar_at>
+bool shred_scalar(json_t const& value, byte_t* output) noexcept {
+    scalar_at scalar;
+    if constexpr (std::is_same_v<scalar_at, bool>) {
+        if (!value.is_boolean())
+            return false;
+        scalar = value.get<json_t::boolean_t>();
+    }
+    else if constexpr (std::is_integral_v<scalar_at>) {
+        using limits_t = std::numeric_limits<scalar_at>;
+        if (value.is_number_unsigned()) {
+            auto number = value.get<json_t::number_unsigned_t>();
+            if (number > static_cast<json_t::number_unsigned_t>(limits_t::max()))
+                return false;
+            scalar = static_cast<scalar_at>(number);
+        }
+        else if (value.is_number_integer()) {
+            auto number = value.get<json_t::number_integer_t>();
+            if (number < 0 ? (!limits_t::is_signed || number < static_cast<json_t::number_integer_t>(limits_t::min()))
+                           : static_cast<json_t::number_unsigned_t>(number) > limits_t::max())
+                return false;
+            scalar = static_cast<scalar_at>(number);
+        }
+        else
+            return false;
+    }
+    else {
+        if (!value.is_number_float())
+            return false;
+        auto number = value.get<json_t::number_float_t>();
+        scalar = static_cast<scalar_at>(number);
+        if (scalar != number && number == number)
+            return false;
+    }
+    std::memcpy(output, &scalar, sizeof(scalar_at));
+    return true;
+}
+
+bool shred_scalar(json_t const& value, ukv_type_t type, byte_t* output) noexcept {
+    switch (type) {
+    case ukv_type_bool_k: return shred_scalar<bool>(value, output);
+    case ukv_type_i8_k: return shred_scalar<std::int8_t>(value, output);
+    case ukv_type_i16_k: return shred_scalar<std::int16_t>(value, output);
+    case ukv_type_i32_k: return shred_scalar<std::int32_t>(value, output);
+    case ukv_type_i64_k: return shred_scalar<std::int64_t>(value, output);
+    case ukv_type_u8_k: return shred_scalar<std::uint8_t>(value, output);
+    case ukv_type_u16_k: return shred_scalar<std::uint16_t>(value, output);
+    case ukv_type_u32_k: return shred_scalar<std::uint32_t>(value, output);
+    case ukv_type_u64_k: return shred_scalar<std::uint64_t>(value, output);
+    case ukv_type_f32_k: return shred_scalar<float>(value, output);
+    case ukv_type_f64_k: return shred_scalar<double>(value, output);
+    default: return false;
+    }
+}
+
+template <typename scalar_at>
+json_t unshred_scalar(byte_t const* input) noexcept {
+    scalar_at scalar;
+    std::memcpy(&scalar, input, sizeof(scalar_at));
+    return json_t(scalar);
+}
+
+json_t unshred_scalar(byte_t const* input, ukv_type_t type) noexcept {
+    switch (type) {
+    case ukv_type_bool_k: return unshred_scalar<bool>(input);
+    case ukv_type_i8_k: return unshred_scalar<std::int8_t>(input);
+    case ukv_type_i16_k: return unshred_scalar<std::int16_t>(input);
+    case ukv_type_i32_k: return unshred_scalar<std::int32_t>(input);
+    case ukv_type_i64_k: return unshred_scalar<std::int64_t>(input);
+    case ukv_type_u8_k: return unshred_scalar<std::uint8_t>(input);
+    case ukv_type_u16_k: return unshred_scalar<std::uint16_t>(input);
+    case ukv_type_u32_k: return unshred_scalar<std::uint32_t>(input);
+    case ukv_type_u64_k: return unshred_scalar<std::uint64_t>(input);
+    case ukv_type_f32_k: return unshred_scalar<float>(input);
+    case ukv_type_f64_k: return unshred_scalar<double>(input);
+    default: return {};
+    }
+}
+
+/**
+ * @brief Drop-in replacement for `ukv_read` of binary documents, that reassembles the
+ * documents of shredded collections. Columns are fetched first, as every read reuses
+ * the output tape of the arena, and the merged documents are exported on `shredded_tape`.
+ */
+tape_view_t read_binary_docs( //
     ukv_t const c_db,
     ukv_txn_t const c_txn,
     read_tasks_soa_t const& tasks,
-    strided_iterator_gt<ukv_str_view_t const> fields,
     ukv_options_t const c_options,
     stl_arena_t& arena,
-    ukv_error_t* c_error,
-    callback_at callback) noexcept {
+    ukv_error_t* c_error) noexcept {
 
     ukv_arena_t arena_ptr = &arena;
     ukv_val_ptr_t binary_docs_begin = nullptr;
     ukv_val_len_t* binary_docs_offs = nullptr;
     ukv_val_len_t* binary_docs_lens = nullptr;
-    ukv_read( //
-        c_db,
-        c_txn,
-        tasks.count,
-        tasks.cols.get(),
-        tasks.cols.stride(),
-        tasks.keys.get(),
-        tasks.keys.stride(),
-        c_options,
-        &binary_docs_begin,
-        &binary_docs_offs,
-        &binary_docs_lens,
-        &arena_ptr,
-        c_error);
-
-    auto binary_docs = tape_view_t(binary_docs_begin, binary_docs_offs, binary_docs_lens, tasks.count);
-    auto binary_docs_it = binary_docs.begin();
+    auto read_residuals = [&](ukv_options_t options) {
+        ukv_read( //
+            c_db,
+            c_txn,
+            tasks.count,
+            tasks.cols.get(),
+            tasks.cols.stride(),
+            tasks.keys.get(),
+            tasks.keys.stride(),
+            options,
+            &binary_docs_begin,
+            &binary_docs_offs,
+            &binary_docs_lens,
+            &arena_ptr,
+            c_error);
+        return tape_view_t(binary_docs_begin, binary_docs_offs, binary_docs_lens, tasks.count);
+    };
 
-    for (ukv_size_t task_idx = 0; task_idx != tasks.count; ++task_idx, ++binary_docs_it) {
-        value_view_t binary_doc = *binary_docs_it;
-        json_t parsed = parse_any(binary_doc, internal_format_k, c_error);
+    try {
+        std::vector<std::shared_ptr<shredding_t const>> layouts;
+        if (!find_layouts(docs_shreddings, c_db, tasks, layouts))
+            return read_residuals(c_options);
+
+        // To reassemble the documents we need their contents, even if only lengths were requested
+        auto options = static_cast<ukv_options_t>(c_options & ~ukv_option_read_lengths_k);
+
+        // Fetch the values of all columns of all shredded documents at once
+        std::vector<col_key_t> cells;
+        for (ukv_size_t task_idx = 0; task_idx != tasks.count; ++task_idx)
+            if (layouts[task_idx])
+                for (shredded_field_t const& field : *layouts[task_idx])
+                    cells.push_back({field.column, tasks[task_idx].key});
+
+        ukv_val_ptr_t cells_begin = nullptr;
+        ukv_val_len_t* cells_offs = nullptr;
+        ukv_val_len_t* cells_lens = nullptr;
+        ukv_read( //
+            c_db,
+            c_txn,
+            static_cast<ukv_size_t>(cells.size()),
+            &cells[0].col,
+            sizeof(col_key_t),
+            &cells[0].key,
+            sizeof(col_key_t),
+            options,
+            &cells_begin,
+            &cells_offs,
+            &cells_lens,
+            &arena_ptr,
+            c_error);
+        if (*c_error)
+            return {};
+
+        // Fixed-width cells are small enough to be copied out before the next read
+        std::vector<std::uint64_t> cells_scalars(cells.size());
+        std::vector<bool> cells_present(cells.size());
+        tape_view_t cells_tape {cells_begin, cells_offs, cells_lens, static_cast<ukv_size_t>(cells.size())};
+        tape_iterator_t cells_it = cells_tape.begin();
+        for (std::size_t cell_idx = 0; cell_idx != cells.size(); ++cell_idx, ++cells_it) {
+            value_view_t cell = *cells_it;
+            cells_present[cell_idx] = cell && cell.size() <= sizeof(std::uint64_t);
+            if (cells_present[cell_idx])
+                std::memcpy(&cells_scalars[cell_idx], cell.begin(), cell.size());
+        }
 
-        // This error is extremely unlikely, as we have previously accepted the data into the store.
+        tape_view_t residuals = read_residuals(options);
         if (*c_error)
-            return tasks;
+            return {};
+
+        auto exporter = std::make_shared<export_to_value_t>();
+        value_t merged;
+        arena.shredded_tape.clear();
+        tape_iterator_t residuals_it = residuals.begin();
+        std::size_t cell_idx = 0;
+        for (ukv_size_t task_idx = 0; task_idx != tasks.count; ++task_idx, ++residuals_it) {
+            value_view_t residual = *residuals_it;
+            shredding_t const* layout = layouts[task_idx].get();
+            if (!layout || !residual) {
+                arena.shredded_tape.push_back(residual);
+                if (!residual)
+                    arena.shredded_tape.lengths()[task_idx] = ukv_val_len_missing_k;
+                cell_idx += layout ? layout->size() : 0;
+                continue;
+            }
 
-        ukv_str_view_t field = fields[task_idx];
-        callback(task_idx, field, parsed);
+            json_t parsed = parse_any(residual, internal_format_k, c_error);
+            if (*c_error)
+                return {};
+            for (shredded_field_t const& field : *layout) {
+                if (cells_present[cell_idx] && parsed.is_object())
+                    parsed[field.name] =
+                        unshred_scalar(reinterpret_cast<byte_t const*>(&cells_scalars[cell_idx]), field.type);
+                ++cell_idx;
+            }
+
+            merged.clear();
+            exporter->value_ptr = &merged;
+            dump_any(parsed, internal_format_k, exporter, c_error);
+            if (*c_error)
+                return {};
+            arena.shredded_tape.push_back(merged);
+        }
+        return arena.shredded_tape;
+    }
+    catch (std::bad_alloc const&) {
+        *c_error = "Out of memory!";
+        return {};
     }
+}
 
-    return tasks;
+/*********************************************************/
+/*****************	 Secondary Indexes	  ****************/
+/*********************************************************/
+
+/**
+ * @brief Ordered index of an integer member of documents. Every entry of the
+ * index collection is keyed by a value of the member and contains a sorted array
+ * of IDs of documents, that have it. So range lookups are just scans of that collection.
+ */
+struct doc_index_t {
+    std::string field;
+    std::string name;
+    ukv_col_t collection = 0;
+};
+
+using doc_indexes_t = std::vector<doc_index_t>;
+using index_lists_t = std::map<col_key_t, std::vector<ukv_key_t>>;
+
+static docs_registry_gt<doc_indexes_t> docs_indexes;
+
+constexpr ukv_size_t docs_index_scan_k = 4 * 1024;
+
+/// Attempts of the internal transaction of `write_binary_docs`, before reporting a conflict.
+constexpr std::size_t docs_index_attempts_k = 16;
+
+/// Frees the internal transaction of `write_binary_docs` on every exit, including exceptions.
+struct owned_txn_t {
+    ukv_t db = nullptr;
+    ukv_txn_t txn = nullptr;
+    ~owned_txn_t() {
+        if (txn)
+            ukv_txn_free(db, txn);
+    }
+};
+
+/**
+ * @brief Extracts the indexed member of a binary document. Only integers are indexed,
+ * except for the maximum value, which is reserved for `ukv_key_unknown_k`.
+ */
+bool indexed_value(value_view_t doc, doc_index_t const& index, ukv_key_t& value) noexcept(false) {
+    auto begin = reinterpret_cast<std::uint8_t const*>(doc.begin());
+    auto end = begin + doc.size();
+    auto member = msgpack_find(begin, end, index.field.c_str());
+    json_t number;
+    if (!member || !msgpack_to_json(member, end, number))
+        return false;
+
+    if (number.is_number_unsigned()) {
+        auto unsigned_value = number.get<json_t::number_unsigned_t>();
+        value = static_cast<ukv_key_t>(unsigned_value);
+        return unsigned_value < static_cast<json_t::number_unsigned_t>(ukv_key_unknown_k);
+    }
+    if (number.is_number_integer()) {
+        value = number.get<json_t::number_integer_t>();
+        return value != ukv_key_unknown_k;
+    }
+    return false;
 }
 
-template <typename callback_at>
-read_tasks_soa_t read_docs( //
+/**
+ * @brief Prepares the updated lists of secondary indexes, affected by a batch of writes.
+ * Previous versions of documents are read through the same transaction, to find
+ * the lists, they must leave. Repeated writes of the same document apply in order.
+ * Inside of a transaction, all of those reads are tracked, so if a concurrent writer
+ * changes the documents or the lists, the commit fails instead of losing its update.
+ */
+void update_indexes( //
     ukv_t const c_db,
     ukv_txn_t const c_txn,
-    read_tasks_soa_t const& tasks,
-    strided_iterator_gt<ukv_str_view_t const> fields,
-    ukv_options_t const c_options,
+    write_tasks_soa_t const& tasks,
+    std::vector<std::shared_ptr<doc_indexes_t const>> const& indexes,
     stl_arena_t& arena,
-    ukv_error_t* c_error,
-    callback_at callback) {
-
-    // Handle the common case of requesting the non-colliding
-    // all-ascending input sequences of document IDs received
-    // during scans without the sort and extra memory.
-    if (all_ascending(tasks.keys, tasks.count))
-        return read_unique_docs(c_db, c_txn, tasks, fields, c_options, arena, c_error, callback);
-
-    // If it's not one of the trivial consecutive lookups, we want
-    // to sort & deduplicate the entries to minimize the random reads
-    // from disk.
-    prepare_memory(arena.updated_keys, tasks.count, c_error);
+    index_lists_t& lists,
+    ukv_error_t* c_error) noexcept(false) {
+
+    // Every task gets a slot per index of its collection
+    std::vector<std::size_t> first_slots(tasks.count + 1);
+    for (ukv_size_t task_idx = 0; task_idx != tasks.count; ++task_idx)
+        first_slots[task_idx + 1] = first_slots[task_idx] + (indexes[task_idx] ? indexes[task_idx]->size() : 0);
+    std::vector<std::optional<ukv_key_t>> old_values(first_slots.back());
+    std::vector<std::optional<ukv_key_t>> new_values(first_slots.back());
+
+    ukv_options_t const read_options = c_txn ? ukv_option_read_track_k : ukv_options_default_k;
+    read_tasks_soa_t previous_tasks {tasks.cols, tasks.keys, tasks.count};
+    tape_view_t previous_docs = read_binary_docs(c_db, c_txn, previous_tasks, read_options, arena, c_error);
     if (*c_error)
-        return tasks;
-    for (ukv_size_t doc_idx = 0; doc_idx != tasks.count; ++doc_idx)
-        arena.updated_keys[doc_idx] = tasks[doc_idx].location();
-    sort_and_deduplicate(arena.updated_keys);
+        return;
 
-    // There is a chance, all the entries are unique.
-    // In such case, let's free-up the memory.
-    if (arena.updated_keys.size() == tasks.count) {
-        arena.updated_keys.clear();
-        return read_unique_docs(c_db, c_txn, tasks, fields, c_options, arena, c_error, callback);
+    std::unordered_map<col_key_t, ukv_size_t, sub_key_hash_t> last_writes;
+    tape_iterator_t previous_docs_it = previous_docs.begin();
+    for (ukv_size_t task_idx = 0; task_idx != tasks.count; ++task_idx, ++previous_docs_it) {
+        doc_indexes_t const* doc_indexes = indexes[task_idx].get();
+        if (!doc_indexes)
+            continue;
+
+        write_task_t task = tasks[task_idx];
+        auto last_write = last_writes.find(task.location());
+        bool was_written = last_write != last_writes.end() && indexes[last_write->second] == indexes[task_idx];
+        for (std::size_t index_idx = 0; index_idx != doc_indexes->size(); ++index_idx) {
+            doc_index_t const& index = (*doc_indexes)[index_idx];
+            std::size_t slot = first_slots[task_idx] + index_idx;
+            ukv_key_t value;
+            if (was_written)
+                old_values[slot] = new_values[first_slots[last_write->second] + index_idx];
+            else if (indexed_value(*previous_docs_it, index, value))
+                old_values[slot] = value;
+            if (!task.is_deleted() && indexed_value(task.view(), index, value))
+                new_values[slot] = value;
+
+            if (old_values[slot])
+                lists.emplace(col_key_t {index.collection, *old_values[slot]}, std::vector<ukv_key_t> {});
+            if (new_values[slot])
+                lists.emplace(col_key_t {index.collection, *new_values[slot]}, std::vector<ukv_key_t> {});
+        }
+        last_writes[task.location()] = task_idx;
     }
+    if (lists.empty())
+        return;
+
+    // Fetch the current lists at once
+    std::vector<col_key_t> locations;
+    locations.reserve(lists.size());
+    for (auto const& location_and_keys : lists)
+        locations.push_back(location_and_keys.first);
 
-    // Otherwise, let's retrieve the sublist of unique docs,
-    // which may be in a very different order from original.
     ukv_arena_t arena_ptr = &arena;
-    ukv_val_ptr_t binary_docs_begin = nullptr;
-    ukv_val_len_t* binary_docs_offs = nullptr;
-    ukv_val_len_t* binary_docs_lens = nullptr;
-    ukv_size_t unique_docs_count = static_cast<ukv_size_t>(arena.updated_keys.size());
+    ukv_val_ptr_t found_values = nullptr;
+    ukv_val_len_t* found_offsets = nullptr;
+    ukv_val_len_t* found_lengths = nullptr;
     ukv_read( //
         c_db,
         c_txn,
-        unique_docs_count,
-        &arena.updated_keys[0].col,
+        static_cast<ukv_size_t>(locations.size()),
+        &locations[0].col,
         sizeof(col_key_t),
-        &arena.updated_keys[0].key,
+        &locations[0].key,
         sizeof(col_key_t),
-        c_options,
-        &binary_docs_begin,
-        &binary_docs_offs,
-        &binary_docs_lens,
+        read_options,
+        &found_values,
+        &found_offsets,
+        &found_lengths,
         &arena_ptr,
         c_error);
+    if (*c_error)
+        return;
 
-    // We will later need to locate the data for every separate request.
-    // Doing it in O(N) tape iterations every time is too slow.
-    // Once we transform to inclusive sums, it will be O(1).
-    //      inplace_inclusive_prefix_sum(binary_docs_lens, binary_docs_lens + binary_docs_count);
-    // Alternatively we can compensate it with additional memory:
-    std::optional<std::vector<json_t>> parsed_docs;
-    try {
-        parsed_docs = std::vector<json_t>(tasks.count);
-    }
-    catch (std::bad_alloc const&) {
-        *c_error = "Out of memory!";
-        return tasks;
-    }
-
-    // Parse all the unique documents
-    auto binary_docs = tape_view_t(binary_docs_begin, binary_docs_offs, binary_docs_lens, tasks.count);
-    auto binary_docs_it = binary_docs.begin();
-    for (ukv_size_t doc_idx = 0; doc_idx != unique_docs_count; ++doc_idx, ++binary_docs_it) {
-        value_view_t binary_doc = *binary_docs_it;
-        json_t& parsed = (*parsed_docs)[doc_idx];
-        parsed = parse_any(binary_doc, internal_format_k, c_error);
-
-        // This error is extremely unlikely, as we have previously accepted the data into the store.
-        if (*c_error)
-            return tasks;
+    tape_iterator_t found_it {found_values, found_offsets, found_lengths};
+    for (auto& location_and_keys : lists) {
+        value_view_t found = *found_it;
+        std::vector<ukv_key_t>& keys = location_and_keys.second;
+        keys.resize(found.size() / sizeof(ukv_key_t));
+        std::memcpy(keys.data(), found.begin(), keys.size() * sizeof(ukv_key_t));
+        ++found_it;
     }
 
-    // Join docs and fields with binary search
+    // Move the documents between the lists. Unchanged values still make sure the document
+    // is listed, repairing the lists after commits, that only partially reached the shards.
     for (ukv_size_t task_idx = 0; task_idx != tasks.count; ++task_idx) {
-        auto task = tasks[task_idx];
-        auto parsed_idx = offset_in_sorted(arena.updated_keys, task.location());
-        json_t& parsed = (*parsed_docs)[parsed_idx];
-        ukv_str_view_t field = fields[task_idx];
-        callback(task_idx, field, parsed);
+        doc_indexes_t const* doc_indexes = indexes[task_idx].get();
+        for (std::size_t index_idx = 0; doc_indexes && index_idx != doc_indexes->size(); ++index_idx) {
+            std::size_t slot = first_slots[task_idx] + index_idx;
+            ukv_col_t index_col = (*doc_indexes)[index_idx].collection;
+            ukv_key_t doc_key = tasks.keys[task_idx];
+            if (old_values[slot] && old_values[slot] != new_values[slot]) {
+                std::vector<ukv_key_t>& keys = lists[{index_col, *old_values[slot]}];
+                auto it = std::lower_bound(keys.begin(), keys.end(), doc_key);
+                if (it != keys.end() && *it == doc_key)
+                    keys.erase(it);
+            }
+            if (new_values[slot]) {
+                std::vector<ukv_key_t>& keys = lists[{index_col, *new_values[slot]}];
+                auto it = std::lower_bound(keys.begin(), keys.end(), doc_key);
+                if (it == keys.end() || *it != doc_key)
+                    keys.insert(it, doc_key);
+            }
+        }
     }
-
-    auto cnt = static_cast<ukv_size_t>(arena.updated_keys.size());
-    auto sub_keys_range = strided_range(arena.updated_keys).immutable();
-    strided_range_gt<ukv_col_t const> cols = sub_keys_range.members(&col_key_t::col);
-    strided_range_gt<ukv_key_t const> keys = sub_keys_range.members(&col_key_t::key);
-    return {cols.begin(), keys.begin(), cnt};
 }
 
-void replace_docs( //
+/**
+ * @brief Drop-in replacement for `ukv_write` of binary documents, that splits the
+ * documents of shredded collections into residual parts and column cells, and
+ * writes all of them in one batch, so atomicity is preserved. Deletions remove
+ * the cells as well, just like members that can't be shredded anymore.
+ * Updates of secondary indexes join the same batch. Those are read-modify-writes
+ * of the shared lists, so without a transaction from the caller the batch runs in
+ * an internal one, repeated on conflicts. Backends without transactions only get
+ * the atomicity of the single batch.
+ */
+void write_binary_docs( //
+    ukv_t const c_db,
+    ukv_txn_t const c_txn,
+    write_tasks_soa_t const& tasks,
+    ukv_options_t const c_options,
+    stl_arena_t& arena,
+    ukv_error_t* c_error) noexcept {
+
+    ukv_arena_t arena_ptr = &arena;
+    try {
+        std::vector<std::shared_ptr<shredding_t const>> layouts;
+        std::vector<std::shared_ptr<doc_indexes_t const>> indexes;
+        bool is_shredded = find_layouts(docs_shreddings, c_db, tasks, layouts);
+        bool is_indexed = find_layouts(docs_indexes, c_db, tasks, indexes);
+        if (!is_shredded && !is_indexed)
+            return ukv_write( //
+                c_db,
+                c_txn,
+                tasks.count,
+                tasks.cols.get(),
+                tasks.cols.stride(),
+                tasks.keys.get(),
+                tasks.keys.stride(),
+                tasks.vals.get(),
+                tasks.vals.stride(),
+                tasks.offs.get(),
+                tasks.offs.stride(),
+                tasks.lens.get(),
+                tasks.lens.stride(),
+                c_options,
+                &arena_ptr,
+                c_error);
+
+        std::size_t count_cells = 0;
+        for (auto const& layout : layouts)
+            count_cells += layout ? layout->size() : 0;
+
+        // Pointers into those buffers are passed to the backend, so they must not grow
+        std::size_t count_entries = tasks.count + count_cells;
+        std::vector<col_key_t> locations;
+        std::vector<ukv_val_ptr_t> vals;
+        std::vector<ukv_val_len_t> lens;
+        std::vector<value_t> residuals(tasks.count);
+        std::vector<std::uint64_t> cells_scalars(count_cells);
+        locations.reserve(count_entries);
+        vals.reserve(count_entries);
+        lens.reserve(count_entries);
+
+        auto exporter = std::make_shared<export_to_value_t>();
+        std::size_t cell_idx = 0;
+        for (ukv_size_t task_idx = 0; task_idx != tasks.count; ++task_idx) {
+            write_task_t task = tasks[task_idx];
+            shredding_t const* layout = is_shredded ? layouts[task_idx].get() : nullptr;
+            locations.push_back(task.location());
+            vals.push_back(task.is_deleted() ? nullptr : ukv_val_ptr_t(task.view().begin()));
+            lens.push_back(static_cast<ukv_val_len_t>(task.view().size()));
+            if (!layout)
+                continue;
+            if (task.is_deleted()) {
+                for (shredded_field_t const& field : *layout) {
+                    locations.push_back({field.column, task.key});
+                    vals.push_back(nullptr);
+                    lens.push_back(0);
+                }
+                cell_idx += layout->size();
+                continue;
+            }
+
+            std::size_t residual_idx = vals.size() - 1;
+            json_t parsed = parse_any(task.view(), internal_format_k, c_error);
+            if (*c_error)
+                return;
+            for (shredded_field_t const& field : *layout) {
+                auto cell = reinterpret_cast<byte_t*>(&cells_scalars[cell_idx++]);
+                auto it = parsed.find(field.name);
+                bool shredded = it != parsed.end() && shred_scalar(it.value(), field.type, cell);
+                if (shredded)
+                    parsed.erase(it);
+                locations.push_back({field.column, task.key});
+                vals.push_back(shredded ? reinterpret_cast<ukv_val_ptr_t>(cell) : nullptr);
+                lens.push_back(shredded ? static_cast<ukv_val_len_t>(shredded_width(field.type)) : 0);
+            }
+
+            value_t& residual = residuals[task_idx];
+            exporter->value_ptr = &residual;
+            dump_any(parsed, internal_format_k, exporter, c_error);
+            if (*c_error)
+                return;
+            vals[residual_idx] = reinterpret_cast<ukv_val_ptr_t>(residual.begin());
+            lens[residual_idx] = static_cast<ukv_val_len_t>(residual.size());
+        }
+
+        if (!is_indexed)
+            return ukv_write( //
+                c_db,
+                c_txn,
+                static_cast<ukv_size_t>(locations.size()),
+                &locations[0].col,
+                sizeof(col_key_t),
+                &locations[0].key,
+                sizeof(col_key_t),
+                vals.data(),
+                sizeof(ukv_val_ptr_t),
+                nullptr,
+                0,
+                lens.data(),
+                sizeof(ukv_val_len_t),
+                c_options,
+                &arena_ptr,
+                c_error);
+
+        // Without the caller's transaction, try an internal one
+        owned_txn_t owned {c_db};
+        if (!c_txn) {
+            ukv_txn_begin(c_db, 0, ukv_options_default_k, &owned.txn, c_error);
+            if (*c_error) {
+                ukv_error_free(std::exchange(*c_error, nullptr));
+                owned.txn = nullptr;
+            }
+        }
+
+        std::size_t const docs_entries = locations.size();
+        index_lists_t lists;
+        for (std::size_t attempt = 1;; ++attempt) {
+            ukv_txn_t const txn = c_txn ? c_txn : owned.txn;
+            lists.clear();
+            locations.resize(docs_entries);
+            vals.resize(docs_entries);
+            lens.resize(docs_entries);
+            update_indexes(c_db, txn, tasks, indexes, arena, lists, c_error);
+
+            // Emptied lists of indexes are removed
+            if (!*c_error) {
+                for (auto& location_and_keys : lists) {
+                    std::vector<ukv_key_t>& keys = location_and_keys.second;
+                    locations.push_back(location_and_keys.first);
+                    vals.push_back(keys.empty() ? nullptr : reinterpret_cast<ukv_val_ptr_t>(keys.data()));
+                    lens.push_back(static_cast<ukv_val_len_t>(keys.size() * sizeof(ukv_key_t)));
+                }
+                ukv_write( //
+                    c_db,
+                    txn,
+                    static_cast<ukv_size_t>(locations.size()),
+                    &locations[0].col,
+                    sizeof(col_key_t),
+                    &locations[0].key,
+                    sizeof(col_key_t),
+                    vals.data(),
+                    sizeof(ukv_val_ptr_t),
+                    nullptr,
+                    0,
+                    lens.data(),
+                    sizeof(ukv_val_len_t),
+                    c_options,
+                    &arena_ptr,
+                    c_error);
+            }
+            if (!*c_error && owned.txn)
+                ukv_txn_commit(owned.txn, c_options, c_error);
+
+            // Concurrent writers may have changed the same documents or lists, so start over
+            if (!*c_error || !owned.txn || attempt == docs_index_attempts_k)
+                break;
+            ukv_error_free(std::exchange(*c_error, nullptr));
+            std::this_thread::yield();
+            ukv_txn_begin(c_db, 0, ukv_options_default_k, &owned.txn, c_error);
+            if (*c_error)
+                break;
+        }
+    }
+    catch (std::bad_alloc const&) {
+        *c_error = "Out of memory!";
+    }
+}
+
+template <typename callback_at>
+read_tasks_soa_t const& read_unique_docs( //
+    ukv_t const c_db,
+    ukv_txn_t const c_txn,
+    read_tasks_soa_t const& tasks,
+    strided_iterator_gt<ukv_str_view_t const> fields,
+    ukv_options_t const c_options,
+    stl_arena_t& arena,
+    ukv_error_t* c_error,
+    callback_at callback) noexcept {
+
+    tape_view_t binary_docs = read_binary_docs(c_db, c_txn, tasks, c_options, arena, c_error);
+    if (*c_error)
+        return tasks;
+    auto binary_docs_it = binary_docs.begin();
+
+    for (ukv_size_t task_idx = 0; task_idx != tasks.count; ++task_idx, ++binary_docs_it) {
+        value_view_t binary_doc = *binary_docs_it;
+        ukv_str_view_t field = fields[task_idx];
+        if constexpr (is_read_only_k<callback_at>) {
+            auto parsed = parse_cached(tasks[task_idx].location(), binary_doc, c_error);
+            if (*c_error)
+                return tasks;
+            callback(task_idx, field, *parsed);
+        }
+        else {
+            json_t parsed = parse_any(binary_doc, internal_format_k, c_error);
+
+            // This error is extremely unlikely, as we have previously accepted the data into the store.
+            if (*c_error)
+                return tasks;
+            callback(task_idx, field, parsed);
+        }
+    }
+
+    return tasks;
+}
+
+template <typename callback_at>
+read_tasks_soa_t read_docs( //
+    ukv_t const c_db,
+    ukv_txn_t const c_txn,
+    read_tasks_soa_t const& tasks,
+    strided_iterator_gt<ukv_str_view_t const> fields,
+    ukv_options_t const c_options,
+    stl_arena_t& arena,
+    ukv_error_t* c_error,
+    callback_at callback) {
+
+    // Handle the common case of requesting the non-colliding
+    // all-ascending input sequences of document IDs received
+    // during scans without the sort and extra memory.
+    if (keys_ascending(tasks.keys, tasks.count))
+        return read_unique_docs(c_db, c_txn, tasks, fields, c_options, arena, c_error, callback);
+
+    // If it's not one of the trivial consecutive lookups, we want
+    // to sort & deduplicate the entries to minimize the random reads
+    // from disk.
+    prepare_memory(arena, arena.updated_keys, tasks.count, c_error);
+    if (*c_error)
+        return tasks;
+    for (ukv_size_t doc_idx = 0; doc_idx != tasks.count; ++doc_idx)
+        arena.updated_keys[doc_idx] = tasks[doc_idx].location();
+    sort_and_deduplicate(arena.updated_keys);
+
+    // There is a chance, all the entries are unique.
+    // In such case, let's free-up the memory.
+    if (arena.updated_keys.size() == tasks.count) {
+        arena.updated_keys.clear();
+        return read_unique_docs(c_db, c_txn, tasks, fields, c_options, arena, c_error, callback);
+    }
+
+    // Otherwise, let's retrieve the sublist of unique docs,
+    // which may be in a very different order from original.
+    ukv_size_t unique_docs_count = static_cast<ukv_size_t>(arena.updated_keys.size());
+    auto unique_keys_range = strided_range(arena.updated_keys).immutable();
+    read_tasks_soa_t unique_tasks {
+        unique_keys_range.members(&col_key_t::col).begin(),
+        unique_keys_range.members(&col_key_t::key).begin(),
+        unique_docs_count,
+    };
+    tape_view_t binary_docs = read_binary_docs(c_db, c_txn, unique_tasks, c_options, arena, c_error);
+    if (*c_error)
+        return tasks;
+
+    // We will later need to locate the data for every separate request.
+    // Doing it in O(N) tape iterations every time is too slow.
+    // Once we transform to inclusive sums, it will be O(1).
+    //      inplace_inclusive_prefix_sum(binary_docs_lens, binary_docs_lens + binary_docs_count);
+    // Alternatively we can compensate it with additional memory:
+    using parsed_doc_t = std::conditional_t<is_read_only_k<callback_at>, std::shared_ptr<json_t const>, json_t>;
+    std::optional<std::vector<parsed_doc_t>> parsed_docs;
+    try {
+        parsed_docs = std::vector<parsed_doc_t>(tasks.count);
+    }
+    catch (std::bad_alloc const&) {
+        *c_error = "Out of memory!";
+        return tasks;
+    }
+
+    // Parse all the unique documents
+    auto binary_docs_it = binary_docs.begin();
+    for (ukv_size_t doc_idx = 0; doc_idx != unique_docs_count; ++doc_idx, ++binary_docs_it) {
+        value_view_t binary_doc = *binary_docs_it;
+        parsed_doc_t& parsed = (*parsed_docs)[doc_idx];
+        if constexpr (is_read_only_k<callback_at>)
+            parsed = parse_cached(arena.updated_keys[doc_idx], binary_doc, c_error);
+        else
+            parsed = parse_any(binary_doc, internal_format_k, c_error);
+
+        // This error is extremely unlikely, as we have previously accepted the data into the store.
+        if (*c_error)
+            return tasks;
+    }
+
+    // Join docs and fields with binary search
+    for (ukv_size_t task_idx = 0; task_idx != tasks.count; ++task_idx) {
+        auto task = tasks[task_idx];
+        auto parsed_idx = offset_in_sorted(arena.updated_keys, task.location());
+        parsed_doc_t& parsed = (*parsed_docs)[parsed_idx];
+        ukv_str_view_t field = fields[task_idx];
+        if constexpr (is_read_only_k<callback_at>)
+            callback(task_idx, field, *parsed);
+        else
+            callback(task_idx, field, parsed);
+    }
+
+    return unique_tasks;
+}
+
+void replace_docs( //
     ukv_t const c_db,
     ukv_txn_t const c_txn,
     write_tasks_soa_t const& tasks,
@@ -348,7 +1268,7 @@ void replace_docs( //
     stl_arena_t& arena,
     ukv_error_t* c_error) noexcept {
 
-    prepare_memory(arena.updated_vals, tasks.count, c_error);
+    prepare_memory(arena, arena.updated_vals, tasks.count, c_error);
     if (*c_error)
         return;
 
@@ -383,24 +1303,241 @@ void replace_docs( //
             return;
     }
 
-    ukv_arena_t arena_ptr = &arena;
-    ukv_write( //
-        c_db,
-        c_txn,
-        tasks.count,
-        tasks.cols.get(),
-        tasks.cols.stride(),
-        tasks.keys.get(),
-        tasks.keys.stride(),
-        arena.updated_vals.front().member_ptr(),
-        sizeof(value_t),
-        nullptr,
-        0,
-        arena.updated_vals.front().member_length(),
-        sizeof(value_t),
-        c_options,
-        &arena_ptr,
-        c_error);
+    strided_iterator_gt<ukv_val_ptr_t const> vals {arena.updated_vals.front().member_ptr(), sizeof(value_t)};
+    strided_iterator_gt<ukv_val_len_t const> lens {arena.updated_vals.front().member_length(), sizeof(value_t)};
+    write_binary_docs(c_db, c_txn, {tasks.cols, tasks.keys, vals, {}, lens, tasks.count}, c_options, arena, c_error);
+}
+
+/// Appends an escaped member name to a JSON-Pointer.
+void append_pointer_token(std::string& pointer, std::string_view name) noexcept(false) {
+    pointer.push_back('/');
+    for (char c : name)
+        if (c == '~')
+            pointer += "~0";
+        else if (c == '/')
+            pointer += "~1";
+        else
+            pointer.push_back(c);
+}
+
+/// Converts a top-level name or a JSON-Pointer into a JSON-Pointer. NULL addresses the whole document.
+std::string field_pointer(ukv_str_view_t field) noexcept(false) {
+    std::string pointer;
+    if (field && field[0] == '/')
+        pointer = field;
+    else if (field)
+        append_pointer_token(pointer, field);
+    return pointer;
+}
+
+bool is_fixed_width_scalar(json_t const& value) noexcept {
+    return value.is_boolean() || value.is_number();
+}
+
+using scalar_assignments_t = std::vector<std::pair<std::string, json_t>>;
+
+/**
+ * @brief Lists the scalar members, that a patch overwrites, if that's all it does.
+ * Paths of assignments are JSON-Pointers, prefixed with the @p pointer to the patched member.
+ * @return false If the patch adds, removes or restructures members.
+ */
+bool collect_assignments( //
+    json_t const& patch,
+    std::string& pointer,
+    ukv_format_t const c_format,
+    scalar_assignments_t& assignments) noexcept(false) {
+
+    switch (c_format) {
+    case ukv_format_json_merge_patch_k: {
+        if (!patch.is_object())
+            return false;
+        for (auto const& member : patch.items()) {
+            std::size_t parent_length = pointer.size();
+            append_pointer_token(pointer, member.key());
+            json_t const& value = member.value();
+            bool is_simple = value.is_object()
+                                 ? !value.empty() && collect_assignments(value, pointer, c_format, assignments)
+                                 : is_fixed_width_scalar(value);
+            if (is_simple && !value.is_object())
+                assignments.emplace_back(pointer, value);
+            pointer.resize(parent_length);
+            if (!is_simple)
+                return false;
+        }
+        return true;
+    }
+    case ukv_format_json_patch_k: {
+        if (!patch.is_array())
+            return false;
+        for (json_t const& operation : patch) {
+            auto op = operation.find("op");
+            auto path = operation.find("path");
+            auto value = operation.find("value");
+            bool is_replace = op != operation.end() && *op == "replace";
+            if (!is_replace || path == operation.end() || !path->is_string() || value == operation.end() ||
+                !is_fixed_width_scalar(*value))
+                return false;
+            assignments.emplace_back(pointer + path->get<std::string>(), *value);
+        }
+        return true;
+    }
+    default:
+        if (!is_fixed_width_scalar(patch))
+            return false;
+        assignments.emplace_back(pointer, patch);
+        return true;
+    }
+}
+
+/**
+ * @brief Adds @p delta to a numeric @p member, keeping it an integer,
+ * unless it was a float, and reporting overflows instead of wrapping around.
+ */
+json_t incremented(json_t const& member, std::int64_t delta, ukv_error_t* c_error) noexcept(false) {
+    if (member.is_number_float())
+        return member.get<double>() + delta;
+    if (member.is_number_unsigned()) {
+        std::uint64_t value = member.get<std::uint64_t>();
+        std::uint64_t magnitude = delta >= 0 ? std::uint64_t(delta) : std::uint64_t(0) - std::uint64_t(delta);
+        if (delta >= 0 && value > std::numeric_limits<std::uint64_t>::max() - magnitude)
+            return (*c_error = "Incremented member overflows!"), member;
+        if (delta >= 0 || value >= magnitude)
+            return delta >= 0 ? value + magnitude : value - magnitude;
+        // The difference is negative, but `value < magnitude <= 2^63` fits into a signed integer
+        return static_cast<std::int64_t>(value) + delta;
+    }
+    if (member.is_number_integer()) {
+        std::int64_t result = 0;
+        if (__builtin_add_overflow(member.get<std::int64_t>(), delta, &result))
+            return (*c_error = "Incremented member overflows!"), member;
+        return result;
+    }
+    *c_error = "Only numeric members can be incremented!";
+    return member;
+}
+
+/**
+ * @brief Adds @p delta to the member of a MessagePack @p doc at @p pointer, overwriting
+ * it in place, if the result fits into the same encoding. Otherwise, the document is
+ * re-serialized. Missing members and documents are created with the value of @p delta.
+ */
+void increment_member( //
+    value_t& doc,
+    std::string const& pointer,
+    std::int64_t delta,
+    std::shared_ptr<export_to_value_t> const& exporter,
+    ukv_error_t* c_error) noexcept(false) {
+
+    auto begin = reinterpret_cast<std::uint8_t*>(doc.begin());
+    auto end = begin + doc.size();
+    auto member = doc.size() ? const_cast<std::uint8_t*>(msgpack_find(begin, end, pointer.c_str())) : nullptr;
+    json_t current;
+    if (member && msgpack_to_json(member, end, current)) {
+        json_t updated = incremented(current, delta, c_error);
+        if (*c_error || msgpack_assign_scalar(member, end, updated))
+            return;
+    }
+
+    json_t parsed = doc.size() ? parse_any(doc, internal_format_k, c_error) : json_t::object();
+    if (*c_error)
+        return;
+    json_ptr_t member_ptr {pointer};
+    if (parsed.contains(member_ptr)) {
+        json_t& existing = parsed.at(member_ptr);
+        existing = incremented(existing, delta, c_error);
+        if (*c_error)
+            return;
+    }
+    else
+        parsed[member_ptr] = delta;
+
+    doc.clear();
+    exporter->value_ptr = &doc;
+    dump_any(parsed, internal_format_k, exporter, c_error);
+}
+
+/**
+ * @brief Applies patches, that only overwrite fixed-width scalars with values of the same
+ * type, directly to the MessagePack representations of documents, skipping the DOM.
+ * @return false If any of the patches needs the generic path. Nothing is written then.
+ */
+bool patch_in_place( //
+    ukv_t const c_db,
+    ukv_txn_t const c_txn,
+    write_tasks_soa_t const& tasks,
+    strided_iterator_gt<ukv_str_view_t const> fields,
+    ukv_options_t const c_options,
+    ukv_format_t const c_format,
+    stl_arena_t& arena,
+    ukv_error_t* c_error) noexcept {
+
+    try {
+        std::vector<scalar_assignments_t> assignments(tasks.count);
+        std::vector<col_key_t> locations(tasks.count);
+        std::string pointer;
+        for (ukv_size_t task_idx = 0; task_idx != tasks.count; ++task_idx) {
+            write_task_t task = tasks[task_idx];
+            if (task.is_deleted())
+                return false;
+
+            // Malformed patches will be reported by the generic path
+            ukv_error_t parsing_error = nullptr;
+            json_t patch = parse_any(task.view(), c_format, &parsing_error);
+            if (parsing_error || patch.is_discarded())
+                return false;
+
+            pointer = field_pointer(fields ? fields[task_idx] : nullptr);
+            if (!collect_assignments(patch, pointer, c_format, assignments[task_idx]))
+                return false;
+            for (auto const& path_and_value : assignments[task_idx])
+                if (path_and_value.first.empty())
+                    return false;
+            locations[task_idx] = task.location();
+        }
+
+        // Repeated updates of the same document must be applied in order to a DOM
+        std::sort(locations.begin(), locations.end());
+        if (std::adjacent_find(locations.begin(), locations.end()) != locations.end())
+            return false;
+
+        read_tasks_soa_t read_tasks {tasks.cols, tasks.keys, tasks.count};
+        tape_view_t docs = read_binary_docs(c_db, c_txn, read_tasks, c_options, arena, c_error);
+        if (*c_error)
+            return true;
+        prepare_memory(arena, arena.updated_vals, tasks.count, c_error);
+        if (*c_error)
+            return true;
+
+        tape_iterator_t docs_it = docs.begin();
+        for (ukv_size_t task_idx = 0; task_idx != tasks.count; ++task_idx, ++docs_it) {
+            value_view_t doc = *docs_it;
+            if (!doc)
+                return false;
+
+            value_t& updated = arena.updated_vals[task_idx];
+            updated.clear();
+            updated.insert(0, doc.begin(), doc.end());
+            auto begin = reinterpret_cast<std::uint8_t*>(updated.begin());
+            auto end = begin + updated.size();
+            for (auto const& path_and_value : assignments[task_idx]) {
+                auto member = const_cast<std::uint8_t*>(msgpack_find(begin, end, path_and_value.first.c_str()));
+                if (!member || !msgpack_assign_scalar(member, end, path_and_value.second))
+                    return false;
+            }
+        }
+    }
+    catch (std::bad_alloc const&) {
+        *c_error = "Out of memory!";
+        return true;
+    }
+    catch (nlohmann::json::exception const&) {
+        return false;
+    }
+
+    strided_iterator_gt<ukv_val_ptr_t const> vals {arena.updated_vals.front().member_ptr(), sizeof(value_t)};
+    strided_iterator_gt<ukv_val_len_t const> lens {arena.updated_vals.front().member_length(), sizeof(value_t)};
+    write_binary_docs(c_db, c_txn, {tasks.cols, tasks.keys, vals, {}, lens, tasks.count}, c_options, arena, c_error);
+    return true;
 }
 
 void read_modify_write( //
@@ -413,104 +1550,427 @@ void read_modify_write( //
     stl_arena_t& arena,
     ukv_error_t* c_error) noexcept {
 
-    prepare_memory(arena.updated_keys, tasks.count, c_error);
+    if (patch_in_place(c_db, c_txn, tasks, fields, c_options, c_format, arena, c_error))
+        return;
+
+    prepare_memory(arena, arena.updated_keys, tasks.count, c_error);
+    if (*c_error)
+        return;
+
+    serializing_tape_ref_t serializing_tape {arena};
+    auto safe_callback = [&](ukv_size_t task_idx, ukv_str_view_t field, json_t& parsed) {
+        try {
+            json_t parsed_task = parse_any(tasks[task_idx].view(), c_format, c_error);
+            if (*c_error)
+                return;
+
+            // Apply the patch
+            json_t null_object;
+            json_t& parsed_part = lookup_field(parsed, field, null_object);
+            if (&parsed != &null_object) {
+                switch (c_format) {
+                case ukv_format_json_patch_k: parsed_part = parsed_part.patch(parsed_task); break;
+                case ukv_format_json_merge_patch_k: parsed_part.merge_patch(parsed_task); break;
+                default: parsed_part = parsed_task; break;
+                }
+            }
+            else if (c_format != ukv_format_json_patch_k && c_format != ukv_format_json_merge_patch_k) {
+                json_t::string_t heapy_field {field};
+                parsed = parsed.flatten();
+                parsed.emplace(heapy_field, parsed_task);
+                parsed = parsed.unflatten();
+            }
+
+            // Save onto output tape
+            serializing_tape.push_back(parsed_part, internal_format_k, c_error);
+            if (*c_error)
+                return;
+        }
+        catch (std::bad_alloc const&) {
+            *c_error = "Out of memory!";
+        }
+    };
+    read_tasks_soa_t read_order = read_docs( //
+        c_db,
+        c_txn,
+        read_tasks_soa_t {tasks.cols, tasks.keys, tasks.count},
+        fields,
+        c_options,
+        arena,
+        c_error,
+        safe_callback);
+
+    // By now, the tape contains concatenated updates docs:
+    ukv_size_t unique_docs_count = static_cast<ukv_size_t>(read_order.size());
+    ukv_val_ptr_t binary_docs_begin = reinterpret_cast<ukv_val_ptr_t>(arena.growing_tape.contents().begin().get());
+    write_tasks_soa_t updates {
+        read_order.cols,
+        read_order.keys,
+        {&binary_docs_begin, 0},
+        arena.growing_tape.offsets().immutable().begin(),
+        arena.growing_tape.lengths().immutable().begin(),
+        unique_docs_count,
+    };
+    write_binary_docs(c_db, c_txn, updates, c_options, arena, c_error);
+}
+
+void parse_fields( //
+    strided_iterator_gt<ukv_str_view_t const> fields,
+    ukv_size_t n,
+    heapy_fields_t& fields_parsed,
+    ukv_error_t* c_error) noexcept {
+
+    try {
+        fields_parsed = std::vector<heapy_field_t>(n);
+        ukv_str_view_t joined_fields_ptr = *fields;
+        for (ukv_size_t field_idx = 0; field_idx != n; ++field_idx) {
+            ukv_str_view_t field = fields.repeats() ? joined_fields_ptr : fields[field_idx];
+            if (!field && (*c_error = "NULL JSON-Pointers are not allowed!"))
+                return;
+
+            heapy_field_t& field_parsed = (*fields_parsed)[field_idx];
+            if (field[0] == '/')
+                field_parsed = json_ptr_t {field};
+            else
+                field_parsed = std::string {field};
+
+            joined_fields_ptr += std::strlen(field) + 1;
+        }
+    }
+    catch (nlohmann::json::parse_error const&) {
+        *c_error = "Inappropriate field path!";
+    }
+    catch (std::bad_alloc const&) {
+        *c_error = "Out of memory!";
+    }
+}
+
+void ukv_docs_cache_limit(ukv_size_t const c_documents) {
+    docs_cache.limit(c_documents);
+}
+
+void ukv_docs_cache_stats(ukv_size_t* c_hits, ukv_size_t* c_misses) {
+    if (c_hits)
+        *c_hits = docs_cache.hits.load();
+    if (c_misses)
+        *c_misses = docs_cache.misses.load();
+}
+
+void ukv_docs_shred( //
+    ukv_t const c_db,
+    ukv_col_t const c_col,
+    ukv_size_t const c_fields_count,
+    ukv_str_view_t const* c_fields,
+    ukv_size_t const c_fields_stride,
+    ukv_type_t const* c_types,
+    ukv_size_t const c_types_stride,
+    ukv_col_t const* c_columns,
+    ukv_size_t const c_columns_stride,
+    ukv_error_t* c_error) {
+
+    if (!c_db && (*c_error = "DataBase is NULL!"))
+        return;
+
+    strided_iterator_gt<ukv_str_view_t const> fields {c_fields, c_fields_stride};
+    strided_iterator_gt<ukv_type_t const> types {c_types, c_types_stride};
+    strided_iterator_gt<ukv_col_t const> columns {c_columns, c_columns_stride};
+    if (c_fields_count && !(fields && types && columns) && (*c_error = "Fields, types and columns are required!"))
+        return;
+
+    try {
+        std::shared_ptr<shredding_t> layout;
+        if (c_fields_count)
+            layout = std::make_shared<shredding_t>(c_fields_count);
+        for (ukv_size_t field_idx = 0; field_idx != c_fields_count; ++field_idx) {
+            shredded_field_t& field = (*layout)[field_idx];
+            ukv_str_view_t name = fields[field_idx];
+            if ((!name || !*name || name[0] == '/') && (*c_error = "Only top-level fields can be shredded!"))
+                return;
+            if (!shredded_width(types[field_idx]) && (*c_error = "Only fixed-width scalars can be shredded!"))
+                return;
+            if ((columns[field_idx] == c_col) && (*c_error = "Columns must differ from the documents collection!"))
+                return;
+            field.name = name;
+            field.type = types[field_idx];
+            field.column = columns[field_idx];
+        }
+        docs_shreddings.assign(c_db, c_col, std::move(layout));
+    }
+    catch (std::bad_alloc const&) {
+        *c_error = "Out of memory!";
+    }
+}
+
+void ukv_docs_index_create( //
+    ukv_t const c_db,
+    ukv_txn_t const c_txn,
+    ukv_col_t const c_col,
+    ukv_str_view_t const c_field,
+    ukv_str_view_t const c_name,
+    ukv_options_t const c_options,
+    ukv_arena_t* c_arena,
+    ukv_error_t* c_error) {
+
+    if (!c_db && (*c_error = "DataBase is NULL!"))
+        return;
+    if ((!c_field || !*c_field) && (*c_error = "Indexed field must be specified!"))
+        return;
+    if ((!c_name || !*c_name) && (*c_error = "Index collection must be named!"))
+        return;
+
+    stl_arena_t& arena = *cast_arena(c_arena, c_error);
+    if (*c_error)
+        return;
+
+    // Start from an empty collection, dropping the leftovers of previous runs
+    ukv_col_t index_col = ukv_col_main_k;
+    ukv_col_remove(c_db, c_name, c_error);
+    if (*c_error)
+        return;
+    ukv_col_open(c_db, c_name, "", &index_col, c_error);
+    if (*c_error)
+        return;
+    if (index_col == c_col && (*c_error = "Index must differ from the documents collection!"))
+        return;
+
+    ukv_arena_t arena_ptr = &arena;
+    auto options = static_cast<ukv_options_t>(c_options & ~ukv_option_read_lengths_k);
+    try {
+        doc_index_t index {c_field, c_name, index_col};
+        index_lists_t lists;
+
+        // Index the existing documents batch by batch, in ascending order of IDs
+        std::vector<ukv_key_t> doc_keys;
+        ukv_key_t next_min_key = std::numeric_limits<ukv_key_t>::min();
+        ukv_size_t scan_length = docs_index_scan_k;
+        while (true) {
+            ukv_key_t* found_keys = nullptr;
+            ukv_val_len_t* found_lengths = nullptr;
+            ukv_scan( //
+                c_db,
+                c_txn,
+                1,
+                &c_col,
+                0,
+                &next_min_key,
+                0,
+                &scan_length,
+                0,
+                options,
+                &found_keys,
+                &found_lengths,
+                &arena_ptr,
+                c_error);
+            if (*c_error)
+                return;
+
+            auto found_end = std::find(found_keys, found_keys + scan_length, ukv_key_unknown_k);
+            doc_keys.assign(found_keys, found_end);
+            if (doc_keys.empty())
+                break;
+
+            read_tasks_soa_t tasks {{&c_col, 0}, {doc_keys.data(), sizeof(ukv_key_t)}, doc_keys.size()};
+            tape_view_t docs = read_binary_docs(c_db, c_txn, tasks, options, arena, c_error);
+            if (*c_error)
+                return;
+
+            tape_iterator_t docs_it = docs.begin();
+            ukv_key_t value;
+            for (ukv_key_t doc_key : doc_keys) {
+                if (indexed_value(*docs_it, index, value))
+                    lists[{index_col, value}].push_back(doc_key);
+                ++docs_it;
+            }
+            if (found_end != found_keys + scan_length)
+                break;
+            next_min_key = doc_keys.back() + 1;
+        }
+
+        std::vector<col_key_t> locations;
+        std::vector<ukv_val_ptr_t> vals;
+        std::vector<ukv_val_len_t> lens;
+        for (auto& location_and_keys : lists) {
+            std::vector<ukv_key_t>& keys = location_and_keys.second;
+            locations.push_back(location_and_keys.first);
+            vals.push_back(reinterpret_cast<ukv_val_ptr_t>(keys.data()));
+            lens.push_back(static_cast<ukv_val_len_t>(keys.size() * sizeof(ukv_key_t)));
+        }
+        if (!locations.empty())
+            ukv_write( //
+                c_db,
+                c_txn,
+                static_cast<ukv_size_t>(locations.size()),
+                &locations[0].col,
+                sizeof(col_key_t),
+                &locations[0].key,
+                sizeof(col_key_t),
+                vals.data(),
+                sizeof(ukv_val_ptr_t),
+                nullptr,
+                0,
+                lens.data(),
+                sizeof(ukv_val_len_t),
+                options,
+                &arena_ptr,
+                c_error);
+        if (*c_error)
+            return;
+
+        docs_indexes.update(c_db, c_col, [&](std::shared_ptr<doc_indexes_t const> const& old) {
+            auto updated = std::make_shared<doc_indexes_t>();
+            for (doc_index_t const& other : old ? *old : doc_indexes_t {})
+                if (other.field != index.field)
+                    updated->push_back(other);
+            updated->push_back(std::move(index));
+            return std::shared_ptr<doc_indexes_t const>(std::move(updated));
+        });
+    }
+    catch (std::bad_alloc const&) {
+        *c_error = "Out of memory!";
+    }
+}
+
+void ukv_docs_index_drop( //
+    ukv_t const c_db,
+    ukv_col_t const c_col,
+    ukv_str_view_t const c_field,
+    ukv_error_t* c_error) {
+
+    if (!c_db && (*c_error = "DataBase is NULL!"))
+        return;
+    if ((!c_field || !*c_field) && (*c_error = "Indexed field must be specified!"))
+        return;
+
+    std::string name;
+    try {
+        docs_indexes.update(c_db, c_col, [&](std::shared_ptr<doc_indexes_t const> const& old) {
+            auto updated = std::make_shared<doc_indexes_t>();
+            for (doc_index_t const& other : old ? *old : doc_indexes_t {})
+                if (other.field != c_field)
+                    updated->push_back(other);
+                else
+                    name = other.name;
+            return updated->empty() ? nullptr : std::shared_ptr<doc_indexes_t const>(std::move(updated));
+        });
+    }
+    catch (std::bad_alloc const&) {
+        *c_error = "Out of memory!";
+        return;
+    }
+
+    if (name.empty() && (*c_error = "Field isn't indexed!"))
+        return;
+    ukv_col_remove(c_db, name.c_str(), c_error);
+}
+
+void ukv_docs_index_find( //
+    ukv_t const c_db,
+    ukv_txn_t const c_txn,
+    ukv_col_t const c_col,
+    ukv_str_view_t const c_field,
+    int64_t const c_min_value,
+    int64_t const c_max_value,
+    ukv_options_t const c_options,
+    ukv_size_t* c_found_count,
+    ukv_key_t** c_found_keys,
+    ukv_arena_t* c_arena,
+    ukv_error_t* c_error) {
+
+    if (!c_db && (*c_error = "DataBase is NULL!"))
+        return;
+    if (!c_found_count && (*c_error = "Found count output is NULL!"))
+        return;
+
+    stl_arena_t& arena = *cast_arena(c_arena, c_error);
     if (*c_error)
         return;
 
-    serializing_tape_ref_t serializing_tape {arena};
-    auto safe_callback = [&](ukv_size_t task_idx, ukv_str_view_t field, json_t& parsed) {
-        try {
-            json_t parsed_task = parse_any(tasks[task_idx].view(), c_format, c_error);
-            if (*c_error)
-                return;
-
-            // Apply the patch
-            json_t null_object;
-            json_t& parsed_part = lookup_field(parsed, field, null_object);
-            if (&parsed != &null_object) {
-                switch (c_format) {
-                case ukv_format_json_patch_k: parsed_part = parsed_part.patch(parsed_task); break;
-                case ukv_format_json_merge_patch_k: parsed_part.merge_patch(parsed_task); break;
-                default: parsed_part = parsed_task; break;
-                }
-            }
-            else if (c_format != ukv_format_json_patch_k && c_format != ukv_format_json_merge_patch_k) {
-                json_t::string_t heapy_field {field};
-                parsed = parsed.flatten();
-                parsed.emplace(heapy_field, parsed_task);
-                parsed = parsed.unflatten();
-            }
+    std::shared_ptr<doc_indexes_t const> doc_indexes = docs_indexes.find(c_db, c_col);
+    doc_index_t const* index = nullptr;
+    for (std::size_t index_idx = 0; doc_indexes && index_idx != doc_indexes->size(); ++index_idx)
+        if (c_field && (*doc_indexes)[index_idx].field == c_field)
+            index = &(*doc_indexes)[index_idx];
+    if (!index && (*c_error = "Field isn't indexed!"))
+        return;
 
-            // Save onto output tape
-            serializing_tape.push_back(parsed_part, internal_format_k, c_error);
+    ukv_arena_t arena_ptr = &arena;
+    auto options = static_cast<ukv_options_t>(c_options & ~ukv_option_read_lengths_k);
+    std::vector<ukv_key_t> values;
+    try {
+        // 1. Collect the values in range from the index, batch by batch
+        ukv_key_t next_min_value = c_min_value;
+        ukv_size_t scan_length = docs_index_scan_k;
+        while (next_min_value <= c_max_value) {
+            ukv_key_t* found_values = nullptr;
+            ukv_val_len_t* found_lengths = nullptr;
+            ukv_scan( //
+                c_db,
+                c_txn,
+                1,
+                &index->collection,
+                0,
+                &next_min_value,
+                0,
+                &scan_length,
+                0,
+                options,
+                &found_values,
+                &found_lengths,
+                &arena_ptr,
+                c_error);
             if (*c_error)
                 return;
+
+            auto found_end = std::find(found_values, found_values + scan_length, ukv_key_unknown_k);
+            auto range_end = std::upper_bound(found_values, found_end, c_max_value);
+            values.insert(values.end(), found_values, range_end);
+            if (range_end != found_values + scan_length)
+                break;
+            next_min_value = found_values[scan_length - 1] + 1;
         }
-        catch (std::bad_alloc const&) {
-            *c_error = "Out of memory!";
-        }
-    };
-    read_tasks_soa_t read_order = read_docs( //
-        c_db,
-        c_txn,
-        read_tasks_soa_t {tasks.cols, tasks.keys, tasks.count},
-        fields,
-        c_options,
-        arena,
-        c_error,
-        safe_callback);
+    }
+    catch (std::bad_alloc const&) {
+        *c_error = "Out of memory!";
+        return;
+    }
 
-    // By now, the tape contains concatenated updates docs:
-    ukv_size_t unique_docs_count = static_cast<ukv_size_t>(read_order.size());
-    ukv_val_ptr_t binary_docs_begin = reinterpret_cast<ukv_val_ptr_t>(arena.growing_tape.contents().begin().get());
-    ukv_arena_t arena_ptr = &arena;
-    ukv_write( //
+    // 2. Fetch and concatenate the lists of documents
+    ukv_val_ptr_t found_lists = nullptr;
+    ukv_val_len_t* found_offsets = nullptr;
+    ukv_val_len_t* found_lengths = nullptr;
+    ukv_read( //
         c_db,
         c_txn,
-        unique_docs_count,
-        read_order.cols.get(),
-        read_order.cols.stride(),
-        read_order.keys.get(),
-        read_order.keys.stride(),
-        &binary_docs_begin,
+        static_cast<ukv_size_t>(values.size()),
+        &index->collection,
         0,
-        arena.growing_tape.offsets().begin().get(),
-        arena.growing_tape.offsets().stride(),
-        arena.growing_tape.lengths().begin().get(),
-        arena.growing_tape.lengths().stride(),
-        c_options,
+        values.data(),
+        sizeof(ukv_key_t),
+        options,
+        &found_lists,
+        &found_offsets,
+        &found_lengths,
         &arena_ptr,
         c_error);
-}
-
-void parse_fields( //
-    strided_iterator_gt<ukv_str_view_t const> fields,
-    ukv_size_t n,
-    heapy_fields_t& fields_parsed,
-    ukv_error_t* c_error) noexcept {
+    if (*c_error)
+        return;
 
-    try {
-        fields_parsed = std::vector<heapy_field_t>(n);
-        ukv_str_view_t joined_fields_ptr = *fields;
-        for (ukv_size_t field_idx = 0; field_idx != n; ++field_idx) {
-            ukv_str_view_t field = fields.repeats() ? joined_fields_ptr : fields[field_idx];
-            if (!field && (*c_error = "NULL JSON-Pointers are not allowed!"))
-                return;
+    // Lists, removed since the scan, are simply empty
+    tape_view_t lists {found_lists, found_offsets, found_lengths, static_cast<ukv_size_t>(values.size())};
+    std::size_t count_keys = 0;
+    for (value_view_t list : lists)
+        count_keys += list.size() / sizeof(ukv_key_t);
 
-            heapy_field_t& field_parsed = (*fields_parsed)[field_idx];
-            if (field[0] == '/')
-                field_parsed = json_ptr_t {field};
-            else
-                field_parsed = std::string {field};
+    auto keys = reinterpret_cast<ukv_key_t*>(
+        prepare_memory(arena, arena.unpacked_tape, count_keys * sizeof(ukv_key_t), c_error));
+    if (*c_error)
+        return;
 
-            joined_fields_ptr += std::strlen(field) + 1;
-        }
-    }
-    catch (nlohmann::json::parse_error const&) {
-        *c_error = "Inappropriate field path!";
-    }
-    catch (std::bad_alloc const&) {
-        *c_error = "Out of memory!";
+    *c_found_count = static_cast<ukv_size_t>(count_keys);
+    *c_found_keys = keys;
+    for (value_view_t list : lists) {
+        std::memcpy(keys, list.begin(), list.size());
+        keys += list.size() / sizeof(ukv_key_t);
     }
 }
 
@@ -548,7 +2008,8 @@ void ukv_docs_write( //
     // this request can be passed entirely to the underlying Key-Value store.
     strided_iterator_gt<ukv_str_view_t const> fields {c_fields, c_fields_stride};
     auto has_fields = fields && (!fields.repeats() || *fields);
-    if (!has_fields && c_format == internal_format_k)
+    auto is_internal = !has_fields && c_format == internal_format_k;
+    if (is_internal && !docs_shreddings.any() && !docs_indexes.any())
         return ukv_write( //
             c_db,
             c_txn,
@@ -580,6 +2041,8 @@ void ukv_docs_write( //
     strided_iterator_gt<ukv_val_len_t const> offs {c_offs, c_offs_stride};
     strided_iterator_gt<ukv_val_len_t const> lens {c_lens, c_lens_stride};
     write_tasks_soa_t tasks {cols, keys, vals, offs, lens, c_tasks_count};
+    if (is_internal)
+        return write_binary_docs(c_db, c_txn, tasks, c_options, arena, c_error);
 
     auto func = has_fields || c_format == ukv_format_json_patch_k || c_format == ukv_format_json_merge_patch_k
                     ? &read_modify_write
@@ -588,6 +2051,101 @@ void ukv_docs_write( //
     func(c_db, c_txn, tasks, fields, c_options, c_format, arena, c_error);
 }
 
+void ukv_docs_increment( //
+    ukv_t const c_db,
+    ukv_txn_t const c_txn,
+    ukv_size_t const c_tasks_count,
+
+    ukv_col_t const* c_cols,
+    ukv_size_t const c_cols_stride,
+
+    ukv_key_t const* c_keys,
+    ukv_size_t const c_keys_stride,
+
+    ukv_str_view_t const* c_fields,
+    ukv_size_t const c_fields_stride,
+
+    int64_t const* c_deltas,
+    ukv_size_t const c_deltas_stride,
+
+    ukv_options_t const c_options,
+
+    ukv_arena_t* c_arena,
+    ukv_error_t* c_error) {
+
+    if (!c_db && (*c_error = "DataBase is NULL!"))
+        return;
+    if (!c_fields && (*c_error = "Incremented fields must be specified!"))
+        return;
+    if (!c_deltas && (*c_error = "Increments must be specified!"))
+        return;
+
+    stl_arena_t& arena = *cast_arena(c_arena, c_error);
+    if (*c_error)
+        return;
+
+    strided_iterator_gt<ukv_col_t const> cols {c_cols, c_cols_stride};
+    strided_iterator_gt<ukv_key_t const> keys {c_keys, c_keys_stride};
+    strided_iterator_gt<ukv_str_view_t const> fields {c_fields, c_fields_stride};
+    strided_iterator_gt<int64_t const> deltas {c_deltas, c_deltas_stride};
+    read_tasks_soa_t tasks {cols, keys, c_tasks_count};
+
+    // Every document is read and written once, no matter how many times it's incremented
+    prepare_memory(arena, arena.updated_keys, c_tasks_count, c_error);
+    if (*c_error)
+        return;
+    for (ukv_size_t task_idx = 0; task_idx != c_tasks_count; ++task_idx)
+        arena.updated_keys[task_idx] = tasks[task_idx].location();
+    sort_and_deduplicate(arena.updated_keys);
+
+    ukv_size_t unique_docs_count = static_cast<ukv_size_t>(arena.updated_keys.size());
+    auto unique_keys_range = strided_range(arena.updated_keys).immutable();
+    auto unique_cols = unique_keys_range.members(&col_key_t::col).begin();
+    auto unique_keys = unique_keys_range.members(&col_key_t::key).begin();
+    read_tasks_soa_t unique_tasks {unique_cols, unique_keys, unique_docs_count};
+    tape_view_t docs = read_binary_docs(c_db, c_txn, unique_tasks, c_options, arena, c_error);
+    if (*c_error)
+        return;
+
+    prepare_memory(arena, arena.updated_vals, unique_docs_count, c_error);
+    if (*c_error)
+        return;
+
+    try {
+        tape_iterator_t docs_it = docs.begin();
+        for (ukv_size_t doc_idx = 0; doc_idx != unique_docs_count; ++doc_idx, ++docs_it) {
+            value_view_t doc = *docs_it;
+            value_t& updated = arena.updated_vals[doc_idx];
+            updated.clear();
+            updated.insert(0, doc.begin(), doc.end());
+        }
+
+        // Increments of the same document are applied in the order they were passed
+        auto exporter = std::make_shared<export_to_value_t>();
+        std::string pointer;
+        for (ukv_size_t task_idx = 0; task_idx != c_tasks_count && !*c_error; ++task_idx) {
+            auto doc_idx = offset_in_sorted(arena.updated_keys, tasks[task_idx].location());
+            pointer = field_pointer(fields[task_idx]);
+            if (pointer.empty() && (*c_error = "Only members of documents can be incremented!"))
+                return;
+            increment_member(arena.updated_vals[doc_idx], pointer, deltas[task_idx], exporter, c_error);
+        }
+    }
+    catch (std::bad_alloc const&) {
+        *c_error = "Out of memory!";
+    }
+    catch (nlohmann::json::exception const&) {
+        *c_error = "Failed to increment a member!";
+    }
+    if (*c_error)
+        return;
+
+    strided_iterator_gt<ukv_val_ptr_t const> vals {arena.updated_vals.front().member_ptr(), sizeof(value_t)};
+    strided_iterator_gt<ukv_val_len_t const> lens {arena.updated_vals.front().member_length(), sizeof(value_t)};
+    write_tasks_soa_t write_tasks {unique_cols, unique_keys, vals, {}, lens, unique_docs_count};
+    write_binary_docs(c_db, c_txn, write_tasks, c_options, arena, c_error);
+}
+
 void ukv_docs_read( //
     ukv_t const c_db,
     ukv_txn_t const c_txn,
@@ -617,7 +2175,8 @@ void ukv_docs_read( //
     // this request can be passed entirely to the underlying Key-Value store.
     strided_iterator_gt<ukv_str_view_t const> fields {c_fields, c_fields_stride};
     auto has_fields = fields && (!fields.repeats() || *fields);
-    if (!has_fields && c_format == internal_format_k)
+    auto is_internal = !has_fields && c_format == internal_format_k;
+    if (is_internal && !docs_shreddings.any())
         return ukv_read( //
             c_db,
             c_txn,
@@ -642,15 +2201,22 @@ void ukv_docs_read( //
 
     strided_iterator_gt<ukv_col_t const> cols {c_cols, c_cols_stride};
     strided_iterator_gt<ukv_key_t const> keys {c_keys, c_keys_stride};
+    if (is_internal) {
+        tape_view_t binary_docs = read_binary_docs(c_db, c_txn, {cols, keys, c_tasks_count}, c_options, arena, c_error);
+        *c_found_values = binary_docs.contents();
+        *c_found_offsets = binary_docs.offsets();
+        *c_found_lengths = binary_docs.lengths();
+        return;
+    }
 
     // Now, we need to parse all the entries to later export them into a target format.
     // Potentially sampling certain sub-fields again along the way.
     serializing_tape_ref_t serializing_tape {arena};
-    json_t null_object;
+    json_t const null_object;
 
-    auto safe_callback = [&](ukv_size_t, ukv_str_view_t field, json_t& parsed) {
+    auto safe_callback = [&](ukv_size_t, ukv_str_view_t field, json_t const& parsed) {
         try {
-            json_t& parsed_part = lookup_field(parsed, field, null_object);
+            json_t const& parsed_part = lookup_field(parsed, field, null_object);
             serializing_tape.push_back(parsed_part, c_format, c_error);
             if (*c_error)
                 return;
@@ -690,34 +2256,17 @@ void ukv_docs_gist( //
     ukv_arena_t* c_arena,
     ukv_error_t* c_error) {
 
-    ukv_val_ptr_t binary_docs_begin = nullptr;
-    ukv_val_len_t* binary_docs_offs = nullptr;
-    ukv_val_len_t* binary_docs_lens = nullptr;
-    ukv_read( //
-        c_db,
-        c_txn,
-        c_docs_count,
-        c_cols,
-        c_cols_stride,
-        c_keys,
-        c_keys_stride,
-        c_options,
-        &binary_docs_begin,
-        &binary_docs_offs,
-        &binary_docs_lens,
-        c_arena,
-        c_error);
-    if (*c_error)
-        return;
-
     stl_arena_t& arena = *cast_arena(c_arena, c_error);
     if (*c_error)
         return;
 
     strided_iterator_gt<ukv_col_t const> cols {c_cols, c_cols_stride};
     strided_iterator_gt<ukv_key_t const> keys {c_keys, c_keys_stride};
+    read_tasks_soa_t tasks {cols, keys, c_docs_count};
 
-    tape_view_t binary_docs {binary_docs_begin, binary_docs_offs, binary_docs_lens, c_docs_count};
+    tape_view_t binary_docs = read_binary_docs(c_db, c_txn, tasks, c_options, arena, c_error);
+    if (*c_error)
+        return;
     tape_iterator_t binary_docs_it = binary_docs.begin();
 
     // Export all the elements into a heap-allocated hash-set, keeping only unique entries
@@ -726,10 +2275,10 @@ void ukv_docs_gist( //
         paths = std::unordered_set<std::string> {};
         for (ukv_size_t doc_idx = 0; doc_idx != c_docs_count; ++doc_idx, ++binary_docs_it) {
             value_view_t binary_doc = *binary_docs_it;
-            json_t parsed = parse_any(binary_doc, internal_format_k, c_error);
+            auto parsed = parse_cached(tasks[doc_idx].location(), binary_doc, c_error);
             if (*c_error)
                 return;
-            json_t parsed_flat = parsed.flatten();
+            json_t parsed_flat = parsed->flatten();
             paths->reserve(paths->size() + parsed_flat.size());
             for (auto& pair : parsed_flat.items())
                 paths->emplace(pair.key());
@@ -747,7 +2296,7 @@ void ukv_docs_gist( //
     total_length += paths->size();
 
     // Reserve memory
-    auto tape = prepare_memory(arena.unpacked_tape, total_length, c_error);
+    auto tape = prepare_memory(arena, arena.unpacked_tape, total_length, c_error);
     if (*c_error)
         return;
 
@@ -1038,6 +2587,37 @@ void export_string_column(json_t const& value, size_t doc_idx, column_begin_t co
     }
 }
 
+void export_column( //
+    json_t const& value,
+    ukv_type_t type,
+    size_t doc_idx,
+    column_begin_t column,
+    std::vector<byte_t>& output) {
+
+    switch (type) {
+
+    case ukv_type_bool_k: export_scalar_column<bool>(value, doc_idx, column); break;
+
+    case ukv_type_i8_k: export_scalar_column<std::int8_t>(value, doc_idx, column); break;
+    case ukv_type_i16_k: export_scalar_column<std::int16_t>(value, doc_idx, column); break;
+    case ukv_type_i32_k: export_scalar_column<std::int32_t>(value, doc_idx, column); break;
+    case ukv_type_i64_k: export_scalar_column<std::int64_t>(value, doc_idx, column); break;
+
+    case ukv_type_u8_k: export_scalar_column<std::uint8_t>(value, doc_idx, column); break;
+    case ukv_type_u16_k: export_scalar_column<std::uint16_t>(value, doc_idx, column); break;
+    case ukv_type_u32_k: export_scalar_column<std::uint32_t>(value, doc_idx, column); break;
+    case ukv_type_u64_k: export_scalar_column<std::uint64_t>(value, doc_idx, column); break;
+
+    case ukv_type_f32_k: export_scalar_column<float>(value, doc_idx, column); break;
+    case ukv_type_f64_k: export_scalar_column<double>(value, doc_idx, column); break;
+
+    case ukv_type_str_k: export_string_column(value, doc_idx, column, output); break;
+    case ukv_type_bin_k: export_string_column(value, doc_idx, column, output); break;
+
+    default: break;
+    }
+}
+
 void ukv_docs_gather( //
     ukv_t const c_db,
     ukv_txn_t const c_txn,
@@ -1070,35 +2650,11 @@ void ukv_docs_gather( //
     ukv_error_t* c_error) {
 
     // Validate the input arguments
-
-    // Retrieve the entire documents before we can sample internal fields
-    ukv_val_ptr_t binary_docs_begin = nullptr;
-    ukv_val_len_t* binary_docs_offs = nullptr;
-    ukv_val_len_t* binary_docs_lens = nullptr;
-    ukv_read( //
-        c_db,
-        c_txn,
-        c_docs_count,
-        c_cols,
-        c_cols_stride,
-        c_keys,
-        c_keys_stride,
-        c_options,
-        &binary_docs_begin,
-        &binary_docs_offs,
-        &binary_docs_lens,
-        c_arena,
-        c_error);
-    if (*c_error)
-        return;
-
     strided_iterator_gt<ukv_col_t const> cols {c_cols, c_cols_stride};
     strided_iterator_gt<ukv_key_t const> keys {c_keys, c_keys_stride};
     strided_iterator_gt<ukv_str_view_t const> fields {c_fields, c_fields_stride};
     strided_iterator_gt<ukv_type_t const> types {c_types, c_types_stride};
-
-    tape_view_t binary_docs {binary_docs_begin, binary_docs_offs, binary_docs_lens, c_docs_count};
-    tape_iterator_t binary_docs_it = binary_docs.begin();
+    read_tasks_soa_t tasks {cols, keys, c_docs_count};
 
     // Parse all the field names
     heapy_fields_t heapy_fields(std::nullopt);
@@ -1130,6 +2686,7 @@ void ukv_docs_gather( //
     if (*c_error)
         return;
     byte_t* const tape = prepare_memory( //
+        arena,
         arena.unpacked_tape,
         bytes_for_addresses + bytes_for_bitmaps + bytes_for_scalars,
         c_error);
@@ -1199,66 +2756,198 @@ void ukv_docs_gather( //
         }
     }
 
-    // Prepare constant values
-    json_t const null_object;
+    auto column_at = [&](ukv_size_t field_idx) noexcept {
+        return column_begin_t {
+            .validities = (*c_result_bitmap_valid)[field_idx],
+            .conversions = (*c_result_bitmap_converted)[field_idx],
+            .collisions = (*c_result_bitmap_collision)[field_idx],
+            .scalars = (*c_result_scalars)[field_idx],
+            .str_offsets = (*c_result_strs_offsets)[field_idx],
+            .str_lengths = (*c_result_strs_lengths)[field_idx],
+        };
+    };
 
-    // Go though all the documents extracting and type-checking the relevant parts
-    for (ukv_size_t doc_idx = 0; doc_idx != c_docs_count; ++doc_idx, ++binary_docs_it) {
-        value_view_t binary_doc = *binary_docs_it;
-        json_t parsed = parse_any(binary_doc, internal_format_k, c_error);
+    // If all the documents belong to the same shredded collection, the shredded members
+    // are exported straight from their columns. The documents are only read, if some
+    // of the fields or some of the cells are missing, and they won't be reassembled.
+    std::shared_ptr<shredding_t const> layout;
+    std::vector<shredded_field_t const*> shredded_fields;
+    bool same_collection = c_docs_count && docs_shreddings.any();
+    for (ukv_size_t doc_idx = 1; same_collection && cols && !cols.repeats() && doc_idx != c_docs_count; ++doc_idx)
+        same_collection = cols[doc_idx] == cols[0];
+    if (same_collection)
+        layout = docs_shreddings.find(c_db, tasks[0].col);
+    try {
+        shredded_fields.resize(layout ? c_fields_count : 0);
+    }
+    catch (std::bad_alloc const&) {
+        *c_error = "Out of memory!";
+        return;
+    }
+    bool needs_docs = !layout;
+    for (ukv_size_t field_idx = 0; field_idx != shredded_fields.size(); ++field_idx) {
+        heapy_field_t const& name_or_path = (*heapy_fields)[field_idx];
+        for (shredded_field_t const& shredded : *layout)
+            if (name_or_path.index() == 1 && std::get<1>(name_or_path) == shredded.name)
+                shredded_fields[field_idx] = &shredded;
+
+        shredded_field_t const* shredded = shredded_fields[field_idx];
+        if (!shredded) {
+            needs_docs = true;
+            continue;
+        }
+
+        ukv_arena_t arena_ptr = &arena;
+        ukv_val_ptr_t cells_begin = nullptr;
+        ukv_val_len_t* cells_offs = nullptr;
+        ukv_val_len_t* cells_lens = nullptr;
+        ukv_read( //
+            c_db,
+            c_txn,
+            c_docs_count,
+            &shredded->column,
+            0,
+            c_keys,
+            c_keys_stride,
+            c_options,
+            &cells_begin,
+            &cells_offs,
+            &cells_lens,
+            &arena_ptr,
+            c_error);
         if (*c_error)
             return;
 
-        for (ukv_size_t field_idx = 0; field_idx != c_fields_count; ++field_idx) {
+        // Cells, that are present, are always valid, but may need a conversion
+        ukv_type_t type = types[field_idx];
+        column_begin_t column = column_at(field_idx);
+        std::memset(column.validities, 0, bytes_per_bitmap);
+        std::size_t const width = shredded_width(shredded->type);
+        tape_iterator_t cells_it = tape_view_t {cells_begin, cells_offs, cells_lens, c_docs_count}.begin();
+        for (ukv_size_t doc_idx = 0; doc_idx != c_docs_count; ++doc_idx, ++cells_it) {
+            value_view_t cell = *cells_it;
+            if (!cell || cell.size() != width) {
+                needs_docs = true;
+                continue;
+            }
+            if (type != shredded->type) {
+                export_column(unshred_scalar(cell.begin(), shredded->type), type, doc_idx, column, arena.another_tape);
+                continue;
+            }
+            ukv_1x8_t mask_bitmap = static_cast<ukv_1x8_t>(1 << (doc_idx % CHAR_BIT));
+            column.conversions[doc_idx / CHAR_BIT] &= ~mask_bitmap;
+            column.collisions[doc_idx / CHAR_BIT] &= ~mask_bitmap;
+            column.validities[doc_idx / CHAR_BIT] |= mask_bitmap;
+            std::memcpy(column.scalars + doc_idx * width, cell.begin(), width);
+        }
+    }
+    if (!needs_docs) {
+        *c_result_strs_contents = reinterpret_cast<ukv_val_ptr_t>(arena.another_tape.data());
+        return;
+    }
 
-            // Find this field within document
-            ukv_type_t type = types[field_idx];
-            heapy_field_t const& name_or_path = (*heapy_fields)[field_idx];
-            json_t::iterator found_value_it = parsed.end();
-            json_t const& found_value =
-                name_or_path.index() == 2 //
-                    ?
-                    // This libraries doesn't implement `find` for JSON-Pointers:
-                    (parsed.contains(std::get<2>(name_or_path)) //
-                         ? parsed.at(std::get<2>(name_or_path))
-                         : null_object)
-                    // But with simple names we can query members with iterators:
-                    : ((found_value_it = parsed.find(std::get<1>(name_or_path))) != parsed.end() //
-                           ? found_value_it.value()
-                           : null_object);
-
-            column_begin_t column {
-                .validities = (*c_result_bitmap_valid)[field_idx],
-                .conversions = (*c_result_bitmap_converted)[field_idx],
-                .collisions = (*c_result_bitmap_collision)[field_idx],
-                .scalars = (*c_result_scalars)[field_idx],
-                .str_offsets = (*c_result_strs_offsets)[field_idx],
-                .str_lengths = (*c_result_strs_lengths)[field_idx],
-            };
-
-            // Export the types
-            switch (type) {
+    // Retrieve the entire documents before we can sample internal fields
+    tape_view_t binary_docs;
+    if (layout) {
+        ukv_arena_t arena_ptr = &arena;
+        ukv_val_ptr_t binary_docs_begin = nullptr;
+        ukv_val_len_t* binary_docs_offs = nullptr;
+        ukv_val_len_t* binary_docs_lens = nullptr;
+        ukv_read( //
+            c_db,
+            c_txn,
+            c_docs_count,
+            c_cols,
+            c_cols_stride,
+            c_keys,
+            c_keys_stride,
+            c_options,
+            &binary_docs_begin,
+            &binary_docs_offs,
+            &binary_docs_lens,
+            &arena_ptr,
+            c_error);
+        binary_docs = tape_view_t {binary_docs_begin, binary_docs_offs, binary_docs_lens, c_docs_count};
+    }
+    else
+        binary_docs = read_binary_docs(c_db, c_txn, tasks, c_options, arena, c_error);
+    if (*c_error)
+        return;
+    tape_iterator_t binary_docs_it = binary_docs.begin();
 
-            case ukv_type_bool_k: export_scalar_column<bool>(found_value, doc_idx, column); break;
+    // Prepare constant values
+    json_t const null_object;
+    json_t extracted;
 
-            case ukv_type_i8_k: export_scalar_column<std::int8_t>(found_value, doc_idx, column); break;
-            case ukv_type_i16_k: export_scalar_column<std::int16_t>(found_value, doc_idx, column); break;
-            case ukv_type_i32_k: export_scalar_column<std::int32_t>(found_value, doc_idx, column); break;
-            case ukv_type_i64_k: export_scalar_column<std::int64_t>(found_value, doc_idx, column); break;
+    // Unless the parsed documents are already cached, we don't build the DOM at all,
+    // and only decode the requested members, navigating through the MessagePack headers.
+    bool const navigate_dom = docs_cache.enabled();
+    static_assert(internal_format_k == ukv_format_msgpack_k, "The lazy path expects MessagePack");
+
+    // The lazy path takes the fields as strings, so restore them from the parsed ones,
+    // which works for the NUL-delimited fields as well, unlike indexing the strided input
+    std::vector<json_t::string_t> lazy_fields;
+    try {
+        if (!navigate_dom)
+            for (heapy_field_t const& name_or_path : *heapy_fields)
+                lazy_fields.push_back(name_or_path.index() == 2 ? std::get<2>(name_or_path).to_string()
+                                                                : std::get<1>(name_or_path));
+    }
+    catch (std::bad_alloc const&) {
+        *c_error = "Out of memory!";
+        return;
+    }
 
-            case ukv_type_u8_k: export_scalar_column<std::uint8_t>(found_value, doc_idx, column); break;
-            case ukv_type_u16_k: export_scalar_column<std::uint16_t>(found_value, doc_idx, column); break;
-            case ukv_type_u32_k: export_scalar_column<std::uint32_t>(found_value, doc_idx, column); break;
-            case ukv_type_u64_k: export_scalar_column<std::uint64_t>(found_value, doc_idx, column); break;
+    // Go though all the documents extracting and type-checking the relevant parts
+    for (ukv_size_t doc_idx = 0; doc_idx != c_docs_count; ++doc_idx, ++binary_docs_it) {
+        value_view_t binary_doc = *binary_docs_it;
+        auto doc_begin = reinterpret_cast<std::uint8_t const*>(binary_doc.begin());
+        auto doc_end = doc_begin + binary_doc.size();
+        std::shared_ptr<json_t const> parsed_ptr;
+        if (navigate_dom) {
+            parsed_ptr = parse_cached(tasks[doc_idx].location(), binary_doc, c_error);
+            if (*c_error)
+                return;
+        }
 
-            case ukv_type_f32_k: export_scalar_column<float>(found_value, doc_idx, column); break;
-            case ukv_type_f64_k: export_scalar_column<double>(found_value, doc_idx, column); break;
+        for (ukv_size_t field_idx = 0; field_idx != c_fields_count; ++field_idx) {
 
-            case ukv_type_str_k: export_string_column(found_value, doc_idx, column, arena.another_tape); break;
-            case ukv_type_bin_k: export_string_column(found_value, doc_idx, column, arena.another_tape); break;
+            // Skip the cells, already exported from columns
+            ukv_1x8_t mask_bitmap = static_cast<ukv_1x8_t>(1 << (doc_idx % CHAR_BIT));
+            column_begin_t column = column_at(field_idx);
+            if (layout && shredded_fields[field_idx] && (column.validities[doc_idx / CHAR_BIT] & mask_bitmap))
+                continue;
 
-            default: break;
+            // Find this field within document
+            json_t const* found_value_ptr = &null_object;
+            if (navigate_dom) {
+                json_t const& parsed = *parsed_ptr;
+                heapy_field_t const& name_or_path = (*heapy_fields)[field_idx];
+                json_t::const_iterator found_value_it = parsed.end();
+                found_value_ptr =
+                    name_or_path.index() == 2 //
+                        ?
+                        // This libraries doesn't implement `find` for JSON-Pointers:
+                        (parsed.contains(std::get<2>(name_or_path)) //
+                             ? &parsed.at(std::get<2>(name_or_path))
+                             : &null_object)
+                        // But with simple names we can query members with iterators:
+                        : ((found_value_it = parsed.find(std::get<1>(name_or_path))) != parsed.end() //
+                               ? &found_value_it.value()
+                               : &null_object);
+            }
+            else {
+                try {
+                    auto member = msgpack_find(doc_begin, doc_end, lazy_fields[field_idx].c_str());
+                    if (member && msgpack_to_json(member, doc_end, extracted))
+                        found_value_ptr = &extracted;
+                }
+                catch (std::bad_alloc const&) {
+                    *c_error = "Out of memory!";
+                    return;
+                }
             }
+            export_column(*found_value_ptr, types[field_idx], doc_idx, column, arena.another_tape);
         }
     }
 
@@ -6,12 +6,13 @@
  * Sits on top of any @see "ukv.h"-compatible system.
  */
 
-#include <numeric>  // `std::accumulate`
 #include <optional> // `std::optional`
 #include <limits>   // `std::numeric_limits`
+#include <atomic>   // `std::atomic`
 
 // #include "ukv/graph.hpp"
 #include "helpers.hpp"
+#include "pfor.hpp"
 
 /*********************************************************/
 /*****************	 C++ Implementation	  ****************/
@@ -23,7 +24,393 @@ using namespace unum;
 ukv_key_t ukv_default_edge_id_k = std::numeric_limits<ukv_key_t>::max();
 ukv_vertex_degree_t ukv_vertex_degree_missing_k = std::numeric_limits<ukv_vertex_degree_t>::max();
 
-constexpr std::size_t bytes_in_degrees_header_k = 2 * sizeof(ukv_vertex_degree_t);
+/// Upper bound for the number of threads, used in big batch operations. Zero means all hardware threads.
+std::atomic<std::size_t> graph_threads_limit {0};
+/// Minimum number of vertices or edges per thread, for batches to be split across threads.
+constexpr std::size_t graph_parallel_chunk_k = 4 * 1024;
+/// Number of vertex IDs, requested in every `ukv_scan` of `ukv_graph_export_csr`.
+constexpr ukv_size_t graph_csr_scan_k = 4 * 1024;
+
+/**
+ * @brief Every vertex is stored as this header, followed by two compressed lists of `neighborship_t`s:
+ * first the outgoing edges, where the vertex is the source, and then the incoming ones.
+ * Both lists are sorted and split into blocks of `pfor_block_k` entries. Every block
+ * is a PFOR block of neighbor IDs deltas, followed by a block of zig-zag coded deltas
+ * of edge IDs. So degrees are known from the header alone and only the requested list
+ * is ever decoded.
+ */
+struct vertex_header_t {
+    ukv_vertex_degree_t degrees[2];
+    ukv_val_len_t outgoing_bytes;
+};
+
+/**
+ * @brief Lists longer than this are split into independently coded chunks,
+ * preceded by an index of their first entries. So updates of high-degree
+ * vertices only re-encode the few chunks they touch, instead of the whole list.
+ * Layout: `[ukv_vertex_degree_t chunks][neighbors_chunk_t index[chunks]][chunks contents]`.
+ */
+constexpr std::size_t neighbors_chunk_k = 1024;
+
+struct neighbors_chunk_t {
+    neighborship_t first;
+    ukv_vertex_degree_t count;
+    /// Relative to the end of the index.
+    ukv_val_len_t offset;
+};
+
+/**
+ * @brief Kinds of sorted batches of updates, that can be merged into an adjacency list.
+ */
+enum class neighbors_update_t {
+    upsert_k,
+    erase_edges_k,
+    /// All the edges to the mentioned neighbors are removed, regardless of @c `neighborship_t::edge_id`.
+    erase_neighbors_k,
+};
+
+inline std::size_t role_idx(ukv_vertex_role_t role) noexcept {
+    return role == ukv_vertex_target_k;
+}
+
+/**
+ * @return false If the vertex is missing.
+ */
+inline bool parse_header(value_view_t bytes, vertex_header_t& header) noexcept {
+    if (bytes.size() < sizeof(vertex_header_t))
+        return false;
+    std::memcpy(&header, bytes.begin(), sizeof(vertex_header_t));
+    return true;
+}
+
+inline byte_t const* neighbors_begin(value_view_t bytes, vertex_header_t const& header, ukv_vertex_role_t role) {
+    return bytes.begin() + sizeof(vertex_header_t) + (role == ukv_vertex_target_k ? header.outgoing_bytes : 0);
+}
+
+inline value_view_t neighbors_bytes(value_view_t bytes, vertex_header_t const& header, ukv_vertex_role_t role) {
+    byte_t const* begin = neighbors_begin(bytes, header, role);
+    return {begin, role == ukv_vertex_target_k ? bytes.end() : begin + header.outgoing_bytes};
+}
+
+inline std::uint64_t zigzag(std::uint64_t delta) noexcept {
+    return (delta << 1) ^ (0 - (delta >> 63));
+}
+
+inline std::uint64_t unzigzag(std::uint64_t coded) noexcept {
+    return (coded >> 1) ^ (0 - (coded & 1));
+}
+
+inline neighbors_chunk_t chunk_at(byte_t const* list, std::size_t idx) noexcept {
+    neighbors_chunk_t chunk;
+    std::memcpy(static_cast<void*>(&chunk),
+                list + sizeof(ukv_vertex_degree_t) + idx * sizeof(neighbors_chunk_t),
+                sizeof(chunk));
+    return chunk;
+}
+
+inline ukv_vertex_degree_t chunks_count(byte_t const* list) noexcept {
+    ukv_vertex_degree_t count;
+    std::memcpy(&count, list, sizeof(count));
+    return count;
+}
+
+inline byte_t const* chunks_contents(byte_t const* list) noexcept {
+    return list + sizeof(ukv_vertex_degree_t) + chunks_count(list) * sizeof(neighbors_chunk_t);
+}
+
+/**
+ * @brief Decodes a single chunk of @p count sorted neighborships and passes
+ * them to @p callback one by one. Edge IDs can be left undecoded.
+ */
+template <bool decode_edges_ak = true, typename callback_at>
+void for_each_in_chunk(byte_t const* chunk, std::size_t count, callback_at&& callback) {
+    std::uint64_t neighbors[pfor_block_k];
+    std::uint64_t edges[pfor_block_k];
+    std::uint64_t last_neighbor = 0;
+    std::uint64_t last_edge = 0;
+    for (std::size_t passed = 0; passed != count;) {
+        std::size_t block = std::min(count - passed, pfor_block_k);
+        chunk += pfor_decode_block(chunk, block, neighbors);
+        if constexpr (decode_edges_ak)
+            chunk += pfor_decode_block(chunk, block, edges);
+        else
+            chunk += pfor_skip_block(chunk, block);
+
+        for (std::size_t i = 0; i != block; ++i) {
+            neighborship_t ship;
+            ship.neighbor_id = static_cast<ukv_key_t>(last_neighbor += neighbors[i]);
+            if constexpr (decode_edges_ak)
+                ship.edge_id = static_cast<ukv_key_t>(last_edge += unzigzag(edges[i]));
+            callback(ship);
+        }
+        passed += block;
+    }
+}
+
+/**
+ * @brief Decodes a list of @p degree sorted neighborships, starting at @p list,
+ * and passes them to @p callback one by one. Edge IDs can be left undecoded.
+ */
+template <bool decode_edges_ak = true, typename callback_at>
+void for_each_neighbor(byte_t const* list, std::size_t degree, callback_at&& callback) {
+    if (degree <= neighbors_chunk_k)
+        return for_each_in_chunk<decode_edges_ak>(list, degree, callback);
+
+    byte_t const* contents = chunks_contents(list);
+    for (std::size_t i = 0, chunks = chunks_count(list); i != chunks; ++i) {
+        neighbors_chunk_t chunk = chunk_at(list, i);
+        for_each_in_chunk<decode_edges_ak>(contents + chunk.offset, chunk.count, callback);
+    }
+}
+
+/// Upper bound for the size of an encoded chunk of @p count neighborships.
+constexpr std::size_t chunk_max_bytes(std::size_t count) noexcept {
+    return (count + pfor_block_k - 1) / pfor_block_k * 2 * pfor_block_max_bytes(0) +
+           count * 2 * sizeof(std::uint64_t);
+}
+
+/**
+ * @brief Encodes a sorted chunk of @p count neighborships into @p output,
+ * which must fit at least `chunk_max_bytes(count)`.
+ * @return The number of bytes written.
+ */
+std::size_t encode_chunk(neighborship_t const* ships, std::size_t count, byte_t* output) noexcept {
+    std::uint64_t neighbors[pfor_block_k];
+    std::uint64_t edges[pfor_block_k];
+    std::uint64_t last_neighbor = 0;
+    std::uint64_t last_edge = 0;
+    byte_t* const begin = output;
+    for (std::size_t passed = 0; passed != count;) {
+        std::size_t block = std::min(count - passed, pfor_block_k);
+        for (std::size_t i = 0; i != block; ++i) {
+            auto neighbor = static_cast<std::uint64_t>(ships[passed + i].neighbor_id);
+            auto edge = static_cast<std::uint64_t>(ships[passed + i].edge_id);
+            neighbors[i] = neighbor - std::exchange(last_neighbor, neighbor);
+            edges[i] = zigzag(edge - std::exchange(last_edge, edge));
+        }
+        output += pfor_encode_block(neighbors, block, output);
+        output += pfor_encode_block(edges, block, output);
+        passed += block;
+    }
+    return output - begin;
+}
+
+void append_chunk(neighborship_t const* ships, std::size_t count, std::vector<byte_t>& output) {
+    std::size_t const old_size = output.size();
+    output.resize(old_size + chunk_max_bytes(count));
+    output.resize(old_size + encode_chunk(ships, count, output.data() + old_size));
+}
+
+/**
+ * @brief Accumulates the chunks of a long list, before they are prefixed with an index.
+ * Overflown chunks are evenly split, so that every chunk keeps room for future insertions.
+ */
+struct chunks_builder_t {
+    std::vector<neighbors_chunk_t> index;
+    std::vector<byte_t> contents;
+    std::size_t count = 0;
+
+    void append(neighborship_t const* ships, std::size_t n) {
+        std::size_t const parts = n <= neighbors_chunk_k ? 1 : (n * 2 + neighbors_chunk_k - 1) / neighbors_chunk_k;
+        for (std::size_t part = 0; part != parts && n; ++part) {
+            std::size_t const begin = n * part / parts;
+            std::size_t const end = n * (part + 1) / parts;
+            neighbors_chunk_t chunk;
+            chunk.first = ships[begin];
+            chunk.count = static_cast<ukv_vertex_degree_t>(end - begin);
+            chunk.offset = static_cast<ukv_val_len_t>(contents.size());
+            index.push_back(chunk);
+            append_chunk(ships + begin, end - begin, contents);
+        }
+        count += n;
+    }
+
+    void append(neighbors_chunk_t chunk, value_view_t bytes) {
+        chunk.offset = static_cast<ukv_val_len_t>(contents.size());
+        index.push_back(chunk);
+        contents.insert(contents.end(), bytes.begin(), bytes.end());
+        count += chunk.count;
+    }
+
+    void export_to(std::vector<byte_t>& output) const {
+        auto chunks = static_cast<ukv_vertex_degree_t>(index.size());
+        auto chunks_bytes = reinterpret_cast<byte_t const*>(&chunks);
+        auto index_bytes = reinterpret_cast<byte_t const*>(index.data());
+        output.insert(output.end(), chunks_bytes, chunks_bytes + sizeof(chunks));
+        output.insert(output.end(), index_bytes, index_bytes + index.size() * sizeof(neighbors_chunk_t));
+        output.insert(output.end(), contents.begin(), contents.end());
+    }
+};
+
+/**
+ * @brief Merges a sorted and deduplicated batch of @p updates into sorted @p ships.
+ */
+void merge_neighbors(neighborship_t const* ships,
+                     std::size_t count,
+                     neighborship_t const* updates,
+                     std::size_t updates_count,
+                     neighbors_update_t kind,
+                     std::vector<neighborship_t>& merged) {
+    merged.clear();
+    auto inserter = std::back_inserter(merged);
+    switch (kind) {
+    case neighbors_update_t::upsert_k:
+        std::set_union(ships, ships + count, updates, updates + updates_count, inserter);
+        break;
+    case neighbors_update_t::erase_edges_k:
+        std::set_difference(ships, ships + count, updates, updates + updates_count, inserter);
+        break;
+    case neighbors_update_t::erase_neighbors_k:
+        for (neighborship_t const* ship = ships; ship != ships + count; ++ship) {
+            while (updates_count && updates->neighbor_id < ship->neighbor_id)
+                ++updates, --updates_count;
+            if (!updates_count || updates->neighbor_id != ship->neighbor_id)
+                merged.push_back(*ship);
+        }
+        break;
+    }
+}
+
+/**
+ * @brief Scratch space for `update_neighbors`, reused between vertices.
+ */
+struct neighbors_scratch_t {
+    std::vector<neighborship_t> decoded;
+    std::vector<neighborship_t> merged;
+    chunks_builder_t chunks;
+};
+
+/**
+ * @brief Applies sorted @p updates to an encoded list, appending the result to @p output.
+ * Short lists are re-encoded as a whole. In chunked lists only the chunks, that
+ * the updates fall into are decoded, and the rest are copied in binary form.
+ * @return The new number of entries in the list.
+ */
+std::size_t update_neighbors(value_view_t list,
+                             std::size_t degree,
+                             std::vector<neighborship_t> const& updates,
+                             neighbors_update_t kind,
+                             neighbors_scratch_t& scratch,
+                             std::vector<byte_t>& output) {
+
+    if (updates.empty()) {
+        output.insert(output.end(), list.begin(), list.end());
+        return degree;
+    }
+
+    auto by_neighbor = [](neighborship_t a, neighborship_t b) { return a.neighbor_id < b.neighbor_id; };
+    chunks_builder_t& chunks = scratch.chunks;
+    chunks.index.clear();
+    chunks.contents.clear();
+    chunks.count = 0;
+
+    if (degree > neighbors_chunk_k) {
+        byte_t const* contents = chunks_contents(list.begin());
+        std::size_t const count_chunks = chunks_count(list.begin());
+        for (std::size_t i = 0; i != count_chunks; ++i) {
+            neighbors_chunk_t chunk = chunk_at(list.begin(), i);
+            bool const is_last = i + 1 == count_chunks;
+            byte_t const* chunk_end = is_last ? list.end() : contents + chunk_at(list.begin(), i + 1).offset;
+
+            // Updates that belong to this chunk. The first and the last chunks are unbounded.
+            // A neighbor may have edges in several chunks, so its removal touches all of them.
+            neighborship_t const* updates_begin = updates.data();
+            neighborship_t const* updates_end = updates.data() + updates.size();
+            if (kind == neighbors_update_t::erase_neighbors_k) {
+                if (i)
+                    updates_begin = std::lower_bound(updates_begin, updates_end, chunk.first, by_neighbor);
+                if (!is_last)
+                    updates_end = std::upper_bound(updates_begin,
+                                                   updates_end,
+                                                   chunk_at(list.begin(), i + 1).first,
+                                                   by_neighbor);
+            }
+            else {
+                if (i)
+                    updates_begin = std::lower_bound(updates_begin, updates_end, chunk.first);
+                if (!is_last)
+                    updates_end = std::lower_bound(updates_begin, updates_end, chunk_at(list.begin(), i + 1).first);
+            }
+
+            if (updates_begin == updates_end) {
+                chunks.append(chunk, value_view_t {contents + chunk.offset, chunk_end});
+                continue;
+            }
+
+            scratch.decoded.clear();
+            for_each_in_chunk(contents + chunk.offset, chunk.count, [&](neighborship_t ship) {
+                scratch.decoded.push_back(ship);
+            });
+            merge_neighbors(scratch.decoded.data(),
+                            scratch.decoded.size(),
+                            updates_begin,
+                            updates_end - updates_begin,
+                            kind,
+                            scratch.merged);
+            chunks.append(scratch.merged.data(), scratch.merged.size());
+        }
+
+        if (chunks.count > neighbors_chunk_k) {
+            chunks.export_to(output);
+            return chunks.count;
+        }
+
+        // The list has shrunk enough to be stored in one piece
+        chunks.index.clear();
+        chunks.contents.clear();
+        chunks.count = 0;
+    }
+
+    scratch.decoded.clear();
+    for_each_neighbor(list.begin(), degree, [&](neighborship_t ship) { scratch.decoded.push_back(ship); });
+    merge_neighbors(scratch.decoded.data(),
+                    scratch.decoded.size(),
+                    updates.data(),
+                    updates.size(),
+                    kind,
+                    scratch.merged);
+
+    if (scratch.merged.size() <= neighbors_chunk_k)
+        append_chunk(scratch.merged.data(), scratch.merged.size(), output);
+    else {
+        chunks.append(scratch.merged.data(), scratch.merged.size());
+        chunks.export_to(output);
+    }
+    return scratch.merged.size();
+}
+
+/**
+ * @brief Applies sorted outgoing and incoming @p updates to a vertex.
+ * Missing vertices are only created by insertions.
+ */
+void update_vertex(value_t& value,
+                   std::vector<neighborship_t> const* updates,
+                   neighbors_update_t kind,
+                   neighbors_scratch_t& scratch,
+                   std::vector<byte_t>& output) {
+
+    if (updates[0].empty() && updates[1].empty())
+        return;
+
+    vertex_header_t header {};
+    value_view_t lists[2];
+    if (parse_header(value, header)) {
+        lists[0] = neighbors_bytes(value, header, ukv_vertex_source_k);
+        lists[1] = neighbors_bytes(value, header, ukv_vertex_target_k);
+    }
+    else if (kind != neighbors_update_t::upsert_k)
+        return;
+
+    output.resize(sizeof(vertex_header_t));
+    auto degree = update_neighbors(lists[0], header.degrees[0], updates[0], kind, scratch, output);
+    header.degrees[0] = static_cast<ukv_vertex_degree_t>(degree);
+    header.outgoing_bytes = static_cast<ukv_val_len_t>(output.size() - sizeof(vertex_header_t));
+    degree = update_neighbors(lists[1], header.degrees[1], updates[1], kind, scratch, output);
+    header.degrees[1] = static_cast<ukv_vertex_degree_t>(degree);
+    std::memcpy(output.data(), &header, sizeof(vertex_header_t));
+
+    value = value_view_t {output.data(), output.data() + output.size()};
+}
 
 indexed_range_gt<neighborship_t const*> neighbors(ukv_vertex_degree_t const* degrees,
                                                   ukv_key_t const* neighborships,
@@ -39,15 +426,6 @@ indexed_range_gt<neighborship_t const*> neighbors(ukv_vertex_degree_t const* deg
     __builtin_unreachable();
 }
 
-indexed_range_gt<neighborship_t const*> neighbors(value_view_t bytes, ukv_vertex_role_t role = ukv_vertex_role_any_k) {
-    // Handle missing vertices
-    if (bytes.size() < 2 * sizeof(ukv_vertex_degree_t))
-        return {};
-
-    auto degrees = reinterpret_cast<ukv_vertex_degree_t const*>(bytes.begin());
-    return neighbors(degrees, reinterpret_cast<ukv_key_t const*>(degrees + 2), role);
-}
-
 struct neighborhood_t {
     ukv_key_t center = 0;
     indexed_range_gt<neighborship_t const*> targets;
@@ -57,16 +435,6 @@ struct neighborhood_t {
     neighborhood_t(neighborhood_t const&) = default;
     neighborhood_t(neighborhood_t&&) = default;
 
-    /**
-     * @brief Parses the a single `value_view_t` chunk
-     * from the output of `ukv_graph_find_edges`.
-     */
-    inline neighborhood_t(ukv_key_t center_vertex, value_view_t bytes) noexcept {
-        center = center_vertex;
-        targets = neighbors(bytes, ukv_vertex_source_k);
-        sources = neighbors(bytes, ukv_vertex_target_k);
-    }
-
     inline neighborhood_t(ukv_key_t center_vertex,
                           ukv_vertex_degree_t const* degrees,
                           ukv_key_t const* neighborships) noexcept {
@@ -195,78 +563,6 @@ struct neighborhoods_t {
     inline std::size_t size() const noexcept { return centers_.size(); }
 };
 
-/**
- * @return true  If such an entry didn't exist and was added.
- * @return false In every other case.
- */
-bool upsert(value_t& value, ukv_vertex_role_t role, ukv_key_t neighbor_id, ukv_key_t edge_id) {
-
-    auto ship = neighborship_t {neighbor_id, edge_id};
-    if (!value.size()) {
-        value = value_t(sizeof(ukv_vertex_degree_t) * 2 + sizeof(neighborship_t));
-        auto degrees = reinterpret_cast<ukv_vertex_degree_t*>(value.begin());
-        auto ships = reinterpret_cast<neighborship_t*>(degrees + 2);
-        degrees[role != ukv_vertex_target_k] = 0;
-        degrees[role == ukv_vertex_target_k] = 1;
-        ships[0] = ship;
-        return true;
-    }
-
-    auto neighbors_range = neighbors(value, role);
-    auto it = std::lower_bound(neighbors_range.begin(), neighbors_range.end(), ship);
-    if (it != neighbors_range.end())
-        if (*it == ship)
-            return false;
-
-    auto off = reinterpret_cast<byte_t const*>(it) - value.begin();
-    auto ship_bytes = reinterpret_cast<byte_t const*>(&ship);
-    value.insert(off, ship_bytes, ship_bytes + sizeof(neighborship_t));
-    auto degrees = reinterpret_cast<ukv_vertex_degree_t*>(value.begin());
-    degrees[role == ukv_vertex_target_k] += 1;
-    return true;
-}
-
-/**
- * @return true  If a matching entry was found and deleted.
- * @return false In every other case.
- */
-bool erase(value_t& value, ukv_vertex_role_t role, ukv_key_t neighbor_id, std::optional<ukv_key_t> edge_id = {}) {
-
-    if (!value.size())
-        return false;
-
-    std::size_t off = 0;
-    std::size_t len = 0;
-
-    auto neighbors_range = neighbors(value, role);
-    if (edge_id) {
-        auto ship = neighborship_t {neighbor_id, *edge_id};
-        auto it = std::lower_bound(neighbors_range.begin(), neighbors_range.end(), ship);
-        if (it == neighbors_range.end())
-            return false;
-        else if (*it != ship)
-            return false;
-
-        off = reinterpret_cast<byte_t const*>(it) - value.begin();
-        len = sizeof(neighborship_t);
-    }
-    else {
-        auto pair = std::equal_range(neighbors_range.begin(), neighbors_range.end(), neighbor_id);
-        if (pair.first == neighbors_range.end())
-            return false;
-        else if (pair.first == pair.second)
-            return false;
-
-        off = reinterpret_cast<byte_t const*>(pair.first) - value.begin();
-        len = sizeof(neighborship_t) * (pair.second - pair.first);
-    }
-
-    value.erase(off, len);
-    auto degrees = reinterpret_cast<ukv_vertex_degree_t*>(value.begin());
-    degrees[role == ukv_vertex_target_k] -= 1;
-    return true;
-}
-
 template <bool export_center_ak = true, bool export_neighbor_ak = true, bool export_edge_ak = true>
 void export_edge_tuples( //
     ukv_t const c_db,
@@ -325,13 +621,19 @@ void export_edge_tuples( //
     {
         tape_iterator_t values_it = values.begin();
         for (ukv_size_t i = 0; i != c_vertices_count; ++i, ++values_it) {
-            value_view_t value = *values_it;
+            vertex_header_t header;
+            if (!parse_header(*values_it, header))
+                continue;
             ukv_vertex_role_t role = roles[i];
-            total_neighborships += neighbors(value, role).size();
+            if (role & ukv_vertex_source_k)
+                total_neighborships += header.degrees[0];
+            if (role & ukv_vertex_target_k)
+                total_neighborships += header.degrees[1];
         }
     }
     constexpr std::size_t tuple_size_k = export_center_ak + export_neighbor_ak + export_edge_ak;
     prepare_memory( //
+        arena,
         arena.unpacked_tape,
         total_neighborships * sizeof(ukv_key_t) * tuple_size_k + c_vertices_count * sizeof(ukv_vertex_degree_t),
         c_error);
@@ -350,39 +652,44 @@ void export_edge_tuples( //
         ukv_vertex_degree_t& degree = degrees_per_vertex[i];
 
         // Some values may be missing
-        if (value.empty()) {
+        vertex_header_t header;
+        if (!parse_header(value, header)) {
             degree = ukv_vertex_degree_missing_k;
             continue;
         }
 
         degree = 0;
         if (role & ukv_vertex_source_k) {
-            auto ns = neighbors(value, ukv_vertex_source_k);
             if constexpr (tuple_size_k != 0)
-                for (neighborship_t n : ns) {
-                    if constexpr (export_center_ak)
-                        neighborships_per_vertex[0] = vertex_id;
-                    if constexpr (export_neighbor_ak)
-                        neighborships_per_vertex[export_center_ak] = n.neighbor_id;
-                    if constexpr (export_edge_ak)
-                        neighborships_per_vertex[export_center_ak + export_neighbor_ak] = n.edge_id;
-                    neighborships_per_vertex += tuple_size_k;
-                }
-            degree += static_cast<ukv_vertex_degree_t>(ns.size());
+                for_each_neighbor<export_edge_ak>( //
+                    neighbors_begin(value, header, ukv_vertex_source_k),
+                    header.degrees[0],
+                    [&](neighborship_t n) {
+                        if constexpr (export_center_ak)
+                            neighborships_per_vertex[0] = vertex_id;
+                        if constexpr (export_neighbor_ak)
+                            neighborships_per_vertex[export_center_ak] = n.neighbor_id;
+                        if constexpr (export_edge_ak)
+                            neighborships_per_vertex[export_center_ak + export_neighbor_ak] = n.edge_id;
+                        neighborships_per_vertex += tuple_size_k;
+                    });
+            degree += header.degrees[0];
         }
         if (role & ukv_vertex_target_k) {
-            auto ns = neighbors(value, ukv_vertex_target_k);
             if constexpr (tuple_size_k != 0)
-                for (neighborship_t n : ns) {
-                    if constexpr (export_neighbor_ak)
-                        neighborships_per_vertex[0] = n.neighbor_id;
-                    if constexpr (export_center_ak)
-                        neighborships_per_vertex[export_neighbor_ak] = vertex_id;
-                    if constexpr (export_edge_ak)
-                        neighborships_per_vertex[export_center_ak + export_neighbor_ak] = n.edge_id;
-                    neighborships_per_vertex += tuple_size_k;
-                }
-            degree += static_cast<ukv_vertex_degree_t>(ns.size());
+                for_each_neighbor<export_edge_ak>( //
+                    neighbors_begin(value, header, ukv_vertex_target_k),
+                    header.degrees[1],
+                    [&](neighborship_t n) {
+                        if constexpr (export_neighbor_ak)
+                            neighborships_per_vertex[0] = n.neighbor_id;
+                        if constexpr (export_center_ak)
+                            neighborships_per_vertex[export_neighbor_ak] = vertex_id;
+                        if constexpr (export_edge_ak)
+                            neighborships_per_vertex[export_center_ak + export_neighbor_ak] = n.edge_id;
+                        neighborships_per_vertex += tuple_size_k;
+                    });
+            degree += header.degrees[1];
         }
     }
 
@@ -430,10 +737,57 @@ void export_disjoint_edge_buffers( //
     if (*c_error)
         return;
 
-    tape_view_t values {c_found_values, c_found_offsets, c_found_lengths, c_vertices_count};
-    std::size_t value_idx = 0;
-    for (value_view_t value : values)
-        arena.updated_vals[value_idx++] = value;
+    prepare_memory(arena, arena.updated_neighbors, c_vertices_count * 2, c_error);
+    if (*c_error)
+        return;
+
+    try {
+        tape_view_t values {c_found_values, c_found_offsets, c_found_lengths, c_vertices_count};
+        std::size_t value_idx = 0;
+        for (value_view_t value : values)
+            arena.updated_vals[value_idx++] = value;
+        for (auto& updates : arena.updated_neighbors)
+            updates.clear();
+    }
+    catch (...) {
+        *c_error = "Failed to copy adjacency lists!";
+    }
+}
+
+/**
+ * @brief Merges the updates, gathered in `stl_arena_t::updated_neighbors`, into the
+ * compressed vertices in `stl_arena_t::updated_vals`, within `[begin, end)` range.
+ * Disjoint ranges can be processed concurrently.
+ */
+void import_disjoint_edge_buffers(stl_arena_t& arena,
+                                  std::size_t begin,
+                                  std::size_t end,
+                                  neighbors_update_t kind,
+                                  std::atomic<ukv_error_t>& error) noexcept {
+    try {
+        neighbors_scratch_t scratch;
+        std::vector<byte_t> output;
+        for (std::size_t i = begin; i != end; ++i) {
+            std::vector<neighborship_t>* updates = &arena.updated_neighbors[i * 2];
+            sort_and_deduplicate(updates[0]);
+            sort_and_deduplicate(updates[1]);
+            update_vertex(arena.updated_vals[i], updates, kind, scratch, output);
+        }
+    }
+    catch (...) {
+        report_error(error, "Failed to encode adjacency lists!");
+    }
+}
+
+void import_disjoint_edge_buffers(stl_arena_t& arena, neighbors_update_t kind, ukv_error_t* c_error) {
+    std::atomic<ukv_error_t> error {nullptr};
+    parallel_for_chunks(arena.updated_vals.size(),
+                        graph_parallel_chunk_k,
+                        graph_threads_limit.load(),
+                        [&](std::size_t begin, std::size_t end) noexcept {
+                            import_disjoint_edge_buffers(arena, begin, end, kind, error);
+                        });
+    *c_error = error.load();
 }
 
 template <bool erase_ak>
@@ -469,7 +823,7 @@ void update_neighborhoods( //
     strided_iterator_gt<ukv_key_t const> targets_ids {c_targets_ids, c_targets_stride};
 
     // Fetch all the data related to touched vertices
-    prepare_memory(arena.updated_keys, c_tasks_count + c_tasks_count, c_error);
+    prepare_memory(arena, arena.updated_keys, c_tasks_count + c_tasks_count, c_error);
     if (*c_error)
         return;
     for (ukv_size_t i = 0; i != c_tasks_count; ++i)
@@ -479,7 +833,7 @@ void update_neighborhoods( //
 
     // Keep only the unique items
     sort_and_deduplicate(arena.updated_keys);
-    prepare_memory(arena.updated_vals, arena.updated_keys.size(), c_error);
+    prepare_memory(arena, arena.updated_vals, arena.updated_keys.size(), c_error);
     if (*c_error)
         return;
 
@@ -496,31 +850,51 @@ void update_neighborhoods( //
     if (*c_error)
         return;
 
-    // Upsert into in-memory arrays
-    for (ukv_size_t i = 0; i != c_tasks_count; ++i) {
-        auto collection = collections[i];
-        auto source_id = sources_ids[i];
-        auto target_id = targets_ids[i];
-
-        auto source_idx = offset_in_sorted(arena.updated_keys, {collection, source_id});
-        auto target_idx = offset_in_sorted(arena.updated_keys, {collection, target_id});
-        auto& source_value = arena.updated_vals[source_idx];
-        auto& target_value = arena.updated_vals[target_idx];
-
-        if constexpr (erase_ak) {
-            std::optional<ukv_key_t> edge_id;
-            if (edges_ids)
-                edge_id = edges_ids[i];
-
-            erase(source_value, ukv_vertex_source_k, target_id, edge_id);
-            erase(target_value, ukv_vertex_target_k, source_id, edge_id);
+    // Locate both ends of every edge
+    std::vector<std::size_t> ends;
+    try {
+        ends.resize(c_tasks_count * 2);
+    }
+    catch (...) {
+        *c_error = "Failed to allocate memory!";
+        return;
+    }
+    std::size_t const threads_limit = graph_threads_limit.load();
+    auto locate_ends = [&](std::size_t begin, std::size_t end) noexcept {
+        for (std::size_t i = begin; i != end; ++i) {
+            ends[i * 2] = offset_in_sorted(arena.updated_keys, {collections[i], sources_ids[i]});
+            ends[i * 2 + 1] = offset_in_sorted(arena.updated_keys, {collections[i], targets_ids[i]});
         }
-        else {
-            auto edge_id = edges_ids[i];
-            upsert(source_value, ukv_vertex_source_k, target_id, edge_id);
-            upsert(target_value, ukv_vertex_target_k, source_id, edge_id);
+    };
+    parallel_for_chunks(c_tasks_count, graph_parallel_chunk_k, threads_limit, locate_ends);
+
+    // Every thread gathers the updates of its own range of vertices and merges them
+    auto kind = erase_ak ? (edges_ids ? neighbors_update_t::erase_edges_k : neighbors_update_t::erase_neighbors_k)
+                         : neighbors_update_t::upsert_k;
+    std::atomic<ukv_error_t> error {nullptr};
+    auto update_range = [&](std::size_t begin, std::size_t end) noexcept {
+        try {
+            for (ukv_size_t i = 0; i != c_tasks_count; ++i) {
+                auto edge_id = edges_ids ? edges_ids[i] : ukv_key_t(0);
+                auto source_idx = ends[i * 2];
+                auto target_idx = ends[i * 2 + 1];
+                if (source_idx >= begin && source_idx < end)
+                    arena.updated_neighbors[source_idx * 2 + role_idx(ukv_vertex_source_k)].push_back(
+                        {targets_ids[i], edge_id});
+                if (target_idx >= begin && target_idx < end)
+                    arena.updated_neighbors[target_idx * 2 + role_idx(ukv_vertex_target_k)].push_back(
+                        {sources_ids[i], edge_id});
+            }
         }
-    }
+        catch (...) {
+            report_error(error, "Failed to gather edges updates!");
+            return;
+        }
+        import_disjoint_edge_buffers(arena, begin, end, kind, error);
+    };
+    parallel_for_chunks(arena.updated_vals.size(), graph_parallel_chunk_k, threads_limit, update_range);
+    if ((*c_error = error.load()))
+        return;
 
     // Dump the data back to disk!
     ukv_val_len_t offset_in_val = 0;
@@ -542,6 +916,10 @@ void update_neighborhoods( //
               c_error);
 }
 
+void ukv_graph_threads_limit(ukv_size_t const c_threads) {
+    graph_threads_limit = c_threads;
+}
+
 void ukv_graph_find_edges( //
     ukv_t const c_db,
     ukv_txn_t const c_txn,
@@ -582,6 +960,340 @@ void ukv_graph_find_edges( //
                 c_error);
 }
 
+void ukv_graph_traverse( //
+    ukv_t const c_db,
+    ukv_txn_t const c_txn,
+    ukv_col_t const c_col,
+
+    ukv_size_t const c_starts_count,
+    ukv_key_t const* c_starts_ids,
+    ukv_size_t const c_starts_stride,
+
+    ukv_vertex_role_t const c_role,
+    ukv_size_t const c_max_depth,
+    ukv_size_t const c_max_visits,
+    ukv_options_t const c_options,
+
+    ukv_size_t* c_vertices_count,
+    ukv_key_t** c_vertices_ids,
+    ukv_size_t** c_depths_per_vertex,
+    ukv_key_t** c_edges_per_vertex,
+
+    ukv_arena_t* c_arena,
+    ukv_error_t* c_error) {
+
+    if (!c_db && (*c_error = "DataBase is NULL!"))
+        return;
+    if (!c_vertices_count && (*c_error = "Vertices count output is NULL!"))
+        return;
+
+    stl_arena_t& arena = *cast_arena(c_arena, c_error);
+    if (*c_error)
+        return;
+
+    strided_range_gt<ukv_key_t const> starts {c_starts_ids, c_starts_stride, c_starts_count};
+    std::size_t const max_visits = c_max_visits ? c_max_visits : std::numeric_limits<std::size_t>::max();
+    auto options = static_cast<ukv_options_t>(c_options & ~ukv_option_read_lengths_k);
+
+    // Vertices in the order of discovery, and the edges, that led to them
+    std::vector<ukv_key_t> found;
+    std::vector<ukv_size_t> depths;
+    std::vector<edge_t> edges;
+    // The visited filter is a sorted set
+    std::vector<ukv_key_t> visited;
+    std::vector<ukv_key_t> frontier;
+    std::vector<std::pair<ukv_key_t, edge_t>> candidates;
+
+    try {
+        frontier.resize(starts.size());
+        for (std::size_t i = 0; i != starts.size(); ++i)
+            frontier[i] = starts[i];
+        sort_and_deduplicate(frontier);
+
+        // Only present starts are reported
+        ukv_vertex_degree_t* degrees_per_vertex = nullptr;
+        ukv_key_t* neighborships_per_vertex = nullptr;
+        export_edge_tuples<false, false, false>(c_db,
+                                                c_txn,
+                                                static_cast<ukv_size_t>(frontier.size()),
+                                                &c_col,
+                                                0,
+                                                frontier.data(),
+                                                sizeof(ukv_key_t),
+                                                &c_role,
+                                                0,
+                                                options,
+                                                &degrees_per_vertex,
+                                                &neighborships_per_vertex,
+                                                c_arena,
+                                                c_error);
+        if (*c_error)
+            return;
+
+        for (std::size_t i = 0; i != frontier.size(); ++i)
+            if (degrees_per_vertex[i] != ukv_vertex_degree_missing_k && found.size() != max_visits)
+                found.push_back(frontier[i]);
+        frontier = visited = found;
+        depths.resize(found.size(), 0);
+
+        for (ukv_size_t depth = 1; depth <= c_max_depth && !frontier.empty() && found.size() != max_visits; ++depth) {
+
+            // Fetch the whole frontier at once
+            export_edge_tuples<true, true, true>(c_db,
+                                                 c_txn,
+                                                 static_cast<ukv_size_t>(frontier.size()),
+                                                 &c_col,
+                                                 0,
+                                                 frontier.data(),
+                                                 sizeof(ukv_key_t),
+                                                 &c_role,
+                                                 0,
+                                                 options,
+                                                 &degrees_per_vertex,
+                                                 &neighborships_per_vertex,
+                                                 c_arena,
+                                                 c_error);
+            if (*c_error)
+                return;
+
+            candidates.clear();
+            for (std::size_t i = 0; i != frontier.size(); ++i) {
+                if (degrees_per_vertex[i] == ukv_vertex_degree_missing_k)
+                    continue;
+                for (ukv_vertex_degree_t j = 0; j != degrees_per_vertex[i]; ++j) {
+                    edge_t edge;
+                    std::memcpy(static_cast<void*>(&edge), neighborships_per_vertex, sizeof(edge_t));
+                    neighborships_per_vertex += 3;
+                    ukv_key_t neighbor = edge.source_id == frontier[i] ? edge.target_id : edge.source_id;
+                    if (!std::binary_search(visited.begin(), visited.end(), neighbor))
+                        candidates.emplace_back(neighbor, edge);
+                }
+            }
+
+            // Deduplicate the next frontier, keeping the first edge to every vertex
+            std::stable_sort(candidates.begin(), candidates.end(), [](auto const& a, auto const& b) {
+                return a.first < b.first;
+            });
+            frontier.clear();
+            for (std::size_t i = 0; i != candidates.size() && found.size() != max_visits; ++i) {
+                if (i && candidates[i].first == candidates[i - 1].first)
+                    continue;
+                frontier.push_back(candidates[i].first);
+                found.push_back(candidates[i].first);
+                depths.push_back(depth);
+                edges.push_back(candidates[i].second);
+            }
+
+            std::size_t const old_visited = visited.size();
+            visited.insert(visited.end(), frontier.begin(), frontier.end());
+            std::inplace_merge(visited.begin(), visited.begin() + old_visited, visited.end());
+        }
+    }
+    catch (...) {
+        *c_error = "Failed to traverse the graph!";
+        return;
+    }
+
+    // Export into arena
+    std::size_t const count = found.size();
+    auto tape = prepare_memory( //
+        arena,
+        arena.unpacked_tape,
+        count * (sizeof(ukv_key_t) + sizeof(ukv_size_t)) + edges.size() * sizeof(edge_t),
+        c_error);
+    if (*c_error)
+        return;
+
+    auto vertices_ids = reinterpret_cast<ukv_key_t*>(tape);
+    auto depths_per_vertex = reinterpret_cast<ukv_size_t*>(vertices_ids + count);
+    auto edges_per_vertex = reinterpret_cast<ukv_key_t*>(depths_per_vertex + count);
+    std::copy(found.begin(), found.end(), vertices_ids);
+    std::copy(depths.begin(), depths.end(), depths_per_vertex);
+    std::memcpy(edges_per_vertex, edges.data(), edges.size() * sizeof(edge_t));
+
+    *c_vertices_count = static_cast<ukv_size_t>(count);
+    if (c_vertices_ids)
+        *c_vertices_ids = vertices_ids;
+    if (c_depths_per_vertex)
+        *c_depths_per_vertex = depths_per_vertex;
+    if (c_edges_per_vertex)
+        *c_edges_per_vertex = edges_per_vertex;
+}
+
+void ukv_graph_export_csr( //
+    ukv_t const c_db,
+    ukv_txn_t const c_txn,
+    ukv_col_t const c_col,
+
+    ukv_key_t const c_min_key,
+    ukv_key_t const c_max_key,
+
+    ukv_vertex_role_t const c_role,
+    ukv_options_t const c_options,
+
+    ukv_size_t* c_vertices_count,
+    ukv_key_t** c_vertices_ids,
+    ukv_size_t** c_offsets_per_vertex,
+    ukv_key_t** c_neighbors_ids,
+    ukv_key_t** c_edges_ids,
+
+    ukv_arena_t* c_arena,
+    ukv_error_t* c_error) {
+
+    if (!c_db && (*c_error = "DataBase is NULL!"))
+        return;
+    if (!c_vertices_count && (*c_error = "Vertices count output is NULL!"))
+        return;
+
+    stl_arena_t& arena = *cast_arena(c_arena, c_error);
+    if (*c_error)
+        return;
+
+    auto options = static_cast<ukv_options_t>(c_options & ~ukv_option_read_lengths_k);
+    std::vector<ukv_key_t> vertices;
+    std::vector<value_view_t> values;
+
+    try {
+        // 1. Collect the IDs of all the vertices in range, batch by batch
+        ukv_key_t next_min_key = c_min_key;
+        ukv_size_t scan_length = graph_csr_scan_k;
+        while (next_min_key < c_max_key) {
+            ukv_key_t* found_keys = nullptr;
+            ukv_val_len_t* found_lengths = nullptr;
+            ukv_scan(c_db,
+                     c_txn,
+                     1,
+                     &c_col,
+                     0,
+                     &next_min_key,
+                     0,
+                     &scan_length,
+                     0,
+                     options,
+                     &found_keys,
+                     &found_lengths,
+                     c_arena,
+                     c_error);
+            if (*c_error)
+                return;
+
+            auto found_end = std::find(found_keys, found_keys + scan_length, ukv_key_unknown_k);
+            auto range_end = std::lower_bound(found_keys, found_end, c_max_key);
+            vertices.insert(vertices.end(), found_keys, range_end);
+            if (range_end != found_keys + scan_length)
+                break;
+            next_min_key = found_keys[scan_length - 1] + 1;
+        }
+
+        // 2. Fetch all the adjacency lists at once
+        ukv_val_ptr_t found_values = nullptr;
+        ukv_val_len_t* found_offsets = nullptr;
+        ukv_val_len_t* found_lengths = nullptr;
+        ukv_read(c_db,
+                 c_txn,
+                 static_cast<ukv_size_t>(vertices.size()),
+                 &c_col,
+                 0,
+                 vertices.data(),
+                 sizeof(ukv_key_t),
+                 options,
+                 &found_values,
+                 &found_offsets,
+                 &found_lengths,
+                 c_arena,
+                 c_error);
+        if (*c_error)
+            return;
+
+        values.resize(vertices.size());
+        tape_iterator_t values_it {found_values, found_offsets, found_lengths};
+        for (std::size_t i = 0; i != values.size(); ++i, ++values_it)
+            values[i] = *values_it;
+    }
+    catch (...) {
+        *c_error = "Failed to allocate memory!";
+        return;
+    }
+
+    // 3. Drop the vertices, removed since the scan, and size the neighbors arrays from headers alone
+    auto degree_of = [&](vertex_header_t const& header) {
+        return ukv_size_t(c_role & ukv_vertex_source_k ? header.degrees[0] : 0) +
+               ukv_size_t(c_role & ukv_vertex_target_k ? header.degrees[1] : 0);
+    };
+    std::size_t count = 0;
+    ukv_size_t total_neighbors = 0;
+    for (std::size_t i = 0; i != vertices.size(); ++i) {
+        vertex_header_t header;
+        if (!parse_header(values[i], header))
+            continue;
+        vertices[count] = vertices[i];
+        values[count] = values[i];
+        total_neighbors += degree_of(header);
+        ++count;
+    }
+
+    bool const export_edges = c_edges_ids != nullptr;
+    auto tape = prepare_memory( //
+        arena,
+        arena.unpacked_tape,
+        count * sizeof(ukv_key_t) + (count + 1) * sizeof(ukv_size_t) +
+            total_neighbors * sizeof(ukv_key_t) * (1 + export_edges),
+        c_error);
+    if (*c_error)
+        return;
+
+    auto vertices_ids = reinterpret_cast<ukv_key_t*>(tape);
+    auto offsets_per_vertex = reinterpret_cast<ukv_size_t*>(vertices_ids + count);
+    auto neighbors_ids = reinterpret_cast<ukv_key_t*>(offsets_per_vertex + count + 1);
+    auto edges_ids = neighbors_ids + total_neighbors;
+    std::copy_n(vertices.begin(), count, vertices_ids);
+    offsets_per_vertex[0] = 0;
+    for (std::size_t i = 0; i != count; ++i) {
+        vertex_header_t header;
+        parse_header(values[i], header);
+        offsets_per_vertex[i + 1] = offsets_per_vertex[i] + degree_of(header);
+    }
+
+    // 4. Decode disjoint ranges of vertices into disjoint slices of the output
+    auto decode_range = [&](std::size_t begin, std::size_t end) noexcept {
+        for (std::size_t i = begin; i != end; ++i) {
+            vertex_header_t header;
+            parse_header(values[i], header);
+            ukv_size_t offset = offsets_per_vertex[i];
+            auto export_list = [&](ukv_vertex_role_t role) {
+                auto list = neighbors_begin(values[i], header, role);
+                auto degree = header.degrees[role_idx(role)];
+                if (export_edges)
+                    for_each_neighbor<true>(list, degree, [&](neighborship_t n) {
+                        neighbors_ids[offset] = n.neighbor_id;
+                        edges_ids[offset] = n.edge_id;
+                        ++offset;
+                    });
+                else
+                    for_each_neighbor<false>(list, degree, [&](neighborship_t n) {
+                        neighbors_ids[offset] = n.neighbor_id;
+                        ++offset;
+                    });
+            };
+            if (c_role & ukv_vertex_source_k)
+                export_list(ukv_vertex_source_k);
+            if (c_role & ukv_vertex_target_k)
+                export_list(ukv_vertex_target_k);
+        }
+    };
+    parallel_for_chunks(count, graph_parallel_chunk_k, graph_threads_limit.load(), decode_range);
+
+    *c_vertices_count = static_cast<ukv_size_t>(count);
+    if (c_vertices_ids)
+        *c_vertices_ids = vertices_ids;
+    if (c_offsets_per_vertex)
+        *c_offsets_per_vertex = offsets_per_vertex;
+    if (c_neighbors_ids)
+        *c_neighbors_ids = neighbors_ids;
+    if (c_edges_ids)
+        *c_edges_ids = edges_ids;
+}
+
 void ukv_graph_upsert_edges( //
     ukv_t const c_db,
     ukv_txn_t const c_txn,
@@ -708,11 +1420,12 @@ void ukv_graph_remove_vertices( //
 
     // Enumerate the opposite ends, from which that same reference must be removed.
     // Here all the keys will be in the sorted order.
-    std::size_t count_edges = std::accumulate(degrees_per_vertex, degrees_per_vertex + c_vertices_count, 0ul);
-    arena.updated_keys.reserve(count_edges * 2);
+    arena.updated_keys.clear();
     for (ukv_size_t i = 0; i != c_vertices_count; ++i, ++degrees_per_vertex) {
         auto collection = collections[i];
         arena.updated_keys.push_back({collection, vertices_ids[i]});
+        if (*degrees_per_vertex == ukv_vertex_degree_missing_k)
+            continue;
         for (ukv_size_t j = 0; j != *degrees_per_vertex; ++j, ++neighbors_per_vertex)
             arena.updated_keys.push_back({collection, *neighbors_per_vertex});
     }
@@ -720,7 +1433,7 @@ void ukv_graph_remove_vertices( //
     // Sorting the tasks would help us faster locate them in the future.
     // We may also face repetitions when connected vertices are removed.
     sort_and_deduplicate(arena.updated_keys);
-    prepare_memory(arena.updated_vals, arena.updated_keys.size(), c_error);
+    prepare_memory(arena, arena.updated_vals, arena.updated_keys.size(), c_error);
     if (*c_error)
         return;
 
@@ -740,28 +1453,46 @@ void ukv_graph_remove_vertices( //
         return;
 
     // From every opposite end - remove a match, and only then - the content itself
-    for (ukv_size_t i = 0; i != arena.updated_keys.size(); ++i) {
-        auto collection = collections[i];
-        auto vertex_id = vertices_ids[i];
-        auto role = roles[i];
-
-        auto vertex_idx = offset_in_sorted(arena.updated_keys, {collection, vertex_id});
-        value_t& vertex_value = arena.updated_vals[vertex_idx];
-
-        for (neighborship_t n : neighbors(vertex_value, role)) {
-            auto neighbor_idx = offset_in_sorted(arena.updated_keys, {collection, n.neighbor_id});
-            value_t& neighbor_value = arena.updated_vals[neighbor_idx];
-            if (role == ukv_vertex_role_any_k) {
-                erase(neighbor_value, ukv_vertex_source_k, vertex_id);
-                erase(neighbor_value, ukv_vertex_target_k, vertex_id);
+    try {
+        for (ukv_size_t i = 0; i != c_vertices_count; ++i) {
+            auto collection = collections[i];
+            auto vertex_id = vertices_ids[i];
+            auto role = roles[i];
+
+            auto vertex_idx = offset_in_sorted(arena.updated_keys, {collection, vertex_id});
+            value_t const& vertex_value = arena.updated_vals[vertex_idx];
+            vertex_header_t header;
+            if (!parse_header(vertex_value, header))
+                continue;
+
+            for (ukv_vertex_role_t own_role : {ukv_vertex_source_k, ukv_vertex_target_k}) {
+                if (!(role & own_role))
+                    continue;
+                auto opposite_idx = role_idx(invert(own_role));
+                for_each_neighbor<false>( //
+                    neighbors_begin(vertex_value, header, own_role),
+                    header.degrees[role_idx(own_role)],
+                    [&](neighborship_t n) {
+                        auto neighbor_idx = offset_in_sorted(arena.updated_keys, {collection, n.neighbor_id});
+                        arena.updated_neighbors[neighbor_idx * 2 + opposite_idx].push_back({vertex_id, 0});
+                    });
             }
-            else
-                erase(neighbor_value, invert(role), vertex_id);
         }
+    }
+    catch (...) {
+        *c_error = "Failed to gather edges updates!";
+        return;
+    }
 
-        vertex_value.reset();
+    for (ukv_size_t i = 0; i != c_vertices_count; ++i) {
+        auto vertex_idx = offset_in_sorted(arena.updated_keys, {collections[i], vertices_ids[i]});
+        arena.updated_vals[vertex_idx].reset();
     }
 
+    import_disjoint_edge_buffers(arena, neighbors_update_t::erase_neighbors_k, c_error);
+    if (*c_error)
+        return;
+
     // Now we will go through all the explicitly deleted vertices
     ukv_val_len_t offset_in_val = 0;
     ukv_write(c_db,
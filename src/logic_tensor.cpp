@@ -0,0 +1,112 @@
+/**
+ * @file logic_tensor.cpp
+ * @author Ashot Vardanian
+ *
+ * @brief "TenPack" gathers of fixed-length values into dense tensors, @see "ukv/tensor.h".
+ * Sits on top of any @see "ukv.h"-compatible system.
+ */
+
+#include <cstring> // `std::memcpy`
+
+#include "ukv/tensor.h"
+#include "helpers.hpp"
+
+/*********************************************************/
+/*****************	 C++ Implementation	  ****************/
+/*********************************************************/
+
+using namespace unum::ukv;
+using namespace unum;
+
+/// Minimum number of bytes per thread, for copies to be split across threads.
+constexpr std::size_t parallel_copy_bytes_k = 4 * 1024 * 1024;
+
+/*********************************************************/
+/*****************	    C Interface 	  ****************/
+/*********************************************************/
+
+void ukv_read_tensor( //
+    ukv_t const c_db,
+    ukv_txn_t const c_txn,
+    ukv_size_t const c_tasks_count,
+
+    ukv_col_t const* c_cols,
+    ukv_size_t const c_cols_stride,
+
+    ukv_key_t const* c_keys,
+    ukv_size_t const c_keys_stride,
+
+    ukv_options_t const c_options,
+
+    ukv_val_len_t* c_row_length,
+    ukv_val_ptr_t* c_tensor,
+
+    ukv_arena_t* c_arena,
+    ukv_error_t* c_error) {
+
+    if (!c_db && (*c_error = "DataBase is NULL!"))
+        return;
+    if ((!c_row_length || !c_tensor) && (*c_error = "Row length and tensor outputs are required!"))
+        return;
+
+    stl_arena_t& arena = *cast_arena(c_arena, c_error);
+    if (*c_error)
+        return;
+
+    ukv_val_ptr_t found_values = nullptr;
+    ukv_val_len_t* found_offsets = nullptr;
+    ukv_val_len_t* found_lengths = nullptr;
+    auto options = static_cast<ukv_options_t>(c_options & ~ukv_option_read_lengths_k);
+    ukv_read(c_db,
+             c_txn,
+             c_tasks_count,
+             c_cols,
+             c_cols_stride,
+             c_keys,
+             c_keys_stride,
+             options,
+             &found_values,
+             &found_offsets,
+             &found_lengths,
+             c_arena,
+             c_error);
+    if (*c_error)
+        return;
+
+    // Validate the lengths, checking if the rows are already back to back
+    std::size_t const n = c_tasks_count;
+    ukv_val_len_t const row_length = *c_row_length || !n ? *c_row_length : found_lengths[0];
+    bool is_dense = true;
+    for (std::size_t i = 0; i != n; ++i) {
+        if (found_lengths[i] == ukv_val_len_missing_k && (*c_error = "Missing values can't be packed into a tensor!"))
+            return;
+        if (found_lengths[i] != row_length && (*c_error = "Values of different lengths can't form a tensor!"))
+            return;
+        is_dense &= found_offsets[i] == found_offsets[0] + i * row_length;
+    }
+    *c_row_length = row_length;
+
+    ukv_val_ptr_t const first_row = n ? found_values + found_offsets[0] : found_values;
+    if (!*c_tensor) {
+        if (is_dense) {
+            *c_tensor = first_row;
+            return;
+        }
+        auto tape = prepare_memory(arena, arena.unpacked_tape, n * row_length, c_error);
+        *c_tensor = reinterpret_cast<ukv_val_ptr_t>(tape);
+        if (*c_error)
+            return;
+    }
+
+    // Big tensors are copied from multiple threads, to saturate the memory bandwidth
+    ukv_val_ptr_t const tensor = *c_tensor;
+    std::size_t const min_rows = parallel_copy_bytes_k / std::max<std::size_t>(row_length, 1);
+    parallel_for_chunks(n, min_rows, 0, [&](std::size_t begin, std::size_t end) noexcept {
+        if (is_dense) {
+            std::memcpy(tensor + begin * row_length, first_row + begin * row_length, (end - begin) * row_length);
+            return;
+        }
+        for (std::size_t i = begin; i != end; ++i)
+            std::memcpy(tensor + i * row_length, found_values + found_offsets[i], row_length);
+    });
+}
@@ -0,0 +1,389 @@
+/**
+ * @file metrics.hpp
+ * @author Ashot Vardanian
+ *
+ * @brief Counters and latency histograms of the C API calls, shared by all the backends.
+ *
+ * Every call of `ukv_read`, `ukv_write`, `ukv_scan`, `ukv_size`, `ukv_txn_begin` and
+ * `ukv_txn_commit` is wrapped into a `metrics_scope_t`, which records its latency,
+ * the number of tasks and the failure. Nothing is ever locked on those paths:
+ * > Global counters are split into cache-line aligned shards, one per group
+ *   of threads, and are only summed up, when the metrics are exported.
+ * > Collections claim slots of a fixed-size open-addressing table with a single CAS.
+ * The latency of a batch, spanning multiple collections, is attributed to the
+ * collection of the first task.
+ *
+ * The `ukv_db_control` requests of the backends expose them:
+ * > "metrics":             JSON object.
+ * > "metrics.prometheus":  Prometheus text exposition format.
+ */
+#pragma once
+#include <cstdint>     // `std::uint64_t`
+#include <chrono>      // `std::chrono::steady_clock`
+#include <atomic>      // `std::atomic`
+#include <string>      // `std::string`
+#include <string_view> // `std::string_view`
+#include <algorithm>   // `std::min`
+#include <iterator>    // `std::size`
+
+#include "helpers.hpp"
+
+namespace unum::ukv {
+
+enum class metric_op_t : std::uint8_t {
+    read_k = 0,
+    write_k,
+    scan_k,
+    size_k,
+    txn_begin_k,
+    txn_commit_k,
+};
+
+static constexpr std::size_t metric_ops_k = 6;
+
+inline char const* metric_op_name(std::size_t op) noexcept {
+    constexpr char const* names[metric_ops_k] = {"read", "write", "scan", "size", "txn_begin", "txn_commit"};
+    return names[op];
+}
+
+/**
+ * @brief HDR-style histogram of nanosecond latencies.
+ * Every power-of-two range is split into `sub_buckets_k` linear buckets,
+ * keeping the relative error of quantiles below `1 / sub_buckets_k`,
+ * while covering the range from 1 ns to half an hour in 160 counters.
+ */
+class latency_histogram_t {
+  public:
+    static constexpr std::size_t sub_bits_k = 2;
+    static constexpr std::size_t sub_buckets_k = 1ull << sub_bits_k;
+    static constexpr std::size_t buckets_k = 40 * sub_buckets_k;
+
+    static std::size_t bucket(std::uint64_t ns) noexcept {
+        if (ns < sub_buckets_k)
+            return static_cast<std::size_t>(ns);
+        std::size_t magnitude = 63 - __builtin_clzll(ns);
+        std::size_t sub = (ns >> (magnitude - sub_bits_k)) & (sub_buckets_k - 1);
+        return std::min((magnitude - sub_bits_k + 1) * sub_buckets_k + sub, buckets_k - 1);
+    }
+
+    /// Exclusive upper bound of values, that fall into the @p idx bucket.
+    static std::uint64_t upper_bound(std::size_t idx) noexcept {
+        if (idx < sub_buckets_k)
+            return idx + 1;
+        std::size_t magnitude = idx / sub_buckets_k + sub_bits_k - 1;
+        std::size_t sub = idx % sub_buckets_k;
+        return static_cast<std::uint64_t>(sub_buckets_k + sub + 1) << (magnitude - sub_bits_k);
+    }
+
+    void record(std::uint64_t ns) noexcept { counts_[bucket(ns)].fetch_add(1, std::memory_order_relaxed); }
+    std::uint64_t count(std::size_t idx) const noexcept { return counts_[idx].load(std::memory_order_relaxed); }
+
+  private:
+    std::atomic<std::uint64_t> counts_[buckets_k] {};
+};
+
+struct op_metrics_t {
+    std::atomic<std::uint64_t> calls {0};
+    std::atomic<std::uint64_t> failures {0};
+    std::atomic<std::uint64_t> tasks {0};
+    std::atomic<std::uint64_t> total_ns {0};
+    latency_histogram_t latency;
+
+    void record(ukv_size_t tasks_count, std::uint64_t ns, bool failed) noexcept {
+        calls.fetch_add(1, std::memory_order_relaxed);
+        failures.fetch_add(failed, std::memory_order_relaxed);
+        tasks.fetch_add(tasks_count, std::memory_order_relaxed);
+        total_ns.fetch_add(ns, std::memory_order_relaxed);
+        latency.record(ns);
+    }
+};
+
+/// Non-atomic sum of `op_metrics_t` across shards, that can answer quantile queries.
+struct op_summary_t {
+    std::uint64_t calls = 0;
+    std::uint64_t failures = 0;
+    std::uint64_t tasks = 0;
+    std::uint64_t total_ns = 0;
+    std::uint64_t counts[latency_histogram_t::buckets_k] {};
+
+    void add(op_metrics_t const& op) noexcept {
+        calls += op.calls.load(std::memory_order_relaxed);
+        failures += op.failures.load(std::memory_order_relaxed);
+        tasks += op.tasks.load(std::memory_order_relaxed);
+        total_ns += op.total_ns.load(std::memory_order_relaxed);
+        for (std::size_t i = 0; i != latency_histogram_t::buckets_k; ++i)
+            counts[i] += op.latency.count(i);
+    }
+
+    /// Upper bound of the bucket, containing the @p q quantile, in nanoseconds.
+    std::uint64_t quantile(double q) const noexcept {
+        std::uint64_t total = 0;
+        for (std::uint64_t count : counts)
+            total += count;
+        if (!total)
+            return 0;
+        std::uint64_t rank = static_cast<std::uint64_t>(q * static_cast<double>(total - 1)) + 1;
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i != latency_histogram_t::buckets_k; ++i)
+            if ((seen += counts[i]) >= rank)
+                return latency_histogram_t::upper_bound(i);
+        return latency_histogram_t::upper_bound(latency_histogram_t::buckets_k - 1);
+    }
+};
+
+inline constexpr double metric_quantiles_k[] = {0.5, 0.9, 0.99, 0.999};
+inline constexpr char const* metric_quantile_names_k[] = {"p50_ns", "p90_ns", "p99_ns", "p999_ns"};
+inline constexpr char const* metric_quantile_labels_k[] = {"0.5", "0.9", "0.99", "0.999"};
+
+/**
+ * @brief Metrics of a single database instance.
+ * Is meant to be a member of the backend state and outlive all the calls.
+ */
+class metrics_t {
+  public:
+    static constexpr std::size_t shards_k = 16;
+    static constexpr std::size_t cols_k = 32;
+
+    /// Transactions, that failed to commit due to concurrent updates of the same keys.
+    std::atomic<std::uint64_t> txn_conflicts {0};
+    /// Transactions with updates, that were restarted or freed without a successful commit.
+    std::atomic<std::uint64_t> txn_aborts {0};
+    /// Number of times the arenas had to grow, requesting memory from the heap.
+    std::atomic<std::uint64_t> arena_growths {0};
+    /// The biggest capacity of a single arena, observed after one of the calls.
+    std::atomic<std::uint64_t> arena_peak_bytes {0};
+
+    op_metrics_t* col(ukv_col_t col, metric_op_t op) noexcept {
+        col_slot_t* slot = claim(col);
+        return slot ? &slot->ops[static_cast<std::size_t>(op)] : nullptr;
+    }
+
+    op_metrics_t& shard(metric_op_t op) noexcept {
+        static std::atomic<std::size_t> threads {0};
+        thread_local std::size_t const shard_idx = threads.fetch_add(1, std::memory_order_relaxed) % shards_k;
+        return shards_[shard_idx].ops[static_cast<std::size_t>(op)];
+    }
+
+    void record(metric_op_t op, ukv_col_t col, ukv_size_t tasks, std::uint64_t ns, bool failed) noexcept {
+        shard(op).record(tasks, ns, failed);
+        if (op_metrics_t* col_op = this->col(col, op))
+            col_op->record(tasks, ns, failed);
+    }
+
+    void observe_arena(stl_arena_t const& arena, std::size_t allocations_before) noexcept {
+        if (arena.allocations <= allocations_before)
+            return;
+        arena_growths.fetch_add(arena.allocations - allocations_before, std::memory_order_relaxed);
+        std::uint64_t bytes = arena_capacity(arena);
+        std::uint64_t peak = arena_peak_bytes.load(std::memory_order_relaxed);
+        while (bytes > peak && !arena_peak_bytes.compare_exchange_weak(peak, bytes, std::memory_order_relaxed))
+            ;
+    }
+
+    /**
+     * @brief Exports all the metrics as a JSON object.
+     * @param name_of   Callable, mapping `ukv_col_t` handles to collection names.
+     * @param extra     Comma-prefixed JSON members, appended by specific backends.
+     */
+    template <typename name_of_at>
+    std::string json(name_of_at&& name_of, std::string_view extra = {}) const {
+        std::string out = "{\"ops\":{";
+        for (std::size_t op = 0; op != metric_ops_k; ++op) {
+            op_summary_t summary;
+            for (shard_t const& shard : shards_)
+                summary.add(shard.ops[op]);
+            append_json(out, op, summary);
+        }
+        out.back() = '}';
+
+        out += ",\"collections\":{";
+        bool any_col = false;
+        for (col_slot_t const& slot : cols_) {
+            if (slot.state.load(std::memory_order_acquire) != slot_ready_k)
+                continue;
+            out += '"', out += escape_json(name_of(slot.id)), out += "\":{";
+            for (std::size_t op = 0; op != metric_ops_k; ++op) {
+                op_summary_t summary;
+                summary.add(slot.ops[op]);
+                append_json(out, op, summary);
+            }
+            out.back() = '}';
+            out += ',';
+            any_col = true;
+        }
+        if (any_col)
+            out.pop_back();
+        out += '}';
+
+        out += ",\"transactions\":{\"conflicts\":" + std::to_string(txn_conflicts.load()) +
+               ",\"aborts\":" + std::to_string(txn_aborts.load()) + "}";
+        out += ",\"arenas\":{\"growths\":" + std::to_string(arena_growths.load()) +
+               ",\"peak_bytes\":" + std::to_string(arena_peak_bytes.load()) + "}";
+        out += extra;
+        out += '}';
+        return out;
+    }
+
+    /**
+     * @brief Exports all the metrics in the Prometheus text format.
+     * Latencies are exported as summaries with precomputed quantiles, in seconds.
+     * @param extra     Complete lines, appended by specific backends.
+     */
+    template <typename name_of_at>
+    std::string prometheus(name_of_at&& name_of, std::string_view extra = {}) const {
+        std::string out;
+        out += "# HELP ukv_calls_total Number of C API calls.\n# TYPE ukv_calls_total counter\n";
+        out += "# HELP ukv_failures_total Number of failed C API calls.\n# TYPE ukv_failures_total counter\n";
+        out += "# HELP ukv_tasks_total Number of tasks in C API calls.\n# TYPE ukv_tasks_total counter\n";
+        out += "# HELP ukv_latency_seconds Latency of C API calls.\n# TYPE ukv_latency_seconds summary\n";
+        for (std::size_t op = 0; op != metric_ops_k; ++op) {
+            op_summary_t summary;
+            for (shard_t const& shard : shards_)
+                summary.add(shard.ops[op]);
+            append_prometheus(out, "op=\"" + std::string(metric_op_name(op)) + "\"", summary);
+        }
+        for (col_slot_t const& slot : cols_) {
+            if (slot.state.load(std::memory_order_acquire) != slot_ready_k)
+                continue;
+            std::string col_label = "col=\"" + escape_json(name_of(slot.id)) + "\",op=\"";
+            for (std::size_t op = 0; op != metric_ops_k; ++op) {
+                op_summary_t summary;
+                summary.add(slot.ops[op]);
+                if (summary.calls)
+                    append_prometheus(out, col_label + metric_op_name(op) + "\"", summary);
+            }
+        }
+        out += "# TYPE ukv_txn_conflicts_total counter\nukv_txn_conflicts_total " +
+               std::to_string(txn_conflicts.load()) + "\n";
+        out += "# TYPE ukv_txn_aborts_total counter\nukv_txn_aborts_total " + std::to_string(txn_aborts.load()) + "\n";
+        out += "# TYPE ukv_arena_growths_total counter\nukv_arena_growths_total " +
+               std::to_string(arena_growths.load()) + "\n";
+        out += "# TYPE ukv_arena_peak_bytes gauge\nukv_arena_peak_bytes " + std::to_string(arena_peak_bytes.load()) +
+               "\n";
+        out += extra;
+        return out;
+    }
+
+    /// Escapes quotes and backslashes, so that names can be embedded into JSON and Prometheus labels.
+    static std::string escape_json(std::string_view str) {
+        std::string escaped;
+        escaped.reserve(str.size());
+        for (char c : str) {
+            if (c == '"' || c == '\\')
+                escaped += '\\';
+            escaped += c;
+        }
+        return escaped;
+    }
+
+  private:
+    struct alignas(64) shard_t {
+        op_metrics_t ops[metric_ops_k];
+    };
+
+    static constexpr std::uint8_t slot_empty_k = 0;
+    static constexpr std::uint8_t slot_claiming_k = 1;
+    static constexpr std::uint8_t slot_ready_k = 2;
+
+    struct alignas(64) col_slot_t {
+        std::atomic<std::uint8_t> state {slot_empty_k};
+        ukv_col_t id = 0;
+        op_metrics_t ops[metric_ops_k];
+    };
+
+    shard_t shards_[shards_k];
+    col_slot_t cols_[cols_k];
+
+    /// Finds or claims the slot of @p col, returning NULL, once the table is full.
+    col_slot_t* claim(ukv_col_t col) noexcept {
+        std::size_t const start = static_cast<std::size_t>(col ^ (col >> 17)) % cols_k;
+        for (std::size_t i = 0; i != cols_k; ++i) {
+            col_slot_t& slot = cols_[(start + i) % cols_k];
+            std::uint8_t state = slot.state.load(std::memory_order_acquire);
+            if (state == slot_empty_k &&
+                slot.state.compare_exchange_strong(state, slot_claiming_k, std::memory_order_acquire)) {
+                slot.id = col;
+                slot.state.store(slot_ready_k, std::memory_order_release);
+                return &slot;
+            }
+            // Some other thread may be filling this slot in, which is only a couple of instructions
+            while (state == slot_claiming_k)
+                state = slot.state.load(std::memory_order_acquire);
+            if (slot.id == col)
+                return &slot;
+        }
+        return nullptr;
+    }
+
+    static std::uint64_t arena_capacity(stl_arena_t const& arena) noexcept {
+        return arena.output_tape.capacity() + arena.unpacked_tape.capacity() + arena.another_tape.capacity() +
+               arena.backend_tape.capacity() + arena.updated_keys.capacity() * sizeof(col_key_t) +
+               arena.updated_vals.capacity() * sizeof(value_t) + arena.strings.capacity() * sizeof(std::string) +
+               arena.backend_cols.capacity() * sizeof(ukv_col_t);
+    }
+
+    static void append_json(std::string& out, std::size_t op, op_summary_t const& summary) {
+        out += '"', out += metric_op_name(op), out += "\":{";
+        out += "\"calls\":" + std::to_string(summary.calls);
+        out += ",\"failures\":" + std::to_string(summary.failures);
+        out += ",\"tasks\":" + std::to_string(summary.tasks);
+        out += ",\"total_ns\":" + std::to_string(summary.total_ns);
+        for (std::size_t i = 0; i != std::size(metric_quantiles_k); ++i)
+            out += ",\"" + std::string(metric_quantile_names_k[i]) +
+                   "\":" + std::to_string(summary.quantile(metric_quantiles_k[i]));
+        out += "},";
+    }
+
+    static void append_prometheus(std::string& out, std::string const& labels, op_summary_t const& summary) {
+        out += "ukv_calls_total{" + labels + "} " + std::to_string(summary.calls) + "\n";
+        out += "ukv_failures_total{" + labels + "} " + std::to_string(summary.failures) + "\n";
+        out += "ukv_tasks_total{" + labels + "} " + std::to_string(summary.tasks) + "\n";
+        for (std::size_t i = 0; i != std::size(metric_quantiles_k); ++i)
+            out += "ukv_latency_seconds{" + labels + ",quantile=\"" + metric_quantile_labels_k[i] + "\"} " +
+                   std::to_string(summary.quantile(metric_quantiles_k[i]) * 1e-9) + "\n";
+        out += "ukv_latency_seconds_sum{" + labels + "} " + std::to_string(summary.total_ns * 1e-9) + "\n";
+        out += "ukv_latency_seconds_count{" + labels + "} " + std::to_string(summary.calls) + "\n";
+    }
+};
+
+/**
+ * @brief Records a single C API call on destruction.
+ * The call is considered failed, if the error is set by then.
+ */
+class metrics_scope_t {
+    metrics_t& metrics_;
+    metric_op_t op_;
+    ukv_col_t col_;
+    ukv_size_t tasks_;
+    ukv_error_t* error_;
+    ukv_arena_t* arena_;
+    std::size_t allocations_before_;
+    std::chrono::steady_clock::time_point start_ = std::chrono::steady_clock::now();
+
+  public:
+    metrics_scope_t(metrics_t& metrics,
+                    metric_op_t op,
+                    ukv_col_t col,
+                    ukv_size_t tasks,
+                    ukv_error_t* error,
+                    ukv_arena_t* arena = nullptr) noexcept
+        : metrics_(metrics), op_(op), col_(col), tasks_(tasks), error_(error), arena_(arena),
+          allocations_before_(arena && *arena ? reinterpret_cast<stl_arena_t*>(*arena)->allocations : 0) {}
+
+    metrics_scope_t(metrics_scope_t const&) = delete;
+    metrics_scope_t& operator=(metrics_scope_t const&) = delete;
+
+    ~metrics_scope_t() noexcept {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_);
+        metrics_.record(op_, col_, tasks_, static_cast<std::uint64_t>(ns.count()), *error_ != nullptr);
+        if (arena_ && *arena_)
+            metrics_.observe_arena(*reinterpret_cast<stl_arena_t const*>(*arena_), allocations_before_);
+    }
+};
+
+/// Collection of the first task of a batch, to which its latency is attributed.
+inline ukv_col_t first_col(ukv_col_t const* cols, ukv_size_t count) noexcept {
+    return cols && count ? cols[0] : ukv_col_main_k;
+}
+
+} // namespace unum::ukv
@@ -0,0 +1,280 @@
+/**
+ * @file msgpack_cursor.hpp
+ * @author Ashot Vardanian
+ *
+ * @brief Navigation over MessagePack documents without materializing them.
+ * Objects are skipped by their headers alone, so extracting a few fields from
+ * a document costs a pass over the headers on the way to them and no allocations.
+ *
+ * https://github.com/msgpack/msgpack/blob/master/spec.md
+ */
+#pragma once
+#include <cstdint> // `std::uint8_t`
+#include <cstring> // `std::memcpy`
+
+namespace unum::ukv {
+
+enum class msgpack_kind_t {
+    nil_k,
+    boolean_k,
+    unsigned_k,
+    signed_k,
+    float32_k,
+    float64_k,
+    string_k,
+    binary_k,
+    extension_k,
+    array_k,
+    map_k,
+};
+
+/**
+ * @brief Header of a single MessagePack object.
+ * For containers, @c `length` is the number of elements, or pairs for maps.
+ * For everything else, it's the number of bytes in the payload.
+ */
+struct msgpack_item_t {
+    msgpack_kind_t kind = msgpack_kind_t::nil_k;
+    std::uint8_t const* payload = nullptr;
+    std::size_t length = 0;
+    /// Value of booleans and integers, that fit into their headers.
+    std::uint64_t inlined = 0;
+};
+
+/// Loads a big-endian unsigned integer of @p bytes width.
+inline std::uint64_t msgpack_load_be(std::uint8_t const* ptr, std::size_t bytes) noexcept {
+    std::uint64_t result = 0;
+    for (std::size_t i = 0; i != bytes; ++i)
+        result = (result << 8) | ptr[i];
+    return result;
+}
+
+/// Stores the lowest @p bytes of @p value in big-endian order.
+inline void msgpack_store_be(std::uint8_t* ptr, std::size_t bytes, std::uint64_t value) noexcept {
+    for (std::size_t i = bytes; i != 0; --i, value >>= 8)
+        ptr[i - 1] = static_cast<std::uint8_t>(value);
+}
+
+/**
+ * @brief Parses the header of the object at @p ptr.
+ * @return Pointer past the header, or NULL if the input is malformed or truncated.
+ */
+inline std::uint8_t const* msgpack_parse_header(std::uint8_t const* ptr,
+                                                std::uint8_t const* end,
+                                                msgpack_item_t& item) noexcept {
+    if (ptr == end)
+        return nullptr;
+
+    std::uint8_t const code = *ptr++;
+    std::size_t width = 0;
+    auto sized = [&](msgpack_kind_t kind, std::size_t length_bytes) {
+        item.kind = kind;
+        width = length_bytes;
+    };
+    auto fixed = [&](msgpack_kind_t kind, std::size_t length) {
+        item.kind = kind;
+        item.length = length;
+    };
+
+    if (code <= 0x7F)
+        fixed(msgpack_kind_t::unsigned_k, 0), item.inlined = code;
+    else if (code <= 0x8F)
+        fixed(msgpack_kind_t::map_k, code & 0x0F);
+    else if (code <= 0x9F)
+        fixed(msgpack_kind_t::array_k, code & 0x0F);
+    else if (code <= 0xBF)
+        fixed(msgpack_kind_t::string_k, code & 0x1F);
+    else if (code >= 0xE0)
+        fixed(msgpack_kind_t::signed_k, 0), item.inlined = static_cast<std::uint64_t>(std::int8_t(code));
+    else
+        switch (code) {
+        case 0xC0: fixed(msgpack_kind_t::nil_k, 0); break;
+        case 0xC2: fixed(msgpack_kind_t::boolean_k, 0), item.inlined = 0; break;
+        case 0xC3: fixed(msgpack_kind_t::boolean_k, 0), item.inlined = 1; break;
+        case 0xC4: sized(msgpack_kind_t::binary_k, 1); break;
+        case 0xC5: sized(msgpack_kind_t::binary_k, 2); break;
+        case 0xC6: sized(msgpack_kind_t::binary_k, 4); break;
+        // Extensions are followed by a type byte, which we keep in the payload
+        case 0xC7: sized(msgpack_kind_t::extension_k, 1); break;
+        case 0xC8: sized(msgpack_kind_t::extension_k, 2); break;
+        case 0xC9: sized(msgpack_kind_t::extension_k, 4); break;
+        case 0xCA: fixed(msgpack_kind_t::float32_k, 4); break;
+        case 0xCB: fixed(msgpack_kind_t::float64_k, 8); break;
+        case 0xCC: fixed(msgpack_kind_t::unsigned_k, 1); break;
+        case 0xCD: fixed(msgpack_kind_t::unsigned_k, 2); break;
+        case 0xCE: fixed(msgpack_kind_t::unsigned_k, 4); break;
+        case 0xCF: fixed(msgpack_kind_t::unsigned_k, 8); break;
+        case 0xD0: fixed(msgpack_kind_t::signed_k, 1); break;
+        case 0xD1: fixed(msgpack_kind_t::signed_k, 2); break;
+        case 0xD2: fixed(msgpack_kind_t::signed_k, 4); break;
+        case 0xD3: fixed(msgpack_kind_t::signed_k, 8); break;
+        case 0xD4: fixed(msgpack_kind_t::extension_k, 2); break;
+        case 0xD5: fixed(msgpack_kind_t::extension_k, 3); break;
+        case 0xD6: fixed(msgpack_kind_t::extension_k, 5); break;
+        case 0xD7: fixed(msgpack_kind_t::extension_k, 9); break;
+        case 0xD8: fixed(msgpack_kind_t::extension_k, 17); break;
+        case 0xD9: sized(msgpack_kind_t::string_k, 1); break;
+        case 0xDA: sized(msgpack_kind_t::string_k, 2); break;
+        case 0xDB: sized(msgpack_kind_t::string_k, 4); break;
+        case 0xDC: sized(msgpack_kind_t::array_k, 2); break;
+        case 0xDD: sized(msgpack_kind_t::array_k, 4); break;
+        case 0xDE: sized(msgpack_kind_t::map_k, 2); break;
+        case 0xDF: sized(msgpack_kind_t::map_k, 4); break;
+        default: return nullptr;
+        }
+
+    if (width) {
+        if (static_cast<std::size_t>(end - ptr) < width)
+            return nullptr;
+        item.length = msgpack_load_be(ptr, width);
+        ptr += width;
+        if (item.kind == msgpack_kind_t::extension_k)
+            item.length += 1;
+    }
+
+    item.payload = ptr;
+    bool const is_container = item.kind == msgpack_kind_t::array_k || item.kind == msgpack_kind_t::map_k;
+    if (!is_container && static_cast<std::size_t>(end - ptr) < item.length)
+        return nullptr;
+    return ptr;
+}
+
+/**
+ * @brief Skips a whole object, including nested containers, without recursion.
+ * @return Pointer past the object, or NULL if the input is malformed or truncated.
+ */
+inline std::uint8_t const* msgpack_skip(std::uint8_t const* ptr, std::uint8_t const* end) noexcept {
+    std::size_t pending = 1;
+    while (pending) {
+        --pending;
+        msgpack_item_t item;
+        ptr = msgpack_parse_header(ptr, end, item);
+        if (!ptr)
+            return nullptr;
+        if (item.kind == msgpack_kind_t::array_k)
+            pending += item.length;
+        else if (item.kind == msgpack_kind_t::map_k)
+            pending += item.length * 2;
+        else
+            ptr += item.length;
+        // Every element takes at least a byte, so we can reject bogus lengths early
+        if (pending > static_cast<std::size_t>(end - ptr))
+            return nullptr;
+    }
+    return ptr;
+}
+
+/**
+ * @brief Compares a MessagePack string with a JSON-Pointer token, unescaping "~0" and "~1" on the fly.
+ */
+inline bool msgpack_equals_token(msgpack_item_t const& key, char const* token, std::size_t token_length) noexcept {
+    std::size_t key_offset = 0;
+    for (std::size_t i = 0; i != token_length; ++i, ++key_offset) {
+        char expected = token[i];
+        if (expected == '~' && i + 1 != token_length)
+            expected = token[++i] == '1' ? '/' : '~';
+        if (key_offset == key.length || char(key.payload[key_offset]) != expected)
+            return false;
+    }
+    return key_offset == key.length;
+}
+
+/**
+ * @brief Finds the value of a key in the map, starting at @p ptr.
+ * @return Pointer to the value, or NULL if it's missing or the input isn't a map.
+ */
+inline std::uint8_t const* msgpack_find_key( //
+    std::uint8_t const* ptr,
+    std::uint8_t const* end,
+    char const* key,
+    std::size_t key_length,
+    bool escaped) noexcept {
+
+    msgpack_item_t map;
+    ptr = msgpack_parse_header(ptr, end, map);
+    if (!ptr || map.kind != msgpack_kind_t::map_k)
+        return nullptr;
+
+    for (std::size_t i = 0; i != map.length; ++i) {
+        msgpack_item_t item;
+        std::uint8_t const* key_payload = msgpack_parse_header(ptr, end, item);
+        if (!key_payload)
+            return nullptr;
+        if (item.kind == msgpack_kind_t::string_k) {
+            bool matches = escaped ? msgpack_equals_token(item, key, key_length)
+                                   : item.length == key_length && std::memcmp(item.payload, key, key_length) == 0;
+            if (matches)
+                return key_payload + item.length;
+            ptr = key_payload + item.length;
+        }
+        else if (!(ptr = msgpack_skip(ptr, end)))
+            return nullptr;
+
+        // Skip the value
+        if (!(ptr = msgpack_skip(ptr, end)))
+            return nullptr;
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Finds the element of the array, starting at @p ptr, by a decimal index.
+ * @return Pointer to the element, or NULL if it's missing or the input isn't an array.
+ */
+inline std::uint8_t const* msgpack_find_index( //
+    std::uint8_t const* ptr,
+    std::uint8_t const* end,
+    char const* index,
+    std::size_t index_length) noexcept {
+
+    if (!index_length || (index[0] == '0' && index_length != 1))
+        return nullptr;
+    std::size_t offset = 0;
+    for (std::size_t i = 0; i != index_length; ++i) {
+        if (index[i] < '0' || index[i] > '9' || offset > (SIZE_MAX - 9) / 10)
+            return nullptr;
+        offset = offset * 10 + (index[i] - '0');
+    }
+
+    msgpack_item_t array;
+    ptr = msgpack_parse_header(ptr, end, array);
+    if (!ptr || array.kind != msgpack_kind_t::array_k || offset >= array.length)
+        return nullptr;
+    for (; offset && ptr; --offset)
+        ptr = msgpack_skip(ptr, end);
+    return ptr;
+}
+
+/**
+ * @brief Locates a member of a document, addressed either by a top-level
+ * key or a JSON-Pointer, starting with a slash. NULL @p field means the whole document.
+ * @return Pointer to the member, or NULL if it's missing or the input is malformed.
+ */
+inline std::uint8_t const* msgpack_find( //
+    std::uint8_t const* ptr,
+    std::uint8_t const* end,
+    char const* field) noexcept {
+
+    if (!field || ptr == end)
+        return ptr != end ? ptr : nullptr;
+    if (field[0] != '/')
+        return msgpack_find_key(ptr, end, field, std::strlen(field), false);
+
+    // Walk the JSON-Pointer token by token
+    for (char const* token = field + 1; ptr; ++token) {
+        char const* token_end = std::strchr(token, '/');
+        std::size_t token_length = token_end ? token_end - token : std::strlen(token);
+
+        msgpack_item_t item;
+        if (!msgpack_parse_header(ptr, end, item))
+            return nullptr;
+        ptr = item.kind == msgpack_kind_t::array_k ? msgpack_find_index(ptr, end, token, token_length)
+                                                   : msgpack_find_key(ptr, end, token, token_length, true);
+        if (!token_end)
+            break;
+        token = token_end;
+    }
+    return ptr;
+}
+
+} // namespace unum::ukv
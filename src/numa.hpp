@@ -0,0 +1,198 @@
+/**
+ * @file numa.hpp
+ * @author Ashot Vardanian
+ *
+ * @brief Minimal NUMA-awareness for multi-socket hosts, without depending on `libnuma`.
+ * > Topology is read from `/sys/devices/system/node`.
+ * > Threads are pinned with `pthread_setaffinity_np`.
+ * > Allocations are steered with the `set_mempolicy` system call, so the pages, first
+ *   touched within a `numa_scope_t`, are preferably placed on the chosen node.
+ *
+ * Nodes are addressed by their index in `numa_topology_t`, not the OS-assigned id.
+ * On other platforms, or hosts with a single node, everything here is a no-op.
+ */
+#pragma once
+#include <cstdint>   // `std::uint64_t`
+#include <cstdlib>   // `std::strtoul`
+#include <fstream>   // `std::ifstream`
+#include <string>    // `std::string`
+#include <vector>    // `std::vector`
+#include <algorithm> // `std::find`
+#include <thread>    // `std::thread::hardware_concurrency`
+
+#if defined(__linux__)
+#include <pthread.h>     // `pthread_setaffinity_np`
+#include <sched.h>       // `sched_getcpu`
+#include <unistd.h>      // `syscall`
+#include <sys/syscall.h> // `SYS_set_mempolicy`
+#endif
+
+namespace unum::ukv {
+
+/// Marks collections and threads, that aren't homed to any specific node.
+constexpr std::size_t numa_any_k = static_cast<std::size_t>(-1);
+
+/**
+ * @brief Parses the Linux "cpulist" format, like "0-15,32-47".
+ */
+inline std::vector<unsigned> numa_parse_list(std::string const& text) {
+    std::vector<unsigned> result;
+    char const* it = text.c_str();
+    while (*it) {
+        char* end = nullptr;
+        unsigned first = static_cast<unsigned>(std::strtoul(it, &end, 10));
+        if (end == it)
+            break;
+        unsigned last = first;
+        if (*end == '-')
+            last = static_cast<unsigned>(std::strtoul(end + 1, &end, 10));
+        for (unsigned i = first; i <= last; ++i)
+            result.push_back(i);
+        it = *end == ',' ? end + 1 : end;
+    }
+    return result;
+}
+
+class numa_topology_t {
+    /// OS-assigned ids of the online nodes.
+    std::vector<unsigned> ids_;
+    /// CPUs of every node.
+    std::vector<std::vector<unsigned>> cpus_;
+
+    static std::string read_line(std::string const& path) {
+        std::ifstream file(path);
+        std::string line;
+        std::getline(file, line);
+        return line;
+    }
+
+    static numa_topology_t discover() {
+        numa_topology_t topology;
+#if defined(__linux__)
+        try {
+            for (unsigned id : numa_parse_list(read_line("/sys/devices/system/node/online"))) {
+                auto path = "/sys/devices/system/node/node" + std::to_string(id) + "/cpulist";
+                auto cpus = numa_parse_list(read_line(path));
+                if (cpus.empty())
+                    continue;
+                topology.ids_.push_back(id);
+                topology.cpus_.push_back(std::move(cpus));
+            }
+        }
+        catch (...) {
+            topology = {};
+        }
+#endif
+        if (topology.cpus_.empty()) {
+            std::vector<unsigned> cpus(std::max(std::thread::hardware_concurrency(), 1u));
+            for (unsigned i = 0; i != cpus.size(); ++i)
+                cpus[i] = i;
+            topology.ids_ = {0};
+            topology.cpus_ = {std::move(cpus)};
+        }
+        return topology;
+    }
+
+  public:
+    /// Topology of the current host, discovered on the first call.
+    static numa_topology_t const& host() {
+        static numa_topology_t topology = discover();
+        return topology;
+    }
+
+    std::size_t size() const noexcept { return cpus_.size(); }
+    unsigned id(std::size_t node) const noexcept { return ids_[node]; }
+    std::vector<unsigned> const& cpus(std::size_t node) const noexcept { return cpus_[node]; }
+
+    std::size_t node_of_cpu(unsigned cpu) const noexcept {
+        for (std::size_t node = 0; node != cpus_.size(); ++node)
+            if (std::find(cpus_[node].begin(), cpus_[node].end(), cpu) != cpus_[node].end())
+                return node;
+        return numa_any_k;
+    }
+};
+
+/// Node of the CPU, on which the calling thread is running now.
+inline std::size_t numa_current_node() noexcept {
+#if defined(__linux__)
+    int cpu = sched_getcpu();
+    return cpu < 0 ? numa_any_k : numa_topology_t::host().node_of_cpu(static_cast<unsigned>(cpu));
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief Restricts the calling thread, and the threads it will spawn, to the CPUs of @p node.
+ * Once pinned, the default "local" allocation policy keeps their memory on the same node.
+ * @return false, if the node is unknown or the OS refused.
+ */
+inline bool numa_pin_thread(std::size_t node) noexcept {
+    numa_topology_t const& topology = numa_topology_t::host();
+    if (node >= topology.size())
+        return false;
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (unsigned cpu : topology.cpus(node))
+        if (cpu < CPU_SETSIZE)
+            CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief Prefers the memory of a specific node for the pages, that the calling thread
+ * touches for the first time, until the scope ends and the previous policy is restored.
+ * Costs two system calls, so is meant to wrap whole batches, and is skipped entirely
+ * on single-node hosts or for unhomed data.
+ */
+class numa_scope_t {
+#if defined(__linux__)
+    static constexpr int mpol_default_k = 0;
+    static constexpr int mpol_preferred_k = 1;
+    static constexpr unsigned long max_nodes_k = 1024;
+    static constexpr std::size_t mask_words_k = max_nodes_k / (sizeof(unsigned long) * 8);
+
+    int old_mode_ = mpol_default_k;
+    unsigned long old_mask_[mask_words_k] {};
+#endif
+    bool active_ = false;
+
+  public:
+    explicit numa_scope_t(std::size_t node) noexcept {
+        numa_topology_t const& topology = numa_topology_t::host();
+        if (node >= topology.size() || topology.size() < 2)
+            return;
+#if defined(__linux__)
+        if (syscall(SYS_get_mempolicy, &old_mode_, old_mask_, max_nodes_k, nullptr, 0ul) != 0)
+            return;
+        unsigned long mask[mask_words_k] {};
+        unsigned const id = topology.id(node);
+        if (id >= max_nodes_k)
+            return;
+        mask[id / (sizeof(unsigned long) * 8)] |= 1ul << (id % (sizeof(unsigned long) * 8));
+        active_ = syscall(SYS_set_mempolicy, mpol_preferred_k, mask, max_nodes_k) == 0;
+#endif
+    }
+
+    numa_scope_t(numa_scope_t const&) = delete;
+    numa_scope_t& operator=(numa_scope_t const&) = delete;
+
+    ~numa_scope_t() noexcept {
+        if (!active_)
+            return;
+#if defined(__linux__)
+        if (old_mode_ == mpol_default_k)
+            syscall(SYS_set_mempolicy, mpol_default_k, nullptr, 0ul);
+        else
+            syscall(SYS_set_mempolicy, old_mode_, old_mask_, max_nodes_k);
+#endif
+    }
+
+    bool active() const noexcept { return active_; }
+};
+
+} // namespace unum::ukv
@@ -0,0 +1,172 @@
+/**
+ * @file pfor.hpp
+ * @author Ashot Vardanian
+ *
+ * @brief Patched Frame-of-Reference coding of 64-bit unsigned integers.
+ * Every block of up to `pfor_block_k` values is bit-packed with the width,
+ * that fits most of them. The few bigger values are "patched": only their low
+ * bits are packed, and the rest is stored in a varint-coded tail of the block.
+ *
+ * Block layout: `[u8 width][u8 exceptions][packed bits][{u8 position, varint high bits}...]`.
+ * The number of values in each block is known to the caller, so it is not stored.
+ */
+#pragma once
+#include <cstdint>   // `std::uint64_t`
+#include <cstring>   // `std::memcpy`
+#include <algorithm> // `std::min`
+
+#include "ukv/cpp/types.hpp"
+
+namespace unum::ukv {
+
+constexpr std::size_t pfor_block_k = 128;
+constexpr unsigned pfor_max_width_k = 64;
+
+/// Upper bound for the size of an encoded block of @p count values.
+constexpr std::size_t pfor_block_max_bytes(std::size_t count) noexcept {
+    return 2 + count * sizeof(std::uint64_t);
+}
+
+inline unsigned pfor_bit_width(std::uint64_t value) noexcept {
+    return value ? pfor_max_width_k - __builtin_clzll(value) : 0;
+}
+
+inline std::size_t pfor_packed_bytes(std::size_t count, unsigned width) noexcept {
+    return (count * width + 7) / 8;
+}
+
+inline std::size_t pfor_varint_bytes(unsigned bits) noexcept {
+    return bits ? (bits + 6) / 7 : 1;
+}
+
+/// ORs the lowest @p width bits of @p value into zero-initialized @p packed memory.
+inline void pfor_store_bits(std::uint8_t* packed, std::size_t bit, unsigned width, std::uint64_t value) noexcept {
+    std::size_t const first = bit / 8;
+    unsigned const shift = bit % 8;
+    std::size_t const bytes = (shift + width + 7) / 8;
+    std::uint64_t word = 0;
+    std::memcpy(&word, packed + first, std::min<std::size_t>(bytes, 8));
+    word |= value << shift;
+    std::memcpy(packed + first, &word, std::min<std::size_t>(bytes, 8));
+    if (bytes > 8)
+        packed[first + 8] |= static_cast<std::uint8_t>(value >> (64 - shift));
+}
+
+inline std::uint64_t pfor_load_bits(std::uint8_t const* packed, std::size_t bit, unsigned width) noexcept {
+    std::size_t const first = bit / 8;
+    unsigned const shift = bit % 8;
+    std::size_t const bytes = (shift + width + 7) / 8;
+    std::uint64_t word = 0;
+    std::memcpy(&word, packed + first, std::min<std::size_t>(bytes, 8));
+    word >>= shift;
+    if (bytes > 8)
+        word |= std::uint64_t(packed[first + 8]) << (64 - shift);
+    return width == pfor_max_width_k ? word : word & ((std::uint64_t(1) << width) - 1);
+}
+
+/**
+ * @brief Picks the packing width, minimizing the total size of the block,
+ * including the exceptions, that don't fit into it.
+ */
+inline unsigned pfor_pick_width(std::uint64_t const* values, std::size_t count) noexcept {
+    std::size_t widths[pfor_max_width_k + 1] {};
+    unsigned max_width = 0;
+    for (std::size_t i = 0; i != count; ++i) {
+        unsigned width = pfor_bit_width(values[i]);
+        widths[width] += 1;
+        max_width = std::max(max_width, width);
+    }
+
+    unsigned best_width = max_width;
+    std::size_t best_bytes = pfor_packed_bytes(count, max_width);
+    for (unsigned width = 0; width < max_width; ++width) {
+        std::size_t bytes = pfor_packed_bytes(count, width);
+        std::size_t exceptions = 0;
+        for (unsigned bigger = width + 1; bigger <= max_width; ++bigger) {
+            bytes += widths[bigger] * (1 + pfor_varint_bytes(bigger - width));
+            exceptions += widths[bigger];
+        }
+        if (bytes < best_bytes && exceptions <= UINT8_MAX)
+            best_width = width, best_bytes = bytes;
+    }
+    return best_width;
+}
+
+/**
+ * @brief Encodes up to `pfor_block_k` @p values into @p output,
+ * which must fit at least `pfor_block_max_bytes(count)`.
+ * @return The number of bytes written.
+ */
+inline std::size_t pfor_encode_block(std::uint64_t const* values, std::size_t count, byte_t* output) noexcept {
+    auto out = reinterpret_cast<std::uint8_t*>(output);
+    unsigned const width = pfor_pick_width(values, count);
+    std::uint64_t const mask = width == pfor_max_width_k ? ~std::uint64_t(0) : (std::uint64_t(1) << width) - 1;
+
+    std::uint8_t* const packed = out + 2;
+    std::size_t const packed_bytes = pfor_packed_bytes(count, width);
+    std::memset(packed, 0, packed_bytes);
+    std::uint8_t* tail = packed + packed_bytes;
+    std::uint8_t exceptions = 0;
+    for (std::size_t i = 0; i != count; ++i) {
+        std::uint64_t value = values[i];
+        if (width)
+            pfor_store_bits(packed, i * width, width, value & mask);
+        if (value <= mask)
+            continue;
+
+        *tail++ = static_cast<std::uint8_t>(i);
+        for (value >>= width; value >= 0x80; value >>= 7)
+            *tail++ = static_cast<std::uint8_t>(value | 0x80);
+        *tail++ = static_cast<std::uint8_t>(value);
+        ++exceptions;
+    }
+
+    out[0] = static_cast<std::uint8_t>(width);
+    out[1] = exceptions;
+    return tail - out;
+}
+
+/**
+ * @brief Decodes a block of @p count values, written by `pfor_encode_block`.
+ * @return The number of bytes consumed.
+ */
+inline std::size_t pfor_decode_block(byte_t const* input, std::size_t count, std::uint64_t* values) noexcept {
+    auto in = reinterpret_cast<std::uint8_t const*>(input);
+    unsigned const width = in[0];
+    std::size_t const exceptions = in[1];
+    std::uint8_t const* const packed = in + 2;
+
+    if (width)
+        for (std::size_t i = 0; i != count; ++i)
+            values[i] = pfor_load_bits(packed, i * width, width);
+    else
+        std::fill_n(values, count, 0);
+
+    std::uint8_t const* tail = packed + pfor_packed_bytes(count, width);
+    for (std::size_t i = 0; i != exceptions; ++i) {
+        std::size_t position = *tail++;
+        std::uint64_t high = 0;
+        unsigned shift = 0;
+        for (; *tail & 0x80; ++tail, shift += 7)
+            high |= std::uint64_t(*tail & 0x7F) << shift;
+        high |= std::uint64_t(*tail++) << shift;
+        values[position] |= high << width;
+    }
+    return tail - in;
+}
+
+/**
+ * @brief Finds the end of a block of @p count values, without unpacking it.
+ * @return The number of bytes in the block.
+ */
+inline std::size_t pfor_skip_block(byte_t const* input, std::size_t count) noexcept {
+    auto in = reinterpret_cast<std::uint8_t const*>(input);
+    std::size_t const exceptions = in[1];
+    std::uint8_t const* tail = in + 2 + pfor_packed_bytes(count, in[0]);
+    for (std::size_t i = 0; i != exceptions; ++i)
+        for (++tail; *tail++ & 0x80;)
+            ;
+    return tail - in;
+}
+
+} // namespace unum::ukv
@@ -27,6 +27,7 @@
  * Global operations:
  * > DELETE /all/:              Clears the entire DB.
  * > GET /all/meta?query=str:   Retrieves DB metadata.
+ * > GET /metrics:              Exports DB metrics for Prometheus scrapers.
  *
  * Supporting transactions:
  * > GET /txn/client:   Returns: {id?: int, error?: str}
@@ -126,21 +127,31 @@
  *      which controls the entire session.
  *      https://developer.mozilla.org/en-US/docs/Web/HTTP/Headers/Transfer-Encoding
  *
- * @section Upcoming Endpoints
+ * Working with @b batched data in tape-like @b SOA, packed in MsgPack or JSON:
+ * > PUT /soa/?col=str:
+ *      Receives: {cols?: [str]|str, keys: [int], lens: [int], tape: bin}
+ * > GET /soa/?col=str:
+ *      Receives: {cols?: [str]|str, keys: [int], lengths?: bool}
+ *      Returns: {lens: [int], tape?: bin}
+ * > DELETE /soa/?col=str:
+ *      Receives: {cols?: [str]|str, keys: [int]}
+ * Missing entries are exported with `ukv_val_len_missing_k` lengths and take
+ * no space on the tape. Errors are reported with HTTP statuses and text bodies.
  *
- * Working with @b batched data in tape-like @b SOA:
- * > PUT /soa/:
- *      Receives: {cols?: [str], keys: [int], txn?: int, lens: [int], tape: str}
- *      Returns: {error?: str}
- * > GET /soa/:
- *      Receives: {cols?: [str], keys: [int], fields?: [str], txn?: int}
- *      Returns: {lens?: [int], tape?: str, error?: str}
- * > DELETE /soa/:
- *      Receives: {cols?: [str], keys: [int], fields?: [str], txn?: int}
- *      Returns: {error?: str}
- * > HEAD /soa/:
- *      Receives: {col?: str, key: int, fields?: [str], txn?: int}
- *      Returns: {len?: int, error?: str}
+ * Streaming ranges of entries:
+ * > GET /scan/?col=str&min=int&max=int&batch=int:
+ *      Returns: A chunked binary stream of (key, length, bytes) records,
+ *      for all the keys in `[min, max)`, scanned `batch` keys at a time.
+ *
+ * @section Connections
+ *
+ * Every connection keeps its own memory arena and a cache of opened collections,
+ * reusing them across requests. Requests can be pipelined, and responses come back
+ * in the order of requests. Payloads can be sent with chunked transfer encoding.
+ * In the NUMA mode, every node gets its own pool of pinned threads, and connections
+ * are spread between those pools, so every connection stays on a single node.
+ *
+ * @section Upcoming Endpoints
  *
  * Working with @b batched data in @b Apache.Arrow format:
  * > GET /arrow/:
@@ -152,7 +163,10 @@
 #include <cstdlib>
 #include <memory>
 #include <vector>
+#include <deque>
 #include <string>
+#include <limits>
+#include <unordered_map>
 #include <algorithm>
 #include <functional>
 #include <thread>   // Thread pool
@@ -187,7 +201,10 @@
 #elif defined(_MSC_VER)
 #endif
 
+#include <nlohmann/json.hpp>
+
 #include "ukv/ukv.hpp"
+#include "numa.hpp"
 
 namespace beast = boost::beast;   // from <boost/beast.hpp>
 namespace http = beast::http;     // from <boost/beast/http.hpp>
@@ -204,6 +221,9 @@ static constexpr char const* mime_msgpack_k = "application/msgpack";
 static constexpr char const* mime_cbor_k = "application/cbor";
 static constexpr char const* mime_bson_k = "application/bson";
 static constexpr char const* mime_ubjson_k = "application/ubjson";
+static constexpr ukv_size_t scan_batch_size_k = 1024;
+
+using json_t = nlohmann::json;
 
 ukv_format_t mime_to_format(beast::string_view mime) {
     if (mime == mime_json_k)
@@ -220,10 +240,8 @@ ukv_format_t mime_to_format(beast::string_view mime) {
         return ukv_format_ubjson_k;
     else if (mime == "application/vnd.apache.arrow.stream" || mime == "application/vnd.apache.arrow.file")
         return ukv_format_arrow_k;
-    else if (mime == "application/vnd.apache.parquet")
-        return ukv_format_parquet_k;
     else
-        return ukv_format_unknown_k;
+        return ukv_format_binary_k;
 }
 
 struct db_w_clients_t : public std::enable_shared_from_this<db_w_clients_t> {
@@ -261,8 +279,8 @@ std::optional<beast::string_view> param_value(beast::string_view query_params, b
         return std::nullopt;
 
     char preceding_char = *(key_begin - 1);
-    bool isnt_part_of_bigger_key = (preceding_char != '?') & (preceding_char != '&') & (preceding_char != '/');
-    if (!isnt_part_of_bigger_key)
+    bool is_part_of_bigger_key = (preceding_char != '?') & (preceding_char != '&') & (preceding_char != '/');
+    if (is_part_of_bigger_key)
         return std::nullopt;
 
     auto value_begin = key_begin + param_name.size();
@@ -270,16 +288,193 @@ std::optional<beast::string_view> param_value(beast::string_view query_params, b
     return beast::string_view {value_begin, static_cast<size_t>(value_end - value_begin)};
 }
 
+/**
+ * @brief Parses an optional integer parameter from the URI.
+ * @return false If the parameter is present, but isn't a valid integer.
+ *         If it's missing, the @p result is left untouched.
+ */
+template <typename integer_at>
+bool param_integer(beast::string_view query_params, beast::string_view param_name, integer_at& result) {
+    auto value = param_value(query_params, param_name);
+    if (!value)
+        return true;
+    auto value_end = value->data() + value->size();
+    auto parse_result = std::from_chars(value->data(), value_end, result);
+    return parse_result.ec == std::errc() && parse_result.ptr == value_end;
+}
+
+/**
+ * @brief State of a single client connection, reused across all of its requests.
+ * Collections are opened by name once per connection, rather than once per request,
+ * and the outputs of all the calls land in the same arena.
+ *
+ * As the arena is overwritten by every following request, including pipelined ones,
+ * responses must own copies of their bodies, instead of referencing the arena.
+ */
+struct connection_t {
+    ukv_t db = nullptr;
+    arena_t arena;
+    std::unordered_map<std::string, ukv_col_t> collections;
+
+    // Reusable buffers for batched requests
+    std::vector<ukv_col_t> cols;
+    std::vector<ukv_key_t> keys;
+    std::vector<ukv_val_len_t> offsets;
+    std::vector<ukv_val_len_t> lengths;
+
+    connection_t(ukv_t db) noexcept : db(db), arena(db) {}
+    connection_t(connection_t const&) = delete;
+
+    /**
+     * @brief Returns a cached handle of a named collection, opening it on first access.
+     * An empty name addresses the main collection.
+     */
+    ukv_col_t collection(beast::string_view name, ukv_error_t* c_error) {
+        if (name.empty())
+            return ukv_col_main_k;
+
+        std::string name_str {name.data(), name.size()};
+        auto it = collections.find(name_str);
+        if (it != collections.end())
+            return it->second;
+
+        ukv_col_t col = ukv_col_main_k;
+        ukv_col_open(db, name_str.c_str(), nullptr, &col, c_error);
+        if (!*c_error)
+            collections.emplace(std::move(name_str), col);
+        return col;
+    }
+};
+
+/**
+ * @brief HTTP body, that scans a range of keys lazily, batch by batch, as the serializer
+ * asks for more data. Large collections are thus streamed in chunked encoding, rather
+ * than being materialized in memory first. Every chunk contains a sequence of records:
+ * the @c `ukv_key_t` key, the @c `ukv_val_len_t` length and the bytes of the value.
+ *
+ * Chunks are produced while other pipelined requests of the same connection are
+ * handled, so the body keeps its own arena, instead of using the connection's one.
+ */
+struct scan_body_t {
+
+    struct value_type {
+        ukv_t db = nullptr;
+        ukv_col_t col = ukv_col_main_k;
+        ukv_key_t min_key = 0;
+        ukv_key_t max_key = ukv_key_unknown_k;
+        ukv_size_t batch_size = 0;
+
+        arena_t arena {nullptr};
+        std::vector<ukv_key_t> keys;
+        std::string chunk;
+
+        value_type() = default;
+        value_type(ukv_t db, ukv_col_t col, ukv_key_t min_key, ukv_key_t max_key, ukv_size_t batch_size)
+            : db(db), col(col), min_key(min_key), max_key(max_key), batch_size(batch_size), arena(db) {}
+
+        /**
+         * @brief Exports the next non-empty batch of records into the @c `chunk`.
+         * @return false If the range is exhausted or the DB failed.
+         */
+        bool next_chunk(ukv_error_t* c_error) {
+            chunk.clear();
+            while (chunk.empty() && min_key < max_key) {
+                ukv_key_t* found_keys = nullptr;
+                ukv_val_len_t* found_lengths = nullptr;
+                ukv_scan(db,
+                         nullptr,
+                         1,
+                         &col,
+                         0,
+                         &min_key,
+                         0,
+                         &batch_size,
+                         0,
+                         ukv_options_default_k,
+                         &found_keys,
+                         &found_lengths,
+                         arena,
+                         c_error);
+                if (*c_error)
+                    return false;
+
+                // Keys are sorted and padded with `ukv_key_unknown_k`
+                ukv_size_t count = 0;
+                while (count != batch_size && found_keys[count] < max_key)
+                    ++count;
+                if (!count)
+                    return false;
+
+                // The following read will overwrite the keys in the arena
+                keys.assign(found_keys, found_keys + count);
+                ukv_val_ptr_t found_values = nullptr;
+                ukv_val_len_t* found_offsets = nullptr;
+                ukv_read(db,
+                         nullptr,
+                         count,
+                         &col,
+                         0,
+                         keys.data(),
+                         sizeof(ukv_key_t),
+                         ukv_options_default_k,
+                         &found_values,
+                         &found_offsets,
+                         &found_lengths,
+                         arena,
+                         c_error);
+                if (*c_error)
+                    return false;
+
+                // Entries may have been removed between the scan and the read
+                for (ukv_size_t i = 0; i != count; ++i) {
+                    if (found_lengths[i] == ukv_val_len_missing_k)
+                        continue;
+                    chunk.append(reinterpret_cast<char const*>(&keys[i]), sizeof(ukv_key_t));
+                    chunk.append(reinterpret_cast<char const*>(&found_lengths[i]), sizeof(ukv_val_len_t));
+                    chunk.append(reinterpret_cast<char const*>(found_values + found_offsets[i]), found_lengths[i]);
+                }
+
+                min_key = count == batch_size ? keys.back() + 1 : max_key;
+            }
+            return !chunk.empty();
+        }
+    };
+
+    class writer {
+        value_type& body_;
+
+      public:
+        using const_buffers_type = net::const_buffer;
+
+        template <bool is_request_ak, typename fields_at>
+        writer(http::header<is_request_ak, fields_at> const&, value_type& body) : body_(body) {}
+
+        void init(beast::error_code& ec) { ec = {}; }
+
+        boost::optional<std::pair<const_buffers_type, bool>> get(beast::error_code& ec) {
+            ec = {};
+            status_t status;
+            if (!body_.next_chunk(status.member_ptr())) {
+                // Headers are already sent, so the only way to report a failure is to drop the connection
+                if (!status)
+                    ec = beast::errc::make_error_code(beast::errc::io_error);
+                return boost::none;
+            }
+            bool has_more = body_.min_key < body_.max_key;
+            return std::make_pair(const_buffers_type {body_.chunk.data(), body_.chunk.size()}, has_more);
+        }
+    };
+};
+
 template <typename body_at, typename allocator_at, typename send_response_at>
-void respond_to_one(db_session_t& session,
+void respond_to_one(connection_t& connection,
                     http::request<body_at, http::basic_fields<allocator_at>>&& req,
                     send_response_at&& send_response) {
 
     http::verb received_verb = req.method();
     beast::string_view received_path = req.target();
 
-    txn_t txn(session.db());
-    col_t collection;
+    ukv_col_t collection = ukv_col_main_k;
     ukv_key_t key = 0;
     ukv_options_t options = ukv_options_default_k;
 
@@ -292,24 +487,40 @@ void respond_to_one(db_session_t& session,
 
     // Parse the following free-order parameters, starting with transaction identifier.
     auto params_str = beast::string_view {key_end, static_cast<size_t>(received_path.end() - key_end)};
-    if (auto txn_val = param_value(params_str, "txn="); txn_val) {
-        auto txn_id = size_t {0};
-        auto txn_parse_result = std::from_chars(txn_val->data(), txn_val->data() + txn_val->size(), txn_id);
-        if (txn_parse_result.ec != std::errc())
-            return send_response(make_error(req, http::status::bad_request, "Couldn't parse the transaction id"));
-    }
+    auto txn_id = size_t {0};
+    if (!param_integer(params_str, "txn=", txn_id))
+        return send_response(make_error(req, http::status::bad_request, "Couldn't parse the transaction id"));
 
     // Parse the collection name string.
     if (auto col_val = param_value(params_str, "col="); col_val) {
-        char col_name_buffer[65] = {0};
-        std::memcpy(col_name_buffer, col_val->data(), std::min(col_val->size(), 64ul));
-
         status_t status;
-        ukv_col_open(session.db(), col_name_buffer, NULL, &collection.raw, error.member_ptr());
+        collection = connection.collection(*col_val, status.member_ptr());
         if (!status)
-            return send_response(make_error(req, http::status::internal_server_error, error.raw));
+            return send_response(
+                make_error(req, http::status::internal_server_error, status.release_exception().what()));
     }
 
+    status_t status;
+    ukv_val_ptr_t found_values = nullptr;
+    ukv_val_len_t* found_offsets = nullptr;
+    ukv_val_len_t* found_lengths = nullptr;
+    auto read_one = [&](ukv_options_t read_options) {
+        ukv_read(connection.db,
+                 nullptr,
+                 1,
+                 &collection,
+                 0,
+                 &key,
+                 0,
+                 read_options,
+                 &found_values,
+                 &found_offsets,
+                 &found_lengths,
+                 connection.arena,
+                 status.member_ptr());
+        return status ? found_lengths[0] : ukv_val_len_missing_k;
+    };
+
     // Once we know, which collection, key and transation user is
     // interested in - perform the actions depending on verbs.
     switch (received_verb) {
@@ -317,35 +528,17 @@ void respond_to_one(db_session_t& session,
         // Read the data:
     case http::verb::get: {
 
-        arena_t tape(session.db());
-        status_t status;
-        ukv_read(session.db(),
-                 txn.raw,
-                 &collection.raw,
-                 0,
-                 &key,
-                 1,
-                 0,
-                 options,
-                 &tape.ptr,
-                 &tape.capacity,
-                 error.member_ptr());
+        ukv_val_len_t len = read_one(options);
         if (!status)
-            return send_response(make_error(req, http::status::internal_server_error, error.raw));
-
-        ukv_val_ptr_t begin = tape.ptr + sizeof(ukv_val_len_t);
-        ukv_val_len_t len = reinterpret_cast<ukv_val_len_t*>(tape.ptr)[0];
-        if (!len)
+            return send_response(
+                make_error(req, http::status::internal_server_error, status.release_exception().what()));
+        if (len == ukv_val_len_missing_k)
             return send_response(make_error(req, http::status::not_found, "Missing key"));
 
-        http::buffer_body::value_type body;
-        body.data = begin;
-        body.size = len;
-        body.more = false;
-
-        http::response<http::buffer_body> res {
+        auto begin = reinterpret_cast<char const*>(found_values + (found_offsets ? found_offsets[0] : 0));
+        http::response<http::string_body> res {
             std::piecewise_construct,
-            std::make_tuple(std::move(body)),
+            std::make_tuple(std::string(begin, len)),
             std::make_tuple(http::status::ok, req.version()),
         };
         res.set(http::field::server, server_name_k);
@@ -358,28 +551,14 @@ void respond_to_one(db_session_t& session,
         // Check the data:
     case http::verb::head: {
 
-        arena_t tape(session.db());
-        status_t status;
-        options = ukv_option_read_lengths_k;
-        ukv_read(session.db(),
-                 txn.raw,
-                 &collection.raw,
-                 0,
-                 &key,
-                 1,
-                 0,
-                 options,
-                 &tape.ptr,
-                 &tape.capacity,
-                 error.member_ptr());
+        ukv_val_len_t len = read_one(ukv_option_read_lengths_k);
         if (!status)
-            return send_response(make_error(req, http::status::internal_server_error, error.raw));
-
-        ukv_val_len_t len = reinterpret_cast<ukv_val_len_t*>(tape.ptr)[0];
-        if (!len)
+            return send_response(
+                make_error(req, http::status::internal_server_error, status.release_exception().what()));
+        if (len == ukv_val_len_missing_k)
             return send_response(make_error(req, http::status::not_found, "Missing key"));
 
-        http::response<http::empty_body> res;
+        http::response<http::empty_body> res {http::status::ok, req.version()};
         res.set(http::field::server, server_name_k);
         res.set(http::field::content_type, mime_binary_k);
         res.content_length(len);
@@ -389,25 +568,12 @@ void respond_to_one(db_session_t& session,
 
     // Insert data if it's missing:
     case http::verb::post: {
-        arena_t tape(session.db());
-        status_t status;
-        options = ukv_option_read_lengths_k;
-        ukv_read(session.db(),
-                 txn.raw,
-                 &collection.raw,
-                 0,
-                 &key,
-                 1,
-                 0,
-                 options,
-                 &tape.ptr,
-                 &tape.capacity,
-                 error.member_ptr());
-        if (!status)
-            return send_response(make_error(req, http::status::internal_server_error, error.raw));
 
-        ukv_val_len_t len = reinterpret_cast<ukv_val_len_t*>(tape.ptr)[0];
-        if (len)
+        ukv_val_len_t len = read_one(ukv_option_read_lengths_k);
+        if (!status)
+            return send_response(
+                make_error(req, http::status::internal_server_error, status.release_exception().what()));
+        if (len != ukv_val_len_missing_k)
             return send_response(make_error(req, http::status::conflict, "Duplicate key"));
 
         [[fallthrough]];
@@ -416,28 +582,22 @@ void respond_to_one(db_session_t& session,
         // Upsert data:
     case http::verb::put: {
 
-        auto opt_payload_len = req.payload_size();
-        if (!opt_payload_len)
-            return send_response(
-                make_error(req, http::status::length_required, "Chunk Transfer Encoding isn't supported"));
-
-        // Should we explicitly check the type of the input here?
+        // Chunked payloads are already assembled by the parser
         auto payload_type = req[http::field::content_type];
         if (payload_type != mime_binary_k)
             return send_response(
                 make_error(req, http::status::unsupported_media_type, "Only binary payload is allowed"));
 
-        status_t status;
-        auto value = req.body();
+        auto& value = req.body();
         auto value_ptr = reinterpret_cast<ukv_val_ptr_t>(value.data());
-        auto value_len = static_cast<ukv_val_len_t>(*opt_payload_len);
+        auto value_len = static_cast<ukv_val_len_t>(value.size());
         ukv_val_len_t value_off = 0;
-        ukv_write(session.db(),
-                  txn.raw,
-                  &collection.raw,
+        ukv_write(connection.db,
+                  nullptr,
+                  1,
+                  &collection,
                   0,
                   &key,
-                  1,
                   0,
                   &value_ptr,
                   0,
@@ -446,11 +606,13 @@ void respond_to_one(db_session_t& session,
                   &value_len,
                   0,
                   options,
-                  error.member_ptr());
+                  connection.arena,
+                  status.member_ptr());
         if (!status)
-            return send_response(make_error(req, http::status::internal_server_error, error.raw));
+            return send_response(
+                make_error(req, http::status::internal_server_error, status.release_exception().what()));
 
-        http::response<http::empty_body> res;
+        http::response<http::empty_body> res {http::status::ok, req.version()};
         res.set(http::field::server, server_name_k);
         res.set(http::field::content_type, mime_binary_k);
         res.keep_alive(req.keep_alive());
@@ -460,16 +622,15 @@ void respond_to_one(db_session_t& session,
         // Upsert data:
     case http::verb::delete_: {
 
-        status_t status;
         ukv_val_ptr_t value_ptr = nullptr;
         ukv_val_len_t value_len = 0;
         ukv_val_len_t value_off = 0;
-        ukv_write(session.db(),
-                  txn.raw,
-                  &collection.raw,
+        ukv_write(connection.db,
+                  nullptr,
+                  1,
+                  &collection,
                   0,
                   &key,
-                  1,
                   0,
                   &value_ptr,
                   0,
@@ -478,11 +639,13 @@ void respond_to_one(db_session_t& session,
                   &value_len,
                   0,
                   options,
-                  error.member_ptr());
+                  connection.arena,
+                  status.member_ptr());
         if (!status)
-            return send_response(make_error(req, http::status::internal_server_error, error.raw));
+            return send_response(
+                make_error(req, http::status::internal_server_error, status.release_exception().what()));
 
-        http::response<http::empty_body> res;
+        http::response<http::empty_body> res {http::status::ok, req.version()};
         res.set(http::field::server, server_name_k);
         res.set(http::field::content_type, mime_binary_k);
         res.keep_alive(req.keep_alive());
@@ -496,64 +659,289 @@ void respond_to_one(db_session_t& session,
     }
 }
 
+/**
+ * @brief Handles batches in the Structure-of-Arrays form, packed in MessagePack or JSON.
+ * All the keys are passed in one array, and so are the values, concatenated into one
+ * binary tape, along with their lengths. A single collection name can be passed in the
+ * URI, a single name or an array of names - in the payload.
+ */
 template <typename body_at, typename allocator_at, typename send_response_at>
-void respond_to_aos(db_session_t& session,
+void respond_to_soa(connection_t& connection,
                     http::request<body_at, http::basic_fields<allocator_at>>&& req,
                     send_response_at&& send_response) {
 
     http::verb received_verb = req.method();
     beast::string_view received_path = req.target();
-
-    txn_t txn(session.db());
-    std::vector<col_t> collections(session.db());
     ukv_options_t options = ukv_options_default_k;
+
+    auto payload_type = req[http::field::content_type];
+    auto payload_format = mime_to_format(payload_type);
+    if (payload_format != ukv_format_msgpack_k && payload_format != ukv_format_json_k)
+        return send_response(make_error(req,
+                                        http::status::unsupported_media_type,
+                                        "We only support json and msgpack MIME types for batches"));
+
+    // Chunked payloads are already assembled by the parser
+    auto const& payload_str = req.body();
+    json_t payload = payload_format == ukv_format_msgpack_k ? json_t::from_msgpack(payload_str, true, false)
+                                                            : json_t::parse(payload_str, nullptr, false);
+    if (payload.is_discarded() || !payload.is_object())
+        return send_response(make_error(req, http::status::bad_request, "Couldn't parse the payload object"));
+
+    // Validate and deserialize the requested keys
+    auto keys_it = payload.find("keys");
+    if (keys_it == payload.end() || !keys_it->is_array())
+        return send_response(make_error(req, http::status::bad_request, "Batches must provide a list of integer keys"));
+    connection.keys.clear();
+    for (auto const& key_json : *keys_it) {
+        if (!key_json.is_number_integer())
+            return send_response(
+                make_error(req, http::status::bad_request, "Batches must provide a list of integer keys"));
+        connection.keys.push_back(key_json.template get<ukv_key_t>());
+    }
+    auto tasks_count = static_cast<ukv_size_t>(connection.keys.size());
+
+    // Resolve the collections through the cache of the connection
+    status_t status;
+    connection.cols.clear();
+    auto params_begin = std::find(received_path.begin(), received_path.end(), '?');
+    auto params_str = beast::string_view {params_begin, static_cast<size_t>(received_path.end() - params_begin)};
+    auto cols_it = payload.find("cols");
+    if (cols_it == payload.end())
+        connection.cols.push_back(connection.collection(param_value(params_str, "col=").value_or(""), //
+                                                        status.member_ptr()));
+    else if (cols_it->is_string())
+        connection.cols.push_back(connection.collection(cols_it->template get_ref<std::string const&>(), //
+                                                        status.member_ptr()));
+    else if (cols_it->is_array() && cols_it->size() == tasks_count)
+        for (auto const& col_json : *cols_it) {
+            if (!col_json.is_string())
+                return send_response(
+                    make_error(req, http::status::bad_request, "Collections must be passed by names"));
+            connection.cols.push_back(connection.collection(col_json.template get_ref<std::string const&>(), //
+                                                            status.member_ptr()));
+            if (!status)
+                break;
+        }
+    else
+        return send_response(
+            make_error(req, http::status::bad_request, "Collections must be a name or a name per key"));
+    if (!status)
+        return send_response(make_error(req, http::status::internal_server_error, status.release_exception().what()));
+    auto cols_stride = connection.cols.size() == 1 ? 0u : sizeof(ukv_col_t);
+
+    switch (received_verb) {
+
+        // Read the data or just its lengths:
+    case http::verb::get: {
+
+        bool lengths_only = payload.value("lengths", false);
+        ukv_val_ptr_t found_values = nullptr;
+        ukv_val_len_t* found_offsets = nullptr;
+        ukv_val_len_t* found_lengths = nullptr;
+        ukv_read(connection.db,
+                 nullptr,
+                 tasks_count,
+                 connection.cols.data(),
+                 cols_stride,
+                 connection.keys.data(),
+                 sizeof(ukv_key_t),
+                 lengths_only ? ukv_option_read_lengths_k : options,
+                 &found_values,
+                 &found_offsets,
+                 &found_lengths,
+                 connection.arena,
+                 status.member_ptr());
+        if (!status)
+            return send_response(
+                make_error(req, http::status::internal_server_error, status.release_exception().what()));
+
+        // Missing entries are marked with `ukv_val_len_missing_k` and take no space on the tape
+        json_t response = json_t::object();
+        response["lens"] = std::vector<ukv_val_len_t>(found_lengths, found_lengths + tasks_count);
+        if (!lengths_only) {
+            json_t::binary_t tape;
+            for (ukv_size_t i = 0; i != tasks_count; ++i)
+                if (found_lengths[i] != ukv_val_len_missing_k)
+                    tape.insert(tape.end(),
+                                found_values + found_offsets[i],
+                                found_values + found_offsets[i] + found_lengths[i]);
+            response["tape"] = std::move(tape);
+        }
+
+        std::string response_str;
+        if (payload_format == ukv_format_msgpack_k)
+            json_t::to_msgpack(response, nlohmann::detail::output_adapter<char>(response_str));
+        else
+            response_str = response.dump();
+
+        http::response<http::string_body> res {
+            std::piecewise_construct,
+            std::make_tuple(std::move(response_str)),
+            std::make_tuple(http::status::ok, req.version()),
+        };
+        res.set(http::field::server, server_name_k);
+        res.set(http::field::content_type, payload_type);
+        res.keep_alive(req.keep_alive());
+        res.prepare_payload();
+        return send_response(std::move(res));
+    }
+
+        // Upsert or delete the data:
+    case http::verb::put:
+    case http::verb::delete_: {
+
+        ukv_val_ptr_t tape_ptr = nullptr;
+        bool is_deletion = received_verb == http::verb::delete_;
+        if (!is_deletion) {
+            auto lens_it = payload.find("lens");
+            auto tape_it = payload.find("tape");
+            if (lens_it == payload.end() || !lens_it->is_array() || lens_it->size() != tasks_count ||
+                tape_it == payload.end() || !(tape_it->is_binary() || tape_it->is_string()))
+                return send_response(make_error(req,
+                                                http::status::bad_request,
+                                                "PUT requests must provide a tape and a length per key"));
+
+            // Deduce the offsets of the values on the tape
+            std::size_t tape_size = tape_it->is_binary() ? tape_it->get_binary().size()
+                                                         : tape_it->template get_ref<std::string const&>().size();
+            std::size_t total_size = 0;
+            connection.offsets.clear();
+            connection.lengths.clear();
+            for (auto const& len_json : *lens_it) {
+                if (!len_json.is_number_unsigned() || len_json.template get<std::size_t>() > tape_size - total_size)
+                    return send_response(make_error(req,
+                                                    http::status::bad_request,
+                                                    "Lengths of values must fit into the tape"));
+                connection.offsets.push_back(static_cast<ukv_val_len_t>(total_size));
+                connection.lengths.push_back(len_json.template get<ukv_val_len_t>());
+                total_size += connection.lengths.back();
+            }
+
+            tape_ptr = tape_it->is_binary()
+                           ? reinterpret_cast<ukv_val_ptr_t>(tape_it->get_binary().data())
+                           : reinterpret_cast<ukv_val_ptr_t>(tape_it->template get_ref<std::string&>().data());
+        }
+
+        ukv_write(connection.db,
+                  nullptr,
+                  tasks_count,
+                  connection.cols.data(),
+                  cols_stride,
+                  connection.keys.data(),
+                  sizeof(ukv_key_t),
+                  is_deletion ? nullptr : &tape_ptr,
+                  0,
+                  connection.offsets.data(),
+                  sizeof(ukv_val_len_t),
+                  connection.lengths.data(),
+                  sizeof(ukv_val_len_t),
+                  options,
+                  connection.arena,
+                  status.member_ptr());
+        if (!status)
+            return send_response(
+                make_error(req, http::status::internal_server_error, status.release_exception().what()));
+
+        http::response<http::empty_body> res {http::status::ok, req.version()};
+        res.set(http::field::server, server_name_k);
+        res.keep_alive(req.keep_alive());
+        return send_response(std::move(res));
+    }
+
+    default: {
+        return send_response(make_error(req, http::status::bad_request, "Unsupported HTTP verb"));
+    }
+    }
+}
+
+/**
+ * @brief Streams all the entries of a collection with keys in `[min, max)`,
+ * scanning and reading them in batches with chunked transfer encoding.
+ * @see `scan_body_t` for the binary layout of the response.
+ */
+template <typename body_at, typename allocator_at, typename send_response_at>
+void respond_to_scan(connection_t& connection,
+                     http::request<body_at, http::basic_fields<allocator_at>>&& req,
+                     send_response_at&& send_response) {
+
+    if (req.method() != http::verb::get)
+        return send_response(make_error(req, http::status::bad_request, "Unsupported HTTP verb"));
+
+    beast::string_view received_path = req.target();
+    auto params_begin = std::find(received_path.begin(), received_path.end(), '?');
+    auto params_str = beast::string_view {params_begin, static_cast<size_t>(received_path.end() - params_begin)};
+
+    ukv_key_t min_key = std::numeric_limits<ukv_key_t>::min();
+    ukv_key_t max_key = ukv_key_unknown_k;
+    ukv_size_t batch_size = scan_batch_size_k;
+    if (!param_integer(params_str, "min=", min_key) || !param_integer(params_str, "max=", max_key) ||
+        !param_integer(params_str, "batch=", batch_size) || !batch_size)
+        return send_response(make_error(req, http::status::bad_request, "Couldn't parse the range of keys"));
+
+    status_t status;
+    ukv_col_t collection = connection.collection(param_value(params_str, "col=").value_or(""), status.member_ptr());
+    if (!status)
+        return send_response(make_error(req, http::status::internal_server_error, status.release_exception().what()));
+
+    http::response<scan_body_t> res {
+        std::piecewise_construct,
+        std::make_tuple(connection.db, collection, min_key, max_key, batch_size),
+        std::make_tuple(http::status::ok, req.version()),
+    };
+    res.set(http::field::server, server_name_k);
+    res.set(http::field::content_type, mime_binary_k);
+    res.chunked(true);
+    res.keep_alive(req.keep_alive());
+    return send_response(std::move(res));
+}
+
+template <typename body_at, typename allocator_at, typename send_response_at>
+void respond_to_aos(connection_t& connection,
+                    http::request<body_at, http::basic_fields<allocator_at>>&& req,
+                    send_response_at&& send_response) {
+
+    beast::string_view received_path = req.target();
+
+    std::vector<ukv_col_t> collections;
     std::vector<ukv_key_t> keys;
 
     // Parse the free-order parameters, starting with transaction identifier.
     auto params_begin = std::find(received_path.begin(), received_path.end(), '?');
     auto params_str = beast::string_view {params_begin, static_cast<size_t>(received_path.end() - params_begin)};
-    if (auto txn_val = param_value(params_str, "txn="); txn_val) {
-        auto txn_id = size_t {0};
-        auto txn_parse_result = std::from_chars(txn_val->data(), txn_val->data() + txn_val->size(), txn_id);
-        if (txn_parse_result.ec != std::errc())
-            return send_response(make_error(req, http::status::bad_request, "Couldn't parse the transaction id"));
-    }
+    auto txn_id = size_t {0};
+    if (!param_integer(params_str, "txn=", txn_id))
+        return send_response(make_error(req, http::status::bad_request, "Couldn't parse the transaction id"));
 
     // Parse the collection name string.
     if (auto col_val = param_value(params_str, "col="); col_val) {
-        char col_name_buffer[65] = {0};
-        std::memcpy(col_name_buffer, col_val->data(), std::min(col_val->size(), 64ul));
-
         status_t status;
-        col_t collection(session.db());
-        ukv_col_open(session.db(), col_name_buffer, NULL, &collection.raw, error.member_ptr());
+        collections.push_back(connection.collection(*col_val, status.member_ptr()));
         if (!status)
-            return send_response(make_error(req, http::status::internal_server_error, error.raw));
-
-        collections.raw_array.emplace_back(std::exchange(collection.raw, nullptr));
+            return send_response(
+                make_error(req, http::status::internal_server_error, status.release_exception().what()));
         // ukv_option_read_colocated(&options, true);
     }
 
     // Make sure we support the requested content type
     auto payload_type = req[http::field::content_type];
-    auto payload_format = mime_to_format(payload_type);
     if (payload_type != mime_json_k && payload_type != mime_msgpack_k && payload_type != mime_cbor_k &&
         payload_type != mime_bson_k && payload_type != mime_ubjson_k)
         return send_response(make_error(req,
                                         http::status::unsupported_media_type,
                                         "We only support json, msgpack, cbor, bson and ubjson MIME types"));
 
-    // Make sure the payload is present, as it handles the heavy part of the query
-    auto opt_payload_len = req.payload_size();
-    if (!opt_payload_len)
-        return send_response(make_error(req, http::status::length_required, "Chunk Transfer Encoding isn't supported"));
+#if 0
+    http::verb received_verb = req.method();
+    ukv_options_t options = ukv_options_default_k;
+    auto payload_format = mime_to_format(payload_type);
 
-    // Parse the payload, that will contain auxiliary data
-    auto payload = req.body();
+    // Parse the payload, that will contain auxiliary data.
+    // Chunked payloads are already assembled by the parser.
+    auto const& payload = req.body();
     auto payload_ptr = reinterpret_cast<char const*>(payload.data());
-    auto payload_len = static_cast<ukv_size_t>(*opt_payload_len);
+    auto payload_len = static_cast<ukv_size_t>(payload.size());
 
-#if 0
     // Once we know, which collection, key and transation user is
     // interested in - perform the actions depending on verbs.
     //
@@ -665,24 +1053,47 @@ void respond_to_aos(db_session_t& session,
     return send_response(std::move(res));
 }
 
+/**
+ * @brief Exports the metrics of the underlying DB in the Prometheus text format.
+ * @see The "metrics.prometheus" request of `ukv_db_control`.
+ */
+template <typename body_at, typename allocator_at, typename send_response_at>
+void respond_to_metrics(connection_t& connection,
+                        http::request<body_at, http::basic_fields<allocator_at>>&& req,
+                        send_response_at&& send_response) {
+
+    if (req.method() != http::verb::get)
+        return send_response(make_error(req, http::status::bad_request, "Unsupported HTTP verb"));
+
+    status_t status;
+    ukv_str_view_t metrics = nullptr;
+    ukv_db_control(connection.db, "metrics.prometheus", &metrics, status.member_ptr());
+    if (!status)
+        return send_response(make_error(req, http::status::internal_server_error, status.release_exception().what()));
+
+    http::response<http::string_body> res {http::status::ok, req.version()};
+    res.set(http::field::server, server_name_k);
+    res.set(http::field::content_type, "text/plain; version=0.0.4");
+    res.keep_alive(req.keep_alive());
+    res.body() = metrics;
+    res.prepare_payload();
+    return send_response(std::move(res));
+}
+
 /**
  * @brief Primary dispatch point, rounting incoming HTTP requests
  *        into underlying UKV calls, preparing results and sending back.
  */
 template <typename body_at, typename allocator_at, typename send_response_at>
-void route_request(db_session_t& session,
+void route_request(connection_t& connection,
                    http::request<body_at, http::basic_fields<allocator_at>>&& req,
                    send_response_at&& send_response) {
 
-    http::verb received_verb = req.method();
     beast::string_view received_path = req.target();
-    fmt::print("Received path: {} {}\n",
-               std::string(beast::http::to_string(received_verb)),
-               std::string(received_path));
 
     // Modifying single entries:
     if (received_path.starts_with("/one/"))
-        return respond_to_one(session, std::move(req), send_response);
+        return respond_to_one(connection, std::move(req), send_response);
 
     // Modifying collections:
     else if (received_path.starts_with("/col/")) {
@@ -698,11 +1109,19 @@ void route_request(db_session_t& session,
 
     // Array-of-Structures:
     else if (received_path.starts_with("/aos/"))
-        return respond_to_aos(session, std::move(req), send_response);
+        return respond_to_aos(connection, std::move(req), send_response);
 
     // Structure-of-Arrays:
     else if (received_path.starts_with("/soa/"))
-        return send_response(make_error(req, http::status::bad_request, "Batch API aren't implemented yet"));
+        return respond_to_soa(connection, std::move(req), send_response);
+
+    // Streaming ranges:
+    else if (received_path.starts_with("/scan/"))
+        return respond_to_scan(connection, std::move(req), send_response);
+
+    // Monitoring:
+    else if (received_path.starts_with("/metrics"))
+        return respond_to_metrics(connection, std::move(req), send_response);
 
     // Array-of-Structures:
     else if (received_path.starts_with("/arrow/"))
@@ -713,45 +1132,80 @@ void route_request(db_session_t& session,
 
 /**
  * @brief A communication channel/session for a single client.
+ * Supports HTTP pipelining: the following requests are read and handled
+ * while the responses to the previous ones are still being written.
  */
 class web_db_session_t : public std::enable_shared_from_this<web_db_session_t> {
-    // This is the C++11 equivalent of a generic lambda.
-    // The function object is used to send an HTTP message.
-    struct send_request_t {
-        web_db_session_t& self_;
 
-        explicit send_request_t(web_db_session_t& self) noexcept : self_(self) {}
+    /**
+     * @brief Responses to pipelined requests, written back in the order of arrival.
+     * Requests are read ahead, until the queue is full, to hide the round-trip latency.
+     * This is the C++11 equivalent of a generic lambda over the message types.
+     */
+    class responses_queue_t {
+        static constexpr std::size_t limit_k = 16;
+
+        struct response_t {
+            virtual ~response_t() = default;
+            virtual void write() = 0;
+        };
+
+        web_db_session_t& self_;
+        std::deque<std::unique_ptr<response_t>> responses_;
+
+      public:
+        explicit responses_queue_t(web_db_session_t& self) noexcept : self_(self) {}
+
+        bool is_full() const noexcept { return responses_.size() >= limit_k; }
+
+        /**
+         * @brief Drops the written response and starts writing the next one.
+         * @return true If the queue was full, so reading has to be resumed.
+         */
+        bool on_write() {
+            bool was_full = is_full();
+            responses_.pop_front();
+            if (!responses_.empty())
+                responses_.front()->write();
+            return was_full;
+        }
 
         template <bool ir_request_ak, typename body_at, typename fields_at>
-        void operator()(http::message<ir_request_ak, body_at, fields_at>&& msg) const {
+        void operator()(http::message<ir_request_ak, body_at, fields_at>&& msg) {
             // The lifetime of the message has to extend
-            // for the duration of the async operation so
-            // we use a `std::shared_ptr` to manage it.
-            auto sp = std::make_shared<http::message<ir_request_ak, body_at, fields_at>>(std::move(msg));
-
-            // Store a type-erased version of the shared
-            // pointer in the class to keep it alive.
-            self_.res_ = sp;
-
-            // Write the response
-            http::async_write(
-                self_.stream_,
-                *sp,
-                beast::bind_front_handler(&web_db_session_t::on_write, self_.shared_from_this(), sp->need_eof()));
+            // for the duration of the async operation.
+            struct typed_response_t final : public response_t {
+                web_db_session_t& self_;
+                http::message<ir_request_ak, body_at, fields_at> msg_;
+
+                typed_response_t(web_db_session_t& self, http::message<ir_request_ak, body_at, fields_at>&& msg)
+                    : self_(self), msg_(std::move(msg)) {}
+
+                void write() override {
+                    http::async_write(self_.stream_,
+                                      msg_,
+                                      beast::bind_front_handler(&web_db_session_t::on_write,
+                                                                self_.shared_from_this(),
+                                                                msg_.need_eof()));
+                }
+            };
+
+            responses_.push_back(std::make_unique<typed_response_t>(self_, std::move(msg)));
+            if (responses_.size() == 1)
+                responses_.front()->write();
         }
     };
 
     beast::tcp_stream stream_;
     beast::flat_buffer buffer_;
     std::shared_ptr<db_w_clients_t> db_;
-    db_session_t db_session_;
+    connection_t connection_;
     http::request<http::string_body> req_;
-    std::shared_ptr<void> res_;
-    send_request_t send_request_;
+    responses_queue_t responses_;
 
   public:
     web_db_session_t(tcp::socket&& socket, std::shared_ptr<db_w_clients_t> const& session)
-        : stream_(std::move(socket)), db_(session), db_session_(session->session()), send_request_(*this) {}
+        : stream_(std::move(socket)), db_(session), connection_(session->session), responses_(*this) {}
 
     /**
      * @brief Start the asynchronous operation.
@@ -790,8 +1244,10 @@ class web_db_session_t : public std::enable_shared_from_this<web_db_session_t> {
         if (ec)
             return log_failure(ec, "read");
 
-        // send_at the response
-        route_request(db_session_, std::move(req_), send_request_);
+        // Queue the response and read the following request, if there is room for its response
+        route_request(connection_, std::move(req_), responses_);
+        if (!responses_.is_full())
+            do_read();
     }
 
     void on_write(bool close, beast::error_code ec, std::size_t bytes_transferred) {
@@ -805,11 +1261,10 @@ class web_db_session_t : public std::enable_shared_from_this<web_db_session_t> {
             // the response indicated the "Connection: close" semantic.
             return do_close();
 
-        // We're done with the response so delete it
-        res_ = nullptr;
-
-        // Read another request
-        do_read();
+        // We're done with the response, so let's write the next one,
+        // and resume reading, if it was blocked by a full queue.
+        if (responses_.on_write())
+            do_read();
     }
 
     void do_close() {
@@ -825,13 +1280,17 @@ class web_db_session_t : public std::enable_shared_from_this<web_db_session_t> {
  *        Once accepted, allocates and dispatches a new @c `web_db_session_t`.
  */
 class listener_t : public std::enable_shared_from_this<listener_t> {
-    net::io_context& io_context_;
+    /// Connections are spread across the pools of all the NUMA nodes.
+    std::vector<net::io_context*> io_contexts_;
+    std::size_t next_context_ = 0;
     tcp::acceptor acceptor_;
     std::shared_ptr<db_w_clients_t> db_;
 
   public:
-    listener_t(net::io_context& io_context, tcp::endpoint endpoint, std::shared_ptr<db_w_clients_t> const& session)
-        : io_context_(io_context), acceptor_(net::make_strand(io_context)), db_(session) {
+    listener_t(std::vector<net::io_context*> io_contexts,
+               tcp::endpoint endpoint,
+               std::shared_ptr<db_w_clients_t> const& session)
+        : io_contexts_(std::move(io_contexts)), acceptor_(net::make_strand(*io_contexts_.front())), db_(session) {
         connect_to(endpoint);
     }
 
@@ -841,7 +1300,8 @@ class listener_t : public std::enable_shared_from_this<listener_t> {
   private:
     void do_accept() {
         // The new connection gets its own strand
-        acceptor_.async_accept(net::make_strand(io_context_),
+        net::io_context& io_context = *io_contexts_[next_context_++ % io_contexts_.size()];
+        acceptor_.async_accept(net::make_strand(io_context),
                                beast::bind_front_handler(&listener_t::on_accept, shared_from_this()));
     }
 
@@ -887,10 +1347,11 @@ int main(int argc, char* argv[]) {
 
     // Check command line arguments
     if (argc < 4) {
-        std::cerr << "Usage: ukv_beast_server <address> <port> <threads> <db_config_path>?\n"
+        std::cerr << "Usage: ukv_beast_server <address> <port> <threads> <db_config_path>? numa?\n"
                   << "Example:\n"
                   << "    ukv_beast_server 0.0.0.0 8080 1\n"
                   << "    ukv_beast_server 0.0.0.0 8080 1 ./config.json\n"
+                  << "    ukv_beast_server 0.0.0.0 8080 32 ./config.json numa\n"
                   << "";
         return EXIT_FAILURE;
     }
@@ -912,23 +1373,43 @@ int main(int argc, char* argv[]) {
 
     // Check if we can initialize the DB
     auto session = std::make_shared<db_w_clients_t>();
-    status_t status;
-    ukv_db_open(db_config.c_str(), &session->raw, error.member_ptr());
+    status_t status = session->session.open(db_config);
     if (!status) {
-        std::cerr << "Couldn't initialize DB: " << error.raw << std::endl;
+        std::cerr << "Couldn't initialize DB: " << status.release_exception().what() << std::endl;
         return EXIT_FAILURE;
     }
 
+    // In the NUMA mode, threads are split evenly between the nodes and pinned to them
+    bool const numa = argc >= 6 && std::string_view(argv[5]) == "numa";
+    std::size_t const threads_count = static_cast<std::size_t>(threads);
+    std::size_t const nodes = numa ? std::min(numa_topology_t::host().size(), threads_count) : 1;
+    std::vector<std::unique_ptr<net::io_context>> io_contexts;
+    std::vector<net::io_context*> io_contexts_ptrs;
+    for (std::size_t node = 0; node != nodes; ++node) {
+        auto const node_threads = threads_count / nodes + (node < threads_count % nodes);
+        io_contexts.push_back(std::make_unique<net::io_context>(static_cast<int>(node_threads)));
+        io_contexts_ptrs.push_back(io_contexts.back().get());
+    }
+
+    // Pools of other nodes may have no connections yet, but must keep running
+    std::vector<net::executor_work_guard<net::io_context::executor_type>> guards;
+    for (auto& io_context : io_contexts)
+        guards.push_back(net::make_work_guard(*io_context));
+
     // Create and launch a listening port
-    auto io_context = net::io_context {threads};
-    std::make_shared<listener_t>(io_context, tcp::endpoint {address, port}, session)->run();
+    std::make_shared<listener_t>(io_contexts_ptrs, tcp::endpoint {address, port}, session)->run();
 
     // Run the I/O service on the requested number of threads
+    auto run = [&io_contexts, nodes](std::size_t node) {
+        if (nodes > 1)
+            numa_pin_thread(node);
+        io_contexts[node]->run();
+    };
     std::vector<std::thread> v;
     v.reserve(threads - 1);
     for (auto i = threads - 1; i > 0; --i)
-        v.emplace_back([&io_context] { io_context.run(); });
-    io_context.run();
+        v.emplace_back(run, static_cast<std::size_t>(i) % nodes);
+    run(0);
 
     return EXIT_SUCCESS;
 }
\ No newline at end of file
@@ -1,22 +1,828 @@
+/**
+ * @file rpc_client.cpp
+ * @author Ashot Vardanian
+ *
+ * @brief Remote backend, implementing the C API on top of `rpc_server.cpp`.
+ *
+ * Every call serializes the whole strided batch into a single frame and waits for a
+ * single response, so remote access costs one round trip per batch, not per key.
+ * Responses are received directly into the arena and exported without copies.
+ *
+ * Connections are persistent and pooled. A call borrows an idle connection or opens
+ * a new one, if all are busy, so concurrent threads never wait for each other's replies.
+ * Every connection carries one request at a time, although the server would execute
+ * pipelined frames in order. So there are as many requests in flight as calling threads,
+ * and `ukv_*_async` submissions are bounded by `ukv_async_threads_limit`. Pipelining
+ * batches over a shared connection would lift that bound, but isn't implemented yet.
+ * The config passed to `ukv_db_open` is the "host:port" address of the server.
+ */
+
+#include <mutex>
+#include <atomic>
+#include <memory>
 #include <vector>
 #include <string>
 #include <string_view>
-#include <unordered_map>
-#include <shared_mutex>
-#include <atomic>
 #include <cstring> // `std::memcpy`
 
-#include "ukv/ukv.h"
+#include <boost/asio.hpp>
+
+#include "ukv/db.h"
+#include "helpers.hpp"
+#include "rpc_protocol.hpp"
+
+/*********************************************************/
+/*****************	 Structures & Consts  ****************/
+/*********************************************************/
+
+ukv_col_t ukv_col_main_k = 0;
+ukv_val_len_t ukv_val_len_missing_k = std::numeric_limits<ukv_val_len_t>::max();
+ukv_key_t ukv_key_unknown_k = std::numeric_limits<ukv_key_t>::max();
 
 /*********************************************************/
 /*****************	 C++ Implementation	  ****************/
 /*********************************************************/
 
+using namespace unum::ukv;
+using namespace unum;
+
+namespace net = boost::asio;
+using tcp = boost::asio::ip::tcp;
+
 namespace {
 
+struct remote_conn_t {
+    net::io_context io_context;
+    tcp::socket socket {io_context};
+    buffer_t request;
+};
+
+using remote_conn_ptr_t = std::unique_ptr<remote_conn_t>;
+
 struct remote_db_t {
-    int socket;
-    int io_context;
+    std::string host;
+    std::string port;
+    std::mutex idle_mutex;
+    std::vector<remote_conn_ptr_t> idle;
+    std::atomic<std::uint32_t> last_request_id {0};
+};
+
+struct remote_txn_t {
+    remote_db_t* db = nullptr;
+    std::uint64_t id = 0;
 };
 
+/// Remote error messages must outlive the call, until the next failure on the same thread.
+thread_local std::string remote_error;
+/// Calls, that don't receive an arena from the user, use this one.
+thread_local stl_arena_t remote_arena;
+
+void connect(remote_db_t& db, remote_conn_t& conn) {
+    tcp::resolver resolver {conn.io_context};
+    net::connect(conn.socket, resolver.resolve(db.host, db.port));
+    conn.socket.set_option(tcp::no_delay(true));
+}
+
+remote_conn_ptr_t borrow_conn(remote_db_t& db) {
+    {
+        std::lock_guard _ {db.idle_mutex};
+        if (!db.idle.empty()) {
+            remote_conn_ptr_t conn = std::move(db.idle.back());
+            db.idle.pop_back();
+            return conn;
+        }
+    }
+    auto conn = std::make_unique<remote_conn_t>();
+    connect(db, *conn);
+    return conn;
+}
+
+void return_conn(remote_db_t& db, remote_conn_ptr_t conn) {
+    std::lock_guard _ {db.idle_mutex};
+    db.idle.push_back(std::move(conn));
+}
+
+/**
+ * @brief Sends a request, serialized by @p fill_request, and receives the
+ * response into the `output_tape` of the @p arena.
+ * @return The reader over the response payload. On failure, it's empty and @p c_error is set.
+ */
+template <typename fill_request_at>
+rpc_reader_t remote_call(remote_db_t& db,
+                         rpc_method_t method,
+                         stl_arena_t& arena,
+                         fill_request_at&& fill_request,
+                         ukv_error_t* c_error) noexcept {
+    try {
+        remote_conn_ptr_t conn = borrow_conn(db);
+        rpc_writer_t request {conn->request};
+        std::uint32_t request_id = ++db.last_request_id;
+        request.start();
+        fill_request(request);
+        request.finish(method, request_id);
+        net::write(conn->socket, net::buffer(conn->request.data(), conn->request.size()));
+
+        // A broken connection is dropped, instead of being returned to the pool
+        rpc_header_t header;
+        net::read(conn->socket, net::buffer(&header, sizeof(header)));
+        if ((header.request_id != request_id || header.length > rpc_max_payload_k) &&
+            (*c_error = "Remote response is out of order!"))
+            return {nullptr, 0};
+
+        byte_t* payload = prepare_memory(arena, arena.output_tape, header.length, c_error);
+        if (*c_error)
+            return {nullptr, 0};
+        net::read(conn->socket, net::buffer(payload, header.length));
+        return_conn(db, std::move(conn));
+
+        if (header.failed) {
+            remote_error.assign(reinterpret_cast<char const*>(payload), header.length);
+            *c_error = remote_error.c_str();
+            return {nullptr, 0};
+        }
+        return {payload, header.length};
+    }
+    catch (std::bad_alloc const&) {
+        *c_error = "Failed to allocate memory!";
+    }
+    catch (std::exception const& e) {
+        remote_error = std::string("Remote call failed: ") + e.what();
+        *c_error = remote_error.c_str();
+    }
+    return {nullptr, 0};
+}
+
+std::uint64_t remote_txn_id(ukv_txn_t const c_txn) noexcept {
+    return c_txn ? reinterpret_cast<remote_txn_t const*>(c_txn)->id : 0;
+}
+
 } // namespace
+
+/*********************************************************/
+/*****************	    C Interface 	  ****************/
+/*********************************************************/
+
+void ukv_db_open( //
+    ukv_str_view_t c_config,
+    ukv_t* c_db,
+    ukv_error_t* c_error) {
+
+    try {
+        auto db_ptr = std::make_unique<remote_db_t>();
+        auto address = std::string_view(c_config ? c_config : "");
+        auto colon = address.rfind(':');
+        db_ptr->host = address.empty() ? "127.0.0.1" : std::string(address.substr(0, colon));
+        db_ptr->port = colon != std::string_view::npos ? std::string(address.substr(colon + 1))
+                                                       : std::to_string(rpc_default_port_k);
+
+        // Connect right away, to report unreachable servers early
+        return_conn(*db_ptr, borrow_conn(*db_ptr));
+        *c_db = db_ptr.release();
+    }
+    catch (std::exception const& e) {
+        remote_error = std::string("Failed to connect to the server: ") + e.what();
+        *c_error = remote_error.c_str();
+    }
+}
+
+void ukv_read( //
+    ukv_t const c_db,
+    ukv_txn_t const c_txn,
+    ukv_size_t const c_tasks_count,
+
+    ukv_col_t const* c_cols,
+    ukv_size_t const c_cols_stride,
+
+    ukv_key_t const* c_keys,
+    ukv_size_t const c_keys_stride,
+
+    ukv_options_t const c_options,
+
+    ukv_val_ptr_t* c_found_values,
+    ukv_val_len_t** c_found_offsets,
+    ukv_val_len_t** c_found_lengths,
+
+    ukv_arena_t* c_arena,
+    ukv_error_t* c_error) {
+
+    if (!c_db && (*c_error = "DataBase is NULL!"))
+        return;
+
+    stl_arena_t& arena = *cast_arena(c_arena, c_error);
+    if (*c_error)
+        return;
+
+    remote_db_t& db = *reinterpret_cast<remote_db_t*>(c_db);
+    strided_iterator_gt<ukv_col_t const> cols {c_cols, c_cols_stride};
+    strided_iterator_gt<ukv_key_t const> keys {c_keys, c_keys_stride};
+    rpc_reader_t response = remote_call(
+        db,
+        rpc_method_t::read_k,
+        arena,
+        [&](rpc_writer_t& request) {
+            request.push(remote_txn_id(c_txn));
+            request.push(c_options);
+            request.push(c_tasks_count);
+            request.push_strided(cols, c_tasks_count);
+            request.push_strided(keys, c_tasks_count);
+        },
+        c_error);
+    if (*c_error)
+        return;
+
+    std::uint8_t has_values = 0;
+    std::uint64_t tape_length = 0;
+    ukv_val_len_t const* lengths = nullptr;
+    ukv_val_len_t const* offsets = nullptr;
+    byte_t const* tape = nullptr;
+    bool is_valid = response.pop(has_values) && (lengths = response.pop_array<ukv_val_len_t>(c_tasks_count)) &&
+                    (!has_values || (offsets = response.pop_array<ukv_val_len_t>(c_tasks_count))) &&
+                    response.pop(tape_length) && (tape = response.pop_array<byte_t>(tape_length));
+    if (!is_valid && (*c_error = "Malformed remote response!"))
+        return;
+
+    *c_found_lengths = const_cast<ukv_val_len_t*>(lengths);
+    *c_found_offsets = const_cast<ukv_val_len_t*>(offsets);
+    *c_found_values = has_values ? reinterpret_cast<ukv_val_ptr_t>(const_cast<byte_t*>(tape)) : nullptr;
+}
+
+/**
+ * @brief Packs the values of a `ukv_write` or `ukv_bulk_load` batch into a single tape.
+ * Deletions are marked with `ukv_val_len_missing_k` lengths.
+ */
+void push_write_tasks(rpc_writer_t& request, write_tasks_soa_t const& tasks, bool has_values) {
+    request.push_strided(tasks.cols, tasks.count);
+    request.push_strided(tasks.keys, tasks.count);
+    request.push(static_cast<std::uint8_t>(has_values));
+    if (!has_values)
+        return;
+
+    ukv_val_len_t* lengths = request.push_array<ukv_val_len_t>(tasks.count);
+    std::uint64_t tape_length = 0;
+    for (ukv_size_t i = 0; i != tasks.count; ++i) {
+        write_task_t task = tasks[i];
+        lengths[i] = task.is_deleted() ? ukv_val_len_missing_k : task.length;
+        tape_length += task.is_deleted() ? 0 : task.length;
+    }
+
+    request.push(tape_length);
+    byte_t* tape = request.push_array<byte_t>(tape_length);
+    for (ukv_size_t i = 0; i != tasks.count; ++i) {
+        write_task_t task = tasks[i];
+        if (task.is_deleted())
+            continue;
+        std::memcpy(tape, task.begin + task.offset, task.length);
+        tape += task.length;
+    }
+}
+
+void ukv_write( //
+    ukv_t const c_db,
+    ukv_txn_t const c_txn,
+    ukv_size_t const c_tasks_count,
+
+    ukv_col_t const* c_cols,
+    ukv_size_t const c_cols_stride,
+
+    ukv_key_t const* c_keys,
+    ukv_size_t const c_keys_stride,
+
+    ukv_val_ptr_t const* c_vals,
+    ukv_size_t const c_vals_stride,
+
+    ukv_val_len_t const* c_offs,
+    ukv_size_t const c_offs_stride,
+
+    ukv_val_len_t const* c_lens,
+    ukv_size_t const c_lens_stride,
+
+    ukv_options_t const c_options,
+
+    ukv_arena_t* c_arena,
+    ukv_error_t* c_error) {
+
+    if (!c_db && (*c_error = "DataBase is NULL!"))
+        return;
+
+    stl_arena_t& arena = *cast_arena(c_arena, c_error);
+    if (*c_error)
+        return;
+
+    remote_db_t& db = *reinterpret_cast<remote_db_t*>(c_db);
+    strided_iterator_gt<ukv_col_t const> cols {c_cols, c_cols_stride};
+    strided_iterator_gt<ukv_key_t const> keys {c_keys, c_keys_stride};
+    strided_iterator_gt<ukv_val_ptr_t const> vals {c_vals, c_vals_stride};
+    strided_iterator_gt<ukv_val_len_t const> offs {c_offs, c_offs_stride};
+    strided_iterator_gt<ukv_val_len_t const> lens {c_lens, c_lens_stride};
+    write_tasks_soa_t tasks {cols, keys, vals, offs, lens, c_tasks_count};
+
+    remote_call(
+        db,
+        rpc_method_t::write_k,
+        arena,
+        [&](rpc_writer_t& request) {
+            request.push(remote_txn_id(c_txn));
+            request.push(c_options);
+            request.push(c_tasks_count);
+            push_write_tasks(request, tasks, c_vals != nullptr);
+        },
+        c_error);
+}
+
+void ukv_bulk_load( //
+    ukv_t const c_db,
+    ukv_size_t const c_tasks_count,
+
+    ukv_col_t const* c_cols,
+    ukv_size_t const c_cols_stride,
+
+    ukv_key_t const* c_keys,
+    ukv_size_t const c_keys_stride,
+
+    ukv_val_ptr_t const* c_vals,
+    ukv_size_t const c_vals_stride,
+
+    ukv_val_len_t const* c_offs,
+    ukv_size_t const c_offs_stride,
+
+    ukv_val_len_t const* c_lens,
+    ukv_size_t const c_lens_stride,
+
+    ukv_options_t const c_options,
+
+    ukv_arena_t* c_arena,
+    ukv_error_t* c_error) {
+
+    if (!c_db && (*c_error = "DataBase is NULL!"))
+        return;
+
+    stl_arena_t& arena = *cast_arena(c_arena, c_error);
+    if (*c_error)
+        return;
+
+    remote_db_t& db = *reinterpret_cast<remote_db_t*>(c_db);
+    strided_iterator_gt<ukv_col_t const> cols {c_cols, c_cols_stride};
+    strided_iterator_gt<ukv_key_t const> keys {c_keys, c_keys_stride};
+    strided_iterator_gt<ukv_val_ptr_t const> vals {c_vals, c_vals_stride};
+    strided_iterator_gt<ukv_val_len_t const> offs {c_offs, c_offs_stride};
+    strided_iterator_gt<ukv_val_len_t const> lens {c_lens, c_lens_stride};
+    write_tasks_soa_t tasks {cols, keys, vals, offs, lens, c_tasks_count};
+
+    remote_call(
+        db,
+        rpc_method_t::bulk_load_k,
+        arena,
+        [&](rpc_writer_t& request) {
+            request.push(std::uint64_t(0));
+            request.push(c_options);
+            request.push(c_tasks_count);
+            push_write_tasks(request, tasks, c_vals != nullptr);
+        },
+        c_error);
+}
+
+void ukv_scan( //
+    ukv_t const c_db,
+    ukv_txn_t const c_txn,
+    ukv_size_t const c_min_tasks_count,
+
+    ukv_col_t const* c_cols,
+    ukv_size_t const c_cols_stride,
+
+    ukv_key_t const* c_min_keys,
+    ukv_size_t const c_min_keys_stride,
+
+    ukv_size_t const* c_scan_lengths,
+    ukv_size_t const c_scan_lengths_stride,
+
+    ukv_options_t const c_options,
+
+    ukv_key_t** c_found_keys,
+    ukv_val_len_t** c_found_lengths,
+
+    ukv_arena_t* c_arena,
+    ukv_error_t* c_error) {
+
+    if (!c_db && (*c_error = "DataBase is NULL!"))
+        return;
+
+    stl_arena_t& arena = *cast_arena(c_arena, c_error);
+    if (*c_error)
+        return;
+
+    remote_db_t& db = *reinterpret_cast<remote_db_t*>(c_db);
+    strided_iterator_gt<ukv_col_t const> cols {c_cols, c_cols_stride};
+    strided_iterator_gt<ukv_key_t const> keys {c_min_keys, c_min_keys_stride};
+    strided_iterator_gt<ukv_size_t const> lens {c_scan_lengths, c_scan_lengths_stride};
+    rpc_reader_t response = remote_call(
+        db,
+        rpc_method_t::scan_k,
+        arena,
+        [&](rpc_writer_t& request) {
+            request.push(remote_txn_id(c_txn));
+            request.push(c_options);
+            request.push(c_min_tasks_count);
+            request.push_strided(cols, c_min_tasks_count);
+            request.push_strided(keys, c_min_tasks_count);
+            request.push_strided(lens, c_min_tasks_count);
+        },
+        c_error);
+    if (*c_error)
+        return;
+
+    ukv_size_t total_lengths = 0;
+    for (ukv_size_t i = 0; i != c_min_tasks_count; ++i)
+        total_lengths += lens[i];
+
+    std::uint8_t has_lengths = 0;
+    ukv_key_t const* found_keys = nullptr;
+    ukv_val_len_t const* found_lengths = nullptr;
+    bool is_valid = response.pop(has_lengths) && (found_keys = response.pop_array<ukv_key_t>(total_lengths)) &&
+                    (!has_lengths || (found_lengths = response.pop_array<ukv_val_len_t>(total_lengths)));
+    if (!is_valid && (*c_error = "Malformed remote response!"))
+        return;
+
+    *c_found_keys = const_cast<ukv_key_t*>(found_keys);
+    *c_found_lengths = const_cast<ukv_val_len_t*>(found_lengths);
+}
+
+void ukv_size( //
+    ukv_t const c_db,
+    ukv_txn_t const c_txn,
+    ukv_size_t const n,
+
+    ukv_col_t const* c_cols,
+    ukv_size_t const c_cols_stride,
+
+    ukv_key_t const* c_min_keys,
+    ukv_size_t const c_min_keys_stride,
+
+    ukv_key_t const* c_max_keys,
+    ukv_size_t const c_max_keys_stride,
+
+    ukv_options_t const c_options,
+
+    ukv_size_t** c_found_estimates,
+    ukv_arena_t* c_arena,
+    ukv_error_t* c_error) {
+
+    if (!c_db && (*c_error = "DataBase is NULL!"))
+        return;
+
+    stl_arena_t& arena = *cast_arena(c_arena, c_error);
+    if (*c_error)
+        return;
+
+    remote_db_t& db = *reinterpret_cast<remote_db_t*>(c_db);
+    strided_iterator_gt<ukv_col_t const> cols {c_cols, c_cols_stride};
+    strided_iterator_gt<ukv_key_t const> min_keys {c_min_keys, c_min_keys_stride};
+    strided_iterator_gt<ukv_key_t const> max_keys {c_max_keys, c_max_keys_stride};
+    rpc_reader_t response = remote_call(
+        db,
+        rpc_method_t::size_k,
+        arena,
+        [&](rpc_writer_t& request) {
+            request.push(remote_txn_id(c_txn));
+            request.push(c_options);
+            request.push(n);
+            request.push_strided(cols, n);
+            request.push_strided(min_keys, n);
+            request.push_strided(max_keys, n);
+        },
+        c_error);
+    if (*c_error)
+        return;
+
+    ukv_size_t const* estimates = response.pop_array<ukv_size_t>(n * 6);
+    if (!estimates && (*c_error = "Malformed remote response!"))
+        return;
+    *c_found_estimates = const_cast<ukv_size_t*>(estimates);
+}
+
+void ukv_remove_range( //
+    ukv_t const c_db,
+    ukv_size_t const n,
+
+    ukv_col_t const* c_cols,
+    ukv_size_t const c_cols_stride,
+
+    ukv_key_t const* c_min_keys,
+    ukv_size_t const c_min_keys_stride,
+
+    ukv_key_t const* c_max_keys,
+    ukv_size_t const c_max_keys_stride,
+
+    ukv_options_t const c_options,
+
+    ukv_arena_t*,
+    ukv_error_t* c_error) {
+
+    if (!c_db && (*c_error = "DataBase is NULL!"))
+        return;
+
+    remote_db_t& db = *reinterpret_cast<remote_db_t*>(c_db);
+    strided_iterator_gt<ukv_col_t const> cols {c_cols, c_cols_stride};
+    strided_iterator_gt<ukv_key_t const> min_keys {c_min_keys, c_min_keys_stride};
+    strided_iterator_gt<ukv_key_t const> max_keys {c_max_keys, c_max_keys_stride};
+    remote_call(
+        db,
+        rpc_method_t::remove_range_k,
+        remote_arena,
+        [&](rpc_writer_t& request) {
+            request.push(c_options);
+            request.push(n);
+            request.push_strided(cols, n);
+            request.push_strided(min_keys, n);
+            request.push_strided(max_keys, n);
+        },
+        c_error);
+}
+
+void ukv_changes_since( //
+    ukv_t const c_db,
+    ukv_col_t const c_col,
+    ukv_size_t const c_generation,
+    ukv_size_t const c_limit,
+
+    ukv_size_t* c_found_count,
+    ukv_key_t** c_found_keys,
+    ukv_size_t** c_found_generations,
+    ukv_val_len_t** c_found_lengths,
+    ukv_size_t* c_next_generation,
+
+    ukv_arena_t* c_arena,
+    ukv_error_t* c_error) {
+
+    if (!c_db && (*c_error = "DataBase is NULL!"))
+        return;
+
+    stl_arena_t& arena = *cast_arena(c_arena, c_error);
+    if (*c_error)
+        return;
+
+    remote_db_t& db = *reinterpret_cast<remote_db_t*>(c_db);
+    rpc_reader_t response = remote_call(
+        db,
+        rpc_method_t::changes_since_k,
+        arena,
+        [&](rpc_writer_t& request) {
+            request.push(c_col);
+            request.push(c_generation);
+            request.push(c_limit);
+        },
+        c_error);
+    if (*c_error)
+        return;
+
+    ukv_size_t count = 0;
+    ukv_size_t next_generation = 0;
+    ukv_key_t const* found_keys = nullptr;
+    ukv_size_t const* found_generations = nullptr;
+    ukv_val_len_t const* found_lengths = nullptr;
+    bool is_valid = response.pop(count) && response.pop(next_generation) &&
+                    (found_keys = response.pop_array<ukv_key_t>(count)) &&
+                    (found_generations = response.pop_array<ukv_size_t>(count)) &&
+                    (found_lengths = response.pop_array<ukv_val_len_t>(count));
+    if (!is_valid && (*c_error = "Malformed remote response!"))
+        return;
+
+    *c_found_count = count;
+    *c_found_keys = const_cast<ukv_key_t*>(found_keys);
+    *c_found_generations = const_cast<ukv_size_t*>(found_generations);
+    *c_found_lengths = const_cast<ukv_val_len_t*>(found_lengths);
+    *c_next_generation = next_generation;
+}
+
+/*********************************************************/
+/*****************	Collections Management	****************/
+/*********************************************************/
+
+void ukv_col_open(
+    // Inputs:
+    ukv_t const c_db,
+    ukv_str_view_t c_col_name,
+    ukv_str_view_t c_config,
+    // Outputs:
+    ukv_col_t* c_col,
+    ukv_error_t* c_error) {
+
+    if (!c_db && (*c_error = "DataBase is NULL!"))
+        return;
+
+    if (!c_col_name || !std::strlen(c_col_name)) {
+        *c_col = ukv_col_main_k;
+        return;
+    }
+
+    remote_db_t& db = *reinterpret_cast<remote_db_t*>(c_db);
+    rpc_reader_t response = remote_call(
+        db,
+        rpc_method_t::col_open_k,
+        remote_arena,
+        [&](rpc_writer_t& request) {
+            request.push_string(c_col_name);
+            request.push_string(c_config);
+        },
+        c_error);
+    if (*c_error)
+        return;
+    if (!response.pop(*c_col) && (*c_error = "Malformed remote response!"))
+        return;
+}
+
+void ukv_col_remove(
+    // Inputs:
+    ukv_t const c_db,
+    ukv_str_view_t c_col_name,
+    // Outputs:
+    ukv_error_t* c_error) {
+
+    if (!c_db && (*c_error = "DataBase is NULL!"))
+        return;
+
+    remote_db_t& db = *reinterpret_cast<remote_db_t*>(c_db);
+    remote_call(
+        db,
+        rpc_method_t::col_remove_k,
+        remote_arena,
+        [&](rpc_writer_t& request) { request.push_string(c_col_name); },
+        c_error);
+}
+
+void ukv_col_list( //
+    ukv_t const c_db,
+    ukv_size_t* c_count,
+    ukv_str_view_t* c_names,
+    ukv_arena_t* c_arena,
+    ukv_error_t* c_error) {
+
+    if (!c_db && (*c_error = "DataBase is NULL!"))
+        return;
+
+    stl_arena_t& arena = *cast_arena(c_arena, c_error);
+    if (*c_error)
+        return;
+
+    remote_db_t& db = *reinterpret_cast<remote_db_t*>(c_db);
+    rpc_reader_t response = remote_call(
+        db,
+        rpc_method_t::col_list_k,
+        arena,
+        [](rpc_writer_t&) {},
+        c_error);
+    if (*c_error)
+        return;
+
+    std::uint64_t length = 0;
+    char const* names = nullptr;
+    bool is_valid = response.pop(*c_count) && response.pop(length) && (names = response.pop_array<char>(length));
+    if (!is_valid && (*c_error = "Malformed remote response!"))
+        return;
+    *c_names = names;
+}
+
+void ukv_db_control( //
+    ukv_t const c_db,
+    ukv_str_view_t c_request,
+    ukv_str_view_t* c_response,
+    ukv_error_t* c_error) {
+
+    if (!c_db && (*c_error = "DataBase is NULL!"))
+        return;
+    if (!c_request && (*c_error = "Request is NULL!"))
+        return;
+
+    *c_response = NULL;
+    remote_db_t& db = *reinterpret_cast<remote_db_t*>(c_db);
+    rpc_reader_t response = remote_call(
+        db,
+        rpc_method_t::db_control_k,
+        remote_arena,
+        [&](rpc_writer_t& request) { request.push_string(c_request); },
+        c_error);
+    if (*c_error)
+        return;
+
+    thread_local std::string answer;
+    std::uint8_t has_answer = 0;
+    try {
+        if (!(response.pop(has_answer) && response.pop_string(answer)) &&
+            (*c_error = "Malformed remote response!"))
+            return;
+    }
+    catch (...) {
+        *c_error = "Failed to allocate memory!";
+        return;
+    }
+    *c_response = has_answer ? answer.c_str() : NULL;
+}
+
+/*********************************************************/
+/*****************		Transactions	  ****************/
+/*********************************************************/
+
+void ukv_txn_begin(
+    // Inputs:
+    ukv_t const c_db,
+    ukv_size_t const c_generation,
+    ukv_options_t const c_options,
+    // Outputs:
+    ukv_txn_t* c_txn,
+    ukv_error_t* c_error) {
+
+    if (!c_db && (*c_error = "DataBase is NULL!"))
+        return;
+
+    remote_db_t& db = *reinterpret_cast<remote_db_t*>(c_db);
+    std::unique_ptr<remote_txn_t> new_txn;
+    if (!*c_txn) {
+        try {
+            new_txn = std::make_unique<remote_txn_t>();
+            new_txn->db = &db;
+        }
+        catch (...) {
+            *c_error = "Failed to initialize the transaction";
+            return;
+        }
+    }
+
+    remote_txn_t& txn = new_txn ? *new_txn : *reinterpret_cast<remote_txn_t*>(*c_txn);
+    rpc_reader_t response = remote_call(
+        db,
+        rpc_method_t::txn_begin_k,
+        remote_arena,
+        [&](rpc_writer_t& request) {
+            request.push(txn.id);
+            request.push(c_options);
+            request.push(c_generation);
+        },
+        c_error);
+    if (*c_error)
+        return;
+    if (!response.pop(txn.id) && (*c_error = "Malformed remote response!"))
+        return;
+    if (new_txn)
+        *c_txn = new_txn.release();
+}
+
+void ukv_txn_commit( //
+    ukv_txn_t const c_txn,
+    ukv_options_t const c_options,
+    ukv_error_t* c_error) {
+
+    if (!c_txn && (*c_error = "Transaction is NULL!"))
+        return;
+
+    remote_txn_t& txn = *reinterpret_cast<remote_txn_t*>(c_txn);
+    remote_call(
+        *txn.db,
+        rpc_method_t::txn_commit_k,
+        remote_arena,
+        [&](rpc_writer_t& request) {
+            request.push(txn.id);
+            request.push(c_options);
+        },
+        c_error);
+}
+
+/*********************************************************/
+/*****************	  Memory Management   ****************/
+/*********************************************************/
+
+void ukv_arena_free(ukv_t const, ukv_arena_t c_arena) {
+    release_arena(c_arena);
+}
+
+ukv_size_t ukv_arena_allocations(ukv_t const, ukv_arena_t const c_arena) {
+    return arena_allocations(c_arena);
+}
+
+void ukv_txn_free(ukv_t const, ukv_txn_t const c_txn) {
+    if (!c_txn)
+        return;
+
+    // Failures are ignored, the server will release the transaction on shutdown
+    remote_txn_t& txn = *reinterpret_cast<remote_txn_t*>(c_txn);
+    ukv_error_t error = nullptr;
+    remote_call(
+        *txn.db,
+        rpc_method_t::txn_free_k,
+        remote_arena,
+        [&](rpc_writer_t& request) { request.push(txn.id); },
+        &error);
+    delete &txn;
+}
+
+void ukv_db_free(ukv_t c_db) {
+    if (!c_db)
+        return;
+    remote_db_t& db = *reinterpret_cast<remote_db_t*>(c_db);
+    delete &db;
+}
+
+void ukv_col_free(ukv_t const, ukv_col_t const) {
+    // Collection handles are owned by the server.
+}
+
+void ukv_error_free(ukv_error_t) {
+}
@@ -0,0 +1,222 @@
+/**
+ * @file rpc_protocol.hpp
+ * @author Ashot Vardanian
+ *
+ * @brief Binary framing shared by `rpc_client.cpp` and `rpc_server.cpp`.
+ *
+ * Every call of the C API becomes exactly one request frame and one response frame,
+ * regardless of the batch size. A frame is an `rpc_header_t` followed by the payload.
+ * Requests carry ids, echoed back by the server, so that many of them can be pipelined
+ * over the same connection. Responses come in the order of requests.
+ *
+ * Payloads are sequences of native little-endian scalars and arrays. Arrays start at
+ * offsets aligned to 8 bytes from the beginning of the payload, so the receiver can
+ * address them in place, without copies. Strided inputs are gathered into arrays,
+ * and inputs with zero stride are sent as a single element, @see `rpc_strided_k`.
+ * If the call fails, the response is flagged and its payload is the error message.
+ */
+#pragma once
+#include <cstdint>     // `std::uint32_t`
+#include <cstring>     // `std::memcpy`
+#include <string_view> // `std::string_view`
+
+#include "helpers.hpp"
+
+namespace unum::ukv {
+
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "The RPC protocol expects little-endian hosts");
+
+static constexpr std::uint16_t rpc_default_port_k = 38710;
+/// Frames larger than that are treated as corrupted streams.
+static constexpr std::uint64_t rpc_max_payload_k = 1ull << 36;
+static constexpr std::size_t rpc_alignment_k = 8;
+
+enum class rpc_method_t : std::uint8_t {
+    read_k = 1,
+    write_k,
+    bulk_load_k,
+    scan_k,
+    size_k,
+    col_open_k,
+    col_list_k,
+    col_remove_k,
+    db_control_k,
+    txn_begin_k,
+    txn_commit_k,
+    txn_free_k,
+    remove_range_k,
+    changes_since_k,
+};
+
+struct rpc_header_t {
+    std::uint64_t length = 0;
+    std::uint32_t request_id = 0;
+    rpc_method_t method = rpc_method_t::read_k;
+    std::uint8_t failed = 0;
+    std::uint16_t reserved = 0;
+};
+
+static_assert(sizeof(rpc_header_t) == 16, "Headers must remain packed");
+
+/**
+ * @brief How strided arguments are serialized:
+ * > `rpc_missing_k`: NULL argument, the default value applies to all tasks.
+ * > `rpc_repeated_k`: Zero stride, the single element applies to all tasks.
+ * > `rpc_strided_k`: One element per task.
+ */
+enum rpc_layout_t : std::uint8_t {
+    rpc_missing_k = 0,
+    rpc_repeated_k = 1,
+    rpc_strided_k = 2,
+};
+
+/**
+ * @brief Appends scalars and aligned arrays to a payload.
+ * Reserves the space for the header, which is filled by `finish`.
+ */
+class rpc_writer_t {
+    buffer_t& buffer_;
+
+  public:
+    rpc_writer_t(buffer_t& buffer) noexcept : buffer_(buffer) {}
+
+    void start() {
+        buffer_.resize(sizeof(rpc_header_t));
+        std::memset(buffer_.data(), 0, sizeof(rpc_header_t));
+    }
+
+    void finish(rpc_method_t method, std::uint32_t request_id, bool failed = false) noexcept {
+        rpc_header_t header;
+        header.length = buffer_.size() - sizeof(rpc_header_t);
+        header.request_id = request_id;
+        header.method = method;
+        header.failed = failed;
+        std::memcpy(buffer_.data(), &header, sizeof(header));
+    }
+
+    void append(void const* begin, std::size_t length) {
+        auto bytes = reinterpret_cast<byte_t const*>(begin);
+        buffer_.insert(buffer_.end(), bytes, bytes + length);
+    }
+
+    void align() {
+        std::size_t payload = buffer_.size() - sizeof(rpc_header_t);
+        buffer_.resize(buffer_.size() + (rpc_alignment_k - payload % rpc_alignment_k) % rpc_alignment_k);
+    }
+
+    template <typename scalar_at>
+    void push(scalar_at value) {
+        append(&value, sizeof(value));
+    }
+
+    template <typename element_at>
+    element_at* push_array(std::size_t count) {
+        align();
+        std::size_t offset = buffer_.size();
+        buffer_.resize(offset + count * sizeof(element_at));
+        return reinterpret_cast<element_at*>(buffer_.data() + offset);
+    }
+
+    template <typename element_at>
+    void push_array(element_at const* begin, std::size_t count) {
+        align();
+        append(begin, count * sizeof(element_at));
+    }
+
+    /// Serializes a strided argument according to `rpc_layout_t`.
+    template <typename element_at>
+    void push_strided(strided_iterator_gt<element_at const> elements, std::size_t count) {
+        if (!elements) {
+            push(rpc_missing_k);
+            return;
+        }
+        if (elements.repeats()) {
+            push(rpc_repeated_k);
+            push_array(elements.get(), 1);
+            return;
+        }
+        push(rpc_strided_k);
+        if (elements.stride() == sizeof(element_at)) {
+            push_array(elements.get(), count);
+            return;
+        }
+        element_at* gathered = push_array<element_at>(count);
+        for (std::size_t i = 0; i != count; ++i)
+            gathered[i] = elements[i];
+    }
+
+    void push_string(ukv_str_view_t str) {
+        std::size_t length = str ? std::strlen(str) : 0;
+        push(static_cast<std::uint64_t>(length));
+        append(str, length);
+    }
+};
+
+/**
+ * @brief Parses payloads produced by `rpc_writer_t` without copying the arrays.
+ * All getters return `false` or NULL once the payload is exhausted.
+ */
+class rpc_reader_t {
+    byte_t const* begin_ = nullptr;
+    byte_t const* ptr_ = nullptr;
+    byte_t const* end_ = nullptr;
+
+  public:
+    rpc_reader_t(byte_t const* begin, std::size_t length) noexcept
+        : begin_(begin), ptr_(begin), end_(begin + length) {}
+
+    template <typename scalar_at>
+    bool pop(scalar_at& value) noexcept {
+        if (static_cast<std::size_t>(end_ - ptr_) < sizeof(value))
+            return false;
+        std::memcpy(&value, ptr_, sizeof(value));
+        ptr_ += sizeof(value);
+        return true;
+    }
+
+    template <typename element_at>
+    element_at const* pop_array(std::size_t count) noexcept {
+        std::size_t offset = static_cast<std::size_t>(ptr_ - begin_);
+        std::size_t padding = (rpc_alignment_k - offset % rpc_alignment_k) % rpc_alignment_k;
+        if (static_cast<std::size_t>(end_ - ptr_) < padding)
+            return nullptr;
+        ptr_ += padding;
+        if (count > static_cast<std::size_t>(end_ - ptr_) / sizeof(element_at))
+            return nullptr;
+        auto result = reinterpret_cast<element_at const*>(ptr_);
+        ptr_ += count * sizeof(element_at);
+        return result;
+    }
+
+    /**
+     * @brief Restores a strided argument, serialized by `rpc_writer_t::push_strided`.
+     * @return `false` if the payload is malformed.
+     */
+    template <typename element_at>
+    bool pop_strided(std::size_t count, strided_iterator_gt<element_at const>& elements) noexcept {
+        std::uint8_t layout = rpc_missing_k;
+        if (!pop(layout))
+            return false;
+        if (layout == rpc_missing_k) {
+            elements = {};
+            return true;
+        }
+        if (layout != rpc_repeated_k && layout != rpc_strided_k)
+            return false;
+        element_at const* begin = pop_array<element_at>(layout == rpc_repeated_k ? 1 : count);
+        elements = {begin, layout == rpc_repeated_k ? 0 : sizeof(element_at)};
+        return begin != nullptr;
+    }
+
+    /// Strings aren't NULL-terminated on the wire, so they are copied out.
+    bool pop_string(std::string& str) {
+        std::uint64_t length = 0;
+        if (!pop(length) || length > static_cast<std::size_t>(end_ - ptr_))
+            return false;
+        str.assign(reinterpret_cast<char const*>(ptr_), length);
+        ptr_ += length;
+        return true;
+    }
+};
+
+} // namespace unum::ukv
@@ -0,0 +1,791 @@
+/**
+ * @file rpc_server.cpp
+ * @author Ashot Vardanian
+ * @date 2022-08-02
+ *
+ * @brief Exposes any UKV backend to `rpc_client.cpp` over persistent TCP connections.
+ *
+ * Every connection is served by a chain of asynchronous reads and writes on its own
+ * strand, so many connections share a small pool of threads. Clients may pipeline
+ * requests, which are executed in order. Every frame is a whole batch, passed to the
+ * underlying C API without unpacking, @see `rpc_protocol.hpp`.
+ *
+ * Transactions are addressed by ids and are shared by all connections, so that a client
+ * can use any connection from its pool for any transaction.
+ *
+ * In the NUMA mode, every node gets its own pool of pinned threads, and the batches are
+ * executed on the node, that owns their first collection, @see "numa.hpp".
+ */
+
+#include <cctype> // `std::isdigit`
+#include <mutex>
+#include <shared_mutex>
+#include <algorithm>
+#include <thread>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iostream>
+#include <unordered_map>
+
+#include <boost/asio.hpp>
+
+#include "ukv/ukv.hpp"
+#include "rpc_protocol.hpp"
+#include "numa.hpp"
+
+using namespace unum::ukv;
+using namespace unum;
+
+namespace net = boost::asio;
+using tcp = boost::asio::ip::tcp;
+
+/*********************************************************/
+/*****************	      Server State	  ****************/
+/*********************************************************/
+
+struct rpc_server_t {
+    db_t db;
+    std::mutex txns_mutex;
+    std::unordered_map<std::uint64_t, ukv_txn_t> txns;
+    std::uint64_t last_txn_id = 0;
+
+    ~rpc_server_t() {
+        for (auto& id_and_txn : txns)
+            ukv_txn_free(db, id_and_txn.second);
+    }
+
+    /// Thread pools of every NUMA node, empty if requests aren't routed.
+    std::vector<net::io_context*> numa_contexts;
+    /// Cached answers of the "numa_node:" control requests.
+    std::shared_mutex homes_mutex;
+    std::unordered_map<ukv_col_t, std::size_t> homes;
+
+    /// Node owning the collection, or `numa_any_k`, if the backend doesn't home it.
+    std::size_t home_of(ukv_col_t col) {
+        {
+            std::shared_lock _ {homes_mutex};
+            auto it = homes.find(col);
+            if (it != homes.end())
+                return it->second;
+        }
+
+        status_t status;
+        ukv_str_view_t answer = nullptr;
+        auto request = "numa_node:" + std::to_string(col);
+        ukv_db_control(db, request.c_str(), &answer, status.member_ptr());
+        std::size_t node = numa_any_k;
+        if (status && answer && std::isdigit(*answer))
+            node = std::strtoull(answer, nullptr, 10);
+
+        std::unique_lock _ {homes_mutex};
+        homes.emplace(col, node);
+        return node;
+    }
+
+    /// Must be called, whenever collections are opened or removed.
+    void forget_homes() {
+        std::unique_lock _ {homes_mutex};
+        homes.clear();
+    }
+
+    ukv_txn_t find_txn(std::uint64_t id, ukv_error_t* c_error) {
+        if (!id)
+            return nullptr;
+        std::lock_guard _ {txns_mutex};
+        auto it = txns.find(id);
+        if (it == txns.end() && (*c_error = "Unknown transaction!"))
+            return nullptr;
+        return it->second;
+    }
+};
+
+void log_failure(boost::system::error_code ec, char const* what) {
+    std::cerr << what << ": " << ec.message() << "\n";
+}
+
+/*********************************************************/
+/*****************	     Request Handlers	  ****************/
+/*********************************************************/
+
+/**
+ * @brief Memory reused between the requests of a single connection.
+ */
+struct rpc_buffers_t {
+    std::vector<ukv_val_ptr_t> values;
+    std::vector<ukv_val_len_t> offsets;
+    std::string name;
+    std::string config;
+};
+
+void serve_read(rpc_server_t& server,
+                rpc_reader_t& request,
+                rpc_writer_t& response,
+                arena_t& arena,
+                ukv_error_t* c_error) {
+    std::uint64_t txn_id = 0;
+    ukv_options_t options = ukv_options_default_k;
+    ukv_size_t count = 0;
+    strided_iterator_gt<ukv_col_t const> cols;
+    strided_iterator_gt<ukv_key_t const> keys;
+    if (!(request.pop(txn_id) && request.pop(options) && request.pop(count) &&
+          request.pop_strided(count, cols) && request.pop_strided(count, keys) && (keys || !count)) &&
+        (*c_error = "Malformed read request!"))
+        return;
+
+    ukv_txn_t txn = server.find_txn(txn_id, c_error);
+    if (*c_error)
+        return;
+
+    ukv_val_ptr_t found_values = nullptr;
+    ukv_val_len_t* found_offsets = nullptr;
+    ukv_val_len_t* found_lengths = nullptr;
+    ukv_read(server.db,
+             txn,
+             count,
+             cols.get(),
+             cols.stride(),
+             keys.get(),
+             keys.stride(),
+             options,
+             &found_values,
+             &found_offsets,
+             &found_lengths,
+             arena,
+             c_error);
+    if (*c_error)
+        return;
+
+    // Values are sent as a single region, addressed by the original offsets
+    bool has_values = found_values && found_offsets;
+    std::size_t tape_length = 0;
+    if (has_values)
+        for (ukv_size_t i = 0; i != count; ++i)
+            if (found_lengths[i] != ukv_val_len_missing_k)
+                tape_length = std::max<std::size_t>(tape_length, found_offsets[i] + found_lengths[i]);
+
+    response.push(static_cast<std::uint8_t>(has_values));
+    response.push_array(found_lengths, count);
+    if (has_values)
+        response.push_array(found_offsets, count);
+    response.push(static_cast<std::uint64_t>(tape_length));
+    response.push_array(found_values, tape_length);
+}
+
+void serve_write(rpc_server_t& server,
+                 rpc_method_t method,
+                 rpc_reader_t& request,
+                 arena_t& arena,
+                 rpc_buffers_t& buffers,
+                 ukv_error_t* c_error) {
+    std::uint64_t txn_id = 0;
+    ukv_options_t options = ukv_options_default_k;
+    ukv_size_t count = 0;
+    strided_iterator_gt<ukv_col_t const> cols;
+    strided_iterator_gt<ukv_key_t const> keys;
+    std::uint8_t has_values = 0;
+    if (!(request.pop(txn_id) && request.pop(options) && request.pop(count) &&
+          request.pop_strided(count, cols) && request.pop_strided(count, keys) && (keys || !count) &&
+          request.pop(has_values)) &&
+        (*c_error = "Malformed write request!"))
+        return;
+
+    // Deleted entries are marked with missing lengths
+    ukv_val_len_t const* lengths = nullptr;
+    std::uint64_t tape_length = 0;
+    byte_t const* tape = nullptr;
+    if (has_values) {
+        lengths = request.pop_array<ukv_val_len_t>(count);
+        if (!(lengths && request.pop(tape_length) && (tape = request.pop_array<byte_t>(tape_length))) &&
+            (*c_error = "Malformed write request!"))
+            return;
+
+        try {
+            buffers.values.resize(count);
+            buffers.offsets.resize(count);
+        }
+        catch (...) {
+            *c_error = "Failed to allocate memory!";
+            return;
+        }
+
+        std::uint64_t progress = 0;
+        auto contents = reinterpret_cast<ukv_val_ptr_t>(const_cast<byte_t*>(tape));
+        for (ukv_size_t i = 0; i != count; ++i) {
+            bool is_deleted = lengths[i] == ukv_val_len_missing_k;
+            buffers.values[i] = is_deleted ? nullptr : contents;
+            buffers.offsets[i] = static_cast<ukv_val_len_t>(progress);
+            progress += is_deleted ? 0 : lengths[i];
+        }
+        if (progress != tape_length && (*c_error = "Malformed write request!"))
+            return;
+    }
+
+    if (method == rpc_method_t::bulk_load_k)
+        ukv_bulk_load(server.db,
+                      count,
+                      cols.get(),
+                      cols.stride(),
+                      keys.get(),
+                      keys.stride(),
+                      has_values ? buffers.values.data() : nullptr,
+                      sizeof(ukv_val_ptr_t),
+                      buffers.offsets.data(),
+                      sizeof(ukv_val_len_t),
+                      lengths,
+                      sizeof(ukv_val_len_t),
+                      options,
+                      arena,
+                      c_error);
+    else {
+        ukv_txn_t txn = server.find_txn(txn_id, c_error);
+        if (*c_error)
+            return;
+        ukv_write(server.db,
+                  txn,
+                  count,
+                  cols.get(),
+                  cols.stride(),
+                  keys.get(),
+                  keys.stride(),
+                  has_values ? buffers.values.data() : nullptr,
+                  sizeof(ukv_val_ptr_t),
+                  buffers.offsets.data(),
+                  sizeof(ukv_val_len_t),
+                  lengths,
+                  sizeof(ukv_val_len_t),
+                  options,
+                  arena,
+                  c_error);
+    }
+}
+
+void serve_scan(rpc_server_t& server,
+                rpc_reader_t& request,
+                rpc_writer_t& response,
+                arena_t& arena,
+                ukv_error_t* c_error) {
+    std::uint64_t txn_id = 0;
+    ukv_options_t options = ukv_options_default_k;
+    ukv_size_t count = 0;
+    strided_iterator_gt<ukv_col_t const> cols;
+    strided_iterator_gt<ukv_key_t const> min_keys;
+    strided_iterator_gt<ukv_size_t const> lengths;
+    if (!(request.pop(txn_id) && request.pop(options) && request.pop(count) &&
+          request.pop_strided(count, cols) && request.pop_strided(count, min_keys) && (min_keys || !count) &&
+          request.pop_strided(count, lengths) && (lengths || !count)) &&
+        (*c_error = "Malformed scan request!"))
+        return;
+
+    ukv_txn_t txn = server.find_txn(txn_id, c_error);
+    if (*c_error)
+        return;
+
+    ukv_key_t* found_keys = nullptr;
+    ukv_val_len_t* found_lengths = nullptr;
+    ukv_scan(server.db,
+             txn,
+             count,
+             cols.get(),
+             cols.stride(),
+             min_keys.get(),
+             min_keys.stride(),
+             lengths.get(),
+             lengths.stride(),
+             options,
+             &found_keys,
+             &found_lengths,
+             arena,
+             c_error);
+    if (*c_error)
+        return;
+
+    ukv_size_t total = 0;
+    for (ukv_size_t i = 0; i != count; ++i)
+        total += lengths[i];
+    response.push(static_cast<std::uint8_t>(found_lengths != nullptr));
+    response.push_array(found_keys, total);
+    if (found_lengths)
+        response.push_array(found_lengths, total);
+}
+
+void serve_size(rpc_server_t& server,
+                rpc_reader_t& request,
+                rpc_writer_t& response,
+                arena_t& arena,
+                ukv_error_t* c_error) {
+    std::uint64_t txn_id = 0;
+    ukv_options_t options = ukv_options_default_k;
+    ukv_size_t count = 0;
+    strided_iterator_gt<ukv_col_t const> cols;
+    strided_iterator_gt<ukv_key_t const> min_keys;
+    strided_iterator_gt<ukv_key_t const> max_keys;
+    if (!(request.pop(txn_id) && request.pop(options) && request.pop(count) &&
+          request.pop_strided(count, cols) && request.pop_strided(count, min_keys) && (min_keys || !count) &&
+          request.pop_strided(count, max_keys) && (max_keys || !count)) &&
+        (*c_error = "Malformed size request!"))
+        return;
+
+    ukv_txn_t txn = server.find_txn(txn_id, c_error);
+    if (*c_error)
+        return;
+
+    ukv_size_t* estimates = nullptr;
+    ukv_size(server.db,
+             txn,
+             count,
+             cols.get(),
+             cols.stride(),
+             min_keys.get(),
+             min_keys.stride(),
+             max_keys.get(),
+             max_keys.stride(),
+             options,
+             &estimates,
+             arena,
+             c_error);
+    if (*c_error)
+        return;
+    response.push_array(estimates, count * 6);
+}
+
+void serve_changes_since(rpc_server_t& server,
+                         rpc_reader_t& request,
+                         rpc_writer_t& response,
+                         arena_t& arena,
+                         ukv_error_t* c_error) {
+    ukv_col_t col = ukv_col_main_k;
+    ukv_size_t generation = 0;
+    ukv_size_t limit = 0;
+    if (!(request.pop(col) && request.pop(generation) && request.pop(limit)) &&
+        (*c_error = "Malformed changes request!"))
+        return;
+
+    ukv_size_t count = 0;
+    ukv_key_t* found_keys = nullptr;
+    ukv_size_t* found_generations = nullptr;
+    ukv_val_len_t* found_lengths = nullptr;
+    ukv_size_t next_generation = 0;
+    ukv_changes_since(server.db,
+                      col,
+                      generation,
+                      limit,
+                      &count,
+                      &found_keys,
+                      &found_generations,
+                      &found_lengths,
+                      &next_generation,
+                      arena,
+                      c_error);
+    if (*c_error)
+        return;
+    response.push(count);
+    response.push(next_generation);
+    response.push_array(found_keys, count);
+    response.push_array(found_generations, count);
+    response.push_array(found_lengths, count);
+}
+
+void serve_remove_range(rpc_server_t& server, rpc_reader_t& request, arena_t& arena, ukv_error_t* c_error) {
+    ukv_options_t options = ukv_options_default_k;
+    ukv_size_t count = 0;
+    strided_iterator_gt<ukv_col_t const> cols;
+    strided_iterator_gt<ukv_key_t const> min_keys;
+    strided_iterator_gt<ukv_key_t const> max_keys;
+    if (!(request.pop(options) && request.pop(count) && request.pop_strided(count, cols) &&
+          request.pop_strided(count, min_keys) && (min_keys || !count) && request.pop_strided(count, max_keys) &&
+          (max_keys || !count)) &&
+        (*c_error = "Malformed range removal request!"))
+        return;
+
+    ukv_remove_range(server.db,
+                     count,
+                     cols.get(),
+                     cols.stride(),
+                     min_keys.get(),
+                     min_keys.stride(),
+                     max_keys.get(),
+                     max_keys.stride(),
+                     options,
+                     arena,
+                     c_error);
+}
+
+void serve_txn(rpc_server_t& server,
+               rpc_method_t method,
+               rpc_reader_t& request,
+               rpc_writer_t& response,
+               ukv_error_t* c_error) {
+    std::uint64_t txn_id = 0;
+    if (!request.pop(txn_id) && (*c_error = "Malformed transaction request!"))
+        return;
+
+    if (method == rpc_method_t::txn_free_k) {
+        std::lock_guard _ {server.txns_mutex};
+        auto it = server.txns.find(txn_id);
+        if (it == server.txns.end())
+            return;
+        ukv_txn_free(server.db, it->second);
+        server.txns.erase(it);
+        return;
+    }
+
+    ukv_options_t options = ukv_options_default_k;
+    if (!request.pop(options) && (*c_error = "Malformed transaction request!"))
+        return;
+
+    if (method == rpc_method_t::txn_commit_k) {
+        ukv_txn_t txn = server.find_txn(txn_id, c_error);
+        if (!*c_error)
+            ukv_txn_commit(txn, options, c_error);
+        return;
+    }
+
+    // Restarting an existing transaction reuses its memory
+    ukv_size_t generation = 0;
+    if (!request.pop(generation) && (*c_error = "Malformed transaction request!"))
+        return;
+    ukv_txn_t txn = server.find_txn(txn_id, c_error);
+    if (*c_error)
+        return;
+    ukv_txn_begin(server.db, generation, options, &txn, c_error);
+    if (*c_error || txn_id) {
+        response.push(txn_id);
+        return;
+    }
+
+    try {
+        std::lock_guard _ {server.txns_mutex};
+        txn_id = ++server.last_txn_id;
+        server.txns.emplace(txn_id, txn);
+        response.push(txn_id);
+    }
+    catch (...) {
+        ukv_txn_free(server.db, txn);
+        *c_error = "Failed to allocate memory!";
+    }
+}
+
+void serve_col(rpc_server_t& server,
+               rpc_method_t method,
+               rpc_reader_t& request,
+               rpc_writer_t& response,
+               arena_t& arena,
+               rpc_buffers_t& buffers,
+               ukv_error_t* c_error) {
+
+    if (method == rpc_method_t::col_list_k) {
+        ukv_size_t count = 0;
+        ukv_str_view_t names = nullptr;
+        ukv_col_list(server.db, &count, &names, arena, c_error);
+        if (*c_error)
+            return;
+        std::size_t length = 0;
+        for (ukv_size_t i = 0; i != count; ++i)
+            length += std::strlen(names + length) + 1;
+        response.push(count);
+        response.push(static_cast<std::uint64_t>(length));
+        response.push_array(names, length);
+        return;
+    }
+
+    if (!request.pop_string(buffers.name) && (*c_error = "Malformed collection request!"))
+        return;
+
+    if (method == rpc_method_t::col_remove_k) {
+        server.forget_homes();
+        return ukv_col_remove(server.db, buffers.name.c_str(), c_error);
+    }
+
+    if (method == rpc_method_t::db_control_k) {
+        ukv_str_view_t answer = nullptr;
+        ukv_db_control(server.db, buffers.name.c_str(), &answer, c_error);
+        if (*c_error)
+            return;
+        response.push(static_cast<std::uint8_t>(answer != nullptr));
+        response.push_string(answer);
+        return;
+    }
+
+    if (!request.pop_string(buffers.config) && (*c_error = "Malformed collection request!"))
+        return;
+    ukv_col_t col = ukv_col_main_k;
+    ukv_col_open(server.db, buffers.name.c_str(), buffers.config.c_str(), &col, c_error);
+    server.forget_homes();
+    if (!*c_error)
+        response.push(col);
+}
+
+/**
+ * @brief Peeks the first collection of the batch, without consuming the @p request.
+ * Reads, writes, scans and size estimates all start with the same fields.
+ */
+ukv_col_t first_col(rpc_method_t method, rpc_reader_t request) noexcept {
+    switch (method) {
+    case rpc_method_t::read_k:
+    case rpc_method_t::write_k:
+    case rpc_method_t::bulk_load_k:
+    case rpc_method_t::scan_k:
+    case rpc_method_t::size_k: break;
+    default: return ukv_col_main_k;
+    }
+
+    std::uint64_t txn_id = 0;
+    ukv_options_t options = ukv_options_default_k;
+    ukv_size_t count = 0;
+    strided_iterator_gt<ukv_col_t const> cols;
+    if (!(request.pop(txn_id) && request.pop(options) && request.pop(count) && request.pop_strided(count, cols)))
+        return ukv_col_main_k;
+    return cols && count ? cols[0] : ukv_col_main_k;
+}
+
+/*********************************************************/
+/*****************	       Sessions	      ****************/
+/*********************************************************/
+
+/**
+ * @brief Serves a single client connection: reads a frame, executes it
+ * and writes the response, before reading the next one.
+ */
+class rpc_session_t : public std::enable_shared_from_this<rpc_session_t> {
+    tcp::socket socket_;
+    std::shared_ptr<rpc_server_t> server_;
+    arena_t arena_;
+    rpc_header_t header_;
+    buffer_t request_;
+    buffer_t response_;
+    rpc_buffers_t buffers_;
+
+  public:
+    rpc_session_t(tcp::socket&& socket, std::shared_ptr<rpc_server_t> const& server)
+        : socket_(std::move(socket)), server_(server), arena_(server->db) {}
+
+    void run() {
+        boost::system::error_code ec;
+        socket_.set_option(tcp::no_delay(true), ec);
+        read_header();
+    }
+
+  private:
+    void read_header() {
+        net::async_read(socket_,
+                        net::buffer(&header_, sizeof(header_)),
+                        [self = shared_from_this()](boost::system::error_code ec, std::size_t) {
+                            if (ec)
+                                return ec != net::error::eof ? log_failure(ec, "read") : void();
+                            self->read_payload();
+                        });
+    }
+
+    void read_payload() {
+        if (header_.length > rpc_max_payload_k)
+            return log_failure(boost::system::errc::make_error_code(boost::system::errc::message_size), "read");
+
+        request_.resize(header_.length);
+        net::async_read(socket_,
+                        net::buffer(request_.data(), request_.size()),
+                        [self = shared_from_this()](boost::system::error_code ec, std::size_t) {
+                            if (ec)
+                                return log_failure(ec, "read");
+                            self->execute();
+                        });
+    }
+
+    /// Moves the execution to a thread of the node, owning the data, if it isn't the current one.
+    void execute() {
+        rpc_server_t& server = *server_;
+        if (server.numa_contexts.size() > 1) {
+            ukv_col_t col = first_col(header_.method, {request_.data(), request_.size()});
+            std::size_t home = server.home_of(col);
+            if (home < server.numa_contexts.size() && home != numa_current_node()) {
+                net::post(*server.numa_contexts[home], [self = shared_from_this()] { self->serve(); });
+                return;
+            }
+        }
+        serve();
+    }
+
+    void serve() {
+        rpc_server_t& server = *server_;
+        rpc_reader_t request {request_.data(), request_.size()};
+        rpc_writer_t response {response_};
+        ukv_error_t error = nullptr;
+        rpc_method_t method = header_.method;
+
+        try {
+            response.start();
+            switch (method) {
+            case rpc_method_t::read_k: serve_read(server, request, response, arena_, &error); break;
+            case rpc_method_t::write_k:
+            case rpc_method_t::bulk_load_k:
+                serve_write(server, method, request, arena_, buffers_, &error);
+                break;
+            case rpc_method_t::scan_k: serve_scan(server, request, response, arena_, &error); break;
+            case rpc_method_t::size_k: serve_size(server, request, response, arena_, &error); break;
+            case rpc_method_t::remove_range_k: serve_remove_range(server, request, arena_, &error); break;
+            case rpc_method_t::changes_since_k: serve_changes_since(server, request, response, arena_, &error); break;
+            case rpc_method_t::col_open_k:
+            case rpc_method_t::col_list_k:
+            case rpc_method_t::col_remove_k:
+            case rpc_method_t::db_control_k:
+                serve_col(server, method, request, response, arena_, buffers_, &error);
+                break;
+            case rpc_method_t::txn_begin_k:
+            case rpc_method_t::txn_commit_k:
+            case rpc_method_t::txn_free_k: serve_txn(server, method, request, response, &error); break;
+            default: error = "Unknown RPC method!"; break;
+            }
+
+            // Partial responses are discarded, only the message is sent
+            if (error) {
+                response.start();
+                response.append(error, std::strlen(error));
+                ukv_error_free(error);
+            }
+            response.finish(method, header_.request_id, error != nullptr);
+        }
+        catch (std::bad_alloc const&) {
+            return log_failure(boost::system::errc::make_error_code(boost::system::errc::not_enough_memory), "execute");
+        }
+
+        net::async_write(socket_,
+                         net::buffer(response_.data(), response_.size()),
+                         [self = shared_from_this()](boost::system::error_code ec, std::size_t) {
+                             if (ec)
+                                 return log_failure(ec, "write");
+                             self->read_header();
+                         });
+    }
+};
+
+class listener_t : public std::enable_shared_from_this<listener_t> {
+    /// Connections are spread across the pools of all the NUMA nodes.
+    std::vector<net::io_context*> io_contexts_;
+    std::size_t next_context_ = 0;
+    tcp::acceptor acceptor_;
+    std::shared_ptr<rpc_server_t> server_;
+
+  public:
+    listener_t(std::vector<net::io_context*> io_contexts,
+               tcp::endpoint endpoint,
+               std::shared_ptr<rpc_server_t> const& server)
+        : io_contexts_(std::move(io_contexts)), acceptor_(net::make_strand(*io_contexts_.front())), server_(server) {
+        connect_to(endpoint);
+    }
+
+    // Start accepting incoming connections
+    void run() { do_accept(); }
+
+  private:
+    void do_accept() {
+        // The new connection gets its own strand
+        net::io_context& io_context = *io_contexts_[next_context_++ % io_contexts_.size()];
+        acceptor_.async_accept(net::make_strand(io_context),
+                               [self = shared_from_this()](boost::system::error_code ec, tcp::socket socket) {
+                                   self->on_accept(ec, std::move(socket));
+                               });
+    }
+
+    void on_accept(boost::system::error_code ec, tcp::socket socket) {
+        if (ec)
+            // To avoid infinite loop
+            return log_failure(ec, "accept");
+
+        std::make_shared<rpc_session_t>(std::move(socket), server_)->run();
+        do_accept();
+    }
+
+    void connect_to(tcp::endpoint endpoint) {
+        boost::system::error_code ec;
+
+        acceptor_.open(endpoint.protocol(), ec);
+        if (ec)
+            return log_failure(ec, "open");
+
+        acceptor_.set_option(net::socket_base::reuse_address(true), ec);
+        if (ec)
+            return log_failure(ec, "set_option");
+
+        acceptor_.bind(endpoint, ec);
+        if (ec)
+            return log_failure(ec, "bind");
+
+        acceptor_.listen(net::socket_base::max_listen_connections, ec);
+        if (ec)
+            return log_failure(ec, "listen");
+    }
+};
+
+//------------------------------------------------------------------------------
+
+int main(int argc, char* argv[]) {
+
+    // Check command line arguments
+    if (argc < 4) {
+        std::cerr << "Usage: ukv_rpc_server <address> <port> <threads> <db_config_path>? numa?\n"
+                  << "Example:\n"
+                  << "    ukv_rpc_server 0.0.0.0 38710 1\n"
+                  << "    ukv_rpc_server 0.0.0.0 38710 1 ./config.json\n"
+                  << "    ukv_rpc_server 0.0.0.0 38710 32 ./config.json numa\n"
+                  << "";
+        return EXIT_FAILURE;
+    }
+
+    // Parse the arguments
+    auto const address = net::ip::make_address(argv[1]);
+    auto const port = static_cast<unsigned short>(std::atoi(argv[2]));
+    auto const threads = std::max<int>(1, std::atoi(argv[3]));
+    auto db_config = std::string();
+
+    // Read the configuration file
+    if (argc >= 5) {
+        auto const db_config_path = std::string(argv[4]);
+        if (!db_config_path.empty()) {
+            std::ifstream ifs(db_config_path);
+            db_config = std::string(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+        }
+    }
+
+    // Check if we can initialize the DB
+    auto server = std::make_shared<rpc_server_t>();
+    status_t status = server->db.open(db_config);
+    if (!status) {
+        std::cerr << "Couldn't initialize DB: " << status.release_exception().what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // In the NUMA mode, threads are split evenly between the nodes and pinned to them
+    bool const numa = argc >= 6 && std::string_view(argv[5]) == "numa";
+    std::size_t const threads_count = static_cast<std::size_t>(threads);
+    std::size_t const nodes = numa ? std::min(numa_topology_t::host().size(), threads_count) : 1;
+    std::vector<std::unique_ptr<net::io_context>> io_contexts;
+    std::vector<net::io_context*> io_contexts_ptrs;
+    for (std::size_t node = 0; node != nodes; ++node) {
+        auto const node_threads = threads_count / nodes + (node < threads_count % nodes);
+        io_contexts.push_back(std::make_unique<net::io_context>(static_cast<int>(node_threads)));
+        io_contexts_ptrs.push_back(io_contexts.back().get());
+    }
+
+    // Pools of other nodes may have no connections yet, but must keep running
+    std::vector<net::executor_work_guard<net::io_context::executor_type>> guards;
+    for (auto& io_context : io_contexts)
+        guards.push_back(net::make_work_guard(*io_context));
+    if (nodes > 1)
+        server->numa_contexts = io_contexts_ptrs;
+
+    // Create and launch a listening port
+    std::make_shared<listener_t>(io_contexts_ptrs, tcp::endpoint {address, port}, server)->run();
+
+    // Run the I/O service on the requested number of threads
+    auto run = [&io_contexts, nodes](std::size_t node) {
+        if (nodes > 1)
+            numa_pin_thread(node);
+        io_contexts[node]->run();
+    };
+    std::vector<std::thread> v;
+    v.reserve(threads - 1);
+    for (auto i = threads - 1; i > 0; --i)
+        v.emplace_back(run, static_cast<std::size_t>(i) % nodes);
+    run(0);
+    return EXIT_SUCCESS;
+}
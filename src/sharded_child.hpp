@@ -0,0 +1,59 @@
+/**
+ * @file sharded_child.hpp
+ * @author Ashot Vardanian
+ *
+ * @brief Entry points of the backend under the sharding router, @see "backend_sharded.cpp".
+ * Every backend exports the same `ukv_*` symbols, so the one under the router is compiled
+ * with all of them renamed to `ukv_child_*`. The `ukv_*_k` constants keep their names,
+ * as their values match across backends, and are defined by the child alone.
+ *
+ * To wrap a backend, include every header it depends on, then define `UKV_SHARDED_CHILD_RENAME`,
+ * include this file and the source of the backend, @see "sharded_stl.cpp". Headers go first,
+ * so that their inline functions are compiled against the router in every translation unit.
+ */
+#pragma once
+#include "ukv/db.h"
+
+decltype(ukv_db_open) ukv_child_db_open;
+decltype(ukv_write) ukv_child_write;
+decltype(ukv_bulk_load) ukv_child_bulk_load;
+decltype(ukv_remove_range) ukv_child_remove_range;
+decltype(ukv_read) ukv_child_read;
+decltype(ukv_scan) ukv_child_scan;
+decltype(ukv_size) ukv_child_size;
+decltype(ukv_changes_since) ukv_child_changes_since;
+decltype(ukv_col_open) ukv_child_col_open;
+decltype(ukv_col_list) ukv_child_col_list;
+decltype(ukv_col_remove) ukv_child_col_remove;
+decltype(ukv_db_control) ukv_child_db_control;
+decltype(ukv_txn_begin) ukv_child_txn_begin;
+decltype(ukv_txn_commit) ukv_child_txn_commit;
+decltype(ukv_arena_free) ukv_child_arena_free;
+decltype(ukv_arena_allocations) ukv_child_arena_allocations;
+decltype(ukv_txn_free) ukv_child_txn_free;
+decltype(ukv_db_free) ukv_child_db_free;
+decltype(ukv_error_free) ukv_child_error_free;
+void ukv_child_col_free(ukv_t const, ukv_col_t const);
+
+#if defined(UKV_SHARDED_CHILD_RENAME)
+#define ukv_db_open ukv_child_db_open
+#define ukv_write ukv_child_write
+#define ukv_bulk_load ukv_child_bulk_load
+#define ukv_remove_range ukv_child_remove_range
+#define ukv_read ukv_child_read
+#define ukv_scan ukv_child_scan
+#define ukv_size ukv_child_size
+#define ukv_changes_since ukv_child_changes_since
+#define ukv_col_open ukv_child_col_open
+#define ukv_col_list ukv_child_col_list
+#define ukv_col_remove ukv_child_col_remove
+#define ukv_db_control ukv_child_db_control
+#define ukv_txn_begin ukv_child_txn_begin
+#define ukv_txn_commit ukv_child_txn_commit
+#define ukv_arena_free ukv_child_arena_free
+#define ukv_arena_allocations ukv_child_arena_allocations
+#define ukv_txn_free ukv_child_txn_free
+#define ukv_db_free ukv_child_db_free
+#define ukv_error_free ukv_child_error_free
+#define ukv_col_free ukv_child_col_free
+#endif
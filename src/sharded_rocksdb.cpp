@@ -0,0 +1,17 @@
+/**
+ * @file sharded_rocksdb.cpp
+ * @author Ashot Vardanian
+ *
+ * @brief Compiles the RocksDB backend under the sharding router, @see "sharded_child.hpp".
+ * Every shard is a separate RocksDB instance, often on a separate disk.
+ */
+
+#include <rocksdb/db.h>
+#include <nlohmann/json.hpp>
+
+#include "helpers.hpp"
+#include "metrics.hpp"
+
+#define UKV_SHARDED_CHILD_RENAME
+#include "sharded_child.hpp"
+#include "backend_rocksdb.cpp"
@@ -0,0 +1,16 @@
+/**
+ * @file sharded_rpc.cpp
+ * @author Ashot Vardanian
+ *
+ * @brief Compiles the RPC client under the sharding router, @see "sharded_child.hpp".
+ * Every shard is a separate `ukv_rpc_server`, addressed by its "host:port" config.
+ */
+
+#include <boost/asio.hpp>
+
+#include "helpers.hpp"
+#include "rpc_protocol.hpp"
+
+#define UKV_SHARDED_CHILD_RENAME
+#include "sharded_child.hpp"
+#include "rpc_client.cpp"
@@ -0,0 +1,19 @@
+/**
+ * @file sharded_stl.cpp
+ * @author Ashot Vardanian
+ *
+ * @brief Compiles the STL backend under the sharding router, @see "sharded_child.hpp".
+ * Is mostly used for testing, as in-memory shards of a single process rarely outperform one bigger instance.
+ */
+
+#include <nlohmann/json.hpp>
+
+#include "helpers.hpp"
+#include "metrics.hpp"
+#include "sorted_blocks.hpp"
+#include "compression.hpp"
+#include "bloom_filter.hpp"
+
+#define UKV_SHARDED_CHILD_RENAME
+#include "sharded_child.hpp"
+#include "backend_stl.cpp"
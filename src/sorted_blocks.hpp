@@ -0,0 +1,344 @@
+/**
+ * @file sorted_blocks.hpp
+ * @author Ashot Vardanian
+ *
+ * @brief Cache-friendly ordered associative container.
+ * A two-level structure: a contiguous index of the first keys of every block,
+ * and blocks, each keeping sorted keys and values in separate contiguous arrays.
+ * Point lookups are two binary searches over dense arrays, instead of chasing
+ * pointers through tree nodes, and ordered scans are linear sweeps over blocks.
+ * A Fenwick tree over the sizes of blocks answers order-statistics queries.
+ */
+#pragma once
+#include <vector>    // `std::vector`
+#include <algorithm> // `std::lower_bound`
+#include <utility>   // `std::pair`
+
+namespace unum::ukv {
+
+/**
+ * @brief Ordered map with the interface subset of `std::map`, used by the backends.
+ * Unlike `std::map`, any insertion may invalidate all the iterators.
+ *
+ * @tparam block_capacity_ak Maximum number of entries in a block, before it is split.
+ */
+template <typename key_at, typename value_at, std::size_t block_capacity_ak = 256>
+class sorted_blocks_gt {
+    static_assert(block_capacity_ak >= 2, "Blocks must be splittable in halves");
+
+    struct block_t {
+        std::vector<key_at> keys;
+        std::vector<value_at> values;
+    };
+
+    /// First keys of every block in `blocks_`, used to navigate between blocks.
+    std::vector<key_at> firsts_;
+    std::vector<block_t> blocks_;
+    std::size_t size_ = 0;
+
+    /**
+     * @brief Fenwick tree of the sizes of `blocks_`, for `rank` queries.
+     * Point insertions update it in logarithmic time, but splitting or dropping
+     * blocks shifts the indexes, so it is invalidated and lazily rebuilt.
+     */
+    mutable std::vector<std::size_t> ranks_;
+    mutable bool ranks_valid_ = false;
+
+    void ranks_add_(std::size_t block_idx) noexcept {
+        if (ranks_valid_)
+            for (std::size_t i = block_idx + 1; i < ranks_.size(); i += i & (~i + 1))
+                ++ranks_[i];
+    }
+
+    void ranks_rebuild_() const {
+        ranks_.assign(blocks_.size() + 1, 0);
+        for (std::size_t i = 1; i != ranks_.size(); ++i) {
+            ranks_[i] += blocks_[i - 1].keys.size();
+            std::size_t parent = i + (i & (~i + 1));
+            if (parent < ranks_.size())
+                ranks_[parent] += ranks_[i];
+        }
+        ranks_valid_ = true;
+    }
+
+  public:
+    /**
+     * @brief Mimics the `std::pair<key_at const, value_at>&` of `std::map`,
+     * so that `it->first`, `it->second` and structured bindings keep working.
+     */
+    template <typename mapped_at>
+    struct reference_gt {
+        key_at const& first;
+        mapped_at& second;
+
+        reference_gt* operator->() noexcept { return this; }
+    };
+
+    template <typename container_at, typename mapped_at>
+    class iterator_gt {
+        friend class sorted_blocks_gt;
+        template <typename, typename>
+        friend class iterator_gt;
+
+        container_at* container_ = nullptr;
+        std::size_t block_ = 0;
+        std::size_t offset_ = 0;
+
+        iterator_gt(container_at* container, std::size_t block, std::size_t offset) noexcept
+            : container_(container), block_(block), offset_(offset) {}
+        iterator_gt(container_at* container, std::pair<std::size_t, std::size_t> position) noexcept
+            : container_(container), block_(position.first), offset_(position.second) {}
+
+      public:
+        iterator_gt() noexcept = default;
+
+        template <typename other_container_at, typename other_mapped_at>
+        iterator_gt(iterator_gt<other_container_at, other_mapped_at> const& other) noexcept
+            : container_(other.container_), block_(other.block_), offset_(other.offset_) {}
+
+        reference_gt<mapped_at> operator*() const noexcept {
+            auto& block = container_->blocks_[block_];
+            return {block.keys[offset_], block.values[offset_]};
+        }
+        reference_gt<mapped_at> operator->() const noexcept { return **this; }
+
+        iterator_gt& operator++() noexcept {
+            if (++offset_ == container_->blocks_[block_].keys.size())
+                ++block_, offset_ = 0;
+            return *this;
+        }
+
+        bool operator==(iterator_gt const& other) const noexcept {
+            return block_ == other.block_ && offset_ == other.offset_;
+        }
+        bool operator!=(iterator_gt const& other) const noexcept { return !(*this == other); }
+    };
+
+    using iterator = iterator_gt<sorted_blocks_gt, value_at>;
+    using const_iterator = iterator_gt<sorted_blocks_gt const, value_at const>;
+
+    iterator begin() noexcept { return {this, 0, 0}; }
+    iterator end() noexcept { return {this, blocks_.size(), 0}; }
+    const_iterator begin() const noexcept { return {this, 0, 0}; }
+    const_iterator end() const noexcept { return {this, blocks_.size(), 0}; }
+
+    std::size_t size() const noexcept { return size_; }
+    bool empty() const noexcept { return !size_; }
+
+    void clear() noexcept {
+        firsts_.clear();
+        blocks_.clear();
+        size_ = 0;
+        ranks_valid_ = false;
+    }
+
+    /**
+     * @brief Preallocates the index for @p n more entries.
+     * Blocks are at least half-full, after being split.
+     */
+    void reserve_more(std::size_t n) {
+        std::size_t blocks = (size_ + n) / (block_capacity_ak / 2) + 1;
+        firsts_.reserve(blocks);
+        blocks_.reserve(blocks);
+    }
+
+    iterator lower_bound(key_at const& key) noexcept { return {this, lower_bound_(key)}; }
+    const_iterator lower_bound(key_at const& key) const noexcept { return {this, lower_bound_(key)}; }
+    iterator find(key_at const& key) noexcept { return find_<iterator>(*this, key); }
+    const_iterator find(key_at const& key) const noexcept { return find_<const_iterator>(*this, key); }
+
+    /**
+     * @brief Number of entries with keys smaller than @p key.
+     * Logarithmic, unless blocks were split or dropped since the last call.
+     * Concurrent calls must be serialized by the caller, as the index is rebuilt lazily.
+     */
+    std::size_t rank(key_at const& key) const {
+        if (!ranks_valid_)
+            ranks_rebuild_();
+        auto [block_idx, offset] = position_(key);
+        std::size_t count = offset;
+        for (std::size_t i = block_idx; i; i -= i & (~i + 1))
+            count += ranks_[i];
+        return count;
+    }
+
+    /**
+     * @brief Inserts an entry, unless the @p key is already present.
+     * Provides the strong exception guarantee: if memory runs out, the container is left intact.
+     */
+    std::pair<iterator, bool> emplace(key_at const& key, value_at&& value) {
+
+        if (blocks_.empty())
+            return {emplace_back(key, std::move(value)), true};
+
+        std::size_t block_idx = block_for_(key);
+        std::size_t offset = position_in_(blocks_[block_idx], key);
+        if (offset != blocks_[block_idx].keys.size() && blocks_[block_idx].keys[offset] == key)
+            return {iterator {this, block_idx, offset}, false};
+
+        // Split the full block in halves, allocating the new one before moving any entries
+        if (blocks_[block_idx].keys.size() == block_capacity_ak) {
+            block_t second_half;
+            second_half.keys.reserve(block_capacity_ak);
+            second_half.values.reserve(block_capacity_ak);
+            firsts_.insert(firsts_.begin() + block_idx + 1, key);
+            try {
+                blocks_.insert(blocks_.begin() + block_idx + 1, std::move(second_half));
+            }
+            catch (...) {
+                firsts_.erase(firsts_.begin() + block_idx + 1);
+                throw;
+            }
+
+            ranks_valid_ = false;
+            std::size_t const half = block_capacity_ak / 2;
+            block_t& first = blocks_[block_idx];
+            block_t& second = blocks_[block_idx + 1];
+            second.keys.assign(first.keys.begin() + half, first.keys.end());
+            second.values.assign(std::make_move_iterator(first.values.begin() + half),
+                                 std::make_move_iterator(first.values.end()));
+            first.keys.resize(half);
+            first.values.erase(first.values.begin() + half, first.values.end());
+            firsts_[block_idx + 1] = second.keys.front();
+            if (offset > half)
+                ++block_idx, offset -= half;
+        }
+
+        block_t& block = blocks_[block_idx];
+        insert_(block, offset, key, std::move(value));
+        firsts_[block_idx] = block.keys.front();
+        ranks_add_(block_idx);
+        return {iterator {this, block_idx, offset}, true};
+    }
+
+    /// Checks if @p key is bigger than all the present keys, so it can be appended with `emplace_back`.
+    bool is_after_last(key_at const& key) const noexcept { return blocks_.empty() || blocks_.back().keys.back() < key; }
+
+    /**
+     * @brief Appends an entry, which must be bigger than any present key.
+     * Unlike `emplace`, never shifts existing entries and fills blocks completely,
+     * which makes loading of sorted datasets a sequential append.
+     * Provides the strong exception guarantee, just like `emplace`.
+     */
+    iterator emplace_back(key_at const& key, value_at&& value) {
+        bool const opens_block = blocks_.empty() || blocks_.back().keys.size() == block_capacity_ak;
+        if (opens_block) {
+            firsts_.push_back(key);
+            try {
+                blocks_.emplace_back();
+            }
+            catch (...) {
+                firsts_.pop_back();
+                throw;
+            }
+            ranks_valid_ = false;
+        }
+
+        block_t& block = blocks_.back();
+        try {
+            insert_(block, block.keys.size(), key, std::move(value));
+        }
+        catch (...) {
+            if (opens_block)
+                blocks_.pop_back(), firsts_.pop_back();
+            throw;
+        }
+        ranks_add_(blocks_.size() - 1);
+        return {this, blocks_.size() - 1, block.keys.size() - 1};
+    }
+
+    /**
+     * @brief Erases all the entries with keys in `[min_key, max_key)`.
+     * Blocks fully covered by the range are dropped at once, and only
+     * the two boundary blocks have their entries shifted.
+     * @return The number of erased entries.
+     */
+    std::size_t erase_range(key_at const& min_key, key_at const& max_key) {
+        if (blocks_.empty() || !(min_key < max_key))
+            return 0;
+
+        auto [first_block, first_offset] = position_(min_key);
+        auto [last_block, last_offset] = position_(max_key);
+        std::size_t erased = 0;
+        auto erase_in = [&](std::size_t block_idx, std::size_t begin, std::size_t end) {
+            block_t& block = blocks_[block_idx];
+            block.keys.erase(block.keys.begin() + begin, block.keys.begin() + end);
+            block.values.erase(block.values.begin() + begin, block.values.begin() + end);
+            erased += end - begin;
+        };
+
+        if (first_block == last_block)
+            erase_in(first_block, first_offset, last_offset);
+        else {
+            erase_in(last_block, 0, last_offset);
+            for (std::size_t i = first_block + 1; i != last_block; ++i)
+                erased += blocks_[i].keys.size();
+            erase_in(first_block, first_offset, blocks_[first_block].keys.size());
+        }
+
+        // Drop the blocks in between and the emptied boundary ones
+        std::size_t drop_begin = first_block + !blocks_[first_block].keys.empty();
+        std::size_t drop_end = last_block + blocks_[last_block].keys.empty();
+        if (drop_begin < drop_end) {
+            blocks_.erase(blocks_.begin() + drop_begin, blocks_.begin() + drop_end);
+            firsts_.erase(firsts_.begin() + drop_begin, firsts_.begin() + drop_end);
+        }
+        for (std::size_t i = first_block; i != blocks_.size() && i <= first_block + 1; ++i)
+            firsts_[i] = blocks_[i].keys.front();
+
+        size_ -= erased;
+        ranks_valid_ = false;
+        return erased;
+    }
+
+  private:
+    /// Inserts into both arrays of the @p block or neither, as values are `noexcept`-movable.
+    void insert_(block_t& block, std::size_t offset, key_at const& key, value_at&& value) {
+        block.keys.insert(block.keys.begin() + offset, key);
+        try {
+            block.values.insert(block.values.begin() + offset, std::move(value));
+        }
+        catch (...) {
+            block.keys.erase(block.keys.begin() + offset);
+            throw;
+        }
+        ++size_;
+    }
+
+    static std::size_t position_in_(block_t const& block, key_at const& key) noexcept {
+        return std::lower_bound(block.keys.begin(), block.keys.end(), key) - block.keys.begin();
+    }
+
+    /// Index of the last block, which starts with a key not bigger than @p key.
+    std::size_t block_for_(key_at const& key) const noexcept {
+        auto first_it = std::upper_bound(firsts_.begin(), firsts_.end(), key);
+        return first_it == firsts_.begin() ? 0 : (first_it - firsts_.begin() - 1);
+    }
+
+    std::pair<std::size_t, std::size_t> position_(key_at const& key) const noexcept {
+        if (blocks_.empty())
+            return {0, 0};
+        std::size_t block_idx = block_for_(key);
+        return {block_idx, position_in_(blocks_[block_idx], key)};
+    }
+
+    std::pair<std::size_t, std::size_t> lower_bound_(key_at const& key) const noexcept {
+        auto [block_idx, offset] = position_(key);
+        if (block_idx != blocks_.size() && offset == blocks_[block_idx].keys.size())
+            ++block_idx, offset = 0;
+        return {block_idx, offset};
+    }
+
+    template <typename iterator_at, typename container_at>
+    static iterator_at find_(container_at& container, key_at const& key) noexcept {
+        auto [block_idx, offset] = container.position_(key);
+        if (block_idx == container.blocks_.size())
+            return container.end();
+        auto const& keys = container.blocks_[block_idx].keys;
+        if (offset == keys.size() || keys[offset] != key)
+            return container.end();
+        return {&container, block_idx, offset};
+    }
+};
+
+} // namespace unum::ukv
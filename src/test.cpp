@@ -6,6 +6,14 @@
  * @brief A set of tests implemented using Google Test.
  */
 
+#include <atomic>
+#include <cstdlib> // `std::malloc`
+#include <cstring> // `std::strcmp`
+#include <filesystem>
+#include <limits>
+#include <new> // `std::bad_alloc`
+#include <numeric>
+#include <thread>
 #include <unordered_set>
 #include <vector>
 
@@ -13,10 +21,62 @@
 #include <nlohmann/json.hpp>
 
 #include "ukv/ukv.hpp"
+#include "ukv/arrow.h"
+#include "ukv/tensor.h"
 
 using namespace unum::ukv;
 using namespace unum;
 
+#ifndef UKV_TEST_BACKEND
+#define UKV_TEST_BACKEND ""
+#endif
+
+/**
+ * Every heap allocation of the current thread is counted, to check the hot paths,
+ * and can be failed on demand, to check the recovery from out-of-memory errors.
+ */
+static thread_local std::size_t heap_allocations = 0;
+static thread_local std::size_t heap_allocations_until_failure = std::numeric_limits<std::size_t>::max();
+
+static void* counted_alloc(std::size_t size, std::size_t alignment = 0) noexcept {
+    if (heap_allocations_until_failure != std::numeric_limits<std::size_t>::max() &&
+        heap_allocations_until_failure-- == 0)
+        return nullptr;
+    ++heap_allocations;
+    size = size ? size : 1;
+    return alignment ? std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment)
+                     : std::malloc(size);
+}
+
+static void* counted_alloc_or_throw(std::size_t size, std::size_t alignment = 0) {
+    if (void* ptr = counted_alloc(size, alignment))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+// clang-format off
+void* operator new(std::size_t n) { return counted_alloc_or_throw(n); }
+void* operator new[](std::size_t n) { return counted_alloc_or_throw(n); }
+void* operator new(std::size_t n, std::nothrow_t const&) noexcept { return counted_alloc(n); }
+void* operator new[](std::size_t n, std::nothrow_t const&) noexcept { return counted_alloc(n); }
+void* operator new(std::size_t n, std::align_val_t a) { return counted_alloc_or_throw(n, std::size_t(a)); }
+void* operator new[](std::size_t n, std::align_val_t a) { return counted_alloc_or_throw(n, std::size_t(a)); }
+void* operator new(std::size_t n, std::align_val_t a, std::nothrow_t const&) noexcept { return counted_alloc(n, std::size_t(a)); }
+void* operator new[](std::size_t n, std::align_val_t a, std::nothrow_t const&) noexcept { return counted_alloc(n, std::size_t(a)); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::nothrow_t const&) noexcept { std::free(p); }
+void operator delete[](void* p, std::nothrow_t const&) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t, std::nothrow_t const&) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t, std::nothrow_t const&) noexcept { std::free(p); }
+// clang-format on
+
 #define macro_concat_(prefix, suffix) prefix##suffix
 #define macro_concat(prefix, suffix) macro_concat_(prefix, suffix)
 #define _ [[maybe_unused]] auto macro_concat(_, __LINE__)
@@ -201,7 +261,355 @@ TEST(db, basic) {
     // Remove all of the values and check that they are missing
     EXPECT_TRUE(ref.erase());
     check_length(ref, ukv_val_len_missing_k);
-    db.clear();
+    EXPECT_TRUE(db.clear());
+}
+
+TEST(db, arena) {
+
+    db_t db;
+    EXPECT_TRUE(db.open(""));
+    col_t col = *db.collection();
+
+    std::vector<ukv_key_t> keys {34, 35, 36};
+    ukv_val_len_t val_len = sizeof(std::uint64_t);
+    std::vector<std::uint64_t> vals {34, 35, 36};
+    std::vector<ukv_val_len_t> offs {0, val_len, val_len * 2};
+    auto vals_begin = reinterpret_cast<ukv_val_ptr_t>(vals.data());
+    values_arg_t values {
+        .contents_begin = {&vals_begin, 0},
+        .offsets_begin = {offs.data(), sizeof(ukv_val_len_t)},
+        .lengths_begin = {&val_len, 0},
+    };
+    EXPECT_TRUE(col[keys].assign(values));
+
+    // Once the arena has grown, repeated reads of the same size must not allocate.
+    // Arenas may be reused after previous tests, so the first read may not allocate either.
+    arena_t arena(db);
+    auto read = [&] {
+        ukv_val_ptr_t found_values = nullptr;
+        ukv_val_len_t* found_offsets = nullptr;
+        ukv_val_len_t* found_lengths = nullptr;
+        status_t status;
+        ukv_read(db,
+                 nullptr,
+                 static_cast<ukv_size_t>(keys.size()),
+                 nullptr,
+                 0,
+                 keys.data(),
+                 sizeof(ukv_key_t),
+                 ukv_options_default_k,
+                 &found_values,
+                 &found_offsets,
+                 &found_lengths,
+                 arena.member_ptr(),
+                 status.member_ptr());
+        EXPECT_TRUE(status);
+    };
+    read();
+    std::size_t const warm_allocations = arena.allocations();
+    for (std::size_t i = 0; i != 10; ++i)
+        read();
+    EXPECT_EQ(arena.allocations(), warm_allocations);
+    EXPECT_TRUE(db.clear());
+}
+
+TEST(db, allocations) {
+    if (std::strcmp(UKV_TEST_BACKEND, "stl") != 0)
+        GTEST_SKIP() << "Only the STL backend promises allocation-free hot paths";
+
+    db_t db;
+    EXPECT_TRUE(db.open(""));
+
+    std::vector<ukv_key_t> keys(16);
+    std::iota(keys.begin(), keys.end(), 0);
+    ukv_val_len_t val_len = sizeof(std::uint64_t);
+    std::vector<std::uint64_t> vals(keys.size());
+    auto vals_begin = reinterpret_cast<ukv_val_ptr_t>(vals.data());
+    std::vector<ukv_val_len_t> offs(keys.size());
+    for (std::size_t i = 0; i != offs.size(); ++i)
+        offs[i] = static_cast<ukv_val_len_t>(i * val_len);
+
+    // Overwrites of values of the same size recycle the replaced buffers
+    arena_t arena(db);
+    auto round_trip = [&](ukv_arena_t* c_arena) {
+        status_t status;
+        ukv_write(db,
+                  nullptr,
+                  static_cast<ukv_size_t>(keys.size()),
+                  nullptr,
+                  0,
+                  keys.data(),
+                  sizeof(ukv_key_t),
+                  &vals_begin,
+                  0,
+                  offs.data(),
+                  sizeof(ukv_val_len_t),
+                  &val_len,
+                  0,
+                  ukv_options_default_k,
+                  c_arena,
+                  status.member_ptr());
+        EXPECT_TRUE(status);
+        ukv_val_ptr_t found_values = nullptr;
+        ukv_val_len_t* found_offsets = nullptr;
+        ukv_val_len_t* found_lengths = nullptr;
+        ukv_read(db,
+                 nullptr,
+                 static_cast<ukv_size_t>(keys.size()),
+                 nullptr,
+                 0,
+                 keys.data(),
+                 sizeof(ukv_key_t),
+                 ukv_options_default_k,
+                 &found_values,
+                 &found_offsets,
+                 &found_lengths,
+                 c_arena ? c_arena : arena.member_ptr(),
+                 status.member_ptr());
+        EXPECT_TRUE(status);
+    };
+    for (ukv_arena_t* c_arena : {arena.member_ptr(), static_cast<ukv_arena_t*>(nullptr)}) {
+        round_trip(c_arena);
+        round_trip(c_arena);
+        std::size_t const warm_allocations = heap_allocations;
+        for (std::size_t i = 0; i != 10; ++i)
+            round_trip(c_arena);
+        EXPECT_EQ(heap_allocations, warm_allocations);
+    }
+    EXPECT_TRUE(db.clear());
+}
+
+TEST(db, scan_prefetch) {
+
+    db_t db;
+    EXPECT_TRUE(db.open(""));
+    col_t col = *db.collection();
+
+    // Spans many batches, including a partial one at the end
+    std::size_t const count = 1'050;
+    std::vector<ukv_key_t> keys(count);
+    std::vector<std::uint64_t> vals(count);
+    std::vector<ukv_val_len_t> offs(count);
+    ukv_val_len_t val_len = sizeof(std::uint64_t);
+    for (std::size_t i = 0; i != count; ++i) {
+        keys[i] = static_cast<ukv_key_t>(i * 3);
+        vals[i] = i;
+        offs[i] = static_cast<ukv_val_len_t>(i * val_len);
+    }
+    auto vals_begin = reinterpret_cast<ukv_val_ptr_t>(vals.data());
+    values_arg_t values {
+        .contents_begin = {&vals_begin, 0},
+        .offsets_begin = {offs.data(), sizeof(ukv_val_len_t)},
+        .lengths_begin = {&val_len, 0},
+    };
+    EXPECT_TRUE(col[keys].assign(values));
+
+    for (bool prefetch : {false, true}) {
+        members_range_t members = col.members();
+        keys_stream_t keys_stream = *members.keys_begin(100, prefetch);
+        std::vector<ukv_key_t> streamed_keys;
+        for (; !keys_stream.is_end(); ++keys_stream)
+            streamed_keys.push_back(keys_stream.key());
+        EXPECT_EQ(streamed_keys, keys);
+
+        pairs_stream_t pairs_stream = *members.pairs_begin(64, prefetch);
+        std::size_t i = 0;
+        for (; !pairs_stream.is_end(); ++pairs_stream, ++i) {
+            EXPECT_EQ(pairs_stream.key(), keys[i]);
+            value_view_t val = pairs_stream.value();
+            ASSERT_EQ(val.size(), sizeof(std::uint64_t));
+            EXPECT_EQ(*reinterpret_cast<std::uint64_t const*>(val.begin()), vals[i]);
+        }
+        EXPECT_EQ(i, count);
+
+        // Batches can be consumed at once, and re-seeking discards the prefetched one
+        keys_stream_t batches = *members.keys_begin(256, prefetch);
+        std::size_t batched = batches.keys_batch().size();
+        EXPECT_TRUE(batches.seek(keys[500]));
+        EXPECT_EQ(batches.key(), keys[500]);
+        while (!batches.is_end()) {
+            batched += batches.keys_batch().size();
+            EXPECT_TRUE(batches.seek_to_next_batch());
+        }
+        EXPECT_EQ(batched, 256 + count - 500);
+    }
+    EXPECT_TRUE(db.clear());
+}
+
+TEST(db, bulk_load) {
+
+    db_t db;
+    EXPECT_TRUE(db.open(""));
+    col_t col = *db.collection();
+
+    std::vector<ukv_key_t> keys {44, 45, 46};
+    ukv_val_len_t val_len = sizeof(std::uint64_t);
+    std::vector<std::uint64_t> vals {44, 45, 46};
+    std::vector<ukv_val_len_t> offs {0, val_len, val_len * 2};
+    auto vals_begin = reinterpret_cast<ukv_val_ptr_t>(vals.data());
+    values_arg_t values {
+        .contents_begin = {&vals_begin, 0},
+        .offsets_begin = {offs.data(), sizeof(ukv_val_len_t)},
+        .lengths_begin = {&val_len, 0},
+    };
+
+    auto bulk_load = [&](std::vector<ukv_key_t> const& keys) {
+        arena_t arena(db);
+        status_t status;
+        // Longer loads repeat the first value
+        ukv_size_t offs_stride = keys.size() <= offs.size() ? sizeof(ukv_val_len_t) : 0;
+        ukv_bulk_load(db,
+                      static_cast<ukv_size_t>(keys.size()),
+                      nullptr,
+                      0,
+                      keys.data(),
+                      sizeof(ukv_key_t),
+                      &vals_begin,
+                      0,
+                      offs.data(),
+                      offs_stride,
+                      &val_len,
+                      0,
+                      ukv_options_default_k,
+                      arena.member_ptr(),
+                      status.member_ptr());
+        return status;
+    };
+
+    EXPECT_TRUE(bulk_load(keys));
+    auto ref = col[keys];
+    check_equalities(ref, values);
+
+    // Unsorted inputs must be rejected
+    std::vector<ukv_key_t> unsorted_keys {49, 48, 47};
+    EXPECT_FALSE(bulk_load(unsorted_keys));
+    auto unsorted_ref = col[unsorted_keys];
+    check_length(unsorted_ref, ukv_val_len_missing_k);
+
+    // Longer inputs are validated in wider chunks, so the misplaced key may be anywhere
+    std::vector<ukv_key_t> long_keys(101);
+    std::iota(long_keys.begin(), long_keys.end(), 100);
+    for (std::size_t misplaced : {1ul, 50ul, 99ul, 100ul}) {
+        std::vector<ukv_key_t> misplaced_keys = long_keys;
+        std::swap(misplaced_keys[misplaced - 1], misplaced_keys[misplaced]);
+        EXPECT_FALSE(bulk_load(misplaced_keys));
+    }
+    std::vector<ukv_key_t> duplicate_keys = long_keys;
+    duplicate_keys[70] = duplicate_keys[69];
+    EXPECT_FALSE(bulk_load(duplicate_keys));
+    EXPECT_TRUE(bulk_load(long_keys));
+    EXPECT_TRUE(db.clear());
+}
+
+TEST(db, remove_range) {
+    db_t db;
+    EXPECT_TRUE(db.open(""));
+    col_t col = *db.collection();
+
+    std::vector<ukv_key_t> keys(2000);
+    std::iota(keys.begin(), keys.end(), 0);
+    ukv_val_len_t val_len = sizeof(std::uint64_t);
+    std::vector<std::uint64_t> vals(keys.begin(), keys.end());
+    auto vals_begin = reinterpret_cast<ukv_val_ptr_t>(vals.data());
+    values_arg_t values {
+        .contents_begin = {&vals_begin, 0},
+        .offsets_begin = {},
+        .lengths_begin = {&val_len, 0},
+    };
+    std::vector<ukv_val_len_t> offs(keys.size());
+    for (std::size_t i = 0; i != keys.size(); ++i)
+        offs[i] = static_cast<ukv_val_len_t>(i * sizeof(std::uint64_t));
+    values.offsets_begin = {offs.data(), sizeof(ukv_val_len_t)};
+    EXPECT_TRUE(col[keys].assign(values));
+
+    auto present_keys = [&] {
+        std::vector<ukv_key_t> present;
+        for (keys_stream_t it = col.keys().begin(); !it.is_end(); ++it)
+            present.push_back(*it);
+        return present;
+    };
+
+    // The range spans many blocks, and both of its ends are in the middle of blocks
+    EXPECT_TRUE(col.remove_range(500, 1500));
+    std::vector<ukv_key_t> expected;
+    for (ukv_key_t key = 0; key != 500; ++key)
+        expected.push_back(key);
+    for (ukv_key_t key = 1500; key != 2000; ++key)
+        expected.push_back(key);
+    EXPECT_EQ(present_keys(), expected);
+    EXPECT_TRUE(col.remove_range(700, 600));
+    EXPECT_EQ(present_keys(), expected);
+
+    // Snapshots still see the removed entries
+    txn_t snapshot = *db.transact(true);
+    std::vector<ukv_key_t> snapshot_keys {100, 200};
+    auto snapshot_ref = snapshot[snapshot_keys];
+    EXPECT_TRUE(col.remove_range(0, 300));
+    auto head_ref = col[snapshot_keys];
+    check_length(head_ref, ukv_val_len_missing_k);
+    check_length(snapshot_ref, val_len);
+    snapshot.reset().throw_unhandled();
+
+    // Transactions, that have read the removed entries, must fail
+    txn_t txn = *db.transact();
+    std::vector<ukv_key_t> txn_keys {1600, 1601};
+    EXPECT_TRUE(txn[txn_keys].value(true));
+    EXPECT_TRUE(col.remove_range(1600, 1700));
+    EXPECT_FALSE(txn.commit());
+
+    // The whole collection can be purged at once
+    EXPECT_TRUE(col.remove_range());
+    EXPECT_TRUE(present_keys().empty());
+    EXPECT_TRUE(db.clear());
+}
+
+TEST(db, size_estimates) {
+    db_t db;
+    EXPECT_TRUE(db.open(""));
+    col_t col = *db.collection();
+    for (ukv_key_t key = 0; key != 1000; ++key)
+        col[key] = "12345678";
+    for (ukv_key_t key = 0; key != 1000; key += 10)
+        EXPECT_TRUE(col[key].erase());
+
+    size_estimates_t whole = *col.members().size_estimates();
+    if (!whole.cardinality.max)
+        GTEST_SKIP() << "Size estimates aren't supported by this backend";
+    EXPECT_LE(whole.cardinality.min, whole.cardinality.max);
+    EXPECT_LE(whole.bytes_in_values.min, whole.bytes_in_values.max);
+    EXPECT_LE(whole.bytes_on_disk.min, whole.bytes_on_disk.max);
+    EXPECT_LE(whole.cardinality.min, 900u);
+    EXPECT_GE(whole.cardinality.max, 900u);
+
+    // Backends with running totals are exact for whole collections and bound the partial ranges
+    if (whole.cardinality.min != whole.cardinality.max)
+        GTEST_SKIP() << "Size estimates of this backend are only approximate";
+    EXPECT_EQ(whole.cardinality.min, 900u);
+    EXPECT_EQ(whole.bytes_in_values.min, 900u * 8u);
+    size_estimates_t part = *col.members(100, 300).size_estimates();
+    EXPECT_LE(part.cardinality.min, 180u);
+    EXPECT_GE(part.cardinality.max, 180u);
+    EXPECT_LE(part.bytes_in_values.min, 180u * 8u);
+    EXPECT_GE(part.bytes_in_values.max, 180u * 8u);
+    EXPECT_EQ(col.members(300, 100).size_estimates()->cardinality.max, 0u);
+
+    // The totals follow overwrites and range removals
+    col[1] = "1234";
+    EXPECT_TRUE(col.remove_range(500, 1000));
+    whole = *col.members().size_estimates();
+    EXPECT_EQ(whole.cardinality.max, 450u);
+    EXPECT_EQ(whole.bytes_in_values.max, 449u * 8u + 4u);
+
+    // Commits are accounted for, as well as the uncommitted updates of transactions
+    txn_t txn = *db.transact();
+    col_t txn_col(db, ukv_col_main_k, txn);
+    for (ukv_key_t key = 2000; key != 2010; ++key)
+        txn_col[key] = "12345678";
+    EXPECT_EQ(txn_col.members().size_estimates()->cardinality.max, 460u);
+    EXPECT_EQ(col.members().size_estimates()->cardinality.max, 450u);
+    txn.commit().throw_unhandled();
+    EXPECT_EQ(col.members().size_estimates()->cardinality.max, 460u);
+    EXPECT_TRUE(db.clear());
 }
 
 TEST(db, named) {
@@ -266,7 +674,343 @@ TEST(db, named) {
     _ = db.remove("col2");
     EXPECT_FALSE(*db.contains("col1"));
     EXPECT_FALSE(*db.contains("col2"));
-    db.clear();
+    EXPECT_TRUE(db.clear());
+}
+
+TEST(db, persistence) {
+    namespace fs = std::filesystem;
+    fs::path const path = fs::temp_directory_path() / "ukv_test_persistence";
+    fs::remove_all(path);
+    fs::create_directories(path);
+
+    auto check = [](db_t& db) {
+        col_t main = *db.collection();
+        for (ukv_key_t key = 2; key != 100; ++key)
+            EXPECT_EQ(*main[key].value(), key % 10 ? std::to_string(key).c_str() : "");
+        EXPECT_EQ(*main[1].value(), "");
+        EXPECT_EQ(*main[200].value(), "committed");
+        EXPECT_EQ(*main[300].value(), "");
+        EXPECT_EQ(*db.collection("named")->at(1).value(), "one");
+        EXPECT_FALSE(*db.contains("dropped"));
+    };
+
+    // Writes, removals, transactions and dropped collections are replayed from the log
+    {
+        db_t db;
+        if (!db.open(path.string())) {
+            fs::remove_all(path);
+            GTEST_SKIP() << "This backend can't be opened from a directory path";
+        }
+        col_t main = *db.collection();
+        for (ukv_key_t key = 0; key != 100; ++key)
+            main[key] = std::to_string(key).c_str();
+        for (ukv_key_t key = 0; key != 100; key += 10)
+            EXPECT_TRUE(main[key].erase());
+        db.collection("named")->at(1) = "one";
+        db.collection("dropped")->at(1) = "gone";
+
+        txn_t txn = *db.transact();
+        col_t txn_col(db, ukv_col_main_k, txn);
+        txn_col[200] = "committed";
+        EXPECT_TRUE(txn_col[1].erase());
+        txn.commit().throw_unhandled();
+        txn_t aborted = *db.transact();
+        col_t aborted_col(db, ukv_col_main_k, aborted);
+        aborted_col[300] = "aborted";
+        EXPECT_TRUE(db.remove("dropped"));
+
+        // Dropping a missing collection is a no-op, even for the log
+        auto files_size = [&] {
+            std::uintmax_t size = 0;
+            for (auto const& entry : fs::directory_iterator(path))
+                size += entry.is_regular_file() ? entry.file_size() : 0;
+            return size;
+        };
+        std::uintmax_t const logged_size = files_size();
+        EXPECT_TRUE(db.remove("missing"));
+        if (std::strcmp(UKV_TEST_BACKEND, "stl") == 0)
+            EXPECT_EQ(files_size(), logged_size);
+    }
+
+    // Reopens the log, and compacts it into a snapshot
+    bool compacted = false;
+    {
+        db_t db;
+        EXPECT_TRUE(db.open(path.string()));
+        check(db);
+
+        ukv_str_view_t response = nullptr;
+        ukv_error_t error = nullptr;
+        ukv_db_control(db, "compact", &response, &error);
+        compacted = !error;
+        ukv_error_free(error);
+        db.collection()->at(400) = "after compaction";
+    }
+
+    // Loads the snapshot, and replays only the younger segment on top
+    {
+        db_t db;
+        EXPECT_TRUE(db.open(path.string()));
+        check(db);
+        EXPECT_EQ(*db.collection()->at(400).value(), "after compaction");
+        if (compacted) {
+            EXPECT_TRUE(fs::is_regular_file(path / ".stl.ukv"));
+        }
+        db.clear().throw_unhandled();
+    }
+    fs::remove_all(path);
+}
+
+TEST(db, persistence_failures) {
+    if (std::strcmp(UKV_TEST_BACKEND, "stl") != 0)
+        GTEST_SKIP() << "Allocation failures are only injected into the STL backend";
+    namespace fs = std::filesystem;
+    fs::path const path = fs::temp_directory_path() / "ukv_test_persistence_failures";
+
+    std::vector<ukv_key_t> keys {1, 2, 3, 4, 5, 6};
+    std::vector<ukv_val_len_t> offs {0, 3, 6, 9, 12, 15};
+    std::vector<ukv_val_len_t> lens {3, 3, 3, 3, 3, ukv_val_len_missing_k};
+    char new_vals[] = "newnewnewnewnew";
+    auto vals_begin = reinterpret_cast<ukv_val_ptr_t>(new_vals);
+
+    // Keys 1-3 are overwritten, 4-5 are inserted and 6 is removed in one batch.
+    // A batch failing at any allocation must leave no trace, neither in memory nor in the log.
+    auto check = [&](db_t& db, bool applied) {
+        col_t main = *db.collection();
+        for (ukv_key_t key : {1, 2, 3})
+            EXPECT_EQ(*main[key].value(), applied ? "new" : "old");
+        for (ukv_key_t key : {4, 5})
+            EXPECT_EQ(*main[key].value(), applied ? "new" : "");
+        EXPECT_EQ(*main[6].value(), applied ? "" : "old");
+    };
+
+    bool applied = false;
+    for (std::size_t failing = 0; !applied; ++failing) {
+        SCOPED_TRACE(failing);
+        fs::remove_all(path);
+        fs::create_directories(path);
+        {
+            db_t db;
+            ASSERT_TRUE(db.open(path.string()));
+            col_t main = *db.collection();
+            for (ukv_key_t key : {1, 2, 3, 6})
+                main[key] = "old";
+
+            arena_t arena(db);
+            status_t status;
+            heap_allocations_until_failure = failing;
+            ukv_write(db,
+                      nullptr,
+                      static_cast<ukv_size_t>(keys.size()),
+                      nullptr,
+                      0,
+                      keys.data(),
+                      sizeof(ukv_key_t),
+                      &vals_begin,
+                      0,
+                      offs.data(),
+                      sizeof(ukv_val_len_t),
+                      lens.data(),
+                      sizeof(ukv_val_len_t),
+                      ukv_option_write_flush_k,
+                      arena.member_ptr(),
+                      status.member_ptr());
+            heap_allocations_until_failure = std::numeric_limits<std::size_t>::max();
+            applied = static_cast<bool>(status);
+            check(db, applied);
+        }
+        db_t db;
+        ASSERT_TRUE(db.open(path.string()));
+        check(db, applied);
+    }
+    fs::remove_all(path);
+}
+
+TEST(db, compression) {
+    db_t db;
+    EXPECT_TRUE(db.open(""));
+    col_t col = *db.collection("compressed", ukv_format_binary_k, R"({"compression": "lz4"})");
+
+    // Long repetitive values shrink, while short ones are kept as is
+    std::vector<ukv_key_t> keys {1, 2, 3};
+    std::string tape = std::string(2000, 'a') + "short" + std::string(500, 'b');
+    std::vector<ukv_val_len_t> offs {0, 2000, 2005};
+    std::vector<ukv_val_len_t> lens {2000, 5, 500};
+    auto vals_begin = reinterpret_cast<ukv_val_ptr_t>(tape.data());
+    values_arg_t values {
+        .contents_begin = {&vals_begin, 0},
+        .offsets_begin = {offs.data(), sizeof(ukv_val_len_t)},
+        .lengths_begin = {lens.data(), sizeof(ukv_val_len_t)},
+    };
+    auto ref = col[keys];
+    round_trip(ref, values);
+    auto maybe_lengths = ref.length();
+    EXPECT_TRUE(maybe_lengths);
+    for (std::size_t i = 0; i != keys.size(); ++i)
+        EXPECT_EQ(maybe_lengths->at(i), lens[i]);
+
+    // Transactions compress on commit, and see their own uncompressed writes
+    txn_t txn = *db.transact();
+    col_t txn_col = *txn["compressed"];
+    std::vector<ukv_key_t> txn_keys {4, 5, 6};
+    auto txn_ref = txn_col[txn_keys];
+    EXPECT_TRUE(txn_ref.assign(values));
+    check_equalities(txn_ref, values);
+    EXPECT_TRUE(txn.commit());
+    auto committed_ref = col[txn_keys];
+    check_equalities(committed_ref, values);
+
+    // Compression can't be changed, once enabled
+    EXPECT_TRUE(db.collection("compressed", ukv_format_binary_k, R"({"compression": "lz4"})"));
+    EXPECT_FALSE(db.collection("compressed", ukv_format_binary_k, R"({"compression": "none"})"));
+    EXPECT_FALSE(db.collection("compressed", ukv_format_binary_k, R"({"compression": "lz5"})"));
+
+    // Small values shrink, if primed with a shared dictionary
+    char const* dictionary_config = R"({"compression": "lz4", "dictionary": "{'name':'','email':'@example.com'}"})";
+    col_t primed = *db.collection("primed", ukv_format_binary_k, dictionary_config);
+    std::string small = "{'name':'Ann','email':'ann@example.com'}";
+    auto small_begin = reinterpret_cast<ukv_val_ptr_t>(small.data());
+    ukv_val_len_t small_len = static_cast<ukv_val_len_t>(small.size());
+    ukv_val_len_t small_off = 0;
+    values_arg_t small_values {
+        .contents_begin = {&small_begin, 0},
+        .offsets_begin = {&small_off, 0},
+        .lengths_begin = {&small_len, 0},
+    };
+    std::vector<ukv_key_t> small_keys {7};
+    auto primed_ref = primed[small_keys];
+    round_trip(primed_ref, small_values);
+    EXPECT_TRUE(db.clear());
+}
+
+TEST(db, bloom_filter) {
+    db_t db;
+    EXPECT_TRUE(db.open(""));
+    col_t col = *db.collection("filtered", ukv_format_binary_k, R"({"bloom_bits_per_key": 10})");
+
+    // Enough keys to outgrow the initial filter a few times
+    std::vector<ukv_key_t> keys(5000);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::uint64_t val = 42;
+    auto vals_begin = reinterpret_cast<ukv_val_ptr_t>(&val);
+    ukv_val_len_t val_len = sizeof(val);
+    ukv_val_len_t val_off = 0;
+    values_arg_t values {
+        .contents_begin = {&vals_begin, 0},
+        .offsets_begin = {&val_off, 0},
+        .lengths_begin = {&val_len, 0},
+    };
+    EXPECT_TRUE(col[keys].assign(values));
+
+    auto count_present = [&](col_t& col, std::vector<ukv_key_t> const& keys) {
+        auto lengths = *col[keys].length();
+        std::size_t present = 0;
+        for (std::size_t i = 0; i != keys.size(); ++i)
+            present += lengths[i] != ukv_val_len_missing_k;
+        return present;
+    };
+    std::vector<ukv_key_t> missing_keys(5000);
+    std::iota(missing_keys.begin(), missing_keys.end(), 1000000);
+    EXPECT_EQ(count_present(col, keys), keys.size());
+    EXPECT_EQ(count_present(col, missing_keys), 0ul);
+
+    // Commits and removals keep the filter consistent
+    txn_t txn = *db.transact();
+    EXPECT_TRUE((*txn["filtered"])[missing_keys].assign(values));
+    EXPECT_TRUE(txn.commit());
+    EXPECT_EQ(count_present(col, missing_keys), missing_keys.size());
+    EXPECT_TRUE(col.remove_range(1000000, 1002500));
+    EXPECT_EQ(count_present(col, missing_keys), missing_keys.size() / 2);
+
+    // Filters can be added to populated collections, resized and disabled
+    col_t main = *db.collection("", ukv_format_binary_k);
+    EXPECT_TRUE(main[keys].assign(values));
+    EXPECT_TRUE(db.collection("", ukv_format_binary_k, R"({"bloom_bits_per_key": 16})"));
+    EXPECT_EQ(count_present(main, keys), keys.size());
+    EXPECT_EQ(count_present(main, missing_keys), 0ul);
+    EXPECT_TRUE(db.collection("", ukv_format_binary_k, R"({"bloom_bits_per_key": 0})"));
+    EXPECT_EQ(count_present(main, keys), keys.size());
+    EXPECT_TRUE(db.clear());
+}
+
+TEST(db, changes) {
+    db_t db;
+    EXPECT_TRUE(db.open(""));
+    col_t col = *db.collection("followed", ukv_format_binary_k, R"({"change_feed": 16})");
+
+    arena_t arena(db);
+    ukv_size_t count = 0;
+    ukv_key_t* keys = nullptr;
+    ukv_size_t* generations = nullptr;
+    ukv_val_len_t* lengths = nullptr;
+    ukv_size_t next = 0;
+    auto changes_since = [&](ukv_size_t generation, ukv_size_t limit) {
+        status_t status;
+        ukv_changes_since(db, col, generation, limit, &count, &keys, &generations, &lengths, &next, //
+                          arena.member_ptr(), status.member_ptr());
+        return status;
+    };
+    if (!changes_since(0, 0))
+        GTEST_SKIP() << "Change feeds aren't supported by this backend";
+    ukv_size_t const start = next;
+
+    // Head writes and removals come in the order of generations
+    std::uint64_t val = 42;
+    auto vals_begin = reinterpret_cast<ukv_val_ptr_t>(&val);
+    ukv_val_len_t val_len = sizeof(val);
+    ukv_val_len_t val_off = 0;
+    values_arg_t values {
+        .contents_begin = {&vals_begin, 0},
+        .offsets_begin = {&val_off, 0},
+        .lengths_begin = {&val_len, 0},
+    };
+    for (ukv_key_t key : {1, 2, 3})
+        EXPECT_TRUE(col[key].assign(values));
+    EXPECT_TRUE(col[2].erase());
+    EXPECT_TRUE(changes_since(start, 100));
+    ASSERT_EQ(count, 4ul);
+    EXPECT_EQ(std::vector<ukv_key_t>(keys, keys + count), (std::vector<ukv_key_t> {1, 2, 3, 2}));
+    EXPECT_EQ(lengths[0], val_len);
+    EXPECT_EQ(lengths[3], ukv_val_len_missing_k);
+    EXPECT_TRUE(std::is_sorted(generations, generations + count));
+    EXPECT_GT(generations[0], start);
+
+    // Followers catch up in small batches, skipping what they have seen
+    EXPECT_TRUE(changes_since(start, 2));
+    ASSERT_EQ(count, 2ul);
+    EXPECT_EQ(keys[1], 2);
+    EXPECT_TRUE(changes_since(next, 100));
+    ASSERT_EQ(count, 2ul);
+    EXPECT_EQ(keys[0], 3);
+    EXPECT_TRUE(changes_since(next, 100));
+    EXPECT_EQ(count, 0ul);
+
+    // Updates of a transaction are never split between batches
+    ukv_size_t const before_txn = next;
+    txn_t txn = *db.transact();
+    std::vector<ukv_key_t> txn_keys {10, 11, 12};
+    EXPECT_TRUE((*txn["followed"])[txn_keys].assign(values));
+    EXPECT_TRUE(txn.commit());
+    EXPECT_TRUE(changes_since(before_txn, 1));
+    EXPECT_EQ(count, 3ul);
+
+    // Once the history is evicted or truncated, the follower must start over
+    std::vector<ukv_key_t> many_keys(20);
+    std::iota(many_keys.begin(), many_keys.end(), 100);
+    EXPECT_TRUE(col[many_keys].assign(values));
+    if (changes_since(before_txn, 100)) {
+        EXPECT_EQ(count, 23ul);
+    }
+    EXPECT_TRUE(changes_since(0, 0));
+    ukv_size_t const restart = next;
+    EXPECT_TRUE(col.remove_range());
+    EXPECT_FALSE(changes_since(restart, 100));
+    EXPECT_TRUE(changes_since(0, 0));
+    EXPECT_TRUE(col[7].assign(values));
+    EXPECT_TRUE(changes_since(next, 100));
+    ASSERT_EQ(count, 1ul);
+    EXPECT_EQ(keys[0], 7);
+    EXPECT_TRUE(db.clear());
 }
 
 TEST(db, docs) {
@@ -318,7 +1062,40 @@ TEST(db, docs) {
     M_EXPECT_EQ_JSON(col[ckf(1, "person")].value()->c_str(), "\"Darvin\"");
     M_EXPECT_EQ_JSON(col[ckf(1, "/hello/0")].value()->c_str(), "\"world\"");
     M_EXPECT_EQ_JSON(col[ckf(1, "age")].value()->c_str(), "28");
-    db.clear();
+    EXPECT_TRUE(db.clear());
+}
+
+TEST(db, docs_cache) {
+    using json_t = nlohmann::json;
+    db_t db;
+    EXPECT_TRUE(db.open(""));
+    ukv_docs_cache_limit(2);
+
+    col_t col = *db.collection("docs", ukv_format_json_k);
+    col[1] = R"( {"person": "Davit", "age": 24} )";
+    col[2] = R"( {"person": "Ashot", "age": 27} )";
+    col[3] = R"( {"person": "Darvin", "age": 28} )";
+
+    ukv_size_t hits = 0, misses = 0;
+    M_EXPECT_EQ_JSON(col[ckf(1, "person")].value()->c_str(), "\"Davit\"");
+    M_EXPECT_EQ_JSON(col[ckf(1, "age")].value()->c_str(), "24");
+    ukv_docs_cache_stats(&hits, &misses);
+    EXPECT_EQ(hits, 1ul);
+    EXPECT_EQ(misses, 1ul);
+
+    // Updated documents must be re-parsed
+    col[1] = R"( {"person": "Davit", "age": 25} )";
+    M_EXPECT_EQ_JSON(col[ckf(1, "age")].value()->c_str(), "25");
+
+    // Overflowing the cache evicts older entries, but keeps results correct
+    M_EXPECT_EQ_JSON(col[ckf(2, "age")].value()->c_str(), "27");
+    M_EXPECT_EQ_JSON(col[ckf(3, "age")].value()->c_str(), "28");
+    M_EXPECT_EQ_JSON(col[ckf(1, "person")].value()->c_str(), "\"Davit\"");
+    ukv_docs_cache_stats(&hits, &misses);
+    EXPECT_EQ(hits + misses, 6ul);
+
+    ukv_docs_cache_limit(0);
+    EXPECT_TRUE(db.clear());
 }
 
 TEST(db, docs_table) {
@@ -426,7 +1203,275 @@ TEST(db, docs_table) {
         EXPECT_STREQ(col1[1].value.c_str(), "27");
         EXPECT_STREQ(col1[2].value.c_str(), "24");
     }
-    db.clear();
+    EXPECT_TRUE(db.clear());
+}
+
+TEST(db, docs_table_nested) {
+    db_t db;
+    EXPECT_TRUE(db.open(""));
+
+    col_t col = *db.collection("", ukv_format_json_k);
+    col[1] = R"( { "person": {"name": "Ashot", "ids/tags": [3, -4]}, "skipped": [{"a": [1, 2]}, "b"], "age": 27 } )";
+    col[2] = R"( [ "not", "an", "object" ] )";
+
+    docs_layout_t layout {3, 4};
+    layout.index(0).key = 1;
+    layout.index(1).key = 2;
+    layout.index(2).key = 3;
+    layout.header(0) = field_type_t {"age", ukv_type_i64_k};
+    layout.header(1) = field_type_t {"/person/name", ukv_type_str_k};
+    layout.header(2) = field_type_t {"/person/ids~1tags/1", ukv_type_i32_k};
+    layout.header(3) = field_type_t {"/person/ids~1tags/2", ukv_type_i32_k};
+
+    auto table = *col.as_table().gather(layout);
+    auto ages = table.column(0).as<std::int64_t>();
+    auto names = table.column(1).as<value_view_t>();
+    auto tags = table.column(2).as<std::int32_t>();
+    EXPECT_EQ(ages[0].value, 27);
+    EXPECT_FALSE(ages[1].valid);
+    EXPECT_FALSE(ages[2].valid);
+    EXPECT_STREQ(names[0].value.c_str(), "Ashot");
+    EXPECT_EQ(tags[0].value, -4);
+    EXPECT_FALSE(table.column(3).as<std::int32_t>()[0].valid);
+
+    // Zero stride means the fields are joined into a single NUL-delimited string,
+    // both for the lazy MessagePack lookups and the cached DOM
+    col[3] = R"( {"a": 1, "b": 2} )";
+    ukv_key_t const key = 3;
+    ukv_type_t const type = ukv_type_i32_k;
+    ukv_str_view_t const joined_fields = "a\0b";
+    for (ukv_size_t cache_limit : {0, 2}) {
+        ukv_docs_cache_limit(cache_limit);
+        arena_t arena(db);
+        ukv_1x8_t** validities = nullptr;
+        ukv_1x8_t** conversions = nullptr;
+        ukv_1x8_t** collisions = nullptr;
+        ukv_val_ptr_t* scalars = nullptr;
+        ukv_val_len_t** offsets = nullptr;
+        ukv_val_len_t** lengths = nullptr;
+        ukv_val_ptr_t strings = nullptr;
+        status_t status;
+        ukv_docs_gather(db, nullptr, 1, 2, col.member_ptr(), 0, &key, 0, &joined_fields, 0, &type, 0, //
+                        ukv_options_default_k,
+                        &validities, &conversions, &collisions, &scalars, &offsets, &lengths, &strings,
+                        arena.member_ptr(), status.member_ptr());
+        ASSERT_TRUE(status);
+        EXPECT_EQ(reinterpret_cast<std::int32_t const*>(scalars[0])[0], 1);
+        EXPECT_EQ(reinterpret_cast<std::int32_t const*>(scalars[1])[0], 2);
+    }
+    ukv_docs_cache_limit(0);
+    EXPECT_TRUE(db.clear());
+}
+
+TEST(db, docs_shredded) {
+    using json_t = nlohmann::json;
+    db_t db;
+    EXPECT_TRUE(db.open(""));
+
+    col_t col = *db.collection("people", ukv_format_json_k);
+    col_t ages = *db.collection("people.age");
+    col_t heights = *db.collection("people.height");
+    std::array<ukv_str_view_t, 2> fields {"age", "height"};
+    std::array<ukv_type_t, 2> types {ukv_type_u8_k, ukv_type_f64_k};
+    std::array<ukv_col_t, 2> columns {ages, heights};
+    ukv_error_t error = nullptr;
+    ukv_docs_shred( //
+        db,
+        col,
+        2,
+        fields.data(),
+        sizeof(ukv_str_view_t),
+        types.data(),
+        sizeof(ukv_type_t),
+        columns.data(),
+        sizeof(ukv_col_t),
+        &error);
+    EXPECT_EQ(error, nullptr);
+
+    // Values, that don't fit into their columns, stay in the residual documents
+    col[1] = R"( {"person": "Davit", "age": 24, "height": 1.8} )";
+    col[2] = R"( {"person": "Ashot", "age": 300, "height": 2} )";
+    col[3] = R"( {"person": "Darvin", "age": 28} )";
+    EXPECT_EQ(*ages[1].length(), 1u);
+    EXPECT_EQ(*ages[2].length(), ukv_val_len_missing_k);
+    EXPECT_EQ(*heights[2].length(), ukv_val_len_missing_k);
+
+    // Documents are reassembled on reads
+    M_EXPECT_EQ_JSON(col[1].value()->c_str(), R"( {"person": "Davit", "age": 24, "height": 1.8} )");
+    M_EXPECT_EQ_JSON(col[2].value()->c_str(), R"( {"person": "Ashot", "age": 300, "height": 2} )");
+    M_EXPECT_EQ_JSON(col[ckf(3, "age")].value()->c_str(), "28");
+
+    // Gathering mixes exact and converted cells with members of residuals
+    docs_layout_t layout {4, 3};
+    for (ukv_key_t key = 1; key <= 4; ++key)
+        layout.index(key - 1) = col_key_t {col, key};
+    layout.header(0) = field_type_t {"age", ukv_type_u8_k};
+    layout.header(1) = field_type_t {"height", ukv_type_f32_k};
+    layout.header(2) = field_type_t {"person", ukv_type_str_k};
+    auto table = *col.as_table().gather(layout);
+    auto ages_column = table.column(0).as<std::uint8_t>();
+    auto heights_column = table.column(1).as<float>();
+    auto names_column = table.column(2).as<value_view_t>();
+    EXPECT_EQ(ages_column[0].value, 24);
+    EXPECT_FALSE(ages_column[0].converted);
+    EXPECT_EQ(ages_column[2].value, 28);
+    EXPECT_FALSE(ages_column[3].valid);
+    EXPECT_FLOAT_EQ(heights_column[0].value, 1.8f);
+    EXPECT_FLOAT_EQ(heights_column[1].value, 2.f);
+    EXPECT_TRUE(heights_column[1].converted);
+    EXPECT_FALSE(heights_column[2].valid);
+    EXPECT_STREQ(names_column[1].value.c_str(), "Ashot");
+
+    // Deleting documents removes their cells
+    EXPECT_TRUE(col[1].erase());
+    EXPECT_EQ(*ages[1].length(), ukv_val_len_missing_k);
+    EXPECT_EQ(*heights[1].length(), ukv_val_len_missing_k);
+
+    ukv_docs_shred(db, col, 0, nullptr, 0, nullptr, 0, nullptr, 0, &error);
+    EXPECT_EQ(error, nullptr);
+    EXPECT_TRUE(db.clear());
+}
+
+TEST(db, docs_index) {
+    db_t db;
+    EXPECT_TRUE(db.open(""));
+
+    col_t col = *db.collection("events", ukv_format_json_k);
+    col[1] = R"( {"user_id": 10, "time": 100} )";
+    col[2] = R"( {"user_id": 20, "time": 90} )";
+    col[3] = R"( {"user_id": 10, "time": 80} )";
+    col[4] = R"( {"user_id": "unknown"} )";
+
+    arena_t arena(db);
+    ukv_error_t error = nullptr;
+    ukv_size_t found_count = 0;
+    ukv_key_t* found_keys = nullptr;
+    auto find = [&](ukv_str_view_t field, std::int64_t min_value, std::int64_t max_value) {
+        ukv_docs_index_find( //
+            db,
+            nullptr,
+            col,
+            field,
+            min_value,
+            max_value,
+            ukv_options_default_k,
+            &found_count,
+            &found_keys,
+            arena.member_ptr(),
+            &error);
+        return std::vector<ukv_key_t>(found_keys, found_keys + (error ? 0 : found_count));
+    };
+
+    // Existing documents are indexed on creation
+    for (ukv_str_view_t field : {"user_id", "time"}) {
+        std::string name = std::string("events.") + field;
+        ukv_docs_index_create(db, nullptr, col, field, name.c_str(), ukv_options_default_k, arena.member_ptr(), &error);
+        EXPECT_EQ(error, nullptr);
+    }
+    EXPECT_EQ(find("user_id", 10, 10), (std::vector<ukv_key_t> {1, 3}));
+    EXPECT_EQ(find("time", 85, 1000), (std::vector<ukv_key_t> {2, 1}));
+
+    // Later writes, patches and deletions update the index
+    col[4] = R"( {"user_id": 10, "time": 95} )";
+    col.as(ukv_format_json_merge_patch_k);
+    col[1] = R"( {"user_id": 20} )";
+    EXPECT_TRUE(col[3].erase());
+    EXPECT_EQ(find("user_id", 10, 10), (std::vector<ukv_key_t> {4}));
+    EXPECT_EQ(find("user_id", 0, 100), (std::vector<ukv_key_t> {4, 1, 2}));
+    EXPECT_EQ(find("time", 85, 1000), (std::vector<ukv_key_t> {2, 4, 1}));
+
+    // Concurrent writers of the same value update the same list, but don't lose each other's keys
+    constexpr std::size_t threads_count_k = 4;
+    constexpr ukv_key_t keys_per_thread_k = 100;
+    std::vector<std::vector<ukv_key_t>> written(threads_count_k);
+    auto work = [&](std::size_t thread_idx) {
+        col_t thread_col = *db.collection("events", ukv_format_json_k);
+        ukv_key_t const first_key = 100 + static_cast<ukv_key_t>(thread_idx) * keys_per_thread_k;
+        for (ukv_key_t key = first_key; key != first_key + keys_per_thread_k; ++key)
+            if (thread_col[key].assign(R"( {"user_id": 30} )"))
+                written[thread_idx].push_back(key);
+    };
+    std::vector<std::thread> threads;
+    for (std::size_t thread_idx = 0; thread_idx != threads_count_k; ++thread_idx)
+        threads.emplace_back(work, thread_idx);
+    for (auto& thread : threads)
+        thread.join();
+    std::vector<ukv_key_t> expected;
+    for (auto const& keys : written)
+        expected.insert(expected.end(), keys.begin(), keys.end());
+    EXPECT_EQ(find("user_id", 30, 30), expected);
+    EXPECT_FALSE(expected.empty());
+
+    ukv_docs_index_drop(db, col, "user_id", &error);
+    EXPECT_EQ(error, nullptr);
+    find("user_id", 0, 1);
+    EXPECT_NE(error, nullptr);
+    ukv_error_free(error);
+    error = nullptr;
+    ukv_docs_index_drop(db, col, "time", &error);
+    EXPECT_EQ(error, nullptr);
+    EXPECT_TRUE(db.clear());
+}
+
+TEST(db, docs_patch_in_place) {
+    using json_t = nlohmann::json;
+    db_t db;
+    EXPECT_TRUE(db.open(""));
+
+    col_t col = *db.collection("", ukv_format_json_k);
+    col[1] = R"( {"name": "a", "stats": {"views": 5, "score": 1.5}, "flag": false} )";
+
+    // Scalars, that keep their encoding, are overwritten in place
+    col.as(ukv_format_json_merge_patch_k);
+    col[1] = R"( {"stats": {"views": 7}, "flag": true} )";
+    col.as(ukv_format_json_patch_k);
+    col[1] = R"( [{"op": "replace", "path": "/stats/score", "value": 2.5}] )";
+    col.as(ukv_format_json_k);
+    M_EXPECT_EQ_JSON(col[1].value()->c_str(), R"( {"name": "a", "stats": {"views": 7, "score": 2.5}, "flag": true} )");
+
+    // Wider values and new members take the generic path
+    col.as(ukv_format_json_merge_patch_k);
+    col[1] = R"( {"stats": {"views": 300}, "tags": 1} )";
+    col.as(ukv_format_json_k);
+    M_EXPECT_EQ_JSON(col[1].value()->c_str(),
+                     R"( {"name": "a", "stats": {"views": 300, "score": 2.5}, "flag": true, "tags": 1} )");
+
+    // Repeated increments are merged, missing documents are created
+    arena_t arena(db);
+    ukv_error_t error = nullptr;
+    ukv_col_t cols[3] = {col, col, col};
+    ukv_key_t keys[3] = {1, 1, 2};
+    ukv_str_view_t fields[3] = {"/stats/views", "/stats/views", "counter"};
+    std::int64_t deltas[3] = {1, 2, -3};
+    auto increment = [&](ukv_size_t count) {
+        ukv_docs_increment( //
+            db,
+            nullptr,
+            count,
+            cols,
+            sizeof(ukv_col_t),
+            keys,
+            sizeof(ukv_key_t),
+            fields,
+            sizeof(ukv_str_view_t),
+            deltas,
+            sizeof(std::int64_t),
+            ukv_options_default_k,
+            arena.member_ptr(),
+            &error);
+    };
+    increment(3);
+    EXPECT_EQ(error, nullptr);
+    M_EXPECT_EQ_JSON(col[1].value()->c_str(),
+                     R"( {"name": "a", "stats": {"views": 303, "score": 2.5}, "flag": true, "tags": 1} )");
+    M_EXPECT_EQ_JSON(col[2].value()->c_str(), R"( {"counter": -3} )");
+
+    // Only numbers can be incremented
+    fields[0] = "name";
+    increment(1);
+    EXPECT_NE(error, nullptr);
+    ukv_error_free(error);
+    EXPECT_TRUE(db.clear());
 }
 
 TEST(db, txn) {
@@ -483,7 +1528,388 @@ TEST(db, txn) {
 
     // Validate that values match after commit
     check_equalities(named_col_ref, values);
-    db.clear();
+    EXPECT_TRUE(db.clear());
+}
+
+TEST(db, txn_snapshot) {
+    db_t db;
+    EXPECT_TRUE(db.open(""));
+    col_t col = *db.collection();
+
+    std::vector<ukv_key_t> keys {64, 65, 66};
+    ukv_val_len_t val_len = sizeof(std::uint64_t);
+    std::vector<std::uint64_t> vals {64, 65, 66};
+    std::vector<ukv_val_len_t> offs {0, val_len, val_len * 2};
+    auto vals_begin = reinterpret_cast<ukv_val_ptr_t>(vals.data());
+
+    values_arg_t values {
+        .contents_begin = {&vals_begin, 0},
+        .offsets_begin = {offs.data(), sizeof(ukv_val_len_t)},
+        .lengths_begin = {&val_len, 0},
+    };
+    auto col_ref = col[keys];
+    EXPECT_TRUE(col_ref.assign(values));
+
+    EXPECT_TRUE(db.transact(true));
+    txn_t txn = *db.transact(true);
+    auto txn_ref = txn[keys];
+
+    // Overwrites of the HEAD state must not be visible through the snapshot
+    std::vector<std::uint64_t> newer_vals {164, 165, 166};
+    auto newer_vals_begin = reinterpret_cast<ukv_val_ptr_t>(newer_vals.data());
+    values_arg_t newer_values {
+        .contents_begin = {&newer_vals_begin, 0},
+        .offsets_begin = {offs.data(), sizeof(ukv_val_len_t)},
+        .lengths_begin = {&val_len, 0},
+    };
+    EXPECT_TRUE(col_ref.assign(newer_values));
+    check_equalities(col_ref, newer_values);
+    check_equalities(txn_ref, values);
+
+    // Neither should the removals or the newly inserted keys
+    EXPECT_TRUE(col_ref.erase());
+    check_length(col_ref, ukv_val_len_missing_k);
+    check_equalities(txn_ref, values);
+
+    std::vector<ukv_key_t> newer_keys {67, 68, 69};
+    EXPECT_TRUE(col[newer_keys].assign(values));
+    auto txn_newer_ref = txn[newer_keys];
+    check_length(txn_newer_ref, ukv_val_len_missing_k);
+
+    // Once restarted, the snapshot observes the latest state
+    txn.reset(true).throw_unhandled();
+    check_length(txn_ref, ukv_val_len_missing_k);
+    check_equalities(txn_newer_ref, values);
+    EXPECT_TRUE(db.clear());
+}
+
+TEST(db, txn_log) {
+    db_t db;
+    EXPECT_TRUE(db.open(""));
+    col_t col = *db.collection();
+    for (ukv_key_t key = 0; key != 10; ++key)
+        col[key] = "head";
+    for (ukv_key_t key = 100; key != 110; ++key)
+        col[key] = "head";
+
+    // Enough overwrites to outgrow the unsorted tail of the log many times
+    txn_t txn = *db.transact();
+    col_t txn_col(db, ukv_col_main_k, txn);
+    for (std::size_t round = 0; round != 3; ++round)
+        for (ukv_key_t key = 0; key != 100; ++key)
+            txn_col[key] = std::to_string(key * 10 + round).c_str();
+    for (ukv_key_t key = 0; key < 100; key += 3)
+        EXPECT_TRUE(txn_col[key].erase());
+    txn_col[99] = "revived";
+
+    auto expected = [](ukv_key_t key) -> std::string {
+        if (key >= 100)
+            return "head";
+        if (key == 99)
+            return "revived";
+        return key % 3 ? std::to_string(key * 10 + 2) : std::string();
+    };
+
+    // Scans merge the log with the collection, removals shadowing the committed keys
+    std::vector<ukv_key_t> expected_keys;
+    for (ukv_key_t key = 0; key != 110; ++key)
+        if (!expected(key).empty())
+            expected_keys.push_back(key);
+    std::vector<ukv_key_t> txn_keys;
+    for (ukv_key_t key : txn_col.keys())
+        txn_keys.push_back(key);
+    EXPECT_EQ(txn_keys, expected_keys);
+    for (ukv_key_t key = 0; key != 110; ++key)
+        EXPECT_EQ(*txn_col[key].value(), expected(key).c_str());
+
+    // The collection itself is untouched until the commit
+    EXPECT_EQ(*col[42].value(), "");
+    EXPECT_EQ(*col[3].value(), "head");
+
+    txn.commit().throw_unhandled();
+    std::vector<ukv_key_t> col_keys;
+    for (ukv_key_t key : col.keys())
+        col_keys.push_back(key);
+    EXPECT_EQ(col_keys, expected_keys);
+    for (ukv_key_t key = 0; key != 110; ++key)
+        EXPECT_EQ(*col[key].value(), expected(key).c_str());
+    EXPECT_TRUE(db.clear());
+}
+
+TEST(db, txn_large) {
+    db_t db;
+    EXPECT_TRUE(db.open(""));
+    col_t col = *db.collection();
+    col_t named_col = *db.collection("named_col");
+    constexpr ukv_key_t count_k = 40 * 1024;
+    for (ukv_key_t key = 0; key < count_k; key += 2)
+        col[key] = "head";
+
+    // More updates per collection than a single thread validates and applies
+    txn_t txn = *db.transact();
+    col_t txn_col(db, ukv_col_main_k, txn);
+    col_t txn_named_col(db, named_col, txn);
+    for (ukv_key_t key = 0; key != count_k; ++key) {
+        txn_col[key] = std::to_string(key).c_str();
+        txn_named_col[key] = std::to_string(-key).c_str();
+    }
+    for (ukv_key_t key = 0; key < count_k; key += 4)
+        EXPECT_TRUE(txn_col[key].erase());
+
+    // The overwritten versions stay visible to the snapshot
+    txn_t snapshot = *db.transact(true);
+    col_t snapshot_col(db, ukv_col_main_k, snapshot);
+    txn.commit().throw_unhandled();
+
+    for (ukv_key_t key = 0; key != count_k; ++key) {
+        EXPECT_EQ(*col[key].value(), key % 4 ? std::to_string(key).c_str() : "");
+        EXPECT_EQ(*named_col[key].value(), std::to_string(-key).c_str());
+    }
+    for (ukv_key_t key = 0; key != count_k; key += 1024)
+        EXPECT_EQ(*snapshot_col[key].value(), key % 2 ? "" : "head");
+    EXPECT_TRUE(db.clear());
+}
+
+TEST(db, txn_threads) {
+    db_t db;
+    EXPECT_TRUE(db.open(""));
+    constexpr std::size_t threads_count_k = 4;
+    constexpr ukv_key_t keys_per_thread_k = 500;
+    col_t shared_col = *db.collection();
+    std::vector<col_t> cols;
+    for (std::size_t thread_idx = 0; thread_idx != threads_count_k; ++thread_idx)
+        cols.push_back(*db.collection(("thread_" + std::to_string(thread_idx)).c_str()));
+
+    // Every thread writes into its own collection and commits into the shared one,
+    // so the commits lock overlapping sets of collections, but never collide on keys
+    auto work = [&](std::size_t thread_idx) {
+        col_t col = cols[thread_idx];
+        ukv_key_t const first_key = static_cast<ukv_key_t>(thread_idx) * keys_per_thread_k;
+        for (ukv_key_t key = first_key; key != first_key + keys_per_thread_k; ++key) {
+            col[key] = std::to_string(key).c_str();
+            EXPECT_EQ(*col[key].value(), std::to_string(key).c_str());
+
+            txn_t txn = *db.transact();
+            col_t txn_col(db, col, txn);
+            col_t txn_shared_col(db, shared_col, txn);
+            txn_col[key] = std::to_string(-key).c_str();
+            txn_shared_col[key] = std::to_string(key).c_str();
+            EXPECT_TRUE(txn.commit());
+            EXPECT_EQ(*col[key].value(), std::to_string(-key).c_str());
+
+            // Reads of the other threads' collections must not block or tear
+            col_t other_col = cols[(thread_idx + 1) % threads_count_k];
+            ukv_key_t const other_key = (key + keys_per_thread_k) % (threads_count_k * keys_per_thread_k);
+            auto other_value = *other_col[other_key].value();
+            EXPECT_TRUE(other_value.size() == 0 || other_value == std::to_string(other_key).c_str() ||
+                        other_value == std::to_string(-other_key).c_str());
+        }
+    };
+    std::vector<std::thread> threads;
+    for (std::size_t thread_idx = 0; thread_idx != threads_count_k; ++thread_idx)
+        threads.emplace_back(work, thread_idx);
+    for (auto& thread : threads)
+        thread.join();
+
+    for (std::size_t thread_idx = 0; thread_idx != threads_count_k; ++thread_idx) {
+        ukv_key_t const first_key = static_cast<ukv_key_t>(thread_idx) * keys_per_thread_k;
+        for (ukv_key_t key = first_key; key != first_key + keys_per_thread_k; ++key) {
+            EXPECT_EQ(*cols[thread_idx][key].value(), std::to_string(-key).c_str());
+            EXPECT_EQ(*shared_col[key].value(), std::to_string(key).c_str());
+        }
+    }
+    EXPECT_TRUE(db.clear());
+}
+
+TEST(db, metrics) {
+    using json_t = nlohmann::json;
+    db_t db;
+    EXPECT_TRUE(db.open(""));
+
+    // Counters aren't reset by clearing the DB, so only their increments are checked
+    ukv_str_view_t response = nullptr;
+    ukv_error_t error = nullptr;
+    ukv_db_control(db, "metrics", &response, &error);
+    ASSERT_EQ(error, nullptr);
+    json_t const before = json_t::parse(response);
+    auto grown = [&](json_t const& after, char const* path) {
+        json_t::json_pointer pointer {path};
+        return after.value(pointer, std::size_t(0)) - before.value(pointer, std::size_t(0));
+    };
+
+    col_t col = *db.collection();
+    col[42] = "answer";
+    col[43] = "question";
+    EXPECT_EQ(*col[42].value(), "answer");
+    EXPECT_EQ(*col[43].value(), "question");
+
+    // Two transactions update the same key, and only the first one commits
+    std::vector<ukv_key_t> keys {42};
+    std::uint64_t val = 0;
+    ukv_val_len_t val_len = sizeof(std::uint64_t);
+    auto vals_begin = reinterpret_cast<ukv_val_ptr_t>(&val);
+    values_arg_t values {
+        .contents_begin = {&vals_begin, 0},
+        .offsets_begin = {},
+        .lengths_begin = {&val_len, 0},
+    };
+    txn_t first = *db.transact();
+    txn_t second = *db.transact();
+    EXPECT_TRUE(first[keys].assign(values));
+    EXPECT_TRUE(second[keys].assign(values));
+    EXPECT_TRUE(first.commit());
+    EXPECT_FALSE(second.commit());
+    {
+        // Discarded updates count as an abort
+        txn_t discarded = *db.transact();
+        EXPECT_TRUE(discarded[keys].assign(values));
+    }
+
+    ukv_db_control(db, "metrics", &response, &error);
+    ASSERT_EQ(error, nullptr);
+    json_t metrics = json_t::parse(response);
+    EXPECT_GE(grown(metrics, "/ops/read/calls"), 2u);
+    EXPECT_GE(grown(metrics, "/ops/write/tasks"), 2u);
+    EXPECT_EQ(grown(metrics, "/ops/txn_commit/calls"), 2u);
+    EXPECT_EQ(grown(metrics, "/ops/txn_commit/failures"), 1u);
+    EXPECT_LE(metrics["ops"]["read"]["p50_ns"].get<std::size_t>(), metrics["ops"]["read"]["p99_ns"].get<std::size_t>());
+    EXPECT_EQ(grown(metrics, "/transactions/conflicts"), 1u);
+    EXPECT_EQ(grown(metrics, "/transactions/aborts"), 1u);
+    EXPECT_GE(grown(metrics, "/collections//read/calls"), 2u);
+
+    ukv_db_control(db, "metrics.prometheus", &response, &error);
+    ASSERT_EQ(error, nullptr);
+    std::string_view prometheus = response;
+    EXPECT_NE(prometheus.find("ukv_calls_total{op=\"read\"}"), std::string_view::npos);
+    auto conflicts = metrics["transactions"]["conflicts"].get<std::size_t>();
+    EXPECT_NE(prometheus.find("ukv_txn_conflicts_total " + std::to_string(conflicts)), std::string_view::npos);
+    EXPECT_TRUE(db.clear());
+}
+
+TEST(db, numa) {
+    db_t db;
+    EXPECT_TRUE(db.open(""));
+
+    ukv_str_view_t response = nullptr;
+    ukv_error_t error = nullptr;
+    ukv_db_control(db, "numa_node:0", &response, &error);
+    if (error) {
+        ukv_error_free(error);
+        GTEST_SKIP() << "NUMA placement isn't supported by this backend";
+    }
+    EXPECT_STREQ(response, "any");
+
+    // Node indexes wrap around, so the same config works on any host
+    col_t homed = *db.collection("homed", ukv_format_binary_k, R"({"numa_node": 1024})");
+    auto request = "numa_node:" + std::to_string(static_cast<ukv_col_t>(homed));
+    ukv_db_control(db, request.c_str(), &response, &error);
+    ASSERT_EQ(error, nullptr);
+    // Collections split between many shards have no single home
+    std::string_view node = response;
+    EXPECT_TRUE(node == "any" || (!node.empty() && std::isdigit(node.front())));
+    homed[42] = "answer";
+    EXPECT_EQ(*homed[42].value(), "answer");
+
+    EXPECT_TRUE(db.collection("auto", ukv_format_binary_k, R"({"numa_node": "auto"})"));
+    EXPECT_FALSE(db.collection("invalid", ukv_format_binary_k, R"({"numa_node": "remote"})"));
+    EXPECT_TRUE(db.clear());
+}
+
+/**
+ * @brief Mimics `std::coroutine_handle<>`, to check the awaitable protocol in C++17.
+ */
+struct resumable_t {
+    std::atomic<bool>* resumed = nullptr;
+    void* address() const noexcept { return resumed; }
+    static resumable_t from_address(void* address) noexcept {
+        return {reinterpret_cast<std::atomic<bool>*>(address)};
+    }
+    void resume() const noexcept { resumed->store(true); }
+};
+
+TEST(db, async) {
+    db_t db;
+    EXPECT_TRUE(db.open(""));
+    col_t col = *db.collection();
+
+    std::vector<ukv_key_t> keys(1000);
+    std::vector<std::uint64_t> vals(keys.size());
+    for (std::size_t i = 0; i != keys.size(); ++i)
+        keys[i] = static_cast<ukv_key_t>(i * 2), vals[i] = i;
+    ukv_val_len_t val_len = sizeof(std::uint64_t);
+    auto vals_begin = reinterpret_cast<ukv_val_ptr_t>(vals.data());
+    std::vector<ukv_val_len_t> offs(keys.size());
+    for (std::size_t i = 0; i != keys.size(); ++i)
+        offs[i] = static_cast<ukv_val_len_t>(i * sizeof(std::uint64_t));
+    values_arg_t values {
+        .contents_begin = {&vals_begin, 0},
+        .offsets_begin = {offs.data(), sizeof(ukv_val_len_t)},
+        .lengths_begin = {&val_len, 0},
+    };
+    EXPECT_TRUE(col.write_async(strided_range(keys).immutable(), values).get());
+
+    // Many reads in flight at once, each with its own arena
+    std::vector<async_gt<tape_view_t>> reads;
+    for (std::size_t i = 0; i != keys.size(); i += 10)
+        reads.push_back(col.read_async(strided_range(keys).immutable().subspan(i, 10)));
+    for (std::size_t i = 0; i != reads.size(); ++i) {
+        auto tape = reads[i].get();
+        ASSERT_TRUE(tape);
+        std::size_t j = i * 10;
+        for (value_view_t value : *tape)
+            EXPECT_EQ(*reinterpret_cast<std::uint64_t const*>(value.begin()), vals[j++]);
+        EXPECT_TRUE(reads[i].ready());
+    }
+
+    // Scans with polling
+    auto scan = col.scan_async(100, 5);
+    while (!scan.ready())
+        std::this_thread::yield();
+    auto found = *scan.get();
+    EXPECT_EQ(std::vector<ukv_key_t>(found.begin(), found.end()), (std::vector<ukv_key_t> {100, 102, 104, 106, 108}));
+    EXPECT_EQ(col.scan_async(1990, 100).get()->size(), 5ul);
+
+    // Awaiting suspends only, if the operation is still in flight
+    std::atomic<bool> resumed {false};
+    auto awaited = col.read_async(strided_range(keys).immutable());
+    if (!awaited.await_ready() && awaited.await_suspend(resumable_t {&resumed}))
+        while (!resumed.load())
+            std::this_thread::yield();
+    EXPECT_EQ(awaited.await_resume()->size(), keys.size());
+
+    // Plain C callbacks, without futures
+    std::atomic<std::size_t> completed {0};
+    arena_t arena(db);
+    ukv_error_t error = nullptr;
+    ukv_size_t scan_length = 3;
+    ukv_key_t* found_keys = nullptr;
+    ukv_val_len_t* found_lengths = nullptr;
+    ukv_scan_async(
+        db, nullptr, 1, nullptr, 0, keys.data(), 0, &scan_length, 0, ukv_options_default_k,
+        &found_keys, &found_lengths, arena,
+        [](void* counter, ukv_error_t) { ++*reinterpret_cast<std::atomic<std::size_t>*>(counter); },
+        &completed, nullptr, &error);
+    EXPECT_EQ(error, nullptr);
+
+    // Failures are reported on completion
+    txn_t txn = *db.transact();
+    EXPECT_TRUE(col.write_async(strided_range(keys).immutable(), values).get());
+    ukv_future_t future = nullptr;
+    arena_t txn_arena(db);
+    ukv_val_ptr_t found_values = nullptr;
+    ukv_val_len_t* found_offsets = nullptr;
+    ukv_val_len_t* found_values_lengths = nullptr;
+    ukv_read_async(db, txn, 1, nullptr, 0, keys.data(), 0, ukv_option_read_track_k, //
+                   &found_values, &found_offsets, &found_values_lengths, txn_arena, nullptr, nullptr, &future, &error);
+    EXPECT_EQ(error, nullptr);
+    ukv_future_wait(future, &error);
+    EXPECT_NE(error, nullptr);
+    EXPECT_TRUE(ukv_future_ready(future));
+    ukv_future_free(db, future);
+    while (!completed.load())
+        std::this_thread::yield();
+    EXPECT_EQ(std::vector<ukv_key_t>(found_keys, found_keys + 3), (std::vector<ukv_key_t> {0, 2, 4}));
+    EXPECT_TRUE(db.clear());
 }
 
 TEST(db, nested_docs) {
@@ -587,7 +2013,7 @@ TEST(db, net) {
     EXPECT_EQ(net.edges(vertex_to_remove)->size(), 2ul);
     EXPECT_EQ(net.edges(1, vertex_to_remove)->size(), 1ul);
     EXPECT_EQ(net.edges(vertex_to_remove, 1)->size(), 0ul);
-    db.clear();
+    EXPECT_TRUE(db.clear());
 }
 
 TEST(db, net_batch) {
@@ -681,10 +2107,352 @@ TEST(db, net_batch) {
     EXPECT_EQ(net.edges(vertex_to_remove)->size(), 2ul);
     EXPECT_EQ(net.edges(1, vertex_to_remove)->size(), 1ul);
     EXPECT_EQ(net.edges(vertex_to_remove, 1)->size(), 0ul);
-    db.clear();
+    EXPECT_TRUE(db.clear());
+}
+
+TEST(db, net_hub) {
+
+    db_t db;
+    EXPECT_TRUE(db.open(""));
+
+    col_t main = *db.collection();
+    graph_ref_t net = main.as_graph();
+
+    // A star, spanning several compressed chunks, with a few outliers among the IDs
+    ukv_key_t const hub = 0;
+    std::vector<edge_t> star;
+    for (ukv_key_t i = 1; i <= 5000; ++i)
+        star.push_back({hub, i * 3, i % 7 ? i : ukv_default_edge_id_k});
+    star.push_back({hub, -5, 1});
+    star.push_back({hub, std::numeric_limits<ukv_key_t>::max() - 1, -1});
+    star.push_back({-5, hub, 2});
+
+    EXPECT_TRUE(net.upsert(edges(star)));
+    EXPECT_EQ(*net.degree(hub), star.size());
+    EXPECT_EQ(*net.degree(hub, ukv_vertex_source_k), star.size() - 1);
+    EXPECT_EQ(*net.degree(hub, ukv_vertex_target_k), 1u);
+
+    auto exported = *net.edges(hub, ukv_vertex_source_k);
+    std::unordered_set<edge_t, edge_hash_t> expected_edges {star.begin(), star.end() - 1};
+    std::unordered_set<edge_t, edge_hash_t> exported_edges;
+    for (std::size_t i = 0; i != exported.size(); ++i)
+        exported_edges.insert(exported[i]);
+    EXPECT_EQ(exported_edges, expected_edges);
+
+    // Streaming insertions land into the middle of existing chunks
+    for (ukv_key_t i = 1; i <= 100; ++i) {
+        edge_t edge {hub, i * 30 + 1, i};
+        EXPECT_TRUE(net.upsert(edge));
+        EXPECT_TRUE(net.upsert(edge));
+        star.insert(star.end() - 1, edge);
+    }
+    EXPECT_EQ(*net.degree(hub), star.size());
+    EXPECT_EQ(net.edges(hub, 301)->size(), 1ul);
+
+    // Removing a vertex must patch the compressed list of the hub
+    EXPECT_TRUE(net.remove(ukv_key_t(-5)));
+    EXPECT_EQ(*net.degree(hub), star.size() - 2);
+    EXPECT_EQ(net.edges(hub, 3)->size(), 1ul);
+    EXPECT_EQ(net.edges(hub, 21)->size(), 1ul);
+    EXPECT_EQ((*net.edges(hub, 21))[0].id, ukv_default_edge_id_k);
+    EXPECT_TRUE(db.clear());
+}
+
+TEST(db, net_traverse) {
+
+    db_t db;
+    EXPECT_TRUE(db.open(""));
+
+    col_t main = *db.collection();
+    graph_ref_t net = main.as_graph();
+
+    // A chain with a shortcut: 1 -> 2 -> 3 -> 4 and 1 -> 5 -> 3
+    std::vector<edge_t> graph {
+        {1, 2, 12},
+        {2, 3, 23},
+        {3, 4, 34},
+        {1, 5, 15},
+        {5, 3, 53},
+    };
+    EXPECT_TRUE(net.upsert(edges(graph)));
+
+    std::vector<ukv_key_t> starts {1, 1, 100};
+    auto two_hops = *net.traverse(strided_range(starts).immutable(), 2);
+    EXPECT_EQ(std::vector<ukv_key_t>(two_hops.vertices.begin(), two_hops.vertices.end()),
+              (std::vector<ukv_key_t> {1, 2, 5, 3}));
+    EXPECT_EQ(std::vector<ukv_size_t>(two_hops.depths.begin(), two_hops.depths.end()),
+              (std::vector<ukv_size_t> {0, 1, 1, 2}));
+    EXPECT_EQ(two_hops.edges.size(), 3ul);
+    EXPECT_EQ(two_hops.edges[2], (edge_t {2, 3, 23}));
+
+    EXPECT_EQ(net.traverse(strided_range(starts).immutable(), 10)->vertices.size(), 5ul);
+    EXPECT_EQ(net.traverse(strided_range(starts).immutable(), 10, ukv_vertex_source_k, 2)->vertices.size(), 2ul);
+    EXPECT_EQ(net.traverse(strided_range(starts).immutable(), 0)->vertices.size(), 1ul);
+
+    // Walking backwards
+    ukv_key_t last = 4;
+    auto backwards = *net.traverse(strided_range_gt<ukv_key_t const> {&last}, 2, ukv_vertex_target_k);
+    EXPECT_EQ(std::vector<ukv_key_t>(backwards.vertices.begin(), backwards.vertices.end()),
+              (std::vector<ukv_key_t> {4, 3, 2, 5}));
+    EXPECT_TRUE(db.clear());
+}
+
+TEST(db, net_csr) {
+
+    db_t db;
+    EXPECT_TRUE(db.open(""));
+
+    col_t main = *db.collection();
+    graph_ref_t net = main.as_graph();
+
+    // A long chain, spanning many scans, and a hub with a few incoming edges
+    std::size_t const chain_length = 10'000;
+    std::vector<edge_t> graph;
+    for (std::size_t i = 0; i != chain_length; ++i)
+        graph.push_back(edge_t {ukv_key_t(i), ukv_key_t(i + 1), ukv_key_t(i * 10)});
+    for (ukv_key_t source : {3, 5, 7})
+        graph.push_back(edge_t {source, -1, source});
+    EXPECT_TRUE(net.upsert(edges(graph)));
+
+    auto outgoing = *net.export_csr(ukv_vertex_source_k, true);
+    EXPECT_EQ(outgoing.vertices.size(), chain_length + 2);
+    EXPECT_EQ(outgoing.vertices[0], -1);
+    EXPECT_EQ(outgoing.offsets[1], 0ul);
+    EXPECT_EQ(outgoing.neighbors.size(), graph.size());
+    EXPECT_EQ(outgoing.offsets[outgoing.vertices.size()], graph.size());
+
+    // Vertex 3 links to the hub and the next one in the chain
+    ukv_size_t begin = outgoing.offsets[4], end = outgoing.offsets[5];
+    EXPECT_EQ(outgoing.vertices[4], 3);
+    EXPECT_EQ(end - begin, 2ul);
+    EXPECT_EQ(outgoing.neighbors[begin], -1);
+    EXPECT_EQ(outgoing.neighbors[begin + 1], 4);
+    EXPECT_EQ(outgoing.edges[begin + 1], 30);
+
+    auto hub = *net.export_csr(ukv_vertex_target_k, false, -1, 0);
+    EXPECT_EQ(hub.vertices.size(), 1ul);
+    EXPECT_EQ(std::vector<ukv_key_t>(hub.neighbors.begin(), hub.neighbors.end()), (std::vector<ukv_key_t> {3, 5, 7}));
+    EXPECT_EQ(hub.edges.size(), 0ul);
+
+    auto both = *net.export_csr(ukv_vertex_role_any_k);
+    EXPECT_EQ(both.neighbors.size(), graph.size() * 2);
+    EXPECT_TRUE(db.clear());
+}
+
+TEST(db, arrow_export) {
+    db_t db;
+    EXPECT_TRUE(db.open(""));
+
+    col_t main = *db.collection();
+    main[1] = "a";
+    main[2] = "bb";
+    main[4] = "dddd";
+
+    col_t docs = *db.collection("docs", ukv_format_json_k);
+    docs[1] = R"( { "person": "Ashot", "age": 27, "alive": true } )";
+    docs[2] = R"( { "person": "Darvin", "age": 24 } )";
+    docs[3] = R"( { "person": "Davit", "alive": false } )";
+
+    ukv_error_t error = nullptr;
+    ukv_arena_t arena = nullptr;
+    ArrowSchema schema;
+    ArrowArray array;
+
+    // Binary values, with missing ones becoming nulls
+    {
+        ukv_key_t keys[4] {1, 2, 3, 4};
+        ukv_val_ptr_t values = nullptr;
+        ukv_val_len_t* offsets = nullptr;
+        ukv_val_len_t* lengths = nullptr;
+        ukv_read(db, nullptr, 4, main.member_ptr(), 0, keys, sizeof(ukv_key_t), //
+                 ukv_options_default_k, &values, &offsets, &lengths, &arena, &error);
+        ASSERT_EQ(error, nullptr);
+
+        ukv_to_arrow_values(db, 4, values, offsets, lengths, "value", &schema, &array, &arena, &error);
+        ASSERT_EQ(error, nullptr);
+        EXPECT_EQ(arena, nullptr);
+        EXPECT_STREQ(schema.format, "z");
+        EXPECT_STREQ(schema.name, "value");
+        EXPECT_EQ(array.length, 4);
+        EXPECT_EQ(array.null_count, 1);
+
+        auto validity = static_cast<std::uint8_t const*>(array.buffers[0]);
+        auto arrow_offsets = static_cast<std::int32_t const*>(array.buffers[1]);
+        auto contents = static_cast<char const*>(array.buffers[2]);
+        EXPECT_EQ(validity[0], 0b1011);
+        EXPECT_EQ(std::vector<std::int32_t>(arrow_offsets, arrow_offsets + 5),
+                  (std::vector<std::int32_t> {0, 1, 3, 3, 7}));
+        EXPECT_EQ(std::string(contents, 7), "abbdddd");
+        schema.release(&schema);
+        array.release(&array);
+        EXPECT_EQ(array.release, nullptr);
+    }
+
+    // Gathered columns, sharing the memory of the arena
+    {
+        ukv_key_t keys[3] {1, 2, 3};
+        ukv_str_view_t fields[3] {"age", "person", "alive"};
+        ukv_type_t types[3] {ukv_type_i32_k, ukv_type_str_k, ukv_type_bool_k};
+        ukv_1x8_t** validities = nullptr;
+        ukv_1x8_t** conversions = nullptr;
+        ukv_1x8_t** collisions = nullptr;
+        ukv_val_ptr_t* scalars = nullptr;
+        ukv_val_len_t** offsets = nullptr;
+        ukv_val_len_t** lengths = nullptr;
+        ukv_val_ptr_t strings = nullptr;
+        ukv_docs_gather(db, nullptr, 3, 3, docs.member_ptr(), 0, keys, sizeof(ukv_key_t), //
+                        fields, sizeof(ukv_str_view_t), types, sizeof(ukv_type_t), ukv_options_default_k,
+                        &validities, &conversions, &collisions, &scalars, &offsets, &lengths, &strings,
+                        &arena, &error);
+        ASSERT_EQ(error, nullptr);
+
+        ukv_to_arrow_table(db, 3, 3, fields, sizeof(ukv_str_view_t), types, sizeof(ukv_type_t), //
+                           validities, scalars, offsets, lengths, strings, &schema, &array, &arena, &error);
+        ASSERT_EQ(error, nullptr);
+        EXPECT_STREQ(schema.format, "+s");
+        ASSERT_EQ(schema.n_children, 3);
+        EXPECT_STREQ(schema.children[1]->name, "person");
+        EXPECT_STREQ(schema.children[1]->format, "u");
+        EXPECT_STREQ(schema.children[2]->format, "b");
+        ASSERT_EQ(array.n_children, 3);
+
+        ArrowArray const& ages = *array.children[0];
+        EXPECT_EQ(ages.buffers[0], validities[0]);
+        EXPECT_EQ(ages.buffers[1], scalars[0]);
+        EXPECT_EQ(static_cast<std::int32_t const*>(ages.buffers[1])[1], 24);
+        EXPECT_EQ(static_cast<std::uint8_t const*>(ages.buffers[0])[0] & 0b111, 0b011);
+
+        ArrowArray const& names = *array.children[1];
+        auto names_offsets = static_cast<std::int32_t const*>(names.buffers[1]);
+        auto names_contents = static_cast<char const*>(names.buffers[2]);
+        EXPECT_EQ(std::vector<std::int32_t>(names_offsets, names_offsets + 4),
+                  (std::vector<std::int32_t> {0, 5, 11, 16}));
+        EXPECT_EQ(std::string(names_contents, 16), "AshotDarvinDavit");
+
+        ArrowArray const& alive = *array.children[2];
+        EXPECT_EQ(static_cast<std::uint8_t const*>(alive.buffers[0])[0] & 0b111, 0b101);
+        EXPECT_EQ(static_cast<std::uint8_t const*>(alive.buffers[1])[0] & 0b101, 0b001);
+        schema.release(&schema);
+        array.release(&array);
+    }
+
+    // Batches of binary values and gathered fields
+    {
+        ArrowArrayStream stream;
+        ukv_to_arrow_stream(db, nullptr, main, 0, 4, 2, 0, nullptr, 0, nullptr, 0, &stream, &error);
+        ASSERT_EQ(error, nullptr);
+        ASSERT_EQ(stream.get_schema(&stream, &schema), 0);
+        EXPECT_EQ(schema.n_children, 2);
+        schema.release(&schema);
+
+        std::vector<ukv_key_t> exported_keys;
+        std::vector<std::size_t> batches_lengths;
+        while (stream.get_next(&stream, &array) == 0 && array.release) {
+            ArrowArray const& keys = *array.children[0];
+            auto begin = static_cast<ukv_key_t const*>(keys.buffers[1]);
+            exported_keys.insert(exported_keys.end(), begin, begin + keys.length);
+            batches_lengths.push_back(array.length);
+            array.release(&array);
+        }
+        EXPECT_EQ(exported_keys, (std::vector<ukv_key_t> {1, 2}));
+        EXPECT_EQ(batches_lengths, (std::vector<std::size_t> {2}));
+        stream.release(&stream);
+
+        ukv_str_view_t field = "person";
+        ukv_type_t type = ukv_type_str_k;
+        ukv_to_arrow_stream(db, nullptr, docs, 0, ukv_key_unknown_k, 2, 1, &field, 0, &type, 0, &stream, &error);
+        ASSERT_EQ(error, nullptr);
+        std::string exported_names;
+        while (stream.get_next(&stream, &array) == 0 && array.release) {
+            ArrowArray const& names = *array.children[1];
+            auto offsets = static_cast<std::int32_t const*>(names.buffers[1]);
+            exported_names.append(static_cast<char const*>(names.buffers[2]), offsets[names.length]);
+            array.release(&array);
+        }
+        EXPECT_EQ(exported_names, "AshotDarvinDavit");
+        stream.release(&stream);
+    }
+    EXPECT_TRUE(db.clear());
 }
 
+TEST(db, tensor) {
+    db_t db;
+    EXPECT_TRUE(db.open(""));
+    col_t main = *db.collection();
+
+    // Ten rows of four floats each, written in one batch
+    constexpr std::size_t rows_k = 10, columns_k = 4;
+    std::vector<float> rows(rows_k * columns_k);
+    std::iota(rows.begin(), rows.end(), 0.f);
+    std::vector<ukv_key_t> keys(rows_k);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::vector<ukv_val_len_t> offsets(rows_k);
+    for (std::size_t i = 0; i != rows_k; ++i)
+        offsets[i] = static_cast<ukv_val_len_t>(i * columns_k * sizeof(float));
+    auto rows_begin = reinterpret_cast<ukv_val_ptr_t>(rows.data());
+    ukv_val_len_t row_length = columns_k * sizeof(float);
+
+    ukv_error_t error = nullptr;
+    ukv_arena_t arena = nullptr;
+    ukv_write(db, nullptr, rows_k, main.member_ptr(), 0, keys.data(), sizeof(ukv_key_t), //
+              &rows_begin, 0, offsets.data(), sizeof(ukv_val_len_t), &row_length, 0,
+              ukv_options_default_k, &arena, &error);
+    ASSERT_EQ(error, nullptr);
+
+    // Gathering in reverse order into the caller's memory
+    std::vector<ukv_key_t> reversed(keys.rbegin(), keys.rend());
+    std::vector<float> tensor(rows_k * columns_k);
+    auto tensor_begin = reinterpret_cast<ukv_val_ptr_t>(tensor.data());
+    ukv_read_tensor(db, nullptr, rows_k, main.member_ptr(), 0, reversed.data(), sizeof(ukv_key_t), //
+                    ukv_options_default_k, &row_length, &tensor_begin, &arena, &error);
+    ASSERT_EQ(error, nullptr);
+    EXPECT_EQ(tensor_begin, reinterpret_cast<ukv_val_ptr_t>(tensor.data()));
+    for (std::size_t i = 0; i != rows_k; ++i)
+        EXPECT_EQ(tensor[i * columns_k + 1], rows[(rows_k - 1 - i) * columns_k + 1]);
+
+    // Inferring the row length and exporting the tensor in the arena
+    ukv_val_len_t inferred_length = 0;
+    ukv_val_ptr_t exported = nullptr;
+    ukv_read_tensor(db, nullptr, rows_k, main.member_ptr(), 0, keys.data(), sizeof(ukv_key_t), //
+                    ukv_options_default_k, &inferred_length, &exported, &arena, &error);
+    ASSERT_EQ(error, nullptr);
+    ASSERT_NE(exported, nullptr);
+    EXPECT_EQ(inferred_length, row_length);
+    EXPECT_EQ(std::memcmp(exported, rows.data(), rows.size() * sizeof(float)), 0);
+
+    // Missing values and different lengths are rejected
+    ukv_key_t missing_keys[2] {0, 100};
+    ukv_read_tensor(db, nullptr, 2, main.member_ptr(), 0, missing_keys, sizeof(ukv_key_t), //
+                    ukv_options_default_k, &row_length, &tensor_begin, &arena, &error);
+    EXPECT_NE(error, nullptr);
+    ukv_error_free(error);
+    error = nullptr;
+
+    main[100] = "short";
+    inferred_length = 0;
+    exported = nullptr;
+    ukv_read_tensor(db, nullptr, 2, main.member_ptr(), 0, missing_keys, sizeof(ukv_key_t), //
+                    ukv_options_default_k, &inferred_length, &exported, &arena, &error);
+    EXPECT_NE(error, nullptr);
+    ukv_error_free(error);
+    ukv_arena_free(db, arena);
+    EXPECT_TRUE(db.clear());
+}
+
+/**
+ * @brief Clears the DB before every test. Remote backends share one server between
+ * tests, so the entries of a test, that failed half-way, would break the next ones.
+ */
+struct clear_db_listener_t : public ::testing::EmptyTestEventListener {
+    void OnTestStart(::testing::TestInfo const&) override {
+        db_t db;
+        ASSERT_TRUE(db.open(""));
+        EXPECT_TRUE(db.clear());
+    }
+};
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
+    ::testing::UnitTest::GetInstance()->listeners().Append(new clear_db_listener_t);
     return RUN_ALL_TESTS();
 }
\ No newline at end of file
@@ -0,0 +1,202 @@
+/**
+ * @file txn_log.hpp
+ * @author Ashot Vardanian
+ *
+ * @brief Flat buffers of the uncommitted state of a transaction.
+ * Instead of a node and a buffer per key, a transaction appends its updates into
+ * a single tape, indexed by a vector of fixed-size entries, and its tracked reads
+ * into another vector. Both are sorted lazily, only when ordered access is needed,
+ * so committing becomes a merge of two sorted sequences: the updates and the collection.
+ */
+#pragma once
+#include <vector>    // `std::vector`
+#include <algorithm> // `std::stable_sort`, `std::max`
+
+#include "helpers.hpp"
+
+namespace unum::ukv {
+
+/**
+ * @brief Append-only log of upserts and removals.
+ * Later entries shadow the earlier ones of the same key. On `sort`, the unsorted tail
+ * is merged into the sorted prefix, keeping only the newest entry of every key, and the
+ * bytes of the shadowed values are reclaimed, once they make up most of the tape.
+ */
+class txn_log_t {
+  public:
+    struct entry_t {
+        col_key_t location;
+        std::size_t offset;
+        /// Equal to `ukv_val_len_missing_k` for removals.
+        ukv_val_len_t length;
+    };
+
+  private:
+    buffer_t tape_;
+    std::vector<entry_t> entries_;
+    /// Length of the sorted prefix of `entries_`, with a single entry per location.
+    std::size_t sorted_ = 0;
+
+    /// Point lookups scan this many unsorted entries, before sorting them.
+    static constexpr std::size_t unsorted_scan_limit_k = 32;
+
+    void compact() noexcept {
+        std::size_t live_bytes = 0;
+        for (entry_t const& entry : entries_)
+            live_bytes += entry.length != ukv_val_len_missing_k ? entry.length : 0;
+        if (tape_.size() <= live_bytes * 2 + 4096)
+            return;
+
+        buffer_t tape;
+        try {
+            tape.reserve(live_bytes);
+        }
+        catch (...) {
+            // Keeping the garbage is better than failing
+            return;
+        }
+        for (entry_t& entry : entries_) {
+            if (entry.length == ukv_val_len_missing_k)
+                continue;
+            auto begin = tape_.begin() + entry.offset;
+            entry.offset = tape.size();
+            tape.insert(tape.end(), begin, begin + entry.length);
+        }
+        tape_ = std::move(tape);
+    }
+
+    /// Grows geometrically, so that the following `push_back` can't fail after the tape was appended.
+    void reserve_entry() {
+        if (entries_.size() == entries_.capacity())
+            entries_.reserve(std::max<std::size_t>(entries_.capacity() * 2, entries_.size() + 1));
+    }
+
+  public:
+    void clear() noexcept {
+        tape_.clear();
+        entries_.clear();
+        sorted_ = 0;
+    }
+
+    bool empty() const noexcept { return entries_.empty(); }
+    /// Is only exact after `sort`, as the shadowed entries are counted otherwise.
+    std::size_t size() const noexcept { return entries_.size(); }
+
+    void upsert(col_key_t location, value_view_t value) {
+        reserve_entry();
+        std::size_t const offset = tape_.size();
+        tape_.insert(tape_.end(), value.begin(), value.end());
+        entries_.push_back({location, offset, static_cast<ukv_val_len_t>(value.size())});
+    }
+
+    void remove(col_key_t location) {
+        reserve_entry();
+        entries_.push_back({location, tape_.size(), ukv_val_len_missing_k});
+    }
+
+    /// The value of an entry, which evaluates to false for removals.
+    value_view_t value(entry_t const& entry) const noexcept {
+        ukv_val_ptr_t begin = reinterpret_cast<ukv_val_ptr_t>(const_cast<byte_t*>(tape_.data() + entry.offset));
+        return {begin, entry.length};
+    }
+
+    /// Merges the unsorted tail into the sorted prefix, newer entries replacing the older ones.
+    void sort() noexcept {
+        if (sorted_ == entries_.size())
+            return;
+
+        auto less = [](entry_t const& a, entry_t const& b) noexcept { return a.location < b.location; };
+        auto middle = entries_.begin() + sorted_;
+        std::stable_sort(middle, entries_.end(), less);
+        std::inplace_merge(entries_.begin(), middle, entries_.end(), less);
+
+        // Equal locations are now in the order of writes, so the last one wins
+        std::size_t count = 0;
+        for (std::size_t i = 0; i != entries_.size(); ++i)
+            if (i + 1 == entries_.size() || entries_[i + 1].location != entries_[i].location)
+                entries_[count++] = entries_[i];
+        entries_.resize(count);
+        sorted_ = count;
+        compact();
+    }
+
+    /// The newest entry for the @p location, or NULL, if the transaction hasn't touched it.
+    entry_t const* find(col_key_t location) noexcept {
+        if (entries_.size() - sorted_ > unsorted_scan_limit_k)
+            sort();
+        for (std::size_t i = entries_.size(); i != sorted_; --i)
+            if (entries_[i - 1].location == location)
+                return &entries_[i - 1];
+
+        auto end = entries_.begin() + sorted_;
+        auto it = std::lower_bound(entries_.begin(), end, location, [](entry_t const& entry, col_key_t location) {
+            return entry.location < location;
+        });
+        return it != end && it->location == location ? &*it : nullptr;
+    }
+
+    /// Entries come in the order of writes, and after `sort` in the order of locations.
+    entry_t const* begin() const noexcept { return entries_.data(); }
+    entry_t const* end() const noexcept { return entries_.data() + entries_.size(); }
+    entry_t const* lower_bound(col_key_t location) const noexcept {
+        return std::lower_bound(begin(), end(), location, [](entry_t const& entry, col_key_t location) {
+            return entry.location < location;
+        });
+    }
+};
+
+/**
+ * @brief Keys read by a transaction, with the generations it has observed.
+ * Duplicates are allowed until the vector is sorted, which keeps the first
+ * observation of every key, as later reads of it are validated against it anyway.
+ */
+class txn_reads_t {
+  public:
+    struct read_t {
+        col_key_t location;
+        generation_t generation;
+    };
+
+  private:
+    std::vector<read_t> reads_;
+    std::size_t sorted_ = 0;
+
+  public:
+    void clear() noexcept {
+        reads_.clear();
+        sorted_ = 0;
+    }
+
+    bool empty() const noexcept { return reads_.empty(); }
+    std::size_t size() const noexcept { return reads_.size(); }
+
+    void push(col_key_t location, generation_t generation) {
+        // Re-reading the same keys shouldn't grow the memory usage indefinitely
+        if (reads_.size() == reads_.capacity() && reads_.size() >= sorted_ * 2 + 1024)
+            sort();
+        reads_.push_back({location, generation});
+    }
+
+    void sort() noexcept {
+        if (sorted_ == reads_.size())
+            return;
+
+        auto less = [](read_t const& a, read_t const& b) noexcept { return a.location < b.location; };
+        auto middle = reads_.begin() + sorted_;
+        std::stable_sort(middle, reads_.end(), less);
+        std::inplace_merge(reads_.begin(), middle, reads_.end(), less);
+
+        std::size_t count = 0;
+        for (std::size_t i = 0; i != reads_.size(); ++i)
+            if (!count || reads_[count - 1].location != reads_[i].location)
+                reads_[count++] = reads_[i];
+        reads_.resize(count);
+        sorted_ = count;
+    }
+
+    /// Must only be used after `sort`.
+    read_t const* begin() const noexcept { return reads_.data(); }
+    read_t const* end() const noexcept { return reads_.data() + reads_.size(); }
+};
+
+} // namespace unum::ukv
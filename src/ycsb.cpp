@@ -0,0 +1,438 @@
+/**
+ * @file ycsb.cpp
+ * @author Ashot Vardanian
+ * @date 2022-08-18
+ *
+ * @brief Yahoo! Cloud Serving Benchmark workloads, driven natively through the C++ SDK.
+ * Like `bench.cpp`, is linked against every backend, producing `ukv_ycsb`,
+ * `ukv_leveldb_ycsb` and `ukv_rocksdb_ycsb`.
+ *
+ * The run consists of two phases, just like in the original YCSB:
+ * 1. "load" inserts `records` entries in batches of 1024.
+ * 2. "run" executes `operations` picked from the mix, split between `threads` workers.
+ *
+ * Every call goes through `members_ref_gt`, addressing `batch` keys at once.
+ * With `--batch=1` it becomes the single-key mode of YCSB, so both modes can be compared
+ * on the same backend. In batched mode latencies are reported per call, not per key.
+ *
+ * @section Workloads
+ * The `--workload=` presets replicate the core workloads of YCSB:
+ *      A: 50% reads, 50% updates, Zipfian.
+ *      B: 95% reads, 5% updates, Zipfian.
+ *      C: 100% reads, Zipfian.
+ *      D: 95% reads, 5% inserts, Latest.
+ *      E: 95% scans, 5% inserts, Zipfian.
+ *      F: 50% reads, 50% read-modify-writes, Zipfian.
+ * Every parameter of the preset can be overridden afterwards:
+ *      ./ukv_ycsb --workload=a --threads=8 --batch=16 --distribution=uniform
+ *      ./ukv_rocksdb_ycsb --workload=e --scan_length=50 --config=/mnt/nvme/rocksdb/
+ *
+ * @section Output
+ * Follows the format of YCSB measurements, so the existing tooling can parse it:
+ *      [READ], Operations, 500000
+ *      [READ], 99thPercentileLatency(us), 12
+ */
+
+#include <cctype>  // `std::tolower`
+#include <cmath>   // `std::pow`
+#include <cstdio>  // `std::printf`
+#include <cstdlib> // `std::strtod`
+#include <chrono>  // `std::chrono::steady_clock`
+#include <random>  // `std::mt19937_64`
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ukv/ukv.hpp"
+#include "metrics.hpp" // `op_metrics_t`
+
+using namespace unum::ukv;
+using namespace unum;
+
+enum class ycsb_op_t : std::uint8_t {
+    read_k = 0,
+    update_k,
+    insert_k,
+    scan_k,
+    rmw_k,
+};
+
+static constexpr std::size_t ycsb_ops_k = 5;
+static constexpr char const* ycsb_op_names_k[ycsb_ops_k] = {"READ", "UPDATE", "INSERT", "SCAN", "READ-MODIFY-WRITE"};
+
+enum class distribution_t {
+    uniform_k,
+    zipfian_k,
+    latest_k,
+};
+
+struct ycsb_config_t {
+    std::string config;
+    std::size_t records = 1'000'000;
+    std::size_t operations = 1'000'000;
+    std::size_t threads = 1;
+    std::size_t batch = 1;
+    std::size_t value_length = 1000;
+    std::size_t scan_length = 100;
+    distribution_t distribution = distribution_t::zipfian_k;
+    double proportions[ycsb_ops_k] = {1, 0, 0, 0, 0};
+    bool transactional = false;
+};
+
+/**
+ * @brief Zipfian generator from "Quickly Generating Billion-Record Synthetic Databases"
+ * by Gray et al., with the same constant as in YCSB. The popular items are scattered
+ * across the keyspace with a hash, like in the "scrambled" YCSB generator.
+ */
+class zipfian_t {
+    static constexpr double theta_k = 0.99;
+    std::size_t count_ = 0;
+    double alpha_ = 0;
+    double zeta_n_ = 0;
+    double eta_ = 0;
+    double half_pow_theta_ = 0;
+
+  public:
+    zipfian_t(std::size_t count) noexcept : count_(count) {
+        double zeta_2 = 0;
+        for (std::size_t i = 1; i <= count; ++i) {
+            zeta_n_ += 1 / std::pow(double(i), theta_k);
+            if (i == 2)
+                zeta_2 = zeta_n_;
+        }
+        alpha_ = 1 / (1 - theta_k);
+        eta_ = (1 - std::pow(2.0 / count, 1 - theta_k)) / (1 - zeta_2 / zeta_n_);
+        half_pow_theta_ = 1 + std::pow(0.5, theta_k);
+    }
+
+    /// Rank of the item, where zero is the most popular one.
+    template <typename generator_at>
+    std::size_t rank(generator_at& generator) const noexcept {
+        double u = std::uniform_real_distribution<double>(0, 1)(generator);
+        double uz = u * zeta_n_;
+        if (uz < 1)
+            return 0;
+        if (uz < half_pow_theta_)
+            return 1;
+        auto result = static_cast<std::size_t>(count_ * std::pow(eta_ * u - eta_ + 1, alpha_));
+        return std::min(result, count_ - 1);
+    }
+};
+
+inline std::uint64_t fnv_hash(std::uint64_t value) noexcept {
+    std::uint64_t hash = 0xCBF29CE484222325ull;
+    for (std::size_t i = 0; i != 8; ++i, value >>= 8)
+        hash = (hash ^ (value & 0xFF)) * 0x100000001B3ull;
+    return hash;
+}
+
+/**
+ * @brief Picks keys of existing records for every thread.
+ * The "latest" distribution is anchored to the shared number of inserted records.
+ */
+class key_chooser_t {
+    ycsb_config_t const& config_;
+    zipfian_t const& zipfian_;
+    std::atomic<std::size_t> const& inserted_;
+    std::mt19937_64 generator_;
+
+  public:
+    key_chooser_t(ycsb_config_t const& config,
+                  zipfian_t const& zipfian,
+                  std::atomic<std::size_t> const& inserted,
+                  std::uint64_t seed) noexcept
+        : config_(config), zipfian_(zipfian), inserted_(inserted), generator_(seed) {}
+
+    ukv_key_t next() noexcept {
+        std::size_t count = inserted_.load(std::memory_order_relaxed);
+        switch (config_.distribution) {
+        case distribution_t::uniform_k: return std::uniform_int_distribution<ukv_key_t>(0, count - 1)(generator_);
+        case distribution_t::zipfian_k: return static_cast<ukv_key_t>(fnv_hash(zipfian_.rank(generator_)) % count);
+        case distribution_t::latest_k:
+        default: return static_cast<ukv_key_t>(count - 1 - std::min(zipfian_.rank(generator_), count - 1));
+        }
+    }
+
+    ycsb_op_t next_op() noexcept {
+        double u = std::uniform_real_distribution<double>(0, 1)(generator_);
+        for (std::size_t i = 0; i != ycsb_ops_k; ++i)
+            if ((u -= config_.proportions[i]) < 0)
+                return static_cast<ycsb_op_t>(i);
+        return ycsb_op_t::read_k;
+    }
+
+    std::size_t next_scan_length() noexcept {
+        return std::uniform_int_distribution<std::size_t>(1, config_.scan_length)(generator_);
+    }
+};
+
+struct ycsb_results_t {
+    op_metrics_t ops[ycsb_ops_k];
+};
+
+bool parse_workload(char preset, ycsb_config_t& config) {
+    double* p = config.proportions;
+    std::fill(p, p + ycsb_ops_k, 0);
+    config.distribution = distribution_t::zipfian_k;
+    switch (preset) {
+    case 'a': p[0] = 0.5, p[1] = 0.5; break;
+    case 'b': p[0] = 0.95, p[1] = 0.05; break;
+    case 'c': p[0] = 1; break;
+    case 'd': p[0] = 0.95, p[2] = 0.05, config.distribution = distribution_t::latest_k; break;
+    case 'e': p[3] = 0.95, p[2] = 0.05; break;
+    case 'f': p[0] = 0.5, p[4] = 0.5; break;
+    default: return false;
+    }
+    return true;
+}
+
+bool parse_args(int argc, char** argv, ycsb_config_t& config) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto eq = arg.find('=');
+        std::string name = arg.substr(0, eq);
+        std::string value = eq == std::string::npos ? "" : arg.substr(eq + 1);
+        auto number = [&] { return static_cast<std::size_t>(std::strtoull(value.c_str(), nullptr, 10)); };
+        auto share = [&] { return std::strtod(value.c_str(), nullptr); };
+
+        if (name == "--workload" && value.size() == 1 && parse_workload(std::tolower(value[0]), config))
+            continue;
+        else if (name == "--config")
+            config.config = value;
+        else if (name == "--records")
+            config.records = number();
+        else if (name == "--operations")
+            config.operations = number();
+        else if (name == "--threads")
+            config.threads = number();
+        else if (name == "--batch")
+            config.batch = number();
+        else if (name == "--value_length")
+            config.value_length = number();
+        else if (name == "--scan_length")
+            config.scan_length = number();
+        else if (name == "--read")
+            config.proportions[0] = share();
+        else if (name == "--update")
+            config.proportions[1] = share();
+        else if (name == "--insert")
+            config.proportions[2] = share();
+        else if (name == "--scan")
+            config.proportions[3] = share();
+        else if (name == "--rmw")
+            config.proportions[4] = share();
+        else if (name == "--transactional")
+            config.transactional = true;
+        else if (name == "--distribution" && value == "uniform")
+            config.distribution = distribution_t::uniform_k;
+        else if (name == "--distribution" && value == "zipfian")
+            config.distribution = distribution_t::zipfian_k;
+        else if (name == "--distribution" && value == "latest")
+            config.distribution = distribution_t::latest_k;
+        else {
+            std::fprintf(stderr, "Unrecognized argument: %s\n", argv[i]);
+            return false;
+        }
+    }
+
+    double total = 0;
+    for (double share : config.proportions)
+        total += share;
+    if (!config.records || !config.threads || !config.batch || !config.scan_length || total <= 0) {
+        std::fprintf(stderr, "Records, threads, batch, scan length and the mix must be positive!\n");
+        return false;
+    }
+    for (double& share : config.proportions)
+        share /= total;
+    return true;
+}
+
+/**
+ * @brief Executes a share of the "run" phase in one thread.
+ * Each batch either goes straight to the HEAD, or through its own transaction.
+ */
+void run_worker(db_t& db,
+                ycsb_config_t const& config,
+                zipfian_t const& zipfian,
+                std::atomic<std::size_t>& next_insert,
+                std::atomic<std::size_t>& inserted,
+                std::size_t thread_idx,
+                std::size_t batches,
+                ycsb_results_t& results) {
+
+    key_chooser_t chooser {config, zipfian, inserted, 42 + thread_idx};
+    std::vector<ukv_key_t> keys(config.batch);
+    std::string value(config.value_length, '\0');
+    std::mt19937_64 generator(thread_idx);
+    for (char& c : value)
+        c = static_cast<char>('a' + generator() % 26);
+    auto value_ptr = reinterpret_cast<ukv_val_ptr_t>(value.data());
+    auto value_length = static_cast<ukv_val_len_t>(value.size());
+    values_arg_t values {
+        .contents_begin = {&value_ptr, 0},
+        .offsets_begin = {},
+        .lengths_begin = {&value_length, 0},
+    };
+
+    txn_t txn;
+    col_t col = *db.collection();
+    if (config.transactional) {
+        auto maybe_txn = db.transact();
+        if (!maybe_txn) {
+            std::fprintf(stderr, "Failed to start a transaction: %s\n", *maybe_txn.release_status().member_ptr());
+            return;
+        }
+        txn = *std::move(maybe_txn);
+        col = *txn.collection();
+    }
+
+    for (std::size_t i = 0; i != batches; ++i) {
+        ycsb_op_t op = chooser.next_op();
+        if (op == ycsb_op_t::insert_k) {
+            auto first = next_insert.fetch_add(config.batch, std::memory_order_relaxed);
+            for (std::size_t j = 0; j != config.batch; ++j)
+                keys[j] = static_cast<ukv_key_t>(first + j);
+        }
+        else
+            for (ukv_key_t& key : keys)
+                key = chooser.next();
+
+        auto start = std::chrono::steady_clock::now();
+        status_t status = config.transactional ? txn.reset() : status_t {};
+        if (status) {
+            switch (op) {
+            case ycsb_op_t::read_k: status = col[keys].value().release_status(); break;
+            case ycsb_op_t::update_k:
+            case ycsb_op_t::insert_k: status = col[keys].assign(values); break;
+            case ycsb_op_t::rmw_k:
+                status = col[keys].value(config.transactional).release_status();
+                if (status)
+                    status = col[keys].assign(values);
+                break;
+            case ycsb_op_t::scan_k:
+                for (ukv_key_t key : keys) {
+                    auto stream = col.members(key).pairs_begin(chooser.next_scan_length());
+                    if (!stream) {
+                        status = stream.release_status();
+                        break;
+                    }
+                }
+                break;
+            }
+        }
+        if (status && config.transactional)
+            status = txn.commit();
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+
+        // New records become visible to the "latest" distribution only after the write
+        if (op == ycsb_op_t::insert_k && status)
+            inserted.fetch_add(config.batch, std::memory_order_relaxed);
+        results.ops[static_cast<std::size_t>(op)].record(config.batch, ns.count(), !status);
+    }
+}
+
+bool load(db_t& db, ycsb_config_t const& config) {
+    constexpr std::size_t batch_k = 1024;
+    col_t col = *db.collection();
+    std::vector<ukv_key_t> keys;
+    std::string value(config.value_length, 'x');
+    auto value_ptr = reinterpret_cast<ukv_val_ptr_t>(value.data());
+    auto value_length = static_cast<ukv_val_len_t>(value.size());
+    values_arg_t values {
+        .contents_begin = {&value_ptr, 0},
+        .offsets_begin = {},
+        .lengths_begin = {&value_length, 0},
+    };
+
+    for (std::size_t first = 0; first < config.records; first += batch_k) {
+        keys.resize(std::min(batch_k, config.records - first));
+        for (std::size_t j = 0; j != keys.size(); ++j)
+            keys[j] = static_cast<ukv_key_t>(first + j);
+        status_t status = col[keys].assign(values);
+        if (!status) {
+            std::fprintf(stderr, "Failed to load: %s\n", *status.member_ptr());
+            return false;
+        }
+    }
+    return true;
+}
+
+void report(char const* section, std::chrono::nanoseconds runtime, op_summary_t const* ops, std::size_t count) {
+    std::uint64_t operations = 0;
+    for (std::size_t i = 0; i != count; ++i)
+        operations += ops[i].tasks;
+    double seconds = std::chrono::duration<double>(runtime).count();
+    std::printf("[%s], RunTime(ms), %.0f\n", section, seconds * 1e3);
+    std::printf("[%s], Throughput(ops/sec), %.1f\n", section, operations / seconds);
+
+    for (std::size_t i = 0; i != count; ++i) {
+        op_summary_t const& op = ops[i];
+        if (!op.calls)
+            continue;
+        char const* name = ycsb_op_names_k[i];
+        std::printf("[%s], Operations, %zu\n", name, std::size_t(op.tasks));
+        std::printf("[%s], Calls, %zu\n", name, std::size_t(op.calls));
+        std::printf("[%s], AverageLatency(us), %.3f\n", name, op.total_ns / 1e3 / op.calls);
+        std::printf("[%s], 50thPercentileLatency(us), %.3f\n", name, op.quantile(0.5) / 1e3);
+        std::printf("[%s], 95thPercentileLatency(us), %.3f\n", name, op.quantile(0.95) / 1e3);
+        std::printf("[%s], 99thPercentileLatency(us), %.3f\n", name, op.quantile(0.99) / 1e3);
+        std::printf("[%s], 99.9thPercentileLatency(us), %.3f\n", name, op.quantile(0.999) / 1e3);
+        std::printf("[%s], Return=OK, %zu\n", name, std::size_t(op.calls - op.failures));
+        if (op.failures)
+            std::printf("[%s], Return=ERROR, %zu\n", name, std::size_t(op.failures));
+    }
+}
+
+int main(int argc, char** argv) {
+    ycsb_config_t config;
+    parse_workload('a', config);
+    if (!parse_args(argc, argv, config))
+        return 1;
+
+    db_t db;
+    status_t status = db.open(config.config);
+    if (!status) {
+        std::fprintf(stderr, "Failed to open the DB: %s\n", *status.member_ptr());
+        return 1;
+    }
+
+    // Load
+    auto load_start = std::chrono::steady_clock::now();
+    if (!load(db, config))
+        return 1;
+    op_summary_t loaded;
+    loaded.tasks = config.records;
+    report("LOAD", std::chrono::steady_clock::now() - load_start, &loaded, 1);
+
+    // Run
+    zipfian_t zipfian {config.records};
+    std::atomic<std::size_t> next_insert {config.records};
+    std::atomic<std::size_t> inserted {config.records};
+    std::vector<ycsb_results_t> results(config.threads);
+    std::vector<std::thread> threads;
+    std::size_t batches = (config.operations + config.batch - 1) / config.batch;
+
+    auto run_start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i != config.threads; ++i) {
+        std::size_t share = batches / config.threads + (i < batches % config.threads);
+        threads.emplace_back(run_worker,
+                             std::ref(db),
+                             std::cref(config),
+                             std::cref(zipfian),
+                             std::ref(next_insert),
+                             std::ref(inserted),
+                             i,
+                             share,
+                             std::ref(results[i]));
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+    auto runtime = std::chrono::steady_clock::now() - run_start;
+
+    op_summary_t summaries[ycsb_ops_k];
+    for (ycsb_results_t const& thread_results : results)
+        for (std::size_t i = 0; i != ycsb_ops_k; ++i)
+            summaries[i].add(thread_results.ops[i]);
+    report("OVERALL", runtime, summaries, ycsb_ops_k);
+    return 0;
+}